@@ -0,0 +1 @@
+#include "../../src/md/forcefieldparameterscache.h"
@@ -34,14 +34,24 @@
 ******************************************************************************/
 
 #include <string>
+#include <fstream>
 #include <iostream>
 
 #include <boost/scoped_ptr.hpp>
 #include <boost/program_options.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#ifndef CHEMKIT_OS_WIN32
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/bzip2.hpp>
+#endif
 
 #include <chemkit/chemkit.h>
+#include <chemkit/molecule.h>
 #include <chemkit/moleculefile.h>
+#include <chemkit/moleculefilereader.h>
+#include <chemkit/moleculefileformat.h>
 
 void printHelp(char *argv[], const boost::program_options::options_description &options)
 {
@@ -104,47 +114,95 @@ int main(int argc, char *argv[])
         return -1;
     }
 
-    // read input
-    chemkit::MoleculeFile inputFile;
-    if(!inputFormatName.empty()){
-        inputFile.setFormat(inputFormatName);
+    // open input
+    chemkit::MoleculeFileReader reader;
+    if(inputFileName != "-"){
+        reader.setFileName(inputFileName);
+    }
+    if(!inputFormatName.empty() && !reader.setFormat(inputFormatName)){
+        std::cerr << "Error: Failed to read input file: " << reader.errorString() << std::endl;
+        return -1;
     }
 
     bool ok = false;
     if(inputFileName == "-"){
-        ok = inputFile.read(std::cin);
+        ok = reader.open(std::cin);
     }
     else{
-        if(inputFormatName.empty()){
-            ok = inputFile.read(inputFileName);
-        }
-        else{
-            ok = inputFile.read(inputFileName, inputFormatName);
-        }
+        ok = reader.open();
     }
 
     if(!ok){
-        std::cerr << "Error: Failed to read input file: " << inputFile.errorString() << std::endl;
+        std::cerr << "Error: Failed to read input file: " << reader.errorString() << std::endl;
         return -1;
     }
 
-    // write output
-    if(outputFormatName.empty()){
-        ok = inputFile.write(outputFileName);
+    // determine output format and compression from the output file name
+    chemkit::MoleculeFile outputFile;
+    if(outputFileName != "-"){
+        outputFile.setFileName(outputFileName);
     }
-    else{
-        if(outputFileName == "-"){
-            ok = inputFile.write(std::cout, outputFormatName);
+    if(!outputFormatName.empty()){
+        outputFile.setFormat(outputFormatName);
+    }
+
+    chemkit::MoleculeFileFormat *outputFormat = outputFile.format();
+    if(!outputFormat){
+        std::cerr << "Error: failed to write output file: " << outputFile.errorString() << std::endl;
+        return -1;
+    }
+
+    // open output
+    std::ofstream outputFileStream;
+    if(outputFileName != "-"){
+        outputFileStream.open(outputFileName.c_str());
+        if(!outputFileStream.is_open()){
+            std::cerr << "Error: failed to open '" << outputFileName << "' for writing." << std::endl;
+            return -1;
         }
-        else{
-            ok = inputFile.write(outputFileName, outputFormatName);
+    }
+
+    boost::iostreams::filtering_ostream output;
+#ifndef CHEMKIT_OS_WIN32
+    if(outputFile.compressionFormat() == "gz"){
+        output.push(boost::iostreams::gzip_compressor());
+    }
+    else if(outputFile.compressionFormat() == "bz2"){
+        output.push(boost::iostreams::bzip2_compressor());
+    }
+#endif
+    if(outputFileName == "-"){
+        output.push(std::cout);
+    }
+    else{
+        output.push(outputFileStream);
+    }
+
+    // convert each molecule as it is read. formats which cannot be
+    // written one molecule at a time are collected and written once
+    // the entire input has been read.
+    chemkit::MoleculeFile bufferFile;
+    bool bufferOutput = false;
+
+    while(boost::shared_ptr<chemkit::Molecule> molecule = reader.next()){
+        if(bufferOutput || !outputFormat->writeMolecule(molecule.get(), output)){
+            bufferFile.addMolecule(molecule);
+            bufferOutput = true;
         }
     }
 
-    if(!ok){
-        std::cerr << "Error: failed to write output file: " << inputFile.errorString() << std::endl;
+    if(!reader.errorString().empty()){
+        std::cerr << "Error: Failed to read input file: " << reader.errorString() << std::endl;
         return -1;
     }
 
+    if(bufferOutput){
+        ok = bufferFile.write(output, outputFormat);
+        if(!ok){
+            std::cerr << "Error: failed to write output file: " << bufferFile.errorString() << std::endl;
+            return -1;
+        }
+    }
+
     return 0;
 }
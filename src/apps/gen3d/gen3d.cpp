@@ -33,12 +33,22 @@
 **
 ******************************************************************************/
 
+#include <cstdio>
 #include <string>
+#include <fstream>
+#include <sstream>
 #include <iostream>
 
+#include <boost/bind.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/program_options.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#ifndef CHEMKIT_OS_WIN32
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/bzip2.hpp>
+#endif
 
 #include <chemkit/atom.h>
 #include <chemkit/point3.h>
@@ -47,25 +57,147 @@
 #include <chemkit/forcefield.h>
 #include <chemkit/lineformat.h>
 #include <chemkit/moleculefile.h>
+#include <chemkit/moleculefileformat.h>
 #include <chemkit/coordinatepredictor.h>
-#include <chemkit/moleculegeometryoptimizer.h>
+#include <chemkit/batchgeometryoptimizer.h>
 
 void printHelp(char *argv[], const boost::program_options::options_description &options)
 {
     std::cout << "Usage: " << argv[0] << " [OPTIONS] formula file\n";
+    std::cout << "       " << argv[0] << " [OPTIONS] -f input-file file\n";
     std::cout << "\n";
     std::cout << "Generates 3D coordinates for a molecule from its SMILES formula.\n";
+    std::cout << "The input file contains one formula per line optionally followed\n";
+    std::cout << "by the molecule's name.\n";
     std::cout << "\n";
     std::cout << "Options:\n";
     std::cout << options << "\n";
 }
 
+// Reads formulas from an input stream and predicts their coordinates.
+class FormulaSource
+{
+public:
+    FormulaSource(std::istream &input, chemkit::LineFormat *format)
+        : m_input(input),
+          m_format(format),
+          m_lineNumber(0)
+    {
+    }
+
+    boost::shared_ptr<chemkit::Molecule> operator()()
+    {
+        std::string line;
+
+        while(std::getline(m_input, line)){
+            m_lineNumber++;
+
+            boost::trim(line);
+            if(line.empty()){
+                continue;
+            }
+
+            // the formula is followed by an optional name
+            std::string formula = line;
+            std::string name;
+            size_t space = line.find_first_of(" \t");
+            if(space != std::string::npos){
+                formula = line.substr(0, space);
+                name = boost::trim_copy(line.substr(space));
+            }
+
+            boost::shared_ptr<chemkit::Molecule> molecule(m_format->read(formula));
+            if(!molecule){
+                std::cerr << "Failed to parse formula on line " << m_lineNumber
+                          << ": " << m_format->errorString() << std::endl;
+                continue;
+            }
+
+            if(!name.empty()){
+                molecule->setName(name);
+            }
+
+            chemkit::CoordinatePredictor::predictCoordinates(molecule.get());
+
+            return molecule;
+        }
+
+        return boost::shared_ptr<chemkit::Molecule>();
+    }
+
+private:
+    std::istream &m_input;
+    chemkit::LineFormat *m_format;
+    size_t m_lineNumber;
+};
+
+// Writes each molecule to the output as soon as it is generated so
+// that only the molecules still being optimized are kept in memory.
+// Formats which cannot be written one molecule at a time are collected
+// and written once all of the molecules have been generated.
+class MoleculeWriter
+{
+public:
+    MoleculeWriter(chemkit::MoleculeFileFormat *format, std::ostream &output)
+        : m_format(format),
+          m_output(output),
+          m_bufferOutput(false),
+          m_count(0)
+    {
+    }
+
+    void write(const boost::shared_ptr<chemkit::Molecule> &molecule)
+    {
+        // set center to origin
+        molecule->setCenter(0, 0, 0);
+
+        if(m_bufferOutput || !m_format->writeMolecule(molecule.get(), m_output)){
+            m_bufferFile.addMolecule(molecule);
+            m_bufferOutput = true;
+        }
+
+        m_count++;
+    }
+
+    bool finish()
+    {
+        if(m_bufferOutput && !m_bufferFile.write(m_output, m_format)){
+            m_errorString = m_bufferFile.errorString();
+            return false;
+        }
+
+        m_output.flush();
+        return true;
+    }
+
+    size_t count() const
+    {
+        return m_count;
+    }
+
+    std::string errorString() const
+    {
+        return m_errorString;
+    }
+
+private:
+    chemkit::MoleculeFileFormat *m_format;
+    std::ostream &m_output;
+    chemkit::MoleculeFile m_bufferFile;
+    bool m_bufferOutput;
+    size_t m_count;
+    std::string m_errorString;
+};
+
 int main(int argc, char *argv[])
 {
     std::string inputFormula;
+    std::string inputFileName;
     std::string inputFormatName;
     std::string outputFileName;
     std::string outputFormatName;
+    std::string forceFieldName;
+    size_t threadCount = 0;
 
     boost::program_options::options_description options;
     options.add_options()
@@ -75,12 +207,21 @@ int main(int argc, char *argv[])
         ("output-file",
             boost::program_options::value<std::string>(&outputFileName),
             "The output file.")
+        ("input-file,f",
+            boost::program_options::value<std::string>(&inputFileName),
+            "Reads formulas from the input file.")
         ("input-format,i",
             boost::program_options::value<std::string>(&inputFormatName),
             "Sets the input format.")
         ("output-format,o",
             boost::program_options::value<std::string>(&outputFormatName),
             "Sets the output format.")
+        ("force-field",
+            boost::program_options::value<std::string>(&forceFieldName)->default_value("uff"),
+            "Sets the force field used for geometry optimization.")
+        ("threads,j",
+            boost::program_options::value<size_t>(&threadCount),
+            "Sets the number of threads used for geometry optimization.")
         ("no-optimization",
             "Do not perform geometry optimization.")
         ("help,h",
@@ -97,11 +238,17 @@ int main(int argc, char *argv[])
         variables);
     boost::program_options::notify(variables);
 
+    // with an input file the only positional argument is the output file
+    if(!inputFileName.empty() && outputFileName.empty()){
+        outputFileName = inputFormula;
+        inputFormula.clear();
+    }
+
     if(variables.count("help")){
         printHelp(argv, options);
         return 0;
     }
-    else if(inputFormula.empty()){
+    else if(inputFormula.empty() && inputFileName.empty()){
         printHelp(argv, options);
         std::cerr << "Error: No input formula specified." << std::endl;
         return -1;
@@ -131,27 +278,23 @@ int main(int argc, char *argv[])
         return -1;
     }
 
-    // read input formula
-    boost::shared_ptr<chemkit::Molecule> molecule(inputFormat->read(inputFormula));
-    if(!molecule){
-        std::cerr << "Failed to parse formula: " << inputFormat->errorString() << std::endl;
-        return -1;
-    }
-
-    // generate 3d coordinates
-    chemkit::CoordinatePredictor::predictCoordinates(molecule.get());
-
-    if(!variables.count("no-optimization")){
-        // optimize 3d coordinates
-        chemkit::MoleculeGeometryOptimizer::optimizeCoordinates(molecule.get());
+    // read input formulas
+    std::istringstream formulaInput(inputFormula);
+    std::ifstream fileInput;
+    if(!inputFileName.empty()){
+        fileInput.open(inputFileName.c_str());
+        if(!fileInput.is_open()){
+            std::cerr << "Error: failed to open input file: " << inputFileName << std::endl;
+            return -1;
+        }
     }
 
-    // set center to origin
-    molecule->setCenter(0, 0, 0);
+    FormulaSource source(inputFileName.empty() ? static_cast<std::istream &>(formulaInput)
+                                               : static_cast<std::istream &>(fileInput),
+                         inputFormat.get());
 
-    // write output file
+    // determine output format and compression from the output file name
     chemkit::MoleculeFile outputFile(outputFileName);
-    outputFile.addMolecule(molecule);
     if(!outputFormatName.empty()){
         if(!outputFile.setFormat(outputFormatName)){
             std::cerr << "File format '" << outputFormatName << "' is not supported." << std::endl;
@@ -159,10 +302,59 @@ int main(int argc, char *argv[])
         }
     }
 
-    if(!outputFile.write()){
+    chemkit::MoleculeFileFormat *outputFormat = outputFile.format();
+    if(!outputFormat){
         std::cerr << "Error: failed to write output file: " << outputFile.errorString() << std::endl;
         return -1;
     }
 
+    // open output
+    std::ofstream outputFileStream(outputFileName.c_str());
+    if(!outputFileStream.is_open()){
+        std::cerr << "Error: failed to open '" << outputFileName << "' for writing." << std::endl;
+        return -1;
+    }
+
+    boost::iostreams::filtering_ostream output;
+#ifndef CHEMKIT_OS_WIN32
+    if(outputFile.compressionFormat() == "gz"){
+        output.push(boost::iostreams::gzip_compressor());
+    }
+    else if(outputFile.compressionFormat() == "bz2"){
+        output.push(boost::iostreams::bzip2_compressor());
+    }
+#endif
+    output.push(outputFileStream);
+
+    MoleculeWriter writer(outputFormat, output);
+
+    if(!variables.count("no-optimization")){
+        // generate and optimize 3d coordinates
+        chemkit::BatchGeometryOptimizer optimizer;
+        optimizer.setForceField(forceFieldName);
+        optimizer.setThreadCount(threadCount);
+        optimizer.optimize(boost::ref(source), boost::bind(&MoleculeWriter::write, &writer, _1));
+    }
+    else{
+        // generate 3d coordinates
+        while(boost::shared_ptr<chemkit::Molecule> molecule = source()){
+            writer.write(molecule);
+        }
+    }
+
+    bool ok = writer.finish();
+    output.reset();
+    outputFileStream.close();
+
+    if(writer.count() == 0){
+        std::remove(outputFileName.c_str());
+        std::cerr << "Error: no molecules were generated." << std::endl;
+        return -1;
+    }
+    else if(!ok){
+        std::cerr << "Error: failed to write output file: " << writer.errorString() << std::endl;
+        return -1;
+    }
+
     return 0;
 }
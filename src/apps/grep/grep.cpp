@@ -34,9 +34,14 @@
 ******************************************************************************/
 
 #include <string>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/filesystem.hpp>
 #include <boost/program_options.hpp>
 #include <boost/algorithm/string.hpp>
 
@@ -45,17 +50,284 @@
 #include <chemkit/molecule.h>
 #include <chemkit/lineformat.h>
 #include <chemkit/moleculefile.h>
+#include <chemkit/moleculefilereader.h>
+#include <chemkit/moleculefileformat.h>
+#include <chemkit/threadpool.h>
 #include <chemkit/substructurequery.h>
+#include <chemkit/substructurequeryset.h>
+#include <chemkit/substructurescreen.h>
+
+// The screen index stores the screening fingerprint for each molecule
+// in a file so that it does not need to be recalculated each time the
+// file is searched. The index is only used if the size and modification
+// time of the file match the values it was built with.
+struct ScreenIndexHeader
+{
+    char magic[8];
+    boost::uint32_t version;
+    boost::uint32_t bitCount;
+    boost::uint32_t flags;
+    boost::uint32_t complete;
+    boost::uint64_t fileSize;
+    boost::int64_t fileModified;
+    boost::uint64_t count;
+};
+
+const char ScreenIndexMagic[8] = { 'C', 'K', 'S', 'C', 'R', 'E', 'E', 'N' };
+const boost::uint32_t ScreenIndexVersion = 1;
+
+ScreenIndexHeader screenIndexHeader(const std::string &fileName, int flags, size_t bitCount)
+{
+    ScreenIndexHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, ScreenIndexMagic, sizeof(header.magic));
+    header.version = ScreenIndexVersion;
+    header.bitCount = bitCount;
+    header.flags = flags;
+    header.fileSize = boost::filesystem::file_size(fileName);
+    header.fileModified = boost::filesystem::last_write_time(fileName);
+
+    return header;
+}
+
+// Reads the fingerprints from a screen index one batch at a time so
+// that the whole index never needs to be held in memory.
+class ScreenIndexReader
+{
+public:
+    ScreenIndexReader()
+        : m_remaining(0)
+    {
+    }
+
+    // opens the index and checks that it matches the expected header
+    bool open(const std::string &indexFileName, const ScreenIndexHeader &expected)
+    {
+        m_file.open(indexFileName.c_str(), std::ios_base::in | std::ios_base::binary);
+        if(!m_file.is_open()){
+            return false;
+        }
+
+        ScreenIndexHeader header;
+        m_file.read(reinterpret_cast<char *>(&header), sizeof(header));
+        if(!m_file ||
+           std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+           header.version != expected.version ||
+           header.bitCount != expected.bitCount ||
+           header.flags != expected.flags ||
+           header.fileSize != expected.fileSize ||
+           header.fileModified != expected.fileModified ||
+           !header.complete){
+            m_file.close();
+            return false;
+        }
+
+        m_bitCount = header.bitCount;
+        m_remaining = header.count;
+        m_blocks.resize(chemkit::Bitset(m_bitCount).num_blocks());
+
+        return true;
+    }
+
+    // reads the next count fingerprints. returns false if the index
+    // does not contain count more fingerprints.
+    bool read(size_t count, std::vector<chemkit::Bitset> &fingerprints)
+    {
+        if(count > m_remaining){
+            return false;
+        }
+
+        fingerprints.resize(count);
+
+        for(size_t i = 0; i < count; i++){
+            m_file.read(reinterpret_cast<char *>(&m_blocks[0]), m_blocks.size() * sizeof(chemkit::Bitset::block_type));
+            if(!m_file){
+                m_remaining = 0;
+                return false;
+            }
+
+            fingerprints[i].resize(m_bitCount);
+            boost::from_block_range(m_blocks.begin(), m_blocks.end(), fingerprints[i]);
+        }
+
+        m_remaining -= count;
+
+        return true;
+    }
+
+private:
+    std::ifstream m_file;
+    size_t m_bitCount;
+    boost::uint64_t m_remaining;
+    std::vector<chemkit::Bitset::block_type> m_blocks;
+};
+
+// Writes a screen index as the fingerprints are calculated. The index
+// is written to a temporary file which replaces the index once all of
+// the fingerprints have been written.
+class ScreenIndexWriter
+{
+public:
+    bool open(const std::string &indexFileName, const ScreenIndexHeader &header)
+    {
+        m_fileName = indexFileName;
+        m_temporaryFileName = indexFileName + ".tmp";
+        m_header = header;
+        m_header.complete = 0;
+        m_header.count = 0;
+
+        m_file.open(m_temporaryFileName.c_str(), std::ios_base::out | std::ios_base::binary);
+        if(!m_file.is_open()){
+            return false;
+        }
+
+        m_file.write(reinterpret_cast<const char *>(&m_header), sizeof(m_header));
+
+        return m_file.good();
+    }
+
+    void write(const std::vector<chemkit::Bitset> &fingerprints)
+    {
+        foreach(const chemkit::Bitset &fingerprint, fingerprints){
+            m_blocks.resize(fingerprint.num_blocks());
+            boost::to_block_range(fingerprint, m_blocks.begin());
+            m_file.write(reinterpret_cast<const char *>(&m_blocks[0]), m_blocks.size() * sizeof(chemkit::Bitset::block_type));
+        }
+
+        m_header.count += fingerprints.size();
+    }
+
+    // marks the index as complete and moves it into place
+    bool finish()
+    {
+        m_header.complete = 1;
+        m_file.seekp(0);
+        m_file.write(reinterpret_cast<const char *>(&m_header), sizeof(m_header));
+
+        bool ok = m_file.good();
+        m_file.close();
+
+        boost::system::error_code error;
+        if(ok){
+            boost::filesystem::rename(m_temporaryFileName, m_fileName, error);
+        }
+        if(!ok || error){
+            boost::filesystem::remove(m_temporaryFileName, error);
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    std::ofstream m_file;
+    std::string m_fileName;
+    std::string m_temporaryFileName;
+    ScreenIndexHeader m_header;
+    std::vector<chemkit::Bitset::block_type> m_blocks;
+};
+
+// reads the pattern molecule from formula. the line format is
+// selected based on the pattern given.
+boost::shared_ptr<chemkit::Molecule> readPattern(const std::string &formula, std::string &errorString)
+{
+    std::string inputFormat;
+    if(boost::algorithm::starts_with(formula, "InChI=") || isdigit(formula[0])){
+        inputFormat = "inchi";
+    }
+    else{
+        inputFormat = "smiles";
+    }
+
+    boost::scoped_ptr<chemkit::LineFormat> patternFormat(chemkit::LineFormat::create(inputFormat));
+    if(!patternFormat){
+        errorString = "failed to create line format.";
+        return boost::shared_ptr<chemkit::Molecule>();
+    }
+
+    boost::shared_ptr<chemkit::Molecule> molecule(patternFormat->read(formula));
+    if(!molecule){
+        errorString = patternFormat->errorString();
+    }
+
+    return molecule;
+}
+
+// reads the patterns from fileName. each line contains a pattern
+// optionally followed by its name. empty lines and lines starting
+// with '#' are ignored.
+bool readPatternFile(const std::string &fileName,
+                     chemkit::SubstructureQuerySet &patterns,
+                     std::vector<std::string> &names,
+                     int flags)
+{
+    std::ifstream file(fileName.c_str());
+    if(!file.is_open()){
+        std::cerr << "Error: failed to open pattern file: " << fileName << std::endl;
+        return false;
+    }
+
+    std::string line;
+    size_t lineNumber = 0;
+
+    while(std::getline(file, line)){
+        lineNumber++;
+
+        boost::algorithm::trim(line);
+        if(line.empty() || line[0] == '#'){
+            continue;
+        }
+
+        std::string formula = line;
+        std::string name = line;
+
+        size_t space = line.find_first_of(" \t");
+        if(space != std::string::npos){
+            formula = line.substr(0, space);
+            name = boost::algorithm::trim_copy(line.substr(space));
+        }
+
+        std::string errorString;
+        boost::shared_ptr<chemkit::Molecule> molecule = readPattern(formula, errorString);
+        if(!molecule){
+            std::cerr << "Error: failed to read pattern on line " << lineNumber << ": " << errorString << std::endl;
+            return false;
+        }
+
+        patterns.addQuery(molecule, flags);
+        names.push_back(name);
+    }
+
+    return true;
+}
+
+// matches each molecule in [begin, end) against the patterns
+void matchPatterns(const chemkit::SubstructureQuerySet *patterns,
+                   const std::vector<const chemkit::Molecule *> *molecules,
+                   std::vector<std::vector<size_t> > *matches,
+                   size_t begin,
+                   size_t end)
+{
+    for(size_t i = begin; i < end; i++){
+        (*matches)[i] = patterns->matches((*molecules)[i]);
+    }
+}
 
 void printHelp(char *argv[], const boost::program_options::options_description &options)
 {
     std::cout << "Usage: " << argv[0] << " [OPTIONS] PATTERN FILE\n";
+    std::cout << "       " << argv[0] << " [OPTIONS] --patterns PATTERNFILE FILE\n";
     std::cout << "\n";
     std::cout << "Search for molecules matching PATTERN in FILE. PATTERN is a line\n";
     std::cout << "representation (e.g. InChI or SMILES) of a molecule to search\n";
     std::cout << "for. A matching molecule is either an exact match or a\n";
     std::cout << "superstructure of PATTERN.\n";
     std::cout << "\n";
+    std::cout << "With --patterns, each line of PATTERNFILE contains a pattern\n";
+    std::cout << "followed by an optional name and molecules matching any of the\n";
+    std::cout << "patterns are returned. With --names-only the names of the\n";
+    std::cout << "patterns each molecule matches are printed after its name.\n";
+    std::cout << "\n";
     std::cout << "Options:\n";
     std::cout << options << "\n";
 }
@@ -64,6 +336,9 @@ int main(int argc, char *argv[])
 {
     std::string formula;
     std::string fileName;
+    std::string indexFileName;
+    std::string patternFileName;
+    size_t threadCount = 1;
 
     boost::program_options::options_description options;
     options.add_options()
@@ -81,6 +356,15 @@ int main(int argc, char *argv[])
             "Return only non-matching molecules.")
         ("names-only,n",
             "Output only the names of matching molecules.")
+        ("threads,t",
+            boost::program_options::value<size_t>(&threadCount),
+            "Number of threads to search with (0 uses all cores).")
+        ("index,x",
+            boost::program_options::value<std::string>(&indexFileName),
+            "Screen index file to use (built if missing or out of date).")
+        ("patterns,f",
+            boost::program_options::value<std::string>(&patternFileName),
+            "File containing patterns to search for, one per line.")
         ("help,h",
             "Shows this help message");
 
@@ -95,11 +379,16 @@ int main(int argc, char *argv[])
         variables);
     boost::program_options::notify(variables);
 
+    // with a pattern file the only positional argument is the input file
+    if(!patternFileName.empty() && fileName.empty()){
+        std::swap(formula, fileName);
+    }
+
     if(variables.count("help")){
         printHelp(argv, options);
         return 0;
     }
-    else if(formula.empty()){
+    else if(formula.empty() && patternFileName.empty()){
         printHelp(argv, options);
         std::cerr << "Error: no input formula given." << std::endl;
         return -1;
@@ -109,34 +398,15 @@ int main(int argc, char *argv[])
         std::cerr << "Error: no input file given." << std::endl;
         return -1;
     }
-
-    // select input line format based on the input pattern given
-    std::string inputFormat;
-    if(boost::algorithm::starts_with(formula, "InChI=") || isdigit(formula[0])){
-        inputFormat = "inchi";
-    }
-    else{
-        inputFormat = "smiles";
-    }
-
-    // create input line format
-    boost::scoped_ptr<chemkit::LineFormat> patternFormat(chemkit::LineFormat::create(inputFormat));
-    if(!patternFormat){
-        std::cerr << "Error: failed to create line format." << std::endl;
+    else if(!patternFileName.empty() && !indexFileName.empty()){
+        std::cerr << "Error: a screen index can not be used with a pattern file." << std::endl;
         return -1;
     }
 
-    // read input molecule
-    boost::shared_ptr<chemkit::Molecule> patternMolecule(patternFormat->read(formula));
-    if(!patternMolecule){
-        std::cerr << "Error: failed to read pattern molecule: " << patternFormat->errorString() << std::endl;
-        return -1;
-    }
-
-    // read input file
-    chemkit::MoleculeFile inputFile(fileName);
-    if(!inputFile.read()){
-        std::cerr << "Error: failed to read input file: " << inputFile.errorString() << std::endl;
+    // open input file
+    chemkit::MoleculeFileReader reader(fileName);
+    if(!reader.open()){
+        std::cerr << "Error: failed to read input file: " << reader.errorString() << std::endl;
         return -1;
     }
 
@@ -154,27 +424,180 @@ int main(int argc, char *argv[])
         flags |= chemkit::SubstructureQuery::CompareExact;
     }
 
+    // read patterns
     chemkit::SubstructureQuery query;
-    query.setMolecule(patternMolecule);
-    query.setFlags(flags);
+    chemkit::SubstructureQuerySet patterns;
+    std::vector<std::string> patternNames;
+    boost::shared_ptr<chemkit::Molecule> patternMolecule;
+
+    if(patternFileName.empty()){
+        std::string errorString;
+        patternMolecule = readPattern(formula, errorString);
+        if(!patternMolecule){
+            std::cerr << "Error: failed to read pattern molecule: " << errorString << std::endl;
+            return -1;
+        }
+
+        query.setMolecule(patternMolecule);
+        query.setFlags(flags);
+    }
+    else if(!readPatternFile(patternFileName, patterns, patternNames, flags)){
+        return -1;
+    }
+
+    // create output format
+    boost::scoped_ptr<chemkit::MoleculeFileFormat> outputFormat;
+    if(!namesOnly){
+        outputFormat.reset(chemkit::MoleculeFileFormat::create(reader.formatName()));
+        if(!outputFormat){
+            std::cerr << "Error: failed to create output format." << std::endl;
+            return -1;
+        }
+    }
+
+    // molecules are read and screened in batches which are matched in
+    // parallel. matching molecules are written as soon as each batch
+    // has been screened. formats which cannot be written one molecule
+    // at a time are collected in the output file and written once the
+    // search has finished.
+    chemkit::SubstructureScreen screen(&query);
+    screen.setThreadCount(threadCount);
+
+    boost::scoped_ptr<chemkit::ThreadPool> pool;
+    if(!patternFileName.empty() && screen.threadCount() > 1){
+        pool.reset(new chemkit::ThreadPool(screen.threadCount()));
+    }
+
+    const size_t batchSize = screen.threadCount() * screen.chunkSize() * 4;
+
+    // open the screen index. the fingerprints are read from it one
+    // batch at a time. if it is missing or does not match the input
+    // file the fingerprints are calculated and written to a new index
+    // as the search proceeds.
+    ScreenIndexReader indexReader;
+    ScreenIndexWriter indexWriter;
+    bool useIndex = !indexFileName.empty();
+    bool readIndex = false;
+    bool buildIndex = false;
+
+    if(useIndex){
+        chemkit::Bitset patternFingerprint = query.screeningFingerprint(patternMolecule.get());
+        ScreenIndexHeader indexHeader = screenIndexHeader(fileName, flags, patternFingerprint.size());
+
+        readIndex = indexReader.open(indexFileName, indexHeader);
+
+        if(!readIndex){
+            buildIndex = indexWriter.open(indexFileName, indexHeader);
+            if(!buildIndex){
+                std::cerr << "Warning: failed to write screen index: " << indexFileName << std::endl;
+            }
+        }
+    }
 
     chemkit::MoleculeFile outputFile;
+    bool bufferOutput = false;
+
+    std::vector<boost::shared_ptr<chemkit::Molecule> > batch;
+    std::vector<const chemkit::Molecule *> batchMolecules;
+
+    for(;;){
+        batch.clear();
+        batchMolecules.clear();
+
+        while(batch.size() < batchSize){
+            boost::shared_ptr<chemkit::Molecule> molecule = reader.next();
+            if(!molecule){
+                break;
+            }
+
+            batch.push_back(molecule);
+            batchMolecules.push_back(molecule.get());
+        }
+
+        if(batch.empty()){
+            break;
+        }
+
+        std::vector<bool> matches;
+        std::vector<std::vector<size_t> > patternMatches;
 
-    foreach(const boost::shared_ptr<chemkit::Molecule> &molecule, inputFile.molecules()){
-        bool match = query.matches(molecule.get());
+        if(!patternFileName.empty()){
+            patternMatches.resize(batch.size());
 
-        if((match && !invertMatch) || (!match && invertMatch)){
-            outputFile.addMolecule(molecule);
+            if(pool){
+                for(size_t begin = 0; begin < batch.size(); begin += screen.chunkSize()){
+                    size_t end = std::min(begin + screen.chunkSize(), batch.size());
+
+                    pool->start(boost::bind(matchPatterns, &patterns, &batchMolecules, &patternMatches, begin, end));
+                }
+
+                pool->waitForDone();
+            }
+            else{
+                matchPatterns(&patterns, &batchMolecules, &patternMatches, 0, batch.size());
+            }
+
+            matches.resize(batch.size());
+            for(size_t i = 0; i < batch.size(); i++){
+                matches[i] = !patternMatches[i].empty();
+            }
+        }
+        else if(useIndex){
+            std::vector<chemkit::Bitset> fingerprints;
+
+            if(!readIndex || !indexReader.read(batch.size(), fingerprints)){
+                // the index is exhausted or unreadable from here on
+                readIndex = false;
+                fingerprints = screen.fingerprints(batchMolecules);
+
+                if(buildIndex){
+                    indexWriter.write(fingerprints);
+                }
+            }
+
+            matches = screen.screen(batchMolecules, fingerprints);
+        }
+        else{
+            matches = screen.screen(batchMolecules);
+        }
+
+        for(size_t i = 0; i < batch.size(); i++){
+            const boost::shared_ptr<chemkit::Molecule> &molecule = batch[i];
+            bool match = matches[i];
+
+            if((match && !invertMatch) || (!match && invertMatch)){
+                if(namesOnly){
+                    std::cout << molecule->name();
+
+                    if(!patternMatches.empty() && match){
+                        for(size_t j = 0; j < patternMatches[i].size(); j++){
+                            std::cout << (j == 0 ? "\t" : ",") << patternNames[patternMatches[i][j]];
+                        }
+                    }
+
+                    std::cout << "\n";
+                }
+                else if(bufferOutput || !outputFormat->writeMolecule(molecule.get(), std::cout)){
+                    outputFile.addMolecule(molecule);
+                    bufferOutput = true;
+                }
+            }
         }
     }
 
-    if(namesOnly){
-        foreach(const boost::shared_ptr<chemkit::Molecule> &molecule, outputFile.molecules()){
-            std::cout << molecule->name() << "\n";
+    if(!reader.errorString().empty()){
+        std::cerr << "Error: failed to read input file: " << reader.errorString() << std::endl;
+        return -1;
+    }
+
+    if(buildIndex){
+        if(!indexWriter.finish()){
+            std::cerr << "Warning: failed to write screen index: " << indexFileName << std::endl;
         }
     }
-    else{
-        bool ok = outputFile.write(std::cout, inputFile.formatName());
+
+    if(bufferOutput){
+        bool ok = outputFile.write(std::cout, outputFormat.get());
         if(!ok){
             std::cerr << "Error: failed to write output file: " << outputFile.errorString() << std::endl;
             return -1;
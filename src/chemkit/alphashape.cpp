@@ -54,6 +54,12 @@ public:
 /// \ingroup chemkit
 /// \internal
 /// \brief The AlphaShape class represents an alpha shape.
+///
+/// The alpha value at which each simplex enters the alpha shape is
+/// calculated once, the first time the simplices are requested.
+/// Changing the alpha value afterwards only selects the simplices
+/// with a lower alpha value and does not recalculate the delaunay
+/// triangulation.
 
 // --- Construction and Destruction ---------------------------------------- //
 /// Creates a new alpha shape with \p points.
@@ -98,7 +104,8 @@ Real AlphaShape::weight(int vertex) const
     return d->triangulation->weight(vertex);
 }
 
-/// Sets the alpha value to \p alphaValue.
+/// Sets the alpha value to \p alphaValue. The default alpha value
+/// is \c 0.
 void AlphaShape::setAlphaValue(Real alphaValue)
 {
     d->alphaValue = alphaValue;
@@ -101,6 +101,9 @@ void Atom::setAtomicNumber(AtomicNumberType atomicNumber)
     }
 
     m_molecule->m_elements[m_index].setAtomicNumber(atomicNumber);
+
+    // ring aromaticity depends on elements
+    m_molecule->d->ringAromaticity.clear();
     m_molecule->notifyWatchers(this, MoleculeWatcher::AtomElementChanged);
 }
 
@@ -392,7 +395,7 @@ bool Atom::isTerminalHydrogen() const
 /// Returns the ring at \p index for the atom.
 Ring* Atom::ring(size_t index) const
 {
-    return rings().advance_begin(index).front();
+    return m_molecule->atomRings(this)[index];
 }
 
 /// Returns a range containing all of the rings that contain the
@@ -401,56 +404,27 @@ Ring* Atom::ring(size_t index) const
 /// \see Molecule::rings()
 Atom::RingRange Atom::rings() const
 {
-    // range of all rings in the molecule
-    const Molecule::RingRange moleculeRings = m_molecule->rings();
-
-    // predicate function to check if a ring contains this atom
-    boost::function<bool (const Ring *)> ringContainsThisAtom =
-        boost::bind(static_cast<bool (Ring::*)(const Atom *) const>(&Ring::contains), _1, this);
-
-    return boost::make_iterator_range(
-               boost::make_filter_iterator<
-                   boost::function<bool (const Ring *)> >(ringContainsThisAtom,
-                                                          moleculeRings.begin(),
-                                                          moleculeRings.end()),
-               boost::make_filter_iterator<
-                    boost::function<bool (const Ring *)> >(ringContainsThisAtom,
-                                                           moleculeRings.end(),
-                                                           moleculeRings.end()));
+    return boost::make_iterator_range(m_molecule->atomRings(this));
 }
 
 /// Returns the number of rings that contain the atom.
 size_t Atom::ringCount() const
 {
-    size_t count = 0;
-
-    foreach(const Ring *ring, m_molecule->rings()){
-        if(ring->contains(this)){
-            count++;
-        }
-    }
-
-    return count;
+    return m_molecule->atomRings(this).size();
 }
 
 /// Returns \c true if the atom is a member of at least one ring
 /// (i.e. ringCount() >= 1).
 bool Atom::isInRing() const
 {
-    foreach(const Ring *ring, m_molecule->rings()){
-        if(ring->contains(this)){
-            return true;
-        }
-    }
-
-    return false;
+    return !m_molecule->atomRings(this).empty();
 }
 
 /// Returns \c true if the atom is a member of a ring of given size.
 bool Atom::isInRing(size_t size) const
 {
-    foreach(const Ring *ring, m_molecule->rings()){
-        if(ring->size() == size && ring->contains(this)){
+    foreach(const Ring *ring, rings()){
+        if(ring->size() == size){
             return true;
         }
     }
@@ -69,11 +69,7 @@ public:
                 boost::transform_iterator<
                     boost::function<Atom* (Bond *)>,
                     std::vector<Bond *>::const_iterator> > NeighborRange;
-    typedef boost::iterator_range<
-                boost::filter_iterator<
-                    boost::function<bool (const Ring *)>,
-                    boost::iterator_range<
-                        std::vector<Ring *>::const_iterator>::const_iterator> > RingRange;
+    typedef boost::iterator_range<std::vector<Ring *>::const_iterator> RingRange;
 
     // properties
     void setElement(const Element &element);
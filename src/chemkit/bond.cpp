@@ -35,8 +35,6 @@
 
 #include "bond.h"
 
-#include <boost/bind.hpp>
-
 #include "atom.h"
 #include "ring.h"
 #include "foreach.h"
@@ -109,6 +107,9 @@ void Bond::setOrder(BondOrderType order)
 {
     m_molecule->d->bondOrders[m_index] = order;
 
+    // ring aromaticity depends on bond orders
+    m_molecule->d->ringAromaticity.clear();
+
     molecule()->notifyWatchers(this, MoleculeWatcher::BondOrderChanged);
 }
 
@@ -199,7 +200,7 @@ bool Bond::isTerminal() const
 /// Returns the ring at \p index for the bond.
 Ring* Bond::ring(size_t index) const
 {
-    return rings().advance_begin(index).front();
+    return m_molecule->bondRings(this)[index];
 }
 
 /// Returns a range containing all of the rings that contain the
@@ -208,56 +209,27 @@ Ring* Bond::ring(size_t index) const
 /// \see Molecule::rings()
 Bond::RingRange Bond::rings() const
 {
-    // range of all rings in the molecule
-    const Molecule::RingRange moleculeRings = m_molecule->rings();
-
-    // predicate function to check if a ring contains this bond
-    boost::function<bool (const Ring *)> ringContainsThisBond =
-        boost::bind(static_cast<bool (Ring::*)(const Bond *) const>(&Ring::contains), _1, this);
-
-    return boost::make_iterator_range(
-               boost::make_filter_iterator<
-                   boost::function<bool (const Ring *)> >(ringContainsThisBond,
-                                                          moleculeRings.begin(),
-                                                          moleculeRings.end()),
-               boost::make_filter_iterator<
-                    boost::function<bool (const Ring *)> >(ringContainsThisBond,
-                                                           moleculeRings.end(),
-                                                           moleculeRings.end()));
+    return boost::make_iterator_range(m_molecule->bondRings(this));
 }
 
 /// Returns the number of rings that contain the bond.
 size_t Bond::ringCount() const
 {
-    size_t count = 0;
-
-    foreach(const Ring *ring, m_molecule->rings()){
-        if(ring->contains(this)){
-            count++;
-        }
-    }
-
-    return count;
+    return m_molecule->bondRings(this).size();
 }
 
 /// Returns \c true if the bond is a member of at least one ring.
 /// (i.e. ringCount() >= 1).
 bool Bond::isInRing() const
 {
-    foreach(const Ring *ring, molecule()->rings()){
-        if(ring->contains(this)){
-            return true;
-        }
-    }
-
-    return false;
+    return !m_molecule->bondRings(this).empty();
 }
 
 /// Returns \c true if the bond is in a ring of given size.
 bool Bond::isInRing(size_t size) const
 {
-    foreach(const Ring *ring, molecule()->rings()){
-        if(ring->size() == size && ring->contains(this)){
+    foreach(const Ring *ring, rings()){
+        if(ring->size() == size){
             return true;
         }
     }
@@ -61,11 +61,7 @@ class CHEMKIT_EXPORT Bond
 public:
     // typedefs
     typedef unsigned char BondOrderType;
-    typedef boost::iterator_range<
-                boost::filter_iterator<
-                    boost::function<bool (const Ring *)>,
-                    boost::iterator_range<
-                        std::vector<Ring *>::const_iterator>::const_iterator> > RingRange;
+    typedef boost::iterator_range<std::vector<Ring *>::const_iterator> RingRange;
 
     // enumerations
     enum BondType{
@@ -37,6 +37,7 @@
 
 #include "atom.h"
 #include "foreach.h"
+#include "celllist.h"
 #include "molecule.h"
 
 namespace chemkit {
@@ -68,6 +69,8 @@ public:
 /// \endcode
 ///
 /// This class implements the \blueobeliskalgorithm{rebondFrom3DCoordinates}.
+/// Only pairs of atoms close enough to be bonded are checked so the
+/// time taken grows linearly with the number of atoms.
 
 /// \typedef BondPredictor::PredictedBond;
 /// This tuple contains information about each predicted bond.
@@ -155,11 +158,25 @@ std::vector<BondPredictor::PredictedBond> BondPredictor::predictedBonds()
 
     std::vector<Atom *> atoms(d->molecule->atoms().begin(), d->molecule->atoms().end());
 
-    for(unsigned int i = 0; i < atoms.size(); i++){
-        for(unsigned int j = i+1; j < atoms.size(); j++){
-            if(couldBeBonded(atoms[i], atoms[j])){
-                bonds.push_back(boost::make_tuple(atoms[i], atoms[j], Bond::Single));
-            }
+    // bonded atoms are never further apart than the sum of their
+    // covalent radii plus the tolerance
+    std::vector<Point3> positions(atoms.size());
+    Real maximumCovalentRadius = 0;
+    for(size_t i = 0; i < atoms.size(); i++){
+        positions[i] = atoms[i]->position();
+        maximumCovalentRadius = std::max(maximumCovalentRadius, atoms[i]->covalentRadius());
+    }
+
+    Real maximumDistance = std::min(maximumBondLength(), 2 * maximumCovalentRadius + tolerance());
+
+    CellList cellList(positions, maximumDistance);
+
+    foreach(const CellList::Pair &pair, cellList.pairs(maximumDistance)){
+        Atom *a = atoms[pair.first];
+        Atom *b = atoms[pair.second];
+
+        if(couldBeBonded(a, b)){
+            bonds.push_back(boost::make_tuple(a, b, Bond::Single));
         }
     }
 
@@ -0,0 +1,442 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "celllist.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include <Eigen/LU>
+
+#include "foreach.h"
+#include "unitcell.h"
+
+namespace chemkit {
+
+// === CellListPrivate ===================================================== //
+class CellListPrivate
+{
+public:
+    std::vector<Point3> points;
+    Real cellSize;
+    size_t cellCounts[3];
+
+    // points sorted by cell. the points in cell c are
+    // cellPoints[cellStarts[c]] to cellPoints[cellStarts[c+1]]
+    std::vector<size_t> cellStarts;
+    std::vector<size_t> cellPoints;
+
+    // non-periodic grid origin
+    Point3 origin;
+
+    // periodic unit cell vectors as columns and their inverse
+    bool periodic;
+    Eigen::Matrix<Real, 3, 3> box;
+    Eigen::Matrix<Real, 3, 3> inverseBox;
+    Real cellWidths[3];
+};
+
+// === CellList ============================================================ //
+/// \class CellList celllist.h chemkit/celllist.h
+/// \ingroup chemkit
+/// \brief The CellList class provides a spatial index for finding
+///        nearby points.
+///
+/// The points are sorted into a uniform grid of cubic cells. A query
+/// for the points within some distance only checks the points in
+/// the cells overlapping the query sphere, so finding the neighbors
+/// of every point takes linear time when the query distance is
+/// close to the cell size.
+///
+/// The following example finds every pair of atoms within 3
+/// Angstroms of each other:
+/// \code
+/// std::vector<Point3> points;
+/// foreach(const Atom *atom, molecule->atoms()){
+///     points.push_back(atom->position());
+/// }
+///
+/// CellList cellList(points, 3.0);
+/// foreach(const CellList::Pair &pair, cellList.pairs(3.0)){
+///     ...
+/// }
+/// \endcode
+///
+/// If a unit cell is given the points are treated as periodic and
+/// distances are measured to the nearest periodic image. The grid
+/// then divides the unit cell along each of its vectors.
+
+/// \typedef CellList::Pair
+/// The indices of two points with the lower index first.
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new cell list containing \p points with cells of
+/// \p cellSize Angstroms.
+///
+/// The cell size may be increased for sparse sets of points in
+/// order to limit the number of cells.
+CellList::CellList(const std::vector<Point3> &points, Real cellSize)
+    : d(new CellListPrivate)
+{
+    d->points = points;
+    d->periodic = false;
+
+    build(cellSize);
+}
+
+/// Creates a new periodic cell list containing \p points in
+/// \p unitCell with cells of at least \p cellSize Angstroms.
+CellList::CellList(const std::vector<Point3> &points, Real cellSize, const UnitCell &unitCell)
+    : d(new CellListPrivate)
+{
+    d->points = points;
+    d->periodic = true;
+    d->box.col(0) = unitCell.x();
+    d->box.col(1) = unitCell.y();
+    d->box.col(2) = unitCell.z();
+    d->inverseBox = d->box.inverse();
+
+    build(cellSize);
+}
+
+/// Destroys the cell list object.
+CellList::~CellList()
+{
+    delete d;
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Returns the number of points in the cell list.
+size_t CellList::size() const
+{
+    return d->points.size();
+}
+
+/// Returns \c true if the cell list contains no points.
+bool CellList::isEmpty() const
+{
+    return d->points.empty();
+}
+
+/// Returns the position of the point at \p index.
+Point3 CellList::position(size_t index) const
+{
+    return d->points[index];
+}
+
+/// Returns the size of the cells. For periodic cell lists this is
+/// the smallest width of the cells.
+Real CellList::cellSize() const
+{
+    return d->cellSize;
+}
+
+/// Returns \c true if the cell list is periodic.
+bool CellList::isPeriodic() const
+{
+    return d->periodic;
+}
+
+// --- Geometry ------------------------------------------------------------ //
+/// Returns the vector from \p a to \p b. For periodic cell lists
+/// the vector to the nearest image of \p b is returned.
+Vector3 CellList::displacement(const Point3 &a, const Point3 &b) const
+{
+    Vector3 vector = b - a;
+
+    if(d->periodic){
+        Vector3 fractional = d->inverseBox * vector;
+        for(int axis = 0; axis < 3; axis++){
+            fractional[axis] -= std::floor(fractional[axis] + 0.5);
+        }
+
+        vector = d->box * fractional;
+    }
+
+    return vector;
+}
+
+/// Returns the distance between the points at \p i and \p j.
+Real CellList::distance(size_t i, size_t j) const
+{
+    return displacement(d->points[i], d->points[j]).norm();
+}
+
+// --- Queries ------------------------------------------------------------- //
+/// Returns the indices of the points within \p distance of \p point
+/// in ascending order.
+std::vector<size_t> CellList::neighbors(const Point3 &point, Real distance) const
+{
+    std::vector<size_t> neighbors;
+    std::vector<size_t> cells;
+    searchCells(point, distance, cells);
+
+    const Real distanceSquared = distance * distance;
+
+    foreach(size_t cell, cells){
+        for(size_t k = d->cellStarts[cell]; k < d->cellStarts[cell + 1]; k++){
+            size_t j = d->cellPoints[k];
+
+            if(displacement(point, d->points[j]).squaredNorm() <= distanceSquared){
+                neighbors.push_back(j);
+            }
+        }
+    }
+
+    std::sort(neighbors.begin(), neighbors.end());
+
+    return neighbors;
+}
+
+/// Returns the indices of the points within \p distance of the point
+/// at \p index in ascending order. The point itself is not included.
+std::vector<size_t> CellList::neighbors(size_t index, Real distance) const
+{
+    std::vector<size_t> neighbors = this->neighbors(d->points[index], distance);
+
+    neighbors.erase(std::remove(neighbors.begin(), neighbors.end(), index), neighbors.end());
+
+    return neighbors;
+}
+
+/// Returns every pair of points within \p distance of each other.
+/// The pairs are sorted by their first and then second index.
+std::vector<CellList::Pair> CellList::pairs(Real distance) const
+{
+    std::vector<Pair> pairs;
+    std::vector<size_t> cells;
+    std::vector<size_t> neighbors;
+
+    const Real distanceSquared = distance * distance;
+
+    for(size_t i = 0; i < d->points.size(); i++){
+        const Point3 &point = d->points[i];
+        searchCells(point, distance, cells);
+
+        neighbors.clear();
+        foreach(size_t cell, cells){
+            for(size_t k = d->cellStarts[cell]; k < d->cellStarts[cell + 1]; k++){
+                size_t j = d->cellPoints[k];
+
+                if(j > i && displacement(point, d->points[j]).squaredNorm() <= distanceSquared){
+                    neighbors.push_back(j);
+                }
+            }
+        }
+
+        std::sort(neighbors.begin(), neighbors.end());
+
+        foreach(size_t j, neighbors){
+            pairs.push_back(Pair(i, j));
+        }
+    }
+
+    return pairs;
+}
+
+// --- Internal Methods ---------------------------------------------------- //
+// Sorts the points into cells.
+void CellList::build(Real cellSize)
+{
+    const size_t size = d->points.size();
+    cellSize = std::max(cellSize, Real(0.1));
+
+    // cell index of each point along each axis
+    std::vector<Vector3> coordinates(size);
+
+    if(d->periodic){
+        // divide each unit cell vector so that the distance between
+        // opposite faces of a cell is at least the cell size
+        Real volume = std::abs(d->box.determinant());
+        Vector3 x = d->box.col(0);
+        Vector3 y = d->box.col(1);
+        Vector3 z = d->box.col(2);
+
+        Real widths[3];
+        widths[0] = volume / y.cross(z).norm();
+        widths[1] = volume / z.cross(x).norm();
+        widths[2] = volume / x.cross(y).norm();
+
+        // limit the number of cells for sparse systems
+        for(;;){
+            for(int axis = 0; axis < 3; axis++){
+                d->cellCounts[axis] = std::max<size_t>(static_cast<size_t>(widths[axis] / cellSize), 1);
+            }
+
+            if(d->cellCounts[0] * d->cellCounts[1] * d->cellCounts[2] <= 8 * size + 64){
+                break;
+            }
+
+            cellSize *= 2;
+        }
+
+        d->cellSize = widths[0] / d->cellCounts[0];
+        for(int axis = 0; axis < 3; axis++){
+            d->cellWidths[axis] = widths[axis] / d->cellCounts[axis];
+            d->cellSize = std::min(d->cellSize, d->cellWidths[axis]);
+        }
+
+        for(size_t i = 0; i < size; i++){
+            Vector3 fractional = d->inverseBox * d->points[i];
+
+            for(int axis = 0; axis < 3; axis++){
+                fractional[axis] -= std::floor(fractional[axis]);
+                coordinates[i][axis] = fractional[axis] * d->cellCounts[axis];
+            }
+        }
+    }
+    else{
+        Point3 minimum = size ? d->points[0] : Point3(0, 0, 0);
+        Point3 maximum = minimum;
+        for(size_t i = 1; i < size; i++){
+            minimum = minimum.cwiseMin(d->points[i]);
+            maximum = maximum.cwiseMax(d->points[i]);
+        }
+
+        Vector3 extent = maximum - minimum;
+
+        // limit the number of cells for sparse systems
+        for(;;){
+            for(int axis = 0; axis < 3; axis++){
+                d->cellCounts[axis] = static_cast<size_t>(extent[axis] / cellSize) + 1;
+            }
+
+            if(d->cellCounts[0] * d->cellCounts[1] * d->cellCounts[2] <= 8 * size + 64){
+                break;
+            }
+
+            cellSize *= 2;
+        }
+
+        d->origin = minimum;
+        d->cellSize = cellSize;
+
+        for(size_t i = 0; i < size; i++){
+            coordinates[i] = (d->points[i] - d->origin) / cellSize;
+        }
+    }
+
+    // sort the points into cells
+    size_t cellCount = d->cellCounts[0] * d->cellCounts[1] * d->cellCounts[2];
+    std::vector<size_t> pointCells(size);
+
+    d->cellStarts.assign(cellCount + 1, 0);
+    for(size_t i = 0; i < size; i++){
+        size_t cell[3];
+        for(int axis = 0; axis < 3; axis++){
+            cell[axis] = std::min(static_cast<size_t>(std::max(coordinates[i][axis], Real(0))), d->cellCounts[axis] - 1);
+        }
+
+        pointCells[i] = (cell[2] * d->cellCounts[1] + cell[1]) * d->cellCounts[0] + cell[0];
+        d->cellStarts[pointCells[i] + 1]++;
+    }
+
+    for(size_t cell = 0; cell < cellCount; cell++){
+        d->cellStarts[cell + 1] += d->cellStarts[cell];
+    }
+
+    std::vector<size_t> cellOffsets(d->cellStarts.begin(), d->cellStarts.end() - 1);
+    d->cellPoints.resize(size);
+    for(size_t i = 0; i < size; i++){
+        d->cellPoints[cellOffsets[pointCells[i]]++] = i;
+    }
+}
+
+// Sets cells to the indices of the cells which overlap the sphere
+// with radius distance around point.
+void CellList::searchCells(const Point3 &point, Real distance, std::vector<size_t> &cells) const
+{
+    cells.clear();
+
+    // range of cells to search along each axis
+    long begin[3];
+    long end[3];
+
+    if(d->periodic){
+        Vector3 fractional = d->inverseBox * point;
+
+        for(int axis = 0; axis < 3; axis++){
+            long count = d->cellCounts[axis];
+            long cell = static_cast<long>(std::floor((fractional[axis] - std::floor(fractional[axis])) * count));
+            long reach = static_cast<long>(std::ceil(distance / d->cellWidths[axis]));
+
+            if(2 * reach + 1 >= count){
+                // search every cell along the axis once
+                begin[axis] = 0;
+                end[axis] = count - 1;
+            }
+            else{
+                begin[axis] = cell - reach;
+                end[axis] = cell + reach;
+            }
+        }
+    }
+    else{
+        Vector3 coordinates = (point - d->origin) / d->cellSize;
+        Real reach = distance / d->cellSize;
+
+        for(int axis = 0; axis < 3; axis++){
+            long last = d->cellCounts[axis] - 1;
+
+            begin[axis] = std::max(static_cast<long>(std::floor(coordinates[axis] - reach)), 0L);
+            end[axis] = std::min(static_cast<long>(std::floor(coordinates[axis] + reach)), last);
+
+            if(coordinates[axis] + reach < 0 || coordinates[axis] - reach > last + 1){
+                return;
+            }
+        }
+    }
+
+    const long countX = d->cellCounts[0];
+    const long countY = d->cellCounts[1];
+    const long countZ = d->cellCounts[2];
+
+    // cells outside of a periodic unit cell wrap around
+    for(long z = begin[2]; z <= end[2]; z++){
+        long cz = ((z % countZ) + countZ) % countZ;
+
+        for(long y = begin[1]; y <= end[1]; y++){
+            long cy = ((y % countY) + countY) % countY;
+
+            for(long x = begin[0]; x <= end[0]; x++){
+                long cx = ((x % countX) + countX) % countX;
+
+                cells.push_back((cz * countY + cy) * countX + cx);
+            }
+        }
+    }
+}
+
+} // end chemkit namespace
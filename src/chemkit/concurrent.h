@@ -39,12 +39,32 @@
 #include "chemkit.h"
 
 #include <boost/thread.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "threadpool.h"
 
 namespace chemkit {
 namespace concurrent {
 
-/// Runs \p function asynchronously in a separate thread. Returns a
-/// future containing the value returned from \p function.
+/// \internal
+template<typename T>
+struct PackagedTaskRunner
+{
+    PackagedTaskRunner(const boost::shared_ptr<boost::packaged_task<T> > &task)
+        : m_task(task)
+    {
+    }
+
+    void operator()()
+    {
+        (*m_task)();
+    }
+
+    boost::shared_ptr<boost::packaged_task<T> > m_task;
+};
+
+/// Runs \p function asynchronously on the global thread pool. Returns
+/// a future containing the value returned from \p function.
 ///
 /// \internal
 template<typename Function>
@@ -52,11 +72,11 @@ inline boost::shared_future<typename Function::result_type> run(const Function &
 {
     typedef typename Function::result_type result_type;
 
-    boost::packaged_task<result_type> task(function);
-    boost::shared_future<result_type> future(task.get_future());
+    boost::shared_ptr<boost::packaged_task<result_type> > task(new boost::packaged_task<result_type>(function));
+    boost::shared_future<result_type> future(task->get_future());
 
-    // execute task in detached thread
-    boost::thread(boost::move(task)).detach();
+    // execute task on the global thread pool
+    ThreadPool::globalInstance()->start(PackagedTaskRunner<result_type>(task));
 
     return future;
 }
@@ -37,6 +37,7 @@
 
 #include "atom.h"
 #include "foreach.h"
+#include "celllist.h"
 #include "molecule.h"
 #include "concurrent.h"
 
@@ -133,25 +134,33 @@ bool CoordinatePredictor::eliminateCloseContacts(Molecule *molecule, Real distan
     bool done = false;
     bool modified = false;
 
+    std::vector<Point3> positions(molecule->size());
+
     while(!done){
         done = true;
 
         for(size_t i = 0; i < molecule->size(); i++){
-            Atom *a = molecule->atom(i);
+            positions[i] = molecule->atom(i)->position();
+        }
+
+        // find close contacts with a cell list. atoms may move while
+        // the contacts are eliminated so each distance is checked
+        // again before moving the atom.
+        CellList cellList(positions, distance);
 
-            for(size_t j = i + 1; j < molecule->size(); j++){
-                Atom *b = molecule->atom(j);
+        foreach(const CellList::Pair &pair, cellList.pairs(distance)){
+            Atom *a = molecule->atom(pair.first);
+            Atom *b = molecule->atom(pair.second);
 
-                if(a->distance(b) < distance){
-                    done = false;
+            if(a->distance(b) < distance){
+                done = false;
 
-                    // move atom b by a random unit vector
-                    b->setPosition(b->position() +
-                                   distance * Vector3::Random().normalized());
+                // move atom b by a random unit vector
+                b->setPosition(b->position() +
+                               distance * Vector3::Random().normalized());
 
-                    // set modified flag
-                    modified = true;
-                }
+                // set modified flag
+                modified = true;
             }
         }
     }
@@ -36,10 +36,17 @@
 #include "delaunaytriangulation.h"
 
 #include <set>
+#include <cmath>
 #include <deque>
 #include <vector>
+#include <limits>
 #include <algorithm>
 
+#include <boost/cstdint.hpp>
+#include <boost/multiprecision/cpp_int.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
 #include "point3.h"
 #include "foreach.h"
 #include "vector3.h"
@@ -140,6 +147,339 @@ DelaunayTriangulation::Triangle Tetrahedron::triangle(int index) const
     return triangle;
 }
 
+// === Spatial Sorting ===================================================== //
+// Returns the index of the point with integer coordinates x, y and z
+// along a three-dimensional hilbert curve of order bits. Uses the
+// algorithm from "Programming the Hilbert Curve" by John Skilling.
+boost::uint64_t hilbertIndex(boost::uint32_t x, boost::uint32_t y, boost::uint32_t z, int bits)
+{
+    boost::uint32_t X[3] = { x, y, z };
+
+    // inverse undo excess work
+    for(boost::uint32_t Q = 1 << (bits - 1); Q > 1; Q >>= 1){
+        boost::uint32_t P = Q - 1;
+
+        for(int i = 0; i < 3; i++){
+            if(X[i] & Q){
+                X[0] ^= P;
+            }
+            else{
+                boost::uint32_t t = (X[0] ^ X[i]) & P;
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+
+    // gray encode
+    X[1] ^= X[0];
+    X[2] ^= X[1];
+
+    boost::uint32_t t = 0;
+    for(boost::uint32_t Q = 1 << (bits - 1); Q > 1; Q >>= 1){
+        if(X[2] & Q){
+            t ^= Q - 1;
+        }
+    }
+
+    for(int i = 0; i < 3; i++){
+        X[i] ^= t;
+    }
+
+    // interleave the bits of the transposed index
+    boost::uint64_t index = 0;
+    for(int bit = bits - 1; bit >= 0; bit--){
+        for(int i = 0; i < 3; i++){
+            index = (index << 1) | ((X[i] >> bit) & 1);
+        }
+    }
+
+    return index;
+}
+
+// Returns the order to insert points in. The points are shuffled and
+// split into rounds which double in size (a biased randomized
+// insertion order) and the points in each round are sorted along a
+// hilbert curve. This keeps consecutive points close together while
+// retaining the expected running time of a random insertion order.
+std::vector<int> insertionOrder(const std::vector<Point3> &points, int count)
+{
+    std::vector<int> order(count);
+    for(int i = 0; i < count; i++){
+        order[i] = i;
+    }
+
+    if(count < 2){
+        return order;
+    }
+
+    // shuffle with a fixed seed so the triangulation is reproducible
+    boost::random::mt19937 generator(count);
+    for(int i = count - 1; i > 0; i--){
+        boost::random::uniform_int_distribution<int> distribution(0, i);
+        std::swap(order[i], order[distribution(generator)]);
+    }
+
+    // hilbert index of each point on a 2^10 grid over the bounding box
+    const int bits = 10;
+    Point3 minimum = points[0];
+    Point3 maximum = points[0];
+    for(int i = 1; i < count; i++){
+        minimum = minimum.cwiseMin(points[i]);
+        maximum = maximum.cwiseMax(points[i]);
+    }
+
+    Real extent = (maximum - minimum).maxCoeff();
+    Real scale = extent > 0 ? ((1 << bits) - 1) / extent : 0;
+
+    std::vector<std::pair<boost::uint64_t, int> > keys(count);
+    for(int i = 0; i < count; i++){
+        const Point3 &point = points[order[i]];
+
+        keys[i].first = hilbertIndex(static_cast<boost::uint32_t>((point.x() - minimum.x()) * scale),
+                                     static_cast<boost::uint32_t>((point.y() - minimum.y()) * scale),
+                                     static_cast<boost::uint32_t>((point.z() - minimum.z()) * scale),
+                                     bits);
+        keys[i].second = order[i];
+    }
+
+    // sort each round along the curve
+    int end = count;
+    while(end > 0){
+        int begin = end > 64 ? end / 2 : 0;
+        std::sort(keys.begin() + begin, keys.begin() + end);
+        end = begin;
+    }
+
+    for(int i = 0; i < count; i++){
+        order[i] = keys[i].second;
+    }
+
+    return order;
+}
+
+// === Predicates ========================================================== //
+// Integer type used to evaluate the predicates exactly. The inputs are
+// converted to integers by scaling them with a common power of two.
+// With the 53 bit significands and binary exponents of doubles this
+// bounds the scaled coordinate differences to 2151 bits and the 4x4
+// determinant in powerSign() to 10763 bits. Being of fixed width the
+// type never allocates and only the limbs in use take part in the
+// arithmetic.
+typedef boost::multiprecision::number<
+    boost::multiprecision::cpp_int_backend<10816,
+                                           10816,
+                                           boost::multiprecision::signed_magnitude,
+                                           boost::multiprecision::unchecked,
+                                           void> > Exact;
+
+// Returns the exponent of the least significant bit of the significand
+// of x. Every double is an integer multiple of two to this power.
+int lowestExponent(double x)
+{
+    int exponent;
+    std::frexp(x, &exponent);
+
+    return exponent - std::numeric_limits<double>::digits;
+}
+
+// Returns x divided by two to the power of exponent as an exact
+// integer. The exponent must not be larger than lowestExponent(x).
+Exact scaledInteger(double x, int exponent)
+{
+    int xExponent;
+    double fraction = std::frexp(std::abs(x), &xExponent);
+
+    Exact value = static_cast<boost::int64_t>(std::ldexp(fraction, std::numeric_limits<double>::digits));
+    value <<= xExponent - std::numeric_limits<double>::digits - exponent;
+
+    return x < 0 ? Exact(-value) : value;
+}
+
+// Returns the determinant of the 3x3 matrix with rows t, u and v.
+template<typename T>
+T determinant(const T t[3], const T u[3], const T v[3])
+{
+    return t[0] * (u[1] * v[2] - u[2] * v[1]) -
+           t[1] * (u[0] * v[2] - u[2] * v[0]) +
+           t[2] * (u[0] * v[1] - u[1] * v[0]);
+}
+
+// Returns the determinant of the 4x4 matrix with rows (t, lt), (u, lu),
+// (v, lv) and (w, lw) expanded along its last column.
+template<typename T>
+T determinant(const T t[3], const T u[3], const T v[3], const T w[3], T lt, T lu, T lv, T lw)
+{
+    return -lt * determinant(u, v, w) +
+            lu * determinant(t, v, w) -
+            lv * determinant(t, u, w) +
+            lw * determinant(t, u, v);
+}
+
+// Returns the permanent of the 3x3 matrix with rows t, u and v.
+template<typename T>
+T permanent(const T t[3], const T u[3], const T v[3])
+{
+    return t[0] * (u[1] * v[2] + u[2] * v[1]) +
+           t[1] * (u[0] * v[2] + u[2] * v[0]) +
+           t[2] * (u[0] * v[1] + u[1] * v[0]);
+}
+
+// Returns the sign of x.
+template<typename T>
+int sign(const T &x)
+{
+    return x > 0 ? 1 : (x < 0 ? -1 : 0);
+}
+
+// The predicates below are first evaluated in double precision. If
+// the result is smaller than a bound on its rounding error, which is
+// the permanent of the matrix times a small multiple of the machine
+// epsilon, the determinant is evaluated again with exact integer
+// arithmetic. This only happens for (nearly) degenerate sets of
+// points where the double precision result can not be trusted.
+const double errorBound = 64 * std::numeric_limits<double>::epsilon();
+
+// Returns the sign of the orientation of p with respect to the plane
+// through a, b and c. This is the sign of planeOrientation(a, b, c, p)
+// computed exactly.
+int orientationSign(const Point3 &a, const Point3 &b, const Point3 &c, const Point3 &p)
+{
+    const Point3 *points[3] = { &a, &b, &c };
+
+    double t[3][3];
+    double absolute[3][3];
+    for(int i = 0; i < 3; i++){
+        for(int j = 0; j < 3; j++){
+            t[i][j] = static_cast<double>((*points[i])[j]) - static_cast<double>(p[j]);
+            absolute[i][j] = std::abs(t[i][j]);
+        }
+    }
+
+    double value = determinant(t[0], t[1], t[2]);
+    if(std::abs(value) > errorBound * permanent(absolute[0], absolute[1], absolute[2])){
+        return sign(value);
+    }
+
+    int exponent = 0;
+    for(int j = 0; j < 3; j++){
+        exponent = std::min(exponent, lowestExponent(p[j]));
+
+        for(int i = 0; i < 3; i++){
+            exponent = std::min(exponent, lowestExponent((*points[i])[j]));
+        }
+    }
+
+    Exact exact[3][3];
+    for(int j = 0; j < 3; j++){
+        Exact origin = scaledInteger(p[j], exponent);
+
+        for(int i = 0; i < 3; i++){
+            exact[i][j] = scaledInteger((*points[i])[j], exponent) - origin;
+        }
+    }
+
+    return sign(determinant(exact[0], exact[1], exact[2]));
+}
+
+// Returns the sign of the power test of the weighted point p with
+// respect to the orthosphere of a, b, c and d. This is the sign of
+// sphereOrientation(a, b, c, d, p, wa, wb, wc, wd, wp) computed
+// exactly.
+int powerSign(const Point3 *points[5], const Real weights[5])
+{
+    const Point3 &p = *points[4];
+
+    double t[4][3];
+    double lifted[4];
+    double absolute[4][3];
+    double liftedAbsolute[4];
+    for(int i = 0; i < 4; i++){
+        for(int j = 0; j < 3; j++){
+            t[i][j] = static_cast<double>((*points[i])[j]) - static_cast<double>(p[j]);
+            absolute[i][j] = std::abs(t[i][j]);
+        }
+
+        double weight = static_cast<double>(weights[i]) - static_cast<double>(weights[4]);
+        lifted[i] = t[i][0] * t[i][0] + t[i][1] * t[i][1] + t[i][2] * t[i][2] - weight;
+        liftedAbsolute[i] = t[i][0] * t[i][0] + t[i][1] * t[i][1] + t[i][2] * t[i][2] + std::abs(weight);
+    }
+
+    double value = determinant(t[0], t[1], t[2], t[3], lifted[0], lifted[1], lifted[2], lifted[3]);
+    double bound = errorBound * (liftedAbsolute[0] * permanent(absolute[1], absolute[2], absolute[3]) +
+                                 liftedAbsolute[1] * permanent(absolute[0], absolute[2], absolute[3]) +
+                                 liftedAbsolute[2] * permanent(absolute[0], absolute[1], absolute[3]) +
+                                 liftedAbsolute[3] * permanent(absolute[0], absolute[1], absolute[2]));
+    if(std::abs(value) > bound){
+        return sign(value);
+    }
+
+    // the weights are scaled by the square of the coordinate scale
+    int exponent = 0;
+    for(int i = 0; i < 5; i++){
+        for(int j = 0; j < 3; j++){
+            exponent = std::min(exponent, lowestExponent((*points[i])[j]));
+        }
+
+        exponent = std::min(exponent, static_cast<int>(std::floor(lowestExponent(weights[i]) / 2.0)));
+    }
+
+    Exact origin[3];
+    for(int j = 0; j < 3; j++){
+        origin[j] = scaledInteger(p[j], exponent);
+    }
+
+    Exact exact[4][3];
+    Exact exactLifted[4];
+    for(int i = 0; i < 4; i++){
+        for(int j = 0; j < 3; j++){
+            exact[i][j] = scaledInteger((*points[i])[j], exponent) - origin[j];
+        }
+
+        exactLifted[i] = exact[i][0] * exact[i][0] + exact[i][1] * exact[i][1] + exact[i][2] * exact[i][2] -
+                         (scaledInteger(weights[i], 2 * exponent) - scaledInteger(weights[4], 2 * exponent));
+    }
+
+    return sign(determinant(exact[0], exact[1], exact[2], exact[3], exactLifted[0], exactLifted[1], exactLifted[2], exactLifted[3]));
+}
+
+// === Alpha Shape Filtration ============================================== //
+// Returns the alpha value for a simplex with orthoradius value. Simplices
+// with an undefined orthoradius are never in the alpha shape.
+Real filtrationValue(Real value)
+{
+    return value == value ? value : std::numeric_limits<Real>::infinity();
+}
+
+template<typename T>
+bool compareFiltrationValues(const std::pair<Real, T> &a, const std::pair<Real, T> &b)
+{
+    return a.first < b.first;
+}
+
+// Sets subset to the simplices with an alpha value less than alpha.
+template<typename T>
+void filtrationSubset(const std::vector<Real> &values, const std::vector<T> &simplices, Real alpha, std::vector<T> &subset)
+{
+    size_t count = std::lower_bound(values.begin(), values.end(), alpha) - values.begin();
+
+    subset.assign(simplices.begin(), simplices.begin() + count);
+}
+
+// Returns the index of the vertex in tetrahedron that is not in triangle.
+int oppositeVertex(const Tetrahedron &tetrahedron, const DelaunayTriangulation::Triangle &triangle)
+{
+    for(int i = 0; i < 4; i++){
+        int vertex = tetrahedron.vertices[i];
+
+        if(vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2]){
+            return i;
+        }
+    }
+
+    return 0;
+}
+
 } // end anonymous namespace
 
 // === DelaunayTriangulationPrivate ======================================== //
@@ -149,15 +489,39 @@ public:
     std::vector<Point3> vertices;
     std::vector<Real> weights;
     std::vector<Tetrahedron> tetrahedra;
-
-    bool alphaShapeCalculated;
+    std::vector<int> freeTetrahedra;
+    int lastTetrahedron;
+
+    // scratch buffers reused for each inserted point
+    std::vector<unsigned int> tetrahedronStamps;
+    unsigned int stamp;
+    std::vector<int> conflictTetrahedra;
+    std::vector<int> conflictQueue;
+    std::vector<int> newTetrahedra;
+    std::vector<std::pair<std::pair<int, int>, std::pair<int, int> > > newFaces;
 
     std::vector<DelaunayTriangulation::Edge> delaunayEdges;
     std::vector<DelaunayTriangulation::Triangle> delaunayTriangles;
     std::vector<std::vector<int> > delaunayTetrahedra;
 
+    // alpha shape filtration. each simplex is stored with the
+    // smallest alpha value at which it is in the alpha shape and
+    // the simplices are sorted by that value.
+    bool alphaShapeCalculated;
+    std::vector<Real> filtrationEdgeValues;
+    std::vector<DelaunayTriangulation::Edge> filtrationEdges;
+    std::vector<Real> filtrationTriangleValues;
+    std::vector<DelaunayTriangulation::Triangle> filtrationTriangles;
+    std::vector<Real> filtrationTetrahedronValues;
+    std::vector<std::vector<int> > filtrationTetrahedra;
+
+    // simplices in the alpha shape for the alpha value they were
+    // last requested with
+    Real alphaShapeEdgesValue;
     std::vector<DelaunayTriangulation::Edge> alphaShapeEdges;
+    Real alphaShapeTrianglesValue;
     std::vector<DelaunayTriangulation::Triangle> alphaShapeTriangles;
+    Real alphaShapeTetrahedraValue;
     std::vector<std::vector<int> > alphaShapeTetrahedra;
 };
 
@@ -182,6 +546,9 @@ DelaunayTriangulation::DelaunayTriangulation(const std::vector<Point3> &points)
     d->vertices = points;
 
     d->alphaShapeCalculated = false;
+    d->alphaShapeEdgesValue = std::numeric_limits<Real>::quiet_NaN();
+    d->alphaShapeTrianglesValue = std::numeric_limits<Real>::quiet_NaN();
+    d->alphaShapeTetrahedraValue = std::numeric_limits<Real>::quiet_NaN();
 
     triangulate(false);
 }
@@ -195,6 +562,9 @@ DelaunayTriangulation::DelaunayTriangulation(const std::vector<Point3> &points,
     d->weights = weights;
 
     d->alphaShapeCalculated = false;
+    d->alphaShapeEdgesValue = std::numeric_limits<Real>::quiet_NaN();
+    d->alphaShapeTrianglesValue = std::numeric_limits<Real>::quiet_NaN();
+    d->alphaShapeTetrahedraValue = std::numeric_limits<Real>::quiet_NaN();
 
     triangulate(true);
 }
@@ -299,7 +669,7 @@ const std::vector<DelaunayTriangulation::Triangle>& DelaunayTriangulation::trian
             break;
         }
 
-        std::set<int> visited;
+        std::vector<bool> visited(d->tetrahedra.size(), false);
         std::deque<int> stack;
 
         stack.push_front(initialTetrahedron);
@@ -307,12 +677,12 @@ const std::vector<DelaunayTriangulation::Triangle>& DelaunayTriangulation::trian
         while(!stack.empty()){
             int index = stack.front();
             stack.pop_front();
-            visited.insert(index);
+            visited[index] = true;
             const Tetrahedron &tetrahedron = d->tetrahedra[index];
 
             for(int i = 0; i < 4; i++){
                 int neighborIndex = tetrahedron.neighbors[i];
-                if(neighborIndex == -1 || visited.count(neighborIndex)){
+                if(neighborIndex == -1 || visited[neighborIndex]){
                     continue;
                 }
 
@@ -402,207 +772,227 @@ Real DelaunayTriangulation::surfaceArea() const
 // --- Alpha Shape --------------------------------------------------------- //
 const std::vector<DelaunayTriangulation::Edge>& DelaunayTriangulation::alphaShapeEdges(const AlphaShape *alphaShape) const
 {
-    if(d->alphaShapeEdges.empty()){
-        std::vector<Edge> alphaShapeEdges;
-        EdgeSet alphaEdgeSet(d->vertices.size());
+    if(d->alphaShapeEdgesValue != alphaShape->alphaValue()){
+        calculateAlphaShape(alphaShape);
 
-        foreach(const Triangle &triangle, alphaShapeTriangles(alphaShape)){
-            for(int i = 0; i < 3; i++){
-                for(int j = i + 1; j < 3; j++){
-                    Edge edge;
-                    edge[0] = triangle[i];
-                    edge[1] = triangle[j];
+        filtrationSubset(d->filtrationEdgeValues,
+                         d->filtrationEdges,
+                         alphaShape->alphaValue(),
+                         d->alphaShapeEdges);
 
-                    if(!alphaEdgeSet.contains(edge[0], edge[1])){
-                        alphaShapeEdges.push_back(edge);
-                        alphaEdgeSet.insert(edge[0], edge[1]);
-                    }
-
-                }
-            }
-        }
+        d->alphaShapeEdgesValue = alphaShape->alphaValue();
+    }
 
-        EdgeSet attachedEdgeSet(d->vertices.size());
+    return d->alphaShapeEdges;
+}
 
-        foreach(const Triangle &triangle, triangles()){
-            int a = triangle[0];
-            int b = triangle[1];
-            int c = triangle[2];
+const std::vector<DelaunayTriangulation::Triangle>& DelaunayTriangulation::alphaShapeTriangles(const AlphaShape *alphaShape) const
+{
+    if(d->alphaShapeTrianglesValue != alphaShape->alphaValue()){
+        calculateAlphaShape(alphaShape);
 
-            if(alphaShape->edgeAttached(a, b, c))
-                attachedEdgeSet.insert(a, b);
+        filtrationSubset(d->filtrationTriangleValues,
+                         d->filtrationTriangles,
+                         alphaShape->alphaValue(),
+                         d->alphaShapeTriangles);
 
-            if(alphaShape->edgeAttached(a, c, b))
-                attachedEdgeSet.insert(a, c);
+        d->alphaShapeTrianglesValue = alphaShape->alphaValue();
+    }
 
-            if(alphaShape->edgeAttached(b, c, a))
-                attachedEdgeSet.insert(b, c);
-        }
+    return d->alphaShapeTriangles;
+}
 
-        foreach(const Edge &edge, edges()){
-            if(alphaEdgeSet.contains(edge[0], edge[1])){
-                continue;
-            }
-            else if(attachedEdgeSet.contains(edge[0], edge[1])){
-                continue;
-            }
+const std::vector<std::vector<int> >& DelaunayTriangulation::alphaShapeTetrahedra(const AlphaShape *alphaShape) const
+{
+    if(d->alphaShapeTetrahedraValue != alphaShape->alphaValue()){
+        calculateAlphaShape(alphaShape);
 
-            if(alphaShape->orthoradius(edge[0], edge[1]) < alphaShape->alphaValue()){
-                alphaShapeEdges.push_back(edge);
-            }
-        }
+        filtrationSubset(d->filtrationTetrahedronValues,
+                         d->filtrationTetrahedra,
+                         alphaShape->alphaValue(),
+                         d->alphaShapeTetrahedra);
 
-        d->alphaShapeEdges = alphaShapeEdges;
+        d->alphaShapeTetrahedraValue = alphaShape->alphaValue();
     }
 
-    return d->alphaShapeEdges;
+    return d->alphaShapeTetrahedra;
 }
 
-const std::vector<DelaunayTriangulation::Triangle>& DelaunayTriangulation::alphaShapeTriangles(const AlphaShape *alphaShape) const
+// Calculates the alpha shape filtration. The alpha value of each
+// tetrahedron is its orthoradius. A triangle is in the alpha shape
+// when either of its tetrahedra are or, if it is not attached, when
+// its own orthoradius is less than alpha. An edge is in the alpha
+// shape when any of its triangles are or, if it is not attached,
+// when its own orthoradius is less than alpha.
+void DelaunayTriangulation::calculateAlphaShape(const AlphaShape *alphaShape) const
 {
-    if(d->alphaShapeTriangles.empty()){
-        calculateAlphaShape(alphaShape);
+    if(d->alphaShapeCalculated){
+        return;
+    }
 
-        std::vector<Triangle> triangles;
+    const Real infinity = std::numeric_limits<Real>::infinity();
 
-        int initialTetrahedron = 0;
-        for(unsigned int i = 0; i < d->tetrahedra.size(); i++){
-            const Tetrahedron &tetrahedron = d->tetrahedra[i];
-            if(!tetrahedron.valid || isExternal(i)){
-                continue;
-            }
+    // tetrahedra
+    std::vector<Real> tetrahedronValues(d->tetrahedra.size(), infinity);
+    std::vector<std::pair<Real, int> > tetrahedra;
 
-            initialTetrahedron = i;
-            break;
+    for(unsigned int i = 0; i < d->tetrahedra.size(); i++){
+        const Tetrahedron &tetrahedron = d->tetrahedra[i];
+        if(!tetrahedron.valid || isExternal(i)){
+            continue;
         }
 
-        std::set<int> visited;
-        std::deque<int> stack;
+        int a = tetrahedron.vertices[0];
+        int b = tetrahedron.vertices[1];
+        int c = tetrahedron.vertices[2];
+        int d = tetrahedron.vertices[3];
 
-        stack.push_front(initialTetrahedron);
+        tetrahedronValues[i] = filtrationValue(alphaShape->orthoradius(a, b, c, d));
+        tetrahedra.push_back(std::make_pair(tetrahedronValues[i], i));
+    }
 
-        while(!stack.empty()){
-            int index = stack.front();
-            stack.pop_front();
-            visited.insert(index);
-            const Tetrahedron &tetrahedron = d->tetrahedra[index];
+    // triangles. each triangle is visited once, from the internal
+    // tetrahedron if it has one. triangles and edges which are only
+    // in external tetrahedra are included so that degenerate (e.g.
+    // planar) sets of points are handled.
+    const int vertexCount = d->vertices.size() - 4;
+    std::vector<std::pair<Real, Triangle> > triangles;
 
-            for(int triangleIndex = 0; triangleIndex < 4; triangleIndex++){
-                int neighborIndex = tetrahedron.neighbors[triangleIndex];
-                if(neighborIndex == -1 || visited.count(neighborIndex)){
-                    continue;
-                }
+    // edge of each triangle along with the triangle's alpha value
+    // and whether the edge is attached to the triangle's third vertex
+    std::vector<std::pair<std::pair<int, int>, std::pair<Real, bool> > > triangleEdges;
 
-                const Tetrahedron &neighbor = d->tetrahedra[neighborIndex];
+    for(unsigned int i = 0; i < d->tetrahedra.size(); i++){
+        const Tetrahedron &tetrahedron = d->tetrahedra[i];
+        if(!tetrahedron.valid){
+            continue;
+        }
+
+        bool external = isExternal(i);
+
+        for(int face = 0; face < 4; face++){
+            Triangle triangle = tetrahedron.triangle(face);
+
+            int va = triangle[0];
+            int vb = triangle[1];
+            int vc = triangle[2];
+
+            if(va >= vertexCount || vb >= vertexCount || vc >= vertexCount){
+                continue;
+            }
+
+            int neighborIndex = tetrahedron.neighbors[face];
+            if(neighborIndex != -1){
                 bool neighborExternal = isExternal(neighborIndex);
 
-                if(!neighborExternal){
-                    stack.push_front(neighborIndex);
-                }
-                else{
-                    visited.insert(neighborIndex);
+                if(external != neighborExternal ? external : neighborIndex < static_cast<int>(i)){
+                    continue;
                 }
+            }
 
-                Triangle triangle = tetrahedron.triangle(triangleIndex);
+            Real value = tetrahedronValues[i];
+            bool attached = false;
 
-                if(tetrahedron.inAlphaShape && (!neighborExternal && neighbor.inAlphaShape)){
-                    triangles.push_back(triangle);
-                }
-                else if(tetrahedron.inAlphaShape || (!neighborExternal && neighbor.inAlphaShape)){
-                    triangles.push_back(triangle);
+            int vd = tetrahedron.vertices[oppositeVertex(tetrahedron, triangle)];
+            if(vd < vertexCount){
+                attached = alphaShape->triangleAttached(va, vb, vc, vd);
+            }
+
+            if(neighborIndex != -1){
+                const Tetrahedron &neighbor = d->tetrahedra[neighborIndex];
+                value = std::min(value, tetrahedronValues[neighborIndex]);
+
+                int ve = neighbor.vertices[oppositeVertex(neighbor, triangle)];
+                if(!attached && ve < vertexCount){
+                    attached = alphaShape->triangleAttached(va, vb, vc, ve);
                 }
-                else{
-                    std::vector<int> tetrahedronVertices;
-                    std::vector<int> neighborVertices;
-                    for(int i = 0; i < 4; i++){
-                        tetrahedronVertices.push_back(tetrahedron.vertices[i]);
-                        neighborVertices.push_back(neighbor.vertices[i]);
-                    }
+            }
 
-                    for(int i = 0; i < 3; i++){
-                        tetrahedronVertices.erase(std::remove(tetrahedronVertices.begin(),
-                                                              tetrahedronVertices.end(),
-                                                              triangle[i]));
+            if(!attached){
+                value = std::min(value, filtrationValue(alphaShape->orthoradius(va, vb, vc)));
+            }
 
-                        neighborVertices.erase(std::remove(neighborVertices.begin(),
-                                                           neighborVertices.end(),
-                                                           triangle[i]));
-                    }
+            triangles.push_back(std::make_pair(value, triangle));
 
-                    int va = triangle[0];
-                    int vb = triangle[1];
-                    int vc = triangle[2];
-                    int vd = tetrahedronVertices[0];
-                    int ve = neighborVertices[0];
+            triangleEdges.push_back(std::make_pair(std::make_pair(std::min(va, vb), std::max(va, vb)),
+                                                   std::make_pair(value, alphaShape->edgeAttached(va, vb, vc))));
+            triangleEdges.push_back(std::make_pair(std::make_pair(std::min(va, vc), std::max(va, vc)),
+                                                   std::make_pair(value, alphaShape->edgeAttached(va, vc, vb))));
+            triangleEdges.push_back(std::make_pair(std::make_pair(std::min(vb, vc), std::max(vb, vc)),
+                                                   std::make_pair(value, alphaShape->edgeAttached(vb, vc, va))));
+        }
 
-                    if(alphaShape->triangleAttached(va, vb, vc, vd)){
-                        continue;
-                    }
-                    else if(!neighborExternal && alphaShape->triangleAttached(va, vb, vc, ve)){
-                        continue;
-                    }
+        // edges of external tetrahedra which may not be in any triangle
+        if(external){
+            for(int j = 0; j < 4; j++){
+                for(int k = j + 1; k < 4; k++){
+                    int va = tetrahedron.vertices[j];
+                    int vb = tetrahedron.vertices[k];
 
-                    if(alphaShape->orthoradius(va, vb, vc) < alphaShape->alphaValue()){
-                        triangles.push_back(triangle);
+                    if(va < vertexCount && vb < vertexCount){
+                        triangleEdges.push_back(std::make_pair(std::make_pair(std::min(va, vb), std::max(va, vb)),
+                                                               std::make_pair(infinity, false)));
                     }
                 }
             }
         }
-
-        d->alphaShapeTriangles = triangles;
     }
 
-    return d->alphaShapeTriangles;
-}
+    // edges
+    std::vector<std::pair<Real, Edge> > edges;
 
-const std::vector<std::vector<int> >& DelaunayTriangulation::alphaShapeTetrahedra(const AlphaShape *alphaShape) const
-{
-    if(d->alphaShapeTetrahedra.empty()){
-        calculateAlphaShape(alphaShape);
+    std::sort(triangleEdges.begin(), triangleEdges.end());
+    for(size_t i = 0; i < triangleEdges.size(); ){
+        const std::pair<int, int> &vertices = triangleEdges[i].first;
 
-        for(unsigned int i = 0; i < d->tetrahedra.size(); i++){
-            const Tetrahedron &tetrahedron = d->tetrahedra[i];
-            if(!tetrahedron.valid || isExternal(i))
-                continue;
+        Real value = infinity;
+        bool attached = false;
 
-            if(tetrahedron.inAlphaShape){
-                std::vector<int> vertices(4);
-                for(int j = 0; j < 4; j++){
-                    vertices[j] = tetrahedron.vertices[j];
-                }
+        size_t j = i;
+        while(j < triangleEdges.size() && triangleEdges[j].first == vertices){
+            value = std::min(value, triangleEdges[j].second.first);
+            attached = attached || triangleEdges[j].second.second;
+            j++;
+        }
 
-                d->alphaShapeTetrahedra.push_back(vertices);
-            }
+        if(!attached){
+            value = std::min(value, filtrationValue(alphaShape->orthoradius(vertices.first, vertices.second)));
         }
-    }
 
-    return d->alphaShapeTetrahedra;
-}
+        Edge edge;
+        edge[0] = vertices.first;
+        edge[1] = vertices.second;
+        edges.push_back(std::make_pair(value, edge));
 
-// Marks the tetrahedra that are in the alpha shape.
-void DelaunayTriangulation::calculateAlphaShape(const AlphaShape *alphaShape) const
-{
-    if(d->alphaShapeCalculated){
-        return;
+        i = j;
     }
 
-    for(unsigned int i = 0; i < d->tetrahedra.size(); i++){
-        Tetrahedron &tetrahedron = d->tetrahedra[i];
-        if(!tetrahedron.valid || isExternal(i)){
-            continue;
-        }
+    // sort each simplex by its alpha value
+    std::stable_sort(tetrahedra.begin(), tetrahedra.end(), compareFiltrationValues<int>);
+    std::stable_sort(triangles.begin(), triangles.end(), compareFiltrationValues<Triangle>);
+    std::stable_sort(edges.begin(), edges.end(), compareFiltrationValues<Edge>);
 
-        int a = tetrahedron.vertices[0];
-        int b = tetrahedron.vertices[1];
-        int c = tetrahedron.vertices[2];
-        int d = tetrahedron.vertices[3];
+    d->filtrationTetrahedronValues.resize(tetrahedra.size());
+    d->filtrationTetrahedra.resize(tetrahedra.size());
+    for(size_t i = 0; i < tetrahedra.size(); i++){
+        const Tetrahedron &tetrahedron = d->tetrahedra[tetrahedra[i].second];
 
-        if(alphaShape->orthoradius(a, b, c, d) < alphaShape->alphaValue()){
-            tetrahedron.inAlphaShape = true;
-        }
-        else{
-            tetrahedron.inAlphaShape = false;
-        }
+        d->filtrationTetrahedronValues[i] = tetrahedra[i].first;
+        d->filtrationTetrahedra[i].assign(tetrahedron.vertices, tetrahedron.vertices + 4);
+    }
+
+    d->filtrationTriangleValues.resize(triangles.size());
+    d->filtrationTriangles.resize(triangles.size());
+    for(size_t i = 0; i < triangles.size(); i++){
+        d->filtrationTriangleValues[i] = triangles[i].first;
+        d->filtrationTriangles[i] = triangles[i].second;
+    }
+
+    d->filtrationEdgeValues.resize(edges.size());
+    d->filtrationEdges.resize(edges.size());
+    for(size_t i = 0; i < edges.size(); i++){
+        d->filtrationEdgeValues[i] = edges[i].first;
+        d->filtrationEdges[i] = edges[i].second;
     }
 
     d->alphaShapeCalculated = true;
@@ -638,31 +1028,47 @@ void DelaunayTriangulation::triangulate(bool weighted)
     big.neighbors[2] = -1;
     big.neighbors[3] = -1;
     big.valid = true;
+    d->tetrahedra.reserve(7 * size + 1);
     d->tetrahedra.push_back(big);
+    d->lastTetrahedron = 0;
+    d->stamp = 0;
 
-    // insert vertices
-    for(int i = 0; i < size; i++){
-        insertPoint(i);
+    // insert vertices in spatially sorted order
+    foreach(int vertex, insertionOrder(d->vertices, size)){
+        insertPoint(vertex);
     }
+
+    d->tetrahedronStamps.clear();
+    d->conflictTetrahedra.clear();
+    d->conflictQueue.clear();
+    d->newTetrahedra.clear();
+    d->newFaces.clear();
 }
 
 /// Returns the index of the tetrahedron that contains the point.
+///
+/// The walk starts at the last tetrahedron created, which is close
+/// to the point when the points are inserted in spatially sorted
+/// order.
 int DelaunayTriangulation::location(const Point3 &point) const
 {
-    int tetrahedronIndex = 0;
-
-    // find last valid tetrahedron to start at
-    for(int i = d->tetrahedra.size() - 1; i != 0; i++){
-        const Tetrahedron &tetrahedron = d->tetrahedra[i];
-        if(!tetrahedron.valid)
-            continue;
-
-        tetrahedronIndex = i;
-        break;
+    int tetrahedronIndex = d->lastTetrahedron;
+    if(tetrahedronIndex < 0 ||
+       tetrahedronIndex >= static_cast<int>(d->tetrahedra.size()) ||
+       !d->tetrahedra[tetrahedronIndex].valid){
+        tetrahedronIndex = 0;
+
+        for(int i = d->tetrahedra.size() - 1; i >= 0; i--){
+            if(d->tetrahedra[i].valid){
+                tetrahedronIndex = i;
+                break;
+            }
+        }
     }
 
     // walk through the delaunay structure and try to find a
-    // tetrahedron that contains the point.
+    // tetrahedron that contains the point. the face checked first is
+    // rotated each step so that the walk does not cycle.
     for(size_t iteration = 0; iteration < d->tetrahedra.size(); iteration++){
         const Tetrahedron &tetrahedron = d->tetrahedra[tetrahedronIndex];
         const Point3 &a = position(tetrahedron.vertices[0]);
@@ -670,22 +1076,33 @@ int DelaunayTriangulation::location(const Point3 &point) const
         const Point3 &c = position(tetrahedron.vertices[2]);
         const Point3 &d = position(tetrahedron.vertices[3]);
 
-        if(chemkit::geometry::planeOrientation(a, b, c, point) > 0){
-            tetrahedronIndex = tetrahedron.neighbors[0];
-        }
-        else if(chemkit::geometry::planeOrientation(a, d, b, point) > 0){
-            tetrahedronIndex = tetrahedron.neighbors[1];
-        }
-        else if(chemkit::geometry::planeOrientation(a, c, d, point) > 0){
-            tetrahedronIndex = tetrahedron.neighbors[2];
-        }
-        else if(chemkit::geometry::planeOrientation(b, d, c, point) > 0){
-            tetrahedronIndex = tetrahedron.neighbors[3];
+        int next = -1;
+        bool outside = false;
+
+        for(int k = 0; k < 4 && !outside; k++){
+            int face = (k + iteration) % 4;
+
+            switch(face){
+                case 0: outside = orientationSign(a, b, c, point) > 0; break;
+                case 1: outside = orientationSign(a, d, b, point) > 0; break;
+                case 2: outside = orientationSign(a, c, d, point) > 0; break;
+                case 3: outside = orientationSign(b, d, c, point) > 0; break;
+            }
+
+            if(outside){
+                next = tetrahedron.neighbors[face];
+            }
         }
-        else{
+
+        if(!outside){
             // we found the tetrahedron that contains the point
             return tetrahedronIndex;
         }
+        else if(next < 0){
+            break;
+        }
+
+        tetrahedronIndex = next;
     }
 
     // for some reason we were not able to locate the tetrahedron after
@@ -702,10 +1119,10 @@ int DelaunayTriangulation::location(const Point3 &point) const
         const Point3 &c = position(tetrahedron.vertices[2]);
         const Point3 &d = position(tetrahedron.vertices[3]);
 
-        if(chemkit::geometry::planeOrientation(a, b, c, point) < 0 &&
-           chemkit::geometry::planeOrientation(a, d, b, point) < 0 &&
-           chemkit::geometry::planeOrientation(a, c, d, point) < 0 &&
-           chemkit::geometry::planeOrientation(b, d, c, point) < 0){
+        if(orientationSign(a, b, c, point) < 0 &&
+           orientationSign(a, d, b, point) < 0 &&
+           orientationSign(a, c, d, point) < 0 &&
+           orientationSign(b, d, c, point) < 0){
             return i;
         }
     }
@@ -716,136 +1133,173 @@ int DelaunayTriangulation::location(const Point3 &point) const
 
 /// Returns a list of tetrahedra that contain the vertex in their
 /// circumsphere.
-std::vector<int> DelaunayTriangulation::findContainingTetrahedra(int vertex) const
+///
+/// Each visited tetrahedron is marked with a stamp that is unique to
+/// the current insertion. Tetrahedra in conflict with the vertex are
+/// marked with the stamp plus one.
+const std::vector<int>& DelaunayTriangulation::findContainingTetrahedra(int vertex) const
 {
-    const Point3 &point = position(vertex);
 
-    std::vector<int> tetrahedra;
+    std::vector<int> &tetrahedra = d->conflictTetrahedra;
+    std::vector<int> &queue = d->conflictQueue;
+    std::vector<unsigned int> &stamps = d->tetrahedronStamps;
+
+    tetrahedra.clear();
+    queue.clear();
+
+    if(stamps.size() < d->tetrahedra.size()){
+        stamps.resize(d->tetrahedra.capacity(), 0);
+    }
 
-    int initialTetrahedron = location(point);
+    d->stamp += 2;
+    const unsigned int visited = d->stamp;
+    const unsigned int conflict = d->stamp + 1;
 
-    std::set<int> visited;
-    std::deque<int> queue;
+    int initialTetrahedron = location(position(vertex));
+    if(initialTetrahedron == -1){
+        return tetrahedra;
+    }
 
     queue.push_back(initialTetrahedron);
+    stamps[initialTetrahedron] = visited;
 
     while(!queue.empty()){
-        int index = queue.front();
-        queue.pop_front();
-        if(index == -1 || visited.count(index))
-            continue;
+        int index = queue.back();
+        queue.pop_back();
 
-        visited.insert(index);
         const Tetrahedron &tetrahedron = d->tetrahedra[index];
 
-        int va = tetrahedron.vertices[0];
-        int vb = tetrahedron.vertices[1];
-        int vc = tetrahedron.vertices[2];
-        int vd = tetrahedron.vertices[3];
+        bool inConflict = isInConflict(index, vertex);
 
-        Point3 pa = position(va);
-        Point3 pb = position(vb);
-        Point3 pc = position(vc);
-        Point3 pd = position(vd);
+        if(inConflict){
+            stamps[index] = conflict;
+            tetrahedra.push_back(index);
 
-        if(chemkit::geometry::planeOrientation(pa, pb, pc, pd) < 0){
-            std::swap(pa, pb);
-            std::swap(va, vb);
+            for(int i = 0; i < 4; i++){
+                int neighbor = tetrahedron.neighbors[i];
+
+                if(neighbor >= 0 && stamps[neighbor] != visited && stamps[neighbor] != conflict){
+                    stamps[neighbor] = visited;
+                    queue.push_back(neighbor);
+                }
+            }
         }
+    }
 
-        if(isWeighted()){
-            Real wa = weight(va);
-            Real wb = weight(vb);
-            Real wc = weight(vc);
-            Real wd = weight(vd);
-            Real wp = weight(vertex);
+    return tetrahedra;
+}
 
-            if(chemkit::geometry::sphereOrientation(pa, pb, pc, pd, point, wa, wb, wc, wd, wp) > 0){
-                tetrahedra.push_back(index);
+/// Returns \c true if \p vertex is in conflict with the tetrahedron
+/// at \p index, that is if it lies inside of the tetrahedron's
+/// circumsphere (or orthosphere for a weighted triangulation).
+///
+/// Vertices lying exactly on the sphere are resolved with a symbolic
+/// perturbation of the weights [Devillers 2011]. Each weight is
+/// increased by an infinitesimal amount which is larger for vertices
+/// with a higher index. The sign of the power test is then given by
+/// the first non-zero derivative with respect to those weights, taken
+/// in order of decreasing vertex index. Each derivative is, up to its
+/// sign, the orientation of the other four points. As every test is
+/// decided for the same perturbed set of points, cospherical points
+/// (e.g. the atoms of a fullerene) never produce flat or overlapping
+/// tetrahedra.
+bool DelaunayTriangulation::isInConflict(int index, int vertex) const
+{
+    const Tetrahedron &tetrahedron = d->tetrahedra[index];
 
-                for(int i = 0; i < 4; i++){
-                    queue.push_back(tetrahedron.neighbors[i]);
-                }
-            }
+    // the points are ordered as (a, b, c, d, p) with (a, b, c, d)
+    // positively oriented
+    int vertices[5] = { tetrahedron.vertices[0],
+                        tetrahedron.vertices[1],
+                        tetrahedron.vertices[2],
+                        tetrahedron.vertices[3],
+                        vertex };
+
+    const Point3 *points[5];
+    Real weights[5];
+    for(int i = 0; i < 5; i++){
+        points[i] = &d->vertices[vertices[i]];
+        weights[i] = isWeighted() ? d->weights[vertices[i]] : 0;
+    }
+
+    if(orientationSign(*points[0], *points[1], *points[2], *points[3]) < 0){
+        std::swap(vertices[0], vertices[1]);
+        std::swap(points[0], points[1]);
+        std::swap(weights[0], weights[1]);
+    }
+
+    int power = powerSign(points, weights);
+    if(power != 0){
+        return power > 0;
+    }
+
+    // perturb the weights starting with the highest vertex index
+    int order[5] = { 0, 1, 2, 3, 4 };
+    for(int i = 1; i < 5; i++){
+        for(int j = i; j > 0 && vertices[order[j - 1]] < vertices[order[j]]; j--){
+            std::swap(order[j - 1], order[j]);
         }
-        else{
-            if(chemkit::geometry::sphereOrientation(pa, pb, pc, pd, point) > 0){
-                tetrahedra.push_back(index);
+    }
 
-                for(int i = 0; i < 4; i++){
-                    queue.push_back(tetrahedron.neighbors[i]);
-                }
+    for(int i = 0; i < 5; i++){
+        int k = order[i];
+
+        // the derivative with respect to the weight of point k is the
+        // cofactor of its lifted coordinate which is the orientation
+        // of the remaining four points
+        const Point3 *rest[4];
+        for(int j = 0, n = 0; j < 5; j++){
+            if(j != k){
+                rest[n++] = points[j];
             }
         }
+
+        int derivative = orientationSign(*rest[0], *rest[1], *rest[2], *rest[3]);
+        if(k % 2 == 1){
+            derivative = -derivative;
+        }
+
+        if(derivative != 0){
+            return derivative > 0;
+        }
     }
 
-    return tetrahedra;
+    return false;
 }
 
 void DelaunayTriangulation::insertPoint(int index)
 {
     Point3 point = position(index);
 
-    const std::vector<int> containingTetrahedra = findContainingTetrahedra(index);
+    const std::vector<int> &containingTetrahedra = findContainingTetrahedra(index);
+    if(containingTetrahedra.empty()){
+        return;
+    }
 
-    std::vector<Triangle> faces;
-    std::vector<std::pair<int, int> > faceNeighbor;
-    std::vector<int> count;
+    const unsigned int conflict = d->stamp + 1;
 
-    foreach(int index, containingTetrahedra){
-        const Tetrahedron &tetrahedron = d->tetrahedra[index];
-        for(int i = 0; i < 4; i++){
-            for(int j = i + 1; j < 4; j++){
-                for(int k = j + 1; k < 4; k++){
-                    Triangle face;
-                    face[0] = tetrahedron.vertices[i];
-                    face[1] = tetrahedron.vertices[j];
-                    face[2] = tetrahedron.vertices[k];
-                    std::sort(face.begin(), face.end());
-
-                    unsigned int faceIndex = std::distance(faces.begin(), std::find(faces.begin(), faces.end(), face));
-                    if(faceIndex == faces.size()){
-                        faces.push_back(face);
-                        count.push_back(1);
-
-                        int faceNumber;
-                        if(i == 0 && j == 1 && k == 2)
-                            faceNumber = 0;
-                        else if(i == 0 && j == 1 && k == 3)
-                            faceNumber = 1;
-                        else if(i == 0 && j == 2 && k == 3)
-                            faceNumber = 2;
-                        else
-                            faceNumber = 3;
-
-                        faceNeighbor.push_back(std::make_pair(index, faceNumber));
-                    }
-                    else{
-                        count[faceIndex]++;
-                    }
-                }
+    // the faces of the cavity are the faces of the containing
+    // tetrahedra whose neighbor is not in conflict with the point.
+    // each one is joined with the point to form a new tetrahedron.
+    std::vector<int> &newTetrahedra = d->newTetrahedra;
+    newTetrahedra.clear();
+
+    foreach(int containingIndex, containingTetrahedra){
+        for(int faceNumber = 0; faceNumber < 4; faceNumber++){
+            int neighborIndex = d->tetrahedra[containingIndex].neighbors[faceNumber];
+            if(neighborIndex >= 0 && d->tetrahedronStamps[neighborIndex] == conflict){
+                continue;
             }
-        }
-    }
 
-    // remove containing tetrahedra
-    foreach(int tetrahedron, containingTetrahedra){
-        d->tetrahedra[tetrahedron].valid = false;
-    }
+            Triangle face = d->tetrahedra[containingIndex].triangle(faceNumber);
 
-    // add new tetrahedra
-    std::vector<int> newTetrahedra;
-    for(unsigned int i = 0; i < faces.size(); i++){
-        if(count[i] == 1){
-            const Triangle &face = faces[i];
             Tetrahedron tetrahedron;
-            int tetrahedronIndex = d->tetrahedra.size();
 
             const Point3 &a = position(face[0]);
             const Point3 &b = position(face[1]);
             const Point3 &c = position(face[2]);
 
-            if(chemkit::geometry::planeOrientation(a, b, c, point) < 0){
+            if(orientationSign(a, b, c, point) < 0){
                 tetrahedron.vertices[0] = face[0];
                 tetrahedron.vertices[1] = face[1];
                 tetrahedron.vertices[2] = face[2];
@@ -858,69 +1312,76 @@ void DelaunayTriangulation::insertPoint(int index)
                 tetrahedron.vertices[3] = index;
             }
 
-            std::pair<int, int> neighbor = faceNeighbor[i];
-            int neighborIndex = neighbor.first;
-            int neighborFace = neighbor.second;
+            tetrahedron.neighbors[0] = neighborIndex; // abc
+            tetrahedron.neighbors[1] = -1; // abd
+            tetrahedron.neighbors[2] = -1; // acd
+            tetrahedron.neighbors[3] = -1; // bcd
+            tetrahedron.valid = true;
+            tetrahedron.inAlphaShape = false;
+
+            // reuse the slot of a previously removed tetrahedron
+            int tetrahedronIndex;
+            if(!d->freeTetrahedra.empty()){
+                tetrahedronIndex = d->freeTetrahedra.back();
+                d->freeTetrahedra.pop_back();
+                d->tetrahedra[tetrahedronIndex] = tetrahedron;
+            }
+            else{
+                tetrahedronIndex = d->tetrahedra.size();
+                d->tetrahedra.push_back(tetrahedron);
+            }
+
+            newTetrahedra.push_back(tetrahedronIndex);
 
-            int oldNeighborIndex = d->tetrahedra[neighborIndex].neighbors[neighborFace];
-            if(oldNeighborIndex != -1){
-                const Tetrahedron &oldNeighbor = d->tetrahedra[oldNeighborIndex];
+            // point the outside neighbor back to the new tetrahedron
+            if(neighborIndex >= 0){
+                Tetrahedron &neighbor = d->tetrahedra[neighborIndex];
 
-                int oldNeighborFace = 0;
                 for(int j = 0; j < 4; j++){
-                    if(oldNeighbor.neighbors[j] == neighborIndex){
-                        oldNeighborFace = j;
+                    if(neighbor.neighbors[j] == containingIndex){
+                        neighbor.neighbors[j] = tetrahedronIndex;
+                        break;
                     }
                 }
-
-                d->tetrahedra[oldNeighborIndex].neighbors[oldNeighborFace] = tetrahedronIndex;
             }
-
-            tetrahedron.neighbors[0] = oldNeighborIndex; // abc
-            tetrahedron.neighbors[1] = -2; // abd
-            tetrahedron.neighbors[2] = -2; // acd
-            tetrahedron.neighbors[3] = -2; // bcd
-
-            tetrahedron.valid = true;
-            d->tetrahedra.push_back(tetrahedron);
-            newTetrahedra.push_back(tetrahedronIndex);
         }
     }
 
-    // fix up neighbors in new tetrahedra
-    for(unsigned int i = 0; i < newTetrahedra.size(); i++){
-        Tetrahedron &tetrahedron = d->tetrahedra[newTetrahedra[i]];
+    // the containing tetrahedra are only released once all of
+    // the new tetrahedra have been created
+    foreach(int containingIndex, containingTetrahedra){
+        d->tetrahedra[containingIndex].valid = false;
+        d->freeTetrahedra.push_back(containingIndex);
+    }
 
-        for(unsigned int j = 0; j < newTetrahedra.size(); j++){
-            if(i == j){
-                continue;
-            }
+    // each inner face of a new tetrahedron is identified by the edge
+    // it shares with the cavity boundary. faces sharing the same edge
+    // are adjacent.
+    std::vector<std::pair<std::pair<int, int>, std::pair<int, int> > > &faces = d->newFaces;
+    faces.clear();
 
-            int otherIndex = newTetrahedra[j];
-            const Tetrahedron &other = d->tetrahedra[otherIndex];
-            boost::array<int, 4> vertices;
-            vertices[0] = other.vertices[0];
-            vertices[1] = other.vertices[1];
-            vertices[2] = other.vertices[2];
-            vertices[3] = other.vertices[3];
-
-            if(std::find(vertices.begin(), vertices.end(), tetrahedron.vertices[0]) != vertices.end() &&
-               std::find(vertices.begin(), vertices.end(), tetrahedron.vertices[1]) != vertices.end() &&
-               std::find(vertices.begin(), vertices.end(), tetrahedron.vertices[3]) != vertices.end()){
-                tetrahedron.neighbors[1] = otherIndex; // abd
-            }
-            else if(std::find(vertices.begin(), vertices.end(), tetrahedron.vertices[0]) != vertices.end() &&
-                    std::find(vertices.begin(), vertices.end(), tetrahedron.vertices[2]) != vertices.end() &&
-                    std::find(vertices.begin(), vertices.end(), tetrahedron.vertices[3]) != vertices.end()){
-                tetrahedron.neighbors[2] = otherIndex; // acd
-            }
-            else if(std::find(vertices.begin(), vertices.end(), tetrahedron.vertices[1]) != vertices.end() &&
-                    std::find(vertices.begin(), vertices.end(), tetrahedron.vertices[2]) != vertices.end() &&
-                    std::find(vertices.begin(), vertices.end(), tetrahedron.vertices[3]) != vertices.end()){
-                tetrahedron.neighbors[3] = otherIndex; // bcd
-            }
+    foreach(int tetrahedronIndex, newTetrahedra){
+        const Tetrahedron &tetrahedron = d->tetrahedra[tetrahedronIndex];
+
+        int a = tetrahedron.vertices[0];
+        int b = tetrahedron.vertices[1];
+        int c = tetrahedron.vertices[2];
+
+        faces.push_back(std::make_pair(std::make_pair(std::min(a, b), std::max(a, b)), std::make_pair(tetrahedronIndex, 1))); // abd
+        faces.push_back(std::make_pair(std::make_pair(std::min(a, c), std::max(a, c)), std::make_pair(tetrahedronIndex, 2))); // acd
+        faces.push_back(std::make_pair(std::make_pair(std::min(b, c), std::max(b, c)), std::make_pair(tetrahedronIndex, 3))); // bcd
+    }
+
+    std::sort(faces.begin(), faces.end());
+    for(size_t i = 0; i + 1 < faces.size(); i++){
+        if(faces[i].first == faces[i + 1].first){
+            d->tetrahedra[faces[i].second.first].neighbors[faces[i].second.second] = faces[i + 1].second.first;
+            d->tetrahedra[faces[i + 1].second.first].neighbors[faces[i + 1].second.second] = faces[i].second.first;
+            i++;
         }
     }
+
+    d->lastTetrahedron = newTetrahedra.back();
 }
 
 bool DelaunayTriangulation::isExternal(int index) const
@@ -86,7 +86,8 @@ private:
     void triangulate(bool weighted);
     int location(const Point3 &point) const;
     void insertPoint(int index);
-    std::vector<int> findContainingTetrahedra(int vertex) const;
+    const std::vector<int>& findContainingTetrahedra(int vertex) const;
+    bool isInConflict(int tetrahedron, int vertex) const;
     bool isExternal(int tetrahedron) const;
 
     // alpha shape
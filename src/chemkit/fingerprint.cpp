@@ -35,6 +35,7 @@
 
 #include "fingerprint.h"
 
+#include "foreach.h"
 #include "molecule.h"
 #include "pluginmanager.h"
 
@@ -115,6 +116,24 @@ Bitset Fingerprint::value(const Molecule *molecule) const
     return Bitset();
 }
 
+/// Returns the fingerprint values for each molecule in
+/// \p molecules.
+///
+/// The default implementation calls value() for each molecule.
+/// Fingerprints which keep scratch storage during generation
+/// may reimplement this method to reuse it across molecules.
+std::vector<Bitset> Fingerprint::value(const std::vector<const Molecule *> &molecules) const
+{
+    std::vector<Bitset> values;
+    values.reserve(molecules.size());
+
+    foreach(const Molecule *molecule, molecules){
+        values.push_back(value(molecule));
+    }
+
+    return values;
+}
+
 // --- Similarity ---------------------------------------------------------- //
 /// Returns the tanimoto coefficent between \p a and \p b.
 Real Fingerprint::tanimotoCoefficient(const Bitset &a, const Bitset &b)
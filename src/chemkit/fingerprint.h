@@ -60,6 +60,7 @@ public:
 
     // fingerprint
     virtual Bitset value(const Molecule *molecule) const;
+    virtual std::vector<Bitset> value(const std::vector<const Molecule *> &molecules) const;
 
     // similarity
     static Real tanimotoCoefficient(const Bitset &a, const Bitset &b);
@@ -0,0 +1,1353 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "fingerprintdatabase.h"
+
+#include <cmath>
+#include <queue>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "foreach.h"
+#include "taskgroup.h"
+#include "threadpool.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CHEMKIT_FINGERPRINTDATABASE_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace chemkit {
+
+namespace {
+
+typedef boost::uint64_t Word;
+
+// each fingerprint record is padded to a multiple of the cache line size
+const size_t WordsPerLine = 64 / sizeof(Word);
+
+// --- Popcount Kernels ---------------------------------------------------- //
+// Each kernel returns the number of bits set in (a & b) for the first
+// size words. The size is always a multiple of WordsPerLine.
+typedef unsigned int (*IntersectionCountFunction)(const Word *a, const Word *b, size_t size);
+
+inline unsigned int popcount(Word x)
+{
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+
+    return static_cast<unsigned int>((x * 0x0101010101010101ULL) >> 56);
+}
+
+unsigned int intersectionCountGeneric(const Word *a, const Word *b, size_t size)
+{
+    unsigned int c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+
+    for(size_t i = 0; i < size; i += 4){
+        c0 += popcount(a[i+0] & b[i+0]);
+        c1 += popcount(a[i+1] & b[i+1]);
+        c2 += popcount(a[i+2] & b[i+2]);
+        c3 += popcount(a[i+3] & b[i+3]);
+    }
+
+    return c0 + c1 + c2 + c3;
+}
+
+#ifdef CHEMKIT_FINGERPRINTDATABASE_X86_DISPATCH
+__attribute__((target("popcnt")))
+unsigned int intersectionCountPopcnt(const Word *a, const Word *b, size_t size)
+{
+    unsigned int c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+
+    for(size_t i = 0; i < size; i += 4){
+        c0 += __builtin_popcountll(a[i+0] & b[i+0]);
+        c1 += __builtin_popcountll(a[i+1] & b[i+1]);
+        c2 += __builtin_popcountll(a[i+2] & b[i+2]);
+        c3 += __builtin_popcountll(a[i+3] & b[i+3]);
+    }
+
+    return c0 + c1 + c2 + c3;
+}
+
+// Counts bits four words at a time using a nibble lookup table
+// and sums the byte counts with a sum of absolute differences.
+__attribute__((target("avx2")))
+unsigned int intersectionCountAvx2(const Word *a, const Word *b, size_t size)
+{
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowMask = _mm256_set1_epi8(0x0f);
+    const __m256i zero = _mm256_setzero_si256();
+
+    __m256i total = zero;
+
+    for(size_t i = 0; i < size; i += 8){
+        __m256i x = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)),
+                                     _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+        __m256i y = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i + 4)),
+                                     _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i + 4)));
+
+        __m256i xCounts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, _mm256_and_si256(x, lowMask)),
+                                          _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(x, 4), lowMask)));
+        __m256i yCounts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, _mm256_and_si256(y, lowMask)),
+                                          _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(y, 4), lowMask)));
+
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(_mm256_add_epi8(xCounts, yCounts), zero));
+    }
+
+    return static_cast<unsigned int>(_mm256_extract_epi64(total, 0) +
+                                     _mm256_extract_epi64(total, 1) +
+                                     _mm256_extract_epi64(total, 2) +
+                                     _mm256_extract_epi64(total, 3));
+}
+#endif
+
+// Returns the fastest popcount kernel supported by the processor.
+IntersectionCountFunction intersectionCountFunction()
+{
+#ifdef CHEMKIT_FINGERPRINTDATABASE_X86_DISPATCH
+    __builtin_cpu_init();
+
+    if(__builtin_cpu_supports("avx2")){
+        return intersectionCountAvx2;
+    }
+    else if(__builtin_cpu_supports("popcnt")){
+        return intersectionCountPopcnt;
+    }
+#endif
+
+    return intersectionCountGeneric;
+}
+
+// Returns true if hit a ranks before hit b. Hits are ordered by
+// decreasing similarity and then by increasing index.
+bool hitLessThan(const FingerprintDatabase::Hit &a, const FingerprintDatabase::Hit &b)
+{
+    return a.second > b.second || (a.second == b.second && a.first < b.first);
+}
+
+struct HitLessThan
+{
+    bool operator()(const FingerprintDatabase::Hit &a, const FingerprintDatabase::Hit &b) const
+    {
+        return hitLessThan(a, b);
+    }
+};
+
+// Orders record slots by the number of bits set and then by index.
+struct SlotLessThan
+{
+    SlotLessThan(const boost::uint32_t *counts, const boost::uint64_t *indices)
+        : m_counts(counts),
+          m_indices(indices)
+    {
+    }
+
+    bool operator()(size_t a, size_t b) const
+    {
+        return m_counts[a] < m_counts[b] ||
+               (m_counts[a] == m_counts[b] && m_indices[a] < m_indices[b]);
+    }
+
+    const boost::uint32_t *m_counts;
+    const boost::uint64_t *m_indices;
+};
+
+// Returns the upper bound on the tanimoto coefficient between two
+// fingerprints with a and b bits set.
+inline Real similarityBound(size_t a, size_t b)
+{
+    if(a == 0 || b == 0){
+        return a == b ? 1 : 0;
+    }
+
+    return a < b ? Real(a) / Real(b) : Real(b) / Real(a);
+}
+
+inline Real similarityValue(size_t intersection, size_t a, size_t b)
+{
+    size_t union_ = a + b - intersection;
+
+    return union_ ? Real(intersection) / Real(union_) : Real(0);
+}
+
+// --- Binary Format ------------------------------------------------------- //
+// The binary format contains a fixed size header followed by the
+// fingerprint type name and the records sorted by their bit count.
+// The records are followed by the bit count of each record, the
+// index of each record, the record of each index and an optional
+// identifier table. Records are aligned to 64 bytes from the start
+// of the file so that they can be searched directly from a mapped
+// file. All values are stored in the byte order of the machine that
+// wrote the file.
+//
+//   header | name | padding | records | bit counts | padding |
+//   indices | positions | identifier offsets | identifiers
+const char BinaryMagic[8] = { 'C', 'K', 'F', 'P', 'R', 'I', 'N', 'T' };
+const boost::uint32_t BinaryVersion = 1;
+const boost::uint32_t BinaryByteOrder = 0x01020304;
+
+struct BinaryHeader
+{
+    char magic[8];
+    boost::uint32_t version;
+    boost::uint32_t byteOrder;
+    boost::uint64_t bitCount;
+    boost::uint64_t recordSize;
+    boost::uint64_t count;
+    boost::uint64_t nameLength;
+    boost::uint64_t recordOffset;
+    boost::uint64_t idOffset; // zero if there are no identifiers
+};
+
+inline boost::uint64_t alignOffset(boost::uint64_t offset, boost::uint64_t alignment)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+void writePadding(std::ostream &output, boost::uint64_t from, boost::uint64_t to)
+{
+    for(boost::uint64_t i = from; i < to; i++){
+        output.put(0);
+    }
+}
+
+int hexValue(char c)
+{
+    if(c >= '0' && c <= '9'){
+        return c - '0';
+    }
+    else if(c >= 'a' && c <= 'f'){
+        return c - 'a' + 10;
+    }
+    else if(c >= 'A' && c <= 'F'){
+        return c - 'A' + 10;
+    }
+
+    return -1;
+}
+
+} // end anonymous namespace
+
+
+// === FingerprintDatabasePrivate ========================================== //
+class FingerprintDatabasePrivate
+{
+public:
+    FingerprintDatabasePrivate();
+
+    void setBitCount(size_t count);
+    const Word* record(size_t slot) const;
+    std::string id(size_t index) const;
+    void reserve(size_t size);
+    void detach();
+    void sort();
+    Word* appendRecord(const std::string &id);
+    void finishRecord();
+    void clear();
+
+    size_t bitCount;
+    size_t wordCount;
+    std::string name;
+    size_t size;
+    IntersectionCountFunction intersectionCount;
+
+    // records are stored in slots sorted by their bit count. the
+    // records and tables are either owned by the database or point
+    // into a mapped binary file.
+    const Word *data;
+    const boost::uint32_t *counts;
+    const boost::uint64_t *indices;
+    const boost::uint64_t *positions;
+    const boost::uint64_t *idOffsets;
+    const char *idData;
+    size_t capacity;
+    std::vector<Word> storage;
+    std::vector<boost::uint32_t> countStorage;
+    std::vector<boost::uint64_t> indexStorage;
+    std::vector<boost::uint64_t> positionStorage;
+    std::vector<std::string> idStorage;
+    boost::scoped_ptr<boost::iostreams::mapped_file_source> file;
+
+    // set when the slots are sorted by bit count
+    boost::atomic<bool> sorted;
+    boost::mutex sortMutex;
+
+    // guards the k-th nearest similarity shared by nearest() chunks
+    boost::mutex nearestMutex;
+
+    size_t threadCount;
+    size_t chunkSize;
+    boost::scoped_ptr<ThreadPool> pool;
+    std::string errorString;
+};
+
+FingerprintDatabasePrivate::FingerprintDatabasePrivate()
+    : bitCount(0),
+      wordCount(0),
+      size(0),
+      intersectionCount(intersectionCountFunction()),
+      data(0),
+      counts(0),
+      indices(0),
+      positions(0),
+      idOffsets(0),
+      idData(0),
+      capacity(0),
+      sorted(true),
+      threadCount(ThreadPool::idealThreadCount()),
+      chunkSize(4096)
+{
+}
+
+void FingerprintDatabasePrivate::setBitCount(size_t count)
+{
+    bitCount = count;
+
+    // round up to a whole number of cache lines
+    size_t lineBits = WordsPerLine * sizeof(Word) * 8;
+    wordCount = ((count + lineBits - 1) / lineBits) * WordsPerLine;
+}
+
+const Word* FingerprintDatabasePrivate::record(size_t slot) const
+{
+    return data + slot * wordCount;
+}
+
+std::string FingerprintDatabasePrivate::id(size_t index) const
+{
+    if(!file){
+        return idStorage[index];
+    }
+    else if(idOffsets){
+        return std::string(idData + idOffsets[index], idData + idOffsets[index+1]);
+    }
+
+    return std::string();
+}
+
+// Grows the owned record storage to hold at least size records.
+void FingerprintDatabasePrivate::reserve(size_t size)
+{
+    detach();
+
+    if(size <= capacity){
+        return;
+    }
+
+    // allocate one extra cache line so that the records can be aligned
+    std::vector<Word> newStorage(size * wordCount + WordsPerLine);
+    size_t address = reinterpret_cast<size_t>(&newStorage[0]);
+    size_t offset = ((64 - address % 64) % 64) / sizeof(Word);
+    Word *newData = &newStorage[0] + offset;
+
+    if(this->size){
+        std::copy(data, data + this->size * wordCount, newData);
+    }
+
+    storage.swap(newStorage);
+    data = newData;
+    capacity = size;
+
+    countStorage.reserve(size);
+    indexStorage.reserve(size);
+    positionStorage.reserve(size);
+    idStorage.reserve(size);
+}
+
+// Copies the records from a mapped file into owned storage so that
+// they can be modified.
+void FingerprintDatabasePrivate::detach()
+{
+    if(!file){
+        return;
+    }
+
+    // keep the file mapped until the records have been copied
+    boost::scoped_ptr<boost::iostreams::mapped_file_source> mapped;
+    mapped.swap(file);
+
+    capacity = 0;
+    reserve(std::max(size, size_t(64)));
+
+    countStorage.assign(counts, counts + size);
+    indexStorage.assign(indices, indices + size);
+    positionStorage.assign(positions, positions + size);
+
+    idStorage.clear();
+    for(size_t i = 0; i < size; i++){
+        idStorage.push_back(idOffsets ? std::string(idData + idOffsets[i], idData + idOffsets[i+1]) : std::string());
+    }
+
+    counts = countStorage.empty() ? 0 : &countStorage[0];
+    indices = indexStorage.empty() ? 0 : &indexStorage[0];
+    positions = positionStorage.empty() ? 0 : &positionStorage[0];
+    idOffsets = 0;
+    idData = 0;
+}
+
+// Reorders the records so that the slots are sorted by bit count.
+void FingerprintDatabasePrivate::sort()
+{
+    detach();
+
+    std::vector<size_t> order(size);
+    for(size_t i = 0; i < size; i++){
+        order[i] = i;
+    }
+
+    std::sort(order.begin(), order.end(), SlotLessThan(counts, indices));
+
+    std::vector<Word> newStorage(capacity * wordCount + WordsPerLine);
+    size_t address = reinterpret_cast<size_t>(&newStorage[0]);
+    size_t offset = ((64 - address % 64) % 64) / sizeof(Word);
+    Word *newData = &newStorage[0] + offset;
+
+    std::vector<boost::uint32_t> newCounts(size);
+    std::vector<boost::uint64_t> newIndices(size);
+
+    for(size_t slot = 0; slot < size; slot++){
+        size_t oldSlot = order[slot];
+
+        std::copy(record(oldSlot), record(oldSlot) + wordCount, newData + slot * wordCount);
+        newCounts[slot] = countStorage[oldSlot];
+        newIndices[slot] = indexStorage[oldSlot];
+        positionStorage[newIndices[slot]] = slot;
+    }
+
+    storage.swap(newStorage);
+    countStorage.swap(newCounts);
+    indexStorage.swap(newIndices);
+
+    data = newData;
+    counts = countStorage.empty() ? 0 : &countStorage[0];
+    indices = indexStorage.empty() ? 0 : &indexStorage[0];
+}
+
+// Appends a new cleared record and returns a pointer to its words.
+// The record must be completed with finishRecord().
+Word* FingerprintDatabasePrivate::appendRecord(const std::string &id)
+{
+    detach();
+
+    if(size == capacity){
+        reserve(std::max(size_t(64), capacity * 2));
+    }
+
+    Word *words = const_cast<Word *>(record(size));
+    std::fill(words, words + wordCount, Word(0));
+
+    countStorage.push_back(0);
+    indexStorage.push_back(size);
+    positionStorage.push_back(size);
+    idStorage.push_back(id);
+    size++;
+
+    counts = &countStorage[0];
+    indices = &indexStorage[0];
+    positions = &positionStorage[0];
+
+    return words;
+}
+
+// Clears any bits past the bit count in the last record and updates
+// its bit count.
+void FingerprintDatabasePrivate::finishRecord()
+{
+    size_t slot = size - 1;
+    Word *words = const_cast<Word *>(record(slot));
+
+    size_t bitsInWord = bitCount % (sizeof(Word) * 8);
+    if(bitsInWord){
+        words[bitCount / (sizeof(Word) * 8)] &= (Word(1) << bitsInWord) - 1;
+    }
+
+    boost::uint32_t count = 0;
+    for(size_t i = 0; i < wordCount; i++){
+        count += popcount(words[i]);
+    }
+
+    countStorage[slot] = count;
+
+    // records appended in bit count order keep the slots sorted
+    if(slot > 0 && count < countStorage[slot-1]){
+        sorted = false;
+    }
+}
+
+void FingerprintDatabasePrivate::clear()
+{
+    file.reset();
+    size = 0;
+    capacity = 0;
+    data = 0;
+    counts = 0;
+    indices = 0;
+    positions = 0;
+    idOffsets = 0;
+    idData = 0;
+    storage.clear();
+    countStorage.clear();
+    indexStorage.clear();
+    positionStorage.clear();
+    idStorage.clear();
+    sorted = true;
+}
+
+// === FingerprintDatabase ================================================= //
+/// \class FingerprintDatabase fingerprintdatabase.h chemkit/fingerprintdatabase.h
+/// \ingroup chemkit
+/// \brief The FingerprintDatabase class provides similarity search
+///        over a collection of fingerprints.
+///
+/// The fingerprints are stored in a single contiguous block of
+/// memory with each fingerprint padded to a multiple of 64 bytes.
+/// Tanimoto coefficients are calculated with the fastest popcount
+/// instructions supported by the processor.
+///
+/// The fingerprints are kept sorted by the number of bits set so
+/// that searches only scan the fingerprints which can reach the
+/// requested similarity. Searches are run in parallel on a
+/// ThreadPool. search() and nearest() may be called from several
+/// threads at once as long as the database is not being modified.
+///
+/// For example, to find the ten most similar fingerprints to a
+/// query molecule in an FPS file:
+/// \code
+/// FingerprintDatabase database;
+/// database.read("fingerprints.fps");
+///
+/// Bitset query = molecule->fingerprint("fp2");
+///
+/// foreach(const FingerprintDatabase::Hit &hit, database.nearest(query, 10)){
+///     std::cout << database.id(hit.first) << " " << hit.second << std::endl;
+/// }
+/// \endcode
+///
+/// Fingerprint databases can also be written in a binary format
+/// which is memory-mapped when read. Mapped fingerprints are searched
+/// directly from the file without being parsed or copied.
+///
+/// \see Fingerprint
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new, empty fingerprint database for fingerprints with
+/// \p bitCount bits. If \p bitCount is \c 0 the bit count is taken
+/// from the first fingerprint added to the database.
+FingerprintDatabase::FingerprintDatabase(size_t bitCount)
+    : d(new FingerprintDatabasePrivate)
+{
+    d->setBitCount(bitCount);
+
+    if(d->threadCount > 1){
+        d->pool.reset(new ThreadPool(d->threadCount));
+    }
+}
+
+/// Destroys the fingerprint database.
+FingerprintDatabase::~FingerprintDatabase()
+{
+    delete d;
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Returns the number of bits in each fingerprint.
+size_t FingerprintDatabase::bitCount() const
+{
+    return d->bitCount;
+}
+
+/// Sets the name of the fingerprint type to \p name.
+void FingerprintDatabase::setName(const std::string &name)
+{
+    d->name = name;
+}
+
+/// Returns the name of the fingerprint type.
+std::string FingerprintDatabase::name() const
+{
+    return d->name;
+}
+
+/// Returns the number of fingerprints in the database.
+size_t FingerprintDatabase::size() const
+{
+    return d->size;
+}
+
+/// Returns \c true if the database contains no fingerprints.
+bool FingerprintDatabase::isEmpty() const
+{
+    return d->size == 0;
+}
+
+/// Returns \c true if the fingerprints are searched directly from a
+/// memory-mapped binary file.
+///
+/// Adding fingerprints to a mapped database first copies the
+/// existing fingerprints into memory.
+bool FingerprintDatabase::isMapped() const
+{
+    return d->file != 0;
+}
+
+/// Sets the number of threads to use for searching to \p count. If
+/// \p count is \c 0 the ideal thread count for the system is used.
+/// The default is ThreadPool::idealThreadCount().
+void FingerprintDatabase::setThreadCount(size_t count)
+{
+    if(count == 0){
+        count = ThreadPool::idealThreadCount();
+    }
+
+    if(count == d->threadCount){
+        return;
+    }
+
+    d->threadCount = count;
+    d->pool.reset(count > 1 ? new ThreadPool(count) : 0);
+}
+
+/// Returns the number of threads used for searching.
+size_t FingerprintDatabase::threadCount() const
+{
+    return d->threadCount;
+}
+
+// --- Fingerprints -------------------------------------------------------- //
+/// Adds \p fingerprint with \p id to the database. Bits past
+/// bitCount() are ignored.
+void FingerprintDatabase::addFingerprint(const Bitset &fingerprint, const std::string &id)
+{
+    if(d->bitCount == 0){
+        d->setBitCount(fingerprint.size());
+    }
+
+    Word *words = d->appendRecord(id);
+
+    for(size_t bit = fingerprint.find_first(); bit != Bitset::npos && bit < d->bitCount; bit = fingerprint.find_next(bit)){
+        words[bit / (sizeof(Word) * 8)] |= Word(1) << (bit % (sizeof(Word) * 8));
+    }
+
+    d->finishRecord();
+}
+
+/// Returns the fingerprint at \p index.
+Bitset FingerprintDatabase::fingerprint(size_t index) const
+{
+    updateOrder();
+
+    Bitset fingerprint(d->bitCount);
+
+    const Word *words = d->record(d->positions[index]);
+
+    for(size_t bit = 0; bit < d->bitCount; bit++){
+        if(words[bit / (sizeof(Word) * 8)] & (Word(1) << (bit % (sizeof(Word) * 8)))){
+            fingerprint.set(bit);
+        }
+    }
+
+    return fingerprint;
+}
+
+/// Returns the identifier for the fingerprint at \p index.
+std::string FingerprintDatabase::id(size_t index) const
+{
+    return d->id(index);
+}
+
+/// Reserves space for \p size fingerprints. This has no effect
+/// until the bit count is known.
+void FingerprintDatabase::reserve(size_t size)
+{
+    if(d->bitCount == 0){
+        return;
+    }
+
+    d->reserve(size);
+}
+
+/// Removes all of the fingerprints from the database.
+void FingerprintDatabase::clear()
+{
+    d->clear();
+}
+
+// --- Search -------------------------------------------------------------- //
+/// Returns the tanimoto coefficient between the fingerprint at
+/// \p index and \p query.
+Real FingerprintDatabase::similarity(size_t index, const Bitset &query) const
+{
+    updateOrder();
+
+    std::vector<Word> words = queryWords(query);
+    size_t queryCount = d->intersectionCount(&words[0], &words[0], d->wordCount);
+
+    size_t slot = d->positions[index];
+    size_t intersection = d->intersectionCount(&words[0], d->record(slot), d->wordCount);
+
+    return similarityValue(intersection, queryCount, d->counts[slot]);
+}
+
+/// Returns each fingerprint with a tanimoto coefficient of at least
+/// \p threshold to \p query. The hits contain the index of each
+/// fingerprint and its similarity and are sorted by decreasing
+/// similarity.
+std::vector<FingerprintDatabase::Hit> FingerprintDatabase::search(const Bitset &query, Real threshold) const
+{
+    std::vector<Hit> hits;
+    if(d->size == 0){
+        return hits;
+    }
+
+    updateOrder();
+
+    std::vector<Word> words = queryWords(query);
+    size_t queryCount = d->intersectionCount(&words[0], &words[0], d->wordCount);
+
+    // only fingerprints with between threshold * queryCount and
+    // queryCount / threshold bits set can reach the threshold
+    size_t begin = 0;
+    size_t end = d->size;
+
+    if(threshold > 0){
+        boost::uint32_t minimumCount = static_cast<boost::uint32_t>(std::floor(threshold * queryCount));
+        boost::uint32_t maximumCount = static_cast<boost::uint32_t>(std::ceil(queryCount / threshold));
+
+        begin = std::lower_bound(d->counts, d->counts + d->size, minimumCount) - d->counts;
+        end = std::upper_bound(d->counts + begin, d->counts + d->size, maximumCount) - d->counts;
+    }
+
+    size_t chunkCount = (end - begin + d->chunkSize - 1) / d->chunkSize;
+    std::vector<std::vector<Hit> > chunkHits(chunkCount);
+
+    if(d->threadCount == 1 || chunkCount < 2){
+        for(size_t i = 0; i < chunkCount; i++){
+            size_t chunkBegin = begin + i * d->chunkSize;
+            searchChunk(&words[0], queryCount, threshold, chunkBegin, std::min(chunkBegin + d->chunkSize, end), &chunkHits[i]);
+        }
+    }
+    else{
+        // only wait for this query's chunks so that concurrent
+        // queries sharing the pool do not wait on each other
+        TaskGroup group(d->pool.get());
+
+        for(size_t i = 0; i < chunkCount; i++){
+            size_t chunkBegin = begin + i * d->chunkSize;
+
+            group.start(boost::bind(&FingerprintDatabase::searchChunk,
+                                    this,
+                                    &words[0],
+                                    queryCount,
+                                    threshold,
+                                    chunkBegin,
+                                    std::min(chunkBegin + d->chunkSize, end),
+                                    &chunkHits[i]));
+        }
+
+        group.wait();
+    }
+
+    foreach(const std::vector<Hit> &chunk, chunkHits){
+        hits.insert(hits.end(), chunk.begin(), chunk.end());
+    }
+
+    std::sort(hits.begin(), hits.end(), hitLessThan);
+
+    return hits;
+}
+
+/// Returns the \p k fingerprints most similar to \p query. The hits
+/// contain the index of each fingerprint and its similarity and are
+/// sorted by decreasing similarity. Fingerprints with the same
+/// similarity are ordered by index.
+std::vector<FingerprintDatabase::Hit> FingerprintDatabase::nearest(const Bitset &query, size_t k) const
+{
+    std::vector<Hit> hits;
+    if(d->size == 0 || k == 0){
+        return hits;
+    }
+
+    updateOrder();
+
+    std::vector<Word> words = queryWords(query);
+    size_t queryCount = d->intersectionCount(&words[0], &words[0], d->wordCount);
+
+    // search the chunks with the highest similarity bound first so
+    // that the k-th nearest similarity is raised as early as possible
+    size_t chunkCount = (d->size + d->chunkSize - 1) / d->chunkSize;
+    std::vector<std::pair<Real, size_t> > chunks;
+
+    for(size_t i = 0; i < chunkCount; i++){
+        size_t begin = i * d->chunkSize;
+        size_t end = std::min(begin + d->chunkSize, d->size);
+        size_t minimumCount = d->counts[begin];
+        size_t maximumCount = d->counts[end-1];
+
+        Real bound;
+        if(queryCount >= minimumCount && queryCount <= maximumCount){
+            bound = 1;
+        }
+        else if(queryCount < minimumCount){
+            bound = similarityBound(queryCount, minimumCount);
+        }
+        else{
+            bound = similarityBound(queryCount, maximumCount);
+        }
+
+        chunks.push_back(std::make_pair(-bound, i));
+    }
+
+    std::sort(chunks.begin(), chunks.end());
+
+    Real nearestBound = -1;
+    std::vector<std::vector<Hit> > chunkHits(chunkCount);
+
+    if(d->threadCount == 1 || chunkCount < 2){
+        for(size_t i = 0; i < chunkCount; i++){
+            size_t begin = chunks[i].second * d->chunkSize;
+            nearestChunk(&words[0], queryCount, k, begin, std::min(begin + d->chunkSize, d->size), &nearestBound, &chunkHits[i]);
+        }
+    }
+    else{
+        // only wait for this query's chunks so that concurrent
+        // queries sharing the pool do not wait on each other
+        TaskGroup group(d->pool.get());
+
+        for(size_t i = 0; i < chunkCount; i++){
+            size_t begin = chunks[i].second * d->chunkSize;
+
+            group.start(boost::bind(&FingerprintDatabase::nearestChunk,
+                                    this,
+                                    &words[0],
+                                    queryCount,
+                                    k,
+                                    begin,
+                                    std::min(begin + d->chunkSize, d->size),
+                                    &nearestBound,
+                                    &chunkHits[i]));
+        }
+
+        group.wait();
+    }
+
+    foreach(const std::vector<Hit> &chunk, chunkHits){
+        hits.insert(hits.end(), chunk.begin(), chunk.end());
+    }
+
+    std::sort(hits.begin(), hits.end(), hitLessThan);
+    if(hits.size() > k){
+        hits.resize(k);
+    }
+
+    return hits;
+}
+
+// --- Input and Output ---------------------------------------------------- //
+/// Reads fingerprints from the file at \p fileName. Returns
+/// \c false if an error occurs.
+///
+/// Files in the binary format are memory-mapped and searched without
+/// copying the fingerprints. Any other file is read as an FPS file.
+///
+/// Reference:
+///   http://code.google.com/p/chem-fingerprints/wiki/FPS
+bool FingerprintDatabase::read(const std::string &fileName)
+{
+    std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+    if(!file.is_open()){
+        setErrorString("Failed to open '" + fileName + "' for reading.");
+        return false;
+    }
+
+    char magic[sizeof(BinaryMagic)];
+    file.read(magic, sizeof(magic));
+    if(file.gcount() == sizeof(magic) && std::memcmp(magic, BinaryMagic, sizeof(magic)) == 0){
+        file.close();
+        return readBinary(fileName);
+    }
+
+    file.clear();
+    file.seekg(0);
+
+    return read(file);
+}
+
+/// Reads fingerprints in the FPS format from \p input. Any existing
+/// fingerprints in the database are removed. Returns \c false if an
+/// error occurs.
+bool FingerprintDatabase::read(std::istream &input)
+{
+    clear();
+    d->name.clear();
+
+    std::string line;
+    size_t lineNumber = 0;
+    size_t headerBitCount = 0;
+
+    while(std::getline(input, line)){
+        lineNumber++;
+
+        if(!line.empty() && line[line.size()-1] == '\r'){
+            line.erase(line.size() - 1);
+        }
+
+        if(line.empty()){
+            continue;
+        }
+
+        // header lines
+        if(line[0] == '#'){
+            if(line.compare(0, 10, "#num_bits=") == 0){
+                headerBitCount = std::atoi(line.c_str() + 10);
+            }
+            else if(line.compare(0, 6, "#type=") == 0){
+                d->name = line.substr(6);
+            }
+
+            continue;
+        }
+
+        // fingerprint lines contain the hex-encoded fingerprint
+        // followed by a tab and the identifier
+        size_t hexLength = line.find('\t');
+        if(hexLength == std::string::npos){
+            hexLength = line.size();
+        }
+
+        if(d->size == 0){
+            d->setBitCount(headerBitCount ? headerBitCount : hexLength * 4);
+        }
+
+        size_t byteCount = (d->bitCount + 7) / 8;
+        if(hexLength % 2 != 0 || hexLength < byteCount * 2 || hexLength / 2 > d->wordCount * sizeof(Word)){
+            std::stringstream error;
+            error << "Invalid fingerprint length on line " << lineNumber << ".";
+            setErrorString(error.str());
+            clear();
+            return false;
+        }
+
+        std::string id;
+        if(hexLength < line.size()){
+            size_t idEnd = line.find('\t', hexLength + 1);
+            id = line.substr(hexLength + 1, idEnd == std::string::npos ? std::string::npos : idEnd - hexLength - 1);
+        }
+
+        Word *words = d->appendRecord(id);
+
+        // bytes are stored in little-endian order
+        for(size_t i = 0; i < hexLength / 2; i++){
+            int high = hexValue(line[2*i]);
+            int low = hexValue(line[2*i+1]);
+
+            if(high < 0 || low < 0){
+                std::stringstream error;
+                error << "Invalid hex character in fingerprint on line " << lineNumber << ".";
+                setErrorString(error.str());
+                clear();
+                return false;
+            }
+
+            words[i / sizeof(Word)] |= Word((high << 4) | low) << (8 * (i % sizeof(Word)));
+        }
+
+        d->finishRecord();
+    }
+
+    return true;
+}
+
+/// Writes the fingerprints to the file at \p fileName in
+/// \p format. Returns \c false if an error occurs.
+///
+/// For example, to convert an FPS file to the binary format:
+/// \code
+/// FingerprintDatabase database;
+/// database.read("fingerprints.fps");
+/// database.write("fingerprints.ckfp", FingerprintDatabase::BinaryFormat);
+/// \endcode
+bool FingerprintDatabase::write(const std::string &fileName, Format format) const
+{
+    std::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary);
+    if(!file.is_open()){
+        setErrorString("Failed to open '" + fileName + "' for writing.");
+        return false;
+    }
+
+    return write(file, format);
+}
+
+/// Writes the fingerprints to \p output in \p format. Returns
+/// \c false if an error occurs.
+bool FingerprintDatabase::write(std::ostream &output, Format format) const
+{
+    if(format == BinaryFormat){
+        return writeBinary(output);
+    }
+
+    return writeFps(output);
+}
+
+// --- Error Handling ------------------------------------------------------ //
+/// Returns a string describing the last error that occurred.
+std::string FingerprintDatabase::errorString() const
+{
+    return d->errorString;
+}
+
+void FingerprintDatabase::setErrorString(const std::string &error) const
+{
+    d->errorString = error;
+}
+
+// --- Internal Methods ---------------------------------------------------- //
+// Maps the binary fingerprint file at fileName.
+bool FingerprintDatabase::readBinary(const std::string &fileName)
+{
+    boost::scoped_ptr<boost::iostreams::mapped_file_source> file;
+
+    try {
+        file.reset(new boost::iostreams::mapped_file_source(fileName));
+    }
+    catch(std::exception &e){
+        setErrorString("Failed to map '" + fileName + "': " + e.what());
+        return false;
+    }
+
+    boost::uint64_t fileSize = file->size();
+
+    BinaryHeader header;
+    if(fileSize < sizeof(header)){
+        setErrorString("Binary fingerprint file is truncated.");
+        return false;
+    }
+
+    std::memcpy(&header, file->data(), sizeof(header));
+
+    if(header.version != BinaryVersion){
+        setErrorString("Binary fingerprint file version is not supported.");
+        return false;
+    }
+    else if(header.byteOrder != BinaryByteOrder){
+        setErrorString("Binary fingerprint file has a different byte order.");
+        return false;
+    }
+
+    clear();
+    d->setBitCount(header.bitCount);
+
+    // verify that each section fits in the file. the count is checked
+    // against the file size before any offsets are computed from it so
+    // that none of them can overflow
+    const boost::uint64_t bytesPerFingerprint = header.recordSize + sizeof(boost::uint32_t) + 2 * sizeof(boost::uint64_t);
+
+    bool valid = header.recordSize == d->wordCount * sizeof(Word) &&
+                 header.bitCount <= header.recordSize * 8 &&
+                 header.recordOffset % 64 == 0 &&
+                 header.recordOffset >= sizeof(header) &&
+                 header.recordOffset <= fileSize &&
+                 header.nameLength <= header.recordOffset - sizeof(header) &&
+                 header.count <= (fileSize - header.recordOffset) / bytesPerFingerprint;
+
+    boost::uint64_t countOffset = 0;
+    boost::uint64_t indexOffset = 0;
+    boost::uint64_t positionOffset = 0;
+    boost::uint64_t positionEnd = 0;
+
+    if(valid){
+        countOffset = header.recordOffset + header.count * header.recordSize;
+        indexOffset = alignOffset(countOffset + header.count * sizeof(boost::uint32_t), sizeof(boost::uint64_t));
+        positionOffset = indexOffset + header.count * sizeof(boost::uint64_t);
+        positionEnd = positionOffset + header.count * sizeof(boost::uint64_t);
+        valid = positionEnd <= fileSize;
+    }
+
+    if(valid && header.idOffset){
+        valid = header.idOffset == positionEnd &&
+                header.count < (fileSize - header.idOffset) / sizeof(boost::uint64_t);
+    }
+
+    const char *data = file->data();
+    const boost::uint64_t *indices = reinterpret_cast<const boost::uint64_t *>(data + indexOffset);
+    const boost::uint64_t *positions = reinterpret_cast<const boost::uint64_t *>(data + positionOffset);
+    const boost::uint64_t *idOffsets = 0;
+    const char *idData = 0;
+
+    // the index and position tables must be inverse permutations
+    for(boost::uint64_t slot = 0; valid && slot < header.count; slot++){
+        valid = indices[slot] < header.count && positions[indices[slot]] == slot;
+    }
+
+    if(valid && header.idOffset){
+        idOffsets = reinterpret_cast<const boost::uint64_t *>(data + header.idOffset);
+        idData = data + header.idOffset + (header.count + 1) * sizeof(boost::uint64_t);
+
+        for(boost::uint64_t i = 0; valid && i < header.count; i++){
+            valid = idOffsets[i] <= idOffsets[i+1];
+        }
+
+        valid = valid && idOffsets[header.count] <= fileSize - (idData - data);
+    }
+
+    if(!valid){
+        setErrorString("Binary fingerprint file is invalid.");
+        d->setBitCount(0);
+        return false;
+    }
+
+    d->name = std::string(data + sizeof(header), header.nameLength);
+    d->size = header.count;
+    d->data = reinterpret_cast<const Word *>(data + header.recordOffset);
+    d->counts = reinterpret_cast<const boost::uint32_t *>(data + countOffset);
+    d->indices = indices;
+    d->positions = positions;
+    d->idOffsets = idOffsets;
+    d->idData = idData;
+    d->file.swap(file);
+
+    return true;
+}
+
+// Writes the fingerprints in the FPS format to output.
+bool FingerprintDatabase::writeFps(std::ostream &output) const
+{
+    updateOrder();
+
+    const char *digits = "0123456789abcdef";
+
+    output << "#FPS1\n";
+    output << "#num_bits=" << d->bitCount << "\n";
+    if(!d->name.empty()){
+        output << "#type=" << d->name << "\n";
+    }
+    output << "#software=chemkit/" << CHEMKIT_VERSION_STRING << "\n";
+
+    size_t byteCount = (d->bitCount + 7) / 8;
+    std::string line;
+
+    for(size_t index = 0; index < d->size; index++){
+        const Word *words = d->record(d->positions[index]);
+
+        line.clear();
+        for(size_t i = 0; i < byteCount; i++){
+            unsigned int byte = (words[i / sizeof(Word)] >> (8 * (i % sizeof(Word)))) & 0xff;
+            line += digits[byte >> 4];
+            line += digits[byte & 0x0f];
+        }
+
+        output << line << "\t" << d->id(index) << "\n";
+    }
+
+    return !output.fail();
+}
+
+// Writes the fingerprints in the binary format to output.
+bool FingerprintDatabase::writeBinary(std::ostream &output) const
+{
+    updateOrder();
+
+    bool hasIds = false;
+    for(size_t i = 0; i < d->size && !hasIds; i++){
+        hasIds = !d->id(i).empty();
+    }
+
+    BinaryHeader header;
+    std::memcpy(header.magic, BinaryMagic, sizeof(BinaryMagic));
+    header.version = BinaryVersion;
+    header.byteOrder = BinaryByteOrder;
+    header.bitCount = d->bitCount;
+    header.recordSize = d->wordCount * sizeof(Word);
+    header.count = d->size;
+    header.nameLength = d->name.size();
+    header.recordOffset = alignOffset(sizeof(header) + header.nameLength, 64);
+
+    boost::uint64_t countEnd = header.recordOffset + header.count * header.recordSize +
+                               header.count * sizeof(boost::uint32_t);
+    boost::uint64_t indexOffset = alignOffset(countEnd, sizeof(boost::uint64_t));
+    boost::uint64_t positionEnd = indexOffset + 2 * header.count * sizeof(boost::uint64_t);
+    header.idOffset = hasIds ? positionEnd : 0;
+
+    // header and name
+    output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    output.write(d->name.data(), d->name.size());
+    writePadding(output, sizeof(header) + header.nameLength, header.recordOffset);
+
+    // records and tables
+    if(d->size){
+        output.write(reinterpret_cast<const char *>(d->data), header.count * header.recordSize);
+        output.write(reinterpret_cast<const char *>(d->counts), header.count * sizeof(boost::uint32_t));
+        writePadding(output, countEnd, indexOffset);
+        output.write(reinterpret_cast<const char *>(d->indices), header.count * sizeof(boost::uint64_t));
+        output.write(reinterpret_cast<const char *>(d->positions), header.count * sizeof(boost::uint64_t));
+    }
+
+    // identifiers
+    if(hasIds){
+        boost::uint64_t offset = 0;
+        output.write(reinterpret_cast<const char *>(&offset), sizeof(offset));
+        for(size_t i = 0; i < d->size; i++){
+            offset += d->id(i).size();
+            output.write(reinterpret_cast<const char *>(&offset), sizeof(offset));
+        }
+
+        for(size_t i = 0; i < d->size; i++){
+            std::string id = d->id(i);
+            output.write(id.data(), id.size());
+        }
+    }
+
+    return !output.fail();
+}
+
+// Sorts the records by the number of bits set if they were not
+// added in sorted order.
+void FingerprintDatabase::updateOrder() const
+{
+    if(d->sorted){
+        return;
+    }
+
+    boost::mutex::scoped_lock lock(d->sortMutex);
+
+    if(!d->sorted){
+        d->sort();
+        d->sorted = true;
+    }
+}
+
+// Adds each fingerprint in the slots [begin, end) with a similarity
+// of at least threshold to hits.
+void FingerprintDatabase::searchChunk(const Word *query,
+                                      size_t queryCount,
+                                      Real threshold,
+                                      size_t begin,
+                                      size_t end,
+                                      std::vector<Hit> *hits) const
+{
+    for(size_t slot = begin; slot < end; slot++){
+        size_t intersection = d->intersectionCount(query, d->record(slot), d->wordCount);
+        Real similarity = similarityValue(intersection, queryCount, d->counts[slot]);
+
+        if(similarity >= threshold){
+            hits->push_back(Hit(d->indices[slot], similarity));
+        }
+    }
+}
+
+// Sets hits to the k most similar fingerprints in the slots
+// [begin, end). Fingerprints whose similarity bound is below the
+// k-th nearest similarity found so far are skipped.
+void FingerprintDatabase::nearestChunk(const Word *query,
+                                       size_t queryCount,
+                                       size_t k,
+                                       size_t begin,
+                                       size_t end,
+                                       Real *nearestBound,
+                                       std::vector<Hit> *hits) const
+{
+    // heap with the least similar hit on top
+    std::priority_queue<Hit, std::vector<Hit>, HitLessThan> heap;
+
+    Real bound = -1;
+    {
+        boost::mutex::scoped_lock lock(d->nearestMutex);
+        bound = *nearestBound;
+    }
+
+    for(size_t slot = begin; slot < end; slot++){
+        size_t count = d->counts[slot];
+
+        if(similarityBound(queryCount, count) < bound){
+            // the bound only decreases once past the query count
+            if(count > queryCount){
+                break;
+            }
+
+            continue;
+        }
+
+        size_t intersection = d->intersectionCount(query, d->record(slot), d->wordCount);
+        Hit hit(d->indices[slot], similarityValue(intersection, queryCount, count));
+
+        if(heap.size() < k){
+            heap.push(hit);
+        }
+        else if(hitLessThan(hit, heap.top())){
+            heap.pop();
+            heap.push(hit);
+        }
+
+        if(heap.size() == k){
+            bound = std::max(bound, heap.top().second);
+        }
+    }
+
+    // share the k-th nearest similarity with the other chunks
+    if(heap.size() == k){
+        boost::mutex::scoped_lock lock(d->nearestMutex);
+        *nearestBound = std::max(*nearestBound, heap.top().second);
+    }
+
+    hits->reserve(heap.size());
+    while(!heap.empty()){
+        hits->push_back(heap.top());
+        heap.pop();
+    }
+}
+
+// Returns the query fingerprint as words padded to the record size.
+std::vector<Word> FingerprintDatabase::queryWords(const Bitset &query) const
+{
+    std::vector<Word> words(std::max(d->wordCount, WordsPerLine), Word(0));
+
+    for(size_t bit = query.find_first(); bit != Bitset::npos && bit < d->bitCount; bit = query.find_next(bit)){
+        words[bit / (sizeof(Word) * 8)] |= Word(1) << (bit % (sizeof(Word) * 8));
+    }
+
+    return words;
+}
+
+} // end chemkit namespace
@@ -0,0 +1,131 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#ifndef CHEMKIT_FINGERPRINTDATABASE_H
+#define CHEMKIT_FINGERPRINTDATABASE_H
+
+#include "chemkit.h"
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <istream>
+#include <ostream>
+
+#include <boost/cstdint.hpp>
+
+#include "bitset.h"
+
+namespace chemkit {
+
+class FingerprintDatabasePrivate;
+
+class CHEMKIT_EXPORT FingerprintDatabase
+{
+public:
+    // typedefs
+    typedef std::pair<size_t, Real> Hit;
+
+    // enumerations
+    enum Format {
+        FpsFormat,
+        BinaryFormat
+    };
+
+    // construction and destruction
+    FingerprintDatabase(size_t bitCount = 0);
+    ~FingerprintDatabase();
+
+    // properties
+    size_t bitCount() const;
+    void setName(const std::string &name);
+    std::string name() const;
+    size_t size() const;
+    bool isEmpty() const;
+    bool isMapped() const;
+    void setThreadCount(size_t count);
+    size_t threadCount() const;
+
+    // fingerprints
+    void addFingerprint(const Bitset &fingerprint, const std::string &id = std::string());
+    Bitset fingerprint(size_t index) const;
+    std::string id(size_t index) const;
+    void reserve(size_t size);
+    void clear();
+
+    // search
+    Real similarity(size_t index, const Bitset &query) const;
+    std::vector<Hit> search(const Bitset &query, Real threshold) const;
+    std::vector<Hit> nearest(const Bitset &query, size_t k) const;
+
+    // input and output
+    bool read(const std::string &fileName);
+    bool read(std::istream &input);
+    bool write(const std::string &fileName, Format format = FpsFormat) const;
+    bool write(std::ostream &output, Format format = FpsFormat) const;
+
+    // error handling
+    std::string errorString() const;
+
+private:
+    CHEMKIT_DISABLE_COPY(FingerprintDatabase)
+
+    void setErrorString(const std::string &error) const;
+    bool readBinary(const std::string &fileName);
+    bool writeFps(std::ostream &output) const;
+    bool writeBinary(std::ostream &output) const;
+    void updateOrder() const;
+    void searchChunk(const boost::uint64_t *query,
+                     size_t queryCount,
+                     Real threshold,
+                     size_t begin,
+                     size_t end,
+                     std::vector<Hit> *hits) const;
+    void nearestChunk(const boost::uint64_t *query,
+                      size_t queryCount,
+                      size_t k,
+                      size_t begin,
+                      size_t end,
+                      Real *nearestBound,
+                      std::vector<Hit> *hits) const;
+    std::vector<boost::uint64_t> queryWords(const Bitset &query) const;
+
+private:
+    FingerprintDatabasePrivate* const d;
+};
+
+} // end chemkit namespace
+
+#endif // CHEMKIT_FINGERPRINTDATABASE_H
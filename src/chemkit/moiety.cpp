@@ -65,6 +65,13 @@ Moiety::Moiety(const std::vector<Atom *> &atoms)
     d->atoms = atoms;
 }
 
+/// Creates a new moiety object as a copy of \p moiety.
+Moiety::Moiety(const Moiety &moiety)
+    : d(new MoietyPrivate)
+{
+    d->atoms = moiety.d->atoms;
+}
+
 /// Destroys the moiety object.
 Moiety::~Moiety()
 {
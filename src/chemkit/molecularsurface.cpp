@@ -39,6 +39,8 @@
 
 #include "molecularsurface.h"
 
+#include <algorithm>
+
 #include <boost/bind.hpp>
 #include <boost/thread.hpp>
 
@@ -46,9 +48,13 @@
 #include "foreach.h"
 #include "vector3.h"
 #include "geometry.h"
+#include "residue.h"
+#include "celllist.h"
 #include "molecule.h"
 #include "alphashape.h"
 #include "concurrent.h"
+#include "taskgroup.h"
+#include "threadpool.h"
 #include "delaunaytriangulation.h"
 
 namespace chemkit {
@@ -68,6 +74,26 @@ Real angleDihedral(const Point3 &s, const Point3 &t, const Point3 &u, const Poin
     return acos(nu.dot(nv)) / (2.0 * pi);
 }
 
+// Returns count points evenly distributed on the unit sphere along
+// a golden section spiral.
+std::vector<Vector3> spherePoints(size_t count)
+{
+    std::vector<Vector3> points(count);
+
+    const Real increment = pi * (3.0 - std::sqrt(5.0));
+    const Real offset = 2.0 / count;
+
+    for(size_t i = 0; i < count; i++){
+        Real y = i * offset - 1 + (offset / 2);
+        Real r = std::sqrt(std::max(Real(0), 1 - y * y));
+        Real phi = i * increment;
+
+        points[i] = Vector3(std::cos(phi) * r, y, std::sin(phi) * r);
+    }
+
+    return points;
+}
+
 } // end anonymous namespace
 
 // === MolecularSurfacePrivate ============================================= //
@@ -84,6 +110,10 @@ public:
     Real surfaceArea;
     bool volumeCalculated;
     bool surfaceAreaCalculated;
+    size_t pointCount;
+    size_t threadCount;
+    std::vector<Real> atomSurfaceAreas;
+    bool atomSurfaceAreasCalculated;
 };
 
 // === MolecularSurface ==================================================== //
@@ -107,6 +137,18 @@ public:
 /// // calculate the surface area
 /// double area = surface.surfaceArea();
 /// \endcode
+///
+/// The total volume and surface area are calculated exactly from the
+/// alpha shape of the spheres. The surface area of each atom is
+/// calculated with the Shrake-Rupley algorithm which places
+/// pointCount() points on each sphere and counts the points that are
+/// not buried by any other sphere. It does not require the alpha
+/// shape and is much faster for large molecules.
+///
+/// \code
+/// // calculate the solvent accessible surface area of each atom
+/// std::vector<Real> areas = surface.atomSurfaceAreas();
+/// \endcode
 
 /// \enum MolecularSurface::SurfaceType
 /// Provides names for each of the available surface types:
@@ -136,6 +178,9 @@ MolecularSurface::MolecularSurface(const Molecule *molecule, SurfaceType type)
     d->alphaShape = 0;
     d->volumeCalculated = false;
     d->surfaceAreaCalculated = false;
+    d->pointCount = 960;
+    d->threadCount = ThreadPool::idealThreadCount();
+    d->atomSurfaceAreasCalculated = false;
 }
 
 /// Destroys the molecular surface object.
@@ -204,6 +249,44 @@ Real MolecularSurface::probeRadius() const
     return d->probeRadius;
 }
 
+/// Sets the number of points placed on each sphere to calculate the
+/// surface area of each atom to \p count. More points give more
+/// accurate areas at the cost of speed. The default is \c 960.
+///
+/// \see atomSurfaceArea()
+void MolecularSurface::setPointCount(size_t count)
+{
+    d->pointCount = std::max<size_t>(count, 1);
+
+    d->atomSurfaceAreasCalculated = false;
+}
+
+/// Returns the number of points placed on each sphere.
+size_t MolecularSurface::pointCount() const
+{
+    return d->pointCount;
+}
+
+/// Sets the number of threads used to calculate the surface area of
+/// each atom to \p count. If \p count is \c 0 the ideal thread count
+/// for the system is used, which is also the default. The atoms are
+/// calculated in blocks on the global ThreadPool.
+void MolecularSurface::setThreadCount(size_t count)
+{
+    if(count == 0){
+        count = ThreadPool::idealThreadCount();
+    }
+
+    d->threadCount = count;
+}
+
+/// Returns the number of threads used to calculate the surface area
+/// of each atom.
+size_t MolecularSurface::threadCount() const
+{
+    return d->threadCount;
+}
+
 const AlphaShape* MolecularSurface::alphaShape() const
 {
     if(!d->alphaShape){
@@ -327,6 +410,43 @@ boost::shared_future<Real> MolecularSurface::surfaceAreaAsync() const
     return chemkit::concurrent::run(boost::bind(&MolecularSurface::surfaceArea, this));
 }
 
+/// Returns the surface area of the atom at \p index. The returned
+/// area is in Angstroms squared (\f$ \AA^{2} \f$).
+///
+/// \see atomSurfaceAreas()
+Real MolecularSurface::atomSurfaceArea(int index) const
+{
+    calculateAtomSurfaceAreas();
+
+    return d->atomSurfaceAreas[index];
+}
+
+/// Returns the surface area of each atom. The sum of the areas
+/// approximates surfaceArea().
+///
+/// \see setPointCount()
+std::vector<Real> MolecularSurface::atomSurfaceAreas() const
+{
+    calculateAtomSurfaceAreas();
+
+    return d->atomSurfaceAreas;
+}
+
+/// Returns the total surface area of the atoms in \p residue. The
+/// residue must be a part of the surface's molecule.
+Real MolecularSurface::residueSurfaceArea(const Residue *residue) const
+{
+    calculateAtomSurfaceAreas();
+
+    Real area = 0;
+
+    foreach(const Atom *atom, residue->atoms()){
+        area += d->atomSurfaceAreas[atom->index()];
+    }
+
+    return area;
+}
+
 // --- Internal Methods ---------------------------------------------------- //
 void MolecularSurface::setCalculated(bool calculated) const
 {
@@ -335,6 +455,127 @@ void MolecularSurface::setCalculated(bool calculated) const
         d->alphaShape = 0;
         d->volumeCalculated = false;
         d->surfaceAreaCalculated = false;
+        d->atomSurfaceAreasCalculated = false;
+    }
+}
+
+// Calculates the surface area of each atom. The atoms are sorted into
+// a cell list which is used to find the overlapping spheres. The atoms
+// are then split into blocks which are calculated in parallel.
+void MolecularSurface::calculateAtomSurfaceAreas() const
+{
+    if(d->atomSurfaceAreasCalculated){
+        return;
+    }
+
+    size_t size = d->points.size();
+    d->atomSurfaceAreas.assign(size, 0);
+
+    if(size == 0){
+        d->atomSurfaceAreasCalculated = true;
+        return;
+    }
+
+    Real maximumRadius = 0;
+    for(size_t i = 0; i < size; i++){
+        maximumRadius = std::max(maximumRadius, radius(i));
+    }
+
+    CellList cellList(d->points, 2 * maximumRadius);
+
+    size_t blockCount = std::min(size, 4 * d->threadCount);
+
+    if(d->threadCount < 2 || blockCount < 2){
+        calculateAtomSurfaceAreas(cellList, maximumRadius, 0, size);
+    }
+    else{
+        TaskGroup group(ThreadPool::globalInstance());
+
+        for(size_t block = 0; block < blockCount; block++){
+            group.start(boost::bind(&MolecularSurface::calculateAtomSurfaceAreas,
+                                   this,
+                                   boost::cref(cellList),
+                                   maximumRadius,
+                                   size * block / blockCount,
+                                   size * (block + 1) / blockCount));
+        }
+
+        group.wait();
+    }
+
+    d->atomSurfaceAreasCalculated = true;
+}
+
+// Calculates the surface area of the atoms from begin to end. The
+// overlapping spheres are found with cellList whose largest sphere
+// has maximumRadius.
+void MolecularSurface::calculateAtomSurfaceAreas(const CellList &cellList,
+                                                 Real maximumRadius,
+                                                 size_t begin,
+                                                 size_t end) const
+{
+    const std::vector<Vector3> points = spherePoints(d->pointCount);
+
+    std::vector<std::pair<Real, size_t> > neighbors;
+    std::vector<Point3> neighborPositions;
+    std::vector<Real> neighborRadiiSquared;
+
+    for(size_t i = begin; i < end; i++){
+        const Point3 &center = d->points[i];
+        const Real r = radius(i);
+
+        // find the spheres which overlap the sphere
+        neighbors.clear();
+        foreach(size_t j, cellList.neighbors(center, r + maximumRadius)){
+            if(j == i){
+                continue;
+            }
+
+            Real distance = (d->points[j] - center).norm();
+            if(distance < r + radius(j)){
+                neighbors.push_back(std::make_pair(distance, j));
+            }
+        }
+
+        // check the closest spheres first
+        std::sort(neighbors.begin(), neighbors.end());
+
+        neighborPositions.resize(neighbors.size());
+        neighborRadiiSquared.resize(neighbors.size());
+        for(size_t k = 0; k < neighbors.size(); k++){
+            neighborPositions[k] = d->points[neighbors[k].second];
+            neighborRadiiSquared[k] = radius(neighbors[k].second) * radius(neighbors[k].second);
+        }
+
+        // count the points which are not inside any other sphere. the
+        // sphere which buried the previous point is checked first.
+        size_t accessibleCount = 0;
+        size_t lastBuried = 0;
+
+        foreach(const Vector3 &direction, points){
+            Point3 point = center + r * direction;
+
+            bool buried = false;
+            if(!neighbors.empty() &&
+               (point - neighborPositions[lastBuried]).squaredNorm() < neighborRadiiSquared[lastBuried]){
+                buried = true;
+            }
+            else{
+                for(size_t k = 0; k < neighbors.size(); k++){
+                    if((point - neighborPositions[k]).squaredNorm() < neighborRadiiSquared[k]){
+                        lastBuried = k;
+                        buried = true;
+                        break;
+                    }
+                }
+            }
+
+            if(!buried){
+                accessibleCount++;
+            }
+        }
+
+        d->atomSurfaceAreas[i] = 4.0 * pi * r * r * accessibleCount / points.size();
     }
 }
 
@@ -38,13 +38,17 @@
 
 #include "chemkit.h"
 
+#include <vector>
+
 #include <boost/thread/future.hpp>
 
 #include "point3.h"
 
 namespace chemkit {
 
+class Residue;
 class Molecule;
+class CellList;
 class AlphaShape;
 class MolecularSurfacePrivate;
 
@@ -69,6 +73,10 @@ public:
     SurfaceType surfaceType() const;
     void setProbeRadius(Real radius);
     Real probeRadius() const;
+    void setPointCount(size_t count);
+    size_t pointCount() const;
+    void setThreadCount(size_t count);
+    size_t threadCount() const;
     const AlphaShape* alphaShape() const;
 
     // geometry
@@ -78,10 +86,15 @@ public:
     boost::shared_future<Real> volumeAsync() const;
     Real surfaceArea() const;
     boost::shared_future<Real> surfaceAreaAsync() const;
+    Real atomSurfaceArea(int index) const;
+    std::vector<Real> atomSurfaceAreas() const;
+    Real residueSurfaceArea(const Residue *residue) const;
 
 private:
     // internal methods
     void setCalculated(bool calculated) const;
+    void calculateAtomSurfaceAreas() const;
+    void calculateAtomSurfaceAreas(const CellList &cellList, Real maximumRadius, size_t begin, size_t end) const;
     Real intersectionArea(int i, int j) const;
     Real intersectionArea(int i, int j, int k) const;
     Real intersectionArea(int i, int j, int k, int l) const;
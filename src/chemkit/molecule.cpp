@@ -78,6 +78,7 @@ MoleculePrivate::MoleculePrivate()
 {
     fragmentsPerceived = false;
     ringsPerceived = false;
+    ringMembershipPerceived = false;
 }
 
 // === Molecule ============================================================ //
@@ -389,6 +390,7 @@ Atom* Molecule::addAtom(const Element &element)
     m_elements.push_back(element);
     d->atomBonds.push_back(std::vector<Bond *>());
     d->partialCharges.push_back(0);
+    d->ringMembershipPerceived = false;
 
     // set atom position
     if(m_coordinates){
@@ -451,6 +453,7 @@ void Molecule::removeAtom(Atom *atom)
     }
 
     atom->m_molecule = 0;
+    d->ringMembershipPerceived = false;
     setFragmentsPerceived(false);
     notifyWatchers(atom, MoleculeWatcher::AtomRemoved);
 
@@ -695,8 +698,10 @@ Molecule::RingRange Molecule::rings() const
     // only run ring perception if necessary
     if(!ringsPerceived()){
         // find rings
-        foreach(const std::vector<Atom *> &ring, chemkit::algorithm::rppath(this)){
-            d->rings.push_back(new Ring(ring));
+        foreach(const std::vector<Atom *> &path, chemkit::algorithm::rppath(this)){
+            Ring *ring = new Ring(path);
+            ring->m_index = d->rings.size();
+            d->rings.push_back(ring);
         }
 
         // set perceived to true
@@ -724,6 +729,11 @@ void Molecule::setRingsPerceived(bool perceived) const
         }
 
         d->rings.clear();
+
+        d->ringMembershipPerceived = false;
+        d->atomRings.clear();
+        d->bondRings.clear();
+        d->ringAromaticity.clear();
     }
 
     d->ringsPerceived = perceived;
@@ -734,6 +744,66 @@ bool Molecule::ringsPerceived() const
     return d->ringsPerceived;
 }
 
+// Builds the lists of rings containing each atom and each bond. The
+// lists are kept until the structure of the molecule changes so that
+// the ring queries on Atom and Bond are simple lookups.
+void Molecule::perceiveRingMembership() const
+{
+    if(d->ringMembershipPerceived){
+        return;
+    }
+
+    d->atomRings.assign(m_atoms.size(), std::vector<Ring *>());
+    d->bondRings.assign(d->bonds.size(), std::vector<Ring *>());
+
+    foreach(Ring *ring, rings()){
+        foreach(const Atom *atom, ring->atoms()){
+            d->atomRings[atom->index()].push_back(ring);
+        }
+
+        foreach(const Bond *bond, ring->bonds()){
+            d->bondRings[bond->index()].push_back(ring);
+        }
+    }
+
+    d->ringMembershipPerceived = true;
+}
+
+// Returns the rings which contain atom.
+const std::vector<Ring *>& Molecule::atomRings(const Atom *atom) const
+{
+    perceiveRingMembership();
+
+    return d->atomRings[atom->index()];
+}
+
+// Returns the rings which contain bond.
+const std::vector<Ring *>& Molecule::bondRings(const Bond *bond) const
+{
+    perceiveRingMembership();
+
+    return d->bondRings[bond->index()];
+}
+
+// Returns true if ring is aromatic. The aromaticity of each ring is
+// perceived once and then cached until the structure, bond orders or
+// elements of the molecule change.
+bool Molecule::isRingAromatic(const Ring *ring) const
+{
+    // values: 0 = not perceived, 1 = not aromatic, 2 = aromatic
+    std::vector<char> &aromaticity = d->ringAromaticity;
+    if(aromaticity.size() != d->rings.size()){
+        aromaticity.assign(d->rings.size(), 0);
+    }
+
+    char &value = aromaticity[ring->m_index];
+    if(value == 0){
+        value = ring->perceiveAromaticity() ? 2 : 1;
+    }
+
+    return value == 2;
+}
+
 // --- Fragment Perception-------------------------------------------------- //
 /// Returns the fragment at \p index.
 ///
@@ -169,6 +169,10 @@ private:
     // internal methods
     void setRingsPerceived(bool perceived) const;
     bool ringsPerceived() const;
+    void perceiveRingMembership() const;
+    const std::vector<Ring *>& atomRings(const Atom *atom) const;
+    const std::vector<Ring *>& bondRings(const Bond *bond) const;
+    bool isRingAromatic(const Ring *ring) const;
     void setFragmentsPerceived(bool perceived) const;
     bool fragmentsPerceived() const;
     void perceiveFragments() const;
@@ -182,6 +186,7 @@ private:
 
     friend class Atom;
     friend class Bond;
+    friend class Ring;
     friend class MoleculeWatcher;
 
 private:
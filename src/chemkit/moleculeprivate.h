@@ -65,6 +65,10 @@ public:
     std::vector<Bond *> bonds;
     bool ringsPerceived;
     std::vector<Ring *> rings;
+    bool ringMembershipPerceived;
+    std::vector<std::vector<Ring *> > atomRings;
+    std::vector<std::vector<Ring *> > bondRings;
+    std::vector<char> ringAromaticity;
     bool fragmentsPerceived;
     std::vector<Fragment *> fragments;
     std::vector<MoleculeWatcher *> watchers;
@@ -0,0 +1,295 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#ifndef CHEMKIT_PACKEDCOORDINATES_INLINE_H
+#define CHEMKIT_PACKEDCOORDINATES_INLINE_H
+
+#include "packedcoordinates.h"
+
+#include "cartesiancoordinates.h"
+
+namespace chemkit {
+
+// === PackedCoordinates =================================================== //
+/// \class PackedCoordinates packedcoordinates.h chemkit/packedcoordinates.h
+/// \ingroup chemkit
+/// \brief The PackedCoordinates class contains cartesian coordinates
+///        stored as separate x, y and z arrays.
+///
+/// Unlike CartesianCoordinates, which stores a Point3 for each
+/// position, the components of each position are stored in three
+/// contiguous arrays of type \c T. Using \c float halves the memory
+/// needed compared to CartesianCoordinates and the layout allows the
+/// bulk geometry operations to be vectorized.
+///
+/// The coordinates can be shared without copying through the
+/// PackedCoordinatesView objects returned from view().
+///
+/// \see CartesianCoordinates, PackedCoordinatesView
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new coordinates object with \p size positions at the
+/// origin.
+template<typename T>
+inline PackedCoordinates<T>::PackedCoordinates(size_t size)
+    : m_x(size),
+      m_y(size),
+      m_z(size)
+{
+}
+
+/// Creates a new coordinates object containing a copy of the
+/// positions in \p coordinates.
+template<typename T>
+inline PackedCoordinates<T>::PackedCoordinates(const CartesianCoordinates *coordinates)
+    : m_x(coordinates->size()),
+      m_y(coordinates->size()),
+      m_z(coordinates->size())
+{
+    view().assign(coordinates);
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Sets the number of positions to \p size. New positions are placed
+/// at the origin.
+template<typename T>
+inline void PackedCoordinates<T>::resize(size_t size)
+{
+    m_x.resize(size);
+    m_y.resize(size);
+    m_z.resize(size);
+}
+
+/// Returns the number of positions.
+template<typename T>
+inline size_t PackedCoordinates<T>::size() const
+{
+    return m_x.size();
+}
+
+/// Returns \c true if there are no positions.
+template<typename T>
+inline bool PackedCoordinates<T>::isEmpty() const
+{
+    return m_x.empty();
+}
+
+/// Returns a pointer to the x components of the coordinates.
+template<typename T>
+inline T* PackedCoordinates<T>::x()
+{
+    return isEmpty() ? 0 : &m_x[0];
+}
+
+/// \overload
+template<typename T>
+inline const T* PackedCoordinates<T>::x() const
+{
+    return isEmpty() ? 0 : &m_x[0];
+}
+
+/// Returns a pointer to the y components of the coordinates.
+template<typename T>
+inline T* PackedCoordinates<T>::y()
+{
+    return isEmpty() ? 0 : &m_y[0];
+}
+
+/// \overload
+template<typename T>
+inline const T* PackedCoordinates<T>::y() const
+{
+    return isEmpty() ? 0 : &m_y[0];
+}
+
+/// Returns a pointer to the z components of the coordinates.
+template<typename T>
+inline T* PackedCoordinates<T>::z()
+{
+    return isEmpty() ? 0 : &m_z[0];
+}
+
+/// \overload
+template<typename T>
+inline const T* PackedCoordinates<T>::z() const
+{
+    return isEmpty() ? 0 : &m_z[0];
+}
+
+// --- Coordinates --------------------------------------------------------- //
+/// Sets the position at \p index to \p position.
+template<typename T>
+inline void PackedCoordinates<T>::setPosition(size_t index, const Point3 &position)
+{
+    setPosition(index, position.x(), position.y(), position.z());
+}
+
+/// Sets the position at \p index to (\p x, \p y, \p z).
+template<typename T>
+inline void PackedCoordinates<T>::setPosition(size_t index, Real x, Real y, Real z)
+{
+    m_x[index] = static_cast<T>(x);
+    m_y[index] = static_cast<T>(y);
+    m_z[index] = static_cast<T>(z);
+}
+
+/// Returns the position at \p index.
+template<typename T>
+inline Point3 PackedCoordinates<T>::position(size_t index) const
+{
+    return Point3(m_x[index], m_y[index], m_z[index]);
+}
+
+/// Appends \p position to the coordinates.
+template<typename T>
+inline void PackedCoordinates<T>::append(const Point3 &position)
+{
+    append(position.x(), position.y(), position.z());
+}
+
+/// Appends the position (\p x, \p y, \p z) to the coordinates.
+template<typename T>
+inline void PackedCoordinates<T>::append(Real x, Real y, Real z)
+{
+    m_x.push_back(static_cast<T>(x));
+    m_y.push_back(static_cast<T>(y));
+    m_z.push_back(static_cast<T>(z));
+}
+
+/// Returns a new cartesian coordinates object containing a copy of
+/// the positions. The ownership of the returned object is passed to
+/// the caller.
+template<typename T>
+inline CartesianCoordinates* PackedCoordinates<T>::toCartesianCoordinates() const
+{
+    return constView().toCartesianCoordinates();
+}
+
+// --- Geometry ------------------------------------------------------------ //
+/// Returns the distance between the points at \p i and \p j.
+template<typename T>
+inline Real PackedCoordinates<T>::distance(size_t i, size_t j) const
+{
+    return constView().distance(i, j);
+}
+
+/// Returns the center of the coordinates.
+template<typename T>
+inline Point3 PackedCoordinates<T>::center() const
+{
+    return constView().center();
+}
+
+/// Returns the center of the coordinates after weighting each
+/// position with \p weights.
+template<typename T>
+inline Point3 PackedCoordinates<T>::weightedCenter(const std::vector<Real> &weights) const
+{
+    return constView().weightedCenter(weights);
+}
+
+/// Moves all of the coordinates by \p vector.
+template<typename T>
+inline void PackedCoordinates<T>::moveBy(const Vector3 &vector)
+{
+    view().moveBy(vector);
+}
+
+/// Moves all of the coordinates by (\p x, \p y, \p z).
+template<typename T>
+inline void PackedCoordinates<T>::moveBy(Real x, Real y, Real z)
+{
+    view().moveBy(x, y, z);
+}
+
+/// Rotates the coordinates by \p angle degrees around \p axis.
+template<typename T>
+inline void PackedCoordinates<T>::rotate(const Vector3 &axis, Real angle)
+{
+    view().rotate(axis, angle);
+}
+
+/// Returns the root mean square deviation between the positions and
+/// the positions in \p coordinates. Both must contain the same number
+/// of positions.
+template<typename T>
+template<typename U>
+inline Real PackedCoordinates<T>::rmsd(const PackedCoordinates<U> &coordinates) const
+{
+    PackedCoordinatesView<U> other(const_cast<U *>(coordinates.x()),
+                                   const_cast<U *>(coordinates.y()),
+                                   const_cast<U *>(coordinates.z()),
+                                   coordinates.size());
+
+    return constView().rmsd(other);
+}
+
+/// Returns a matrix containing the distances between each pair of
+/// points in the coordinates.
+template<typename T>
+inline Matrix PackedCoordinates<T>::distanceMatrix() const
+{
+    return constView().distanceMatrix();
+}
+
+// --- Views --------------------------------------------------------------- //
+/// Returns a view of all of the coordinates. The view remains valid
+/// until the coordinates are resized or destroyed.
+template<typename T>
+inline PackedCoordinatesView<T> PackedCoordinates<T>::view()
+{
+    return PackedCoordinatesView<T>(x(), y(), z(), size());
+}
+
+/// Returns a view of the \p count coordinates starting at \p index.
+template<typename T>
+inline PackedCoordinatesView<T> PackedCoordinates<T>::view(size_t index, size_t count)
+{
+    return view().mid(index, count);
+}
+
+// --- Internal Methods ---------------------------------------------------- //
+// Returns a view used by the const methods. The view is never used
+// to modify the coordinates.
+template<typename T>
+inline PackedCoordinatesView<T> PackedCoordinates<T>::constView() const
+{
+    return const_cast<PackedCoordinates<T> *>(this)->view();
+}
+
+} // end chemkit namespace
+
+#endif // CHEMKIT_PACKEDCOORDINATES_INLINE_H
@@ -0,0 +1,107 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#ifndef CHEMKIT_PACKEDCOORDINATES_H
+#define CHEMKIT_PACKEDCOORDINATES_H
+
+#include "chemkit.h"
+
+#include <vector>
+
+#include "matrix.h"
+#include "point3.h"
+#include "vector3.h"
+#include "packedcoordinatesview.h"
+
+namespace chemkit {
+
+class CartesianCoordinates;
+
+template<typename T>
+class CHEMKIT_EXPORT PackedCoordinates
+{
+public:
+    // construction and destruction
+    PackedCoordinates(size_t size = 0);
+    PackedCoordinates(const CartesianCoordinates *coordinates);
+
+    // properties
+    void resize(size_t size);
+    size_t size() const;
+    bool isEmpty() const;
+    T* x();
+    const T* x() const;
+    T* y();
+    const T* y() const;
+    T* z();
+    const T* z() const;
+
+    // coordinates
+    void setPosition(size_t index, const Point3 &position);
+    void setPosition(size_t index, Real x, Real y, Real z);
+    Point3 position(size_t index) const;
+    void append(const Point3 &position);
+    void append(Real x, Real y, Real z);
+    CartesianCoordinates* toCartesianCoordinates() const;
+
+    // geometry
+    Real distance(size_t i, size_t j) const;
+    Point3 center() const;
+    Point3 weightedCenter(const std::vector<Real> &weights) const;
+    void moveBy(const Vector3 &vector);
+    void moveBy(Real x, Real y, Real z);
+    void rotate(const Vector3 &axis, Real angle);
+    template<typename U> Real rmsd(const PackedCoordinates<U> &coordinates) const;
+    Matrix distanceMatrix() const;
+
+    // views
+    PackedCoordinatesView<T> view();
+    PackedCoordinatesView<T> view(size_t index, size_t count);
+
+private:
+    PackedCoordinatesView<T> constView() const;
+
+private:
+    std::vector<T> m_x;
+    std::vector<T> m_y;
+    std::vector<T> m_z;
+};
+
+} // end chemkit namespace
+
+#include "packedcoordinates-inline.h"
+
+#endif // CHEMKIT_PACKEDCOORDINATES_H
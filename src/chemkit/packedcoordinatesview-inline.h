@@ -0,0 +1,340 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#ifndef CHEMKIT_PACKEDCOORDINATESVIEW_INLINE_H
+#define CHEMKIT_PACKEDCOORDINATESVIEW_INLINE_H
+
+#include "packedcoordinatesview.h"
+
+#include <cmath>
+#include <cassert>
+
+#include "constants.h"
+#include "cartesiancoordinates.h"
+
+namespace chemkit {
+
+// === PackedCoordinatesView =============================================== //
+/// \class PackedCoordinatesView packedcoordinatesview.h chemkit/packedcoordinatesview.h
+/// \ingroup chemkit
+/// \brief The PackedCoordinatesView class provides access to
+///        coordinates stored as separate x, y and z arrays.
+///
+/// A view does not own the coordinates it refers to. Views are cheap
+/// to copy and are usually obtained from a PackedCoordinates object
+/// with PackedCoordinates::view(). Any change made through a view is
+/// visible to every other view of the same coordinates.
+///
+/// The bulk operations (moveBy(), rotate(), center(), rmsd(),
+/// distanceMatrix(), etc.) operate on whole arrays at a time so that
+/// they are vectorized. Sums are always accumulated in Real
+/// precision even if \c T is \c float.
+///
+/// \see PackedCoordinates
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new, empty view.
+template<typename T>
+inline PackedCoordinatesView<T>::PackedCoordinatesView()
+    : m_x(0),
+      m_y(0),
+      m_z(0),
+      m_size(0)
+{
+}
+
+/// Creates a new view of the \p size coordinates stored in the
+/// \p x, \p y and \p z arrays.
+template<typename T>
+inline PackedCoordinatesView<T>::PackedCoordinatesView(T *x, T *y, T *z, size_t size)
+    : m_x(x),
+      m_y(y),
+      m_z(z),
+      m_size(size)
+{
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Returns the number of coordinates in the view.
+template<typename T>
+inline size_t PackedCoordinatesView<T>::size() const
+{
+    return m_size;
+}
+
+/// Returns \c true if the view contains no coordinates.
+template<typename T>
+inline bool PackedCoordinatesView<T>::isEmpty() const
+{
+    return m_size == 0;
+}
+
+/// Returns a pointer to the x components of the coordinates.
+template<typename T>
+inline T* PackedCoordinatesView<T>::x() const
+{
+    return m_x;
+}
+
+/// Returns a pointer to the y components of the coordinates.
+template<typename T>
+inline T* PackedCoordinatesView<T>::y() const
+{
+    return m_y;
+}
+
+/// Returns a pointer to the z components of the coordinates.
+template<typename T>
+inline T* PackedCoordinatesView<T>::z() const
+{
+    return m_z;
+}
+
+/// Returns a view of the \p count coordinates starting at \p index.
+template<typename T>
+inline PackedCoordinatesView<T> PackedCoordinatesView<T>::mid(size_t index, size_t count) const
+{
+    assert(index + count <= m_size);
+
+    return PackedCoordinatesView<T>(m_x + index, m_y + index, m_z + index, count);
+}
+
+// --- Coordinates --------------------------------------------------------- //
+/// Sets the position at \p index to \p position.
+template<typename T>
+inline void PackedCoordinatesView<T>::setPosition(size_t index, const Point3 &position)
+{
+    setPosition(index, position.x(), position.y(), position.z());
+}
+
+/// Sets the position at \p index to (\p x, \p y, \p z).
+template<typename T>
+inline void PackedCoordinatesView<T>::setPosition(size_t index, Real x, Real y, Real z)
+{
+    assert(index < m_size);
+
+    m_x[index] = static_cast<T>(x);
+    m_y[index] = static_cast<T>(y);
+    m_z[index] = static_cast<T>(z);
+}
+
+/// Returns the position at \p index.
+template<typename T>
+inline Point3 PackedCoordinatesView<T>::position(size_t index) const
+{
+    assert(index < m_size);
+
+    return Point3(m_x[index], m_y[index], m_z[index]);
+}
+
+/// Sets the positions in the view to the positions in
+/// \p coordinates. Both must contain the same number of
+/// coordinates.
+template<typename T>
+inline void PackedCoordinatesView<T>::assign(const CartesianCoordinates *coordinates)
+{
+    assert(coordinates->size() == m_size);
+
+    for(size_t i = 0; i < m_size; i++){
+        setPosition(i, coordinates->position(i));
+    }
+}
+
+/// Returns a new cartesian coordinates object containing a copy of
+/// the positions in the view. The ownership of the returned object
+/// is passed to the caller.
+template<typename T>
+inline CartesianCoordinates* PackedCoordinatesView<T>::toCartesianCoordinates() const
+{
+    CartesianCoordinates *coordinates = new CartesianCoordinates(m_size);
+
+    for(size_t i = 0; i < m_size; i++){
+        coordinates->setPosition(i, position(i));
+    }
+
+    return coordinates;
+}
+
+// --- Geometry ------------------------------------------------------------ //
+/// Returns the distance between the points at \p i and \p j.
+template<typename T>
+inline Real PackedCoordinatesView<T>::distance(size_t i, size_t j) const
+{
+    return (position(i) - position(j)).norm();
+}
+
+/// Returns the center of the coordinates.
+template<typename T>
+inline Point3 PackedCoordinatesView<T>::center() const
+{
+    if(isEmpty()){
+        return Point3(0, 0, 0);
+    }
+
+    Point3 sum(xArray().template cast<Real>().sum(),
+               yArray().template cast<Real>().sum(),
+               zArray().template cast<Real>().sum());
+
+    return (1.0 / m_size) * sum;
+}
+
+/// Returns the center of the coordinates after weighting each
+/// position with \p weights. The weighted positions are divided by
+/// the sum of the weights.
+template<typename T>
+inline Point3 PackedCoordinatesView<T>::weightedCenter(const std::vector<Real> &weights) const
+{
+    assert(weights.size() == m_size);
+
+    if(isEmpty()){
+        return Point3();
+    }
+
+    Eigen::Map<const Eigen::Array<Real, Eigen::Dynamic, 1> > w(&weights[0], m_size);
+
+    Point3 sum((xArray().template cast<Real>() * w).sum(),
+               (yArray().template cast<Real>() * w).sum(),
+               (zArray().template cast<Real>() * w).sum());
+
+    return (1.0 / w.sum()) * sum;
+}
+
+/// Moves all of the coordinates by \p vector.
+template<typename T>
+inline void PackedCoordinatesView<T>::moveBy(const Vector3 &vector)
+{
+    xArray() += static_cast<T>(vector.x());
+    yArray() += static_cast<T>(vector.y());
+    zArray() += static_cast<T>(vector.z());
+}
+
+/// Moves all of the coordinates by (\p x, \p y, \p z).
+template<typename T>
+inline void PackedCoordinatesView<T>::moveBy(Real x, Real y, Real z)
+{
+    moveBy(Vector3(x, y, z));
+}
+
+/// Rotates the coordinates by \p angle degrees around \p axis.
+template<typename T>
+inline void PackedCoordinatesView<T>::rotate(const Vector3 &axis, Real angle)
+{
+    if(isEmpty()){
+        return;
+    }
+
+    Eigen::Matrix<Real, 3, 3> rotation =
+        Eigen::AngleAxis<Real>(angle * constants::DegreesToRadians, axis).toRotationMatrix();
+    Eigen::Matrix<T, 3, 3> m = rotation.template cast<T>();
+
+    ArrayMap x = xArray();
+    ArrayMap y = yArray();
+    ArrayMap z = zArray();
+
+    Eigen::Array<T, Eigen::Dynamic, 1> rx = m(0, 0) * x + m(0, 1) * y + m(0, 2) * z;
+    Eigen::Array<T, Eigen::Dynamic, 1> ry = m(1, 0) * x + m(1, 1) * y + m(1, 2) * z;
+    z = m(2, 0) * x + m(2, 1) * y + m(2, 2) * z;
+    x = rx;
+    y = ry;
+}
+
+/// Returns the root mean square deviation between the positions in
+/// the view and the positions in \p coordinates. Both must contain
+/// the same number of positions.
+template<typename T>
+template<typename U>
+inline Real PackedCoordinatesView<T>::rmsd(const PackedCoordinatesView<U> &coordinates) const
+{
+    assert(coordinates.size() == m_size);
+
+    size_t size = m_size;
+    if(size == 0){
+        return 0;
+    }
+
+    typedef Eigen::Map<Eigen::Array<U, Eigen::Dynamic, 1> > OtherArrayMap;
+    OtherArrayMap x(coordinates.x(), size);
+    OtherArrayMap y(coordinates.y(), size);
+    OtherArrayMap z(coordinates.z(), size);
+
+    Real sum = (xArray().head(size).template cast<Real>() - x.template cast<Real>()).square().sum() +
+               (yArray().head(size).template cast<Real>() - y.template cast<Real>()).square().sum() +
+               (zArray().head(size).template cast<Real>() - z.template cast<Real>()).square().sum();
+
+    return std::sqrt(sum / size);
+}
+
+/// Returns a matrix containing the distances between each pair of
+/// points in the coordinates.
+template<typename T>
+inline Matrix PackedCoordinatesView<T>::distanceMatrix() const
+{
+    Matrix matrix(m_size, m_size);
+
+    Eigen::Array<Real, Eigen::Dynamic, 1> x = xArray().template cast<Real>();
+    Eigen::Array<Real, Eigen::Dynamic, 1> y = yArray().template cast<Real>();
+    Eigen::Array<Real, Eigen::Dynamic, 1> z = zArray().template cast<Real>();
+
+    // each column is calculated at once from the packed arrays
+    for(size_t j = 0; j < m_size; j++){
+        matrix.col(j) = ((x - x[j]).square() + (y - y[j]).square() + (z - z[j]).square()).sqrt().matrix();
+    }
+
+    return matrix;
+}
+
+// --- Internal Methods ---------------------------------------------------- //
+template<typename T>
+inline typename PackedCoordinatesView<T>::ArrayMap PackedCoordinatesView<T>::xArray() const
+{
+    return ArrayMap(m_x, m_size);
+}
+
+template<typename T>
+inline typename PackedCoordinatesView<T>::ArrayMap PackedCoordinatesView<T>::yArray() const
+{
+    return ArrayMap(m_y, m_size);
+}
+
+template<typename T>
+inline typename PackedCoordinatesView<T>::ArrayMap PackedCoordinatesView<T>::zArray() const
+{
+    return ArrayMap(m_z, m_size);
+}
+
+} // end chemkit namespace
+
+#endif // CHEMKIT_PACKEDCOORDINATESVIEW_INLINE_H
@@ -60,7 +60,8 @@ namespace chemkit {
 // --- Construction and Destruction ---------------------------------------- //
 /// Creates a new ring that contains the atoms is \p path.
 Ring::Ring(std::vector<Atom *> path)
-    : m_atoms(path)
+    : m_atoms(path),
+      m_index(0)
 {
     assert(isValid());
 }
@@ -245,7 +246,16 @@ bool Ring::isFusedTo(const Ring *ring) const
 
 // --- Aromaticity --------------------------------------------------------- //
 /// Returns \c true if the ring is aromatic.
+///
+/// The result is cached by the molecule until its structure, bond
+/// orders or elements are changed.
 bool Ring::isAromatic() const
+{
+    return molecule()->isRingAromatic(this);
+}
+
+// --- Internal Methods ---------------------------------------------------- //
+bool Ring::perceiveAromaticity() const
 {
     // check for planarity of all ring atoms
     if(!isPlanar()){
@@ -302,7 +312,6 @@ bool Ring::isAromatic() const
     return false;
 }
 
-// --- Internal Methods ---------------------------------------------------- //
 bool Ring::isValid() const
 {
     if(size() < 3)
@@ -102,6 +102,7 @@ private:
     const Bond *previousBond(const Atom *atom) const;
     bool isPlanar() const;
     size_t piElectronCount() const;
+    bool perceiveAromaticity() const;
 
     CHEMKIT_DISABLE_COPY(Ring)
 
@@ -109,6 +110,7 @@ private:
 
 private:
     std::vector<Atom *> m_atoms;
+    size_t m_index;
 };
 
 } // end chemkit namespace
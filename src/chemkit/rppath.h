@@ -38,6 +38,7 @@
 
 #include "chemkit.h"
 
+#include <map>
 #include <set>
 #include <limits>
 #include <algorithm>
@@ -47,6 +48,8 @@
 #include <Eigen/Core>
 
 #include "atom.h"
+#include "bond.h"
+#include "bitset.h"
 #include "graph.h"
 #include "foreach.h"
 #include "fragment.h"
@@ -178,29 +181,81 @@ private:
 };
 
 // === Sssr ================================================================ //
+// The Sssr class builds up the smallest set of smallest rings from
+// candidate rings. A candidate is only added if its bonds are linearly
+// independent of the bonds of the rings already in the set.
 template<typename T>
 class Sssr
 {
 public:
+    // construction and destruction
+    Sssr(const Graph<T> &graph);
+
     // properties
     size_t size() const { return m_rings.size(); }
     bool isEmpty() const { return m_rings.empty(); }
 
     // rings
     const std::vector<std::vector<T> >& rings() const { return m_rings; }
-    void append(const std::vector<T> &ring) { m_rings.push_back(ring); }
+    bool append(const std::vector<T> &ring);
+    bool isIndependent(const std::vector<T> &ring) const;
 
-    // ring checks
-    bool isValid(const std::vector<T> &ring) const;
-    bool isUnique(const std::vector<T> &ring) const;
+    // static methods
+    static bool isValid(const std::vector<T> &ring);
+
+private:
+    Bitset bondSet(const std::vector<T> &ring) const;
+    Bitset reduce(const Bitset &bonds) const;
 
 private:
+    std::map<std::pair<T, T>, size_t> m_bondIndices;
     std::vector<std::vector<T> > m_rings;
+    std::vector<Bitset> m_basis;
+    std::vector<size_t> m_pivots;
 };
 
-// --- Ring Checks --------------------------------------------------------- //
+// --- Construction and Destruction ---------------------------------------- //
+template<typename T>
+inline Sssr<T>::Sssr(const Graph<T> &graph)
+{
+    for(T i = 0; i < graph.size(); i++){
+        foreach(T neighbor, graph.neighbors(i)){
+            if(i < neighbor){
+                size_t index = m_bondIndices.size();
+                m_bondIndices[std::make_pair(i, neighbor)] = index;
+            }
+        }
+    }
+}
+
+// --- Rings --------------------------------------------------------------- //
+// Adds ring to the set if it is independent of the rings already in
+// the set. Returns false if the ring was not added.
 template<typename T>
-inline bool Sssr<T>::isValid(const std::vector<T> &ring) const
+inline bool Sssr<T>::append(const std::vector<T> &ring)
+{
+    Bitset reduced = reduce(bondSet(ring));
+    if(reduced.none()){
+        return false;
+    }
+
+    m_basis.push_back(reduced);
+    m_pivots.push_back(reduced.find_first());
+    m_rings.push_back(ring);
+    return true;
+}
+
+// Returns true if ring is independent of the rings already in the set.
+template<typename T>
+inline bool Sssr<T>::isIndependent(const std::vector<T> &ring) const
+{
+    return reduce(bondSet(ring)).any();
+}
+
+// --- Static Methods ------------------------------------------------------ //
+// Returns true if ring does not visit any vertex more than once.
+template<typename T>
+inline bool Sssr<T>::isValid(const std::vector<T> &ring)
 {
     // check for any duplicate vertices
     for(T i = 0; i < ring.size(); i++){
@@ -214,86 +269,136 @@ inline bool Sssr<T>::isValid(const std::vector<T> &ring) const
     return true;
 }
 
+// --- Internal Methods ---------------------------------------------------- //
 template<typename T>
-inline bool Sssr<T>::isUnique(const std::vector<T> &path) const
+inline Bitset Sssr<T>::bondSet(const std::vector<T> &ring) const
 {
-    // must be unique if sssr is empty
-    if(isEmpty()){
-        return true;
-    }
+    Bitset bonds(m_bondIndices.size());
 
-    // check if a ring with the same atoms is already in the sssr
-    std::set<T> pathSet;
-    pathSet.insert(path.begin(), path.end());
+    for(size_t i = 0; i < ring.size(); i++){
+        T a = ring[i];
+        T b = ring[(i + 1) % ring.size()];
 
-    foreach(const std::vector<T> &ring, m_rings){
-        std::set<T> ringSet;
-        ringSet.insert(ring.begin(), ring.end());
-
-        std::vector<T> sortedRing(ring.begin(), ring.end());
-        std::sort(sortedRing.begin(), sortedRing.end());
+        bonds.set(m_bondIndices.find(std::make_pair(std::min(a, b), std::max(a, b)))->second);
+    }
 
-        std::set<T> intersection;
-        std::set_intersection(pathSet.begin(), pathSet.end(),
-                              ringSet.begin(), ringSet.end(),
-                              std::inserter(intersection, intersection.begin()));
+    return bonds;
+}
 
-        if(intersection.size() == ring.size()){
-            return false;
+// Returns the remainder of bonds after eliminating the rings already in
+// the set. The remainder is empty if bonds is a combination of them.
+template<typename T>
+inline Bitset Sssr<T>::reduce(const Bitset &bonds) const
+{
+    Bitset reduced = bonds;
+    for(size_t i = 0; i < m_basis.size(); i++){
+        if(reduced.test(m_pivots[i])){
+            reduced ^= m_basis[i];
         }
     }
 
-    // build set of bonds in the path
-    std::set<std::pair<T, T> > pathBonds;
-    for(T i = 0; i < path.size() - 1; i++){
-        pathBonds.insert(std::make_pair(std::min(path[i], path[i+1]),
-                                        std::max(path[i], path[i+1])));
-    }
+    return reduced;
+}
+
+// === Ring Systems ======================================================== //
+// A frame in the depth-first search used to find ring systems.
+template<typename T>
+struct RingSystemFrame
+{
+    T vertex;
+    T parent;
+    size_t next;
+};
+
+// Returns the ring systems (the biconnected components containing at
+// least one cycle) of graph as lists of edges. Bridges and the other
+// acyclic parts of the graph are dropped. The root vertex of the
+// depth-first search which found each ring system is stored in roots.
+// Ring systems with the same root are connected and are returned
+// consecutively in order of increasing root.
+template<typename T>
+inline std::vector<std::vector<std::pair<T, T> > > ringSystems(const Graph<T> &graph, std::vector<T> &roots)
+{
+    typedef std::pair<T, T> Edge;
+    typedef RingSystemFrame<T> Frame;
 
-    pathBonds.insert(std::make_pair(std::min(path.front(), path.back()),
-                                    std::max(path.front(), path.back())));
+    const T n = graph.size();
+    const T none = std::numeric_limits<T>::max();
 
-    // remove bonds from path bonds that are already in a smaller ring
-    foreach(const std::vector<T> &ring, m_rings){
-        if(ring.size() >= path.size()){
+    std::vector<std::vector<Edge> > systems;
+    roots.clear();
+
+    // discovery time (zero if not yet visited) and low-link for each vertex
+    std::vector<T> discovery(n, 0);
+    std::vector<T> low(n, 0);
+    T time = 1;
+
+    std::vector<Frame> stack;
+    std::vector<Edge> edges;
+
+    for(T root = 0; root < n; root++){
+        if(discovery[root] || graph.neighbors(root).empty()){
             continue;
         }
 
-        for(T i = 0; i < ring.size() - 1; i++){
-            pathBonds.erase(std::make_pair(std::min(ring[i], ring[i+1]),
-                                           std::max(ring[i], ring[i+1])));
-        }
+        discovery[root] = low[root] = time++;
+        Frame rootFrame = { root, none, 0 };
+        stack.push_back(rootFrame);
 
-        pathBonds.erase(std::make_pair(std::min(ring.front(), ring.back()),
-                                       std::max(ring.front(), ring.back())));
-    }
+        while(!stack.empty()){
+            Frame &frame = stack.back();
+            const T vertex = frame.vertex;
+            const std::vector<T> &neighbors = graph.neighbors(vertex);
 
-    // check if any other ring contains the same bonds
-    foreach(const std::vector<T> &ring, m_rings){
-        std::set<std::pair<T, T> > ringBonds;
+            if(frame.next < neighbors.size()){
+                T neighbor = neighbors[frame.next++];
 
-        // add ring bonds
-        for(T i = 0; i < ring.size() - 1; i++){
-            ringBonds.insert(std::make_pair(std::min(ring[i], ring[i+1]),
-                                            std::max(ring[i], ring[i+1])));
-        }
+                if(neighbor == frame.parent){
+                    continue;
+                }
+                else if(!discovery[neighbor]){
+                    edges.push_back(Edge(vertex, neighbor));
+                    discovery[neighbor] = low[neighbor] = time++;
+                    Frame neighborFrame = { neighbor, vertex, 0 };
+                    stack.push_back(neighborFrame);
+                }
+                else if(discovery[neighbor] < discovery[vertex]){
+                    // back edge
+                    edges.push_back(Edge(vertex, neighbor));
+                    low[vertex] = std::min(low[vertex], discovery[neighbor]);
+                }
 
-        // add closure bond
-        ringBonds.insert(std::make_pair(std::min(ring.front(), ring.back()),
-                                        std::max(ring.front(), ring.back())));
+                continue;
+            }
 
-        // check intersection
-        std::set<std::pair<T, T> > intersection;
-        std::set_intersection(pathBonds.begin(), pathBonds.end(),
-                              ringBonds.begin(), ringBonds.end(),
-                              std::inserter(intersection, intersection.begin()));
+            const T parent = frame.parent;
+            stack.pop_back();
 
-        if(intersection.size() == pathBonds.size()){
-            return false;
+            if(parent == none){
+                continue;
+            }
+
+            low[parent] = std::min(low[parent], low[vertex]);
+
+            if(low[vertex] >= discovery[parent]){
+                // parent separates the component containing vertex
+                typename std::vector<Edge>::iterator begin = edges.end();
+                do {
+                    --begin;
+                } while(*begin != Edge(parent, vertex));
+
+                // a component with a single edge is a bridge
+                if(edges.end() - begin > 1){
+                    systems.push_back(std::vector<Edge>(begin, edges.end()));
+                    roots.push_back(root);
+                }
+
+                edges.erase(begin, edges.end());
+            }
         }
     }
 
-    return true;
+    return systems;
 }
 
 } // end detail namespace
@@ -392,43 +497,41 @@ inline std::vector<std::vector<T> > rppath(const Graph<T> &graph)
     std::sort(candidates.begin(), candidates.end(), RingCandidate<T>::compareSize);
 
     // algorithm 3 - find sssr from the ring candidate set
-    Sssr<T> sssr;
+    Sssr<T> sssr(graph);
 
     foreach(const RingCandidate<T> &candidate, candidates){
+        const std::vector<std::vector<T> > &returnPaths = P(candidate.end(), candidate.start());
+
         // odd sized ring
         if(candidate.size() & 1){
-            for(size_t i = 0; i < Pt(candidate.start(), candidate.end()).size(); i++){
+            foreach(const std::vector<T> &path, Pt(candidate.start(), candidate.end())){
                 std::vector<T> ring;
                 ring.push_back(candidate.start());
-                std::vector<T> &path = Pt(candidate.start(), candidate.end())[i];
                 ring.insert(ring.end(), path.begin(), path.end());
                 ring.push_back(candidate.end());
-                if(!P(candidate.end(), candidate.start()).empty()){
-                    path = P(candidate.end(), candidate.start())[0];
-                    ring.insert(ring.end(), path.begin(), path.end());
+                if(!returnPaths.empty()){
+                    ring.insert(ring.end(), returnPaths[0].begin(), returnPaths[0].end());
                 }
 
-                // check if ring is valid and unique
-                if(sssr.isValid(ring) && sssr.isUnique(ring)){
-                    sssr.append(ring);
+                // check if ring is valid and independent
+                if(Sssr<T>::isValid(ring) && sssr.append(ring)){
                     break;
                 }
             }
         }
         // even sized ring
         else{
-            for(size_t i = 0; i < P(candidate.start(), candidate.end()).size() - 1; i++){
+            const std::vector<std::vector<T> > &paths = P(candidate.start(), candidate.end());
+
+            for(size_t i = 0; i < paths.size() - 1; i++){
                 std::vector<T> ring;
                 ring.push_back(candidate.start());
-                std::vector<T> &path = P(candidate.start(), candidate.end())[i];
-                ring.insert(ring.end(), path.begin(), path.end());
+                ring.insert(ring.end(), paths[i].begin(), paths[i].end());
                 ring.push_back(candidate.end());
-                path = P(candidate.end(), candidate.start())[i+1];
-                ring.insert(ring.end(), path.begin(), path.end());
+                ring.insert(ring.end(), returnPaths[i+1].begin(), returnPaths[i+1].end());
 
-                // check if ring is valid and unique
-                if(sssr.isValid(ring) && sssr.isUnique(ring)){
-                    sssr.append(ring);
+                // check if ring is valid and independent
+                if(Sssr<T>::isValid(ring) && sssr.append(ring)){
                     break;
                 }
             }
@@ -442,39 +545,520 @@ inline std::vector<std::vector<T> > rppath(const Graph<T> &graph)
     return sssr.rings();
 }
 
-inline std::vector<std::vector<Atom *> > rppath(const Fragment *fragment)
+namespace detail {
+
+// === Horton ============================================================== //
+// The ContractedChain class represents a chain of degree two vertices
+// connecting two branch vertices in a ring system.
+template<typename T>
+struct ContractedChain
 {
-    std::vector<Atom *> atoms = fragment->atoms();
+    T source;
+    T target;
+    T weight;
+    std::vector<T> vertices;
+};
 
-    // remove any terminal atoms
-    atoms.erase(std::remove_if(atoms.begin(), atoms.end(), boost::bind(&Atom::isTerminal, _1)), atoms.end());
+// The HortonCandidate class represents a candidate ring as a list of
+// contracted chains along with the set of chains it contains. A
+// candidate is ambiguous if another shortest path from its root to
+// one of its chains forms a different ring of the same size.
+template<typename T>
+struct HortonCandidate
+{
+    T root;
+    std::vector<size_t> chains;
+    Bitset chainSet;
+    bool ambiguous;
+};
 
-    // create graph
-    Graph<size_t> graph(atoms.size());
+// Finds the smallest set of smallest rings in a biconnected graph
+// containing at least two rings using Horton's algorithm and stores
+// them in rings.
+//
+// Returns false if the graph has more than one smallest set of
+// smallest rings. The rings chosen between equally sized alternatives
+// would then differ from those chosen by the rp-path algorithm so it
+// is left to the caller to use that instead.
+//
+// Each chain of degree two vertices is first contracted to a single
+// weighted edge between two branch vertices. This keeps the number of
+// candidate rings proportional to the number of rings rather than the
+// number of vertices which makes it suitable for the large ring systems
+// formed by e.g. disulfide bridges in proteins.
+//
+// For a description of the algorithm see [Horton 1987].
+template<typename T>
+inline bool horton(const Graph<T> &graph, std::vector<std::vector<T> > &rings)
+{
+    typedef ContractedChain<T> Chain;
+    typedef HortonCandidate<T> Candidate;
 
-    for(size_t i = 0; i < atoms.size(); i++){
-        for(size_t j = i + 1; j < atoms.size(); j++){
-            if(atoms[i]->isBondedTo(atoms[j])){
-                graph.addEdge(i, j);
+    const T n = graph.size();
+    const T none = std::numeric_limits<T>::max();
+
+    // find branch vertices
+    std::vector<T> nodes;
+    std::vector<T> nodeIndices(n, none);
+
+    for(T i = 0; i < n; i++){
+        if(graph.neighbors(i).size() > 2){
+            nodeIndices[i] = nodes.size();
+            nodes.push_back(i);
+        }
+    }
+
+    // contract chains (each chain is found once from each end)
+    std::vector<Chain> chains;
+    std::vector<std::vector<size_t> > nodeChains(nodes.size());
+
+    for(T i = 0; i < nodes.size(); i++){
+        foreach(T neighbor, graph.neighbors(nodes[i])){
+            Chain chain;
+            chain.source = i;
+
+            T previous = nodes[i];
+            T current = neighbor;
+            while(nodeIndices[current] == none){
+                chain.vertices.push_back(current);
+
+                const std::vector<T> &neighbors = graph.neighbors(current);
+                T next = neighbors[0] == previous ? neighbors[1] : neighbors[0];
+                previous = current;
+                current = next;
+            }
+
+            chain.target = nodeIndices[current];
+            if(chain.target <= i){
+                continue;
+            }
+
+            chain.weight = chain.vertices.size() + 1;
+            nodeChains[chain.source].push_back(chains.size());
+            nodeChains[chain.target].push_back(chains.size());
+            chains.push_back(chain);
+        }
+    }
+
+    const T ringCount = chains.size() - nodes.size() + 1;
+
+    // create candidate rings from the shortest paths from each node
+    std::vector<Candidate> candidates;
+    std::map<Bitset, size_t> candidateIndices;
+
+    // shortest distance between two nodes connected by three or more
+    // shortest paths, any two of which may form a ring
+    T ambiguousDistance = none;
+
+    std::vector<T> distance(nodes.size());
+    std::vector<T> pathCount(nodes.size());
+    std::vector<size_t> parentChain(nodes.size());
+    std::vector<T> parentNode(nodes.size());
+    std::vector<char> visited(nodes.size());
+    std::vector<T> marks(nodes.size(), none);
+
+    for(T root = 0; root < nodes.size(); root++){
+        // find shortest paths with dijkstra's algorithm
+        std::fill(distance.begin(), distance.end(), none);
+        std::fill(visited.begin(), visited.end(), false);
+        distance[root] = 0;
+        pathCount[root] = 1;
+        parentChain[root] = none;
+        parentNode[root] = none;
+
+        for(;;){
+            T node = none;
+            for(T i = 0; i < nodes.size(); i++){
+                if(!visited[i] && distance[i] != none && (node == none || distance[i] < distance[node])){
+                    node = i;
+                }
+            }
+
+            if(node == none){
+                break;
+            }
+
+            visited[node] = true;
+
+            if(pathCount[node] > 2){
+                ambiguousDistance = std::min(ambiguousDistance, distance[node]);
+            }
+
+            foreach(size_t index, nodeChains[node]){
+                const Chain &chain = chains[index];
+                T other = chain.source == node ? chain.target : chain.source;
+
+                if(distance[node] + chain.weight < distance[other]){
+                    distance[other] = distance[node] + chain.weight;
+                    pathCount[other] = pathCount[node];
+                    parentChain[other] = index;
+                    parentNode[other] = node;
+                }
+                else if(distance[node] + chain.weight == distance[other]){
+                    // the number of paths is only needed up to three
+                    pathCount[other] = std::min<T>(pathCount[other] + pathCount[node], 3);
+                }
+            }
+        }
+
+        // form a candidate ring from each chain
+        for(size_t index = 0; index < chains.size(); index++){
+            const Chain &chain = chains[index];
+            if(parentChain[chain.source] == index || parentChain[chain.target] == index){
+                continue;
+            }
+
+            // the paths to each end of the chain may only share the root
+            for(T node = chain.source; node != root; node = parentNode[node]){
+                marks[node] = root;
+            }
+
+            bool valid = true;
+            for(T node = chain.target; node != root; node = parentNode[node]){
+                if(marks[node] == root){
+                    valid = false;
+                    break;
+                }
+            }
+
+            for(T node = chain.source; node != root; node = parentNode[node]){
+                marks[node] = none;
+            }
+
+            if(!valid){
+                continue;
+            }
+
+            Candidate candidate;
+            candidate.root = root;
+            candidate.chainSet.resize(chains.size());
+
+            for(T node = chain.source; node != root; node = parentNode[node]){
+                candidate.chains.push_back(parentChain[node]);
+            }
+            std::reverse(candidate.chains.begin(), candidate.chains.end());
+            candidate.chains.push_back(index);
+            for(T node = chain.target; node != root; node = parentNode[node]){
+                candidate.chains.push_back(parentChain[node]);
+            }
+
+            foreach(size_t chainIndex, candidate.chains){
+                candidate.chainSet.set(chainIndex);
+            }
+
+            T size = distance[chain.source] + chain.weight + distance[chain.target];
+            candidate.ambiguous = (pathCount[chain.source] > 1 && 2 * distance[chain.source] < size) ||
+                                  (pathCount[chain.target] > 1 && 2 * distance[chain.target] < size);
+
+            std::map<Bitset, size_t>::iterator iter = candidateIndices.find(candidate.chainSet);
+            if(iter == candidateIndices.end()){
+                candidateIndices[candidate.chainSet] = candidates.size();
+                candidates.push_back(candidate);
+            }
+            else if(candidate.ambiguous){
+                candidates[iter->second].ambiguous = true;
+            }
+        }
+    }
+
+    // expand the contracted chains to form the candidate rings
+    std::vector<std::vector<T> > candidateRings;
+    candidateRings.reserve(candidates.size());
+
+    foreach(const Candidate &candidate, candidates){
+        std::vector<T> ring;
+        T node = candidate.root;
+
+        foreach(size_t index, candidate.chains){
+            const Chain &chain = chains[index];
+
+            ring.push_back(nodes[node]);
+
+            if(chain.source == node){
+                ring.insert(ring.end(), chain.vertices.begin(), chain.vertices.end());
+                node = chain.target;
+            }
+            else{
+                ring.insert(ring.end(), chain.vertices.rbegin(), chain.vertices.rend());
+                node = chain.source;
+            }
+        }
+
+        candidateRings.push_back(ring);
+    }
+
+    // choose rings in order of size. another set of smallest rings
+    // exists if a ring which was not chosen is independent of all of
+    // the smaller rings or if a chosen ring is ambiguous
+    std::vector<std::pair<size_t, size_t> > order(candidateRings.size());
+    for(size_t i = 0; i < candidateRings.size(); i++){
+        order[i] = std::make_pair(candidateRings[i].size(), i);
+    }
+    std::sort(order.begin(), order.end());
+
+    Sssr<T> sssr(graph);
+    Sssr<T> smallerRings(graph);
+    size_t size = 0;
+
+    for(size_t i = 0; i < order.size(); i++){
+        const Candidate &candidate = candidates[order[i].second];
+        const std::vector<T> &ring = candidateRings[order[i].second];
+
+        if(ring.size() > size){
+            if(sssr.size() == ringCount){
+                break;
+            }
+
+            smallerRings = sssr;
+            size = ring.size();
+        }
+
+        if(sssr.append(ring)){
+            if(candidate.ambiguous){
+                return false;
+            }
+        }
+        else if(smallerRings.isIndependent(ring)){
+            return false;
+        }
+    }
+
+    if(ambiguousDistance != none && 2 * ambiguousDistance <= size){
+        return false;
+    }
+
+    rings = sssr.rings();
+    return true;
+}
+
+// Returns the smallest set of smallest rings in the ring system
+// made up of edges. The rings are composed of vertex indices in the
+// graph containing the ring system.
+template<typename T>
+inline std::vector<std::vector<T> > ringSystemSssr(const std::vector<std::pair<T, T> > &edges)
+{
+    typedef std::pair<T, T> Edge;
+
+    // sorted list of the vertices in the ring system
+    std::vector<T> vertices;
+    vertices.reserve(edges.size() * 2);
+    foreach(const Edge &edge, edges){
+        vertices.push_back(edge.first);
+        vertices.push_back(edge.second);
+    }
+    std::sort(vertices.begin(), vertices.end());
+    vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+    // create graph for the ring system
+    Graph<T> graph(vertices.size());
+    foreach(const Edge &edge, edges){
+        graph.addEdge(std::lower_bound(vertices.begin(), vertices.end(), edge.first) - vertices.begin(),
+                      std::lower_bound(vertices.begin(), vertices.end(), edge.second) - vertices.begin());
+    }
+
+    std::vector<std::vector<T> > rings;
+
+    if(edges.size() == vertices.size()){
+        // a ring system with a single ring is a simple cycle
+        std::vector<T> ring;
+        ring.reserve(vertices.size());
+
+        T previous = 0;
+        T current = 0;
+        do {
+            ring.push_back(vertices[current]);
+
+            const std::vector<T> &neighbors = graph.neighbors(current);
+            T next = neighbors[0] != previous || ring.size() == 1 ? neighbors[0] : neighbors[1];
+            previous = current;
+            current = next;
+        } while(current != 0);
+
+        rings.push_back(ring);
+    }
+    else{
+        // the rp-path algorithm scales with the cube of the number of
+        // vertices so large ring systems are handled by contracting
+        // their chains and using horton's algorithm instead unless
+        // there is a choice between equally sized rings to be made
+        std::vector<std::vector<T> > cycles;
+        if(vertices.size() <= 64 || !horton(graph, cycles)){
+            cycles = rppath(graph);
+        }
+
+        foreach(const std::vector<T> &cycle, cycles){
+            std::vector<T> ring(cycle.size());
+
+            for(size_t i = 0; i < cycle.size(); i++){
+                ring[i] = vertices[cycle[i]];
+            }
+
+            rings.push_back(ring);
+        }
+    }
+
+    return rings;
+}
+
+// Returns true if ring a is smaller than ring b.
+template<typename T>
+inline bool compareRingSize(const std::vector<T> &a, const std::vector<T> &b)
+{
+    return a.size() < b.size();
+}
+
+// Marks the vertices of graph which are left after repeatedly removing
+// all vertices with less than two neighbors. These are the same vertices
+// which are kept by Graph::cyclize().
+template<typename T>
+inline std::vector<char> cyclicVertices(const Graph<T> &graph)
+{
+    std::vector<char> cyclic(graph.size(), true);
+    std::vector<T> degree(graph.size());
+    std::vector<T> queue;
+
+    for(T i = 0; i < graph.size(); i++){
+        degree[i] = graph.neighbors(i).size();
+
+        if(degree[i] < 2){
+            cyclic[i] = false;
+            queue.push_back(i);
+        }
+    }
+
+    while(!queue.empty()){
+        T vertex = queue.back();
+        queue.pop_back();
+
+        foreach(T neighbor, graph.neighbors(vertex)){
+            if(cyclic[neighbor] && --degree[neighbor] < 2){
+                cyclic[neighbor] = false;
+                queue.push_back(neighbor);
+            }
+        }
+    }
+
+    return cyclic;
+}
+
+// Returns the sorted list of the cyclic vertices connected to vertex.
+// Each vertex found is marked as visited.
+template<typename T>
+inline std::vector<T> cyclicComponent(const Graph<T> &graph,
+                                      const std::vector<char> &cyclic,
+                                      std::vector<char> &visited,
+                                      T vertex)
+{
+    std::vector<T> vertices(1, vertex);
+    visited[vertex] = true;
+
+    for(size_t i = 0; i < vertices.size(); i++){
+        foreach(T neighbor, graph.neighbors(vertices[i])){
+            if(cyclic[neighbor] && !visited[neighbor]){
+                visited[neighbor] = true;
+                vertices.push_back(neighbor);
+            }
+        }
+    }
+
+    std::sort(vertices.begin(), vertices.end());
+    return vertices;
+}
+
+// Returns the smallest set of smallest rings in the connected graph
+// made up of vertices using the RP-Path algorithm. The rings are
+// composed of vertex indices in graph.
+template<typename T>
+inline std::vector<std::vector<T> > componentSssr(const Graph<T> &graph,
+                                                  const std::vector<T> &vertices,
+                                                  const std::vector<char> &cyclic)
+{
+    Graph<T> component(vertices.size());
+    for(T i = 0; i < vertices.size(); i++){
+        foreach(T neighbor, graph.neighbors(vertices[i])){
+            if(cyclic[neighbor] && vertices[i] < neighbor){
+                component.addEdge(i, std::lower_bound(vertices.begin(), vertices.end(), neighbor) - vertices.begin());
             }
         }
     }
 
-    // cyclize graph
-    std::vector<size_t> originalIndices;
-    graph.cyclize(originalIndices);
+    std::vector<std::vector<T> > rings = rppath(component);
+
+    foreach(std::vector<T> &ring, rings){
+        for(size_t i = 0; i < ring.size(); i++){
+            ring[i] = vertices[ring[i]];
+        }
+    }
+
+    return rings;
+}
+
+// Returns the smallest set of smallest rings for the ring systems in
+// graph. The rings from each connected component of the graph are
+// grouped together and sorted by size.
+//
+// Connected components whose cyclic part has at most 64 vertices are
+// perceived as a whole with the RP-Path algorithm. This keeps both the
+// choice between equally sized rings and the order of the rings the
+// same as when running RP-Path on the entire cyclized graph. Larger
+// components are perceived separately for each ring system.
+template<typename T>
+inline std::vector<std::vector<T> > sssr(const Graph<T> &graph)
+{
+    std::vector<T> roots;
+    std::vector<std::vector<std::pair<T, T> > > systems = ringSystems(graph, roots);
+    if(systems.empty()){
+        return std::vector<std::vector<T> >();
+    }
+
+    std::vector<char> cyclic = cyclicVertices(graph);
+    std::vector<char> visited(graph.size(), false);
+
+    std::vector<std::vector<T> > rings;
+    size_t first = 0;
+
+    for(size_t i = 0; i < systems.size(); i++){
+        // find the last ring system in the connected component
+        if(i + 1 < systems.size() && roots[i + 1] == roots[i]){
+            continue;
+        }
+
+        std::vector<T> vertices = cyclicComponent(graph, cyclic, visited, systems[first].front().first);
+
+        if(vertices.size() <= 64){
+            std::vector<std::vector<T> > componentRings = componentSssr(graph, vertices, cyclic);
+            rings.insert(rings.end(), componentRings.begin(), componentRings.end());
+        }
+        else{
+            size_t componentStart = rings.size();
+
+            for(size_t j = first; j <= i; j++){
+                std::vector<std::vector<T> > systemRings = ringSystemSssr(systems[j]);
+                rings.insert(rings.end(), systemRings.begin(), systemRings.end());
+            }
 
-    // perceive rings
-    std::vector<std::vector<size_t> > sssr = rppath(graph);
+            // sort the rings from the connected component by size
+            std::stable_sort(rings.begin() + componentStart, rings.end(), compareRingSize<T>);
+        }
 
-    // convert from lists of indices to lists of atoms
+        first = i + 1;
+    }
+
+    return rings;
+}
+
+// Converts rings of atom indices into rings of atoms.
+inline std::vector<std::vector<Atom *> > ringAtoms(const std::vector<std::vector<size_t> > &cycles,
+                                                   const std::vector<Atom *> &atoms)
+{
     std::vector<std::vector<Atom *> > rings;
+    rings.reserve(cycles.size());
 
-    foreach(const std::vector<size_t> &cycle, sssr){
+    foreach(const std::vector<size_t> &cycle, cycles){
         std::vector<Atom *> ring(cycle.size());
 
         for(size_t i = 0; i < cycle.size(); i++){
-            ring[i] = atoms[originalIndices[cycle[i]]];
+            ring[i] = atoms[cycle[i]];
         }
 
         rings.push_back(ring);
@@ -483,17 +1067,56 @@ inline std::vector<std::vector<Atom *> > rppath(const Fragment *fragment)
     return rings;
 }
 
+} // end detail namespace
+
+// Returns the smallest set of smallest rings in the fragment.
+//
+// Small fragments are perceived as a whole with the RP-Path algorithm.
+// Fragments with more than 64 cyclic atoms are first reduced to their
+// ring systems which are then perceived separately.
+inline std::vector<std::vector<Atom *> > rppath(const Fragment *fragment)
+{
+    std::vector<Atom *> atoms = fragment->atoms();
+
+    // map from molecule atom index to fragment atom index
+    std::vector<size_t> indices(fragment->molecule()->size());
+    for(size_t i = 0; i < atoms.size(); i++){
+        indices[atoms[i]->index()] = i;
+    }
+
+    // create graph
+    Graph<size_t> graph(atoms.size());
+
+    for(size_t i = 0; i < atoms.size(); i++){
+        foreach(const Atom *neighbor, atoms[i]->neighbors()){
+            size_t j = indices[neighbor->index()];
+
+            if(i < j){
+                graph.addEdge(i, j);
+            }
+        }
+    }
+
+    return detail::ringAtoms(detail::sssr(graph), atoms);
+}
+
+// Returns the smallest set of smallest rings in the molecule.
+//
+// The rings for each fragment are grouped together and sorted by size
+// and the fragments are ordered by their lowest atom index (the same
+// order as Molecule::fragments()).
 inline std::vector<std::vector<Atom *> > rppath(const Molecule *molecule)
 {
-    std::vector<std::vector<Atom *> > rings;
+    std::vector<Atom *> atoms(molecule->atoms().begin(), molecule->atoms().end());
 
-    foreach(const Fragment *fragment, molecule->fragments()){
-        std::vector<std::vector<Atom *> > fragmentRings = rppath(fragment);
+    // create graph
+    Graph<size_t> graph(atoms.size());
 
-        rings.insert(rings.end(), fragmentRings.begin(), fragmentRings.end());
+    foreach(const Bond *bond, molecule->bonds()){
+        graph.addEdge(bond->atom1()->index(), bond->atom2()->index());
     }
 
-    return rings;
+    return detail::ringAtoms(detail::sssr(graph), atoms);
 }
 
 } // end algorithm namespace
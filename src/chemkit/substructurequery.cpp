@@ -35,82 +35,27 @@
 
 #include "substructurequery.h"
 
+#include <boost/bind.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/mcgregor_common_subgraphs.hpp>
 
-#include "vf2.h"
 #include "atom.h"
 #include "bond.h"
 #include "ring.h"
 #include "foreach.h"
 #include "molecule.h"
+#include "moleculewatcher.h"
+#include "substructurescreen.h"
+#include "substructurequeryplan.h"
 
 namespace chemkit {
 
 namespace {
 
-struct AtomComparator
-{
-    AtomComparator(const std::vector<Atom *> &sourceAtoms, const std::vector<Atom *> &targetAtoms)
-        : m_sourceAtoms(sourceAtoms),
-          m_targetAtoms(targetAtoms)
-    {
-    }
-
-    AtomComparator(const AtomComparator &other)
-        : m_sourceAtoms(other.m_sourceAtoms),
-          m_targetAtoms(other.m_targetAtoms)
-    {
-    }
-
-    bool operator()(size_t a, size_t b) const
-    {
-        return m_sourceAtoms[a]->atomicNumber() == m_targetAtoms[b]->atomicNumber();
-    }
-
-    const std::vector<Atom *> &m_sourceAtoms;
-    const std::vector<Atom *> &m_targetAtoms;
-};
-
-struct BondComparator
-{
-    BondComparator(const std::vector<Atom *> &sourceAtoms, const std::vector<Atom *> &targetAtoms, int flags)
-        : m_sourceAtoms(sourceAtoms),
-          m_targetAtoms(targetAtoms),
-          m_flags(flags)
-    {
-    }
-
-    BondComparator(const BondComparator &other)
-        : m_sourceAtoms(other.m_sourceAtoms),
-          m_targetAtoms(other.m_targetAtoms),
-          m_flags(other.m_flags)
-    {
-    }
-
-    bool operator()(size_t a1, size_t a2, size_t b1, size_t b2) const
-    {
-        const Bond *bondA = m_sourceAtoms[a1]->bondTo(m_sourceAtoms[a2]);
-        const Bond *bondB = m_targetAtoms[b1]->bondTo(m_targetAtoms[b2]);
-
-        if(!bondA || !bondB){
-            return false;
-        }
-
-        if(m_flags & SubstructureQuery::CompareAromaticity){
-            return (bondA->order() == bondB->order()) ||
-                   (bondA->isAromatic() && bondB->isAromatic());
-        }
-        else{
-            return bondA->order() == bondB->order();
-        }
-    }
-
-    const std::vector<Atom *> &m_sourceAtoms;
-    const std::vector<Atom *> &m_targetAtoms;
-    int m_flags;
-};
+typedef std::map<Atom *, Atom *> AtomMapping;
 
 typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS> AdjacencyListGraph;
 
@@ -241,16 +186,228 @@ struct McgregorCommonSubgraphsCallback
     std::map<size_t, size_t> &m_mapping;
 };
 
+// The screening fingerprint sets one bit for each linear path of up
+// to ScreeningPathLength heavy atoms and for each ring closed by such a
+// path. Every path in the query maps onto a path with the same atoms
+// and bond orders in any molecule the query matches, so the query's
+// fingerprint is always a subset of a matching molecule's fingerprint.
+//
+// Unlike the FP2 fingerprint, bonds are labeled by their order rather
+// than by aromaticity which keeps the fingerprint consistent with the
+// bond comparison performed by the VF2 matcher.
+const size_t ScreeningFingerprintSize = 1024;
+const size_t ScreeningPathLength = 6;
+
+class ScreeningFingerprintGenerator
+{
+public:
+    ScreeningFingerprintGenerator(const Molecule *molecule, bool compareBondOrders)
+        : m_visited(molecule->size()),
+          m_compareBondOrders(compareBondOrders)
+    {
+        m_path.reserve(2 * ScreeningPathLength + 2);
+    }
+
+    void addPaths(const Atom *atom,
+                  const Bond *bond,
+                  const Atom *firstAtom,
+                  Bitset &fingerprint)
+    {
+        m_path.push_back(bondLabel(bond));
+        m_path.push_back(atom->atomicNumber());
+        m_visited.set(atom->index());
+
+        fingerprint.set(pathHash() % ScreeningFingerprintSize);
+
+        foreach(const Bond *neighborBond, atom->bonds()){
+            if(neighborBond == bond){
+                continue;
+            }
+
+            const Atom *neighbor = neighborBond->otherAtom(atom);
+            if(neighbor->isTerminalHydrogen()){
+                continue;
+            }
+
+            if(!m_visited.test(neighbor->index())){
+                if(m_path.size() < 2 * ScreeningPathLength){
+                    addPaths(neighbor, neighborBond, firstAtom, fingerprint);
+                }
+            }
+            else if(neighbor == firstAtom && m_path.size() >= 6){
+                // ring closed by a path of three or more atoms
+                fingerprint.set(ringHash(neighborBond) % ScreeningFingerprintSize);
+            }
+        }
+
+        m_visited.reset(atom->index());
+        m_path.pop_back();
+        m_path.pop_back();
+    }
+
+private:
+    unsigned int bondLabel(const Bond *bond) const
+    {
+        if(!bond){
+            return 0;
+        }
+
+        return m_compareBondOrders ? bond->order() : 1;
+    }
+
+    // Returns the hash of the path. Paths are hashed in the direction
+    // which gives the lexicographically larger sequence so that a path
+    // and its reverse set the same bit.
+    size_t pathHash() const
+    {
+        const size_t size = m_path.size();
+
+        // the reversed path is [0, atom n, bond n, ..., bond 2, atom 1]
+        bool reverse = false;
+        for(size_t i = 1; i < size; i++){
+            unsigned int forward = m_path[i];
+            unsigned int backward = m_path[size - i];
+
+            if(forward != backward){
+                reverse = backward > forward;
+                break;
+            }
+        }
+
+        size_t hash = 0;
+        if(reverse){
+            for(size_t i = size - 1; i > 0; i--){
+                hash = hash * 31 + m_path[i];
+            }
+        }
+        else{
+            for(size_t i = 1; i < size; i++){
+                hash = hash * 31 + m_path[i];
+            }
+        }
+
+        return hash;
+    }
+
+    size_t ringHash(const Bond *closingBond) const
+    {
+        size_t hash = 17;
+
+        for(size_t i = 1; i < m_path.size(); i++){
+            hash = hash * 31 + m_path[i];
+        }
+
+        return hash * 31 + bondLabel(closingBond);
+    }
+
+private:
+    std::vector<unsigned int> m_path;
+    Bitset m_visited;
+    bool m_compareBondOrders;
+};
+
+Bitset screeningFingerprint(const Molecule *molecule, int flags)
+{
+    Bitset fingerprint(ScreeningFingerprintSize);
+
+    bool compareBondOrders = !(flags & SubstructureQuery::CompareAromaticity);
+    ScreeningFingerprintGenerator generator(molecule, compareBondOrders);
+
+    foreach(const Atom *atom, molecule->atoms()){
+        if(!atom->isTerminalHydrogen()){
+            generator.addPaths(atom, 0, atom, fingerprint);
+        }
+    }
+
+    return fingerprint;
+}
+
 } // end anonymous namespace
 
 // === SubstructureQueryPrivate ============================================ //
 class SubstructureQueryPrivate
 {
 public:
+    SubstructureQueryPrivate();
+
+    void setMolecule(const boost::shared_ptr<Molecule> &molecule);
+    void invalidate();
+    void updateCache();
+    const Bitset& queryFingerprint();
+    const SubstructureQueryPlan& queryPlan();
+
     boost::shared_ptr<Molecule> molecule;
     int flags;
+    MoleculeWatcher watcher;
+    boost::mutex cacheMutex;
+    boost::atomic<bool> cacheValid;
+    Bitset fingerprint;
+    SubstructureQueryPlan plan;
 };
 
+SubstructureQueryPrivate::SubstructureQueryPrivate()
+    : flags(0),
+      cacheValid(false)
+{
+    // invalidate cached query data whenever the query molecule changes
+    watcher.atomAdded.connect(boost::bind(&SubstructureQueryPrivate::invalidate, this));
+    watcher.atomRemoved.connect(boost::bind(&SubstructureQueryPrivate::invalidate, this));
+    watcher.atomElementChanged.connect(boost::bind(&SubstructureQueryPrivate::invalidate, this));
+    watcher.bondAdded.connect(boost::bind(&SubstructureQueryPrivate::invalidate, this));
+    watcher.bondRemoved.connect(boost::bind(&SubstructureQueryPrivate::invalidate, this));
+    watcher.bondOrderChanged.connect(boost::bind(&SubstructureQueryPrivate::invalidate, this));
+}
+
+void SubstructureQueryPrivate::setMolecule(const boost::shared_ptr<Molecule> &molecule)
+{
+    watcher.setMolecule(molecule.get());
+    this->molecule = molecule;
+    invalidate();
+}
+
+void SubstructureQueryPrivate::invalidate()
+{
+    boost::lock_guard<boost::mutex> lock(cacheMutex);
+    cacheValid = false;
+}
+
+// Calculates the screening fingerprint and match plan for the query
+// molecule. These are only calculated once and then shared between
+// threads until the query molecule or flags are changed.
+void SubstructureQueryPrivate::updateCache()
+{
+    if(cacheValid){
+        return;
+    }
+
+    boost::lock_guard<boost::mutex> lock(cacheMutex);
+
+    if(!cacheValid){
+        if(molecule){
+            fingerprint = screeningFingerprint(molecule.get(), flags);
+            plan = SubstructureQueryPlan(molecule.get(), flags);
+        }
+        else{
+            fingerprint.clear();
+            plan = SubstructureQueryPlan();
+        }
+
+        cacheValid = true;
+    }
+}
+
+const Bitset& SubstructureQueryPrivate::queryFingerprint()
+{
+    updateCache();
+    return fingerprint;
+}
+
+const SubstructureQueryPlan& SubstructureQueryPrivate::queryPlan()
+{
+    updateCache();
+    return plan;
+}
+
 // === SubstructureQuery =================================================== //
 /// \class SubstructureQuery substructurequery.h chemkit/substructurequery.h
 /// \ingroup chemkit
@@ -261,7 +418,6 @@ public:
 SubstructureQuery::SubstructureQuery()
   : d(new SubstructureQueryPrivate)
 {
-    d->flags = 0;
 }
 
 /// Creates a new substructure query with \p molecule as the
@@ -269,8 +425,7 @@ SubstructureQuery::SubstructureQuery()
 SubstructureQuery::SubstructureQuery(const boost::shared_ptr<Molecule> &molecule)
     : d(new SubstructureQueryPrivate)
 {
-    d->molecule = molecule;
-    d->flags = 0;
+    d->setMolecule(molecule);
 }
 
 /// Creates a new substructure query with \p formula in \p format as
@@ -278,8 +433,7 @@ SubstructureQuery::SubstructureQuery(const boost::shared_ptr<Molecule> &molecule
 SubstructureQuery::SubstructureQuery(const std::string &formula, const std::string &format)
     : d(new SubstructureQueryPrivate)
 {
-    d->molecule = boost::make_shared<Molecule>(formula, format);
-    d->flags = 0;
+    d->setMolecule(boost::make_shared<Molecule>(formula, format));
 }
 
 /// Destroys the substructure query object.
@@ -292,7 +446,7 @@ SubstructureQuery::~SubstructureQuery()
 /// Sets the substructure molecule to \p molecule.
 void SubstructureQuery::setMolecule(const boost::shared_ptr<Molecule> &molecule)
 {
-    d->molecule = molecule;
+    d->setMolecule(molecule);
 }
 
 /// Sets the substructure molecule to \p formula with \p format.
@@ -311,6 +465,7 @@ boost::shared_ptr<Molecule> SubstructureQuery::molecule() const
 void SubstructureQuery::setFlags(int flags)
 {
     d->flags = flags;
+    d->invalidate();
 }
 
 /// Returns the query flags.
@@ -346,6 +501,29 @@ bool SubstructureQuery::matches(const Molecule *molecule) const
         return true;
     }
 
+    return matches(molecule, screeningFingerprint(molecule));
+}
+
+/// Returns \c true if the substructure molecule matches \p molecule.
+///
+/// The \p fingerprint must be the screening fingerprint for
+/// \p molecule as returned by screeningFingerprint(). This allows
+/// the fingerprints for a set of molecules to be calculated once and
+/// reused for many queries.
+bool SubstructureQuery::matches(const Molecule *molecule, const Bitset &fingerprint) const
+{
+    if(!d->molecule){
+        return false;
+    }
+
+    if(d->molecule->isEmpty()){
+        return true;
+    }
+
+    if(!passesScreen(fingerprint)){
+        return false;
+    }
+
     return !mapping(molecule).empty();
 }
 
@@ -353,88 +531,56 @@ bool SubstructureQuery::matches(const Molecule *molecule) const
 /// atoms in the substructure molecule and the atoms in \p molecule.
 std::map<Atom *, Atom *> SubstructureQuery::mapping(const Molecule *molecule) const
 {
-    Graph<size_t> source;
-    Graph<size_t> target;
+    // the query plan is only compiled once and then reused for each molecule
+    const SubstructureQueryPlan &plan = d->queryPlan();
 
-    std::vector<Atom *> sourceAtoms;
     std::vector<Atom *> targetAtoms;
-
-    if(d->flags & CompareHydrogens){
-        source.resize(d->molecule->size());
-        sourceAtoms = std::vector<Atom *>(d->molecule->atoms().begin(), d->molecule->atoms().end());
-
-        if(!(d->flags & CompareAtomsOnly)){
-            foreach(const Bond *bond, d->molecule->bonds()){
-                source.addEdge(bond->atom1()->index(), bond->atom2()->index());
-            }
-        }
-
-        target.resize(molecule->size());
-        targetAtoms = std::vector<Atom *>(molecule->atoms().begin(), molecule->atoms().end());
-
-        if(!(d->flags & CompareAtomsOnly)){
-            foreach(const Bond *bond, molecule->bonds()){
-                target.addEdge(bond->atom1()->index(), bond->atom2()->index());
-            }
-        }
+    if(!plan.match(molecule, targetAtoms)){
+        return std::map<Atom *, Atom *>();
     }
-    else{
-        foreach(Atom *atom, d->molecule->atoms()){
-            if(!atom->isTerminalHydrogen()){
-                sourceAtoms.push_back(atom);
-            }
-        }
-
-        foreach(Atom *atom, molecule->atoms()){
-            if(!atom->isTerminalHydrogen()){
-                targetAtoms.push_back(atom);
-            }
-        }
-
-        source.resize(sourceAtoms.size());
-        target.resize(targetAtoms.size());
 
-        if(!(d->flags & CompareAtomsOnly)){
-            for(size_t i = 0; i < sourceAtoms.size(); i++){
-                for(size_t j = i + 1; j < sourceAtoms.size(); j++){
-                    if(sourceAtoms[i]->isBondedTo(sourceAtoms[j])){
-                        source.addEdge(i, j);
-                    }
-                }
-            }
+    std::map<Atom *, Atom *> atomMapping;
 
-            for(size_t i = 0; i < targetAtoms.size(); i++){
-                for(size_t j = i + 1; j < targetAtoms.size(); j++){
-                    if(targetAtoms[i]->isBondedTo(targetAtoms[j])){
-                        target.addEdge(i, j);
-                    }
-                }
-            }
-        }
+    for(size_t i = 0; i < targetAtoms.size(); i++){
+        atomMapping[plan.atoms()[i]] = targetAtoms[i];
     }
 
-    AtomComparator atomComparator(sourceAtoms, targetAtoms);
-    BondComparator bondComparator(sourceAtoms, targetAtoms, d->flags);
+    return atomMapping;
+}
 
-    // run vf2 isomorphism algorithm
-    std::map<size_t, size_t> mapping = chemkit::algorithm::vf2(source,
-                                                               target,
-                                                               atomComparator,
-                                                               bondComparator);
+/// Returns every mapping between the atoms in the substructure
+/// molecule and the atoms in \p molecule.
+///
+/// If the UniqueMatches flag is set only one mapping is returned
+/// for each distinct set of atoms in \p molecule. For example, a
+/// benzene query has twelve mappings onto a benzene molecule but
+/// only one unique mapping.
+std::vector<std::map<Atom *, Atom *> > SubstructureQuery::mappings(const Molecule *molecule) const
+{
+    const SubstructureQueryPlan &plan = d->queryPlan();
 
-    // check for exact match
-    if(d->flags & CompareExact && mapping.size() != source.size()){
-        return std::map<Atom *, Atom *>();
-    }
+    std::vector<std::vector<Atom *> > targetMappings;
+    plan.matchAll(molecule, d->flags & UniqueMatches, &targetMappings);
 
-    // convert index mapping to an atom mapping
-    std::map<Atom *, Atom *> atomMapping;
+    std::vector<std::map<Atom *, Atom *> > atomMappings(targetMappings.size());
 
-    for(std::map<size_t, size_t>::iterator i = mapping.begin(); i != mapping.end(); ++i){
-        atomMapping[sourceAtoms[i->first]] = targetAtoms[i->second];
+    for(size_t i = 0; i < targetMappings.size(); i++){
+        for(size_t j = 0; j < plan.size(); j++){
+            atomMappings[i][plan.atoms()[j]] = targetMappings[i][j];
+        }
     }
 
-    return atomMapping;
+    return atomMappings;
+}
+
+/// Returns the number of times the substructure molecule occurs in
+/// \p molecule.
+///
+/// If the UniqueMatches flag is set each distinct set of atoms in
+/// \p molecule is only counted once.
+size_t SubstructureQuery::count(const Molecule *molecule) const
+{
+    return d->queryPlan().matchAll(molecule, d->flags & UniqueMatches, 0);
 }
 
 /// Returns the maximum mapping (also known as maximum common
@@ -537,17 +683,45 @@ std::map<Atom *, Atom *> SubstructureQuery::maximumMapping(const Molecule *molec
 
 /// Returns a vector containing each molecule in \p molecules that
 /// matches the substructure molecule.
+///
+/// The molecules are matched in parallel using all of the available
+/// processor cores. Use the SubstructureScreen class directly to
+/// control the number of threads used.
 std::vector<Molecule *> SubstructureQuery::filter(const std::vector<Molecule *> &molecules) const
 {
-    std::vector<Molecule *> matchingMolecules;
+    SubstructureScreen screen(this);
 
-    foreach(Molecule *molecule, molecules){
-        if(matches(molecule)){
-            matchingMolecules.push_back(molecule);
-        }
+    return screen.filter(molecules);
+}
+
+// --- Screening ---------------------------------------------------------- //
+/// Returns the screening fingerprint for \p molecule.
+///
+/// The screening fingerprint is a path-based fingerprint with the
+/// property that every bit set in the fingerprint of the query
+/// molecule is also set in the fingerprint of any molecule the query
+/// matches. It is used by matches() to quickly reject molecules
+/// before running the full isomorphism search.
+///
+/// The fingerprint depends on the query flags. Fingerprints stored
+/// for later use should be recalculated if the flags change.
+///
+/// \see passesScreen()
+Bitset SubstructureQuery::screeningFingerprint(const Molecule *molecule) const
+{
+    return chemkit::screeningFingerprint(molecule, d->flags);
+}
+
+/// Returns \c true if a molecule with the screening \p fingerprint
+/// could match the query. Returns \c false if the molecule can not
+/// contain the query molecule.
+bool SubstructureQuery::passesScreen(const Bitset &fingerprint) const
+{
+    if(!d->molecule){
+        return false;
     }
 
-    return matchingMolecules;
+    return d->queryFingerprint().is_subset_of(fingerprint);
 }
 
 /// Searches the the molecule for an occurrence of the substructure
@@ -585,4 +759,30 @@ Moiety SubstructureQuery::find(const Molecule *molecule) const
     return Moiety(atoms);
 }
 
+/// Returns a moiety for each occurrence of the substructure molecule
+/// in \p molecule. The atoms in each moiety are in the same order as
+/// the atoms in the substructure molecule.
+///
+/// \see mappings()
+std::vector<Moiety> SubstructureQuery::findAll(const Molecule *molecule) const
+{
+    std::vector<Moiety> moieties;
+
+    foreach(const AtomMapping &mapping, mappings(molecule)){
+        std::vector<Atom *> atoms;
+
+        foreach(Atom *atom, d->molecule->atoms()){
+            AtomMapping::const_iterator iter = mapping.find(atom);
+
+            if(iter != mapping.end()){
+                atoms.push_back(iter->second);
+            }
+        }
+
+        moieties.push_back(Moiety(atoms));
+    }
+
+    return moieties;
+}
+
 } // end chemkit namespace
@@ -43,6 +43,7 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include "bitset.h"
 #include "moiety.h"
 
 namespace chemkit {
@@ -59,7 +60,8 @@ public:
         CompareAtomsOnly = 0x00,
         CompareHydrogens = 0x01,
         CompareAromaticity = 0x02,
-        CompareExact = 0x04
+        CompareExact = 0x04,
+        UniqueMatches = 0x08
     };
 
     // construction and destruction
@@ -77,10 +79,18 @@ public:
 
     // queries
     bool matches(const Molecule *molecule) const;
+    bool matches(const Molecule *molecule, const Bitset &fingerprint) const;
     std::map<Atom *, Atom *> mapping(const Molecule *molecule) const;
+    std::vector<std::map<Atom *, Atom *> > mappings(const Molecule *molecule) const;
+    size_t count(const Molecule *molecule) const;
     std::map<Atom *, Atom *> maximumMapping(const Molecule *molecule) const;
     std::vector<Molecule *> filter(const std::vector<Molecule *> &molecules) const;
     Moiety find(const Molecule *molecule) const;
+    std::vector<Moiety> findAll(const Molecule *molecule) const;
+
+    // screening
+    Bitset screeningFingerprint(const Molecule *molecule) const;
+    bool passesScreen(const Bitset &fingerprint) const;
 
 private:
     SubstructureQueryPrivate* const d;
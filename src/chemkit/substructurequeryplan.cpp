@@ -0,0 +1,551 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "substructurequeryplan.h"
+
+#include <set>
+#include <algorithm>
+
+#include "atom.h"
+#include "bond.h"
+#include "foreach.h"
+#include "molecule.h"
+#include "substructurequery.h"
+
+namespace chemkit {
+
+namespace {
+
+const size_t NullIndex = size_t(-1);
+
+// Returns a rank for the element which is lower for elements that are
+// less common in organic molecules. Rarer atoms are matched first as
+// they have fewer candidates in the target molecule.
+int elementRank(int atomicNumber)
+{
+    switch(atomicNumber){
+        case Atom::Hydrogen:
+            return 4;
+        case Atom::Carbon:
+            return 3;
+        case Atom::Oxygen:
+            return 2;
+        case Atom::Nitrogen:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+} // end anonymous namespace
+
+// === SubstructureQueryPlan::Step ========================================= //
+bool SubstructureQueryPlan::Step::operator==(const Step &other) const
+{
+    return atomicNumber == other.atomicNumber &&
+           degree == other.degree &&
+           cyclic == other.cyclic &&
+           parent == other.parent &&
+           parentBondOrder == other.parentBondOrder &&
+           parentBondAromatic == other.parentBondAromatic &&
+           closures == other.closures &&
+           closureBondOrders == other.closureBondOrders &&
+           closureBondAromatic == other.closureBondAromatic;
+}
+
+// === SubstructureQueryPlan::Target ======================================= //
+SubstructureQueryPlan::Target::Target(const Molecule *molecule, bool includeHydrogens, bool findCyclic)
+{
+    // map from atom index to vertex index
+    std::vector<size_t> vertices(molecule->size(), NullIndex);
+
+    atoms.reserve(molecule->size());
+    foreach(Atom *atom, molecule->atoms()){
+        if(includeHydrogens || !atom->isTerminalHydrogen()){
+            vertices[atom->index()] = atoms.size();
+            atoms.push_back(atom);
+        }
+    }
+
+    offsets.assign(atoms.size() + 1, 0);
+
+    foreach(const Bond *bond, molecule->bonds()){
+        size_t a = vertices[bond->atom1()->index()];
+        size_t b = vertices[bond->atom2()->index()];
+
+        if(a != NullIndex && b != NullIndex){
+            offsets[a + 1]++;
+            offsets[b + 1]++;
+        }
+    }
+
+    for(size_t i = 0; i < atoms.size(); i++){
+        offsets[i + 1] += offsets[i];
+    }
+
+    neighbors.resize(offsets.back());
+    bonds.resize(offsets.back());
+
+    std::vector<size_t> positions(offsets.begin(), offsets.end() - 1);
+
+    foreach(const Bond *bond, molecule->bonds()){
+        size_t a = vertices[bond->atom1()->index()];
+        size_t b = vertices[bond->atom2()->index()];
+
+        if(a != NullIndex && b != NullIndex){
+            neighbors[positions[a]] = b;
+            bonds[positions[a]++] = bond;
+            neighbors[positions[b]] = a;
+            bonds[positions[b]++] = bond;
+        }
+    }
+
+    if(findCyclic){
+        perceiveCyclic();
+    }
+}
+
+// Returns the bond between vertices a and b or 0 if they are not bonded.
+const Bond* SubstructureQueryPlan::Target::bond(size_t a, size_t b) const
+{
+    for(size_t i = offsets[a]; i < offsets[a + 1]; i++){
+        if(neighbors[i] == b){
+            return bonds[i];
+        }
+    }
+
+    return 0;
+}
+
+// Marks each vertex which is part of a cycle. A vertex is part of a
+// cycle if it is bonded by at least one edge that is not a bridge.
+// Bridges are found with an iterative depth-first search which runs
+// in linear time and does not require ring perception.
+void SubstructureQueryPlan::Target::perceiveCyclic()
+{
+    cyclic.assign(size(), false);
+
+    std::vector<size_t> discovered(size(), 0);
+    std::vector<size_t> low(size(), 0);
+    std::vector<size_t> next(size(), 0);
+    std::vector<const Bond *> parentBond(size(), static_cast<const Bond *>(0));
+    std::vector<size_t> stack;
+    size_t time = 1;
+
+    for(size_t root = 0; root < size(); root++){
+        if(discovered[root]){
+            continue;
+        }
+
+        discovered[root] = low[root] = time++;
+        next[root] = offsets[root];
+        stack.push_back(root);
+
+        while(!stack.empty()){
+            size_t vertex = stack.back();
+
+            if(next[vertex] < offsets[vertex + 1]){
+                size_t edge = next[vertex]++;
+                size_t neighbor = neighbors[edge];
+
+                if(bonds[edge] == parentBond[vertex]){
+                    continue;
+                }
+
+                if(!discovered[neighbor]){
+                    discovered[neighbor] = low[neighbor] = time++;
+                    next[neighbor] = offsets[neighbor];
+                    parentBond[neighbor] = bonds[edge];
+                    stack.push_back(neighbor);
+                }
+                else if(discovered[neighbor] < discovered[vertex]){
+                    // back edge
+                    low[vertex] = std::min(low[vertex], discovered[neighbor]);
+                    cyclic[vertex] = true;
+                    cyclic[neighbor] = true;
+                }
+            }
+            else{
+                stack.pop_back();
+
+                if(!stack.empty()){
+                    size_t parent = stack.back();
+                    low[parent] = std::min(low[parent], low[vertex]);
+
+                    if(low[vertex] <= discovered[parent]){
+                        cyclic[parent] = true;
+                        cyclic[vertex] = true;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// === SubstructureQueryPlan =============================================== //
+/// Creates a new, empty query plan.
+SubstructureQueryPlan::SubstructureQueryPlan()
+    : m_flags(0),
+      m_cyclic(false)
+{
+}
+
+/// Creates a new query plan for \p molecule using \p flags.
+SubstructureQueryPlan::SubstructureQueryPlan(const Molecule *molecule, int flags)
+    : m_flags(flags),
+      m_cyclic(false)
+{
+    Target query(molecule, flags & SubstructureQuery::CompareHydrogens, true);
+
+    // order the atoms by preferring atoms bonded to atoms already in
+    // the plan, then rarer elements and then atoms with more neighbors
+    std::vector<size_t> order;
+    std::vector<size_t> position(query.size(), NullIndex);
+    std::vector<size_t> connections(query.size(), 0);
+
+    while(order.size() < query.size()){
+        size_t best = NullIndex;
+
+        for(size_t i = 0; i < query.size(); i++){
+            if(position[i] != NullIndex){
+                continue;
+            }
+
+            if(best == NullIndex){
+                best = i;
+                continue;
+            }
+
+            if(connections[i] != connections[best]){
+                if(connections[i] > connections[best]){
+                    best = i;
+                }
+                continue;
+            }
+
+            int rank = elementRank(query.atoms[i]->atomicNumber());
+            int bestRank = elementRank(query.atoms[best]->atomicNumber());
+            if(rank != bestRank){
+                if(rank < bestRank){
+                    best = i;
+                }
+                continue;
+            }
+
+            if(query.degree(i) > query.degree(best)){
+                best = i;
+            }
+        }
+
+        position[best] = order.size();
+        order.push_back(best);
+
+        for(size_t i = query.offsets[best]; i < query.offsets[best + 1]; i++){
+            connections[query.neighbors[i]]++;
+        }
+    }
+
+    // build the constraints for each step
+    bool compareAromaticity = flags & SubstructureQuery::CompareAromaticity;
+
+    m_steps.resize(order.size());
+    m_atoms.resize(order.size());
+
+    for(size_t k = 0; k < order.size(); k++){
+        size_t vertex = order[k];
+        Step &step = m_steps[k];
+
+        m_atoms[k] = query.atoms[vertex];
+
+        step.atomicNumber = query.atoms[vertex]->atomicNumber();
+        step.degree = query.degree(vertex);
+        step.cyclic = query.cyclic[vertex];
+        step.parent = NullIndex;
+        step.parentBondOrder = 0;
+        step.parentBondAromatic = false;
+
+        m_cyclic = m_cyclic || step.cyclic;
+
+        for(size_t i = query.offsets[vertex]; i < query.offsets[vertex + 1]; i++){
+            size_t neighborStep = position[query.neighbors[i]];
+            if(neighborStep >= k){
+                continue;
+            }
+
+            const Bond *bond = query.bonds[i];
+            bool aromatic = compareAromaticity && bond->isAromatic();
+
+            if(step.parent == NullIndex || neighborStep < step.parent){
+                if(step.parent != NullIndex){
+                    step.closures.push_back(step.parent);
+                    step.closureBondOrders.push_back(step.parentBondOrder);
+                    step.closureBondAromatic.push_back(step.parentBondAromatic);
+                }
+
+                step.parent = neighborStep;
+                step.parentBondOrder = bond->order();
+                step.parentBondAromatic = aromatic;
+            }
+            else{
+                step.closures.push_back(neighborStep);
+                step.closureBondOrders.push_back(bond->order());
+                step.closureBondAromatic.push_back(aromatic);
+            }
+        }
+    }
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Returns the number of atoms in the plan.
+size_t SubstructureQueryPlan::size() const
+{
+    return m_steps.size();
+}
+
+/// Returns \c true if the plan contains no atoms.
+bool SubstructureQueryPlan::isEmpty() const
+{
+    return m_steps.empty();
+}
+
+/// Returns the flags the plan was compiled with.
+int SubstructureQueryPlan::flags() const
+{
+    return m_flags;
+}
+
+/// Returns \c true if any atom in the plan must be matched to an
+/// atom in a ring.
+bool SubstructureQueryPlan::isCyclic() const
+{
+    return m_cyclic;
+}
+
+/// Returns the query atoms in the order they are matched.
+const std::vector<Atom *>& SubstructureQueryPlan::atoms() const
+{
+    return m_atoms;
+}
+
+/// Returns the steps in the plan.
+const std::vector<SubstructureQueryPlan::Step>& SubstructureQueryPlan::steps() const
+{
+    return m_steps;
+}
+
+// --- Matching ------------------------------------------------------------ //
+/// Searches for the first match of the plan in \p molecule. If found,
+/// \p mapping is set to the target atom for each atom in atoms() and
+/// \c true is returned.
+bool SubstructureQueryPlan::match(const Molecule *molecule, std::vector<Atom *> &mapping) const
+{
+    std::vector<std::vector<Atom *> > mappings;
+
+    if(!search(molecule, 1, false, &mappings)){
+        return false;
+    }
+
+    mapping.swap(mappings.front());
+    return true;
+}
+
+/// Searches for every match of the plan in \p molecule and returns
+/// the number of matches found. If \p unique is \c true only the
+/// first match for each distinct set of target atoms is counted. If
+/// \p mappings is not \c 0 the mapping for each match is added to it.
+size_t SubstructureQueryPlan::matchAll(const Molecule *molecule,
+                                       bool unique,
+                                       std::vector<std::vector<Atom *> > *mappings) const
+{
+    return search(molecule, 0, unique, mappings);
+}
+
+/// Returns \c true if \p bond is compatible with a query bond with
+/// \p order. If \p aromatic is \c true any aromatic bond is accepted.
+bool SubstructureQueryPlan::compareBond(int order, bool aromatic, const Bond *bond)
+{
+    if(bond->order() == order){
+        return true;
+    }
+
+    return aromatic && bond->isAromatic();
+}
+
+/// Returns \c true if \p vertex in \p target satisfies the
+/// constraints of \p step given the vertices \p mapped to the
+/// earlier steps. The bond to the parent step is not checked.
+bool SubstructureQueryPlan::isFeasible(const Step &step,
+                                       size_t vertex,
+                                       const Target &target,
+                                       const std::vector<size_t> &mapped)
+{
+    if(target.atoms[vertex]->atomicNumber() != step.atomicNumber){
+        return false;
+    }
+
+    if(target.degree(vertex) < step.degree){
+        return false;
+    }
+
+    if(step.cyclic && !target.cyclic[vertex]){
+        return false;
+    }
+
+    for(size_t i = 0; i < step.closures.size(); i++){
+        const Bond *bond = target.bond(vertex, mapped[step.closures[i]]);
+
+        if(!bond || !compareBond(step.closureBondOrders[i], step.closureBondAromatic[i], bond)){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// --- Internal Methods ---------------------------------------------------- //
+// Runs a depth-first search for matches of the plan in molecule. The
+// search state is held in flat arrays indexed by step rather than in
+// a separate state object for each level of the search.
+size_t SubstructureQueryPlan::search(const Molecule *molecule,
+                                     size_t maximumCount,
+                                     bool unique,
+                                     std::vector<std::vector<Atom *> > *mappings) const
+{
+    const size_t size = m_steps.size();
+
+    if(size == 0 || molecule->size() < size){
+        return 0;
+    }
+
+    Target target(molecule, m_flags & SubstructureQuery::CompareHydrogens, m_cyclic);
+
+    std::vector<size_t> mapped(size, NullIndex);
+    std::vector<size_t> cursor(size, 0);
+    std::vector<char> used(target.size(), false);
+    std::set<std::vector<size_t> > matchedSets;
+
+    size_t count = 0;
+    size_t depth = 0;
+
+    for(;;){
+        const Step &step = m_steps[depth];
+
+        // find the next feasible candidate for this step. candidates
+        // are the neighbors of the atom matched to the step's parent
+        size_t vertex = NullIndex;
+
+        if(step.parent == NullIndex){
+            while(cursor[depth] < target.size()){
+                size_t candidate = cursor[depth]++;
+
+                if(!used[candidate] && isFeasible(step, candidate, target, mapped)){
+                    vertex = candidate;
+                    break;
+                }
+            }
+        }
+        else{
+            size_t parentVertex = mapped[step.parent];
+            size_t begin = target.offsets[parentVertex];
+            size_t end = target.offsets[parentVertex + 1];
+
+            while(begin + cursor[depth] < end){
+                size_t edge = begin + cursor[depth]++;
+                size_t candidate = target.neighbors[edge];
+
+                if(!used[candidate] &&
+                   compareBond(step.parentBondOrder, step.parentBondAromatic, target.bonds[edge]) &&
+                   isFeasible(step, candidate, target, mapped)){
+                    vertex = candidate;
+                    break;
+                }
+            }
+        }
+
+        // no candidates left, backtrack to the previous step
+        if(vertex == NullIndex){
+            if(depth == 0){
+                break;
+            }
+
+            depth--;
+            used[mapped[depth]] = false;
+            mapped[depth] = NullIndex;
+            continue;
+        }
+
+        mapped[depth] = vertex;
+
+        if(depth + 1 < size){
+            used[vertex] = true;
+            depth++;
+            cursor[depth] = 0;
+            continue;
+        }
+
+        // found a complete match
+        bool accept = true;
+
+        if(unique){
+            std::vector<size_t> matchedSet(mapped);
+            std::sort(matchedSet.begin(), matchedSet.end());
+            accept = matchedSets.insert(matchedSet).second;
+        }
+
+        if(accept){
+            count++;
+
+            if(mappings){
+                std::vector<Atom *> mapping(size);
+                for(size_t i = 0; i < size; i++){
+                    mapping[i] = target.atoms[mapped[i]];
+                }
+
+                mappings->push_back(mapping);
+            }
+
+            if(maximumCount && count >= maximumCount){
+                break;
+            }
+        }
+
+        mapped[depth] = NullIndex;
+    }
+
+    return count;
+}
+
+} // end chemkit namespace
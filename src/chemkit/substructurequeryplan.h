@@ -0,0 +1,140 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#ifndef CHEMKIT_SUBSTRUCTUREQUERYPLAN_H
+#define CHEMKIT_SUBSTRUCTUREQUERYPLAN_H
+
+#include "chemkit.h"
+
+#include <vector>
+
+namespace chemkit {
+
+class Atom;
+class Bond;
+class Molecule;
+
+// The SubstructureQueryPlan class contains a query molecule compiled
+// into the order in which its atoms are matched along with the
+// constraints that each matched target atom must satisfy.
+//
+// Atoms are matched starting with the rarest element and then by
+// extending the match along the bonds of the atoms already matched.
+// Each candidate target atom is therefore taken from the neighbors of
+// an already matched atom rather than from every atom in the target.
+class SubstructureQueryPlan
+{
+public:
+    // The Step class contains the constraints for one atom in the plan.
+    // The parent is the earlier step whose matched atom's neighbors are
+    // the candidates for this step and the closures are the other
+    // earlier steps bonded to this step.
+    struct Step
+    {
+        bool operator==(const Step &other) const;
+
+        int atomicNumber;
+        size_t degree;
+        bool cyclic;
+        size_t parent;
+        int parentBondOrder;
+        bool parentBondAromatic;
+        std::vector<size_t> closures;
+        std::vector<int> closureBondOrders;
+        std::vector<char> closureBondAromatic;
+    };
+
+    // The Target class contains the atoms of a molecule to be matched
+    // along with their adjacency stored in compressed row format. Unless
+    // hydrogens are included, terminal hydrogens are left out.
+    class Target
+    {
+    public:
+        Target(const Molecule *molecule, bool includeHydrogens, bool findCyclic);
+
+        size_t size() const { return atoms.size(); }
+        size_t degree(size_t vertex) const { return offsets[vertex + 1] - offsets[vertex]; }
+        const Bond* bond(size_t a, size_t b) const;
+
+        std::vector<Atom *> atoms;
+        std::vector<size_t> offsets;
+        std::vector<size_t> neighbors;
+        std::vector<const Bond *> bonds;
+        std::vector<char> cyclic;
+
+    private:
+        void perceiveCyclic();
+    };
+
+    // construction and destruction
+    SubstructureQueryPlan();
+    SubstructureQueryPlan(const Molecule *molecule, int flags);
+
+    // properties
+    size_t size() const;
+    bool isEmpty() const;
+    int flags() const;
+    bool isCyclic() const;
+    const std::vector<Atom *>& atoms() const;
+    const std::vector<Step>& steps() const;
+
+    // matching
+    bool match(const Molecule *molecule, std::vector<Atom *> &mapping) const;
+    size_t matchAll(const Molecule *molecule,
+                    bool unique,
+                    std::vector<std::vector<Atom *> > *mappings) const;
+    static bool compareBond(int order, bool aromatic, const Bond *bond);
+    static bool isFeasible(const Step &step,
+                           size_t vertex,
+                           const Target &target,
+                           const std::vector<size_t> &mapped);
+
+private:
+    size_t search(const Molecule *molecule,
+                  size_t maximumCount,
+                  bool unique,
+                  std::vector<std::vector<Atom *> > *mappings) const;
+
+private:
+    int m_flags;
+    bool m_cyclic;
+    std::vector<Atom *> m_atoms;
+    std::vector<Step> m_steps;
+};
+
+} // end chemkit namespace
+
+#endif // CHEMKIT_SUBSTRUCTUREQUERYPLAN_H
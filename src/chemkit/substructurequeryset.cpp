@@ -0,0 +1,462 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "substructurequeryset.h"
+
+#include <algorithm>
+
+#include <boost/make_shared.hpp>
+
+#include "atom.h"
+#include "foreach.h"
+#include "molecule.h"
+#include "substructurequery.h"
+#include "substructurequeryplan.h"
+
+namespace chemkit {
+
+namespace {
+
+const size_t NullIndex = size_t(-1);
+
+// query flags which change how the target molecule is prepared
+const int TargetFlags = SubstructureQuery::CompareHydrogens |
+                        SubstructureQuery::CompareAromaticity;
+
+// The QuerySetNode class represents a single step shared by every
+// query plan in the node's subtree.
+struct QuerySetNode
+{
+    SubstructureQueryPlan::Step step;
+    size_t parent;
+    std::vector<size_t> children;
+    std::vector<size_t> queries;
+    size_t queryCount;
+};
+
+// The QuerySetGroup class contains the prefix tree of query plans for
+// the queries which share the same target flags. Node zero is the root
+// and has no step.
+struct QuerySetGroup
+{
+    int flags;
+    bool cyclic;
+    size_t depth;
+    std::vector<size_t> queries;
+    std::vector<QuerySetNode> nodes;
+};
+
+// The QuerySetMatcher class holds the state used to match a single
+// molecule against the queries in a group.
+class QuerySetMatcher
+{
+public:
+    QuerySetMatcher(const QuerySetGroup &group,
+                    const std::vector<size_t> &queryNodes,
+                    const SubstructureQueryPlan::Target &target,
+                    bool firstOnly,
+                    std::vector<char> &resolved,
+                    std::vector<size_t> &matches);
+
+    bool isFinished() const;
+    void resolve(size_t query);
+    void accept(size_t query);
+    void search(size_t node, size_t depth);
+
+private:
+    const QuerySetGroup &m_group;
+    const std::vector<size_t> &m_queryNodes;
+    const SubstructureQueryPlan::Target &m_target;
+    bool m_firstOnly;
+    bool m_stopped;
+    std::vector<char> &m_resolved;
+    std::vector<size_t> &m_matches;
+    std::vector<size_t> m_remaining;
+    std::vector<size_t> m_mapped;
+    std::vector<char> m_used;
+};
+
+QuerySetMatcher::QuerySetMatcher(const QuerySetGroup &group,
+                                 const std::vector<size_t> &queryNodes,
+                                 const SubstructureQueryPlan::Target &target,
+                                 bool firstOnly,
+                                 std::vector<char> &resolved,
+                                 std::vector<size_t> &matches)
+    : m_group(group),
+      m_queryNodes(queryNodes),
+      m_target(target),
+      m_firstOnly(firstOnly),
+      m_stopped(false),
+      m_resolved(resolved),
+      m_matches(matches),
+      m_mapped(group.depth, NullIndex),
+      m_used(target.size(), false)
+{
+    m_remaining.reserve(group.nodes.size());
+    foreach(const QuerySetNode &node, group.nodes){
+        m_remaining.push_back(node.queryCount);
+    }
+}
+
+// Returns true if there are no queries left to search for.
+bool QuerySetMatcher::isFinished() const
+{
+    return m_stopped || m_remaining[0] == 0;
+}
+
+// Marks the query as resolved so that it is no longer searched for.
+void QuerySetMatcher::resolve(size_t query)
+{
+    if(m_resolved[query]){
+        return;
+    }
+
+    m_resolved[query] = true;
+
+    for(size_t node = m_queryNodes[query]; node != NullIndex; node = m_group.nodes[node].parent){
+        m_remaining[node]--;
+    }
+}
+
+// Marks the query as matching the target.
+void QuerySetMatcher::accept(size_t query)
+{
+    if(m_resolved[query]){
+        return;
+    }
+
+    resolve(query);
+    m_matches.push_back(query);
+
+    if(m_firstOnly){
+        m_stopped = true;
+    }
+}
+
+// Searches for matches of the steps below node. The atom matched for
+// each step is stored at the step's depth so every query in a subtree
+// shares the atoms matched for their common steps.
+void QuerySetMatcher::search(size_t node, size_t depth)
+{
+    foreach(size_t child, m_group.nodes[node].children){
+        if(m_remaining[child] == 0){
+            continue;
+        }
+
+        const QuerySetNode &childNode = m_group.nodes[child];
+        const SubstructureQueryPlan::Step &step = childNode.step;
+
+        size_t begin = 0;
+        size_t end = m_target.size();
+        if(step.parent != NullIndex){
+            begin = m_target.offsets[m_mapped[step.parent]];
+            end = m_target.offsets[m_mapped[step.parent] + 1];
+        }
+
+        for(size_t i = begin; i < end; i++){
+            size_t vertex = i;
+
+            if(step.parent != NullIndex){
+                vertex = m_target.neighbors[i];
+
+                if(!SubstructureQueryPlan::compareBond(step.parentBondOrder,
+                                                       step.parentBondAromatic,
+                                                       m_target.bonds[i])){
+                    continue;
+                }
+            }
+
+            if(m_used[vertex] || !SubstructureQueryPlan::isFeasible(step, vertex, m_target, m_mapped)){
+                continue;
+            }
+
+            m_mapped[depth] = vertex;
+            m_used[vertex] = true;
+
+            foreach(size_t query, childNode.queries){
+                accept(query);
+            }
+
+            if(m_remaining[child] > 0 && !m_stopped){
+                search(child, depth + 1);
+            }
+
+            m_used[vertex] = false;
+            m_mapped[depth] = NullIndex;
+
+            if(m_remaining[child] == 0 || m_stopped){
+                break;
+            }
+        }
+
+        if(m_stopped){
+            return;
+        }
+    }
+}
+
+} // end anonymous namespace
+
+// === SubstructureQuerySetPrivate ========================================= //
+class SubstructureQuerySetPrivate
+{
+public:
+    void match(const Molecule *molecule, bool firstOnly, std::vector<size_t> &matches) const;
+
+    std::vector<boost::shared_ptr<SubstructureQuery> > queries;
+    std::vector<size_t> queryNodes;
+    std::vector<QuerySetGroup> groups;
+};
+
+void SubstructureQuerySetPrivate::match(const Molecule *molecule,
+                                        bool firstOnly,
+                                        std::vector<size_t> &matches) const
+{
+    std::vector<char> resolved(queries.size(), false);
+
+    foreach(const QuerySetGroup &group, groups){
+        // queries whose screening fingerprint is not a subset of the
+        // molecule's cannot match and are removed from the search
+        Bitset fingerprint = queries[group.queries.front()]->screeningFingerprint(molecule);
+
+        std::vector<size_t> rejected;
+        foreach(size_t query, group.queries){
+            if(!queries[query]->passesScreen(fingerprint)){
+                rejected.push_back(query);
+            }
+        }
+
+        if(rejected.size() == group.queries.size()){
+            continue;
+        }
+
+        SubstructureQueryPlan::Target target(molecule, group.flags & SubstructureQuery::CompareHydrogens, group.cyclic);
+        QuerySetMatcher matcher(group, queryNodes, target, firstOnly, resolved, matches);
+
+        foreach(size_t query, rejected){
+            matcher.resolve(query);
+        }
+
+        // empty queries match every molecule
+        foreach(size_t query, group.nodes[0].queries){
+            matcher.accept(query);
+        }
+
+        if(!matcher.isFinished()){
+            matcher.search(0, 0);
+        }
+
+        if(firstOnly && !matches.empty()){
+            return;
+        }
+    }
+}
+
+// === SubstructureQuerySet ================================================ //
+/// \class SubstructureQuerySet substructurequeryset.h chemkit/substructurequeryset.h
+/// \ingroup chemkit
+/// \brief The SubstructureQuerySet class matches a molecule against
+///        many substructure queries at once.
+///
+/// Matching a molecule against each query in the set separately would
+/// repeat the work of preparing the molecule for every query. The
+/// query set prepares each molecule once and matches the queries
+/// together, sharing the work for queries which begin with the same
+/// atoms and bonds.
+///
+/// For example, to find which functional groups are present in a
+/// molecule:
+/// \code
+/// SubstructureQuerySet groups;
+/// size_t hydroxyl = groups.addQuery("[OH]", "smiles");
+/// size_t carboxyl = groups.addQuery("C(=O)O", "smiles");
+/// size_t amine = groups.addQuery("N", "smiles");
+///
+/// std::vector<size_t> matches = groups.matches(molecule);
+/// \endcode
+///
+/// The query molecules must not be modified after they are added to
+/// the set.
+///
+/// \see SubstructureQuery
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new, empty substructure query set.
+SubstructureQuerySet::SubstructureQuerySet()
+    : d(new SubstructureQuerySetPrivate)
+{
+}
+
+/// Destroys the substructure query set.
+SubstructureQuerySet::~SubstructureQuerySet()
+{
+    delete d;
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Returns the number of queries in the set.
+size_t SubstructureQuerySet::size() const
+{
+    return d->queries.size();
+}
+
+/// Returns \c true if the set contains no queries.
+bool SubstructureQuerySet::isEmpty() const
+{
+    return d->queries.empty();
+}
+
+// --- Queries ------------------------------------------------------------- //
+/// Adds a query for \p molecule with \p flags to the set and returns
+/// its index.
+///
+/// \see SubstructureQuery::Flag
+size_t SubstructureQuerySet::addQuery(const boost::shared_ptr<Molecule> &molecule, int flags)
+{
+    size_t index = d->queries.size();
+
+    boost::shared_ptr<SubstructureQuery> query = boost::make_shared<SubstructureQuery>(molecule);
+    query->setFlags(flags);
+    d->queries.push_back(query);
+
+    // find the group for the query's flags
+    QuerySetGroup *group = 0;
+    foreach(QuerySetGroup &existingGroup, d->groups){
+        if(existingGroup.flags == (flags & TargetFlags)){
+            group = &existingGroup;
+            break;
+        }
+    }
+
+    if(!group){
+        d->groups.push_back(QuerySetGroup());
+        group = &d->groups.back();
+        group->flags = flags & TargetFlags;
+        group->cyclic = false;
+        group->depth = 0;
+        group->nodes.resize(1);
+        group->nodes[0].parent = NullIndex;
+        group->nodes[0].queryCount = 0;
+    }
+
+    group->queries.push_back(index);
+
+    // add the steps from the query's plan to the prefix tree
+    SubstructureQueryPlan plan(molecule.get(), flags);
+    group->cyclic = group->cyclic || plan.isCyclic();
+    group->depth = std::max(group->depth, plan.size());
+
+    size_t node = 0;
+    foreach(const SubstructureQueryPlan::Step &step, plan.steps()){
+        size_t next = NullIndex;
+
+        foreach(size_t child, group->nodes[node].children){
+            if(group->nodes[child].step == step){
+                next = child;
+                break;
+            }
+        }
+
+        if(next == NullIndex){
+            next = group->nodes.size();
+
+            QuerySetNode child;
+            child.step = step;
+            child.parent = node;
+            child.queryCount = 0;
+            group->nodes.push_back(child);
+            group->nodes[node].children.push_back(next);
+        }
+
+        node = next;
+    }
+
+    group->nodes[node].queries.push_back(index);
+    d->queryNodes.push_back(node);
+
+    for(size_t i = node; i != NullIndex; i = group->nodes[i].parent){
+        group->nodes[i].queryCount++;
+    }
+
+    return index;
+}
+
+/// Adds a query for the molecule described by \p formula in
+/// \p format with \p flags to the set and returns its index.
+size_t SubstructureQuerySet::addQuery(const std::string &formula, const std::string &format, int flags)
+{
+    return addQuery(boost::make_shared<Molecule>(formula, format), flags);
+}
+
+/// Returns the query at \p index.
+const SubstructureQuery* SubstructureQuerySet::query(size_t index) const
+{
+    return d->queries[index].get();
+}
+
+/// Removes all of the queries from the set.
+void SubstructureQuerySet::clear()
+{
+    d->queries.clear();
+    d->queryNodes.clear();
+    d->groups.clear();
+}
+
+// --- Matching ------------------------------------------------------------ //
+/// Returns the indices of the queries which match \p molecule in
+/// ascending order.
+///
+/// This method is thread-safe and may be called for different
+/// molecules from multiple threads.
+std::vector<size_t> SubstructureQuerySet::matches(const Molecule *molecule) const
+{
+    std::vector<size_t> matches;
+    d->match(molecule, false, matches);
+    std::sort(matches.begin(), matches.end());
+
+    return matches;
+}
+
+/// Returns \c true if any query in the set matches \p molecule.
+bool SubstructureQuerySet::matchesAny(const Molecule *molecule) const
+{
+    std::vector<size_t> matches;
+    d->match(molecule, true, matches);
+
+    return !matches.empty();
+}
+
+} // end chemkit namespace
@@ -0,0 +1,83 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#ifndef CHEMKIT_SUBSTRUCTUREQUERYSET_H
+#define CHEMKIT_SUBSTRUCTUREQUERYSET_H
+
+#include "chemkit.h"
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+namespace chemkit {
+
+class Molecule;
+class SubstructureQuery;
+class SubstructureQuerySetPrivate;
+
+class CHEMKIT_EXPORT SubstructureQuerySet
+{
+public:
+    // construction and destruction
+    SubstructureQuerySet();
+    ~SubstructureQuerySet();
+
+    // properties
+    size_t size() const;
+    bool isEmpty() const;
+
+    // queries
+    size_t addQuery(const boost::shared_ptr<Molecule> &molecule, int flags = 0);
+    size_t addQuery(const std::string &formula, const std::string &format, int flags = 0);
+    const SubstructureQuery* query(size_t index) const;
+    void clear();
+
+    // matching
+    std::vector<size_t> matches(const Molecule *molecule) const;
+    bool matchesAny(const Molecule *molecule) const;
+
+private:
+    CHEMKIT_DISABLE_COPY(SubstructureQuerySet)
+
+private:
+    SubstructureQuerySetPrivate* const d;
+};
+
+} // end chemkit namespace
+
+#endif // CHEMKIT_SUBSTRUCTUREQUERYSET_H
@@ -0,0 +1,448 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "substructurescreen.h"
+
+#include <set>
+#include <cassert>
+
+#include <boost/bind.hpp>
+#include <boost/atomic.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include "foreach.h"
+#include "molecule.h"
+#include "taskgroup.h"
+#include "threadpool.h"
+#include "substructurequery.h"
+
+namespace chemkit {
+
+namespace {
+
+Real secondsSince(const boost::posix_time::ptime &start)
+{
+    boost::posix_time::time_duration duration =
+        boost::posix_time::microsec_clock::universal_time() - start;
+
+    return duration.total_microseconds() / 1.0e6;
+}
+
+} // end anonymous namespace
+
+// === SubstructureScreenCall ============================================== //
+// The state of a single call to SubstructureScreen::screen().
+class SubstructureScreenCall
+{
+public:
+    boost::atomic<bool> canceled;
+};
+
+// === SubstructureScreenPrivate =========================================== //
+class SubstructureScreenPrivate
+{
+public:
+    const SubstructureQuery *query;
+    size_t threadCount;
+    size_t chunkSize;
+    boost::scoped_ptr<ThreadPool> pool;
+    boost::mutex mutex;
+    std::set<SubstructureScreenCall *> calls;
+    boost::thread_specific_ptr<bool> lastCanceled;
+    std::vector<size_t> threadCounts;
+    std::vector<Real> threadTimes;
+    Real elapsedTime;
+};
+
+// === SubstructureScreen ================================================== //
+/// \class SubstructureScreen substructurescreen.h chemkit/substructurescreen.h
+/// \ingroup chemkit
+/// \brief The SubstructureScreen class runs a substructure query
+///        against many molecules in parallel.
+///
+/// The molecules to screen are split into chunks which are matched
+/// on a ThreadPool. Results are always returned in the same order as
+/// the input molecules.
+///
+/// For example, to find all of the molecules containing a benzene
+/// ring using four threads:
+/// \code
+/// SubstructureQuery query("c1ccccc1", "smiles");
+///
+/// SubstructureScreen screen(&query);
+/// screen.setThreadCount(4);
+///
+/// std::vector<Molecule *> benzenes = screen.filter(molecules);
+/// \endcode
+///
+/// Each molecule is only accessed by a single thread, so the same
+/// molecule must not appear more than once in the input.
+///
+/// Screens may be run from several threads at once. They share the
+/// screen's thread pool but each call only waits for its own chunks
+/// and has its own cancelation state.
+///
+/// \see SubstructureQuery
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new substructure screen for \p query.
+SubstructureScreen::SubstructureScreen(const SubstructureQuery *query)
+    : d(new SubstructureScreenPrivate)
+{
+    d->query = query;
+    d->threadCount = ThreadPool::idealThreadCount();
+    d->chunkSize = 64;
+    if(d->threadCount > 1){
+        d->pool.reset(new ThreadPool(d->threadCount));
+    }
+    d->threadCounts.resize(d->threadCount, 0);
+    d->threadTimes.resize(d->threadCount, 0);
+    d->elapsedTime = 0;
+}
+
+/// Destroys the substructure screen.
+SubstructureScreen::~SubstructureScreen()
+{
+    delete d;
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Returns the query for the screen.
+const SubstructureQuery* SubstructureScreen::query() const
+{
+    return d->query;
+}
+
+/// Sets the number of threads to use to \p count. If \p count is
+/// \c 0 the ideal thread count for the system is used. The default
+/// is ThreadPool::idealThreadCount().
+///
+/// Changing the thread count resets the screening statistics.
+void SubstructureScreen::setThreadCount(size_t count)
+{
+    if(count == 0){
+        count = ThreadPool::idealThreadCount();
+    }
+
+    if(count == d->threadCount){
+        return;
+    }
+
+    d->threadCount = count;
+    d->pool.reset(count > 1 ? new ThreadPool(count) : 0);
+    d->threadCounts.assign(count, 0);
+    d->threadTimes.assign(count, 0);
+}
+
+/// Returns the number of threads used for screening.
+size_t SubstructureScreen::threadCount() const
+{
+    return d->threadCount;
+}
+
+/// Sets the number of molecules matched by each task to \p size.
+/// The default chunk size is \c 64.
+void SubstructureScreen::setChunkSize(size_t size)
+{
+    d->chunkSize = std::max(size, size_t(1));
+}
+
+/// Returns the number of molecules matched by each task.
+size_t SubstructureScreen::chunkSize() const
+{
+    return d->chunkSize;
+}
+
+// --- Screening ----------------------------------------------------------- //
+/// Screens each molecule in \p molecules. The returned vector
+/// contains \c true for each molecule that matches the query.
+///
+/// If the screen is canceled the remaining molecules are not
+/// matched and are reported as \c false.
+std::vector<bool> SubstructureScreen::screen(const std::vector<const Molecule *> &molecules)
+{
+    return screenMolecules(molecules, 0);
+}
+
+/// Screens each molecule in \p molecules using the precalculated
+/// screening \p fingerprints. The fingerprint for each molecule must
+/// be at the same position as the molecule and must have been
+/// calculated with SubstructureQuery::screeningFingerprint() using
+/// the same query flags.
+///
+/// Molecules whose fingerprint does not pass the screen are reported
+/// as \c false without being matched.
+///
+/// \see fingerprints()
+std::vector<bool> SubstructureScreen::screen(const std::vector<const Molecule *> &molecules,
+                                             const std::vector<Bitset> &fingerprints)
+{
+    assert(fingerprints.size() == molecules.size());
+
+    return screenMolecules(molecules, &fingerprints);
+}
+
+/// Returns a vector containing each molecule in \p molecules that
+/// matches the query. The molecules are returned in the same order
+/// as they appear in \p molecules.
+std::vector<Molecule *> SubstructureScreen::filter(const std::vector<Molecule *> &molecules)
+{
+    std::vector<bool> matches = screen(std::vector<const Molecule *>(molecules.begin(), molecules.end()));
+
+    std::vector<Molecule *> matchingMolecules;
+
+    for(size_t i = 0; i < molecules.size(); i++){
+        if(matches[i]){
+            matchingMolecules.push_back(molecules[i]);
+        }
+    }
+
+    return matchingMolecules;
+}
+
+/// Cancels each screen which is currently running. This may be
+/// called from any thread. Molecules which have not yet been matched
+/// will be skipped. Screens started after cancel() returns are not
+/// affected.
+void SubstructureScreen::cancel()
+{
+    boost::mutex::scoped_lock lock(d->mutex);
+
+    foreach(SubstructureScreenCall *call, d->calls){
+        call->canceled = true;
+    }
+}
+
+/// Returns \c true if the last screen run from the calling thread
+/// was canceled.
+bool SubstructureScreen::isCanceled() const
+{
+    const bool *canceled = d->lastCanceled.get();
+
+    return canceled && *canceled;
+}
+
+/// Returns the screening fingerprint for each molecule in
+/// \p molecules. The fingerprints are calculated in parallel and
+/// can be passed to screen() or stored for later use.
+///
+/// \see SubstructureQuery::screeningFingerprint()
+std::vector<Bitset> SubstructureScreen::fingerprints(const std::vector<const Molecule *> &molecules)
+{
+    std::vector<Bitset> fingerprints(molecules.size());
+
+    run(molecules.size(), boost::bind(&SubstructureScreen::fingerprintChunk,
+                                      this,
+                                      &molecules,
+                                      &fingerprints,
+                                      _1,
+                                      _2));
+
+    return fingerprints;
+}
+
+// --- Statistics ---------------------------------------------------------- //
+/// Returns the total number of molecules matched by the screen.
+size_t SubstructureScreen::screenedCount() const
+{
+    size_t count = 0;
+
+    foreach(size_t threadCount, d->threadCounts){
+        count += threadCount;
+    }
+
+    return count;
+}
+
+/// Returns the number of molecules matched by each thread.
+std::vector<size_t> SubstructureScreen::threadScreenedCounts() const
+{
+    return d->threadCounts;
+}
+
+/// Returns the throughput, in molecules per second, of each thread.
+std::vector<Real> SubstructureScreen::threadThroughputs() const
+{
+    std::vector<Real> throughputs(d->threadCount, 0);
+
+    for(size_t i = 0; i < d->threadCount; i++){
+        if(d->threadTimes[i] > 0){
+            throughputs[i] = d->threadCounts[i] / d->threadTimes[i];
+        }
+    }
+
+    return throughputs;
+}
+
+/// Returns the time, in seconds, taken by the last call to screen().
+Real SubstructureScreen::elapsedTime() const
+{
+    return d->elapsedTime;
+}
+
+// --- Internal Methods ---------------------------------------------------- //
+// Screens molecules, using fingerprints if it is not null. The call is
+// registered with the screen while it runs so that cancel() can reach
+// it without affecting other calls.
+std::vector<bool> SubstructureScreen::screenMolecules(const std::vector<const Molecule *> &molecules,
+                                                      const std::vector<Bitset> *fingerprints)
+{
+    SubstructureScreenCall call;
+    call.canceled = false;
+
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+    // perceive rings for the query molecule before it is shared
+    // between threads so that it is not modified while matching
+    perceiveQueryRings();
+
+    {
+        boost::mutex::scoped_lock lock(d->mutex);
+        d->calls.insert(&call);
+    }
+
+    std::vector<char> matches(molecules.size(), false);
+
+    run(molecules.size(), boost::bind(&SubstructureScreen::screenChunk,
+                                      this,
+                                      &molecules,
+                                      fingerprints,
+                                      &matches,
+                                      &call,
+                                      _1,
+                                      _2));
+
+    {
+        boost::mutex::scoped_lock lock(d->mutex);
+        d->calls.erase(&call);
+    }
+
+    d->lastCanceled.reset(new bool(call.canceled));
+
+    setElapsedTime(secondsSince(start));
+
+    return std::vector<bool>(matches.begin(), matches.end());
+}
+
+// Calls function(begin, end) for each chunk of the range [0, size)
+// and waits for all of the chunks to complete.
+void SubstructureScreen::run(size_t size, const boost::function<void (size_t, size_t)> &function)
+{
+    if(d->threadCount == 1){
+        function(0, size);
+        return;
+    }
+
+    // only wait for this call's chunks so that concurrent screens
+    // sharing the pool do not wait on each other
+    TaskGroup group(d->pool.get());
+
+    for(size_t begin = 0; begin < size; begin += d->chunkSize){
+        size_t end = std::min(begin + d->chunkSize, size);
+
+        group.start(boost::bind(function, begin, end));
+    }
+
+    group.wait();
+}
+
+void SubstructureScreen::perceiveQueryRings() const
+{
+    boost::mutex::scoped_lock lock(d->mutex);
+
+    if(d->query->molecule()){
+        d->query->molecule()->rings();
+    }
+}
+
+void SubstructureScreen::setElapsedTime(Real time)
+{
+    boost::mutex::scoped_lock lock(d->mutex);
+
+    d->elapsedTime = time;
+}
+
+void SubstructureScreen::screenChunk(const std::vector<const Molecule *> *molecules,
+                                     const std::vector<Bitset> *fingerprints,
+                                     std::vector<char> *matches,
+                                     const SubstructureScreenCall *call,
+                                     size_t begin,
+                                     size_t end)
+{
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+    size_t count = 0;
+
+    for(size_t i = begin; i < end && !call->canceled; i++){
+        if(fingerprints){
+            (*matches)[i] = d->query->matches((*molecules)[i], (*fingerprints)[i]);
+        }
+        else{
+            (*matches)[i] = d->query->matches((*molecules)[i]);
+        }
+
+        count++;
+    }
+
+    // each pool thread only updates its own statistics. chunks run
+    // on the calling thread share the first entry.
+    int thread = d->pool ? d->pool->currentThreadIndex() : -1;
+    if(thread == -1){
+        boost::mutex::scoped_lock lock(d->mutex);
+
+        d->threadCounts[0] += count;
+        d->threadTimes[0] += secondsSince(start);
+    }
+    else{
+        d->threadCounts[thread] += count;
+        d->threadTimes[thread] += secondsSince(start);
+    }
+}
+
+void SubstructureScreen::fingerprintChunk(const std::vector<const Molecule *> *molecules,
+                                          std::vector<Bitset> *fingerprints,
+                                          size_t begin,
+                                          size_t end)
+{
+    for(size_t i = begin; i < end; i++){
+        (*fingerprints)[i] = d->query->screeningFingerprint((*molecules)[i]);
+    }
+}
+
+} // end chemkit namespace
@@ -0,0 +1,109 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#ifndef CHEMKIT_SUBSTRUCTURESCREEN_H
+#define CHEMKIT_SUBSTRUCTURESCREEN_H
+
+#include "chemkit.h"
+
+#include <vector>
+
+#include <boost/function.hpp>
+
+#include "bitset.h"
+
+namespace chemkit {
+
+class Molecule;
+class SubstructureQuery;
+class SubstructureScreenCall;
+class SubstructureScreenPrivate;
+
+class CHEMKIT_EXPORT SubstructureScreen
+{
+public:
+    // construction and destruction
+    SubstructureScreen(const SubstructureQuery *query);
+    ~SubstructureScreen();
+
+    // properties
+    const SubstructureQuery* query() const;
+    void setThreadCount(size_t count);
+    size_t threadCount() const;
+    void setChunkSize(size_t size);
+    size_t chunkSize() const;
+
+    // screening
+    std::vector<bool> screen(const std::vector<const Molecule *> &molecules);
+    std::vector<bool> screen(const std::vector<const Molecule *> &molecules,
+                             const std::vector<Bitset> &fingerprints);
+    std::vector<Molecule *> filter(const std::vector<Molecule *> &molecules);
+    void cancel();
+    bool isCanceled() const;
+    std::vector<Bitset> fingerprints(const std::vector<const Molecule *> &molecules);
+
+    // statistics
+    size_t screenedCount() const;
+    std::vector<size_t> threadScreenedCounts() const;
+    std::vector<Real> threadThroughputs() const;
+    Real elapsedTime() const;
+
+private:
+    CHEMKIT_DISABLE_COPY(SubstructureScreen)
+
+    std::vector<bool> screenMolecules(const std::vector<const Molecule *> &molecules,
+                                      const std::vector<Bitset> *fingerprints);
+    void run(size_t size, const boost::function<void (size_t, size_t)> &function);
+    void perceiveQueryRings() const;
+    void setElapsedTime(Real time);
+    void screenChunk(const std::vector<const Molecule *> *molecules,
+                     const std::vector<Bitset> *fingerprints,
+                     std::vector<char> *matches,
+                     const SubstructureScreenCall *call,
+                     size_t begin,
+                     size_t end);
+    void fingerprintChunk(const std::vector<const Molecule *> *molecules,
+                          std::vector<Bitset> *fingerprints,
+                          size_t begin,
+                          size_t end);
+
+private:
+    SubstructureScreenPrivate* const d;
+};
+
+} // end chemkit namespace
+
+#endif // CHEMKIT_SUBSTRUCTURESCREEN_H
@@ -0,0 +1,218 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "taskgroup.h"
+
+#include <boost/thread.hpp>
+#include <boost/exception_ptr.hpp>
+
+namespace chemkit {
+
+// === TaskGroupPrivate ==================================================== //
+class TaskGroupPrivate
+{
+public:
+    ThreadPool *pool;
+    boost::mutex mutex;
+    boost::condition_variable tasksDone;
+    size_t count;
+    boost::exception_ptr exception;
+};
+
+namespace {
+
+// Decrements the group's task count when the task finishes, even if
+// the task throws.
+class TaskFinisher
+{
+public:
+    TaskFinisher(TaskGroupPrivate *group)
+        : m_group(group)
+    {
+    }
+
+    ~TaskFinisher()
+    {
+        boost::lock_guard<boost::mutex> lock(m_group->mutex);
+        if(--m_group->count == 0){
+            m_group->tasksDone.notify_all();
+        }
+    }
+
+private:
+    TaskGroupPrivate *m_group;
+};
+
+struct GroupTask
+{
+    TaskGroupPrivate *group;
+    ThreadPool::Task task;
+
+    void operator()() const
+    {
+        TaskFinisher finisher(group);
+
+        try {
+            task();
+        }
+        catch(...){
+            boost::lock_guard<boost::mutex> lock(group->mutex);
+            if(!group->exception){
+                group->exception = boost::current_exception();
+            }
+        }
+    }
+};
+
+} // end anonymous namespace
+
+// === TaskGroup =========================================================== //
+/// \class TaskGroup taskgroup.h chemkit/taskgroup.h
+/// \ingroup chemkit
+/// \brief The TaskGroup class tracks a set of tasks started in a
+///        ThreadPool.
+///
+/// Unlike ThreadPool::waitForDone(), which waits for every task in
+/// the pool, wait() only waits for the tasks started through the
+/// group. This allows several callers to share one pool without
+/// waiting on each other's tasks.
+///
+/// If wait() is called from one of the pool's own threads (for
+/// example from within another task) the calling thread runs queued
+/// tasks while it waits instead of blocking, so nested groups do not
+/// deadlock the pool.
+///
+/// If a task in the group throws an exception the remaining tasks
+/// still run and the first exception is rethrown from wait().
+///
+/// \code
+/// TaskGroup group(pool);
+/// for(size_t i = 0; i < chunkCount; i++){
+///     group.start(boost::bind(processChunk, i));
+/// }
+/// group.wait();
+/// \endcode
+///
+/// \see ThreadPool
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new task group which starts tasks in \p pool.
+TaskGroup::TaskGroup(ThreadPool *pool)
+    : d(new TaskGroupPrivate)
+{
+    d->pool = pool;
+    d->count = 0;
+}
+
+/// Destroys the task group. Waits for any tasks in the group that
+/// have not yet finished. Exceptions from tasks that were never
+/// waited for are discarded.
+TaskGroup::~TaskGroup()
+{
+    waitForTasks();
+
+    delete d;
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Returns the pool that the group starts tasks in.
+ThreadPool* TaskGroup::pool() const
+{
+    return d->pool;
+}
+
+// --- Tasks --------------------------------------------------------------- //
+/// Starts \p task in the pool as part of the group.
+void TaskGroup::start(const ThreadPool::Task &task)
+{
+    {
+        boost::lock_guard<boost::mutex> lock(d->mutex);
+        d->count++;
+    }
+
+    GroupTask groupTask;
+    groupTask.group = d;
+    groupTask.task = task;
+
+    d->pool->start(groupTask);
+}
+
+/// Blocks until all of the tasks started in the group have
+/// finished. If any of the tasks threw an exception the first one is
+/// rethrown.
+void TaskGroup::wait()
+{
+    waitForTasks();
+
+    boost::exception_ptr exception;
+    {
+        boost::lock_guard<boost::mutex> lock(d->mutex);
+        exception = d->exception;
+        d->exception = boost::exception_ptr();
+    }
+
+    if(exception){
+        boost::rethrow_exception(exception);
+    }
+}
+
+// --- Internal Methods ---------------------------------------------------- //
+// Blocks until all of the tasks in the group have finished. Exceptions
+// stored by the tasks are left for the caller.
+void TaskGroup::waitForTasks()
+{
+    int index = d->pool->currentThreadIndex();
+
+    boost::unique_lock<boost::mutex> lock(d->mutex);
+
+    while(d->count != 0){
+        if(index == -1){
+            d->tasksDone.wait(lock);
+            continue;
+        }
+
+        // help run queued tasks rather than blocking a pool thread
+        lock.unlock();
+        bool ran = d->pool->runTask(static_cast<size_t>(index));
+        lock.lock();
+
+        if(!ran && d->count != 0){
+            d->tasksDone.timed_wait(lock, boost::posix_time::milliseconds(1));
+        }
+    }
+}
+
+} // end chemkit namespace
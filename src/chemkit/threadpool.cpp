@@ -0,0 +1,341 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "threadpool.h"
+
+#include <deque>
+#include <cassert>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/exception_ptr.hpp>
+
+namespace chemkit {
+
+namespace {
+
+// Each worker owns a queue of tasks. Workers take tasks from the back
+// of their own queue and steal from the front of other queues when
+// their own queue is empty.
+struct WorkerQueue
+{
+    boost::mutex mutex;
+    std::deque<ThreadPool::Task> tasks;
+};
+
+struct CurrentThread
+{
+    const ThreadPool *pool;
+    size_t index;
+};
+
+boost::thread_specific_ptr<CurrentThread> currentThread;
+
+} // end anonymous namespace
+
+// === ThreadPoolPrivate =================================================== //
+class ThreadPoolPrivate
+{
+public:
+    std::vector<WorkerQueue *> queues;
+    boost::thread_group threads;
+    boost::mutex mutex;
+    boost::condition_variable taskAvailable;
+    boost::condition_variable tasksDone;
+    size_t pendingCount;
+    size_t activeCount;
+    size_t nextQueue;
+    bool stopping;
+    boost::exception_ptr exception;
+};
+
+// === ThreadPool ========================================================== //
+/// \class ThreadPool threadpool.h chemkit/threadpool.h
+/// \ingroup chemkit
+/// \brief The ThreadPool class manages a fixed set of worker threads.
+///
+/// Tasks are distributed over per-thread queues. Idle threads steal
+/// work from busy ones so that uneven tasks (such as substructure
+/// matches against molecules of very different sizes) keep every
+/// thread busy.
+///
+/// If a task throws an exception it is caught on the worker thread
+/// and rethrown to the caller of waitForDone() (or TaskGroup::wait()
+/// for tasks started through a group).
+///
+/// Tasks should not block waiting on other tasks started in the same
+/// pool as this can exhaust the available threads. Use a TaskGroup to
+/// wait for a set of tasks, from within a task or when the pool is
+/// shared between several callers.
+///
+/// \see TaskGroup, concurrent::run()
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new thread pool with \p threadCount threads. If
+/// \p threadCount is \c 0 idealThreadCount() threads are used.
+ThreadPool::ThreadPool(size_t threadCount)
+    : d(new ThreadPoolPrivate)
+{
+    if(threadCount == 0){
+        threadCount = idealThreadCount();
+    }
+
+    d->pendingCount = 0;
+    d->activeCount = 0;
+    d->nextQueue = 0;
+    d->stopping = false;
+
+    for(size_t i = 0; i < threadCount; i++){
+        d->queues.push_back(new WorkerQueue);
+    }
+
+    for(size_t i = 0; i < threadCount; i++){
+        d->threads.create_thread(boost::bind(&ThreadPool::workerLoop, this, i));
+    }
+}
+
+/// Destroys the thread pool. Any tasks which have already been
+/// started are run before the pool is destroyed.
+ThreadPool::~ThreadPool()
+{
+    // exceptions from tasks that were never waited for are discarded
+    try {
+        waitForDone();
+    }
+    catch(...){
+    }
+
+    {
+        boost::lock_guard<boost::mutex> lock(d->mutex);
+        d->stopping = true;
+    }
+
+    d->taskAvailable.notify_all();
+    d->threads.join_all();
+
+    for(size_t i = 0; i < d->queues.size(); i++){
+        delete d->queues[i];
+    }
+
+    delete d;
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Returns the number of threads in the pool.
+size_t ThreadPool::threadCount() const
+{
+    return d->queues.size();
+}
+
+/// Returns the index of the calling thread in the pool or \c -1 if
+/// the calling thread does not belong to the pool.
+int ThreadPool::currentThreadIndex() const
+{
+    const CurrentThread *thread = currentThread.get();
+
+    if(!thread || thread->pool != this){
+        return -1;
+    }
+
+    return static_cast<int>(thread->index);
+}
+
+// --- Tasks --------------------------------------------------------------- //
+/// Starts \p task on one of the threads in the pool.
+///
+/// Tasks started from within a pool thread are queued on that
+/// thread's own queue.
+void ThreadPool::start(const Task &task)
+{
+    int index = currentThreadIndex();
+
+    if(index == -1){
+        boost::lock_guard<boost::mutex> lock(d->mutex);
+        index = static_cast<int>(d->nextQueue++ % d->queues.size());
+    }
+
+    // the pending count is incremented before the task is queued so
+    // that it can never be taken before it has been counted
+    {
+        boost::lock_guard<boost::mutex> lock(d->mutex);
+        d->pendingCount++;
+    }
+
+    WorkerQueue *queue = d->queues[index];
+    {
+        boost::lock_guard<boost::mutex> lock(queue->mutex);
+        queue->tasks.push_back(task);
+    }
+
+    d->taskAvailable.notify_one();
+}
+
+/// Blocks until all of the tasks started in the pool have finished.
+/// If any of the tasks threw an exception the first one is rethrown.
+///
+/// This must not be called from one of the pool's own threads as the
+/// calling task would wait for itself. To wait for only the tasks
+/// started by one caller use a TaskGroup.
+void ThreadPool::waitForDone()
+{
+    assert(currentThreadIndex() == -1);
+
+    boost::unique_lock<boost::mutex> lock(d->mutex);
+
+    while(d->pendingCount != 0 || d->activeCount != 0){
+        d->tasksDone.wait(lock);
+    }
+
+    if(d->exception){
+        boost::exception_ptr exception = d->exception;
+        d->exception = boost::exception_ptr();
+        lock.unlock();
+
+        boost::rethrow_exception(exception);
+    }
+}
+
+// --- Static Methods ------------------------------------------------------ //
+/// Returns the global thread pool. The global pool is created the
+/// first time it is used and contains idealThreadCount() threads.
+ThreadPool* ThreadPool::globalInstance()
+{
+    static ThreadPool pool;
+
+    return &pool;
+}
+
+/// Returns the ideal number of threads for the system. This is
+/// equal to the number of processor cores.
+size_t ThreadPool::idealThreadCount()
+{
+    size_t count = boost::thread::hardware_concurrency();
+
+    return count > 0 ? count : 1;
+}
+
+// --- Internal Methods ---------------------------------------------------- //
+void ThreadPool::workerLoop(size_t index)
+{
+    CurrentThread *thread = new CurrentThread;
+    thread->pool = this;
+    thread->index = index;
+    currentThread.reset(thread);
+
+    for(;;){
+        if(runTask(index)){
+            continue;
+        }
+
+        boost::unique_lock<boost::mutex> lock(d->mutex);
+        while(d->pendingCount == 0 && !d->stopping){
+            d->taskAvailable.wait(lock);
+        }
+
+        if(d->pendingCount == 0 && d->stopping){
+            break;
+        }
+    }
+}
+
+// Takes a task from the worker's own queue or steals one from another
+// worker. Returns false if no tasks are queued.
+bool ThreadPool::takeTask(size_t index, Task &task)
+{
+    const size_t queueCount = d->queues.size();
+
+    for(size_t i = 0; i < queueCount && task.empty(); i++){
+        WorkerQueue *queue = d->queues[(index + i) % queueCount];
+
+        boost::lock_guard<boost::mutex> lock(queue->mutex);
+        if(queue->tasks.empty()){
+            continue;
+        }
+
+        if(i == 0){
+            task = queue->tasks.back();
+            queue->tasks.pop_back();
+        }
+        else{
+            task = queue->tasks.front();
+            queue->tasks.pop_front();
+        }
+    }
+
+    if(task.empty()){
+        return false;
+    }
+
+    boost::lock_guard<boost::mutex> lock(d->mutex);
+    d->pendingCount--;
+    d->activeCount++;
+
+    return true;
+}
+
+// Takes a task and runs it on the calling thread. Returns false if
+// no tasks are queued. An exception thrown by the task is stored and
+// rethrown from waitForDone().
+bool ThreadPool::runTask(size_t index)
+{
+    Task task;
+    if(!takeTask(index, task)){
+        return false;
+    }
+
+    boost::exception_ptr exception;
+    try {
+        task();
+    }
+    catch(...){
+        exception = boost::current_exception();
+    }
+
+    boost::lock_guard<boost::mutex> lock(d->mutex);
+    if(exception && !d->exception){
+        d->exception = exception;
+    }
+
+    d->activeCount--;
+    if(d->pendingCount == 0 && d->activeCount == 0){
+        d->tasksDone.notify_all();
+    }
+
+    return true;
+}
+
+} // end chemkit namespace
@@ -38,14 +38,24 @@
 
 #include "genericfile.h"
 
+#include <cctype>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <boost/bind.hpp>
 #include <boost/format.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/iostreams/device/array.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
 
+#include <chemkit/foreach.h>
+#include <chemkit/taskgroup.h>
+#include <chemkit/threadpool.h>
+
 #ifndef CHEMKIT_OS_WIN32
 #include <boost/iostreams/filter/gzip.hpp>
 #include <boost/iostreams/filter/bzip2.hpp>
@@ -65,14 +75,16 @@ namespace chemkit {
 /// Creates a new file.
 template<typename File, typename Format>
 inline GenericFile<File, Format>::GenericFile()
-    : m_format(0)
+    : m_format(0),
+      m_threadCount(1)
 {
 }
 
 /// Creates a new file with \p fileName.
 template<typename File, typename Format>
 inline GenericFile<File, Format>::GenericFile(const std::string &fileName)
-    : m_format(0)
+    : m_format(0),
+      m_threadCount(1)
 {
     setFileName(fileName);
 }
@@ -203,6 +215,34 @@ inline std::string GenericFile<File, Format>::compressionFormat() const
     return m_compressionFormat;
 }
 
+/// Sets the number of threads used to read the file to \p count. If
+/// \p count is \c 0 the ideal thread count for the system is used.
+/// The default is \c 1.
+///
+/// When more than one thread is used and the file's format is able
+/// to split its data into independent records (e.g. SDF or SMILES
+/// files) the file is memory-mapped, divided into chunks at record
+/// boundaries and each chunk is parsed concurrently on the global
+/// ThreadPool. The records are then added to the file in the same
+/// order as they appear in the file. Compressed files and formats
+/// which cannot be split are always read sequentially.
+template<typename File, typename Format>
+inline void GenericFile<File, Format>::setThreadCount(size_t count)
+{
+    if(count == 0){
+        count = ThreadPool::idealThreadCount();
+    }
+
+    m_threadCount = count;
+}
+
+/// Returns the number of threads used to read the file.
+template<typename File, typename Format>
+inline size_t GenericFile<File, Format>::threadCount() const
+{
+    return m_threadCount;
+}
+
 // --- Input and Output ---------------------------------------------------- //
 /// Reads the file using the current file name. Returns \c false if
 /// no file name is set or if reading of the file fails.
@@ -218,6 +258,22 @@ inline bool GenericFile<File, Format>::read()
         return false;
     }
 
+    // read uncompressed files in parallel if the format supports it
+    if(m_threadCount > 1 && m_compressionFormat.empty()){
+        boost::iostreams::mapped_file_source mappedFile;
+
+        try {
+            mappedFile.open(m_fileName);
+        }
+        catch(std::exception &){
+        }
+
+        bool ok = false;
+        if(mappedFile.is_open() && readChunks(mappedFile.data(), mappedFile.size(), &ok)){
+            return ok;
+        }
+    }
+
     // open file
     std::ifstream file(m_fileName.c_str());
     if(!file.is_open()){
@@ -354,8 +410,14 @@ inline bool GenericFile<File, Format>::read(const boost::iostreams::mapped_file_
         return false;
     }
 
+    // read the file in parallel if the format supports it
+    bool ok = false;
+    if(m_threadCount > 1 && readChunks(input.data(), input.size(), &ok)){
+        return ok;
+    }
+
     // read the file
-    bool ok = m_format->readMappedFile(input, static_cast<File *>(this));
+    ok = m_format->readMappedFile(input, static_cast<File *>(this));
     if(!ok){
         setErrorString(m_format->errorString());
     }
@@ -527,6 +589,157 @@ inline std::string GenericFile<File, Format>::suffix(const std::string &fileName
     return suffix;
 }
 
+// Splits data into chunks at record boundaries and reads each chunk
+// on a separate thread. Returns false if the data could not be split
+// (in which case it should be read sequentially). Otherwise ok is set
+// to indicate whether every chunk was read successfully.
+template<typename File, typename Format>
+inline bool GenericFile<File, Format>::readChunks(const char *data, size_t size, bool *ok)
+{
+    // minimum number of bytes per chunk
+    const size_t minimumChunkSize = 64 * 1024;
+
+    const File *self = static_cast<const File *>(this);
+    if(self->_recordBoundary(data, size, 0) != 0){
+        return false;
+    }
+
+    // several chunks per thread keep the threads busy when the
+    // records are not uniformly sized
+    size_t chunkCount = std::min(m_threadCount * 4, size / minimumChunkSize);
+    if(chunkCount < 2){
+        return false;
+    }
+
+    // find chunk boundaries
+    std::vector<size_t> boundaries;
+    boundaries.push_back(0);
+
+    for(size_t i = 1; i < chunkCount; i++){
+        size_t position = std::max(i * (size / chunkCount), boundaries.back() + 1);
+        if(position >= size){
+            break;
+        }
+
+        size_t boundary = self->_recordBoundary(data, size, position);
+        if(boundary == std::string::npos){
+            return false;
+        }
+        else if(boundary >= size){
+            break;
+        }
+        else if(boundary > boundaries.back()){
+            boundaries.push_back(boundary);
+        }
+    }
+
+    boundaries.push_back(size);
+
+    if(boundaries.size() < 3){
+        return false;
+    }
+
+    // read each chunk into its own file
+    size_t count = boundaries.size() - 1;
+    std::vector<boost::shared_ptr<File> > files(count);
+    std::vector<char> results(count, true);
+
+    // the chunks are read on the global pool and the group only waits
+    // for this file's chunks
+    TaskGroup group(ThreadPool::globalInstance());
+
+    for(size_t i = 0; i < count; i++){
+        const char *begin = data + boundaries[i];
+        const char *end = data + boundaries[i+1];
+
+        // skip chunks which only contain white space
+        bool empty = true;
+        for(const char *c = begin; c != end; c++){
+            if(!isspace(static_cast<unsigned char>(*c))){
+                empty = false;
+                break;
+            }
+        }
+
+        if(empty){
+            continue;
+        }
+
+        Format *format = self->_cloneFormat();
+        if(!format){
+            group.wait();
+            return false;
+        }
+
+        files[i].reset(new File);
+        files[i]->setFormat(format);
+
+        group.start(boost::bind(&GenericFile<File, Format>::readChunk,
+                               files[i].get(),
+                               begin,
+                               end,
+                               &results[i]));
+    }
+
+    group.wait();
+
+    // check for errors
+    for(size_t i = 0; i < count; i++){
+        if(!results[i]){
+            setErrorString(files[i]->format()->errorString());
+            *ok = false;
+            return true;
+        }
+    }
+
+    // add the contents of each chunk in file order
+    foreach(const boost::shared_ptr<File> &file, files){
+        if(file){
+            static_cast<File *>(this)->_appendFile(file.get());
+        }
+    }
+
+    *ok = true;
+    return true;
+}
+
+// Reads the data between begin and end into file.
+template<typename File, typename Format>
+inline void GenericFile<File, Format>::readChunk(File *file, const char *begin, const char *end, char *ok)
+{
+    boost::iostreams::stream<boost::iostreams::array_source> stream(begin, end - begin);
+
+    *ok = file->format()->read(stream, file);
+}
+
+// Returns the offset of the first record starting at or after
+// position. The default implementation returns npos indicating that
+// the file cannot be split into independent records.
+template<typename File, typename Format>
+inline size_t GenericFile<File, Format>::_recordBoundary(const char *data, size_t size, size_t position) const
+{
+    CHEMKIT_UNUSED(data);
+    CHEMKIT_UNUSED(size);
+    CHEMKIT_UNUSED(position);
+
+    return std::string::npos;
+}
+
+// Returns a copy of the file's format used to read a single chunk.
+template<typename File, typename Format>
+inline Format* GenericFile<File, Format>::_cloneFormat() const
+{
+    return Format::create(formatName());
+}
+
+// Appends the contents of file (containing a single chunk) to the
+// file. The default implementation does nothing.
+template<typename File, typename Format>
+inline void GenericFile<File, Format>::_appendFile(File *file)
+{
+    CHEMKIT_UNUSED(file);
+}
+
 // Reads the file from the string. This is an internal convenience method
 // provided to ease the implementation of the Python API for file I/O.
 template<typename File, typename Format>
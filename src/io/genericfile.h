@@ -69,6 +69,8 @@ public:
     std::string formatName() const;
     bool setCompressionFormat(const std::string &name);
     std::string compressionFormat() const;
+    void setThreadCount(size_t count);
+    size_t threadCount() const;
 
     // input and output
     bool read();
@@ -95,6 +97,9 @@ public:
     // internal methods
     bool _readFromString(const std::string &string);
     std::string _writeToString();
+    size_t _recordBoundary(const char *data, size_t size, size_t position) const;
+    Format* _cloneFormat() const;
+    void _appendFile(File *file);
 
     // static methods
     static std::vector<std::string> formats();
@@ -105,12 +110,15 @@ protected:
 
 private:
     std::string suffix(const std::string &fileName);
+    bool readChunks(const char *data, size_t size, bool *ok);
+    static void readChunk(File *file, const char *begin, const char *end, char *ok);
 
 private:
     Format *m_format;
     std::string m_fileName;
     std::string m_errorString;
     std::string m_compressionFormat;
+    size_t m_threadCount;
     VariantMap m_data;
 };
 
@@ -186,6 +186,29 @@ void MoleculeFile::clear()
     d->fileData.clear();
 }
 
+// --- Internal Methods ---------------------------------------------------- //
+// Returns the offset of the first record starting at or after position
+// in data. Used to split the file for parallel reading.
+size_t MoleculeFile::_recordBoundary(const char *data, size_t size, size_t position) const
+{
+    return format()->recordBoundary(data, size, position);
+}
+
+// Returns a copy of the file's format (including its options) used to
+// read a single chunk of the file.
+MoleculeFileFormat* MoleculeFile::_cloneFormat() const
+{
+    return format()->clone();
+}
+
+// Appends the molecules read from a single chunk of the file.
+void MoleculeFile::_appendFile(MoleculeFile *file)
+{
+    d->molecules.insert(d->molecules.end(),
+                        file->d->molecules.begin(),
+                        file->d->molecules.end());
+}
+
 // --- Static Methods ------------------------------------------------------ //
 /// Reads and returns a molecule from the file. Returns a null pointer if
 /// there was an error reading the file or the file is empty.
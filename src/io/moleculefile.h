@@ -77,6 +77,11 @@ public:
     bool contains(const boost::shared_ptr<Molecule> &molecule) const;
     void clear();
 
+    // internal methods
+    size_t _recordBoundary(const char *data, size_t size, size_t position) const;
+    MoleculeFileFormat* _cloneFormat() const;
+    void _appendFile(MoleculeFile *file);
+
     // static methods
     static boost::shared_ptr<Molecule> quickRead(const std::string &fileName);
     static void quickWrite(const Molecule *molecule, const std::string &fileName);
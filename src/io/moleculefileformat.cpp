@@ -38,11 +38,14 @@
 #include <map>
 
 #include <boost/format.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <boost/algorithm/string.hpp>
 
 #include <chemkit/variantmap.h>
 #include <chemkit/pluginmanager.h>
 
+#include "moleculefile.h"
+
 namespace chemkit {
 
 // === MoleculeFileFormatPrivate =========================================== //
@@ -52,6 +55,8 @@ public:
     std::string name;
     std::string errorString;
     VariantMap options;
+    boost::scoped_ptr<MoleculeFile> bufferedFile;
+    size_t bufferedIndex;
 };
 
 // === MoleculeFileFormat ================================================== //
@@ -76,6 +81,7 @@ MoleculeFileFormat::MoleculeFileFormat(const std::string &name)
     : d(new MoleculeFileFormatPrivate)
 {
     d->name = boost::algorithm::to_lower_copy(name);
+    d->bufferedIndex = 0;
 }
 
 /// Destroys a molecule file format.
@@ -151,6 +157,84 @@ bool MoleculeFileFormat::write(const MoleculeFile *file, std::ostream &output)
     return false;
 }
 
+/// Reads and returns the next molecule from \p input. Returns a
+/// null pointer once the end of \p input has been reached or if an
+/// error occurred (in which case errorString() will be set).
+///
+/// Formats that store one molecule per record (e.g. SDF, MOL2 or
+/// SMILES files) reimplement this method to parse a single record at
+/// a time. The default implementation reads the entire contents of
+/// \p input on the first call and then returns the buffered molecules
+/// one by one.
+///
+/// \see MoleculeFileReader
+boost::shared_ptr<Molecule> MoleculeFileFormat::readNextMolecule(std::istream &input)
+{
+    if(!d->bufferedFile){
+        d->bufferedFile.reset(new MoleculeFile);
+        d->bufferedIndex = 0;
+
+        if(!read(input, d->bufferedFile.get())){
+            return boost::shared_ptr<Molecule>();
+        }
+    }
+
+    if(d->bufferedIndex >= d->bufferedFile->moleculeCount()){
+        return boost::shared_ptr<Molecule>();
+    }
+
+    return d->bufferedFile->molecule(d->bufferedIndex++);
+}
+
+/// Writes a single \p molecule to \p output. Returns \c false if
+/// the format does not support writing molecules one at a time.
+///
+/// Formats which can be written by concatenating records reimplement
+/// this method so that output can be produced without first
+/// collecting every molecule in a MoleculeFile.
+bool MoleculeFileFormat::writeMolecule(const Molecule *molecule, std::ostream &output)
+{
+    CHEMKIT_UNUSED(molecule);
+    CHEMKIT_UNUSED(output);
+
+    setErrorString((boost::format("'%s' incremental writing not supported.") % name()).str());
+    return false;
+}
+
+/// Returns the offset of the first record in \p data which starts
+/// at or after \p position. Returns \p size if no record starts after
+/// \p position and \c std::string::npos if the format does not
+/// support splitting its data into independent records.
+///
+/// Formats which store each molecule in a self-contained record
+/// (e.g. SDF or SMILES files) reimplement this method so that large
+/// files can be split into chunks and parsed in parallel. A position
+/// of \c 0 is always the start of the first record.
+///
+/// \see GenericFile::setThreadCount()
+size_t MoleculeFileFormat::recordBoundary(const char *data, size_t size, size_t position) const
+{
+    CHEMKIT_UNUSED(data);
+    CHEMKIT_UNUSED(size);
+    CHEMKIT_UNUSED(position);
+
+    return std::string::npos;
+}
+
+// --- Copying ------------------------------------------------------------- //
+/// Returns a new format object of the same type with the same
+/// options. The ownership of the returned format is passed to the
+/// caller.
+MoleculeFileFormat* MoleculeFileFormat::clone() const
+{
+    MoleculeFileFormat *format = create(name());
+    if(format){
+        format->d->options = d->options;
+    }
+
+    return format;
+}
+
 // --- Error Handling ------------------------------------------------------ //
 /// Sets a string describing the last error that occurred.
 void MoleculeFileFormat::setErrorString(const std::string &error)
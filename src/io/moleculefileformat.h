@@ -43,6 +43,7 @@
 #include <istream>
 #include <ostream>
 
+#include <boost/shared_ptr.hpp>
 #include <boost/iostreams/device/mapped_file.hpp>
 
 #include <chemkit/plugin.h>
@@ -50,6 +51,7 @@
 
 namespace chemkit {
 
+class Molecule;
 class MoleculeFile;
 class MoleculeFileFormatPrivate;
 
@@ -70,10 +72,16 @@ public:
     virtual bool read(std::istream &input, MoleculeFile *file);
     virtual bool readMappedFile(const boost::iostreams::mapped_file_source &input, MoleculeFile *file);
     virtual bool write(const MoleculeFile *file, std::ostream &output);
+    virtual boost::shared_ptr<Molecule> readNextMolecule(std::istream &input);
+    virtual bool writeMolecule(const Molecule *molecule, std::ostream &output);
+    virtual size_t recordBoundary(const char *data, size_t size, size_t position) const;
 
     // error handling
     std::string errorString() const;
 
+    // copying
+    MoleculeFileFormat* clone() const;
+
     // static methods
     static MoleculeFileFormat* create(const std::string &format);
     static std::vector<std::string> formats();
@@ -38,6 +38,9 @@
 
 #include "moleculefileformatadaptor.h"
 
+#include <cstring>
+#include <algorithm>
+
 #include <boost/foreach.hpp>
 #include <boost/algorithm/string.hpp>
 
@@ -70,6 +73,29 @@ inline MoleculeFileFormatAdaptor<LineFormat>::~MoleculeFileFormatAdaptor()
 }
 
 inline bool MoleculeFileFormatAdaptor<LineFormat>::read(std::istream &input, MoleculeFile *file)
+{
+    for(;;){
+        boost::shared_ptr<Molecule> molecule = readNextMolecule(input);
+        if(!molecule){
+            break;
+        }
+
+        file->addMolecule(molecule);
+    }
+
+    return true;
+}
+
+inline bool MoleculeFileFormatAdaptor<LineFormat>::write(const MoleculeFile *file, std::ostream &output)
+{
+    BOOST_FOREACH(const boost::shared_ptr<Molecule> &molecule, file->molecules()){
+        writeMolecule(molecule.get(), output);
+    }
+
+    return true;
+}
+
+inline boost::shared_ptr<Molecule> MoleculeFileFormatAdaptor<LineFormat>::readNextMolecule(std::istream &input)
 {
     while(!input.eof()){
         std::string line;
@@ -94,28 +120,43 @@ inline bool MoleculeFileFormatAdaptor<LineFormat>::read(std::istream &input, Mol
             molecule->setName(lineItems[1]);
         }
 
-        file->addMolecule(molecule);
+        return molecule;
     }
 
-    return true;
+    return boost::shared_ptr<Molecule>();
 }
 
-inline bool MoleculeFileFormatAdaptor<LineFormat>::write(const MoleculeFile *file, std::ostream &output)
+inline bool MoleculeFileFormatAdaptor<LineFormat>::writeMolecule(const Molecule *molecule, std::ostream &output)
 {
-    BOOST_FOREACH(const boost::shared_ptr<Molecule> &molecule, file->molecules()){
-        std::string formula = m_format->write(molecule.get());
-        output << formula;
-
-        if(!molecule->name().empty()){
-            output << " " << molecule->name();
-        }
+    std::string formula = m_format->write(molecule);
+    output << formula;
 
-        output << "\n";
+    if(!molecule->name().empty()){
+        output << " " << molecule->name();
     }
 
+    output << "\n";
+
     return true;
 }
 
+inline size_t MoleculeFileFormatAdaptor<LineFormat>::recordBoundary(const char *data,
+                                                                    size_t size,
+                                                                    size_t position) const
+{
+    if(position == 0 || position >= size){
+        return std::min(position, size);
+    }
+
+    // each line contains a single record
+    const char *lineEnd = static_cast<const char *>(memchr(data + position - 1, '\n', size - position + 1));
+    if(!lineEnd){
+        return size;
+    }
+
+    return static_cast<size_t>(lineEnd - data) + 1;
+}
+
 // === MoleculeFileFormatAdaptor<PolymerFileFormat> ======================= //
 inline MoleculeFileFormatAdaptor<PolymerFileFormat>::MoleculeFileFormatAdaptor(PolymerFileFormat *format)
     : MoleculeFileFormat(format->name())
@@ -58,6 +58,9 @@ public:
 
     virtual bool read(std::istream &input, MoleculeFile *file) CHEMKIT_OVERRIDE;
     virtual bool write(const MoleculeFile *file, std::ostream &output) CHEMKIT_OVERRIDE;
+    virtual boost::shared_ptr<Molecule> readNextMolecule(std::istream &input) CHEMKIT_OVERRIDE;
+    virtual bool writeMolecule(const Molecule *molecule, std::ostream &output) CHEMKIT_OVERRIDE;
+    virtual size_t recordBoundary(const char *data, size_t size, size_t position) const CHEMKIT_OVERRIDE;
 
 private:
     LineFormat *m_format;
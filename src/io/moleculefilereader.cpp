@@ -0,0 +1,310 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "moleculefilereader.h"
+
+#include <fstream>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#ifndef CHEMKIT_OS_WIN32
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/bzip2.hpp>
+#endif
+
+#include <chemkit/molecule.h>
+
+#include "moleculefile.h"
+#include "moleculefileformat.h"
+
+namespace chemkit {
+
+// === MoleculeFileReaderPrivate =========================================== //
+class MoleculeFileReaderPrivate
+{
+public:
+    MoleculeFile file;
+    boost::scoped_ptr<std::ifstream> fileStream;
+    boost::scoped_ptr<boost::iostreams::filtering_istream> stream;
+    size_t position;
+    std::string errorString;
+};
+
+// === MoleculeFileReader ================================================== //
+/// \class MoleculeFileReader moleculefilereader.h chemkit/moleculefilereader.h
+/// \ingroup chemkit-io
+/// \brief The MoleculeFileReader class reads molecules from a file
+///        one at a time.
+///
+/// Unlike MoleculeFile, which reads every molecule in a file into
+/// memory before any of them can be accessed, the MoleculeFileReader
+/// class parses a single record each time next() is called. This
+/// allows very large molecule libraries to be processed in constant
+/// memory.
+///
+/// The following example shows how to iterate over each molecule in
+/// a file:
+/// \code
+/// MoleculeFileReader reader("library.sdf");
+/// reader.open();
+///
+/// while(boost::shared_ptr<Molecule> molecule = reader.next()){
+///     std::cout << molecule->formula() << std::endl;
+/// }
+/// \endcode
+///
+/// Formats which do not support incremental reading (see
+/// MoleculeFileFormat::readNextMolecule()) are read completely when
+/// the first molecule is requested.
+///
+/// \see MoleculeFile
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new molecule file reader.
+MoleculeFileReader::MoleculeFileReader()
+    : d(new MoleculeFileReaderPrivate)
+{
+    d->position = 0;
+}
+
+/// Creates a new molecule file reader for \p fileName.
+MoleculeFileReader::MoleculeFileReader(const std::string &fileName)
+    : d(new MoleculeFileReaderPrivate)
+{
+    d->position = 0;
+
+    setFileName(fileName);
+}
+
+/// Destroys the molecule file reader.
+MoleculeFileReader::~MoleculeFileReader()
+{
+    close();
+
+    delete d;
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Sets the file name for the reader to \p fileName.
+///
+/// If no format is set the suffix of \p fileName will be used to
+/// determine the file and compression formats.
+void MoleculeFileReader::setFileName(const std::string &fileName)
+{
+    d->file.setFileName(fileName);
+}
+
+/// Returns the file name for the reader.
+std::string MoleculeFileReader::fileName() const
+{
+    return d->file.fileName();
+}
+
+/// Sets the format for the reader to \p formatName. Returns \c false
+/// if \p formatName is not supported.
+bool MoleculeFileReader::setFormat(const std::string &formatName)
+{
+    bool ok = d->file.setFormat(formatName);
+    if(!ok){
+        setErrorString(d->file.errorString());
+    }
+
+    return ok;
+}
+
+/// Returns the format object for the reader.
+MoleculeFileFormat* MoleculeFileReader::format() const
+{
+    return d->file.format();
+}
+
+/// Returns the name of the format for the reader or an empty
+/// string if no format is set.
+std::string MoleculeFileReader::formatName() const
+{
+    return d->file.formatName();
+}
+
+/// Sets the compression format for the reader.
+bool MoleculeFileReader::setCompressionFormat(const std::string &name)
+{
+    return d->file.setCompressionFormat(name);
+}
+
+/// Returns the compression format for the reader.
+std::string MoleculeFileReader::compressionFormat() const
+{
+    return d->file.compressionFormat();
+}
+
+/// Returns the number of molecules that have been read since the
+/// reader was opened.
+size_t MoleculeFileReader::position() const
+{
+    return d->position;
+}
+
+// --- Input --------------------------------------------------------------- //
+/// Opens the file using the current file name. Returns \c false if
+/// no file name is set or if the file could not be opened.
+bool MoleculeFileReader::open()
+{
+    close();
+
+    if(d->file.fileName().empty()){
+        setErrorString("No file name set for reading.");
+        return false;
+    }
+
+    d->fileStream.reset(new std::ifstream(d->file.fileName().c_str()));
+    if(!d->fileStream->is_open()){
+        d->fileStream.reset();
+        setErrorString("Failed to open file for reading.");
+        return false;
+    }
+
+    return openStream(*d->fileStream);
+}
+
+/// Opens the file with \p fileName. Returns \c false if the file
+/// could not be opened.
+bool MoleculeFileReader::open(const std::string &fileName)
+{
+    setFileName(fileName);
+
+    return open();
+}
+
+/// Opens the reader on \p input. The stream must remain valid until
+/// the reader is closed.
+bool MoleculeFileReader::open(std::istream &input)
+{
+    close();
+
+    return openStream(input);
+}
+
+/// Closes the reader.
+void MoleculeFileReader::close()
+{
+    d->stream.reset();
+    d->fileStream.reset();
+}
+
+/// Returns \c true if the reader is open.
+bool MoleculeFileReader::isOpen() const
+{
+    return d->stream != 0;
+}
+
+/// Reads and returns the next molecule from the file. Returns a
+/// null pointer once all of the molecules have been read or if an
+/// error occurred. After an error errorString() describes the
+/// failure.
+boost::shared_ptr<Molecule> MoleculeFileReader::next()
+{
+    if(!d->stream){
+        return boost::shared_ptr<Molecule>();
+    }
+
+    MoleculeFileFormat *format = d->file.format();
+
+    boost::shared_ptr<Molecule> molecule = format->readNextMolecule(*d->stream);
+    if(!molecule){
+        if(!format->errorString().empty()){
+            setErrorString(format->errorString());
+        }
+
+        close();
+        return molecule;
+    }
+
+    d->position++;
+
+    return molecule;
+}
+
+// --- Error Handling ------------------------------------------------------ //
+/// Returns a string describing the last error that occurred.
+std::string MoleculeFileReader::errorString() const
+{
+    return d->errorString;
+}
+
+/// Sets a string describing the last error that occurred.
+void MoleculeFileReader::setErrorString(const std::string &errorString)
+{
+    d->errorString = errorString;
+}
+
+// --- Internal Methods ---------------------------------------------------- //
+bool MoleculeFileReader::openStream(std::istream &input)
+{
+    if(!d->file.format()){
+        setErrorString("No file format set for reading.");
+        d->fileStream.reset();
+        return false;
+    }
+
+    // reset any parsing state left in the format from a previous read
+    if(!d->file.setFormat(d->file.formatName())){
+        setErrorString(d->file.errorString());
+        d->fileStream.reset();
+        return false;
+    }
+
+    d->stream.reset(new boost::iostreams::filtering_istream);
+
+    // insert stream decompressor
+#ifndef CHEMKIT_OS_WIN32
+    if(d->file.compressionFormat() == "gz"){
+        d->stream->push(boost::iostreams::gzip_decompressor());
+    }
+    else if(d->file.compressionFormat() == "bz2"){
+        d->stream->push(boost::iostreams::bzip2_decompressor());
+    }
+#endif
+
+    d->stream->push(input);
+
+    d->position = 0;
+    d->errorString.clear();
+
+    return true;
+}
+
+} // end chemkit namespace
@@ -0,0 +1,92 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#ifndef CHEMKIT_MOLECULEFILEREADER_H
+#define CHEMKIT_MOLECULEFILEREADER_H
+
+#include "io.h"
+
+#include <string>
+#include <istream>
+
+#include <boost/shared_ptr.hpp>
+
+namespace chemkit {
+
+class Molecule;
+class MoleculeFileFormat;
+class MoleculeFileReaderPrivate;
+
+class CHEMKIT_IO_EXPORT MoleculeFileReader
+{
+public:
+    // construction and destruction
+    MoleculeFileReader();
+    MoleculeFileReader(const std::string &fileName);
+    ~MoleculeFileReader();
+
+    // properties
+    void setFileName(const std::string &fileName);
+    std::string fileName() const;
+    bool setFormat(const std::string &formatName);
+    MoleculeFileFormat* format() const;
+    std::string formatName() const;
+    bool setCompressionFormat(const std::string &name);
+    std::string compressionFormat() const;
+    size_t position() const;
+
+    // input
+    bool open();
+    bool open(const std::string &fileName);
+    bool open(std::istream &input);
+    void close();
+    bool isOpen() const;
+    boost::shared_ptr<Molecule> next();
+
+    // error handling
+    std::string errorString() const;
+
+private:
+    bool openStream(std::istream &input);
+    void setErrorString(const std::string &errorString);
+
+private:
+    MoleculeFileReaderPrivate* const d;
+};
+
+} // end chemkit namespace
+
+#endif // CHEMKIT_MOLECULEFILEREADER_H
@@ -0,0 +1,427 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "batchgeometryoptimizer.h"
+
+#include <map>
+#include <utility>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include <chemkit/molecule.h>
+#include <chemkit/threadpool.h>
+
+namespace chemkit {
+
+namespace {
+
+// Reads molecules from a vector of molecule pointers.
+class VectorSource
+{
+public:
+    VectorSource(const std::vector<Molecule *> *molecules)
+        : m_molecules(molecules),
+          m_index(0)
+    {
+    }
+
+    boost::shared_ptr<Molecule> operator()()
+    {
+        if(m_index == m_molecules->size()){
+            return boost::shared_ptr<Molecule>();
+        }
+
+        // the molecules are owned by the caller
+        return boost::shared_ptr<Molecule>((*m_molecules)[m_index++], NullDeleter());
+    }
+
+private:
+    struct NullDeleter
+    {
+        void operator()(Molecule *) const { }
+    };
+
+    const std::vector<Molecule *> *m_molecules;
+    size_t m_index;
+};
+
+// Stores the result for each molecule in a vector.
+class VectorSink
+{
+public:
+    VectorSink(std::vector<bool> *results)
+        : m_results(results)
+    {
+    }
+
+    void operator()(const boost::shared_ptr<Molecule> &molecule, bool converged)
+    {
+        CHEMKIT_UNUSED(molecule);
+
+        m_results->push_back(converged);
+    }
+
+private:
+    std::vector<bool> *m_results;
+};
+
+} // end anonymous namespace
+
+// === BatchGeometryOptimizerPrivate ======================================= //
+class BatchGeometryOptimizerPrivate
+{
+public:
+    std::string forceField;
+    MoleculeGeometryOptimizer::Algorithm algorithm;
+    Real gradientTolerance;
+    size_t maximumIterations;
+    size_t threadCount;
+    size_t queueSize;
+    size_t moleculeCount;
+    size_t convergedCount;
+    size_t evaluationCount;
+    boost::scoped_ptr<ThreadPool> pool;
+    std::vector<boost::shared_ptr<MoleculeGeometryOptimizer> > optimizers;
+    std::map<size_t, std::pair<boost::shared_ptr<Molecule>, bool> > results;
+    boost::mutex mutex;
+    boost::condition_variable resultReady;
+};
+
+// === BatchGeometryOptimizer ============================================== //
+/// \class BatchGeometryOptimizer batchgeometryoptimizer.h chemkit/batchgeometryoptimizer.h
+/// \ingroup chemkit-md
+/// \brief The BatchGeometryOptimizer class performs geometry
+///        optimization for a stream of molecules.
+///
+/// Molecules are requested one at a time from a source function and
+/// optimized on a pool of worker threads. Each worker keeps its own
+/// MoleculeGeometryOptimizer, and with it its own force field, for
+/// the whole run so the force field parameters are only loaded once
+/// per thread. The optimized molecules are passed to the sink
+/// function in the same order they were read from the source.
+///
+/// At most queueSize() molecules are held in memory at any time which
+/// allows arbitrarily large molecule files to be processed.
+///
+/// The following example minimizes every molecule in an SDF file and
+/// writes the results to another file:
+/// \code
+/// MoleculeFileReader reader("input.sdf");
+/// reader.open();
+///
+/// MoleculeFile output("output.sdf");
+///
+/// BatchGeometryOptimizer optimizer;
+/// optimizer.setForceField("mmff");
+/// optimizer.optimize(boost::bind(&MoleculeFileReader::next, &reader),
+///                    boost::bind(&MoleculeFile::addMolecule, &output, _1));
+///
+/// output.write();
+/// \endcode
+///
+/// \see MoleculeGeometryOptimizer
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new batch geometry optimizer.
+BatchGeometryOptimizer::BatchGeometryOptimizer()
+    : d(new BatchGeometryOptimizerPrivate)
+{
+    d->forceField = "uff";
+    d->algorithm = MoleculeGeometryOptimizer::SteepestDescent;
+    d->gradientTolerance = 0.1;
+    d->maximumIterations = 1000;
+    d->threadCount = ThreadPool::idealThreadCount();
+    d->queueSize = 0;
+    d->moleculeCount = 0;
+    d->convergedCount = 0;
+    d->evaluationCount = 0;
+}
+
+/// Destroys the batch geometry optimizer.
+BatchGeometryOptimizer::~BatchGeometryOptimizer()
+{
+    delete d;
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Sets the force field to use to \p forceField. The default is
+/// \c "uff".
+void BatchGeometryOptimizer::setForceField(const std::string &forceField)
+{
+    d->forceField = forceField;
+}
+
+/// Returns the name of the force field used for optimization.
+std::string BatchGeometryOptimizer::forceField() const
+{
+    return d->forceField;
+}
+
+/// Sets the minimization algorithm to \p algorithm. The default is
+/// MoleculeGeometryOptimizer::SteepestDescent.
+void BatchGeometryOptimizer::setAlgorithm(MoleculeGeometryOptimizer::Algorithm algorithm)
+{
+    d->algorithm = algorithm;
+}
+
+/// Returns the minimization algorithm.
+MoleculeGeometryOptimizer::Algorithm BatchGeometryOptimizer::algorithm() const
+{
+    return d->algorithm;
+}
+
+/// Sets the root-mean-square gradient below which a molecule is
+/// considered converged to \p tolerance. The default is \c 0.1.
+void BatchGeometryOptimizer::setGradientTolerance(Real tolerance)
+{
+    d->gradientTolerance = tolerance;
+}
+
+/// Returns the gradient tolerance.
+Real BatchGeometryOptimizer::gradientTolerance() const
+{
+    return d->gradientTolerance;
+}
+
+/// Sets the maximum number of steps performed for each molecule to
+/// \p count. The default is \c 1000.
+void BatchGeometryOptimizer::setMaximumIterations(size_t count)
+{
+    d->maximumIterations = count;
+}
+
+/// Returns the maximum number of steps performed for each molecule.
+size_t BatchGeometryOptimizer::maximumIterations() const
+{
+    return d->maximumIterations;
+}
+
+/// Sets the number of worker threads to \p count. If \p count is
+/// \c 0 the ideal thread count for the system is used. The default
+/// is ThreadPool::idealThreadCount().
+void BatchGeometryOptimizer::setThreadCount(size_t count)
+{
+    if(count == 0){
+        count = ThreadPool::idealThreadCount();
+    }
+
+    d->threadCount = count;
+}
+
+/// Returns the number of worker threads.
+size_t BatchGeometryOptimizer::threadCount() const
+{
+    return d->threadCount;
+}
+
+/// Sets the maximum number of molecules that are read from the
+/// source but not yet passed to the sink to \p size. If \p size is
+/// \c 0 four times the thread count is used. The default is \c 0.
+void BatchGeometryOptimizer::setQueueSize(size_t size)
+{
+    d->queueSize = size;
+}
+
+/// Returns the maximum number of molecules held at once.
+size_t BatchGeometryOptimizer::queueSize() const
+{
+    return d->queueSize;
+}
+
+// --- Optimization -------------------------------------------------------- //
+/// Optimizes each molecule returned by \p source until it returns a
+/// null molecule. Each optimized molecule is passed to \p sink along
+/// with \c true if its optimization converged. The sink is called from
+/// the calling thread in the same order the molecules were read.
+/// Molecules whose optimization throws an exception are passed to
+/// the sink as not converged.
+///
+/// Returns the number of molecules optimized.
+size_t BatchGeometryOptimizer::optimize(const Source &source, const Sink &sink)
+{
+    d->moleculeCount = 0;
+    d->convergedCount = 0;
+    d->evaluationCount = 0;
+    d->results.clear();
+
+    size_t queueSize = d->queueSize ? d->queueSize : 4 * d->threadCount;
+
+    // create one optimizer for each thread
+    d->optimizers.clear();
+    for(size_t i = 0; i < d->threadCount; i++){
+        d->optimizers.push_back(boost::shared_ptr<MoleculeGeometryOptimizer>(createOptimizer()));
+    }
+
+    if(d->threadCount > 1 && (!d->pool || d->pool->threadCount() != d->threadCount)){
+        d->pool.reset(new ThreadPool(d->threadCount));
+    }
+
+    size_t readCount = 0;
+    size_t writeCount = 0;
+    bool sourceDone = false;
+
+    for(;;){
+        // keep the queue full
+        while(!sourceDone && readCount - writeCount < queueSize){
+            boost::shared_ptr<Molecule> molecule = source();
+            if(!molecule){
+                sourceDone = true;
+                break;
+            }
+
+            if(d->threadCount > 1){
+                d->pool->start(boost::bind(&BatchGeometryOptimizer::optimizeMolecule, this, readCount, molecule));
+            }
+            else{
+                optimizeMolecule(readCount, molecule);
+            }
+
+            readCount++;
+        }
+
+        if(sourceDone && writeCount == readCount){
+            break;
+        }
+
+        // wait for the next molecule in input order
+        std::pair<boost::shared_ptr<Molecule>, bool> result;
+        {
+            boost::unique_lock<boost::mutex> lock(d->mutex);
+
+            std::map<size_t, std::pair<boost::shared_ptr<Molecule>, bool> >::iterator iter;
+            while((iter = d->results.find(writeCount)) == d->results.end()){
+                d->resultReady.wait(lock);
+            }
+
+            result = iter->second;
+            d->results.erase(iter);
+        }
+
+        if(sink){
+            sink(result.first, result.second);
+        }
+
+        writeCount++;
+    }
+
+    d->optimizers.clear();
+
+    return readCount;
+}
+
+/// Optimizes each molecule in \p molecules. Returns a vector
+/// containing \c true for each molecule whose optimization
+/// converged.
+std::vector<bool> BatchGeometryOptimizer::optimize(const std::vector<Molecule *> &molecules)
+{
+    std::vector<bool> results;
+    results.reserve(molecules.size());
+
+    optimize(VectorSource(&molecules), VectorSink(&results));
+
+    return results;
+}
+
+// --- Statistics ---------------------------------------------------------- //
+/// Returns the number of molecules optimized in the last call to
+/// optimize().
+size_t BatchGeometryOptimizer::moleculeCount() const
+{
+    return d->moleculeCount;
+}
+
+/// Returns the number of molecules whose optimization converged in
+/// the last call to optimize().
+size_t BatchGeometryOptimizer::convergedCount() const
+{
+    return d->convergedCount;
+}
+
+/// Returns the total number of energy and gradient evaluations
+/// performed in the last call to optimize().
+size_t BatchGeometryOptimizer::evaluationCount() const
+{
+    return d->evaluationCount;
+}
+
+// --- Internal Methods ---------------------------------------------------- //
+MoleculeGeometryOptimizer* BatchGeometryOptimizer::createOptimizer() const
+{
+    MoleculeGeometryOptimizer *optimizer = new MoleculeGeometryOptimizer;
+    optimizer->setForceField(d->forceField);
+    optimizer->setAlgorithm(d->algorithm);
+    optimizer->setGradientTolerance(d->gradientTolerance);
+    optimizer->setMaximumIterations(d->maximumIterations);
+
+    return optimizer;
+}
+
+// Optimizes the molecule at index in the input using the optimizer
+// belonging to the calling thread. A result is always stored for the
+// molecule, if the optimization throws it is stored as not converged
+// so that optimize() does not wait for it forever.
+void BatchGeometryOptimizer::optimizeMolecule(size_t index, const boost::shared_ptr<Molecule> &molecule)
+{
+    int thread = d->pool ? d->pool->currentThreadIndex() : -1;
+    MoleculeGeometryOptimizer *optimizer = d->optimizers[thread == -1 ? 0 : thread].get();
+
+    bool converged = false;
+    size_t evaluationCount = 0;
+
+    try {
+        optimizer->setMolecule(molecule.get());
+        converged = optimizer->optimize();
+        evaluationCount = optimizer->evaluationCount();
+    }
+    catch(...){
+        converged = false;
+    }
+
+    optimizer->setMolecule(0);
+
+    boost::lock_guard<boost::mutex> lock(d->mutex);
+    d->results[index] = std::make_pair(molecule, converged);
+    d->moleculeCount++;
+    d->evaluationCount += evaluationCount;
+    if(converged){
+        d->convergedCount++;
+    }
+    d->resultReady.notify_one();
+}
+
+} // end chemkit namespace
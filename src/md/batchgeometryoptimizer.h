@@ -0,0 +1,101 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#ifndef CHEMKIT_BATCHGEOMETRYOPTIMIZER_H
+#define CHEMKIT_BATCHGEOMETRYOPTIMIZER_H
+
+#include "md.h"
+
+#include <string>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "moleculegeometryoptimizer.h"
+
+namespace chemkit {
+
+class Molecule;
+class BatchGeometryOptimizerPrivate;
+
+class CHEMKIT_MD_EXPORT BatchGeometryOptimizer
+{
+public:
+    // typedefs
+    typedef boost::function<boost::shared_ptr<Molecule> ()> Source;
+    typedef boost::function<void (const boost::shared_ptr<Molecule> &, bool)> Sink;
+
+    // construction and destruction
+    BatchGeometryOptimizer();
+    ~BatchGeometryOptimizer();
+
+    // properties
+    void setForceField(const std::string &forceField);
+    std::string forceField() const;
+    void setAlgorithm(MoleculeGeometryOptimizer::Algorithm algorithm);
+    MoleculeGeometryOptimizer::Algorithm algorithm() const;
+    void setGradientTolerance(Real tolerance);
+    Real gradientTolerance() const;
+    void setMaximumIterations(size_t count);
+    size_t maximumIterations() const;
+    void setThreadCount(size_t count);
+    size_t threadCount() const;
+    void setQueueSize(size_t size);
+    size_t queueSize() const;
+
+    // optimization
+    size_t optimize(const Source &source, const Sink &sink);
+    std::vector<bool> optimize(const std::vector<Molecule *> &molecules);
+
+    // statistics
+    size_t moleculeCount() const;
+    size_t convergedCount() const;
+    size_t evaluationCount() const;
+
+private:
+    CHEMKIT_DISABLE_COPY(BatchGeometryOptimizer)
+
+    MoleculeGeometryOptimizer* createOptimizer() const;
+    void optimizeMolecule(size_t index, const boost::shared_ptr<Molecule> &molecule);
+
+private:
+    BatchGeometryOptimizerPrivate* const d;
+};
+
+} // end chemkit namespace
+
+#endif // CHEMKIT_BATCHGEOMETRYOPTIMIZER_H
@@ -0,0 +1,451 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "dynamicsintegrator.h"
+
+#include <cmath>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/normal_distribution.hpp>
+
+#include <chemkit/constants.h>
+#include <chemkit/cartesiancoordinates.h>
+
+#include "topology.h"
+#include "potential.h"
+#include "forcefield.h"
+#include "trajectory.h"
+#include "trajectoryframe.h"
+
+namespace chemkit {
+
+namespace {
+
+// converts a force in kcal/(mol*angstrom) divided by a mass in amu
+// to an acceleration in angstroms/fs^2
+const Real AccelerationConversion = 4.184e-4;
+
+// the boltzmann constant in kcal/(mol*K)
+const Real BoltzmannConstantKcal = constants::GasConstant / 4184.0;
+
+} // end anonymous namespace
+
+// === DynamicsIntegratorPrivate =========================================== //
+class DynamicsIntegratorPrivate
+{
+public:
+    Real timestep;
+    Real temperature;
+    unsigned int seed;
+    boost::random::mt19937 generator;
+    boost::random::normal_distribution<Real> normal;
+    std::vector<Real> masses;
+    std::vector<Vector3> velocities;
+    std::vector<Vector3> accelerations;
+    std::vector<Point3> accelerationPositions;
+    boost::shared_ptr<Trajectory> trajectory;
+    DynamicsIntegrator::FrameWriter frameWriter;
+    size_t frameInterval;
+    size_t stepCount;
+};
+
+// === DynamicsIntegrator ================================================== //
+/// \class DynamicsIntegrator dynamicsintegrator.h chemkit/dynamicsintegrator.h
+/// \ingroup chemkit-md
+/// \brief The DynamicsIntegrator class is the base class for
+///        molecular dynamics integrators.
+///
+/// Positions are in angstroms, velocities in angstroms/fs, masses in
+/// amu, the timestep in fs and the temperature in kelvin.
+///
+/// If no masses are set and the potential is a ForceField the masses
+/// are taken from its topology, otherwise every atom has a mass of
+/// one. If no velocities are set they are drawn from the
+/// Maxwell-Boltzmann distribution at temperature() before the first
+/// step.
+///
+/// Every frameInterval() steps the coordinates are added as a new
+/// frame to the trajectory and passed to the frame writer, if either
+/// is set. The frame writer can be used to write frames to disk as
+/// they are produced instead of keeping them in memory.
+///
+/// \see VelocityVerletIntegrator, LangevinIntegrator
+
+// --- Construction and Destruction ---------------------------------------- //
+DynamicsIntegrator::DynamicsIntegrator()
+    : d(new DynamicsIntegratorPrivate)
+{
+    d->timestep = 1.0;
+    d->temperature = 300.0;
+    d->seed = 0;
+    d->generator.seed(d->seed);
+    d->frameInterval = 1;
+    d->stepCount = 0;
+}
+
+/// Destroys the integrator.
+DynamicsIntegrator::~DynamicsIntegrator()
+{
+    delete d;
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Sets the timestep to \p timestep femtoseconds. The default is
+/// \c 1.0.
+void DynamicsIntegrator::setTimestep(Real timestep)
+{
+    d->timestep = timestep;
+}
+
+/// Returns the timestep in femtoseconds.
+Real DynamicsIntegrator::timestep() const
+{
+    return d->timestep;
+}
+
+/// Sets the target temperature to \p temperature kelvin. The default
+/// is \c 300.
+void DynamicsIntegrator::setTemperature(Real temperature)
+{
+    d->temperature = temperature;
+}
+
+/// Returns the target temperature in kelvin.
+Real DynamicsIntegrator::temperature() const
+{
+    return d->temperature;
+}
+
+/// Sets the seed for the random number generator to \p seed and
+/// restarts its sequence.
+void DynamicsIntegrator::setSeed(unsigned int seed)
+{
+    d->seed = seed;
+    d->generator.seed(seed);
+    d->normal.reset();
+}
+
+/// Returns the seed for the random number generator.
+unsigned int DynamicsIntegrator::seed() const
+{
+    return d->seed;
+}
+
+// --- Masses -------------------------------------------------------------- //
+/// Sets the mass of each atom to \p masses.
+void DynamicsIntegrator::setMasses(const std::vector<Real> &masses)
+{
+    d->masses = masses;
+    d->accelerations.clear();
+}
+
+/// Returns the mass of each atom.
+std::vector<Real> DynamicsIntegrator::masses() const
+{
+    return d->masses;
+}
+
+// --- Velocities ---------------------------------------------------------- //
+/// Sets the velocity of each atom to \p velocities.
+void DynamicsIntegrator::setVelocities(const std::vector<Vector3> &velocities)
+{
+    d->velocities = velocities;
+}
+
+/// Returns the velocity of each atom.
+std::vector<Vector3> DynamicsIntegrator::velocities() const
+{
+    return d->velocities;
+}
+
+/// Draws the velocities from the Maxwell-Boltzmann distribution at
+/// temperature(). The momentum of the center of mass is removed and
+/// the velocities are scaled to match the temperature exactly.
+void DynamicsIntegrator::initializeVelocities()
+{
+    if(!prepare()){
+        return;
+    }
+
+    size_t size = coordinates()->size();
+    d->velocities.resize(size);
+
+    Vector3 momentum(0, 0, 0);
+    Real totalMass = 0;
+
+    for(size_t i = 0; i < size; i++){
+        Real velocity = thermalVelocity(i);
+        d->velocities[i] = Vector3(velocity * randomNormal(),
+                                   velocity * randomNormal(),
+                                   velocity * randomNormal());
+
+        momentum += d->masses[i] * d->velocities[i];
+        totalMass += d->masses[i];
+    }
+
+    // remove center of mass motion
+    if(size > 1 && totalMass > 0){
+        Vector3 drift = momentum / totalMass;
+        for(size_t i = 0; i < size; i++){
+            d->velocities[i] -= drift;
+        }
+    }
+
+    Real temperature = kineticTemperature();
+    if(temperature > 0){
+        Real scale = std::sqrt(d->temperature / temperature);
+        for(size_t i = 0; i < size; i++){
+            d->velocities[i] *= scale;
+        }
+    }
+}
+
+/// Returns the kinetic energy of the system in kcal/mol.
+Real DynamicsIntegrator::kineticEnergy() const
+{
+    Real energy = 0;
+
+    for(size_t i = 0; i < d->velocities.size() && i < d->masses.size(); i++){
+        energy += d->masses[i] * d->velocities[i].squaredNorm();
+    }
+
+    return 0.5 * energy / AccelerationConversion;
+}
+
+/// Returns the temperature of the system calculated from its
+/// kinetic energy in kelvin.
+Real DynamicsIntegrator::kineticTemperature() const
+{
+    size_t size = d->velocities.size();
+    if(size == 0){
+        return 0;
+    }
+
+    // degrees of freedom without the center of mass motion
+    size_t degreesOfFreedom = size > 1 ? 3 * size - 3 : 3;
+
+    return 2 * kineticEnergy() / (degreesOfFreedom * BoltzmannConstantKcal);
+}
+
+// --- Trajectory ---------------------------------------------------------- //
+/// Sets the trajectory that frames are added to to \p trajectory.
+void DynamicsIntegrator::setTrajectory(const boost::shared_ptr<Trajectory> &trajectory)
+{
+    d->trajectory = trajectory;
+}
+
+/// Returns the trajectory that frames are added to.
+boost::shared_ptr<Trajectory> DynamicsIntegrator::trajectory() const
+{
+    return d->trajectory;
+}
+
+/// Sets the function called with the time and coordinates of each
+/// frame to \p writer.
+void DynamicsIntegrator::setFrameWriter(const FrameWriter &writer)
+{
+    d->frameWriter = writer;
+}
+
+/// Returns the function called for each frame.
+DynamicsIntegrator::FrameWriter DynamicsIntegrator::frameWriter() const
+{
+    return d->frameWriter;
+}
+
+/// Sets the number of steps between frames to \p interval. If
+/// \p interval is \c 0 no frames are produced. The default is \c 1.
+void DynamicsIntegrator::setFrameInterval(size_t interval)
+{
+    d->frameInterval = interval;
+}
+
+/// Returns the number of steps between frames.
+size_t DynamicsIntegrator::frameInterval() const
+{
+    return d->frameInterval;
+}
+
+// --- Integration --------------------------------------------------------- //
+/// Performs a single time step.
+void DynamicsIntegrator::integrate()
+{
+    if(!prepare()){
+        return;
+    }
+
+    if(d->velocities.size() != coordinates()->size()){
+        initializeVelocities();
+    }
+
+    // recalculate the accelerations if the coordinates were changed
+    if(d->accelerations.size() != coordinates()->size() ||
+       d->accelerationPositions.size() != coordinates()->size()){
+        updateAccelerations();
+    }
+    else{
+        for(size_t i = 0; i < d->accelerationPositions.size(); i++){
+            if(coordinates()->position(i) != d->accelerationPositions[i]){
+                updateAccelerations();
+                break;
+            }
+        }
+    }
+
+    step();
+
+    d->stepCount++;
+
+    if(d->frameInterval && d->stepCount % d->frameInterval == 0){
+        writeFrame();
+    }
+}
+
+/// Performs \p stepCount time steps.
+void DynamicsIntegrator::run(size_t stepCount)
+{
+    for(size_t i = 0; i < stepCount; i++){
+        integrate();
+    }
+}
+
+/// Returns the number of steps performed.
+size_t DynamicsIntegrator::stepCount() const
+{
+    return d->stepCount;
+}
+
+/// Returns the simulated time in femtoseconds.
+Real DynamicsIntegrator::time() const
+{
+    return d->stepCount * d->timestep;
+}
+
+// --- Internal Methods ---------------------------------------------------- //
+/// Returns the velocities which are updated by step().
+std::vector<Vector3>& DynamicsIntegrator::velocityBuffer()
+{
+    return d->velocities;
+}
+
+/// Returns the acceleration of each atom at the current coordinates
+/// in angstroms/fs^2.
+const std::vector<Vector3>& DynamicsIntegrator::accelerations() const
+{
+    return d->accelerations;
+}
+
+/// Calculates the accelerations at the current coordinates.
+void DynamicsIntegrator::updateAccelerations()
+{
+    const CartesianCoordinates *coordinates = this->coordinates();
+
+    d->accelerations = potential()->gradient(coordinates);
+    for(size_t i = 0; i < d->accelerations.size(); i++){
+        d->accelerations[i] *= -AccelerationConversion / d->masses[i];
+    }
+
+    d->accelerationPositions.resize(coordinates->size());
+    for(size_t i = 0; i < coordinates->size(); i++){
+        d->accelerationPositions[i] = coordinates->position(i);
+    }
+}
+
+/// Returns the standard deviation of each velocity component of the
+/// atom at \p index at temperature() in angstroms/fs.
+Real DynamicsIntegrator::thermalVelocity(size_t index) const
+{
+    return std::sqrt(BoltzmannConstantKcal * d->temperature * AccelerationConversion / d->masses[index]);
+}
+
+/// Returns a random number from the standard normal distribution.
+Real DynamicsIntegrator::randomNormal()
+{
+    return d->normal(d->generator);
+}
+
+// Checks the potential and coordinates and fills in missing masses.
+// Returns false if the integrator cannot be run.
+bool DynamicsIntegrator::prepare()
+{
+    boost::shared_ptr<Potential> potential = this->potential();
+    if(!potential || !coordinates()){
+        return false;
+    }
+
+    size_t size = coordinates()->size();
+    if(d->masses.size() == size){
+        return true;
+    }
+
+    d->masses.assign(size, 1.0);
+
+    ForceField *forceField = dynamic_cast<ForceField *>(potential.get());
+    if(forceField && forceField->topology() && forceField->topology()->size() == size){
+        boost::shared_ptr<Topology> topology = forceField->topology();
+
+        for(size_t i = 0; i < size; i++){
+            if(topology->mass(i) > 0){
+                d->masses[i] = topology->mass(i);
+            }
+        }
+    }
+
+    d->accelerations.clear();
+
+    return true;
+}
+
+void DynamicsIntegrator::writeFrame()
+{
+    if(d->trajectory){
+        if(d->trajectory->size() != coordinates()->size()){
+            d->trajectory->resize(coordinates()->size());
+        }
+
+        TrajectoryFrame *frame = d->trajectory->addFrame();
+        frame->setTime(time());
+        for(size_t i = 0; i < coordinates()->size(); i++){
+            frame->setPosition(i, coordinates()->position(i));
+        }
+    }
+
+    if(d->frameWriter){
+        d->frameWriter(time(), coordinates());
+    }
+}
+
+} // end chemkit namespace
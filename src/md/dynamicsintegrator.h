@@ -0,0 +1,118 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#ifndef CHEMKIT_DYNAMICSINTEGRATOR_H
+#define CHEMKIT_DYNAMICSINTEGRATOR_H
+
+#include "md.h"
+
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <chemkit/vector3.h>
+
+#include "integrator.h"
+
+namespace chemkit {
+
+class Trajectory;
+class CartesianCoordinates;
+class DynamicsIntegratorPrivate;
+
+class CHEMKIT_MD_EXPORT DynamicsIntegrator : public Integrator
+{
+public:
+    // typedefs
+    typedef boost::function<void (Real, const CartesianCoordinates *)> FrameWriter;
+
+    // construction and destruction
+    virtual ~DynamicsIntegrator();
+
+    // properties
+    void setTimestep(Real timestep);
+    Real timestep() const;
+    void setTemperature(Real temperature);
+    Real temperature() const;
+    void setSeed(unsigned int seed);
+    unsigned int seed() const;
+
+    // masses
+    void setMasses(const std::vector<Real> &masses);
+    std::vector<Real> masses() const;
+
+    // velocities
+    void setVelocities(const std::vector<Vector3> &velocities);
+    std::vector<Vector3> velocities() const;
+    void initializeVelocities();
+    Real kineticEnergy() const;
+    Real kineticTemperature() const;
+
+    // trajectory
+    void setTrajectory(const boost::shared_ptr<Trajectory> &trajectory);
+    boost::shared_ptr<Trajectory> trajectory() const;
+    void setFrameWriter(const FrameWriter &writer);
+    FrameWriter frameWriter() const;
+    void setFrameInterval(size_t interval);
+    size_t frameInterval() const;
+
+    // integration
+    virtual void integrate() CHEMKIT_OVERRIDE;
+    void run(size_t stepCount);
+    size_t stepCount() const;
+    Real time() const;
+
+protected:
+    DynamicsIntegrator();
+    virtual void step() = 0;
+    std::vector<Vector3>& velocityBuffer();
+    const std::vector<Vector3>& accelerations() const;
+    void updateAccelerations();
+    Real thermalVelocity(size_t index) const;
+    Real randomNormal();
+
+private:
+    bool prepare();
+    void writeFrame();
+
+private:
+    DynamicsIntegratorPrivate* const d;
+};
+
+} // end chemkit namespace
+
+#endif // CHEMKIT_DYNAMICSINTEGRATOR_H
@@ -35,18 +35,44 @@
 
 #include "forcefield.h"
 
+#include <limits>
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
 #include <chemkit/foreach.h>
+#include <chemkit/celllist.h>
 #include <chemkit/constants.h>
 #include <chemkit/concurrent.h>
+#include <chemkit/threadpool.h>
+#include <chemkit/molecule.h>
 #include <chemkit/pluginmanager.h>
+#include <chemkit/coordinateset.h>
+#include <chemkit/diagramcoordinates.h>
+#include <chemkit/internalcoordinates.h>
 #include <chemkit/cartesiancoordinates.h>
 
 #include "topology.h"
 #include "topologybuilder.h"
+#include "forcefieldkernel.h"
 #include "forcefieldcalculation.h"
 
 namespace chemkit {
 
+// === ForceFieldBatch ===================================================== //
+// Packed atoms and parameters for all of the calculations which share
+// a kernel.
+class ForceFieldBatch
+{
+public:
+    const ForceFieldKernel *kernel;
+    size_t size;
+    std::vector<size_t> atoms;
+    std::vector<Real> parameters;
+};
+
 // === ForceFieldPrivate =================================================== //
 class ForceFieldPrivate
 {
@@ -55,6 +81,23 @@ public:
     int flags;
     boost::shared_ptr<Topology> topology;
     std::vector<ForceFieldCalculation *> calculations;
+    std::vector<ForceFieldBatch> batches;
+    std::vector<const ForceFieldCalculation *> unbatchedCalculations;
+    bool batchesValid;
+    boost::mutex batchesMutex;
+    Real nonbondedCutoff;
+    Real switchingDistance;
+    Real neighborListSkin;
+    std::vector<ForceFieldKernel *> nonbondedKernels;
+    std::vector<ForceFieldBatch> nonbondedBatches;
+    std::vector<std::vector<size_t> > exclusions;
+    std::vector<std::vector<size_t> > oneFours;
+    std::vector<Point3> referencePositions;
+    bool neighborListValid;
+    boost::mutex neighborListMutex;
+    size_t threadCount;
+    boost::scoped_ptr<ThreadPool> pool;
+    boost::mutex poolMutex;
     std::string parameterSet;
     std::string parameterFile;
     std::map<std::string, std::string> parameterSets;
@@ -93,6 +136,12 @@ ForceField::ForceField(const std::string &name)
 {
     d->name = name;
     d->flags = 0;
+    d->batchesValid = false;
+    d->nonbondedCutoff = 0;
+    d->switchingDistance = -1;
+    d->neighborListSkin = 2.0;
+    d->neighborListValid = false;
+    d->threadCount = 1;
 }
 
 /// Destroys a force field.
@@ -103,6 +152,11 @@ ForceField::~ForceField()
         delete calculation;
     }
 
+    // delete all nonbonded kernels
+    foreach(ForceFieldKernel *kernel, d->nonbondedKernels){
+        delete kernel;
+    }
+
     delete d;
 }
 
@@ -135,27 +189,63 @@ size_t ForceField::size() const
     return d->topology->size();
 }
 
+/// Sets the number of threads used to evaluate the energy and
+/// gradient to \p count. If \p count is \c 0 the ideal thread count
+/// for the system is used. The default is \c 1.
+///
+/// The terms are split into contiguous slices which are evaluated
+/// in parallel and summed in a fixed order, so the results are
+/// reproducible for a given thread count. Small systems are always
+/// evaluated on the calling thread.
+void ForceField::setThreadCount(size_t count)
+{
+    if(count == 0){
+        count = ThreadPool::idealThreadCount();
+    }
+
+    boost::mutex::scoped_lock lock(d->poolMutex);
+
+    if(count == d->threadCount){
+        return;
+    }
+
+    d->threadCount = count;
+    d->pool.reset();
+}
+
+/// Returns the number of threads used to evaluate the energy and
+/// gradient.
+size_t ForceField::threadCount() const
+{
+    return d->threadCount;
+}
+
 // --- Setup --------------------------------------------------------------- //
 /// Sets the topology for the force field to \p topology.
 void ForceField::setTopology(const boost::shared_ptr<Topology> &topology)
 {
     d->topology = topology;
 
-    // remove old calculations
-    foreach(ForceFieldCalculation *calculation, d->calculations){
-        delete calculation;
-    }
-    d->calculations.clear();
+    // remove old calculations and nonbonded kernels
+    clearCalculations();
+    clearNonbondedKernels();
+    d->exclusions.clear();
+    d->oneFours.clear();
+    d->neighborListValid = false;
 }
 
 /// Builds a topology for the molecule and sets it with setTopology().
 ///
+/// If a nonbonded cutoff is set the nonbonded pairs are not added to
+/// the topology and are instead found with a neighbor list.
+///
 /// \see TopologyBuilder
 void ForceField::setTopologyFromMolecule(const Molecule *molecule)
 {
     TopologyBuilder builder;
     builder.setAtomTyper(name());
     builder.setPartialChargeModel(name());
+    builder.setNonbondedInteractionsEnabled(d->nonbondedCutoff <= 0);
     builder.addMolecule(molecule);
     setTopology(builder.topology());
 }
@@ -233,20 +323,142 @@ std::string ForceField::parameterFile() const
     return d->parameterFile;
 }
 
+// --- Nonbonded Interactions --------------------------------------------- //
+/// Sets the nonbonded cutoff distance to \p cutoff. A cutoff of
+/// \c 0 (the default) evaluates every nonbonded pair.
+///
+/// With a cutoff, force fields which support it evaluate their van
+/// der Waals and electrostatic terms using a Verlet neighbor list
+/// built with a cell list. Pairs separated by one or two bonds are
+/// excluded and pairs separated by three bonds are scaled by the
+/// force field. Between switchingDistance() and the cutoff the pair
+/// energies are smoothly switched off.
+///
+/// The cutoff must be set before the topology is set and the force
+/// field is setup. After that it may be changed to any other non-zero
+/// value.
+void ForceField::setNonbondedCutoff(Real cutoff)
+{
+    d->nonbondedCutoff = cutoff;
+    d->neighborListValid = false;
+}
+
+/// Returns the nonbonded cutoff distance.
+Real ForceField::nonbondedCutoff() const
+{
+    return d->nonbondedCutoff;
+}
+
+/// Sets the distance at which the switching function starts to
+/// \p distance. By default the switching distance is 90% of the
+/// nonbonded cutoff.
+void ForceField::setSwitchingDistance(Real distance)
+{
+    d->switchingDistance = distance;
+}
+
+/// Returns the distance at which the switching function starts.
+Real ForceField::switchingDistance() const
+{
+    if(d->switchingDistance < 0){
+        return 0.9 * d->nonbondedCutoff;
+    }
+
+    return std::min(d->switchingDistance, d->nonbondedCutoff);
+}
+
+/// Sets the neighbor list skin to \p skin. The default is 2.0 \AA.
+///
+/// The neighbor list contains every pair within the cutoff plus the
+/// skin and is only rebuilt once an atom has moved further than half
+/// the skin. A larger skin means fewer rebuilds but more pairs.
+void ForceField::setNeighborListSkin(Real skin)
+{
+    d->neighborListSkin = skin;
+    d->neighborListValid = false;
+}
+
+/// Returns the neighbor list skin.
+Real ForceField::neighborListSkin() const
+{
+    return d->neighborListSkin;
+}
+
+/// Adds \p kernel to the force field's nonbonded kernels. Each
+/// kernel is evaluated for every pair in the neighbor list with the
+/// parameters from nonbondedParameters(). The force field takes
+/// ownership of the kernel.
+///
+/// Nonbonded kernels are only evaluated when a nonbonded cutoff is
+/// set and are removed by setTopology().
+void ForceField::addNonbondedKernel(ForceFieldKernel *kernel)
+{
+    d->nonbondedKernels.push_back(kernel);
+    d->neighborListValid = false;
+}
+
+/// Removes and deletes all of the nonbonded kernels. Force fields
+/// call this before adding their kernels in setup() so that setting
+/// up the force field again does not evaluate each pair twice.
+void ForceField::clearNonbondedKernels()
+{
+    foreach(ForceFieldKernel *kernel, d->nonbondedKernels){
+        delete kernel;
+    }
+    d->nonbondedKernels.clear();
+    d->nonbondedBatches.clear();
+    d->neighborListValid = false;
+}
+
+/// Writes the parameters of \p kernel for the pair of atoms \p a
+/// and \p b to \p parameters. \p oneFour is \c true if the atoms
+/// are separated by three bonds. Returns \c false if the pair should
+/// not be evaluated with the kernel.
+///
+/// The default implementation returns \c false.
+bool ForceField::nonbondedParameters(const ForceFieldKernel *kernel,
+                                     size_t a,
+                                     size_t b,
+                                     bool oneFour,
+                                     Real *parameters) const
+{
+    CHEMKIT_UNUSED(kernel);
+    CHEMKIT_UNUSED(a);
+    CHEMKIT_UNUSED(b);
+    CHEMKIT_UNUSED(oneFour);
+    CHEMKIT_UNUSED(parameters);
+
+    return false;
+}
+
 // --- Calculations -------------------------------------------------------- //
 void ForceField::addCalculation(ForceFieldCalculation *calculation)
 {
     calculation->setForceField(this);
 
     d->calculations.push_back(calculation);
+    d->batchesValid = false;
 }
 
 void ForceField::removeCalculation(ForceFieldCalculation *calculation)
 {
     d->calculations.erase(std::remove(d->calculations.begin(), d->calculations.end(), calculation));
+    d->batchesValid = false;
     delete calculation;
 }
 
+/// Removes and deletes all of the calculations. Force fields call
+/// this at the start of setup() so that setting up the force field
+/// again does not add each calculation twice.
+void ForceField::clearCalculations()
+{
+    foreach(ForceFieldCalculation *calculation, d->calculations){
+        delete calculation;
+    }
+    d->calculations.clear();
+    d->batchesValid = false;
+}
+
 /// Returns a list of all the calculations in the force field.
 std::vector<ForceFieldCalculation *> ForceField::calculations() const
 {
@@ -267,9 +479,30 @@ void ForceField::setCalculationSetup(ForceFieldCalculation *calculation, bool se
 /// \copydoc Potential::energy()
 Real ForceField::energy(const CartesianCoordinates *coordinates) const
 {
+    updateBatches();
+
+    std::vector<Point3> positions(coordinates->size());
+    for(size_t i = 0; i < positions.size(); i++){
+        positions[i] = coordinates->position(i);
+    }
+
+    boost::unique_lock<boost::mutex> neighborListLock(d->neighborListMutex, boost::defer_lock);
+    if(d->nonbondedCutoff > 0 && !d->nonbondedKernels.empty()){
+        neighborListLock.lock();
+        updateNeighborList(positions);
+    }
+
+    size_t taskCount = this->taskCount();
+    std::vector<Real> taskEnergies(taskCount, 0);
+    runTasks(positions.empty() ? 0 : &positions[0], taskCount, &taskEnergies[0], 0);
+
+    // sum the energy of each task in order
     Real energy = 0;
+    foreach(Real taskEnergy, taskEnergies){
+        energy += taskEnergy;
+    }
 
-    foreach(const ForceFieldCalculation *calculation, d->calculations){
+    foreach(const ForceFieldCalculation *calculation, d->unbatchedCalculations){
         energy += calculation->energy(coordinates);
     }
 
@@ -280,10 +513,42 @@ Real ForceField::energy(const CartesianCoordinates *coordinates) const
 std::vector<Vector3> ForceField::gradient(const CartesianCoordinates *coordinates) const
 {
     if(d->flags & AnalyticalGradient){
+        updateBatches();
+
+        std::vector<Point3> positions(coordinates->size());
+        for(size_t i = 0; i < positions.size(); i++){
+            positions[i] = coordinates->position(i);
+        }
+
+        boost::unique_lock<boost::mutex> neighborListLock(d->neighborListMutex, boost::defer_lock);
+        if(d->nonbondedCutoff > 0 && !d->nonbondedKernels.empty()){
+            neighborListLock.lock();
+            updateNeighborList(positions);
+        }
+
         std::vector<Vector3> gradient(size());
         std::fill(gradient.begin(), gradient.end(), Vector3(0, 0, 0));
 
-        foreach(const ForceFieldCalculation *calculation, d->calculations){
+        // the first task accumulates directly into the gradient and
+        // every other task into its own buffer
+        size_t taskCount = this->taskCount();
+        std::vector<std::vector<Vector3> > taskGradients(taskCount - 1, gradient);
+        std::vector<Vector3 *> taskGradientData(taskCount);
+        taskGradientData[0] = gradient.empty() ? 0 : &gradient[0];
+        for(size_t task = 1; task < taskCount; task++){
+            taskGradientData[task] = &taskGradients[task - 1][0];
+        }
+
+        runTasks(positions.empty() ? 0 : &positions[0], taskCount, 0, &taskGradientData[0]);
+
+        // reduce the task gradients in order
+        foreach(const std::vector<Vector3> &taskGradient, taskGradients){
+            for(size_t i = 0; i < gradient.size(); i++){
+                gradient[i] += taskGradient[i];
+            }
+        }
+
+        foreach(const ForceFieldCalculation *calculation, d->unbatchedCalculations){
             std::vector<Vector3> atomGradients = calculation->gradient(coordinates);
 
             for(size_t i = 0; i < atomGradients.size(); i++){
@@ -298,6 +563,115 @@ std::vector<Vector3> ForceField::gradient(const CartesianCoordinates *coordinate
     }
 }
 
+/// Returns the energy of each set of \p coordinates. The force field
+/// only needs to be setup once for the topology and is then evaluated
+/// for every set of coordinates, which is useful for scoring a large
+/// number of conformers.
+///
+/// The coordinates are distributed over threadCount() threads with
+/// each set evaluated on a single thread, so the energies are equal
+/// to those from energy() with a thread count of one. If a nonbonded
+/// cutoff is set the neighbor list is shared and the coordinates are
+/// evaluated one after another instead.
+///
+/// \see energy()
+std::vector<Real> ForceField::energies(const std::vector<const CartesianCoordinates *> &coordinates) const
+{
+    std::vector<Real> energies(coordinates.size(), 0);
+
+    updateBatches();
+
+    if(d->nonbondedCutoff > 0 && !d->nonbondedKernels.empty()){
+        for(size_t i = 0; i < coordinates.size(); i++){
+            energies[i] = energy(coordinates[i]);
+        }
+
+        return energies;
+    }
+
+    if(d->threadCount < 2 || coordinates.size() < 2){
+        for(size_t i = 0; i < coordinates.size(); i++){
+            evaluateEnergy(coordinates[i], &energies[i]);
+        }
+
+        return energies;
+    }
+
+    boost::mutex::scoped_lock lock(d->poolMutex);
+
+    if(!d->pool){
+        d->pool.reset(new ThreadPool(d->threadCount));
+    }
+
+    for(size_t i = 0; i < coordinates.size(); i++){
+        d->pool->start(boost::bind(&ForceField::evaluateEnergy, this, coordinates[i], &energies[i]));
+    }
+
+    d->pool->waitForDone();
+
+    return energies;
+}
+
+/// Returns the energy of each coordinate set in \p molecule. Internal
+/// and diagram coordinates are converted to cartesian coordinates
+/// before they are evaluated. The energy is NaN for empty coordinate
+/// sets.
+///
+/// The force field must already be setup with the topology of
+/// \p molecule.
+///
+/// \see energies()
+std::vector<Real> ForceField::coordinateSetEnergies(const Molecule *molecule) const
+{
+    std::vector<const CartesianCoordinates *> coordinates;
+    std::vector<CartesianCoordinates *> convertedCoordinates;
+
+    foreach(const boost::shared_ptr<CoordinateSet> &coordinateSet, molecule->coordinateSets()){
+        CartesianCoordinates *cartesianCoordinates = 0;
+
+        switch(coordinateSet->type()){
+            case CoordinateSet::Cartesian:
+                cartesianCoordinates = coordinateSet->cartesianCoordinates();
+                break;
+            case CoordinateSet::Internal:
+                cartesianCoordinates = coordinateSet->internalCoordinates()->toCartesianCoordinates();
+                convertedCoordinates.push_back(cartesianCoordinates);
+                break;
+            case CoordinateSet::Diagram:
+                cartesianCoordinates = coordinateSet->diagramCoordinates()->toCartesianCoordinates();
+                convertedCoordinates.push_back(cartesianCoordinates);
+                break;
+            default:
+                break;
+        }
+
+        coordinates.push_back(cartesianCoordinates);
+    }
+
+    // evaluate the non-empty coordinate sets
+    std::vector<const CartesianCoordinates *> validCoordinates;
+    foreach(const CartesianCoordinates *cartesianCoordinates, coordinates){
+        if(cartesianCoordinates){
+            validCoordinates.push_back(cartesianCoordinates);
+        }
+    }
+
+    std::vector<Real> validEnergies = energies(validCoordinates);
+
+    std::vector<Real> energies(coordinates.size(), std::numeric_limits<Real>::quiet_NaN());
+    for(size_t i = 0, j = 0; i < coordinates.size(); i++){
+        if(coordinates[i]){
+            energies[i] = validEnergies[j++];
+        }
+    }
+
+    foreach(CartesianCoordinates *cartesianCoordinates, convertedCoordinates){
+        delete cartesianCoordinates;
+    }
+
+    return energies;
+}
+
 // --- Error Handling ------------------------------------------------------ //
 /// Sets a string that describes the last error that occurred.
 void ForceField::setErrorString(const std::string &errorString)
@@ -311,6 +685,279 @@ std::string ForceField::errorString() const
     return d->errorString;
 }
 
+// --- Internal Methods ---------------------------------------------------- //
+void ForceField::calculationChanged()
+{
+    d->batchesValid = false;
+}
+
+// Packs the atoms and parameters of each calculation into a batch for
+// its kernel. Calculations without a kernel are evaluated individually.
+void ForceField::updateBatches() const
+{
+    boost::mutex::scoped_lock lock(d->batchesMutex);
+
+    if(d->batchesValid){
+        return;
+    }
+
+    d->batches.clear();
+    d->unbatchedCalculations.clear();
+
+    std::map<const ForceFieldKernel *, size_t> batchIndices;
+
+    foreach(const ForceFieldCalculation *calculation, d->calculations){
+        const ForceFieldKernel *kernel = calculation->kernel();
+        if(!kernel){
+            d->unbatchedCalculations.push_back(calculation);
+            continue;
+        }
+
+        std::map<const ForceFieldKernel *, size_t>::iterator iter = batchIndices.find(kernel);
+        if(iter == batchIndices.end()){
+            iter = batchIndices.insert(std::make_pair(kernel, d->batches.size())).first;
+
+            ForceFieldBatch batch;
+            batch.kernel = kernel;
+            batch.size = 0;
+            d->batches.push_back(batch);
+        }
+
+        ForceFieldBatch &batch = d->batches[iter->second];
+        const size_t *atoms = calculation->atomData();
+        batch.atoms.insert(batch.atoms.end(), atoms, atoms + kernel->atomCount());
+        const Real *parameters = calculation->parameterData();
+        batch.parameters.insert(batch.parameters.end(), parameters, parameters + kernel->parameterCount());
+        batch.size++;
+    }
+
+    d->batchesValid = true;
+}
+
+// Returns the number of tasks to split the batches into. Each task
+// evaluates at least a thousand terms so that small systems are
+// evaluated on the calling thread.
+size_t ForceField::taskCount() const
+{
+    if(d->threadCount < 2){
+        return 1;
+    }
+
+    size_t termCount = 0;
+    foreach(const ForceFieldBatch &batch, d->batches){
+        termCount += batch.size;
+    }
+    if(d->nonbondedCutoff > 0){
+        foreach(const ForceFieldBatch &batch, d->nonbondedBatches){
+            termCount += batch.size;
+        }
+    }
+
+    return std::max<size_t>(1, std::min(d->threadCount, termCount / 1024));
+}
+
+// Evaluates each task on the thread pool and waits for them to
+// finish. Either the energy of each task is written to energies or
+// the gradient of each task is added to its gradient buffer.
+void ForceField::runTasks(const Point3 *positions, size_t taskCount, Real *energies, Vector3 **gradients) const
+{
+    if(taskCount == 1){
+        evaluateTask(positions, 0, 1, energies, gradients ? gradients[0] : 0);
+        return;
+    }
+
+    boost::mutex::scoped_lock lock(d->poolMutex);
+
+    if(!d->pool){
+        d->pool.reset(new ThreadPool(d->threadCount));
+    }
+
+    for(size_t task = 0; task < taskCount; task++){
+        d->pool->start(boost::bind(&ForceField::evaluateTask,
+                                   this,
+                                   positions,
+                                   task,
+                                   taskCount,
+                                   energies ? &energies[task] : static_cast<Real *>(0),
+                                   gradients ? gradients[task] : static_cast<Vector3 *>(0)));
+    }
+
+    d->pool->waitForDone();
+}
+
+// Evaluates the energy of coordinates on the calling thread and
+// writes it to energy. The batches must be up to date and no
+// nonbonded cutoff may be in use.
+void ForceField::evaluateEnergy(const CartesianCoordinates *coordinates, Real *energy) const
+{
+    std::vector<Point3> positions(coordinates->size());
+    for(size_t i = 0; i < positions.size(); i++){
+        positions[i] = coordinates->position(i);
+    }
+
+    *energy = 0;
+    evaluateTask(positions.empty() ? 0 : &positions[0], 0, 1, energy, 0);
+
+    foreach(const ForceFieldCalculation *calculation, d->unbatchedCalculations){
+        *energy += calculation->energy(coordinates);
+    }
+}
+
+// Evaluates the task-th of taskCount contiguous slices of every batch.
+// If gradient is not null the gradient is accumulated into it,
+// otherwise the energy is added to energy.
+void ForceField::evaluateTask(const Point3 *positions, size_t task, size_t taskCount, Real *energy, Vector3 *gradient) const
+{
+    foreach(const ForceFieldBatch &batch, d->batches){
+        size_t begin = batch.size * task / taskCount;
+        size_t end = batch.size * (task + 1) / taskCount;
+        if(begin == end){
+            continue;
+        }
+
+        const size_t *atoms = &batch.atoms[begin * batch.kernel->atomCount()];
+        const Real *parameters = &batch.parameters[begin * batch.kernel->parameterCount()];
+
+        if(gradient){
+            batch.kernel->gradient(positions, atoms, parameters, end - begin, gradient);
+        }
+        else{
+            *energy += batch.kernel->energy(positions, atoms, parameters, end - begin);
+        }
+    }
+
+    if(d->nonbondedCutoff > 0 && !d->nonbondedKernels.empty()){
+        Real switchingDistance = this->switchingDistance();
+
+        foreach(const ForceFieldBatch &batch, d->nonbondedBatches){
+            size_t begin = batch.size * task / taskCount;
+            size_t end = batch.size * (task + 1) / taskCount;
+            if(begin == end){
+                continue;
+            }
+
+            const size_t *atoms = &batch.atoms[begin * batch.kernel->atomCount()];
+            const Real *parameters = &batch.parameters[begin * batch.kernel->parameterCount()];
+
+            if(gradient){
+                batch.kernel->gradient(positions, atoms, parameters, end - begin, switchingDistance, d->nonbondedCutoff, gradient);
+            }
+            else{
+                *energy += batch.kernel->energy(positions, atoms, parameters, end - begin, switchingDistance, d->nonbondedCutoff);
+            }
+        }
+    }
+}
+
+// Builds the sorted per-atom lists of excluded (1-2 and 1-3) and
+// scaled (1-4) pairs from the topology. Only partners with a larger
+// index are stored.
+void ForceField::updateExclusions() const
+{
+    const Topology *topology = d->topology.get();
+
+    d->exclusions.assign(topology->size(), std::vector<size_t>());
+    d->oneFours.assign(topology->size(), std::vector<size_t>());
+
+    foreach(const Topology::BondedInteraction &interaction, topology->bondedInteractions()){
+        size_t a = std::min(interaction[0], interaction[1]);
+        size_t b = std::max(interaction[0], interaction[1]);
+        d->exclusions[a].push_back(b);
+    }
+    foreach(const Topology::AngleInteraction &interaction, topology->angleInteractions()){
+        size_t a = std::min(interaction[0], interaction[2]);
+        size_t b = std::max(interaction[0], interaction[2]);
+        d->exclusions[a].push_back(b);
+    }
+    foreach(const Topology::TorsionInteraction &interaction, topology->torsionInteractions()){
+        size_t a = std::min(interaction[0], interaction[3]);
+        size_t b = std::max(interaction[0], interaction[3]);
+        d->oneFours[a].push_back(b);
+    }
+
+    for(size_t i = 0; i < topology->size(); i++){
+        std::sort(d->exclusions[i].begin(), d->exclusions[i].end());
+        d->exclusions[i].erase(std::unique(d->exclusions[i].begin(), d->exclusions[i].end()), d->exclusions[i].end());
+        std::sort(d->oneFours[i].begin(), d->oneFours[i].end());
+        d->oneFours[i].erase(std::unique(d->oneFours[i].begin(), d->oneFours[i].end()), d->oneFours[i].end());
+    }
+}
+
+// Rebuilds the nonbonded batches from a cell list if the neighbor
+// list is invalid or any atom has moved more than half the skin
+// since the last build. The neighbor list mutex must be held.
+void ForceField::updateNeighborList(const std::vector<Point3> &positions) const
+{
+    const size_t size = positions.size();
+
+    if(d->neighborListValid && d->referencePositions.size() == size){
+        const Real maximumDisplacement = 0.5 * d->neighborListSkin;
+        const Real maximumDisplacementSquared = maximumDisplacement * maximumDisplacement;
+
+        bool moved = false;
+        for(size_t i = 0; i < size; i++){
+            if((positions[i] - d->referencePositions[i]).squaredNorm() > maximumDisplacementSquared){
+                moved = true;
+                break;
+            }
+        }
+
+        if(!moved){
+            return;
+        }
+    }
+
+    if(d->exclusions.size() != size){
+        updateExclusions();
+    }
+
+    d->referencePositions = positions;
+    d->nonbondedBatches.assign(d->nonbondedKernels.size(), ForceFieldBatch());
+    for(size_t k = 0; k < d->nonbondedKernels.size(); k++){
+        d->nonbondedBatches[k].kernel = d->nonbondedKernels[k];
+        d->nonbondedBatches[k].size = 0;
+    }
+    d->neighborListValid = true;
+
+    if(size < 2){
+        return;
+    }
+
+    // pairs within the list cutoff. the pairs are visited in index
+    // order so that the terms are summed in the same order as when
+    // every pair is evaluated.
+    const Real listCutoff = d->nonbondedCutoff + d->neighborListSkin;
+    CellList cellList(positions, listCutoff);
+
+    std::vector<Real> parameters;
+
+    foreach(const CellList::Pair &pair, cellList.pairs(listCutoff)){
+        size_t i = pair.first;
+        size_t j = pair.second;
+
+        const std::vector<size_t> &exclusions = d->exclusions[i];
+        const std::vector<size_t> &oneFours = d->oneFours[i];
+
+        if(std::binary_search(exclusions.begin(), exclusions.end(), j)){
+            continue;
+        }
+
+        bool oneFour = std::binary_search(oneFours.begin(), oneFours.end(), j);
+
+        foreach(ForceFieldBatch &batch, d->nonbondedBatches){
+            size_t parameterCount = batch.kernel->parameterCount();
+            parameters.assign(parameterCount, 0);
+
+            if(nonbondedParameters(batch.kernel, i, j, oneFour, parameterCount ? &parameters[0] : 0)){
+                batch.atoms.push_back(i);
+                batch.atoms.push_back(j);
+                batch.parameters.insert(batch.parameters.end(), parameters.begin(), parameters.end());
+                batch.size++;
+            }
+        }
+    }
+}
+
 // --- Static Methods ------------------------------------------------------ //
 /// Create a new force field from \p name. If \p name is invalid or
 /// a force field with \p name is not available \c 0 is returned.
@@ -54,6 +54,7 @@ namespace chemkit {
 
 class Molecule;
 class Topology;
+class ForceFieldKernel;
 class ForceFieldPrivate;
 class CartesianCoordinates;
 
@@ -72,6 +73,8 @@ public:
     std::string name() const;
     int flags() const;
     size_t size() const CHEMKIT_OVERRIDE;
+    void setThreadCount(size_t count);
+    size_t threadCount() const;
 
     // setup
     void setTopology(const boost::shared_ptr<Topology> &topology);
@@ -87,11 +90,21 @@ public:
     void setParameterFile(const std::string &fileName);
     std::string parameterFile() const;
 
+    // nonbonded interactions
+    void setNonbondedCutoff(Real cutoff);
+    Real nonbondedCutoff() const;
+    void setSwitchingDistance(Real distance);
+    Real switchingDistance() const;
+    void setNeighborListSkin(Real skin);
+    Real neighborListSkin() const;
+
     // calculations
     std::vector<ForceFieldCalculation *> calculations() const;
     size_t calculationCount() const;
     Real energy(const CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
     std::vector<Vector3> gradient(const CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    std::vector<Real> energies(const std::vector<const CartesianCoordinates *> &coordinates) const;
+    std::vector<Real> coordinateSetEnergies(const Molecule *molecule) const;
 
     // error handling
     std::string errorString() const;
@@ -105,11 +118,27 @@ protected:
     void setFlags(int flags);
     void addCalculation(ForceFieldCalculation *calculation);
     void removeCalculation(ForceFieldCalculation *calculation);
+    void clearCalculations();
     void setCalculationSetup(ForceFieldCalculation *calculation, bool setup);
+    void addNonbondedKernel(ForceFieldKernel *kernel);
+    void clearNonbondedKernels();
+    virtual bool nonbondedParameters(const ForceFieldKernel *kernel, size_t a, size_t b, bool oneFour, Real *parameters) const;
     void addParameterSet(const std::string &name, const std::string &fileName);
     void removeParameterSet(const std::string &name);
     void setErrorString(const std::string &errorString);
 
+private:
+    void calculationChanged();
+    void updateBatches() const;
+    void updateExclusions() const;
+    void updateNeighborList(const std::vector<Point3> &positions) const;
+    size_t taskCount() const;
+    void runTasks(const Point3 *positions, size_t taskCount, Real *energies, Vector3 **gradients) const;
+    void evaluateEnergy(const CartesianCoordinates *coordinates, Real *energy) const;
+    void evaluateTask(const Point3 *positions, size_t task, size_t taskCount, Real *energy, Vector3 *gradient) const;
+
+    friend class ForceFieldCalculation;
+
 private:
     ForceFieldPrivate* const d;
 };
@@ -39,6 +39,7 @@
 
 #include "topology.h"
 #include "forcefield.h"
+#include "forcefieldkernel.h"
 
 namespace chemkit {
 
@@ -108,6 +109,10 @@ boost::shared_ptr<Topology> ForceFieldCalculation::topology() const
 void ForceFieldCalculation::setAtom(size_t index, size_t atom)
 {
     d->atoms[index] = atom;
+
+    if(d->forceField){
+        d->forceField->calculationChanged();
+    }
 }
 
 /// Returns the atom at index in the calculation.
@@ -138,6 +143,10 @@ std::string ForceFieldCalculation::atomType(size_t index) const
 void ForceFieldCalculation::setParameter(int index, Real value)
 {
     d->parameters[index] = value;
+
+    if(d->forceField){
+        d->forceField->calculationChanged();
+    }
 }
 
 /// Returns the parameter at index.
@@ -159,12 +168,34 @@ int ForceFieldCalculation::parameterCount() const
 }
 
 // --- Calculations -------------------------------------------------------- //
+/// Returns the kernel used to evaluate the calculation or \c 0 if
+/// the calculation does not provide one.
+///
+/// Calculations that share a kernel are evaluated together by the
+/// force field which avoids a virtual call for each term.
+///
+/// \see ForceFieldKernel
+const ForceFieldKernel* ForceFieldCalculation::kernel() const
+{
+    return 0;
+}
+
 /// Returns the energy of the calculation. Energy is in kcal/mol.
 Real ForceFieldCalculation::energy(const CartesianCoordinates *coordinates) const
 {
-    CHEMKIT_UNUSED(coordinates);
+    const ForceFieldKernel *kernel = this->kernel();
+    if(!kernel){
+        return 0;
+    }
 
-    return 0;
+    std::vector<Point3> positions(atomCount());
+    std::vector<size_t> atoms(atomCount());
+    for(size_t i = 0; i < atomCount(); i++){
+        positions[i] = coordinates->position(atom(i));
+        atoms[i] = i;
+    }
+
+    return kernel->energy(&positions[0], &atoms[0], parameterData(), 1);
 }
 
 /// Returns the gradient of the energy with respect to the
@@ -190,7 +221,22 @@ Real ForceFieldCalculation::energy(const CartesianCoordinates *coordinates) cons
 **/
 std::vector<Vector3> ForceFieldCalculation::gradient(const CartesianCoordinates *coordinates) const
 {
-    return numericalGradient(coordinates);
+    const ForceFieldKernel *kernel = this->kernel();
+    if(!kernel){
+        return numericalGradient(coordinates);
+    }
+
+    std::vector<Point3> positions(atomCount());
+    std::vector<size_t> atoms(atomCount());
+    for(size_t i = 0; i < atomCount(); i++){
+        positions[i] = coordinates->position(atom(i));
+        atoms[i] = i;
+    }
+
+    std::vector<Vector3> gradient(atomCount(), Vector3(0, 0, 0));
+    kernel->gradient(&positions[0], &atoms[0], parameterData(), 1, &gradient[0]);
+
+    return gradient;
 }
 
 /// Returns the gradient of the energy with respect to the
@@ -245,4 +291,14 @@ void ForceFieldCalculation::setForceField(ForceField *forceField)
     d->forceField = forceField;
 }
 
+const size_t* ForceFieldCalculation::atomData() const
+{
+    return d->atoms.empty() ? 0 : &d->atoms[0];
+}
+
+const Real* ForceFieldCalculation::parameterData() const
+{
+    return d->parameters.empty() ? 0 : &d->parameters[0];
+}
+
 } // end chemkit namespace
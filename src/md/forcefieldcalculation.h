@@ -48,6 +48,7 @@ namespace chemkit {
 
 class Topology;
 class ForceField;
+class ForceFieldKernel;
 class CartesianCoordinates;
 class ForceFieldCalculationPrivate;
 
@@ -83,6 +84,7 @@ public:
     int parameterCount() const;
 
     // calculations
+    virtual const ForceFieldKernel* kernel() const;
     virtual Real energy(const CartesianCoordinates *coordinates) const;
     virtual std::vector<Vector3> gradient(const CartesianCoordinates *coordinates) const;
     std::vector<Vector3> numericalGradient(const CartesianCoordinates *coordinates) const;
@@ -95,6 +97,8 @@ protected:
 private:
     void setSetup(bool setup);
     void setForceField(ForceField *forceField);
+    const size_t* atomData() const;
+    const Real* parameterData() const;
 
     friend class ForceField;
 
@@ -0,0 +1,200 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#ifndef CHEMKIT_FORCEFIELDKERNEL_INLINE_H
+#define CHEMKIT_FORCEFIELDKERNEL_INLINE_H
+
+#include "forcefieldkernel.h"
+
+namespace chemkit {
+
+// === ForceFieldKernelAdaptor ============================================= //
+/// \class ForceFieldKernelAdaptor forcefieldkernel.h chemkit/forcefieldkernel.h
+/// \ingroup chemkit-md
+/// \brief The ForceFieldKernelAdaptor class implements a force field
+///        kernel from the static evaluation functions of a force
+///        field calculation class.
+///
+/// The \p Calculation class must provide the \c AtomCount and
+/// \c ParameterCount constants along with the following static
+/// functions which evaluate a single term:
+///
+/// \code
+/// static Real evaluateEnergy(const Point3 *positions,
+///                            const size_t *atoms,
+///                            const Real *parameters);
+/// static void evaluateGradient(const Point3 *positions,
+///                              const size_t *atoms,
+///                              const Real *parameters,
+///                              Vector3 *gradient);
+/// \endcode
+///
+/// The gradient written by \c evaluateGradient() has one entry for
+/// each of the term's atoms.
+///
+/// The switched energy() and gradient() overloads are only meaningful
+/// for pair terms where \c AtomCount is two.
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new kernel adaptor.
+template<typename Calculation>
+inline ForceFieldKernelAdaptor<Calculation>::ForceFieldKernelAdaptor()
+    : ForceFieldKernel(Calculation::AtomCount, Calculation::ParameterCount)
+{
+}
+
+// --- Calculations -------------------------------------------------------- //
+template<typename Calculation>
+inline Real ForceFieldKernelAdaptor<Calculation>::energy(const Point3 *positions,
+                                                         const size_t *atoms,
+                                                         const Real *parameters,
+                                                         size_t count) const
+{
+    Real energy = 0;
+
+    for(size_t i = 0; i < count; i++){
+        energy += Calculation::evaluateEnergy(positions, atoms, parameters);
+
+        atoms += Calculation::AtomCount;
+        parameters += Calculation::ParameterCount;
+    }
+
+    return energy;
+}
+
+template<typename Calculation>
+inline void ForceFieldKernelAdaptor<Calculation>::gradient(const Point3 *positions,
+                                                           const size_t *atoms,
+                                                           const Real *parameters,
+                                                           size_t count,
+                                                           Vector3 *gradient) const
+{
+    Vector3 termGradient[Calculation::AtomCount];
+
+    for(size_t i = 0; i < count; i++){
+        Calculation::evaluateGradient(positions, atoms, parameters, termGradient);
+
+        for(size_t j = 0; j < size_t(Calculation::AtomCount); j++){
+            gradient[atoms[j]] += termGradient[j];
+        }
+
+        atoms += Calculation::AtomCount;
+        parameters += Calculation::ParameterCount;
+    }
+}
+
+template<typename Calculation>
+inline Real ForceFieldKernelAdaptor<Calculation>::energy(const Point3 *positions,
+                                                         const size_t *atoms,
+                                                         const Real *parameters,
+                                                         size_t count,
+                                                         Real switchingDistance,
+                                                         Real cutoff) const
+{
+    const Real on2 = switchingDistance * switchingDistance;
+    const Real off2 = cutoff * cutoff;
+    const Real denominator = on2 < off2 ? (off2 - on2) * (off2 - on2) * (off2 - on2) : 1;
+
+    Real energy = 0;
+
+    for(size_t i = 0; i < count; i++){
+        Real r2 = (positions[atoms[0]] - positions[atoms[1]]).squaredNorm();
+
+        if(r2 < off2){
+            Real termEnergy = Calculation::evaluateEnergy(positions, atoms, parameters);
+
+            if(r2 > on2){
+                // switching function
+                termEnergy *= (off2 - r2) * (off2 - r2) * (off2 + 2 * r2 - 3 * on2) / denominator;
+            }
+
+            energy += termEnergy;
+        }
+
+        atoms += Calculation::AtomCount;
+        parameters += Calculation::ParameterCount;
+    }
+
+    return energy;
+}
+
+template<typename Calculation>
+inline void ForceFieldKernelAdaptor<Calculation>::gradient(const Point3 *positions,
+                                                           const size_t *atoms,
+                                                           const Real *parameters,
+                                                           size_t count,
+                                                           Real switchingDistance,
+                                                           Real cutoff,
+                                                           Vector3 *gradient) const
+{
+    const Real on2 = switchingDistance * switchingDistance;
+    const Real off2 = cutoff * cutoff;
+    const Real denominator = on2 < off2 ? (off2 - on2) * (off2 - on2) * (off2 - on2) : 1;
+
+    Vector3 termGradient[Calculation::AtomCount];
+
+    for(size_t i = 0; i < count; i++){
+        Vector3 ab = positions[atoms[0]] - positions[atoms[1]];
+        Real r2 = ab.squaredNorm();
+
+        if(r2 < off2){
+            Calculation::evaluateGradient(positions, atoms, parameters, termGradient);
+
+            if(r2 > on2){
+                // switching function and its derivative with respect
+                // to r divided by r (dr/da is (a - b) / r)
+                Real s = (off2 - r2) * (off2 - r2) * (off2 + 2 * r2 - 3 * on2) / denominator;
+                Real ds_dr_r = 12 * (off2 - r2) * (on2 - r2) / denominator;
+                Real termEnergy = Calculation::evaluateEnergy(positions, atoms, parameters);
+
+                Vector3 de_da = ab * (termEnergy * ds_dr_r);
+
+                termGradient[0] = termGradient[0] * s + de_da;
+                termGradient[1] = termGradient[1] * s - de_da;
+            }
+
+            gradient[atoms[0]] += termGradient[0];
+            gradient[atoms[1]] += termGradient[1];
+        }
+
+        atoms += Calculation::AtomCount;
+        parameters += Calculation::ParameterCount;
+    }
+}
+
+} // end chemkit namespace
+
+#endif // CHEMKIT_FORCEFIELDKERNEL_INLINE_H
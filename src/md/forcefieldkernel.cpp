@@ -0,0 +1,110 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "forcefieldkernel.h"
+
+namespace chemkit {
+
+// === ForceFieldKernel ==================================================== //
+/// \class ForceFieldKernel forcefieldkernel.h chemkit/forcefieldkernel.h
+/// \ingroup chemkit-md
+/// \brief The ForceFieldKernel class evaluates a batch of force
+///        field calculations of the same type.
+///
+/// Each force field calculation type may provide a kernel through
+/// ForceFieldCalculation::kernel(). The force field packs the atom
+/// indices and parameters of all calculations sharing a kernel into
+/// contiguous arrays and evaluates them with a single call to
+/// energy() or gradient().
+///
+/// The atoms and parameters for the \c i'th term of a batch start
+/// at <tt>atoms[i * atomCount()]</tt> and
+/// <tt>parameters[i * parameterCount()]</tt> respectively.
+///
+/// \see ForceFieldKernelAdaptor
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new kernel for calculations with \p atomCount atoms
+/// and \p parameterCount parameters.
+ForceFieldKernel::ForceFieldKernel(size_t atomCount, size_t parameterCount)
+    : m_atomCount(atomCount),
+      m_parameterCount(parameterCount)
+{
+}
+
+/// Destroys the kernel.
+ForceFieldKernel::~ForceFieldKernel()
+{
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Returns the number of atoms in each term.
+size_t ForceFieldKernel::atomCount() const
+{
+    return m_atomCount;
+}
+
+/// Returns the number of parameters in each term.
+size_t ForceFieldKernel::parameterCount() const
+{
+    return m_parameterCount;
+}
+
+// --- Calculations -------------------------------------------------------- //
+/// \fn Real ForceFieldKernel::energy(const Point3 *positions, const size_t *atoms, const Real *parameters, size_t count) const
+///
+/// Returns the total energy of the \p count terms described by
+/// \p atoms and \p parameters. Atom indices refer to \p positions.
+
+/// \fn void ForceFieldKernel::gradient(const Point3 *positions, const size_t *atoms, const Real *parameters, size_t count, Vector3 *gradient) const
+///
+/// Adds the gradient of the \p count terms described by \p atoms
+/// and \p parameters to \p gradient. The gradient is indexed by
+/// atom in the same way as \p positions.
+
+/// \fn Real ForceFieldKernel::energy(const Point3 *positions, const size_t *atoms, const Real *parameters, size_t count, Real switchingDistance, Real cutoff) const
+///
+/// Returns the total energy of the \p count pair terms described by
+/// \p atoms and \p parameters. Pairs further apart than \p cutoff
+/// are skipped and pairs between \p switchingDistance and \p cutoff
+/// are smoothly scaled to zero with the CHARMM switching function.
+
+/// \fn void ForceFieldKernel::gradient(const Point3 *positions, const size_t *atoms, const Real *parameters, size_t count, Real switchingDistance, Real cutoff, Vector3 *gradient) const
+///
+/// Adds the gradient of the switched energy of the \p count pair
+/// terms described by \p atoms and \p parameters to \p gradient.
+
+} // end chemkit namespace
@@ -0,0 +1,125 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#ifndef CHEMKIT_FORCEFIELDKERNEL_H
+#define CHEMKIT_FORCEFIELDKERNEL_H
+
+#include "md.h"
+
+#include <chemkit/point3.h>
+#include <chemkit/vector3.h>
+
+namespace chemkit {
+
+class CHEMKIT_MD_EXPORT ForceFieldKernel
+{
+public:
+    // construction and destruction
+    virtual ~ForceFieldKernel();
+
+    // properties
+    size_t atomCount() const;
+    size_t parameterCount() const;
+
+    // calculations
+    virtual Real energy(const Point3 *positions,
+                        const size_t *atoms,
+                        const Real *parameters,
+                        size_t count) const = 0;
+    virtual void gradient(const Point3 *positions,
+                          const size_t *atoms,
+                          const Real *parameters,
+                          size_t count,
+                          Vector3 *gradient) const = 0;
+    virtual Real energy(const Point3 *positions,
+                        const size_t *atoms,
+                        const Real *parameters,
+                        size_t count,
+                        Real switchingDistance,
+                        Real cutoff) const = 0;
+    virtual void gradient(const Point3 *positions,
+                          const size_t *atoms,
+                          const Real *parameters,
+                          size_t count,
+                          Real switchingDistance,
+                          Real cutoff,
+                          Vector3 *gradient) const = 0;
+
+protected:
+    ForceFieldKernel(size_t atomCount, size_t parameterCount);
+
+private:
+    size_t m_atomCount;
+    size_t m_parameterCount;
+};
+
+template<typename Calculation>
+class ForceFieldKernelAdaptor : public ForceFieldKernel
+{
+public:
+    // construction and destruction
+    ForceFieldKernelAdaptor();
+
+    // calculations
+    Real energy(const Point3 *positions,
+                const size_t *atoms,
+                const Real *parameters,
+                size_t count) const CHEMKIT_OVERRIDE;
+    void gradient(const Point3 *positions,
+                  const size_t *atoms,
+                  const Real *parameters,
+                  size_t count,
+                  Vector3 *gradient) const CHEMKIT_OVERRIDE;
+    Real energy(const Point3 *positions,
+                const size_t *atoms,
+                const Real *parameters,
+                size_t count,
+                Real switchingDistance,
+                Real cutoff) const CHEMKIT_OVERRIDE;
+    void gradient(const Point3 *positions,
+                  const size_t *atoms,
+                  const Real *parameters,
+                  size_t count,
+                  Real switchingDistance,
+                  Real cutoff,
+                  Vector3 *gradient) const CHEMKIT_OVERRIDE;
+};
+
+} // end chemkit namespace
+
+#include "forcefieldkernel-inline.h"
+
+#endif // CHEMKIT_FORCEFIELDKERNEL_H
@@ -0,0 +1,124 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#ifndef CHEMKIT_FORCEFIELDPARAMETERSCACHE_INLINE_H
+#define CHEMKIT_FORCEFIELDPARAMETERSCACHE_INLINE_H
+
+#include "forcefieldparameterscache.h"
+
+namespace chemkit {
+
+// === ForceFieldParametersCache =========================================== //
+/// \class ForceFieldParametersCache forcefieldparameterscache.h chemkit/forcefieldparameterscache.h
+/// \ingroup chemkit-md
+/// \brief The ForceFieldParametersCache class provides a process
+///        wide cache of force field parameter sets.
+///
+/// Parameter sets are loaded the first time they are requested and
+/// shared by every force field that requests them afterwards. The
+/// returned parameters are immutable so they may be used from any
+/// number of threads at once.
+///
+/// The \p Parameters type must be default constructible and, to be
+/// loaded from a file, provide the following methods:
+/// \code
+/// bool read(const std::string &fileName);
+/// std::string errorString() const;
+/// \endcode
+
+// --- Parameters ---------------------------------------------------------- //
+/// Returns the built-in parameters. These are created with the
+/// default constructor the first time they are requested.
+template<typename Parameters>
+inline boost::shared_ptr<const Parameters> ForceFieldParametersCache<Parameters>::parameters()
+{
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    boost::shared_ptr<const Parameters> &parameters = m_parameters[std::string()];
+    if(!parameters){
+        parameters.reset(new Parameters);
+    }
+
+    return parameters;
+}
+
+/// Returns the parameters read from \p fileName. The file is only
+/// read the first time it is requested. If the parameters could not
+/// be read a null pointer is returned and, if \p errorString is not
+/// \c 0, it is set to a description of the error.
+template<typename Parameters>
+inline boost::shared_ptr<const Parameters> ForceFieldParametersCache<Parameters>::parameters(const std::string &fileName,
+                                                                                             std::string *errorString)
+{
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    typename std::map<std::string, boost::shared_ptr<const Parameters> >::const_iterator iter = m_parameters.find(fileName);
+    if(iter != m_parameters.end()){
+        return iter->second;
+    }
+
+    boost::shared_ptr<Parameters> parameters(new Parameters);
+    if(!parameters->read(fileName)){
+        if(errorString){
+            *errorString = parameters->errorString();
+        }
+
+        return boost::shared_ptr<const Parameters>();
+    }
+
+    m_parameters[fileName] = parameters;
+
+    return parameters;
+}
+
+/// Removes all of the parameters from the cache. Parameters still
+/// in use by a force field are destroyed once they are released.
+template<typename Parameters>
+inline void ForceFieldParametersCache<Parameters>::clear()
+{
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_parameters.clear();
+}
+
+template<typename Parameters>
+boost::mutex ForceFieldParametersCache<Parameters>::m_mutex;
+
+template<typename Parameters>
+std::map<std::string, boost::shared_ptr<const Parameters> > ForceFieldParametersCache<Parameters>::m_parameters;
+
+} // end chemkit namespace
+
+#endif // CHEMKIT_FORCEFIELDPARAMETERSCACHE_INLINE_H
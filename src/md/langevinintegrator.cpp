@@ -0,0 +1,120 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "langevinintegrator.h"
+
+#include <cmath>
+
+#include <chemkit/cartesiancoordinates.h>
+
+namespace chemkit {
+
+// === LangevinIntegrator ================================================== //
+/// \class LangevinIntegrator langevinintegrator.h chemkit/langevinintegrator.h
+/// \ingroup chemkit-md
+/// \brief The LangevinIntegrator class integrates the Langevin
+///        equations of motion.
+///
+/// The system is coupled to a heat bath at temperature() through a
+/// friction term and random forces. Each step is split with the BAOAB
+/// scheme of Leimkuhler and Matthews, which samples configurations
+/// accurately at large timesteps.
+///
+/// The random forces are drawn from a generator seeded with seed(),
+/// so trajectories are reproducible for a given seed.
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new Langevin integrator.
+LangevinIntegrator::LangevinIntegrator()
+    : DynamicsIntegrator(),
+      m_frictionCoefficient(1.0)
+{
+}
+
+/// Destroys the integrator.
+LangevinIntegrator::~LangevinIntegrator()
+{
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Sets the friction coefficient to \p coefficient inverse
+/// picoseconds. The default is \c 1.0.
+void LangevinIntegrator::setFrictionCoefficient(Real coefficient)
+{
+    m_frictionCoefficient = coefficient;
+}
+
+/// Returns the friction coefficient in inverse picoseconds.
+Real LangevinIntegrator::frictionCoefficient() const
+{
+    return m_frictionCoefficient;
+}
+
+// --- Integration --------------------------------------------------------- //
+void LangevinIntegrator::step()
+{
+    CartesianCoordinates *coordinates = this->coordinates();
+    std::vector<Vector3> &velocities = velocityBuffer();
+    Real timestep = this->timestep();
+
+    // velocity damping and noise over a full step (1/ps -> 1/fs)
+    Real damping = std::exp(-m_frictionCoefficient * timestep * 1.0e-3);
+    Real noise = std::sqrt(1 - damping * damping);
+
+    const std::vector<Vector3> &initialAccelerations = accelerations();
+    for(size_t i = 0; i < velocities.size(); i++){
+        // half kick and half drift
+        velocities[i] += 0.5 * timestep * initialAccelerations[i];
+        Point3 position = coordinates->position(i) + 0.5 * timestep * velocities[i];
+
+        // thermostat
+        Real velocity = noise * thermalVelocity(i);
+        velocities[i] = damping * velocities[i] +
+                        velocity * Vector3(randomNormal(), randomNormal(), randomNormal());
+
+        // half drift
+        coordinates->setPosition(i, position + 0.5 * timestep * velocities[i]);
+    }
+
+    // half kick with the new accelerations
+    updateAccelerations();
+    const std::vector<Vector3> &finalAccelerations = accelerations();
+    for(size_t i = 0; i < velocities.size(); i++){
+        velocities[i] += 0.5 * timestep * finalAccelerations[i];
+    }
+}
+
+} // end chemkit namespace
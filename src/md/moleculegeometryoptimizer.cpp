@@ -35,10 +35,13 @@
 
 #include "moleculegeometryoptimizer.h"
 
+#include <deque>
+
 #include <boost/make_shared.hpp>
 #include <boost/math/special_functions/fpclassify.hpp>
 
 #include <chemkit/atom.h>
+#include <chemkit/foreach.h>
 #include <chemkit/molecule.h>
 #include <chemkit/concurrent.h>
 #include <chemkit/cartesiancoordinates.h>
@@ -50,7 +53,346 @@ namespace chemkit {
 
 namespace {
 
-class SteepestDescentIntegrator : public Integrator
+// A point along the line search direction.
+struct LineSearchPoint
+{
+    Real step;
+    Real energy;
+    Real slope;
+    std::vector<Vector3> gradient;
+};
+
+// === MinimizationIntegrator ============================================== //
+// Base class for the energy minimization integrators. Caches the energy
+// and gradient at the current coordinates and counts the number of
+// potential evaluations.
+class MinimizationIntegrator : public Integrator
+{
+public:
+    MinimizationIntegrator();
+
+    virtual void reset();
+    Real currentEnergy();
+    Real currentRmsg();
+    Real energyChange() const;
+    bool isStalled() const;
+    size_t evaluationCount() const;
+
+protected:
+    Real evaluateEnergy();
+    std::vector<Vector3> evaluateGradient();
+    void update();
+    void invalidate();
+    bool lineSearch(const std::vector<Vector3> &direction, Real step, Real curvature, Real *acceptedStep);
+
+private:
+    void evaluatePoint(const std::vector<Point3> &initialPositions, const std::vector<Vector3> &direction, LineSearchPoint *point);
+
+protected:
+    Real m_energy;
+    std::vector<Vector3> m_gradient;
+    bool m_valid;
+    Real m_energyChange;
+    bool m_stalled;
+    size_t m_evaluationCount;
+};
+
+// the largest distance any atom is moved in a single line search step
+const Real MaximumDisplacement = 0.3;
+
+// the maximum number of points evaluated in a single line search
+const size_t MaximumLineSearchPoints = 20;
+
+// the constant for the sufficient decrease condition
+const Real SufficientDecrease = 1e-4;
+
+Real dot(const std::vector<Vector3> &a, const std::vector<Vector3> &b)
+{
+    Real sum = 0;
+
+    for(size_t i = 0; i < a.size(); i++){
+        sum += a[i].dot(b[i]);
+    }
+
+    return sum;
+}
+
+// Returns the step between a and b minimizing the cubic interpolating
+// the energies and slopes at both points. Falls back to bisection if
+// the cubic has no minimum in the interval or the interpolated step
+// is too close to either end.
+Real interpolateStep(const LineSearchPoint &a, const LineSearchPoint &b)
+{
+    Real bisection = 0.5 * (a.step + b.step);
+
+    if(!(boost::math::isfinite)(a.energy) || !(boost::math::isfinite)(b.energy)){
+        return bisection;
+    }
+
+    Real d1 = a.slope + b.slope - 3 * (a.energy - b.energy) / (a.step - b.step);
+    Real radicand = d1 * d1 - a.slope * b.slope;
+    if(radicand < 0){
+        return bisection;
+    }
+
+    Real d2 = (b.step > a.step ? 1 : -1) * std::sqrt(radicand);
+    Real denominator = b.slope - a.slope + 2 * d2;
+    if(denominator == 0){
+        return bisection;
+    }
+
+    Real step = b.step - (b.step - a.step) * (b.slope + d2 - d1) / denominator;
+
+    Real margin = 0.1 * std::abs(b.step - a.step);
+    if(!(step > std::min(a.step, b.step) + margin && step < std::max(a.step, b.step) - margin)){
+        return bisection;
+    }
+
+    return step;
+}
+
+MinimizationIntegrator::MinimizationIntegrator()
+{
+    reset();
+}
+
+void MinimizationIntegrator::reset()
+{
+    m_energy = 0;
+    m_gradient.clear();
+    m_valid = false;
+    m_energyChange = 0;
+    m_stalled = false;
+    m_evaluationCount = 0;
+}
+
+Real MinimizationIntegrator::currentEnergy()
+{
+    update();
+
+    return m_energy;
+}
+
+Real MinimizationIntegrator::currentRmsg()
+{
+    update();
+
+    if(m_gradient.empty()){
+        return 0;
+    }
+
+    return std::sqrt(dot(m_gradient, m_gradient) / (3.0 * m_gradient.size()));
+}
+
+// Returns the decrease in energy from the last integration step.
+Real MinimizationIntegrator::energyChange() const
+{
+    return m_energyChange;
+}
+
+// Returns true if the last step failed to reduce the energy along the
+// steepest descent direction.
+bool MinimizationIntegrator::isStalled() const
+{
+    return m_stalled;
+}
+
+size_t MinimizationIntegrator::evaluationCount() const
+{
+    return m_evaluationCount;
+}
+
+Real MinimizationIntegrator::evaluateEnergy()
+{
+    m_evaluationCount++;
+
+    return potential()->energy(coordinates());
+}
+
+std::vector<Vector3> MinimizationIntegrator::evaluateGradient()
+{
+    m_evaluationCount++;
+
+    return potential()->gradient(coordinates());
+}
+
+// Calculates the energy and gradient at the current coordinates if
+// they are not already known.
+void MinimizationIntegrator::update()
+{
+    if(m_valid || !potential() || !coordinates()){
+        return;
+    }
+
+    m_energy = evaluateEnergy();
+    m_gradient = evaluateGradient();
+    m_valid = true;
+}
+
+void MinimizationIntegrator::invalidate()
+{
+    m_valid = false;
+}
+
+// Moves the atoms to point->step along direction and calculates the
+// energy and, if it is finite, the gradient and slope at the point.
+void MinimizationIntegrator::evaluatePoint(const std::vector<Point3> &initialPositions,
+                                           const std::vector<Vector3> &direction,
+                                           LineSearchPoint *point)
+{
+    CartesianCoordinates *coordinates = this->coordinates();
+
+    for(size_t i = 0; i < initialPositions.size(); i++){
+        coordinates->setPosition(i, initialPositions[i] + direction[i] * point->step);
+    }
+
+    point->energy = evaluateEnergy();
+
+    if((boost::math::isfinite)(point->energy)){
+        point->gradient = evaluateGradient();
+        point->slope = dot(point->gradient, direction);
+    }
+}
+
+// Searches along direction from the current coordinates for a step
+// satisfying the strong Wolfe conditions with the given curvature
+// constant. The search starts at step, which is limited so that no
+// atom moves further than MaximumDisplacement.
+//
+// On success the coordinates are moved to the new point and true is
+// returned. Otherwise the coordinates are left unchanged.
+bool MinimizationIntegrator::lineSearch(const std::vector<Vector3> &direction, Real step, Real curvature, Real *acceptedStep)
+{
+    CartesianCoordinates *coordinates = this->coordinates();
+    size_t size = coordinates->size();
+
+    update();
+
+    const Real initialEnergy = m_energy;
+    const Real initialSlope = dot(m_gradient, direction);
+    if(!(initialSlope < 0) || !(boost::math::isfinite)(initialEnergy)){
+        return false;
+    }
+
+    // limit the largest atom displacement
+    Real maximumDirection = 0;
+    foreach(const Vector3 &vector, direction){
+        maximumDirection = std::max(maximumDirection, vector.norm());
+    }
+    const Real maximumStep = MaximumDisplacement / maximumDirection;
+    step = std::min(step, maximumStep);
+
+    std::vector<Point3> initialPositions(size);
+    for(size_t i = 0; i < size; i++){
+        initialPositions[i] = coordinates->position(i);
+    }
+
+    LineSearchPoint previous;
+    previous.step = 0;
+    previous.energy = initialEnergy;
+    previous.slope = initialSlope;
+    previous.gradient = m_gradient;
+
+    LineSearchPoint current;
+    LineSearchPoint low;
+    LineSearchPoint high;
+    low.step = 0;
+    bool bracketed = false;
+    bool accepted = false;
+    size_t pointCount = 0;
+
+    // increase the step until the minimum is bracketed
+    while(pointCount < MaximumLineSearchPoints){
+        current.step = step;
+        evaluatePoint(initialPositions, direction, &current);
+        pointCount++;
+
+        if(!(current.energy <= initialEnergy + SufficientDecrease * current.step * initialSlope) ||
+           (pointCount > 1 && current.energy >= previous.energy)){
+            low = previous;
+            high = current;
+            bracketed = true;
+            break;
+        }
+        else if(std::abs(current.slope) <= -curvature * initialSlope){
+            accepted = true;
+            break;
+        }
+        else if(current.slope >= 0){
+            low = current;
+            high = previous;
+            bracketed = true;
+            break;
+        }
+        else if(step >= maximumStep){
+            accepted = true;
+            break;
+        }
+
+        previous = current;
+        step = std::min(2 * step, maximumStep);
+    }
+
+    if(!bracketed && !accepted){
+        // the last point satisfies the sufficient decrease condition
+        accepted = true;
+    }
+
+    // shrink the bracket until a point satisfies both conditions
+    while(bracketed && !accepted && pointCount < MaximumLineSearchPoints){
+        current.step = interpolateStep(low, high);
+        evaluatePoint(initialPositions, direction, &current);
+        pointCount++;
+
+        if(!(current.energy <= initialEnergy + SufficientDecrease * current.step * initialSlope) ||
+           current.energy >= low.energy){
+            high = current;
+        }
+        else{
+            if(std::abs(current.slope) <= -curvature * initialSlope){
+                accepted = true;
+                break;
+            }
+
+            if(current.slope * (high.step - low.step) >= 0){
+                high = low;
+            }
+
+            low = current;
+        }
+    }
+
+    if(!accepted){
+        // fall back to the lowest point found if it reduced the energy
+        if(low.step > 0 && low.energy < initialEnergy){
+            current = low;
+            for(size_t i = 0; i < size; i++){
+                coordinates->setPosition(i, initialPositions[i] + direction[i] * current.step);
+            }
+        }
+        else{
+            for(size_t i = 0; i < size; i++){
+                coordinates->setPosition(i, initialPositions[i]);
+            }
+
+            return false;
+        }
+    }
+
+    m_energy = current.energy;
+    m_gradient = current.gradient;
+    m_valid = true;
+    m_energyChange = initialEnergy - current.energy;
+
+    if(acceptedStep){
+        *acceptedStep = current.step;
+    }
+
+    return true;
+}
+
+// === SteepestDescentIntegrator =========================================== //
+class SteepestDescentIntegrator : public MinimizationIntegrator
 {
 public:
     void integrate() CHEMKIT_OVERRIDE;
@@ -61,7 +403,7 @@ void SteepestDescentIntegrator::integrate()
     CartesianCoordinates *coordinates = this->coordinates();
     boost::shared_ptr<Potential> potential = this->potential();
 
-    if(!potential || !coordinates){
+    if(!potential || !coordinates || m_stalled){
         return;
     }
 
@@ -71,8 +413,11 @@ void SteepestDescentIntegrator::integrate()
     size_t stepCount = 10;
 
     // calculate initial energy and gradient
-    Real initialEnergy = potential->energy(coordinates);
-    std::vector<Vector3> gradient = potential->gradient(coordinates);
+    update();
+    Real startEnergy = m_energy;
+    Real initialEnergy = m_energy;
+    std::vector<Vector3> gradient = m_gradient;
+    bool moved = false;
 
     // perform line search
     for(size_t i = 0; i < stepCount; i++){
@@ -85,7 +430,7 @@ void SteepestDescentIntegrator::integrate()
         }
 
         // calculate new energy
-        Real finalEnergy = potential->energy(coordinates);
+        Real finalEnergy = evaluateEnergy();
 
         // if the final energy is NaN then most likely the
         // simulation exploded so we reset the initial atom
@@ -99,12 +444,17 @@ void SteepestDescentIntegrator::integrate()
             }
 
             // recalculate gradient
-            gradient = potential->gradient(coordinates);
+            gradient = evaluateGradient();
+            moved = true;
 
             // continue to next step
             continue;
         }
 
+        if(finalEnergy < initialEnergy){
+            moved = true;
+        }
+
         if(finalEnergy < initialEnergy && std::abs(finalEnergy - initialEnergy) < stepConv){
             break;
         }
@@ -129,6 +479,242 @@ void SteepestDescentIntegrator::integrate()
             step *= 0.1;
         }
     }
+
+    // none of the steps reduced the energy
+    if(!moved){
+        m_stalled = true;
+    }
+
+    m_energyChange = startEnergy - initialEnergy;
+    invalidate();
+}
+
+// === ConjugateGradientIntegrator ========================================= //
+// Nonlinear conjugate gradient minimization using the Polak-Ribiere
+// formula with automatic restarts (PR+).
+class ConjugateGradientIntegrator : public MinimizationIntegrator
+{
+public:
+    ConjugateGradientIntegrator();
+
+    void reset() CHEMKIT_OVERRIDE;
+    void integrate() CHEMKIT_OVERRIDE;
+
+private:
+    std::vector<Vector3> m_previousGradient;
+    std::vector<Vector3> m_direction;
+    Real m_previousStep;
+    Real m_previousSlope;
+    size_t m_iteration;
+};
+
+ConjugateGradientIntegrator::ConjugateGradientIntegrator()
+{
+    reset();
+}
+
+void ConjugateGradientIntegrator::reset()
+{
+    MinimizationIntegrator::reset();
+
+    m_previousGradient.clear();
+    m_direction.clear();
+    m_previousStep = 0;
+    m_previousSlope = 0;
+    m_iteration = 0;
+}
+
+void ConjugateGradientIntegrator::integrate()
+{
+    if(!potential() || !coordinates() || m_stalled){
+        return;
+    }
+
+    update();
+
+    // restart with the steepest descent direction every 3N iterations
+    bool restart = m_direction.empty() || m_iteration % (3 * m_gradient.size()) == 0;
+
+    if(!restart){
+        Real beta = (dot(m_gradient, m_gradient) - dot(m_gradient, m_previousGradient)) /
+                    dot(m_previousGradient, m_previousGradient);
+        beta = std::max(Real(0), beta);
+
+        for(size_t i = 0; i < m_direction.size(); i++){
+            m_direction[i] = -m_gradient[i] + beta * m_direction[i];
+        }
+
+        if(!(dot(m_direction, m_gradient) < 0)){
+            restart = true;
+        }
+    }
+
+    if(restart){
+        m_direction.resize(m_gradient.size());
+        for(size_t i = 0; i < m_gradient.size(); i++){
+            m_direction[i] = -m_gradient[i];
+        }
+    }
+
+    // initial step assuming the first order change in energy will be
+    // the same as in the previous iteration
+    Real slope = dot(m_gradient, m_direction);
+    Real step = 1;
+    if(m_previousStep > 0 && !restart){
+        step = m_previousStep * m_previousSlope / slope;
+    }
+
+    std::vector<Vector3> gradient = m_gradient;
+
+    Real acceptedStep = 0;
+    if(!lineSearch(m_direction, step, 0.1, &acceptedStep)){
+        if(restart){
+            m_stalled = true;
+        }
+
+        // restart from the steepest descent direction
+        m_direction.clear();
+        m_iteration = 0;
+        return;
+    }
+
+    m_previousGradient = gradient;
+    m_previousStep = acceptedStep;
+    m_previousSlope = slope;
+    m_iteration++;
+}
+
+// === LbfgsIntegrator ===================================================== //
+// Limited-memory BFGS minimization. The inverse hessian is approximated
+// from the last few steps and gradient changes.
+class LbfgsIntegrator : public MinimizationIntegrator
+{
+public:
+    void reset() CHEMKIT_OVERRIDE;
+    void integrate() CHEMKIT_OVERRIDE;
+
+private:
+    // the number of corrections stored
+    enum { HistorySize = 8 };
+
+    std::deque<std::vector<Vector3> > m_steps;
+    std::deque<std::vector<Vector3> > m_gradientChanges;
+    std::deque<Real> m_rho;
+};
+
+void LbfgsIntegrator::reset()
+{
+    MinimizationIntegrator::reset();
+
+    m_steps.clear();
+    m_gradientChanges.clear();
+    m_rho.clear();
+}
+
+void LbfgsIntegrator::integrate()
+{
+    if(!potential() || !coordinates() || m_stalled){
+        return;
+    }
+
+    CartesianCoordinates *coordinates = this->coordinates();
+    size_t size = coordinates->size();
+
+    update();
+
+    // two-loop recursion for the search direction
+    std::vector<Vector3> direction(size);
+    for(size_t i = 0; i < size; i++){
+        direction[i] = -m_gradient[i];
+    }
+
+    std::vector<Real> alpha(m_steps.size());
+    for(size_t k = m_steps.size(); k-- > 0; ){
+        alpha[k] = m_rho[k] * dot(m_steps[k], direction);
+
+        for(size_t i = 0; i < size; i++){
+            direction[i] -= alpha[k] * m_gradientChanges[k][i];
+        }
+    }
+
+    if(!m_steps.empty()){
+        const std::vector<Vector3> &y = m_gradientChanges.back();
+        Real scale = 1.0 / (m_rho.back() * dot(y, y));
+
+        for(size_t i = 0; i < size; i++){
+            direction[i] *= scale;
+        }
+    }
+
+    for(size_t k = 0; k < m_steps.size(); k++){
+        Real beta = m_rho[k] * dot(m_gradientChanges[k], direction);
+
+        for(size_t i = 0; i < size; i++){
+            direction[i] += (alpha[k] - beta) * m_steps[k][i];
+        }
+    }
+
+    bool steepestDescent = m_steps.empty();
+    if(!(dot(direction, m_gradient) < 0)){
+        for(size_t i = 0; i < size; i++){
+            direction[i] = -m_gradient[i];
+        }
+
+        steepestDescent = true;
+    }
+
+    std::vector<Point3> positions(size);
+    for(size_t i = 0; i < size; i++){
+        positions[i] = coordinates->position(i);
+    }
+    std::vector<Vector3> gradient = m_gradient;
+
+    if(!lineSearch(direction, 1.0, 0.9, 0)){
+        if(steepestDescent){
+            m_stalled = true;
+        }
+
+        // discard the history and restart from the steepest descent
+        // direction
+        m_steps.clear();
+        m_gradientChanges.clear();
+        m_rho.clear();
+        return;
+    }
+
+    // store the correction pair
+    std::vector<Vector3> step(size);
+    std::vector<Vector3> gradientChange(size);
+    for(size_t i = 0; i < size; i++){
+        step[i] = coordinates->position(i) - positions[i];
+        gradientChange[i] = m_gradient[i] - gradient[i];
+    }
+
+    Real curvature = dot(step, gradientChange);
+    if(curvature > 1e-10){
+        m_steps.push_back(step);
+        m_gradientChanges.push_back(gradientChange);
+        m_rho.push_back(1.0 / curvature);
+
+        if(m_steps.size() > HistorySize){
+            m_steps.pop_front();
+            m_gradientChanges.pop_front();
+            m_rho.pop_front();
+        }
+    }
+}
+
+boost::shared_ptr<MinimizationIntegrator> createIntegrator(MoleculeGeometryOptimizer::Algorithm algorithm)
+{
+    switch(algorithm){
+        case MoleculeGeometryOptimizer::SteepestDescent:
+            return boost::make_shared<SteepestDescentIntegrator>();
+        case MoleculeGeometryOptimizer::ConjugateGradient:
+            return boost::make_shared<ConjugateGradientIntegrator>();
+        case MoleculeGeometryOptimizer::Lbfgs:
+        default:
+            return boost::make_shared<LbfgsIntegrator>();
+    }
 }
 
 } // end anonymous namespace
@@ -140,8 +726,14 @@ public:
     Molecule *molecule;
     boost::shared_ptr<ForceField> forceField;
     std::string forceFieldName;
+    size_t threadCount;
+    MoleculeGeometryOptimizer::Algorithm algorithm;
+    Real gradientTolerance;
+    Real energyTolerance;
+    size_t maximumIterations;
+    size_t iterationCount;
     std::string errorString;
-    boost::shared_ptr<Integrator> integrator;
+    boost::shared_ptr<MinimizationIntegrator> integrator;
 };
 
 // === MoleculeGeometryOptimizer =========================================== //
@@ -186,7 +778,13 @@ MoleculeGeometryOptimizer::MoleculeGeometryOptimizer(Molecule *molecule)
 {
     d->molecule = molecule;
     d->forceFieldName = "uff";
-    d->integrator = boost::make_shared<SteepestDescentIntegrator>();
+    d->threadCount = 1;
+    d->algorithm = SteepestDescent;
+    d->gradientTolerance = 0.1;
+    d->energyTolerance = 0;
+    d->maximumIterations = 1000;
+    d->iterationCount = 0;
+    d->integrator = createIntegrator(d->algorithm);
 }
 
 /// Destroys the geometry optmizer object.
@@ -228,6 +826,103 @@ std::string MoleculeGeometryOptimizer::forceField() const
     return d->forceFieldName;
 }
 
+/// Sets the number of threads used to evaluate the force field to
+/// \p count. If \p count is \c 0 the ideal thread count for the
+/// system is used. The default is \c 1.
+///
+/// \see ForceField::setThreadCount()
+void MoleculeGeometryOptimizer::setThreadCount(size_t count)
+{
+    d->threadCount = count;
+
+    if(d->forceField){
+        d->forceField->setThreadCount(count);
+    }
+}
+
+/// Returns the number of threads used to evaluate the force field.
+size_t MoleculeGeometryOptimizer::threadCount() const
+{
+    if(d->forceField){
+        return d->forceField->threadCount();
+    }
+
+    return d->threadCount;
+}
+
+/// Sets the minimization algorithm to \p algorithm. The default is
+/// \c SteepestDescent.
+///
+/// The following algorithms are supported:
+///     - \c SteepestDescent: moves the atoms against the gradient
+///       with an adaptive step size.
+///     - \c ConjugateGradient: nonlinear conjugate gradient using the
+///       Polak-Ribiere formula.
+///     - \c Lbfgs: limited-memory BFGS.
+///
+/// Both the conjugate gradient and L-BFGS algorithms use a line
+/// search satisfying the strong Wolfe conditions and typically need
+/// far fewer energy evaluations than steepest descent.
+///
+/// Changing the algorithm requires setup() to be called again.
+void MoleculeGeometryOptimizer::setAlgorithm(Algorithm algorithm)
+{
+    if(algorithm == d->algorithm){
+        return;
+    }
+
+    d->algorithm = algorithm;
+    d->integrator = createIntegrator(algorithm);
+    d->forceField.reset();
+}
+
+/// Returns the minimization algorithm.
+MoleculeGeometryOptimizer::Algorithm MoleculeGeometryOptimizer::algorithm() const
+{
+    return d->algorithm;
+}
+
+/// Sets the root-mean-square gradient below which the optimization
+/// is considered converged to \p tolerance. The default is \c 0.1.
+void MoleculeGeometryOptimizer::setGradientTolerance(Real tolerance)
+{
+    d->gradientTolerance = tolerance;
+}
+
+/// Returns the root-mean-square gradient convergence tolerance.
+Real MoleculeGeometryOptimizer::gradientTolerance() const
+{
+    return d->gradientTolerance;
+}
+
+/// Sets the change in energy between steps below which the
+/// optimization is considered converged to \p tolerance. The default
+/// is \c 0 which disables the energy convergence criterion.
+void MoleculeGeometryOptimizer::setEnergyTolerance(Real tolerance)
+{
+    d->energyTolerance = tolerance;
+}
+
+/// Returns the energy convergence tolerance.
+Real MoleculeGeometryOptimizer::energyTolerance() const
+{
+    return d->energyTolerance;
+}
+
+/// Sets the maximum number of steps performed by optimize() to
+/// \p count. If \p count is \c 0 there is no limit. The default is
+/// \c 1000.
+void MoleculeGeometryOptimizer::setMaximumIterations(size_t count)
+{
+    d->maximumIterations = count;
+}
+
+/// Returns the maximum number of steps performed by optimize().
+size_t MoleculeGeometryOptimizer::maximumIterations() const
+{
+    return d->maximumIterations;
+}
+
 // --- Energy -------------------------------------------------------------- //
 /// Returns the current energy of the force field.
 Real MoleculeGeometryOptimizer::energy() const
@@ -236,7 +931,7 @@ Real MoleculeGeometryOptimizer::energy() const
         return 0;
     }
 
-    return d->integrator->energy();
+    return d->integrator->currentEnergy();
 }
 
 // --- Optimization -------------------------------------------------------- //
@@ -248,14 +943,21 @@ bool MoleculeGeometryOptimizer::setup()
         return false;
     }
 
-    d->forceField = boost::shared_ptr<ForceField>(ForceField::create(d->forceFieldName));
-    if(!d->forceField){
-        d->errorString = "Force field '" + d->forceFieldName + "' is not supported.";
-        return false;
+    // the force field is reused when optimizing a sequence of
+    // molecules so that its parameters are only loaded once
+    if(!d->forceField || d->forceField->name() != d->forceFieldName){
+        d->forceField = boost::shared_ptr<ForceField>(ForceField::create(d->forceFieldName));
+        if(!d->forceField){
+            d->errorString = "Force field '" + d->forceFieldName + "' is not supported.";
+            return false;
+        }
     }
 
+    d->forceField->setThreadCount(d->threadCount);
+    d->integrator->reset();
     d->integrator->setPotential(d->forceField);
     d->integrator->setCoordinates(d->molecule->coordinates());
+    d->iterationCount = 0;
 
     d->forceField->setTopologyFromMolecule(d->molecule);
     if(!d->forceField->setup()){
@@ -266,9 +968,7 @@ bool MoleculeGeometryOptimizer::setup()
     return true;
 }
 
-/// Performs a single geometry optimization step. Returns \c true if
-/// converged. The minimization is considered converged when the
-/// root mean square gradient is below the convergance value.
+/// Performs a single geometry optimization step.
 void MoleculeGeometryOptimizer::step()
 {
     if(!d->molecule || !d->forceField){
@@ -277,37 +977,92 @@ void MoleculeGeometryOptimizer::step()
 
     // perform a single integration step
     d->integrator->integrate();
+    d->iterationCount++;
 }
 
 /// Returns \c true if the optimization algorithm has converged. By
 /// default, the algorithm is considered converged when the
 /// root-mean-square gradient of the force field falls below \c 0.1.
+///
+/// The optimization is also considered converged if the energy
+/// changed by less than the energy tolerance in the last step. An
+/// optimization which has stalled is not converged.
+///
+/// \see setGradientTolerance(), setEnergyTolerance(), isStalled()
 bool MoleculeGeometryOptimizer::converged()
 {
     if(!d->forceField){
         return false;
     }
 
+    if(d->integrator->isStalled()){
+        return false;
+    }
+
+    Real rmsg = d->integrator->currentRmsg();
+
+    if(d->energyTolerance > 0 &&
+       d->iterationCount > 0 &&
+       std::abs(d->integrator->energyChange()) < d->energyTolerance){
+        return true;
+    }
+
     // check for convergance
-    return d->integrator->rmsg() < 0.1;
+    return rmsg < d->gradientTolerance;
+}
+
+/// Returns \c true if a step can no longer reduce the energy.
+/// Further calls to step() have no effect until setup() is called
+/// again.
+///
+/// \see converged()
+bool MoleculeGeometryOptimizer::isStalled() const
+{
+    return d->forceField && d->integrator->isStalled();
 }
 
 /// Optimizes the geometry of the molecule. Returns \c true if the
-/// optimization algorithm converged.
+/// optimization algorithm converged within the maximum number of
+/// iterations.
+///
+/// \see setMaximumIterations()
 bool MoleculeGeometryOptimizer::optimize()
 {
     if(!setup()){
         return false;
     }
 
-    while(!converged()){
+    bool converged = this->converged();
+
+    while(!converged){
+        if(d->integrator->isStalled() ||
+           (d->maximumIterations && d->iterationCount >= d->maximumIterations)){
+            break;
+        }
+
         step();
+        converged = this->converged();
     }
 
     // write the optimized coordinates to the molecule
     writeCoordinates();
 
-    return true;
+    return converged;
+}
+
+/// Returns the number of steps performed since the last call to
+/// setup().
+size_t MoleculeGeometryOptimizer::iterationCount() const
+{
+    return d->iterationCount;
+}
+
+/// Returns the number of energy and gradient evaluations performed
+/// since the last call to setup(). An energy evaluation and a
+/// gradient evaluation each count as one.
+size_t MoleculeGeometryOptimizer::evaluationCount() const
+{
+    return d->integrator->evaluationCount();
 }
 
 /// Writes the optimized coordinates to the molecule.
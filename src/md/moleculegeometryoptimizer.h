@@ -50,6 +50,13 @@ class MoleculeGeometryOptimizerPrivate;
 class CHEMKIT_MD_EXPORT MoleculeGeometryOptimizer
 {
 public:
+    // enumerations
+    enum Algorithm {
+        SteepestDescent,
+        ConjugateGradient,
+        Lbfgs
+    };
+
     // construction and destruction
     MoleculeGeometryOptimizer(Molecule *molecule = 0);
     ~MoleculeGeometryOptimizer();
@@ -59,6 +66,16 @@ public:
     Molecule* molecule() const;
     bool setForceField(const std::string &forceField);
     std::string forceField() const;
+    void setThreadCount(size_t count);
+    size_t threadCount() const;
+    void setAlgorithm(Algorithm algorithm);
+    Algorithm algorithm() const;
+    void setGradientTolerance(Real tolerance);
+    Real gradientTolerance() const;
+    void setEnergyTolerance(Real tolerance);
+    Real energyTolerance() const;
+    void setMaximumIterations(size_t count);
+    size_t maximumIterations() const;
 
     // energy
     Real energy() const;
@@ -67,8 +84,11 @@ public:
     bool setup();
     void step();
     bool converged();
+    bool isStalled() const;
     bool optimize();
     void writeCoordinates();
+    size_t iterationCount() const;
+    size_t evaluationCount() const;
 
     // error handling
     std::string errorString() const;
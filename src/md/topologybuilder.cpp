@@ -72,6 +72,7 @@ class TopologyBuilderPrivate
 public:
     std::string atomTyper;
     std::string partialChargeModel;
+    bool nonbondedInteractionsEnabled;
     boost::shared_ptr<Topology> topology;
 };
 
@@ -105,6 +106,7 @@ public:
 TopologyBuilder::TopologyBuilder()
     : d(new TopologyBuilderPrivate)
 {
+    d->nonbondedInteractionsEnabled = true;
     d->topology = boost::make_shared<Topology>();
 }
 
@@ -143,6 +145,26 @@ bool TopologyBuilder::setPartialChargeModel(const std::string &model)
     return true;
 }
 
+/// Sets whether nonbonded interactions are added to the topology
+/// to \p enabled. The default is \c true.
+///
+/// Enumerating every nonbonded pair scales quadratically with the
+/// number of atoms. Force fields using a nonbonded cutoff find their
+/// pairs with a neighbor list instead and disable this.
+///
+/// \see ForceField::setNonbondedCutoff()
+void TopologyBuilder::setNonbondedInteractionsEnabled(bool enabled)
+{
+    d->nonbondedInteractionsEnabled = enabled;
+}
+
+/// Returns \c true if nonbonded interactions are added to the
+/// topology.
+bool TopologyBuilder::nonbondedInteractionsEnabled() const
+{
+    return d->nonbondedInteractionsEnabled;
+}
+
 // --- Topology ------------------------------------------------------------ //
 /// Adds \p molecule to the topology.
 void TopologyBuilder::addMolecule(const Molecule *molecule)
@@ -288,6 +310,10 @@ void TopologyBuilder::addMolecule(const Molecule *molecule)
     }
 
     // add nonbonded interactions
+    if(!d->nonbondedInteractionsEnabled){
+        return;
+    }
+
     std::vector<const Atom *> atoms(molecule->atoms().begin(), molecule->atoms().end());
     for(size_t i = 0; i < atoms.size(); i++){
         for(size_t j = i + 1; j < atoms.size(); j++){
@@ -48,6 +48,7 @@ class TrajectoryPrivate
 {
 public:
     size_t size;
+    Trajectory::CoordinatePrecision coordinatePrecision;
     std::vector<TrajectoryFrame *> frames;
 };
 
@@ -63,6 +64,11 @@ public:
 /// Trajectories are usually associated with a Topology which contains
 /// the atomic properties and atomic interactions for a system.
 ///
+/// By default the coordinates of each frame are stored in double
+/// precision. Long trajectories of large systems can instead store
+/// single precision coordinates to halve the memory needed. See
+/// setCoordinatePrecision().
+///
 /// \see Topology, TrajectoryFrame, TrajectoryFile
 
 // --- Construction and Destruction ---------------------------------------- //
@@ -71,6 +77,7 @@ Trajectory::Trajectory(size_t size)
     : d(new TrajectoryPrivate)
 {
     d->size = size;
+    d->coordinatePrecision = DoublePrecision;
 }
 
 /// Destroys the trajectory object.
@@ -106,11 +113,35 @@ bool Trajectory::isEmpty() const
     return frameCount() == 0;
 }
 
+/// Sets the precision used to store the coordinates of each frame
+/// to \p precision. Any existing frames are converted to the new
+/// precision. The default is \c DoublePrecision.
+///
+/// With \c SinglePrecision the coordinates are stored in a
+/// PackedCoordinates<float> object and can be accessed without
+/// copying through TrajectoryFrame::packedCoordinates().
+void Trajectory::setCoordinatePrecision(CoordinatePrecision precision)
+{
+    d->coordinatePrecision = precision;
+
+    foreach(TrajectoryFrame *frame, d->frames){
+        frame->setCoordinatePrecision(precision);
+    }
+}
+
+/// Returns the precision used to store the coordinates of each
+/// frame.
+Trajectory::CoordinatePrecision Trajectory::coordinatePrecision() const
+{
+    return d->coordinatePrecision;
+}
+
 // --- Frames -------------------------------------------------------------- //
 /// Adds a new frame to the trajectory.
 TrajectoryFrame* Trajectory::addFrame()
 {
     TrajectoryFrame *frame = new TrajectoryFrame(this, d->size);
+    frame->setCoordinatePrecision(d->coordinatePrecision);
     d->frames.push_back(frame);
     return frame;
 }
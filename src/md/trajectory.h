@@ -48,6 +48,12 @@ class TrajectoryPrivate;
 class CHEMKIT_MD_EXPORT Trajectory
 {
 public:
+    // enumerations
+    enum CoordinatePrecision {
+        DoublePrecision,
+        SinglePrecision
+    };
+
     // construction and destruction
     Trajectory(size_t size = 0);
     ~Trajectory();
@@ -56,6 +62,8 @@ public:
     void resize(size_t size);
     size_t size() const;
     bool isEmpty() const;
+    void setCoordinatePrecision(CoordinatePrecision precision);
+    CoordinatePrecision coordinatePrecision() const;
 
     // frames
     TrajectoryFrame* addFrame();
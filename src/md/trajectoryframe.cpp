@@ -39,12 +39,24 @@
 #include <algorithm>
 
 #include <chemkit/unitcell.h>
+#include <chemkit/packedcoordinates.h>
 #include <chemkit/cartesiancoordinates.h>
 
 #include "trajectory.h"
 
 namespace chemkit {
 
+namespace {
+
+// Used for the double precision coordinates which are owned by the
+// frame itself.
+struct NullDeleter
+{
+    void operator()(const CartesianCoordinates *) const { }
+};
+
+} // end anonymous namespace
+
 // === TrajectoryFramePrivate ============================================== //
 class TrajectoryFramePrivate
 {
@@ -52,6 +64,7 @@ public:
     Trajectory *trajectory;
     Real time;
     CartesianCoordinates *coordinates;
+    PackedCoordinates<float> *packedCoordinates;
     UnitCell *unitCell;
 };
 
@@ -64,6 +77,11 @@ public:
 /// TrajectoryFrame objects are created with the
 /// Trajectory::addFrame() method and destroyed with the
 /// Trajectory::removeFrame() method.
+///
+/// If the trajectory uses single precision coordinates the positions
+/// are stored in a PackedCoordinates<float> object which can be
+/// accessed without copying with packedCoordinates(). Only one of the
+/// two representations is stored at a time.
 
 // --- Construction and Destruction ---------------------------------------- //
 /// Creates a new trajectory frame.
@@ -73,6 +91,7 @@ TrajectoryFrame::TrajectoryFrame(Trajectory *trajectory, size_t size)
     d->trajectory = trajectory;
     d->time = 0;
     d->coordinates = new CartesianCoordinates(size);
+    d->packedCoordinates = 0;
     d->unitCell = 0;
 }
 
@@ -80,6 +99,7 @@ TrajectoryFrame::TrajectoryFrame(Trajectory *trajectory, size_t size)
 TrajectoryFrame::~TrajectoryFrame()
 {
     delete d->coordinates;
+    delete d->packedCoordinates;
     delete d->unitCell;
     delete d;
 }
@@ -88,19 +108,28 @@ TrajectoryFrame::~TrajectoryFrame()
 /// Sets the number of coordinates in the frame to \p size.
 void TrajectoryFrame::resize(size_t size)
 {
-    d->coordinates->resize(size);
+    if(d->packedCoordinates){
+        d->packedCoordinates->resize(size);
+    }
+    else{
+        d->coordinates->resize(size);
+    }
 }
 
 /// Returns the number of coordinates in the frame.
 size_t TrajectoryFrame::size() const
 {
+    if(d->packedCoordinates){
+        return d->packedCoordinates->size();
+    }
+
     return d->coordinates->size();
 }
 
 /// Returns \c true if the frame contains no coordinates.
 bool TrajectoryFrame::isEmpty() const
 {
-    return d->coordinates->isEmpty();
+    return size() == 0;
 }
 
 /// Returns the index of the frame in the trajectory.
@@ -117,6 +146,22 @@ Trajectory* TrajectoryFrame::trajectory() const
     return d->trajectory;
 }
 
+/// Sets the precision used to store the coordinates to \p precision.
+void TrajectoryFrame::setCoordinatePrecision(Trajectory::CoordinatePrecision precision)
+{
+    if(precision == Trajectory::SinglePrecision && !d->packedCoordinates){
+        d->packedCoordinates = new PackedCoordinates<float>(d->coordinates);
+        delete d->coordinates;
+        d->coordinates = 0;
+    }
+    else if(precision == Trajectory::DoublePrecision && d->packedCoordinates){
+        d->coordinates = d->packedCoordinates->toCartesianCoordinates();
+
+        delete d->packedCoordinates;
+        d->packedCoordinates = 0;
+    }
+}
+
 // --- Time ---------------------------------------------------------------- //
 /// Sets the time for the trajectory frame to \p time.
 void TrajectoryFrame::setTime(Real time)
@@ -134,19 +179,56 @@ Real TrajectoryFrame::time() const
 /// Sets the coordinates at \p index to \p position.
 void TrajectoryFrame::setPosition(size_t index, const Point3 &position)
 {
-    d->coordinates->setPosition(index, position);
+    if(d->packedCoordinates){
+        d->packedCoordinates->setPosition(index, position);
+    }
+    else{
+        d->coordinates->setPosition(index, position);
+    }
 }
 
 /// Returns the position at \p index.
 Point3 TrajectoryFrame::position(size_t index) const
 {
+    if(d->packedCoordinates){
+        return d->packedCoordinates->position(index);
+    }
+
     return d->coordinates->position(index);
 }
 
 /// Returns the coordinates for the frame.
-const CartesianCoordinates* TrajectoryFrame::coordinates() const
+///
+/// For double precision frames the returned object refers to the
+/// coordinates stored in the frame. For single precision frames a
+/// new double precision copy of the coordinates is returned which is
+/// owned by the caller and does not see later changes to the frame.
+/// Use packedCoordinates() to access single precision coordinates
+/// without copying.
+boost::shared_ptr<const CartesianCoordinates> TrajectoryFrame::coordinates() const
 {
-    return d->coordinates;
+    if(d->packedCoordinates){
+        return boost::shared_ptr<const CartesianCoordinates>(d->packedCoordinates->toCartesianCoordinates());
+    }
+
+    return boost::shared_ptr<const CartesianCoordinates>(d->coordinates, NullDeleter());
+}
+
+/// Returns a view of the single precision coordinates for the frame.
+/// If the frame does not use single precision coordinates an empty
+/// view is returned.
+///
+/// The view refers to the coordinates stored in the frame and
+/// remains valid until the frame is resized or destroyed.
+///
+/// \see Trajectory::setCoordinatePrecision()
+PackedCoordinatesView<float> TrajectoryFrame::packedCoordinates() const
+{
+    if(!d->packedCoordinates){
+        return PackedCoordinatesView<float>();
+    }
+
+    return d->packedCoordinates->view();
 }
 
 // --- Unit Cell ----------------------------------------------------------- //
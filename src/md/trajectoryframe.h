@@ -38,13 +38,17 @@
 
 #include "md.h"
 
+#include <boost/shared_ptr.hpp>
+
 #include <chemkit/point3.h>
+#include <chemkit/packedcoordinatesview.h>
+
+#include "trajectory.h"
 
 namespace chemkit {
 
 class UnitCell;
 class CartesianCoordinates;
-class Trajectory;
 class TrajectoryFramePrivate;
 
 class CHEMKIT_MD_EXPORT TrajectoryFrame
@@ -63,7 +67,8 @@ public:
     // coordinates
     void setPosition(size_t index, const Point3 &position);
     Point3 position(size_t index) const;
-    const CartesianCoordinates* coordinates() const;
+    boost::shared_ptr<const CartesianCoordinates> coordinates() const;
+    PackedCoordinatesView<float> packedCoordinates() const;
 
     // unit cell
     void setUnitCell(UnitCell *cell);
@@ -75,6 +80,7 @@ private:
     ~TrajectoryFrame();
 
     void resize(size_t size);
+    void setCoordinatePrecision(Trajectory::CoordinatePrecision precision);
 
     friend class Trajectory;
 
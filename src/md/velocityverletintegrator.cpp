@@ -0,0 +1,139 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "velocityverletintegrator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <chemkit/cartesiancoordinates.h>
+
+namespace chemkit {
+
+// === VelocityVerletIntegrator ============================================ //
+/// \class VelocityVerletIntegrator velocityverletintegrator.h chemkit/velocityverletintegrator.h
+/// \ingroup chemkit-md
+/// \brief The VelocityVerletIntegrator class integrates the equations
+///        of motion with the velocity Verlet algorithm.
+///
+/// Without a thermostat the total energy of the system is conserved.
+/// If a coupling time is set the velocities are rescaled after each
+/// step with the Berendsen thermostat towards temperature().
+///
+/// The following example runs a thousand steps of dynamics for a
+/// molecule with the UFF force field and keeps every tenth frame.
+///
+/// \code
+/// boost::shared_ptr<ForceField> forceField(ForceField::create("uff"));
+/// forceField->setTopologyFromMolecule(molecule);
+/// forceField->setup();
+///
+/// VelocityVerletIntegrator integrator;
+/// integrator.setPotential(forceField);
+/// integrator.setCoordinates(molecule->coordinates());
+/// integrator.setTrajectory(boost::make_shared<Trajectory>());
+/// integrator.setFrameInterval(10);
+/// integrator.run(1000);
+/// \endcode
+
+// --- Construction and Destruction ---------------------------------------- //
+/// Creates a new velocity Verlet integrator.
+VelocityVerletIntegrator::VelocityVerletIntegrator()
+    : DynamicsIntegrator(),
+      m_couplingTime(0)
+{
+}
+
+/// Destroys the integrator.
+VelocityVerletIntegrator::~VelocityVerletIntegrator()
+{
+}
+
+// --- Properties ---------------------------------------------------------- //
+/// Sets the coupling time of the Berendsen thermostat to \p time
+/// femtoseconds. If \p time is \c 0 the thermostat is disabled. The
+/// default is \c 0.
+void VelocityVerletIntegrator::setCouplingTime(Real time)
+{
+    m_couplingTime = time;
+}
+
+/// Returns the coupling time of the thermostat in femtoseconds.
+Real VelocityVerletIntegrator::couplingTime() const
+{
+    return m_couplingTime;
+}
+
+// --- Integration --------------------------------------------------------- //
+void VelocityVerletIntegrator::step()
+{
+    CartesianCoordinates *coordinates = this->coordinates();
+    std::vector<Vector3> &velocities = velocityBuffer();
+    Real timestep = this->timestep();
+
+    // half kick and drift
+    const std::vector<Vector3> &initialAccelerations = accelerations();
+    for(size_t i = 0; i < velocities.size(); i++){
+        velocities[i] += 0.5 * timestep * initialAccelerations[i];
+        coordinates->setPosition(i, coordinates->position(i) + timestep * velocities[i]);
+    }
+
+    // half kick with the new accelerations
+    updateAccelerations();
+    const std::vector<Vector3> &finalAccelerations = accelerations();
+    for(size_t i = 0; i < velocities.size(); i++){
+        velocities[i] += 0.5 * timestep * finalAccelerations[i];
+    }
+
+    // berendsen thermostat
+    if(m_couplingTime > 0){
+        Real temperature = kineticTemperature();
+
+        // there is nothing to rescale for a system at rest and the
+        // scale factor is clamped so that coupling times shorter than
+        // the timestep can not produce a negative square root
+        if(temperature > 0){
+            Real factor = 1 + timestep / m_couplingTime * (this->temperature() / temperature - 1);
+            Real scale = std::sqrt(std::max(factor, Real(0)));
+
+            for(size_t i = 0; i < velocities.size(); i++){
+                velocities[i] *= scale;
+            }
+        }
+    }
+}
+
+} // end chemkit namespace
@@ -39,7 +39,7 @@
 
 #include <chemkit/topology.h>
 #include <chemkit/constants.h>
-#include <chemkit/cartesiancoordinates.h>
+#include <chemkit/geometry.h>
 
 // === AmberCalculation ==================================================== //
 AmberCalculation::AmberCalculation(int type, int atomCount, int parameterCount)
@@ -49,7 +49,7 @@ AmberCalculation::AmberCalculation(int type, int atomCount, int parameterCount)
 
 // === AmberBondCalculation ================================================ //
 AmberBondCalculation::AmberBondCalculation(size_t a, size_t b)
-    : AmberCalculation(BondStrech, 2, 2)
+    : AmberCalculation(BondStrech, AtomCount, ParameterCount)
 {
     setAtom(0, a);
     setAtom(1, b);
@@ -71,42 +71,51 @@ bool AmberBondCalculation::setup(const AmberParameters *parameters)
     return true;
 }
 
-chemkit::Real AmberBondCalculation::energy(const chemkit::CartesianCoordinates *coordinates) const
+const chemkit::ForceFieldKernel* AmberBondCalculation::kernel() const
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
+    static const chemkit::ForceFieldKernelAdaptor<AmberBondCalculation> kernel;
+    return &kernel;
+}
+
+chemkit::Real AmberBondCalculation::evaluateEnergy(const chemkit::Point3 *positions,
+                                                   const size_t *atoms,
+                                                   const chemkit::Real *parameters)
+{
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
 
-    chemkit::Real kb = parameter(0);
-    chemkit::Real r0 = parameter(1);
-    chemkit::Real r = coordinates->distance(a, b);
+    chemkit::Real kb = parameters[0];
+    chemkit::Real r0 = parameters[1];
+    chemkit::Real r = (a - b).norm();
     chemkit::Real dr = r - r0;
 
     return kb * (dr*dr);
 }
 
-std::vector<chemkit::Vector3> AmberBondCalculation::gradient(const chemkit::CartesianCoordinates *coordinates) const
+void AmberBondCalculation::evaluateGradient(const chemkit::Point3 *positions,
+                                            const size_t *atoms,
+                                            const chemkit::Real *parameters,
+                                            chemkit::Vector3 *gradient)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
 
-    chemkit::Real kb = parameter(0);
-    chemkit::Real r0 = parameter(1);
-    chemkit::Real r = coordinates->distance(a, b);
+    chemkit::Real kb = parameters[0];
+    chemkit::Real r0 = parameters[1];
+    chemkit::Real r = (a - b).norm();
 
     // dE/dr
     chemkit::Real de_dr = 2.0 * kb * (r - r0);
 
-    boost::array<chemkit::Vector3, 2> gradient = coordinates->distanceGradient(a, b);
+    boost::array<chemkit::Vector3, 2> distanceGradient = chemkit::geometry::distanceGradient(a, b);
 
-    gradient[0] *= de_dr;
-    gradient[1] *= de_dr;
-
-    return std::vector<chemkit::Vector3>(gradient.begin(), gradient.end());
+    gradient[0] = distanceGradient[0] * de_dr;
+    gradient[1] = distanceGradient[1] * de_dr;
 }
 
 // === AmberAngleCalculation =============================================== //
 AmberAngleCalculation::AmberAngleCalculation(size_t a, size_t b, size_t c)
-    : AmberCalculation(AngleBend, 3, 2)
+    : AmberCalculation(AngleBend, AtomCount, ParameterCount)
 {
     setAtom(0, a);
     setAtom(1, b);
@@ -130,45 +139,54 @@ bool AmberAngleCalculation::setup(const AmberParameters *parameters)
     return true;
 }
 
-chemkit::Real AmberAngleCalculation::energy(const chemkit::CartesianCoordinates *coordinates) const
+const chemkit::ForceFieldKernel* AmberAngleCalculation::kernel() const
+{
+    static const chemkit::ForceFieldKernelAdaptor<AmberAngleCalculation> kernel;
+    return &kernel;
+}
+
+chemkit::Real AmberAngleCalculation::evaluateEnergy(const chemkit::Point3 *positions,
+                                                    const size_t *atoms,
+                                                    const chemkit::Real *parameters)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+    const chemkit::Point3 &c = positions[atoms[2]];
 
-    chemkit::Real ka = parameter(0);
-    chemkit::Real theta0 = parameter(1);
-    chemkit::Real theta = coordinates->angle(a, b, c);
+    chemkit::Real ka = parameters[0];
+    chemkit::Real theta0 = parameters[1];
+    chemkit::Real theta = chemkit::geometry::angle(a, b, c);
     chemkit::Real dt = theta - theta0;
 
     return ka * (dt*dt);
 }
 
-std::vector<chemkit::Vector3> AmberAngleCalculation::gradient(const chemkit::CartesianCoordinates *coordinates) const
+void AmberAngleCalculation::evaluateGradient(const chemkit::Point3 *positions,
+                                             const size_t *atoms,
+                                             const chemkit::Real *parameters,
+                                             chemkit::Vector3 *gradient)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+    const chemkit::Point3 &c = positions[atoms[2]];
 
-    chemkit::Real ka = parameter(0);
-    chemkit::Real theta0 = parameter(1);
-    chemkit::Real theta = coordinates->angle(a, b, c);
+    chemkit::Real ka = parameters[0];
+    chemkit::Real theta0 = parameters[1];
+    chemkit::Real theta = chemkit::geometry::angle(a, b, c);
 
     // dE/dtheta
     chemkit::Real de_dtheta = 2.0 * ka * (theta - theta0);
 
-    boost::array<chemkit::Vector3, 3> gradient = coordinates->angleGradient(a, b, c);
-
-    gradient[0] *= de_dtheta;
-    gradient[1] *= de_dtheta;
-    gradient[2] *= de_dtheta;
+    boost::array<chemkit::Vector3, 3> angleGradient = chemkit::geometry::angleGradient(a, b, c);
 
-    return std::vector<chemkit::Vector3>(gradient.begin(), gradient.end());
+    gradient[0] = angleGradient[0] * de_dtheta;
+    gradient[1] = angleGradient[1] * de_dtheta;
+    gradient[2] = angleGradient[2] * de_dtheta;
 }
 
 // === AmberTorsionCalculation ============================================= //
 AmberTorsionCalculation::AmberTorsionCalculation(size_t a, size_t b, size_t c, size_t d)
-    : AmberCalculation(Torsion, 4, 8)
+    : AmberCalculation(Torsion, AtomCount, ParameterCount)
 {
     setAtom(0, a);
     setAtom(1, b);
@@ -203,23 +221,31 @@ bool AmberTorsionCalculation::setup(const AmberParameters *parameters)
     return true;
 }
 
-chemkit::Real AmberTorsionCalculation::energy(const chemkit::CartesianCoordinates *coordinates) const
+const chemkit::ForceFieldKernel* AmberTorsionCalculation::kernel() const
+{
+    static const chemkit::ForceFieldKernelAdaptor<AmberTorsionCalculation> kernel;
+    return &kernel;
+}
+
+chemkit::Real AmberTorsionCalculation::evaluateEnergy(const chemkit::Point3 *positions,
+                                                      const size_t *atoms,
+                                                      const chemkit::Real *parameters)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
-    size_t d = atom(3);
-
-    chemkit::Real V1 = parameter(0);
-    chemkit::Real V2 = parameter(1);
-    chemkit::Real V3 = parameter(2);
-    chemkit::Real V4 = parameter(3);
-    chemkit::Real gamma1 = parameter(4);
-    chemkit::Real gamma2 = parameter(5);
-    chemkit::Real gamma3 = parameter(6);
-    chemkit::Real gamma4 = parameter(7);
-
-    chemkit::Real angle = coordinates->torsionAngle(a, b, c, d);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+    const chemkit::Point3 &c = positions[atoms[2]];
+    const chemkit::Point3 &d = positions[atoms[3]];
+
+    chemkit::Real V1 = parameters[0];
+    chemkit::Real V2 = parameters[1];
+    chemkit::Real V3 = parameters[2];
+    chemkit::Real V4 = parameters[3];
+    chemkit::Real gamma1 = parameters[4];
+    chemkit::Real gamma2 = parameters[5];
+    chemkit::Real gamma3 = parameters[6];
+    chemkit::Real gamma4 = parameters[7];
+
+    chemkit::Real angle = chemkit::geometry::torsionAngle(a, b, c, d);
 
     chemkit::Real energy = 0;
     energy += V1 * (1.0 + cos((1.0 * angle - gamma1) * chemkit::constants::DegreesToRadians));
@@ -230,23 +256,26 @@ chemkit::Real AmberTorsionCalculation::energy(const chemkit::CartesianCoordinate
     return energy;
 }
 
-std::vector<chemkit::Vector3> AmberTorsionCalculation::gradient(const chemkit::CartesianCoordinates *coordinates) const
+void AmberTorsionCalculation::evaluateGradient(const chemkit::Point3 *positions,
+                                               const size_t *atoms,
+                                               const chemkit::Real *parameters,
+                                               chemkit::Vector3 *gradient)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
-    size_t d = atom(3);
-
-    chemkit::Real V1 = parameter(0);
-    chemkit::Real V2 = parameter(1);
-    chemkit::Real V3 = parameter(2);
-    chemkit::Real V4 = parameter(3);
-    chemkit::Real gamma1 = parameter(4);
-    chemkit::Real gamma2 = parameter(5);
-    chemkit::Real gamma3 = parameter(6);
-    chemkit::Real gamma4 = parameter(7);
-
-    chemkit::Real phi = coordinates->torsionAngle(a, b, c, d);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+    const chemkit::Point3 &c = positions[atoms[2]];
+    const chemkit::Point3 &d = positions[atoms[3]];
+
+    chemkit::Real V1 = parameters[0];
+    chemkit::Real V2 = parameters[1];
+    chemkit::Real V3 = parameters[2];
+    chemkit::Real V4 = parameters[3];
+    chemkit::Real gamma1 = parameters[4];
+    chemkit::Real gamma2 = parameters[5];
+    chemkit::Real gamma3 = parameters[6];
+    chemkit::Real gamma4 = parameters[7];
+
+    chemkit::Real phi = chemkit::geometry::torsionAngle(a, b, c, d);
 
     // dE/dphi
     chemkit::Real de_dphi = 0;
@@ -256,19 +285,17 @@ std::vector<chemkit::Vector3> AmberTorsionCalculation::gradient(const chemkit::C
     de_dphi += V4 * (-sin((4.0 * phi - gamma4) * chemkit::constants::DegreesToRadians) * 4.0);
     de_dphi *= chemkit::constants::DegreesToRadians;
 
-    boost::array<chemkit::Vector3, 4> gradient = coordinates->torsionAngleGradient(a, b, c, d);
-
-    gradient[0] *= de_dphi;
-    gradient[1] *= de_dphi;
-    gradient[2] *= de_dphi;
-    gradient[3] *= de_dphi;
+    boost::array<chemkit::Vector3, 4> torsionGradient = chemkit::geometry::torsionAngleGradient(a, b, c, d);
 
-    return std::vector<chemkit::Vector3>(gradient.begin(), gradient.end());
+    gradient[0] = torsionGradient[0] * de_dphi;
+    gradient[1] = torsionGradient[1] * de_dphi;
+    gradient[2] = torsionGradient[2] * de_dphi;
+    gradient[3] = torsionGradient[3] * de_dphi;
 }
 
 // === AmberNonbondedCalculation =========================================== //
 AmberNonbondedCalculation::AmberNonbondedCalculation(size_t a, size_t b)
-    : AmberCalculation(VanDerWaals | Electrostatic, 2, 2)
+    : AmberCalculation(VanDerWaals | Electrostatic, AtomCount, ParameterCount)
 {
     setAtom(0, a);
     setAtom(1, b);
@@ -276,6 +303,9 @@ AmberNonbondedCalculation::AmberNonbondedCalculation(size_t a, size_t b)
 
 bool AmberNonbondedCalculation::setup(const AmberParameters *parameters)
 {
+    setParameter(2, topology()->charge(atom(0)));
+    setParameter(3, topology()->charge(atom(1)));
+
     std::string typeA = atomType(0);
     std::string typeB = atomType(1);
 
@@ -285,55 +315,83 @@ bool AmberNonbondedCalculation::setup(const AmberParameters *parameters)
         return false;
     }
 
-    chemkit::Real epsilon = parametersA->wellDepth + parametersB->wellDepth;
-    chemkit::Real sigma = parametersA->vanDerWaalsRadius + parametersB->vanDerWaalsRadius;
+    chemkit::Real combinedParameters[2];
+    combineParameters(parametersA, parametersB, combinedParameters);
 
-    setParameter(0, epsilon);
-    setParameter(1, sigma);
+    setParameter(0, combinedParameters[0]);
+    setParameter(1, combinedParameters[1]);
 
     return true;
 }
 
-chemkit::Real AmberNonbondedCalculation::energy(const chemkit::CartesianCoordinates *coordinates) const
+// Combines the nonbonded parameters of two atoms into the epsilon
+// and sigma parameters for their interaction.
+void AmberNonbondedCalculation::combineParameters(const AmberNonbondedParameters *parametersA,
+                                                  const AmberNonbondedParameters *parametersB,
+                                                  chemkit::Real *parameters)
+{
+    // epsilon
+    parameters[0] = parametersA->wellDepth + parametersB->wellDepth;
+
+    // sigma
+    parameters[1] = parametersA->vanDerWaalsRadius + parametersB->vanDerWaalsRadius;
+}
+
+const chemkit::ForceFieldKernel* AmberNonbondedCalculation::kernel() const
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-
-    chemkit::Real epsilon = parameter(0);
-    chemkit::Real sigma = parameter(1);
-    chemkit::Real qa = topology()->charge(a);
-    chemkit::Real qb = topology()->charge(b);
-    chemkit::Real r = coordinates->distance(a, b);
+    static const chemkit::ForceFieldKernelAdaptor<AmberNonbondedCalculation> kernel;
+    return &kernel;
+}
+
+chemkit::Real AmberNonbondedCalculation::evaluateEnergy(const chemkit::Point3 *positions,
+                                                        const size_t *atoms,
+                                                        const chemkit::Real *parameters)
+{
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+
+    chemkit::Real epsilon = parameters[0];
+    chemkit::Real sigma = parameters[1];
+    chemkit::Real qa = parameters[2];
+    chemkit::Real qb = parameters[3];
+    chemkit::Real r = (a - b).norm();
     chemkit::Real e0 = 1;
 
-    chemkit::Real vanDerWaalsTerm = epsilon * (pow(sigma/r, 12) - 2 * pow(sigma/r, 6));
+    chemkit::Real sr = sigma / r;
+    chemkit::Real sr2 = sr * sr;
+    chemkit::Real sr6 = sr2 * sr2 * sr2;
+
+    chemkit::Real vanDerWaalsTerm = epsilon * (sr6 * sr6 - 2 * sr6);
     chemkit::Real electrostaticTerm = (qa * qb) / (4.0 * chemkit::constants::Pi * e0 * r);
 
     return vanDerWaalsTerm + electrostaticTerm;
 }
 
-std::vector<chemkit::Vector3> AmberNonbondedCalculation::gradient(const chemkit::CartesianCoordinates *coordinates) const
+void AmberNonbondedCalculation::evaluateGradient(const chemkit::Point3 *positions,
+                                                 const size_t *atoms,
+                                                 const chemkit::Real *parameters,
+                                                 chemkit::Vector3 *gradient)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
 
-    chemkit::Real epsilon = parameter(0);
-    chemkit::Real sigma = parameter(1);
-    chemkit::Real qa = topology()->charge(a);
-    chemkit::Real qb = topology()->charge(b);
+    chemkit::Real epsilon = parameters[0];
+    chemkit::Real sigma = parameters[1];
+    chemkit::Real qa = parameters[2];
+    chemkit::Real qb = parameters[3];
     chemkit::Real e0 = 1;
     chemkit::Real pi = chemkit::constants::Pi;
 
-    chemkit::Real r = coordinates->distance(a, b);
+    chemkit::Real r = (a - b).norm();
     chemkit::Real sr = sigma / r;
+    chemkit::Real sr2 = sr * sr;
+    chemkit::Real sr5 = sr2 * sr2 * sr;
 
     // dE/dr
-    chemkit::Real de_dr = (-12 * epsilon * sigma / pow(r, 2) * (pow(sr, 11) - pow(sr, 5))) - ((qa * qb) / (4.0 * pi * e0 * pow(r, 2)));
-
-    boost::array<chemkit::Vector3, 2> gradient = coordinates->distanceGradient(a, b);
+    chemkit::Real de_dr = (-12 * epsilon * sigma / (r * r) * (sr5 * sr5 * sr - sr5)) - ((qa * qb) / (4.0 * pi * e0 * (r * r)));
 
-    gradient[0] *= de_dr;
-    gradient[1] *= de_dr;
+    boost::array<chemkit::Vector3, 2> distanceGradient = chemkit::geometry::distanceGradient(a, b);
 
-    return std::vector<chemkit::Vector3>(gradient.begin(), gradient.end());
+    gradient[0] = distanceGradient[0] * de_dr;
+    gradient[1] = distanceGradient[1] * de_dr;
 }
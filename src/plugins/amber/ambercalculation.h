@@ -36,9 +36,11 @@
 #ifndef AMBERCALCULATION_H
 #define AMBERCALCULATION_H
 
+#include <chemkit/forcefieldkernel.h>
 #include <chemkit/forcefieldcalculation.h>
 
 class AmberParameters;
+struct AmberNonbondedParameters;
 
 class AmberCalculation : public chemkit::ForceFieldCalculation
 {
@@ -52,41 +54,93 @@ protected:
 class AmberBondCalculation : public AmberCalculation
 {
 public:
+    enum {
+        AtomCount = 2,
+        ParameterCount = 2
+    };
+
     AmberBondCalculation(size_t a, size_t b);
 
     bool setup(const AmberParameters *parameters);
-    chemkit::Real energy(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
-    std::vector<chemkit::Vector3> gradient(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    const chemkit::ForceFieldKernel* kernel() const CHEMKIT_OVERRIDE;
+
+    static chemkit::Real evaluateEnergy(const chemkit::Point3 *positions,
+                                        const size_t *atoms,
+                                        const chemkit::Real *parameters);
+    static void evaluateGradient(const chemkit::Point3 *positions,
+                                 const size_t *atoms,
+                                 const chemkit::Real *parameters,
+                                 chemkit::Vector3 *gradient);
 };
 
 class AmberAngleCalculation : public AmberCalculation
 {
 public:
+    enum {
+        AtomCount = 3,
+        ParameterCount = 2
+    };
+
     AmberAngleCalculation(size_t a, size_t b, size_t c);
 
     bool setup(const AmberParameters *parameters);
-    chemkit::Real energy(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
-    std::vector<chemkit::Vector3> gradient(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    const chemkit::ForceFieldKernel* kernel() const CHEMKIT_OVERRIDE;
+
+    static chemkit::Real evaluateEnergy(const chemkit::Point3 *positions,
+                                        const size_t *atoms,
+                                        const chemkit::Real *parameters);
+    static void evaluateGradient(const chemkit::Point3 *positions,
+                                 const size_t *atoms,
+                                 const chemkit::Real *parameters,
+                                 chemkit::Vector3 *gradient);
 };
 
 class AmberTorsionCalculation : public AmberCalculation
 {
 public:
+    enum {
+        AtomCount = 4,
+        ParameterCount = 8
+    };
+
     AmberTorsionCalculation(size_t a, size_t b, size_t c, size_t d);
 
     bool setup(const AmberParameters *parameters);
-    chemkit::Real energy(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
-    std::vector<chemkit::Vector3> gradient(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    const chemkit::ForceFieldKernel* kernel() const CHEMKIT_OVERRIDE;
+
+    static chemkit::Real evaluateEnergy(const chemkit::Point3 *positions,
+                                        const size_t *atoms,
+                                        const chemkit::Real *parameters);
+    static void evaluateGradient(const chemkit::Point3 *positions,
+                                 const size_t *atoms,
+                                 const chemkit::Real *parameters,
+                                 chemkit::Vector3 *gradient);
 };
 
 class AmberNonbondedCalculation : public AmberCalculation
 {
 public:
+    enum {
+        AtomCount = 2,
+        ParameterCount = 4
+    };
+
     AmberNonbondedCalculation(size_t a, size_t b);
 
     bool setup(const AmberParameters *parameters);
-    chemkit::Real energy(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
-    std::vector<chemkit::Vector3> gradient(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    const chemkit::ForceFieldKernel* kernel() const CHEMKIT_OVERRIDE;
+
+    static void combineParameters(const AmberNonbondedParameters *parametersA,
+                                  const AmberNonbondedParameters *parametersB,
+                                  chemkit::Real *parameters);
+
+    static chemkit::Real evaluateEnergy(const chemkit::Point3 *positions,
+                                        const size_t *atoms,
+                                        const chemkit::Real *parameters);
+    static void evaluateGradient(const chemkit::Point3 *positions,
+                                 const size_t *atoms,
+                                 const chemkit::Real *parameters,
+                                 chemkit::Vector3 *gradient);
 };
 
 #endif // AMBERCALCULATION_H
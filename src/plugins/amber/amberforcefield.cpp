@@ -44,19 +44,20 @@
 
 #include <chemkit/foreach.h>
 #include <chemkit/topology.h>
+#include <chemkit/forcefieldparameterscache.h>
 
 // --- Construction and Destruction ---------------------------------------- //
 AmberForceField::AmberForceField()
-    : chemkit::ForceField("amber")
+    : chemkit::ForceField("amber"),
+      m_nonbondedKernel(0)
 {
-    m_parameters = new AmberParameters;
+    m_parameters = chemkit::ForceFieldParametersCache<AmberParameters>::parameters();
 
     setFlags(chemkit::ForceField::AnalyticalGradient);
 }
 
 AmberForceField::~AmberForceField()
 {
-    delete m_parameters;
 }
 
 // --- Setup --------------------------------------------------------------- //
@@ -67,6 +68,9 @@ bool AmberForceField::setup()
         return false;
     }
 
+    // remove the calculations from a previous setup
+    clearCalculations();
+
     foreach(const chemkit::Topology::BondedInteraction &interaction, topology->bondedInteractions()){
         addCalculation(new AmberBondCalculation(interaction[0],
                                                 interaction[1]));
@@ -92,8 +96,28 @@ bool AmberForceField::setup()
 
     bool ok = true;
 
+    // nonbonded kernel for the neighbor list. as with the nonbonded
+    // calculations, atoms without parameters keep their charges.
+    if(nonbondedCutoff() > 0){
+        clearNonbondedKernels();
+
+        m_nonbondedParameters.resize(topology->size());
+
+        for(size_t i = 0; i < topology->size(); i++){
+            m_nonbondedParameters[i] = m_parameters->nonbondedParameters(topology->type(i));
+            if(!m_nonbondedParameters[i]){
+                ok = false;
+            }
+        }
+
+        chemkit::ForceFieldKernel *nonbondedKernel =
+            new chemkit::ForceFieldKernelAdaptor<AmberNonbondedCalculation>;
+        addNonbondedKernel(nonbondedKernel);
+        m_nonbondedKernel = nonbondedKernel;
+    }
+
     foreach(chemkit::ForceFieldCalculation *calculation, calculations()){
-        bool setup = static_cast<AmberCalculation *>(calculation)->setup(m_parameters);
+        bool setup = static_cast<AmberCalculation *>(calculation)->setup(m_parameters.get());
 
         if(!setup){
             ok = false;
@@ -107,5 +131,28 @@ bool AmberForceField::setup()
 
 const AmberParameters* AmberForceField::parameters() const
 {
-    return m_parameters;
+    return m_parameters.get();
+}
+
+bool AmberForceField::nonbondedParameters(const chemkit::ForceFieldKernel *kernel,
+                                          size_t a,
+                                          size_t b,
+                                          bool oneFour,
+                                          chemkit::Real *parameters) const
+{
+    CHEMKIT_UNUSED(oneFour);
+
+    if(kernel == m_nonbondedKernel){
+        const AmberNonbondedParameters *parametersA = m_nonbondedParameters[a];
+        const AmberNonbondedParameters *parametersB = m_nonbondedParameters[b];
+        if(parametersA && parametersB){
+            AmberNonbondedCalculation::combineParameters(parametersA, parametersB, parameters);
+        }
+
+        parameters[2] = topology()->charge(a);
+        parameters[3] = topology()->charge(b);
+        return true;
+    }
+
+    return false;
 }
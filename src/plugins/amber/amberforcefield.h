@@ -36,9 +36,12 @@
 #ifndef AMBERFORCEFIELD_H
 #define AMBERFORCEFIELD_H
 
+#include <boost/shared_ptr.hpp>
+
 #include <chemkit/forcefield.h>
 
 class AmberParameters;
+struct AmberNonbondedParameters;
 
 class AmberForceField : public chemkit::ForceField
 {
@@ -51,8 +54,13 @@ public:
     virtual bool setup();
     const AmberParameters* parameters() const;
 
+protected:
+    bool nonbondedParameters(const chemkit::ForceFieldKernel *kernel, size_t a, size_t b, bool oneFour, chemkit::Real *parameters) const CHEMKIT_OVERRIDE;
+
 private:
-    AmberParameters *m_parameters;
+    boost::shared_ptr<const AmberParameters> m_parameters;
+    std::vector<const AmberNonbondedParameters *> m_nonbondedParameters;
+    const chemkit::ForceFieldKernel *m_nonbondedKernel;
 };
 
 #endif // AMBERFORCEFIELD_H
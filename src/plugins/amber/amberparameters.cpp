@@ -36,6 +36,7 @@
 #include "amberparameters.h"
 
 #include <cstring>
+#include <algorithm>
 
 namespace {
 
@@ -621,12 +622,69 @@ const struct NonbondedParameters NonbondedParameters[] = {
 
 const int NonbondedParametersCount = sizeof(NonbondedParameters) / sizeof(*NonbondedParameters);
 
+// The parameter tables are indexed by a key built from the atom types
+// with the order of interchangeable types removed. Entries with the
+// same key are sorted by their position in the table.
+typedef std::pair<std::string, int> IndexEntry;
+
+std::string pairKey(const std::string &typeA, const std::string &typeB)
+{
+    return typeA < typeB ? typeA + ' ' + typeB : typeB + ' ' + typeA;
+}
+
+std::string angleKey(const std::string &typeA, const std::string &typeB, const std::string &typeC)
+{
+    return typeB + ' ' + pairKey(typeA, typeC);
+}
+
+bool indexKeyLessThan(const IndexEntry &entry, const std::string &key)
+{
+    return entry.first < key;
+}
+
+// Returns the first entry in the index with key.
+std::vector<IndexEntry>::const_iterator findKey(const std::vector<IndexEntry> &index, const std::string &key)
+{
+    std::vector<IndexEntry>::const_iterator iter =
+        std::lower_bound(index.begin(), index.end(), key, indexKeyLessThan);
+
+    if(iter != index.end() && iter->first != key){
+        return index.end();
+    }
+
+    return iter;
+}
+
 } // end anonymous namespace
 
 // === AmberParameters ===================================================== //
 // --- Construction and Destruction ---------------------------------------- //
 AmberParameters::AmberParameters()
 {
+    for(int i = 0; i < BondParametersCount; i++){
+        const struct BondParameters *parameters = &BondParameters[i];
+        m_bondIndex.push_back(IndexEntry(pairKey(parameters->typeA, parameters->typeB), i));
+    }
+
+    for(int i = 0; i < AngleParametersCount; i++){
+        const struct AngleParameters *parameters = &AngleParameters[i];
+        m_angleIndex.push_back(IndexEntry(angleKey(parameters->typeA, parameters->typeB, parameters->typeC), i));
+    }
+
+    // torsions are indexed by their two central types
+    for(int i = 0; i < TorsionParametersCount; i++){
+        const struct TorsionParameters *parameters = &TorsionParameters[i];
+        m_torsionIndex.push_back(IndexEntry(pairKey(parameters->typeB, parameters->typeC), i));
+    }
+
+    for(int i = 0; i < NonbondedParametersCount; i++){
+        m_nonbondedIndex.push_back(IndexEntry(NonbondedParameters[i].type, i));
+    }
+
+    std::sort(m_bondIndex.begin(), m_bondIndex.end());
+    std::sort(m_angleIndex.begin(), m_angleIndex.end());
+    std::sort(m_torsionIndex.begin(), m_torsionIndex.end());
+    std::sort(m_nonbondedIndex.begin(), m_nonbondedIndex.end());
 }
 
 AmberParameters::~AmberParameters()
@@ -636,48 +694,40 @@ AmberParameters::~AmberParameters()
 // --- Parameters ---------------------------------------------------------- //
 const AmberBondParameters* AmberParameters::bondParameters(const std::string &typeA, const std::string &typeB) const
 {
-    for(int i = 0; i < BondParametersCount; i++){
-        const struct BondParameters *parameters = &BondParameters[i];
-
-        if((typeA == parameters->typeA && typeB == parameters->typeB) ||
-           (typeA == parameters->typeB && (typeB == parameters->typeA))){
-            return &parameters->parameters;
-        }
+    std::vector<IndexEntry>::const_iterator iter = findKey(m_bondIndex, pairKey(typeA, typeB));
+    if(iter == m_bondIndex.end()){
+        return 0;
     }
 
-    return 0;
+    return &BondParameters[iter->second].parameters;
 }
 
 const AmberAngleParameters* AmberParameters::angleParameters(const std::string &typeA, const std::string &typeB, const std::string &typeC) const
 {
-    for(int i = 0; i < AngleParametersCount; i++){
-        const struct AngleParameters *parameters = &AngleParameters[i];
-
-        if(typeB == parameters->typeB){
-            if((typeA == parameters->typeA && typeC == parameters->typeC) ||
-               (typeA == parameters->typeC && typeC == parameters->typeA)){
-                return &parameters->parameters;
-            }
-        }
+    std::vector<IndexEntry>::const_iterator iter = findKey(m_angleIndex, angleKey(typeA, typeB, typeC));
+    if(iter == m_angleIndex.end()){
+        return 0;
     }
 
-    return 0;
+    return &AngleParameters[iter->second].parameters;
 }
 
 const AmberTorsionParameters* AmberParameters::torsionParameters(const std::string &typeA, const std::string &typeB, const std::string &typeC, const std::string &typeD) const
 {
-    for(int i = 0; i < TorsionParametersCount; i++){
-        const struct TorsionParameters *parameters = &TorsionParameters[i];
+    std::string key = pairKey(typeB, typeC);
 
-        if((typeB == parameters->typeB && typeC == parameters->typeC) ||
-           (typeC == parameters->typeB && typeB == parameters->typeC)){
-            if(strcmp("X", parameters->typeA) == 0){
-                return &parameters->parameters;
-            }
-            else if((typeA == parameters->typeA && typeD == parameters->typeD) ||
-                    (typeA == parameters->typeD && typeD == parameters->typeA)){
-                return &parameters->parameters;
-            }
+    // the first matching torsion with the same central types is used
+    for(std::vector<IndexEntry>::const_iterator iter = findKey(m_torsionIndex, key);
+        iter != m_torsionIndex.end() && iter->first == key;
+        ++iter){
+        const struct TorsionParameters *parameters = &TorsionParameters[iter->second];
+
+        if(strcmp("X", parameters->typeA) == 0){
+            return &parameters->parameters;
+        }
+        else if((typeA == parameters->typeA && typeD == parameters->typeD) ||
+                (typeA == parameters->typeD && typeD == parameters->typeA)){
+            return &parameters->parameters;
         }
     }
 
@@ -686,13 +736,10 @@ const AmberTorsionParameters* AmberParameters::torsionParameters(const std::stri
 
 const AmberNonbondedParameters* AmberParameters::nonbondedParameters(const std::string &type) const
 {
-    for(int i = 0; i < NonbondedParametersCount; i++){
-        const struct NonbondedParameters *parameters = &NonbondedParameters[i];
-
-        if(type == parameters->type){
-            return &parameters->parameters;
-        }
+    std::vector<IndexEntry>::const_iterator iter = findKey(m_nonbondedIndex, type);
+    if(iter == m_nonbondedIndex.end()){
+        return 0;
     }
 
-    return 0;
+    return &NonbondedParameters[iter->second].parameters;
 }
@@ -37,6 +37,8 @@
 #define AMBERPARAMETERS_H
 
 #include <string>
+#include <vector>
+#include <utility>
 
 #include <chemkit/chemkit.h>
 
@@ -82,6 +84,14 @@ public:
     const AmberAngleParameters* angleParameters(const std::string &typeA, const std::string &typeB, const std::string &typeC) const;
     const AmberTorsionParameters* torsionParameters(const std::string &typeA, const std::string &typeB, const std::string &typeC, const std::string &typeD) const;
     const AmberNonbondedParameters* nonbondedParameters(const std::string &type) const;
+
+private:
+    typedef std::pair<std::string, int> IndexEntry;
+
+    std::vector<IndexEntry> m_bondIndex;
+    std::vector<IndexEntry> m_angleIndex;
+    std::vector<IndexEntry> m_torsionIndex;
+    std::vector<IndexEntry> m_nonbondedIndex;
 };
 
 #endif // AMBERPARAMETERS_H
@@ -36,6 +36,8 @@
 
 #include "fp2fingerprint.h"
 
+#include <algorithm>
+
 #include <chemkit/atom.h>
 #include <chemkit/bond.h>
 #include <chemkit/ring.h>
@@ -55,114 +57,185 @@ Fp2Fingerprint::~Fp2Fingerprint()
 
 // Returns the FP2 fingerprint value for the molecule.
 chemkit::Bitset Fp2Fingerprint::value(const chemkit::Molecule *molecule) const
+{
+    Scratch scratch;
+
+    return value(molecule, scratch);
+}
+
+// Returns the FP2 fingerprint values for each molecule. The scratch
+// buffers used during fragment enumeration are shared between the
+// molecules so that they are only allocated once.
+std::vector<chemkit::Bitset> Fp2Fingerprint::value(const std::vector<const chemkit::Molecule *> &molecules) const
+{
+    Scratch scratch;
+
+    std::vector<chemkit::Bitset> values;
+    values.reserve(molecules.size());
+
+    foreach(const chemkit::Molecule *molecule, molecules){
+        values.push_back(value(molecule, scratch));
+    }
+
+    return values;
+}
+
+// Returns the FP2 fingerprint value for the molecule using the
+// buffers in scratch.
+chemkit::Bitset Fp2Fingerprint::value(const chemkit::Molecule *molecule,
+                                      Scratch &scratch) const
 {
     // create bitset
     chemkit::Bitset fingerprint(1021);
 
+    // reset per-molecule state
+    scratch.visited.assign(molecule->atomCount(), 0);
+    scratch.terminalHydrogen.assign(molecule->atomCount(), 0);
+
+    foreach(const chemkit::Atom *atom, molecule->atoms()){
+        scratch.terminalHydrogen[atom->index()] = atom->isTerminalHydrogen();
+    }
+
     foreach(const chemkit::Atom *atom, molecule->atoms()){
         // skip fragments starting at terminal hydrogens
-        if(atom->isTerminalHydrogen()){
+        if(scratch.terminalHydrogen[atom->index()]){
             continue;
         }
 
         // add each atom fragment to the fingerprint
-        addFragments(atom, fingerprint);
+        addFragments(atom, scratch, fingerprint);
     }
 
     return fingerprint;
 }
 
-// Add all fragments starting at atom to the fingerprint.
-void Fp2Fingerprint::addFragments(const chemkit::Atom *atom,
+// Add all fragments starting at firstAtom to the fingerprint.
+//
+// Fragments are enumerated depth-first with an explicit stack. Each
+// frame appends a [bond, atom] pair to the shared fragment buffer
+// which is removed again when the frame is popped. Ring closures
+// overwrite the leading bond of the fragment for the remainder of
+// the frame, so the value it had on entry is restored on pop.
+void Fp2Fingerprint::addFragments(const chemkit::Atom *firstAtom,
+                                  Scratch &scratch,
                                   chemkit::Bitset &fingerprint) const
 {
-    Fragment fragment;
-    chemkit::Bitset visited(atom->molecule()->atomCount());
-    extendFragment(fragment, 1, visited, atom, 0, atom, fingerprint);
+    const size_t MaxFragmentSize = 7;
+
+    Fragment &fragment = scratch.fragment;
+    std::vector<Frame> &stack = scratch.stack;
+
+    fragment.clear();
+    pushFrame(firstAtom, 0, scratch);
+
+    while(!stack.empty()){
+        Frame &frame = stack.back();
+        size_t depth = stack.size();
+
+        if(frame.position < frame.bonds.size()){
+            const chemkit::Bond *neighborBond = frame.bonds[frame.position++];
+            if(neighborBond == frame.bond){
+                continue; // don't retrace steps
+            }
+
+            const chemkit::Atom *neighbor = neighborBond->otherAtom(frame.atom);
+            if(scratch.terminalHydrogen[neighbor->index()]){
+                continue; // don't include terminal hydrogens
+            }
+
+            // if the neighbor is an atom that we've already visited
+            // then this fragment forms a ring
+            if(scratch.visited[neighbor->index()]){
+                if(neighbor == firstAtom){
+                    // add bond at front for the ring
+                    fragment[0] = frame.bondOrder;
+
+                    addRing(scratch, fingerprint);
+                }
+            }
+            // no ring
+            else if(depth < MaxFragmentSize){
+                // extend fragment to the next atom
+                pushFrame(neighbor, neighborBond, scratch);
+            }
+
+            continue;
+        }
+
+        // do not save C, N, O single atom fragments
+        if(fragment[0] == 0 && (depth > 1 || fragment[1] > 8 || fragment[1] < 6)){
+            fingerprint.set(canonicalHash(fragment));
+        }
+
+        // remove the atom from the fragment
+        scratch.visited[frame.atom->index()] = 0;
+        fragment.resize(fragment.size() - 2);
+        if(!fragment.empty()){
+            fragment[0] = frame.front;
+        }
+
+        stack.pop_back();
+    }
 }
 
-// Extend the fragment to atom.
-void Fp2Fingerprint::extendFragment(Fragment fragment,
-                                    size_t depth,
-                                    chemkit::Bitset visited,
-                                    const chemkit::Atom *atom,
-                                    const chemkit::Bond *bond,
-                                    const chemkit::Atom *firstAtom,
-                                    chemkit::Bitset &fingerprint) const
+// Extends the current fragment to atom through bond.
+void Fp2Fingerprint::pushFrame(const chemkit::Atom *atom,
+                               const chemkit::Bond *bond,
+                               Scratch &scratch)
 {
-    const size_t MaxFragmentSize = 7;
+    Fragment &fragment = scratch.fragment;
+
+    Frame frame;
+    frame.atom = atom;
+    frame.bond = bond;
+    frame.bonds = atom->bonds();
+    frame.position = 0;
+    frame.bondOrder = 0;
+    frame.front = fragment.empty() ? 0 : fragment[0];
 
-    chemkit::Bond::BondOrderType bondOrder = 0;
     if(bond){
-        bondOrder = bond->isAromatic() ? 5 : bond->order();
+        frame.bondOrder = bond->isAromatic() ? 5 : bond->order();
     }
 
-    fragment.push_back(bondOrder);
+    fragment.push_back(frame.bondOrder);
     fragment.push_back(atom->atomicNumber());
-    visited.set(atom->index());
+    scratch.visited[atom->index()] = 1;
 
-    foreach(const chemkit::Bond *neighborBond, atom->bonds()){
-        if(neighborBond == bond){
-            continue; // don't retrace steps
-        }
+    scratch.stack.push_back(frame);
+}
 
-        const chemkit::Atom *neighbor = neighborBond->otherAtom(atom);
-        if(neighbor->isTerminalHydrogen()){
-            continue; // don't include terminal hydrogens
-        }
+// Adds the ring formed by the current fragment to the fingerprint.
+void Fp2Fingerprint::addRing(Scratch &scratch, chemkit::Bitset &fingerprint)
+{
+    Fragment &ring = scratch.ring;
+    Fragment &canonicalRing = scratch.canonicalRing;
+    Fragment &reversedRing = scratch.reversedRing;
 
-        // if the neighbor is an atom that we've already visited
-        // then this fragment forms a ring
-        if(visited.test(neighbor->index())){
-            if(neighbor == firstAtom){
-                // add bond at front for the ring
-                fragment[0] = bondOrder;
-
-                // insert ring
-                Fragment ring = fragment;
-                Fragment canonicalRing = fragment;
-                for(size_t i = 0; i < ring.size() / 2; i++){
-                    // rotate atoms in ring
-                    std::rotate(ring.begin(), ring.begin() + 2, ring.end());
-                    if(ring > canonicalRing){
-                        canonicalRing = ring;
-                    }
-
-                    // reverse the ring
-                    Fragment reversedRing = ring;
-                    std::reverse(reversedRing.begin() + 1, reversedRing.end());
-                    if(reversedRing > canonicalRing){
-                        canonicalRing = reversedRing;
-                    }
-
-                    // add the non-ring form of all ring rotations
-                    Fragment ringCopy = ring;
-                    ringCopy[0] = 0;
-                    fingerprint.set(canonicalHash(ringCopy));
-                }
+    ring = scratch.fragment;
+    canonicalRing = scratch.fragment;
 
-                fingerprint.set(canonicalHash(canonicalRing));
-            }
+    for(size_t i = 0; i < ring.size() / 2; i++){
+        // rotate atoms in ring
+        std::rotate(ring.begin(), ring.begin() + 2, ring.end());
+        if(ring > canonicalRing){
+            canonicalRing = ring;
         }
-        // no ring
-        else{
-            if(depth < MaxFragmentSize){
-                // extend fragment to the next atom
-                extendFragment(fragment,
-                               depth+1,
-                               visited,
-                               neighbor,
-                               neighborBond,
-                               firstAtom,
-                               fingerprint);
-            }
+
+        // reverse the ring
+        reversedRing = ring;
+        std::reverse(reversedRing.begin() + 1, reversedRing.end());
+        if(reversedRing > canonicalRing){
+            canonicalRing = reversedRing;
         }
-    }
 
-    // do not save C, N, O single atom fragments
-    if(fragment[0] == 0 && (depth > 1 || fragment[1] > 8 || fragment[1] < 6)){
-        fingerprint.set(canonicalHash(fragment));
+        // add the non-ring form of all ring rotations
+        unsigned char front = ring[0];
+        ring[0] = 0;
+        fingerprint.set(canonicalHash(ring));
+        ring[0] = front;
     }
+
+    fingerprint.set(canonicalHash(canonicalRing));
 }
 
 // Returns the canonical hash value for the fragment.
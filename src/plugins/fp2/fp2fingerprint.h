@@ -38,6 +38,7 @@
 
 #include <vector>
 
+#include <chemkit/atom.h>
 #include <chemkit/molecule.h>
 #include <chemkit/fingerprint.h>
 
@@ -48,19 +49,41 @@ public:
     ~Fp2Fingerprint();
 
     chemkit::Bitset value(const chemkit::Molecule *molecule) const CHEMKIT_OVERRIDE;
+    std::vector<chemkit::Bitset> value(const std::vector<const chemkit::Molecule *> &molecules) const CHEMKIT_OVERRIDE;
 
 private:
     typedef std::vector<unsigned char> Fragment;
 
+    struct Frame
+    {
+        const chemkit::Atom *atom;
+        const chemkit::Bond *bond;
+        chemkit::Atom::BondRange bonds;
+        size_t position;
+        unsigned char bondOrder;
+        unsigned char front;
+    };
+
+    struct Scratch
+    {
+        Fragment fragment;
+        Fragment ring;
+        Fragment canonicalRing;
+        Fragment reversedRing;
+        std::vector<Frame> stack;
+        std::vector<char> visited;
+        std::vector<char> terminalHydrogen;
+    };
+
+    chemkit::Bitset value(const chemkit::Molecule *molecule,
+                          Scratch &scratch) const;
     void addFragments(const chemkit::Atom *atom,
+                      Scratch &scratch,
                       chemkit::Bitset &fingerprint) const;
-    void extendFragment(Fragment fragment,
-                        size_t depth,
-                        chemkit::Bitset visited,
-                        const chemkit::Atom *atom,
-                        const chemkit::Bond *bond,
-                        const chemkit::Atom *firstAtom,
-                        chemkit::Bitset &fingerprint) const;
+    static void pushFrame(const chemkit::Atom *atom,
+                          const chemkit::Bond *bond,
+                          Scratch &scratch);
+    static void addRing(Scratch &scratch, chemkit::Bitset &fingerprint);
     static size_t canonicalHash(const Fragment &fragment);
 };
 
@@ -40,6 +40,9 @@
 
 #include "mdlfileformat.h"
 
+#include <cstring>
+#include <algorithm>
+
 #include <boost/algorithm/string.hpp>
 
 #include <chemkit/atom.h>
@@ -111,8 +114,110 @@ bool MdlFileFormat::write(const chemkit::MoleculeFile *file, std::ostream &outpu
     return true;
 }
 
+boost::shared_ptr<chemkit::Molecule> MdlFileFormat::readNextMolecule(std::istream &input)
+{
+    boost::shared_ptr<chemkit::Molecule> molecule = readMolecule(input);
+
+    if(molecule && (name() == "sdf" || name() == "sd")){
+        readDataBlock(input, molecule.get());
+    }
+
+    return molecule;
+}
+
+bool MdlFileFormat::writeMolecule(const chemkit::Molecule *molecule, std::ostream &output)
+{
+    writeMolFile(molecule, output);
+
+    if(name() == "sdf" || name() == "sd"){
+        output << "$$$$\n";
+    }
+
+    return true;
+}
+
+size_t MdlFileFormat::recordBoundary(const char *data, size_t size, size_t position) const
+{
+    // only sdf files contain multiple records
+    if(name() != "sdf" && name() != "sd"){
+        return chemkit::MoleculeFileFormat::recordBoundary(data, size, position);
+    }
+
+    if(position == 0){
+        return 0;
+    }
+    else if(position >= size){
+        return size;
+    }
+
+    // records start after a '$$$$' line so begin scanning at the
+    // start of the line containing the character before position
+    size_t lineStart = position - 1;
+    while(lineStart > 0 && data[lineStart - 1] != '\n'){
+        lineStart--;
+    }
+
+    while(lineStart < size){
+        const char *lineEnd = static_cast<const char *>(memchr(data + lineStart, '\n', size - lineStart));
+        size_t lineEndPosition = lineEnd ? static_cast<size_t>(lineEnd - data) : size;
+
+        // skip leading white space (the reader trims each line)
+        size_t i = lineStart;
+        while(i < lineEndPosition && isspace(static_cast<unsigned char>(data[i]))){
+            i++;
+        }
+
+        if(lineEndPosition - i >= 4 && strncmp(data + i, "$$$$", 4) == 0){
+            return std::min(lineEndPosition + 1, size);
+        }
+
+        lineStart = lineEndPosition + 1;
+    }
+
+    return size;
+}
+
 // --- Internal Methods ---------------------------------------------------- //
 bool MdlFileFormat::readMolFile(std::istream &input, chemkit::MoleculeFile *file)
+{
+    boost::shared_ptr<chemkit::Molecule> molecule = readMolecule(input);
+    if(!molecule){
+        setErrorString("File is empty");
+        return false;
+    }
+
+    file->addMolecule(molecule);
+
+    return true;
+}
+
+bool MdlFileFormat::readSdfFile(std::istream &input, chemkit::MoleculeFile *file)
+{
+    while(!input.eof()){
+        // read molecule
+        boost::shared_ptr<chemkit::Molecule> molecule = readMolecule(input);
+        if(!molecule){
+            break;
+        }
+
+        // read data block
+        readDataBlock(input, molecule.get());
+
+        file->addMolecule(molecule);
+    }
+
+    // return false if we failed to read any molecules
+    if(file->moleculeCount() == 0){
+        return false;
+    }
+
+    return true;
+}
+
+// Reads a single molecule record (header, counts line, atom, bond and
+// property blocks) from input. Returns a null pointer if the end of the
+// input is reached before a complete header could be read.
+boost::shared_ptr<chemkit::Molecule> MdlFileFormat::readMolecule(std::istream &input)
 {
     // title line
     std::string title;
@@ -127,8 +232,7 @@ bool MdlFileFormat::readMolFile(std::istream &input, chemkit::MoleculeFile *file
     std::getline(input, comment);
 
     if(input.eof()){
-        setErrorString("File is empty");
-        return false;
+        return boost::shared_ptr<chemkit::Molecule>();
     }
 
     // read counts line
@@ -153,28 +257,7 @@ bool MdlFileFormat::readMolFile(std::istream &input, chemkit::MoleculeFile *file
     // read properties
     readPropertyBlock(input, molecule.get());
 
-    file->addMolecule(molecule);
-
-    return true;
-}
-
-bool MdlFileFormat::readSdfFile(std::istream &input, chemkit::MoleculeFile *file)
-{
-    while(!input.eof()){
-        // read molecule
-        readMolFile(input, file);
-
-        // read data block
-        chemkit::Molecule *molecule = file->molecules().back().get();
-        readDataBlock(input, molecule);
-    }
-
-    // return false if we failed to read any molecules
-    if(file->moleculeCount() == 0){
-        return false;
-    }
-
-    return true;
+    return molecule;
 }
 
 bool MdlFileFormat::readAtomBlock(std::istream &input, chemkit::Molecule *molecule, int atomCount)
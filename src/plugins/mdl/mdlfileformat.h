@@ -49,8 +49,12 @@ public:
     // input and output
     bool read(std::istream &input, chemkit::MoleculeFile *file) CHEMKIT_OVERRIDE;
     bool write(const chemkit::MoleculeFile *file, std::ostream &output) CHEMKIT_OVERRIDE;
+    boost::shared_ptr<chemkit::Molecule> readNextMolecule(std::istream &input) CHEMKIT_OVERRIDE;
+    bool writeMolecule(const chemkit::Molecule *molecule, std::ostream &output) CHEMKIT_OVERRIDE;
+    size_t recordBoundary(const char *data, size_t size, size_t position) const CHEMKIT_OVERRIDE;
 
 private:
+    boost::shared_ptr<chemkit::Molecule> readMolecule(std::istream &input);
     bool readMolFile(std::istream &input, chemkit::MoleculeFile *file);
     bool readSdfFile(std::istream &input, chemkit::MoleculeFile *file);
     bool readAtomBlock(std::istream &input, chemkit::Molecule *molecule, int atomCount);
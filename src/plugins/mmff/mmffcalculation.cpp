@@ -38,9 +38,9 @@
 #include <boost/lexical_cast.hpp>
 
 #include <chemkit/topology.h>
+#include <chemkit/geometry.h>
 #include <chemkit/constants.h>
 #include <chemkit/forcefield.h>
-#include <chemkit/cartesiancoordinates.h>
 
 #include "mmffparameters.h"
 
@@ -52,7 +52,7 @@ MmffCalculation::MmffCalculation(int type, int atomCount, int parameterCount)
 
 // === MmffBondStrechCalculation =========================================== //
 MmffBondStrechCalculation::MmffBondStrechCalculation(size_t a, size_t b)
-    : MmffCalculation(BondStrech, 2, 2)
+    : MmffCalculation(BondStrech, AtomCount, ParameterCount)
 {
     setAtom(0, a);
     setAtom(1, b);
@@ -79,15 +79,20 @@ bool MmffBondStrechCalculation::setup(const MmffParameters *parameters)
     return false;
 }
 
-chemkit::Real MmffBondStrechCalculation::energy(const chemkit::CartesianCoordinates *coordinates) const
+const chemkit::ForceFieldKernel* MmffBondStrechCalculation::kernel() const
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
+    static const chemkit::ForceFieldKernelAdaptor<MmffBondStrechCalculation> kernel;
+    return &kernel;
+}
 
-    chemkit::Real kb = parameter(0);
-    chemkit::Real r0 = parameter(1);
+chemkit::Real MmffBondStrechCalculation::evaluateEnergy(const chemkit::Point3 *positions,
+                                                        const size_t *atoms,
+                                                        const chemkit::Real *parameters)
+{
+    chemkit::Real kb = parameters[0];
+    chemkit::Real r0 = parameters[1];
 
-    chemkit::Real r = coordinates->distance(a, b);
+    chemkit::Real r = (positions[atoms[0]] - positions[atoms[1]]).norm();
     chemkit::Real dr = r - r0;
     chemkit::Real cs = -2.0; // cubic strech constant
 
@@ -95,32 +100,33 @@ chemkit::Real MmffBondStrechCalculation::energy(const chemkit::CartesianCoordina
     return 143.9325 * (kb / 2) * (dr*dr) * (1 + cs * dr + ((7.0/12.0)*(cs*cs)) * (dr*dr));
 }
 
-std::vector<chemkit::Vector3> MmffBondStrechCalculation::gradient(const chemkit::CartesianCoordinates *coordinates) const
+void MmffBondStrechCalculation::evaluateGradient(const chemkit::Point3 *positions,
+                                                 const size_t *atoms,
+                                                 const chemkit::Real *parameters,
+                                                 chemkit::Vector3 *gradient)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
 
-    chemkit::Real kb = parameter(0);
-    chemkit::Real r0 = parameter(1);
+    chemkit::Real kb = parameters[0];
+    chemkit::Real r0 = parameters[1];
 
-    chemkit::Real r = coordinates->distance(a, b);
+    chemkit::Real r = (a - b).norm();
     chemkit::Real dr = r - r0;
     chemkit::Real cs = -2.0; // cubic strech constant
 
     // dE/dr
     chemkit::Real de_dr = 143.9325 * kb * dr * (1 + cs * dr + (7.0/12.0 * (cs*cs) * (dr*dr)) + 0.5 * dr * (cs + (14.0/12.0 * (cs*cs) * dr)));
 
-    boost::array<chemkit::Vector3, 2> gradient = coordinates->distanceGradient(a, b);
-
-    gradient[0] *= de_dr;
-    gradient[1] *= de_dr;
+    boost::array<chemkit::Vector3, 2> distanceGradient = chemkit::geometry::distanceGradient(a, b);
 
-    return std::vector<chemkit::Vector3>(gradient.begin(), gradient.end());
+    gradient[0] = distanceGradient[0] * de_dr;
+    gradient[1] = distanceGradient[1] * de_dr;
 }
 
 // === MmffAngleBendCalculation ============================================ //
 MmffAngleBendCalculation::MmffAngleBendCalculation(size_t a, size_t b, size_t c)
-    : MmffCalculation(AngleBend, 3, 2)
+    : MmffCalculation(AngleBend, AtomCount, ParameterCount)
 {
     setAtom(0, a);
     setAtom(1, b);
@@ -152,51 +158,58 @@ bool MmffAngleBendCalculation::setup(const MmffParameters *parameters)
     return false;
 }
 
-chemkit::Real MmffAngleBendCalculation::energy(const chemkit::CartesianCoordinates *coordinates) const
+const chemkit::ForceFieldKernel* MmffAngleBendCalculation::kernel() const
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
+    static const chemkit::ForceFieldKernelAdaptor<MmffAngleBendCalculation> kernel;
+    return &kernel;
+}
 
-    chemkit::Real ka = parameter(0);
-    chemkit::Real t0 = parameter(1);
+chemkit::Real MmffAngleBendCalculation::evaluateEnergy(const chemkit::Point3 *positions,
+                                                       const size_t *atoms,
+                                                       const chemkit::Real *parameters)
+{
+    chemkit::Real ka = parameters[0];
+    chemkit::Real t0 = parameters[1];
 
     chemkit::Real cb = -0.007; // cubic bend constant
-    chemkit::Real t = coordinates->angle(a, b, c);
+    chemkit::Real t = chemkit::geometry::angle(positions[atoms[0]],
+                                               positions[atoms[1]],
+                                               positions[atoms[2]]);
     chemkit::Real dt = t - t0;
 
     // equation 3
-    return 0.043844 * (ka / 2.0) * pow(dt, 2) * (1 + cb * dt);
+    return 0.043844 * (ka / 2.0) * (dt*dt) * (1 + cb * dt);
 }
 
-std::vector<chemkit::Vector3> MmffAngleBendCalculation::gradient(const chemkit::CartesianCoordinates *coordinates) const
+void MmffAngleBendCalculation::evaluateGradient(const chemkit::Point3 *positions,
+                                                const size_t *atoms,
+                                                const chemkit::Real *parameters,
+                                                chemkit::Vector3 *gradient)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+    const chemkit::Point3 &c = positions[atoms[2]];
 
-    chemkit::Real ka = parameter(0);
-    chemkit::Real t0 = parameter(1);
+    chemkit::Real ka = parameters[0];
+    chemkit::Real t0 = parameters[1];
 
     chemkit::Real cb = -0.007; // cubic bend constant
-    chemkit::Real t = coordinates->angle(a, b, c);
+    chemkit::Real t = chemkit::geometry::angle(a, b, c);
     chemkit::Real dt = t - t0;
 
     // dE/dt
     chemkit::Real de_dt = 0.043844 * ka * dt * (1 + cb * dt + 0.5 * cb * dt);
 
-    boost::array<chemkit::Vector3, 3> gradient = coordinates->angleGradient(a, b, c);
+    boost::array<chemkit::Vector3, 3> angleGradient = chemkit::geometry::angleGradient(a, b, c);
 
-    gradient[0] *= de_dt;
-    gradient[1] *= de_dt;
-    gradient[2] *= de_dt;
-
-    return std::vector<chemkit::Vector3>(gradient.begin(), gradient.end());
+    gradient[0] = angleGradient[0] * de_dt;
+    gradient[1] = angleGradient[1] * de_dt;
+    gradient[2] = angleGradient[2] * de_dt;
 }
 
 // === MmffStrechBendCalculation =========================================== //
 MmffStrechBendCalculation::MmffStrechBendCalculation(size_t a, size_t b, size_t c)
-    : MmffCalculation(BondStrech | AngleBend, 3, 5)
+    : MmffCalculation(BondStrech | AngleBend, AtomCount, ParameterCount)
 {
     setAtom(0, a);
     setAtom(1, b);
@@ -268,64 +281,71 @@ bool MmffStrechBendCalculation::setup(const MmffParameters *parameters)
     return false;
 }
 
-chemkit::Real MmffStrechBendCalculation::energy(const chemkit::CartesianCoordinates *coordinates) const
+const chemkit::ForceFieldKernel* MmffStrechBendCalculation::kernel() const
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
-
-    chemkit::Real kba_ijk = parameter(0);
-    chemkit::Real kba_kji = parameter(1);
-    chemkit::Real r0_ab = parameter(2);
-    chemkit::Real r0_bc = parameter(3);
-    chemkit::Real t0 = parameter(4);
+    static const chemkit::ForceFieldKernelAdaptor<MmffStrechBendCalculation> kernel;
+    return &kernel;
+}
 
-    chemkit::Real r_ab = coordinates->distance(a, b);
-    chemkit::Real r_bc = coordinates->distance(b, c);
+chemkit::Real MmffStrechBendCalculation::evaluateEnergy(const chemkit::Point3 *positions,
+                                                        const size_t *atoms,
+                                                        const chemkit::Real *parameters)
+{
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+    const chemkit::Point3 &c = positions[atoms[2]];
+
+    chemkit::Real kba_ijk = parameters[0];
+    chemkit::Real kba_kji = parameters[1];
+    chemkit::Real r0_ab = parameters[2];
+    chemkit::Real r0_bc = parameters[3];
+    chemkit::Real t0 = parameters[4];
+
+    chemkit::Real r_ab = (a - b).norm();
+    chemkit::Real r_bc = (b - c).norm();
     chemkit::Real dr_ab = r_ab - r0_ab;
     chemkit::Real dr_bc = r_bc - r0_bc;
-    chemkit::Real t = coordinates->angle(a, b, c);
+    chemkit::Real t = chemkit::geometry::angle(a, b, c);
     chemkit::Real dt = t - t0;
 
     // equation 5
     return 2.51210 * (kba_ijk * dr_ab + kba_kji * dr_bc) * dt;
 }
 
-std::vector<chemkit::Vector3> MmffStrechBendCalculation::gradient(const chemkit::CartesianCoordinates *coordinates) const
+void MmffStrechBendCalculation::evaluateGradient(const chemkit::Point3 *positions,
+                                                 const size_t *atoms,
+                                                 const chemkit::Real *parameters,
+                                                 chemkit::Vector3 *gradient)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
-
-    chemkit::Real kba_ijk = parameter(0);
-    chemkit::Real kba_kji = parameter(1);
-    chemkit::Real r0_ab = parameter(2);
-    chemkit::Real r0_bc = parameter(3);
-    chemkit::Real t0 = parameter(4);
-
-    chemkit::Real r_ab = coordinates->distance(a, b);
-    chemkit::Real r_bc = coordinates->distance(b, c);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+    const chemkit::Point3 &c = positions[atoms[2]];
+
+    chemkit::Real kba_ijk = parameters[0];
+    chemkit::Real kba_kji = parameters[1];
+    chemkit::Real r0_ab = parameters[2];
+    chemkit::Real r0_bc = parameters[3];
+    chemkit::Real t0 = parameters[4];
+
+    chemkit::Real r_ab = (a - b).norm();
+    chemkit::Real r_bc = (b - c).norm();
     chemkit::Real dr_ab = r_ab - r0_ab;
     chemkit::Real dr_bc = r_bc - r0_bc;
-    chemkit::Real t = coordinates->angle(a, b, c);
+    chemkit::Real t = chemkit::geometry::angle(a, b, c);
     chemkit::Real dt = t - t0;
 
-    std::vector<chemkit::Vector3> gradient(3);
-
-    boost::array<chemkit::Vector3, 2> distanceGradientAB = coordinates->distanceGradient(a, b);
-    boost::array<chemkit::Vector3, 2> distanceGradientBC = coordinates->distanceGradient(b, c);
-    boost::array<chemkit::Vector3, 3> angleGradientABC = coordinates->angleGradient(a, b, c);
+    boost::array<chemkit::Vector3, 2> distanceGradientAB = chemkit::geometry::distanceGradient(a, b);
+    boost::array<chemkit::Vector3, 2> distanceGradientBC = chemkit::geometry::distanceGradient(b, c);
+    boost::array<chemkit::Vector3, 3> angleGradientABC = chemkit::geometry::angleGradient(a, b, c);
 
     gradient[0] = (distanceGradientAB[0] * kba_ijk * dt + angleGradientABC[0] * (kba_ijk * dr_ab + kba_kji * dr_bc)) * 2.51210;
     gradient[1] = ((distanceGradientAB[1] * kba_ijk + distanceGradientBC[0] * kba_kji) * dt + angleGradientABC[1] * (kba_ijk * dr_ab + kba_kji * dr_bc)) * 2.51210;
     gradient[2] = ((distanceGradientBC[1] * kba_kji) * dt + angleGradientABC[2] * (kba_ijk * dr_ab + kba_kji * dr_bc)) * 2.51210;
-
-    return gradient;
 }
 
 // === MmffOutOfPlaneBendingCalculation ==================================== //
 MmffOutOfPlaneBendingCalculation::MmffOutOfPlaneBendingCalculation(size_t a, size_t b, size_t c, size_t d)
-    : MmffCalculation(Inversion, 4, 1)
+    : MmffCalculation(Inversion, AtomCount, ParameterCount)
 {
     setAtom(0, a);
     setAtom(1, b);
@@ -357,46 +377,53 @@ bool MmffOutOfPlaneBendingCalculation::setup(const MmffParameters *parameters)
     return true;
 }
 
-chemkit::Real MmffOutOfPlaneBendingCalculation::energy(const chemkit::CartesianCoordinates *coordinates) const
+const chemkit::ForceFieldKernel* MmffOutOfPlaneBendingCalculation::kernel() const
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
-    size_t d = atom(3);
+    static const chemkit::ForceFieldKernelAdaptor<MmffOutOfPlaneBendingCalculation> kernel;
+    return &kernel;
+}
 
-    chemkit::Real angle = coordinates->wilsonAngle(a, b, c, d);
-    chemkit::Real koop = parameter(0);
+chemkit::Real MmffOutOfPlaneBendingCalculation::evaluateEnergy(const chemkit::Point3 *positions,
+                                                               const size_t *atoms,
+                                                               const chemkit::Real *parameters)
+{
+    chemkit::Real angle = chemkit::geometry::wilsonAngle(positions[atoms[0]],
+                                                         positions[atoms[1]],
+                                                         positions[atoms[2]],
+                                                         positions[atoms[3]]);
+    chemkit::Real koop = parameters[0];
 
     // equation 6
     return 0.043844 * (koop / 2.0) * (angle*angle);
 }
 
-std::vector<chemkit::Vector3> MmffOutOfPlaneBendingCalculation::gradient(const chemkit::CartesianCoordinates *coordinates) const
+void MmffOutOfPlaneBendingCalculation::evaluateGradient(const chemkit::Point3 *positions,
+                                                        const size_t *atoms,
+                                                        const chemkit::Real *parameters,
+                                                        chemkit::Vector3 *gradient)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
-    size_t d = atom(3);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+    const chemkit::Point3 &c = positions[atoms[2]];
+    const chemkit::Point3 &d = positions[atoms[3]];
 
-    chemkit::Real angle = coordinates->wilsonAngle(a, b, c, d);
-    chemkit::Real koop = parameter(0);
+    chemkit::Real angle = chemkit::geometry::wilsonAngle(a, b, c, d);
+    chemkit::Real koop = parameters[0];
 
     // dE/dw
     chemkit::Real de_dw = 0.043844 * koop * angle;
 
-    boost::array<chemkit::Vector3, 4> gradient = coordinates->wilsonAngleGradient(a, b, c, d);
-
-    gradient[0] *= de_dw;
-    gradient[1] *= de_dw;
-    gradient[2] *= de_dw;
-    gradient[3] *= de_dw;
+    boost::array<chemkit::Vector3, 4> wilsonGradient = chemkit::geometry::wilsonAngleGradient(a, b, c, d);
 
-    return std::vector<chemkit::Vector3>(gradient.begin(), gradient.end());
+    gradient[0] = wilsonGradient[0] * de_dw;
+    gradient[1] = wilsonGradient[1] * de_dw;
+    gradient[2] = wilsonGradient[2] * de_dw;
+    gradient[3] = wilsonGradient[3] * de_dw;
 }
 
 // === MmffTorsionCalculation ============================================== //
 MmffTorsionCalculation::MmffTorsionCalculation(size_t a, size_t b, size_t c, size_t d)
-    : MmffCalculation(Torsion, 4, 3)
+    : MmffCalculation(Torsion, AtomCount, ParameterCount)
 {
     setAtom(0, a);
     setAtom(1, b);
@@ -432,50 +459,57 @@ bool MmffTorsionCalculation::setup(const MmffParameters *parameters)
     return true;
 }
 
-chemkit::Real MmffTorsionCalculation::energy(const chemkit::CartesianCoordinates *coordinates) const
+const chemkit::ForceFieldKernel* MmffTorsionCalculation::kernel() const
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
-    size_t d = atom(3);
+    static const chemkit::ForceFieldKernelAdaptor<MmffTorsionCalculation> kernel;
+    return &kernel;
+}
 
-    chemkit::Real angle = coordinates->torsionAngleRadians(a, b, c, d);
-    chemkit::Real V1 = parameter(0);
-    chemkit::Real V2 = parameter(1);
-    chemkit::Real V3 = parameter(2);
+chemkit::Real MmffTorsionCalculation::evaluateEnergy(const chemkit::Point3 *positions,
+                                                     const size_t *atoms,
+                                                     const chemkit::Real *parameters)
+{
+    chemkit::Real angle = chemkit::geometry::torsionAngleRadians(positions[atoms[0]],
+                                                                 positions[atoms[1]],
+                                                                 positions[atoms[2]],
+                                                                 positions[atoms[3]]);
+    chemkit::Real V1 = parameters[0];
+    chemkit::Real V2 = parameters[1];
+    chemkit::Real V3 = parameters[2];
 
     // equation 7
     return 0.5 * (V1 * (1.0 + cos(angle)) + V2 * (1.0 - cos(2.0 * angle)) + V3 * (1.0 + cos(3.0 * angle)));
 }
 
-std::vector<chemkit::Vector3> MmffTorsionCalculation::gradient(const chemkit::CartesianCoordinates *coordinates) const
+void MmffTorsionCalculation::evaluateGradient(const chemkit::Point3 *positions,
+                                              const size_t *atoms,
+                                              const chemkit::Real *parameters,
+                                              chemkit::Vector3 *gradient)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
-    size_t d = atom(3);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+    const chemkit::Point3 &c = positions[atoms[2]];
+    const chemkit::Point3 &d = positions[atoms[3]];
 
-    chemkit::Real phi = coordinates->torsionAngleRadians(a, b, c, d);
-    chemkit::Real V1 = parameter(0);
-    chemkit::Real V2 = parameter(1);
-    chemkit::Real V3 = parameter(2);
+    chemkit::Real phi = chemkit::geometry::torsionAngleRadians(a, b, c, d);
+    chemkit::Real V1 = parameters[0];
+    chemkit::Real V2 = parameters[1];
+    chemkit::Real V3 = parameters[2];
 
     // dE/dphi
     chemkit::Real de_dphi = 0.5 * (-V1 * sin(phi) + 2 * V2 * sin(2 * phi) - 3 * V3 * sin(3 * phi));
 
-    boost::array<chemkit::Vector3, 4> gradient = coordinates->torsionAngleGradientRadians(a, b, c, d);
+    boost::array<chemkit::Vector3, 4> torsionGradient = chemkit::geometry::torsionAngleGradientRadians(a, b, c, d);
 
-    gradient[0] *= de_dphi;
-    gradient[1] *= de_dphi;
-    gradient[2] *= de_dphi;
-    gradient[3] *= de_dphi;
-
-    return std::vector<chemkit::Vector3>(gradient.begin(), gradient.end());
+    gradient[0] = torsionGradient[0] * de_dphi;
+    gradient[1] = torsionGradient[1] * de_dphi;
+    gradient[2] = torsionGradient[2] * de_dphi;
+    gradient[3] = torsionGradient[3] * de_dphi;
 }
 
 // === MmffVanDerWaalsCalculation ========================================== //
 MmffVanDerWaalsCalculation::MmffVanDerWaalsCalculation(size_t a, size_t b)
-    : MmffCalculation(VanDerWaals, 2, 2)
+    : MmffCalculation(VanDerWaals, AtomCount, ParameterCount)
 {
     setAtom(0, a);
     setAtom(1, b);
@@ -497,6 +531,21 @@ bool MmffVanDerWaalsCalculation::setup(const MmffParameters *parameters)
         return false;
     }
 
+    chemkit::Real combinedParameters[ParameterCount];
+    combineParameters(parametersA, parametersB, combinedParameters);
+
+    setParameter(0, combinedParameters[0]);
+    setParameter(1, combinedParameters[1]);
+
+    return true;
+}
+
+// Combines the van der waals parameters of two atoms into the rs and
+// eps parameters for their interaction.
+void MmffVanDerWaalsCalculation::combineParameters(const MmffVanDerWaalsParameters *parametersA,
+                                                   const MmffVanDerWaalsParameters *parametersB,
+                                                   chemkit::Real *parameters)
+{
     chemkit::Real N_a = parametersA->N;
     chemkit::Real N_b = parametersB->N;
     chemkit::Real A_a = parametersA->A;
@@ -533,50 +582,72 @@ bool MmffVanDerWaalsCalculation::setup(const MmffParameters *parameters)
         eps *= 0.5;
     }
 
-    setParameter(0, rs);
-    setParameter(1, eps);
-
-    return true;
+    parameters[0] = rs;
+    parameters[1] = eps;
 }
 
-chemkit::Real MmffVanDerWaalsCalculation::energy(const chemkit::CartesianCoordinates *coordinates) const
+const chemkit::ForceFieldKernel* MmffVanDerWaalsCalculation::kernel() const
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
+    static const chemkit::ForceFieldKernelAdaptor<MmffVanDerWaalsCalculation> kernel;
+    return &kernel;
+}
 
-    chemkit::Real rs = parameter(0);
-    chemkit::Real eps = parameter(1);
-    chemkit::Real r = coordinates->distance(a, b);
+chemkit::Real MmffVanDerWaalsCalculation::evaluateEnergy(const chemkit::Point3 *positions,
+                                                         const size_t *atoms,
+                                                         const chemkit::Real *parameters)
+{
+    chemkit::Real rs = parameters[0];
+    chemkit::Real eps = parameters[1];
+    chemkit::Real r = (positions[atoms[0]] - positions[atoms[1]]).norm();
+
+    chemkit::Real r2 = r * r;
+    chemkit::Real r7 = r2 * r2 * r2 * r;
+    chemkit::Real rs2 = rs * rs;
+    chemkit::Real rs7 = rs2 * rs2 * rs2 * rs;
+    chemkit::Real q = (1.07 * rs) / (r + 0.07 * rs);
+    chemkit::Real q2 = q * q;
+    chemkit::Real q7 = q2 * q2 * q2 * q;
 
     // equation 8
-    return eps * pow(((1.07 * rs) / (r + 0.07 * rs)), 7) * (((1.12 * pow(rs, 7)) / (pow(r, 7) + 0.12 * pow(rs, 7))) - 2);
+    return eps * q7 * (((1.12 * rs7) / (r7 + 0.12 * rs7)) - 2);
 }
 
-std::vector<chemkit::Vector3> MmffVanDerWaalsCalculation::gradient(const chemkit::CartesianCoordinates *coordinates) const
+void MmffVanDerWaalsCalculation::evaluateGradient(const chemkit::Point3 *positions,
+                                                  const size_t *atoms,
+                                                  const chemkit::Real *parameters,
+                                                  chemkit::Vector3 *gradient)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-
-    chemkit::Real rs = parameter(0);
-    chemkit::Real eps = parameter(1);
-    chemkit::Real r = coordinates->distance(a, b);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+
+    chemkit::Real rs = parameters[0];
+    chemkit::Real eps = parameters[1];
+    chemkit::Real r = (a - b).norm();
+
+    chemkit::Real r2 = r * r;
+    chemkit::Real r6 = r2 * r2 * r2;
+    chemkit::Real r7 = r6 * r;
+    chemkit::Real rs2 = rs * rs;
+    chemkit::Real rs7 = rs2 * rs2 * rs2 * rs;
+    chemkit::Real q = (1.07 * rs) / (r + 0.07 * rs);
+    chemkit::Real q2 = q * q;
+    chemkit::Real q6 = q2 * q2 * q2;
+    chemkit::Real s = r7 + 0.12 * rs7;
 
     // dE/dr
-    chemkit::Real de_dr = 7 * eps * pow(1.07 * rs / (r + 0.07 * rs), 6) *
-                           ((-1.07 * rs / pow(r + 0.07 * rs, 2)) * (1.12 * pow(rs, 7) / (pow(r, 7) + 0.12 * pow(rs, 7)) - 2) +
-                           (-1.12 * pow(rs, 7) * pow(r, 6) / pow(pow(r, 7) + 0.12 * pow(rs, 7), 2)) * (1.07 * rs / (r + 0.07 * rs)));
-
-    boost::array<chemkit::Vector3, 2> gradient = coordinates->distanceGradient(a, b);
+    chemkit::Real de_dr = 7 * eps * q6 *
+                           ((-q / (r + 0.07 * rs)) * (1.12 * rs7 / s - 2) +
+                           (-1.12 * rs7 * r6 / (s * s)) * q);
 
-    gradient[0] *= de_dr;
-    gradient[1] *= de_dr;
+    boost::array<chemkit::Vector3, 2> distanceGradient = chemkit::geometry::distanceGradient(a, b);
 
-    return std::vector<chemkit::Vector3>(gradient.begin(), gradient.end());
+    gradient[0] = distanceGradient[0] * de_dr;
+    gradient[1] = distanceGradient[1] * de_dr;
 }
 
 // === MmffElectrostaticCalculation ======================================== //
 MmffElectrostaticCalculation::MmffElectrostaticCalculation(size_t a, size_t b)
-    : MmffCalculation(Electrostatic, 2, 3)
+    : MmffCalculation(Electrostatic, AtomCount, ParameterCount)
 {
     setAtom(0, a);
     setAtom(1, b);
@@ -607,16 +678,21 @@ bool MmffElectrostaticCalculation::setup(const MmffParameters *parameters)
     return true;
 }
 
-chemkit::Real MmffElectrostaticCalculation::energy(const chemkit::CartesianCoordinates *coordinates) const
+const chemkit::ForceFieldKernel* MmffElectrostaticCalculation::kernel() const
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
+    static const chemkit::ForceFieldKernelAdaptor<MmffElectrostaticCalculation> kernel;
+    return &kernel;
+}
 
-    chemkit::Real qa = parameter(0);
-    chemkit::Real qb = parameter(1);
-    chemkit::Real oneFourScaling = parameter(2);
+chemkit::Real MmffElectrostaticCalculation::evaluateEnergy(const chemkit::Point3 *positions,
+                                                           const size_t *atoms,
+                                                           const chemkit::Real *parameters)
+{
+    chemkit::Real qa = parameters[0];
+    chemkit::Real qb = parameters[1];
+    chemkit::Real oneFourScaling = parameters[2];
 
-    chemkit::Real r = coordinates->distance(a, b);
+    chemkit::Real r = (positions[atoms[0]] - positions[atoms[1]]).norm();
     chemkit::Real e = 1.0; // dielectric constant
     chemkit::Real d = 0.05; // electrostatic buffering constant
 
@@ -624,25 +700,26 @@ chemkit::Real MmffElectrostaticCalculation::energy(const chemkit::CartesianCoord
     return ((332.0716 * qa * qb) / (e * (r + d))) * oneFourScaling;
 }
 
-std::vector<chemkit::Vector3> MmffElectrostaticCalculation::gradient(const chemkit::CartesianCoordinates *coordinates) const
+void MmffElectrostaticCalculation::evaluateGradient(const chemkit::Point3 *positions,
+                                                    const size_t *atoms,
+                                                    const chemkit::Real *parameters,
+                                                    chemkit::Vector3 *gradient)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
 
-    chemkit::Real qa = parameter(0);
-    chemkit::Real qb = parameter(1);
-    chemkit::Real oneFourScaling = parameter(2);
+    chemkit::Real qa = parameters[0];
+    chemkit::Real qb = parameters[1];
+    chemkit::Real oneFourScaling = parameters[2];
 
-    chemkit::Real r = coordinates->distance(a, b);
+    chemkit::Real r = (a - b).norm();
     chemkit::Real e = 1.0; // dielectric constant
     chemkit::Real d = 0.05; // electrostatic buffering constant
 
-    chemkit::Real de_dr = 332.0716 * qa * qb * oneFourScaling * (-1.0 / (e * pow(r + d, 2)));
-
-    boost::array<chemkit::Vector3, 2> gradient = coordinates->distanceGradient(a, b);
+    chemkit::Real de_dr = 332.0716 * qa * qb * oneFourScaling * (-1.0 / (e * (r + d) * (r + d)));
 
-    gradient[0] *= de_dr;
-    gradient[1] *= de_dr;
+    boost::array<chemkit::Vector3, 2> distanceGradient = chemkit::geometry::distanceGradient(a, b);
 
-    return std::vector<chemkit::Vector3>(gradient.begin(), gradient.end());
+    gradient[0] = distanceGradient[0] * de_dr;
+    gradient[1] = distanceGradient[1] * de_dr;
 }
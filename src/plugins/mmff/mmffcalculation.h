@@ -36,9 +36,11 @@
 #ifndef MMFFCALCULATION_H
 #define MMFFCALCULATION_H
 
+#include <chemkit/forcefieldkernel.h>
 #include <chemkit/forcefieldcalculation.h>
 
 class MmffParameters;
+struct MmffVanDerWaalsParameters;
 
 class MmffCalculation : public chemkit::ForceFieldCalculation
 {
@@ -52,71 +54,159 @@ protected:
 class MmffBondStrechCalculation : public MmffCalculation
 {
 public:
+    enum {
+        AtomCount = 2,
+        ParameterCount = 2
+    };
+
     MmffBondStrechCalculation(size_t a, size_t b);
 
     bool setup(const MmffParameters *parameters);
-    chemkit::Real energy(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
-    std::vector<chemkit::Vector3> gradient(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    const chemkit::ForceFieldKernel* kernel() const CHEMKIT_OVERRIDE;
+
+    static chemkit::Real evaluateEnergy(const chemkit::Point3 *positions,
+                                        const size_t *atoms,
+                                        const chemkit::Real *parameters);
+    static void evaluateGradient(const chemkit::Point3 *positions,
+                                 const size_t *atoms,
+                                 const chemkit::Real *parameters,
+                                 chemkit::Vector3 *gradient);
 };
 
 class MmffAngleBendCalculation : public MmffCalculation
 {
 public:
+    enum {
+        AtomCount = 3,
+        ParameterCount = 2
+    };
+
     MmffAngleBendCalculation(size_t a, size_t b, size_t c);
 
     bool setup(const MmffParameters *parameters);
-    chemkit::Real energy(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
-    std::vector<chemkit::Vector3> gradient(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    const chemkit::ForceFieldKernel* kernel() const CHEMKIT_OVERRIDE;
+
+    static chemkit::Real evaluateEnergy(const chemkit::Point3 *positions,
+                                        const size_t *atoms,
+                                        const chemkit::Real *parameters);
+    static void evaluateGradient(const chemkit::Point3 *positions,
+                                 const size_t *atoms,
+                                 const chemkit::Real *parameters,
+                                 chemkit::Vector3 *gradient);
 };
 
 class MmffStrechBendCalculation : public MmffCalculation
 {
 public:
+    enum {
+        AtomCount = 3,
+        ParameterCount = 5
+    };
+
     MmffStrechBendCalculation(size_t a, size_t b, size_t c);
 
     bool setup(const MmffParameters *parameters);
-    chemkit::Real energy(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
-    std::vector<chemkit::Vector3> gradient(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    const chemkit::ForceFieldKernel* kernel() const CHEMKIT_OVERRIDE;
+
+    static chemkit::Real evaluateEnergy(const chemkit::Point3 *positions,
+                                        const size_t *atoms,
+                                        const chemkit::Real *parameters);
+    static void evaluateGradient(const chemkit::Point3 *positions,
+                                 const size_t *atoms,
+                                 const chemkit::Real *parameters,
+                                 chemkit::Vector3 *gradient);
 };
 
 class MmffOutOfPlaneBendingCalculation : public MmffCalculation
 {
 public:
+    enum {
+        AtomCount = 4,
+        ParameterCount = 1
+    };
+
     MmffOutOfPlaneBendingCalculation(size_t a, size_t b, size_t c, size_t d);
 
     bool setup(const MmffParameters *parameters);
-    chemkit::Real energy(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
-    std::vector<chemkit::Vector3> gradient(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    const chemkit::ForceFieldKernel* kernel() const CHEMKIT_OVERRIDE;
+
+    static chemkit::Real evaluateEnergy(const chemkit::Point3 *positions,
+                                        const size_t *atoms,
+                                        const chemkit::Real *parameters);
+    static void evaluateGradient(const chemkit::Point3 *positions,
+                                 const size_t *atoms,
+                                 const chemkit::Real *parameters,
+                                 chemkit::Vector3 *gradient);
 };
 
 class MmffTorsionCalculation : public MmffCalculation
 {
 public:
+    enum {
+        AtomCount = 4,
+        ParameterCount = 3
+    };
+
     MmffTorsionCalculation(size_t a, size_t b, size_t c, size_t d);
 
     bool setup(const MmffParameters *parameters);
-    chemkit::Real energy(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
-    std::vector<chemkit::Vector3> gradient(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    const chemkit::ForceFieldKernel* kernel() const CHEMKIT_OVERRIDE;
+
+    static chemkit::Real evaluateEnergy(const chemkit::Point3 *positions,
+                                        const size_t *atoms,
+                                        const chemkit::Real *parameters);
+    static void evaluateGradient(const chemkit::Point3 *positions,
+                                 const size_t *atoms,
+                                 const chemkit::Real *parameters,
+                                 chemkit::Vector3 *gradient);
 };
 
 class MmffVanDerWaalsCalculation : public MmffCalculation
 {
 public:
+    enum {
+        AtomCount = 2,
+        ParameterCount = 2
+    };
+
     MmffVanDerWaalsCalculation(size_t a, size_t b);
 
     bool setup(const MmffParameters *parameters);
-    chemkit::Real energy(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
-    std::vector<chemkit::Vector3> gradient(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    const chemkit::ForceFieldKernel* kernel() const CHEMKIT_OVERRIDE;
+
+    static void combineParameters(const MmffVanDerWaalsParameters *parametersA,
+                                  const MmffVanDerWaalsParameters *parametersB,
+                                  chemkit::Real *parameters);
+
+    static chemkit::Real evaluateEnergy(const chemkit::Point3 *positions,
+                                        const size_t *atoms,
+                                        const chemkit::Real *parameters);
+    static void evaluateGradient(const chemkit::Point3 *positions,
+                                 const size_t *atoms,
+                                 const chemkit::Real *parameters,
+                                 chemkit::Vector3 *gradient);
 };
 
 class MmffElectrostaticCalculation : public MmffCalculation
 {
 public:
+    enum {
+        AtomCount = 2,
+        ParameterCount = 3
+    };
+
     MmffElectrostaticCalculation(size_t a, size_t b);
 
     bool setup(const MmffParameters *parameters);
-    chemkit::Real energy(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
-    std::vector<chemkit::Vector3> gradient(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    const chemkit::ForceFieldKernel* kernel() const CHEMKIT_OVERRIDE;
+
+    static chemkit::Real evaluateEnergy(const chemkit::Point3 *positions,
+                                        const size_t *atoms,
+                                        const chemkit::Real *parameters);
+    static void evaluateGradient(const chemkit::Point3 *positions,
+                                 const size_t *atoms,
+                                 const chemkit::Real *parameters,
+                                 chemkit::Vector3 *gradient);
 };
 
 #endif // MMFFCALCULATION_H
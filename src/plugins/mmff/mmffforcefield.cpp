@@ -56,11 +56,15 @@
 #include <chemkit/molecule.h>
 #include <chemkit/topology.h>
 #include <chemkit/pluginmanager.h>
+#include <chemkit/forcefieldparameterscache.h>
+
+#include <boost/lexical_cast.hpp>
 
 // --- Construction and Destruction ---------------------------------------- //
 MmffForceField::MmffForceField()
     : chemkit::ForceField("mmff"),
-      m_parameters(0)
+      m_vanDerWaalsKernel(0),
+      m_electrostaticKernel(0)
 {
     const chemkit::Plugin *mmffPlugin = chemkit::PluginManager::instance()->plugin("mmff");
     if(mmffPlugin){
@@ -74,19 +78,17 @@ MmffForceField::MmffForceField()
 
 MmffForceField::~MmffForceField()
 {
-    delete m_parameters;
 }
 
 // --- Parameterization ---------------------------------------------------- //
 bool MmffForceField::setup()
 {
+    // the parsed parameters are shared between force fields
     if(!m_parameters || m_parameters->fileName() != parameterFile()){
-        m_parameters = new MmffParameters;
-        bool ok = m_parameters->read(parameterFile());
-        if(!ok){
-            setErrorString("Failed to load parameters: " + m_parameters->errorString());
-            delete m_parameters;
-            m_parameters = 0;
+        std::string errorString;
+        m_parameters = chemkit::ForceFieldParametersCache<MmffParameters>::parameters(parameterFile(), &errorString);
+        if(!m_parameters){
+            setErrorString("Failed to load parameters: " + errorString);
             return false;
         }
     }
@@ -96,6 +98,9 @@ bool MmffForceField::setup()
         return false;
     }
 
+    // remove the calculations from a previous setup
+    clearCalculations();
+
     // bond strech calculations
     foreach(const chemkit::Topology::BondedInteraction &interaction, topology->bondedInteractions()){
         size_t a = interaction[0];
@@ -147,8 +152,34 @@ bool MmffForceField::setup()
 
     bool ok = true;
 
+    // van der waals and electrostatic kernels for the neighbor list.
+    // pairs with an atom without parameters are skipped.
+    if(nonbondedCutoff() > 0){
+        clearNonbondedKernels();
+
+        m_vanDerWaalsParameters.resize(topology->size());
+
+        for(size_t i = 0; i < topology->size(); i++){
+            int type = boost::lexical_cast<int>(topology->type(i));
+
+            m_vanDerWaalsParameters[i] = m_parameters->vanDerWaalsParameters(type);
+            if(!m_vanDerWaalsParameters[i]){
+                ok = false;
+            }
+        }
+
+        chemkit::ForceFieldKernel *vanDerWaalsKernel =
+            new chemkit::ForceFieldKernelAdaptor<MmffVanDerWaalsCalculation>;
+        chemkit::ForceFieldKernel *electrostaticKernel =
+            new chemkit::ForceFieldKernelAdaptor<MmffElectrostaticCalculation>;
+        addNonbondedKernel(vanDerWaalsKernel);
+        addNonbondedKernel(electrostaticKernel);
+        m_vanDerWaalsKernel = vanDerWaalsKernel;
+        m_electrostaticKernel = electrostaticKernel;
+    }
+
     foreach(chemkit::ForceFieldCalculation *calculation, calculations()){
-        bool setup = static_cast<MmffCalculation *>(calculation)->setup(m_parameters);
+        bool setup = static_cast<MmffCalculation *>(calculation)->setup(m_parameters.get());
 
         if(!setup){
             ok = false;
@@ -162,5 +193,33 @@ bool MmffForceField::setup()
 
 const MmffParameters* MmffForceField::parameters() const
 {
-    return m_parameters;
+    return m_parameters.get();
+}
+
+bool MmffForceField::nonbondedParameters(const chemkit::ForceFieldKernel *kernel,
+                                         size_t a,
+                                         size_t b,
+                                         bool oneFour,
+                                         chemkit::Real *parameters) const
+{
+    if(kernel == m_vanDerWaalsKernel){
+        const MmffVanDerWaalsParameters *parametersA = m_vanDerWaalsParameters[a];
+        const MmffVanDerWaalsParameters *parametersB = m_vanDerWaalsParameters[b];
+        if(!parametersA || !parametersB){
+            return false;
+        }
+
+        MmffVanDerWaalsCalculation::combineParameters(parametersA, parametersB, parameters);
+        return true;
+    }
+    else if(kernel == m_electrostaticKernel){
+        const boost::shared_ptr<chemkit::Topology> &topology = this->topology();
+
+        parameters[0] = topology->charge(a);
+        parameters[1] = topology->charge(b);
+        parameters[2] = oneFour ? 0.75 : 1.0;
+        return true;
+    }
+
+    return false;
 }
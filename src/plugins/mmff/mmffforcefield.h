@@ -36,6 +36,8 @@
 #ifndef MMFFFORCEFIELD_H
 #define MMFFFORCEFIELD_H
 
+#include <boost/shared_ptr.hpp>
+
 #include <chemkit/molecule.h>
 #include <chemkit/forcefield.h>
 
@@ -54,8 +56,14 @@ public:
     virtual bool setup();
     const MmffParameters* parameters() const;
 
+protected:
+    bool nonbondedParameters(const chemkit::ForceFieldKernel *kernel, size_t a, size_t b, bool oneFour, chemkit::Real *parameters) const CHEMKIT_OVERRIDE;
+
 private:
-    MmffParameters *m_parameters;
+    boost::shared_ptr<const MmffParameters> m_parameters;
+    std::vector<const MmffVanDerWaalsParameters *> m_vanDerWaalsParameters;
+    const chemkit::ForceFieldKernel *m_vanDerWaalsKernel;
+    const chemkit::ForceFieldKernel *m_electrostaticKernel;
 };
 
 #endif // MMFFFORCEFIELD_H
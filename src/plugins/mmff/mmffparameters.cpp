@@ -37,11 +37,9 @@
 
 #include <fstream>
 
-#include <boost/make_shared.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
 
-#include "mmffplugin.h"
 #include "mmffatomtyper.h"
 #include "mmffforcefield.h"
 #include "mmffparametersdata.h"
@@ -49,7 +47,6 @@
 #include <chemkit/atom.h>
 #include <chemkit/bond.h>
 #include <chemkit/foreach.h>
-#include <chemkit/pluginmanager.h>
 
 namespace {
 
@@ -263,6 +260,14 @@ int EquivalentTypesCount = sizeof(EquivalentTypes) / sizeof(*EquivalentTypes);
 MmffParameters::MmffParameters()
     : d(new MmffParametersData)
 {
+    // index the equivalent types by atom type
+    for(int i = 0; i < EquivalentTypesCount; i++){
+        int type = EquivalentTypes[i][0];
+
+        if(type >= 0 && type <= MaxAtomType){
+            d->equivalentTypes[type] = EquivalentTypes[i];
+        }
+    }
 }
 
 MmffParameters::~MmffParameters()
@@ -277,21 +282,6 @@ std::string MmffParameters::fileName() const
 
 bool MmffParameters::read(const std::string &fileName)
 {
-    // try to load cached parameters
-    MmffPlugin *mmffPlugin = static_cast<MmffPlugin *>(chemkit::PluginManager::instance()->plugin("mmff"));
-    if(mmffPlugin){
-        d = mmffPlugin->parameters(fileName);
-
-        if(d){
-            return true;
-        }
-    }
-
-    // create new parameters data if we don't have a cached one
-    if(!d){
-        d = boost::make_shared<MmffParametersData>();
-    }
-
     std::ifstream file(fileName.c_str());
     if(!file.is_open()){
         setErrorString("Failed to open parameters file.");
@@ -355,7 +345,7 @@ bool MmffParameters::read(const std::string &fileName)
                 MmffBondStrechParameters parameters;
                 parameters.kb = boost::lexical_cast<chemkit::Real>(data[3]);
                 parameters.r0 = boost::lexical_cast<chemkit::Real>(data[4]);
-                d->bondStrechParameters[index] = parameters;
+                d->bondStrechParameters.insert(index, parameters);
             }
             else if(section == EmpiricalBondStrech){
             }
@@ -370,7 +360,7 @@ bool MmffParameters::read(const std::string &fileName)
                 MmffAngleBendParameters parameters;
                 parameters.ka = boost::lexical_cast<chemkit::Real>(data[4]);
                 parameters.theta0 = boost::lexical_cast<chemkit::Real>(data[5]);
-                d->angleBendParameters[index] = parameters;
+                d->angleBendParameters.insert(index, parameters);
             }
             else if(section == StrechBend){
                 int strechBendType = boost::lexical_cast<int>(data[0]);
@@ -383,7 +373,7 @@ bool MmffParameters::read(const std::string &fileName)
                 MmffStrechBendParameters parameters;
                 parameters.kba_ijk = boost::lexical_cast<chemkit::Real>(data[4]);
                 parameters.kba_kji = boost::lexical_cast<chemkit::Real>(data[5]);
-                d->strechBendParameters[index] = parameters;
+                d->strechBendParameters.insert(index, parameters);
             }
             else if(section == DefaultStrechBend){
                 MmffDefaultStrechBendParameters parameters;
@@ -404,7 +394,7 @@ bool MmffParameters::read(const std::string &fileName)
 
                 MmffOutOfPlaneBendingParameters parameters;
                 parameters.koop = boost::lexical_cast<chemkit::Real>(data[4]);
-                d->outOfPlaneBendingParameters[index] = parameters;
+                d->outOfPlaneBendingParameters.insert(index, parameters);
             }
             else if(section == Torsion){
                 int torsionType = boost::lexical_cast<int>(data[0]);
@@ -419,7 +409,7 @@ bool MmffParameters::read(const std::string &fileName)
                 parameters.V1 = boost::lexical_cast<chemkit::Real>(data[5]);
                 parameters.V2 = boost::lexical_cast<chemkit::Real>(data[6]);
                 parameters.V3 = boost::lexical_cast<chemkit::Real>(data[7]);
-                d->torsionParameters[index] = parameters;
+                d->torsionParameters.insert(index, parameters);
             }
             else if(section == VanDerWaals){
                 int type = boost::lexical_cast<int>(data[0]);
@@ -440,7 +430,9 @@ bool MmffParameters::read(const std::string &fileName)
                 parameters.typeA = boost::lexical_cast<int>(data[1]);
                 parameters.typeB = boost::lexical_cast<int>(data[2]);
                 parameters.bci = boost::lexical_cast<chemkit::Real>(data[3]);
-                d->chargeParameters.push_back(parameters);
+
+                int index = calculateChargeIndex(parameters.bondType, parameters.typeA, parameters.typeB);
+                d->chargeParameters.insert(index, parameters);
             }
             else if(section == PartialCharge){
                 int type = boost::lexical_cast<int>(data[1]);
@@ -455,10 +447,12 @@ bool MmffParameters::read(const std::string &fileName)
         }
     }
 
-    // store parameters in the cache
-    if(mmffPlugin){
-        mmffPlugin->storeParameters(fileName, d);
-    }
+    d->bondStrechParameters.sort();
+    d->angleBendParameters.sort();
+    d->strechBendParameters.sort();
+    d->outOfPlaneBendingParameters.sort();
+    d->torsionParameters.sort();
+    d->chargeParameters.sort();
 
     return true;
 }
@@ -480,15 +474,7 @@ const MmffChargeParameters* MmffParameters::chargeParameters(const chemkit::Atom
 {
     int bondType = calculateBondType(a->bondTo(b), typeA, typeB);
 
-    foreach(const MmffChargeParameters &parameters, d->chargeParameters){
-        if(parameters.bondType == bondType &&
-           parameters.typeA == typeA &&
-           parameters.typeB == typeB){
-            return &parameters;
-        }
-    }
-
-    return 0;
+    return d->chargeParameters.find(calculateChargeIndex(bondType, typeA, typeB));
 }
 
 const MmffPartialChargeParameters* MmffParameters::partialChargeParameters(int type) const
@@ -503,12 +489,7 @@ const MmffBondStrechParameters* MmffParameters::bondStrechParameters(int bondTyp
 
     int index = calculateBondStrechIndex(bondType, typeA, typeB);
 
-    std::map<int, MmffBondStrechParameters>::const_iterator iter = d->bondStrechParameters.find(index);
-    if(iter == d->bondStrechParameters.end()){
-        return 0;
-    }
-
-    return &iter->second;
+    return d->bondStrechParameters.find(index);
 }
 
 const MmffBondStrechParameters* MmffParameters::empiricalBondStrechParameters(int atomicNumberA, int atomicNumberB) const
@@ -526,24 +507,14 @@ const MmffAngleBendParameters* MmffParameters::angleBendParameters(int angleType
 
     int index = calculateAngleBendIndex(angleType, typeA, typeB, typeC);
 
-    std::map<int, MmffAngleBendParameters>::const_iterator iter = d->angleBendParameters.find(index);
-    if(iter == d->angleBendParameters.end()){
-        return 0;
-    }
-
-    return &iter->second;
+    return d->angleBendParameters.find(index);
 }
 
 const MmffStrechBendParameters* MmffParameters::strechBendParameters(int strechBendType, int typeA, int typeB, int typeC) const
 {
     int index = calculateStrechBendIndex(strechBendType, typeA, typeB, typeC);
 
-    std::map<int, MmffStrechBendParameters>::const_iterator iter = d->strechBendParameters.find(index);
-    if(iter == d->strechBendParameters.end()){
-        return 0;
-    }
-
-    return &iter->second;
+    return d->strechBendParameters.find(index);
 }
 
 const MmffStrechBendParameters* MmffParameters::defaultStrechBendParameters(int typeA, int typeB, int typeC) const
@@ -574,31 +545,30 @@ const MmffOutOfPlaneBendingParameters* MmffParameters::outOfPlaneBendingParamete
 
     int index = calculateOutOfPlaneBendingIndex(typeA, typeB, typeC, typeD);
 
-    std::map<int, MmffOutOfPlaneBendingParameters>::const_iterator iter;
-    iter = d->outOfPlaneBendingParameters.find(index);
-    if(iter != d->outOfPlaneBendingParameters.end()){
-        return &iter->second;
+    const MmffOutOfPlaneBendingParameters *parameters = d->outOfPlaneBendingParameters.find(index);
+    if(parameters){
+        return parameters;
     }
 
     // step down 3-2-3-3
     index = calculateOutOfPlaneBendingIndex(equivalentType(typeA, 3), typeB, equivalentType(typeC, 3), equivalentType(typeD, 3));
-    iter = d->outOfPlaneBendingParameters.find(index);
-    if(iter != d->outOfPlaneBendingParameters.end()){
-        return &iter->second;
+    parameters = d->outOfPlaneBendingParameters.find(index);
+    if(parameters){
+        return parameters;
     }
 
     // step down 4-2-4-4
     index = calculateOutOfPlaneBendingIndex(equivalentType(typeA, 4), typeB, equivalentType(typeC, 4), equivalentType(typeD, 4));
-    iter = d->outOfPlaneBendingParameters.find(index);
-    if(iter != d->outOfPlaneBendingParameters.end()){
-        return &iter->second;
+    parameters = d->outOfPlaneBendingParameters.find(index);
+    if(parameters){
+        return parameters;
     }
 
     // step down 5-2-5-5
     index = calculateOutOfPlaneBendingIndex(equivalentType(typeA, 5), typeB, equivalentType(typeC, 5), equivalentType(typeD, 5));
-    iter = d->outOfPlaneBendingParameters.find(index);
-    if(iter != d->outOfPlaneBendingParameters.end()){
-        return &iter->second;
+    parameters = d->outOfPlaneBendingParameters.find(index);
+    if(parameters){
+        return parameters;
     }
 
     return 0;
@@ -616,38 +586,37 @@ const MmffTorsionParameters* MmffParameters::torsionParameters(int torsionType,
 
     int index = calculateTorsionIndex(torsionType, typeA, typeB, typeC, typeD);
 
-    std::map<int, MmffTorsionParameters>::const_iterator iter;
-    iter = d->torsionParameters.find(index);
-    if(iter != d->torsionParameters.end()){
-        return &iter->second;
+    const MmffTorsionParameters *parameters = d->torsionParameters.find(index);
+    if(parameters){
+        return parameters;
     }
 
     // step down 3-2-2-5
     index = calculateTorsionIndex(torsionType, equivalentType(typeA, 3), typeB, typeC, equivalentType(typeD, 5));
-    iter = d->torsionParameters.find(index);
-    if(iter != d->torsionParameters.end()){
-        return &iter->second;
+    parameters = d->torsionParameters.find(index);
+    if(parameters){
+        return parameters;
     }
 
     // step down 5-2-2-3
     index = calculateTorsionIndex(torsionType, equivalentType(typeA, 5), typeB, typeC, equivalentType(typeD, 3));
-    iter = d->torsionParameters.find(index);
-    if(iter != d->torsionParameters.end()){
-        return &iter->second;
+    parameters = d->torsionParameters.find(index);
+    if(parameters){
+        return parameters;
     }
 
     // step down 5-2-2-5
     index = calculateTorsionIndex(torsionType, equivalentType(typeA, 5), typeB, typeC, equivalentType(typeD, 5));
-    iter = d->torsionParameters.find(index);
-    if(iter != d->torsionParameters.end()){
-        return &iter->second;
+    parameters = d->torsionParameters.find(index);
+    if(parameters){
+        return parameters;
     }
 
     // step down 5-2-2-5 (with no torsion type)
     index = calculateTorsionIndex(0, equivalentType(typeA, 5), typeB, typeC, equivalentType(typeD, 5));
-    iter = d->torsionParameters.find(index);
-    if(iter != d->torsionParameters.end()){
-        return &iter->second;
+    parameters = d->torsionParameters.find(index);
+    if(parameters){
+        return parameters;
     }
 
     return 0;
@@ -656,14 +625,13 @@ const MmffTorsionParameters* MmffParameters::torsionParameters(int torsionType,
 // --- Static Methods ------------------------------------------------------ //
 int MmffParameters::calculateBondType(const chemkit::Bond *bond, int typeA, int typeB)
 {
-    MmffParameters parameters;
-    const MmffAtomParameters *parametersA = parameters.atomParameters(typeA);
-    const MmffAtomParameters *parametersB = parameters.atomParameters(typeB);
-
-    if(!parametersA || !parametersB){
+    if(typeA < 1 || typeA > MaxAtomType || typeB < 1 || typeB > MaxAtomType){
         return 0;
     }
 
+    const MmffAtomParameters *parametersA = &AtomParameters[typeA-1];
+    const MmffAtomParameters *parametersB = &AtomParameters[typeB-1];
+
     if(bond->order() == chemkit::Bond::Single && !MmffAromaticityModel().isAromatic(bond)){
         if(parametersA->sbmb && parametersB->sbmb){
             return 1;
@@ -741,13 +709,16 @@ int MmffParameters::equivalentType(int type, int level) const
         return type;
     }
 
-    for(int i = 0; i < EquivalentTypesCount; i++){
-        if(EquivalentTypes[i][0] == type){
-            return EquivalentTypes[i][level-1];
-        }
+    if(type < 0 || type > MaxAtomType || !d->equivalentTypes[type]){
+        return 0;
     }
 
-    return 0;
+    return d->equivalentTypes[type][level-1];
+}
+
+int MmffParameters::calculateChargeIndex(int bondType, int typeA, int typeB)
+{
+    return 2 * (typeA * 136 + typeB) + bondType;
 }
 
 int MmffParameters::calculateBondStrechIndex(int bondType, int typeA, int typeB) const
@@ -151,6 +151,7 @@ public:
 
 private:
     int equivalentType(int type, int level) const;
+    static int calculateChargeIndex(int bondType, int typeA, int typeB);
     int calculateBondStrechIndex(int bondType, int typeA, int typeB) const;
     int calculateAngleBendIndex(int angleType, int typeA, int typeB, int typeC) const;
     int calculateStrechBendIndex(int strechBendType, int typeA, int typeB, int typeC) const;
@@ -162,7 +163,6 @@ private:
     std::string m_fileName;
     std::string m_errorString;
     boost::shared_ptr<MmffParametersData> d;
-    MmffAromaticityModel m_aromaticityModel;
 };
 
 #endif // MMFFPARAMETERS_H
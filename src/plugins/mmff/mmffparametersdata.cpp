@@ -40,6 +40,7 @@
 /// Creates a new parameters data object.
 MmffParametersData::MmffParametersData()
     : vanDerWaalsParameters(MmffParameters::MaxAtomType + 1),
-      partialChargeParameters(MmffParameters::MaxAtomType + 1)
+      partialChargeParameters(MmffParameters::MaxAtomType + 1),
+      equivalentTypes(MmffParameters::MaxAtomType + 1)
 {
 }
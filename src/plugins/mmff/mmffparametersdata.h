@@ -36,26 +36,105 @@
 #ifndef MMFFPARAMETERSDATA_H
 #define MMFFPARAMETERSDATA_H
 
-#include <map>
 #include <vector>
+#include <utility>
+#include <algorithm>
 
 #include "mmffparameters.h"
 
+// Stores parameters sorted by their index so that they can be found
+// with a binary search.
+template<typename T>
+class MmffParametersTable
+{
+public:
+    // parameters
+    void insert(int index, const T &parameters);
+    void sort();
+    const T* find(int index) const;
+
+private:
+    typedef std::pair<int, T> Entry;
+
+    static bool entryLessThan(const Entry &a, const Entry &b);
+    static bool indexLessThan(const Entry &entry, int index);
+
+private:
+    std::vector<Entry> m_entries;
+};
+
 class MmffParametersData
 {
 public:
     // construction and destruction
     MmffParametersData();
 
-    std::map<int, MmffBondStrechParameters> bondStrechParameters;
-    std::map<int, MmffAngleBendParameters> angleBendParameters;
-    std::map<int, MmffStrechBendParameters> strechBendParameters;
+    MmffParametersTable<MmffBondStrechParameters> bondStrechParameters;
+    MmffParametersTable<MmffAngleBendParameters> angleBendParameters;
+    MmffParametersTable<MmffStrechBendParameters> strechBendParameters;
     std::vector<MmffDefaultStrechBendParameters> defaultStrechBendParameters;
-    std::map<int, MmffOutOfPlaneBendingParameters> outOfPlaneBendingParameters;
-    std::map<int, MmffTorsionParameters> torsionParameters;
+    MmffParametersTable<MmffOutOfPlaneBendingParameters> outOfPlaneBendingParameters;
+    MmffParametersTable<MmffTorsionParameters> torsionParameters;
     std::vector<MmffVanDerWaalsParameters> vanDerWaalsParameters;
-    std::vector<MmffChargeParameters> chargeParameters;
+    MmffParametersTable<MmffChargeParameters> chargeParameters;
     std::vector<MmffPartialChargeParameters> partialChargeParameters;
+    std::vector<const int *> equivalentTypes;
 };
 
+// === MmffParametersTable ================================================= //
+/// Adds \p parameters with \p index to the table. sort() must be
+/// called before the parameters can be found.
+template<typename T>
+inline void MmffParametersTable<T>::insert(int index, const T &parameters)
+{
+    m_entries.push_back(std::make_pair(index, parameters));
+}
+
+/// Sorts the parameters by index. If more than one set of parameters
+/// was inserted with the same index the last one is kept.
+template<typename T>
+inline void MmffParametersTable<T>::sort()
+{
+    std::stable_sort(m_entries.begin(), m_entries.end(), entryLessThan);
+
+    std::vector<Entry> entries;
+    entries.reserve(m_entries.size());
+    for(size_t i = 0; i < m_entries.size(); i++){
+        if(!entries.empty() && entries.back().first == m_entries[i].first){
+            entries.back() = m_entries[i];
+        }
+        else{
+            entries.push_back(m_entries[i]);
+        }
+    }
+
+    m_entries.swap(entries);
+}
+
+/// Returns the parameters with \p index or \c 0 if there are none.
+template<typename T>
+inline const T* MmffParametersTable<T>::find(int index) const
+{
+    typename std::vector<Entry>::const_iterator iter =
+        std::lower_bound(m_entries.begin(), m_entries.end(), index, indexLessThan);
+
+    if(iter == m_entries.end() || iter->first != index){
+        return 0;
+    }
+
+    return &iter->second;
+}
+
+template<typename T>
+inline bool MmffParametersTable<T>::entryLessThan(const Entry &a, const Entry &b)
+{
+    return a.first < b.first;
+}
+
+template<typename T>
+inline bool MmffParametersTable<T>::indexLessThan(const Entry &entry, int index)
+{
+    return entry.first < index;
+}
+
 #endif // MMFFPARAMETERSDATA_H
@@ -38,6 +38,7 @@
 #include <chemkit/foreach.h>
 #include <chemkit/molecule.h>
 #include <chemkit/pluginmanager.h>
+#include <chemkit/forcefieldparameterscache.h>
 
 #include "mmffplugin.h"
 #include "mmffparameters.h"
@@ -47,7 +48,6 @@ MmffPartialChargeModel::MmffPartialChargeModel()
     : chemkit::PartialChargeModel("mmff")
 {
     m_typer = 0;
-    m_parameters = 0;
 
     // load parameters
     const chemkit::Plugin *mmffPlugin = chemkit::PluginManager::instance()->plugin("mmff");
@@ -55,17 +55,11 @@ MmffPartialChargeModel::MmffPartialChargeModel()
         return;
     }
 
-    m_parameters = new MmffParameters;
-    bool ok = m_parameters->read(mmffPlugin->dataPath() + "mmff94.prm");
-    if(!ok){
-        delete m_parameters;
-        m_parameters = 0;
-    }
+    m_parameters = chemkit::ForceFieldParametersCache<MmffParameters>::parameters(mmffPlugin->dataPath() + "mmff94.prm");
 }
 
 MmffPartialChargeModel::~MmffPartialChargeModel()
 {
-    delete m_parameters;
 }
 
 // --- Properties ---------------------------------------------------------- //
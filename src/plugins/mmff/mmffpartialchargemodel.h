@@ -36,6 +36,8 @@
 #ifndef MMFFPARTIALCHARGEMODEL_H
 #define MMFFPARTIALCHARGEMODEL_H
 
+#include <boost/shared_ptr.hpp>
+
 #include <chemkit/partialchargemodel.h>
 
 #include "mmffatomtyper.h"
@@ -58,7 +60,7 @@ public:
 private:
     std::vector<chemkit::Real> m_partialCharges;
     const MmffAtomTyper *m_typer;
-    MmffParameters *m_parameters;
+    boost::shared_ptr<const MmffParameters> m_parameters;
 };
 
 #endif // MMFFPARTIALCHARGEMODEL_H
@@ -39,7 +39,6 @@
 
 #include "mmffatomtyper.h"
 #include "mmffforcefield.h"
-#include "mmffparametersdata.h"
 #include "mmffaromaticitymodel.h"
 #include "mmffpartialchargemodel.h"
 
@@ -57,23 +56,6 @@ MmffPlugin::~MmffPlugin()
 {
 }
 
-void MmffPlugin::storeParameters(const std::string &name,
-                                 const boost::shared_ptr<MmffParametersData> &parameters)
-{
-    m_parametersCache[name] = parameters;
-}
-
-boost::shared_ptr<MmffParametersData> MmffPlugin::parameters(const std::string &name) const
-{
-    std::map<std::string, boost::shared_ptr<MmffParametersData> >::const_iterator iter;
-    iter = m_parametersCache.find(name);
-    if(iter == m_parametersCache.end()){
-        return boost::shared_ptr<MmffParametersData>();
-    }
-
-    return iter->second;
-}
-
 chemkit::MolecularDescriptor* MmffPlugin::createMmffEnergyDescriptor()
 {
     return new chemkit::ForceFieldEnergyDescriptor<MmffForceField>("mmff-energy");
@@ -36,30 +36,16 @@
 #ifndef MMFFPLUGIN_H
 #define MMFFPLUGIN_H
 
-#include <map>
-#include <string>
-
-#include <boost/shared_ptr.hpp>
-
 #include <chemkit/plugin.h>
 #include <chemkit/moleculardescriptor.h>
 
-class MmffParametersData;
-
 class MmffPlugin : public chemkit::Plugin
 {
 public:
     MmffPlugin();
     ~MmffPlugin();
 
-    void storeParameters(const std::string &name,
-                         const boost::shared_ptr<MmffParametersData> &parameters);
-    boost::shared_ptr<MmffParametersData> parameters(const std::string &name) const;
-
     static chemkit::MolecularDescriptor* createMmffEnergyDescriptor();
-
-private:
-    std::map<std::string, boost::shared_ptr<MmffParametersData> > m_parametersCache;
 };
 
 #endif // MMFFPLUGIN_H
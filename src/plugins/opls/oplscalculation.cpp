@@ -39,7 +39,7 @@
 
 #include <chemkit/topology.h>
 #include <chemkit/constants.h>
-#include <chemkit/cartesiancoordinates.h>
+#include <chemkit/geometry.h>
 
 // === OplsCalculation ===================================================== //
 OplsCalculation::OplsCalculation(int type, int atomCount, int parameterCount)
@@ -49,7 +49,7 @@ OplsCalculation::OplsCalculation(int type, int atomCount, int parameterCount)
 
 // === OplsBondStrechCalculation =========================================== //
 OplsBondStrechCalculation::OplsBondStrechCalculation(size_t a, size_t b)
-    : OplsCalculation(BondStrech, 2, 2)
+    : OplsCalculation(BondStrech, AtomCount, ParameterCount)
 {
     setAtom(0, a);
     setAtom(1, b);
@@ -71,43 +71,52 @@ bool OplsBondStrechCalculation::setup(const OplsParameters *parameters)
     return true;
 }
 
-chemkit::Real OplsBondStrechCalculation::energy(const chemkit::CartesianCoordinates *coordinates) const
+const chemkit::ForceFieldKernel* OplsBondStrechCalculation::kernel() const
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
+    static const chemkit::ForceFieldKernelAdaptor<OplsBondStrechCalculation> kernel;
+    return &kernel;
+}
+
+chemkit::Real OplsBondStrechCalculation::evaluateEnergy(const chemkit::Point3 *positions,
+                                                        const size_t *atoms,
+                                                        const chemkit::Real *parameters)
+{
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
 
-    chemkit::Real kb = parameter(0);
-    chemkit::Real r0 = parameter(1);
+    chemkit::Real kb = parameters[0];
+    chemkit::Real r0 = parameters[1];
 
-    chemkit::Real r = coordinates->distance(a, b);
+    chemkit::Real r = (a - b).norm();
 
     return kb * pow(r - r0, 2);
 }
 
-std::vector<chemkit::Vector3> OplsBondStrechCalculation::gradient(const chemkit::CartesianCoordinates *coordinates) const
+void OplsBondStrechCalculation::evaluateGradient(const chemkit::Point3 *positions,
+                                                 const size_t *atoms,
+                                                 const chemkit::Real *parameters,
+                                                 chemkit::Vector3 *gradient)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
 
-    chemkit::Real kb = parameter(0);
-    chemkit::Real r0 = parameter(1);
+    chemkit::Real kb = parameters[0];
+    chemkit::Real r0 = parameters[1];
 
-    chemkit::Real r = coordinates->distance(a, b);
+    chemkit::Real r = (a - b).norm();
 
-    boost::array<chemkit::Vector3, 2> gradient = coordinates->distanceGradient(a, b);
+    boost::array<chemkit::Vector3, 2> distanceGradient = chemkit::geometry::distanceGradient(a, b);
 
     // dE/dr
     chemkit::Real de_dr = 2.0 * kb * (r - r0);
 
-    gradient[0] *= de_dr;
-    gradient[1] *= de_dr;
-
-    return std::vector<chemkit::Vector3>(gradient.begin(), gradient.end());
+    gradient[0] = distanceGradient[0] * de_dr;
+    gradient[1] = distanceGradient[1] * de_dr;
 }
 
 // === OplsAngleBendCalculation ============================================ //
 OplsAngleBendCalculation::OplsAngleBendCalculation(size_t a, size_t b, size_t c)
-    : OplsCalculation(AngleBend, 3, 2)
+    : OplsCalculation(AngleBend, AtomCount, ParameterCount)
 {
     setAtom(0, a);
     setAtom(1, b);
@@ -131,46 +140,55 @@ bool OplsAngleBendCalculation::setup(const OplsParameters *parameters)
     return true;
 }
 
-chemkit::Real OplsAngleBendCalculation::energy(const chemkit::CartesianCoordinates *coordinates) const
+const chemkit::ForceFieldKernel* OplsAngleBendCalculation::kernel() const
+{
+    static const chemkit::ForceFieldKernelAdaptor<OplsAngleBendCalculation> kernel;
+    return &kernel;
+}
+
+chemkit::Real OplsAngleBendCalculation::evaluateEnergy(const chemkit::Point3 *positions,
+                                                       const size_t *atoms,
+                                                       const chemkit::Real *parameters)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+    const chemkit::Point3 &c = positions[atoms[2]];
 
-    chemkit::Real ka = parameter(0);
-    chemkit::Real theta0 = parameter(1);
+    chemkit::Real ka = parameters[0];
+    chemkit::Real theta0 = parameters[1];
 
-    chemkit::Real theta = coordinates->angleRadians(a, b, c);
+    chemkit::Real theta = chemkit::geometry::angleRadians(a, b, c);
 
     return ka * pow(theta - theta0, 2);
 }
 
-std::vector<chemkit::Vector3> OplsAngleBendCalculation::gradient(const chemkit::CartesianCoordinates *coordinates) const
+void OplsAngleBendCalculation::evaluateGradient(const chemkit::Point3 *positions,
+                                                const size_t *atoms,
+                                                const chemkit::Real *parameters,
+                                                chemkit::Vector3 *gradient)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+    const chemkit::Point3 &c = positions[atoms[2]];
 
-    chemkit::Real ka = parameter(0);
-    chemkit::Real theta0 = parameter(1);
+    chemkit::Real ka = parameters[0];
+    chemkit::Real theta0 = parameters[1];
 
-    chemkit::Real theta = coordinates->angleRadians(a, b, c);
+    chemkit::Real theta = chemkit::geometry::angleRadians(a, b, c);
 
-    boost::array<chemkit::Vector3, 3> gradient = coordinates->angleGradientRadians(a, b, c);
+    boost::array<chemkit::Vector3, 3> angleGradient = chemkit::geometry::angleGradientRadians(a, b, c);
 
     // dE/dtheta
     chemkit::Real de_dtheta = (2.0 * ka * (theta - theta0));
 
-    gradient[0] *= de_dtheta;
-    gradient[1] *= de_dtheta;
-    gradient[2] *= de_dtheta;
-
-    return std::vector<chemkit::Vector3>(gradient.begin(), gradient.end());
+    gradient[0] = angleGradient[0] * de_dtheta;
+    gradient[1] = angleGradient[1] * de_dtheta;
+    gradient[2] = angleGradient[2] * de_dtheta;
 }
 
 // === OplsTorsionCalculation ============================================== //
 OplsTorsionCalculation::OplsTorsionCalculation(size_t a, size_t b, size_t c, size_t d)
-    : OplsCalculation(Torsion, 4, 3)
+    : OplsCalculation(Torsion, AtomCount, ParameterCount)
 {
     setAtom(0, a);
     setAtom(1, b);
@@ -197,51 +215,60 @@ bool OplsTorsionCalculation::setup(const OplsParameters *parameters)
     return true;
 }
 
-chemkit::Real OplsTorsionCalculation::energy(const chemkit::CartesianCoordinates *coordinates) const
+const chemkit::ForceFieldKernel* OplsTorsionCalculation::kernel() const
+{
+    static const chemkit::ForceFieldKernelAdaptor<OplsTorsionCalculation> kernel;
+    return &kernel;
+}
+
+chemkit::Real OplsTorsionCalculation::evaluateEnergy(const chemkit::Point3 *positions,
+                                                     const size_t *atoms,
+                                                     const chemkit::Real *parameters)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
-    size_t d = atom(3);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+    const chemkit::Point3 &c = positions[atoms[2]];
+    const chemkit::Point3 &d = positions[atoms[3]];
 
-    chemkit::Real v1 = parameter(0);
-    chemkit::Real v2 = parameter(1);
-    chemkit::Real v3 = parameter(2);
+    chemkit::Real v1 = parameters[0];
+    chemkit::Real v2 = parameters[1];
+    chemkit::Real v3 = parameters[2];
 
-    chemkit::Real phi = coordinates->torsionAngleRadians(a, b, c, d);
+    chemkit::Real phi = chemkit::geometry::torsionAngleRadians(a, b, c, d);
 
     return (1.0/2.0) * (v1 * (1.0 + cos(phi)) + v2 * (1.0 - cos(2.0 * phi)) + v3 * (1.0 + cos(3.0 * phi)));
 }
 
-std::vector<chemkit::Vector3> OplsTorsionCalculation::gradient(const chemkit::CartesianCoordinates *coordinates) const
+void OplsTorsionCalculation::evaluateGradient(const chemkit::Point3 *positions,
+                                              const size_t *atoms,
+                                              const chemkit::Real *parameters,
+                                              chemkit::Vector3 *gradient)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
-    size_t d = atom(3);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+    const chemkit::Point3 &c = positions[atoms[2]];
+    const chemkit::Point3 &d = positions[atoms[3]];
 
-    chemkit::Real v1 = parameter(0);
-    chemkit::Real v2 = parameter(1);
-    chemkit::Real v3 = parameter(2);
+    chemkit::Real v1 = parameters[0];
+    chemkit::Real v2 = parameters[1];
+    chemkit::Real v3 = parameters[2];
 
-    chemkit::Real phi = coordinates->torsionAngleRadians(a, b, c, d);
+    chemkit::Real phi = chemkit::geometry::torsionAngleRadians(a, b, c, d);
 
     // dE/dphi
     chemkit::Real de_dphi = (1.0/2.0) * (-v1 * sin(phi) + 2.0 * v2 * sin(2.0 * phi) - 3.0 * v3 * sin(3.0 * phi));
 
-    boost::array<chemkit::Vector3, 4> gradient = coordinates->torsionAngleGradientRadians(a, b, c, d);
-
-    gradient[0] *= de_dphi;
-    gradient[1] *= de_dphi;
-    gradient[2] *= de_dphi;
-    gradient[3] *= de_dphi;
+    boost::array<chemkit::Vector3, 4> torsionGradient = chemkit::geometry::torsionAngleGradientRadians(a, b, c, d);
 
-    return std::vector<chemkit::Vector3>(gradient.begin(), gradient.end());
+    gradient[0] = torsionGradient[0] * de_dphi;
+    gradient[1] = torsionGradient[1] * de_dphi;
+    gradient[2] = torsionGradient[2] * de_dphi;
+    gradient[3] = torsionGradient[3] * de_dphi;
 }
 
 // === OplsNonbondedCalculation ============================================ //
 OplsNonbondedCalculation::OplsNonbondedCalculation(size_t a, size_t b)
-    : OplsCalculation(VanDerWaals | Electrostatic, 2, 5)
+    : OplsCalculation(VanDerWaals | Electrostatic, AtomCount, ParameterCount)
 {
     setAtom(0, a);
     setAtom(1, b);
@@ -258,69 +285,93 @@ bool OplsNonbondedCalculation::setup(const OplsParameters *parameters)
         return false;
     }
 
-    chemkit::Real qa = parameters->partialCharge(typeA);
-    chemkit::Real qb = parameters->partialCharge(typeB);
-    chemkit::Real sigma = sqrt(pa->sigma * pb->sigma);
-    chemkit::Real epsilon = sqrt(pa->epsilon * pb->epsilon);
-
-    setParameter(0, qa);
-    setParameter(1, qb);
-    setParameter(2, sigma);
-    setParameter(3, epsilon);
+    chemkit::Real combinedParameters[ParameterCount];
+    combineParameters(parameters->partialCharge(typeA),
+                      parameters->partialCharge(typeB),
+                      pa,
+                      pb,
+                      topology()->isOneFour(atom(0), atom(1)),
+                      combinedParameters);
 
-    // one-four scaling
-    if(topology()->isOneFour(atom(0), atom(1))){
-        setParameter(4, 0.5);
-    }
-    else{
-        setParameter(4, 1.0);
+    for(int i = 0; i < ParameterCount; i++){
+        setParameter(i, combinedParameters[i]);
     }
 
     return true;
 }
 
-chemkit::Real OplsNonbondedCalculation::energy(const chemkit::CartesianCoordinates *coordinates) const
+// Combines the charges and van der waals parameters of two atoms into
+// the parameters for their interaction.
+void OplsNonbondedCalculation::combineParameters(chemkit::Real qa,
+                                                 chemkit::Real qb,
+                                                 const OplsVanDerWaalsParameters *pa,
+                                                 const OplsVanDerWaalsParameters *pb,
+                                                 bool oneFour,
+                                                 chemkit::Real *parameters)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
+    parameters[0] = qa;
+    parameters[1] = qb;
+    parameters[2] = sqrt(pa->sigma * pb->sigma);
+    parameters[3] = sqrt(pa->epsilon * pb->epsilon);
 
-    chemkit::Real qa = parameter(0);
-    chemkit::Real qb = parameter(1);
+    // one-four scaling
+    parameters[4] = oneFour ? 0.5 : 1.0;
+}
+
+const chemkit::ForceFieldKernel* OplsNonbondedCalculation::kernel() const
+{
+    static const chemkit::ForceFieldKernelAdaptor<OplsNonbondedCalculation> kernel;
+    return &kernel;
+}
+
+chemkit::Real OplsNonbondedCalculation::evaluateEnergy(const chemkit::Point3 *positions,
+                                                       const size_t *atoms,
+                                                       const chemkit::Real *parameters)
+{
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+
+    chemkit::Real qa = parameters[0];
+    chemkit::Real qb = parameters[1];
     chemkit::Real e = 332.06; // vacuum permitivity
-    chemkit::Real sigma = parameter(2);
-    chemkit::Real epsilon = parameter(3);
-    chemkit::Real scale = parameter(4);
+    chemkit::Real sigma = parameters[2];
+    chemkit::Real epsilon = parameters[3];
+    chemkit::Real scale = parameters[4];
 
-    chemkit::Real r = coordinates->distance(a, b);
+    chemkit::Real r = (a - b).norm();
+    chemkit::Real sr = sigma / r;
+    chemkit::Real sr2 = sr * sr;
+    chemkit::Real sr6 = sr2 * sr2 * sr2;
 
-    return scale * ((qa * qb * e) / r + 4.0 * epsilon * (pow(sigma / r, 12) - pow(sigma / r, 6)));
+    return scale * ((qa * qb * e) / r + 4.0 * epsilon * (sr6 * sr6 - sr6));
 }
 
-std::vector<chemkit::Vector3> OplsNonbondedCalculation::gradient(const chemkit::CartesianCoordinates *coordinates) const
+void OplsNonbondedCalculation::evaluateGradient(const chemkit::Point3 *positions,
+                                                const size_t *atoms,
+                                                const chemkit::Real *parameters,
+                                                chemkit::Vector3 *gradient)
 {
-    std::vector<chemkit::Vector3> gradient(2);
-
-    size_t a = atom(0);
-    size_t b = atom(1);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
 
-    chemkit::Real qa = parameter(0);
-    chemkit::Real qb = parameter(1);
+    chemkit::Real qa = parameters[0];
+    chemkit::Real qb = parameters[1];
     chemkit::Real e = 332.06; // vacuum permitivity
-    chemkit::Real sigma = parameter(2);
-    chemkit::Real epsilon = parameter(3);
-    chemkit::Real scale = parameter(4);
+    chemkit::Real sigma = parameters[2];
+    chemkit::Real epsilon = parameters[3];
+    chemkit::Real scale = parameters[4];
 
-    chemkit::Real r = coordinates->distance(a, b);
+    chemkit::Real r = (a - b).norm();
     chemkit::Real sr = sigma / r;
+    chemkit::Real sr2 = sr * sr;
+    chemkit::Real sr5 = sr2 * sr2 * sr;
 
     // dE/dr
-    chemkit::Real de_dr = scale * ((1.0 / pow(r, 3)) * (-qa * qb * e + -4.0 * epsilon * sigma * (12.0 * pow(sr, 11) - 6.0 * pow(sr, 5))));
+    chemkit::Real de_dr = scale * ((1.0 / (r * r * r)) * (-qa * qb * e + -4.0 * epsilon * sigma * (12.0 * sr5 * sr5 * sr - 6.0 * sr5)));
 
     // dE/da
-    chemkit::Vector3 de_da = (coordinates->position(a) - coordinates->position(b)) * de_dr;
+    chemkit::Vector3 de_da = (a - b) * de_dr;
 
     gradient[0] = de_da;
     gradient[1] = -de_da;
-
-    return gradient;
 }
@@ -36,6 +36,7 @@
 #ifndef OPLSCALCULATION_H
 #define OPLSCALCULATION_H
 
+#include <chemkit/forcefieldkernel.h>
 #include <chemkit/forcefieldcalculation.h>
 
 #include "oplsparameters.h"
@@ -52,41 +53,96 @@ protected:
 class OplsBondStrechCalculation : public OplsCalculation
 {
 public:
+    enum {
+        AtomCount = 2,
+        ParameterCount = 2
+    };
+
     OplsBondStrechCalculation(size_t a, size_t b);
 
     bool setup(const OplsParameters *parameters);
-    chemkit::Real energy(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
-    std::vector<chemkit::Vector3> gradient(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    const chemkit::ForceFieldKernel* kernel() const CHEMKIT_OVERRIDE;
+
+    static chemkit::Real evaluateEnergy(const chemkit::Point3 *positions,
+                                        const size_t *atoms,
+                                        const chemkit::Real *parameters);
+    static void evaluateGradient(const chemkit::Point3 *positions,
+                                 const size_t *atoms,
+                                 const chemkit::Real *parameters,
+                                 chemkit::Vector3 *gradient);
 };
 
 class OplsAngleBendCalculation : public OplsCalculation
 {
 public:
+    enum {
+        AtomCount = 3,
+        ParameterCount = 2
+    };
+
     OplsAngleBendCalculation(size_t a, size_t b, size_t c);
 
     bool setup(const OplsParameters *parameters);
-    chemkit::Real energy(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
-    std::vector<chemkit::Vector3> gradient(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    const chemkit::ForceFieldKernel* kernel() const CHEMKIT_OVERRIDE;
+
+    static chemkit::Real evaluateEnergy(const chemkit::Point3 *positions,
+                                        const size_t *atoms,
+                                        const chemkit::Real *parameters);
+    static void evaluateGradient(const chemkit::Point3 *positions,
+                                 const size_t *atoms,
+                                 const chemkit::Real *parameters,
+                                 chemkit::Vector3 *gradient);
 };
 
 class OplsTorsionCalculation : public OplsCalculation
 {
 public:
+    enum {
+        AtomCount = 4,
+        ParameterCount = 3
+    };
+
     OplsTorsionCalculation(size_t a, size_t b, size_t c, size_t d);
 
     bool setup(const OplsParameters *parameters);
-    chemkit::Real energy(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
-    std::vector<chemkit::Vector3> gradient(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    const chemkit::ForceFieldKernel* kernel() const CHEMKIT_OVERRIDE;
+
+    static chemkit::Real evaluateEnergy(const chemkit::Point3 *positions,
+                                        const size_t *atoms,
+                                        const chemkit::Real *parameters);
+    static void evaluateGradient(const chemkit::Point3 *positions,
+                                 const size_t *atoms,
+                                 const chemkit::Real *parameters,
+                                 chemkit::Vector3 *gradient);
 };
 
 class OplsNonbondedCalculation : public OplsCalculation
 {
 public:
+    enum {
+        AtomCount = 2,
+        ParameterCount = 5
+    };
+
     OplsNonbondedCalculation(size_t a, size_t b);
 
     bool setup(const OplsParameters *parameters);
-    chemkit::Real energy(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
-    std::vector<chemkit::Vector3> gradient(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    const chemkit::ForceFieldKernel* kernel() const CHEMKIT_OVERRIDE;
+
+    static void combineParameters(chemkit::Real qa,
+                                  chemkit::Real qb,
+                                  const OplsVanDerWaalsParameters *pa,
+                                  const OplsVanDerWaalsParameters *pb,
+                                  bool oneFour,
+                                  chemkit::Real *parameters);
+
+    static chemkit::Real evaluateEnergy(const chemkit::Point3 *positions,
+                                        const size_t *atoms,
+                                        const chemkit::Real *parameters);
+    static void evaluateGradient(const chemkit::Point3 *positions,
+                                 const size_t *atoms,
+                                 const chemkit::Real *parameters,
+                                 chemkit::Vector3 *gradient);
 };
 
 #endif // OPLSCALCULATION_H
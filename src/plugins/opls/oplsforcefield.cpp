@@ -41,6 +41,9 @@
 #include <chemkit/foreach.h>
 #include <chemkit/topology.h>
 #include <chemkit/pluginmanager.h>
+#include <chemkit/forcefieldparameterscache.h>
+
+#include <boost/lexical_cast.hpp>
 
 #include "oplsatomtyper.h"
 #include "oplsparameters.h"
@@ -50,28 +53,41 @@
 OplsForceField::OplsForceField()
     : chemkit::ForceField("opls")
 {
-    m_parameters = 0;
+    m_nonbondedKernel = 0;
     setFlags(chemkit::ForceField::AnalyticalGradient);
 
     const chemkit::Plugin *oplsPlugin = chemkit::PluginManager::instance()->plugin("opls");
     if(oplsPlugin){
-        m_parameters = new OplsParameters(oplsPlugin->dataPath() + "oplsaa.prm");
+        addParameterSet("oplsaa", oplsPlugin->dataPath() + "oplsaa.prm");
+        setParameterSet("oplsaa");
     }
 }
 
 OplsForceField::~OplsForceField()
 {
-    delete m_parameters;
 }
 
 // --- Parameterization ---------------------------------------------------- //
 bool OplsForceField::setup()
 {
+    // the parsed parameters are shared between force fields
+    if(!m_parameters || m_parameters->fileName() != parameterFile()){
+        std::string errorString;
+        m_parameters = chemkit::ForceFieldParametersCache<OplsParameters>::parameters(parameterFile(), &errorString);
+        if(!m_parameters){
+            setErrorString("Failed to load parameters: " + errorString);
+            return false;
+        }
+    }
+
     const boost::shared_ptr<chemkit::Topology> &topology = this->topology();
     if(!topology){
         return false;
     }
 
+    // remove the calculations from a previous setup
+    clearCalculations();
+
     foreach(const chemkit::Topology::BondedInteraction &interaction, topology->bondedInteractions()){
         addCalculation(new OplsBondStrechCalculation(interaction[0],
                                                      interaction[1]));
@@ -97,8 +113,32 @@ bool OplsForceField::setup()
 
     bool ok = true;
 
+    // nonbonded kernel for the neighbor list. pairs with an atom
+    // without parameters are skipped as with the nonbonded calculations.
+    if(nonbondedCutoff() > 0){
+        clearNonbondedKernels();
+
+        m_charges.resize(topology->size());
+        m_vanDerWaalsParameters.resize(topology->size());
+
+        for(size_t i = 0; i < topology->size(); i++){
+            int type = boost::lexical_cast<int>(topology->type(i));
+
+            m_charges[i] = m_parameters->partialCharge(type);
+            m_vanDerWaalsParameters[i] = m_parameters->vanDerWaalsParameters(type);
+            if(!m_vanDerWaalsParameters[i]){
+                ok = false;
+            }
+        }
+
+        chemkit::ForceFieldKernel *nonbondedKernel =
+            new chemkit::ForceFieldKernelAdaptor<OplsNonbondedCalculation>;
+        addNonbondedKernel(nonbondedKernel);
+        m_nonbondedKernel = nonbondedKernel;
+    }
+
     foreach(chemkit::ForceFieldCalculation *calculation, calculations()){
-        bool setup = static_cast<OplsCalculation *>(calculation)->setup(m_parameters);
+        bool setup = static_cast<OplsCalculation *>(calculation)->setup(m_parameters.get());
 
         if(!setup){
             ok = false;
@@ -109,3 +149,23 @@ bool OplsForceField::setup()
 
     return ok;
 }
+
+bool OplsForceField::nonbondedParameters(const chemkit::ForceFieldKernel *kernel,
+                                         size_t a,
+                                         size_t b,
+                                         bool oneFour,
+                                         chemkit::Real *parameters) const
+{
+    if(kernel == m_nonbondedKernel){
+        const OplsVanDerWaalsParameters *pa = m_vanDerWaalsParameters[a];
+        const OplsVanDerWaalsParameters *pb = m_vanDerWaalsParameters[b];
+        if(!pa || !pb){
+            return false;
+        }
+
+        OplsNonbondedCalculation::combineParameters(m_charges[a], m_charges[b], pa, pb, oneFour, parameters);
+        return true;
+    }
+
+    return false;
+}
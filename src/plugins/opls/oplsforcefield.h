@@ -36,9 +36,12 @@
 #ifndef OPLSFORCEFIELD_H
 #define OPLSFORCEFIELD_H
 
+#include <boost/shared_ptr.hpp>
+
 #include <chemkit/forcefield.h>
 
 class OplsParameters;
+struct OplsVanDerWaalsParameters;
 
 class OplsForceField : public chemkit::ForceField
 {
@@ -50,8 +53,14 @@ public:
     // parameterization
     bool setup();
 
+protected:
+    bool nonbondedParameters(const chemkit::ForceFieldKernel *kernel, size_t a, size_t b, bool oneFour, chemkit::Real *parameters) const CHEMKIT_OVERRIDE;
+
 private:
-    OplsParameters *m_parameters;
+    boost::shared_ptr<const OplsParameters> m_parameters;
+    std::vector<chemkit::Real> m_charges;
+    std::vector<const OplsVanDerWaalsParameters *> m_vanDerWaalsParameters;
+    const chemkit::ForceFieldKernel *m_nonbondedKernel;
 };
 
 #endif // OPLSFORCEFIELD_H
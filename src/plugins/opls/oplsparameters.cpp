@@ -36,29 +36,59 @@
 #include "oplsparameters.h"
 
 #include <fstream>
+#include <algorithm>
 
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
 
-#include <chemkit/foreach.h>
 
-// --- Construction and Destruction ---------------------------------------- //
-OplsParameters::OplsParameters(const std::string &fileName)
-    : m_fileName(fileName)
+namespace {
+
+// The bond, angle and torsion parameters are sorted by their atom
+// classes so that they can be found with a binary search. Parameters
+// with the same atom classes keep the order they were read in.
+bool bondStrechLessThan(const OplsBondStrechParameters &a, const OplsBondStrechParameters &b)
 {
-    read(fileName);
+    if(a.typeA != b.typeA)
+        return a.typeA < b.typeA;
+
+    return a.typeB < b.typeB;
 }
 
-OplsParameters::~OplsParameters()
+bool angleBendLessThan(const OplsAngleBendParameters &a, const OplsAngleBendParameters &b)
 {
+    if(a.typeA != b.typeA)
+        return a.typeA < b.typeA;
+    if(a.typeB != b.typeB)
+        return a.typeB < b.typeB;
+
+    return a.typeC < b.typeC;
 }
 
-// --- Properties ---------------------------------------------------------- //
-void OplsParameters::setFileName(const std::string &fileName)
+bool torsionLessThan(const OplsTorsionParameters &a, const OplsTorsionParameters &b)
 {
-    m_fileName = fileName;
+    if(a.typeA != b.typeA)
+        return a.typeA < b.typeA;
+    if(a.typeB != b.typeB)
+        return a.typeB < b.typeB;
+    if(a.typeC != b.typeC)
+        return a.typeC < b.typeC;
+
+    return a.typeD < b.typeD;
 }
 
+} // end anonymous namespace
+
+// --- Construction and Destruction ---------------------------------------- //
+OplsParameters::OplsParameters()
+{
+}
+
+OplsParameters::~OplsParameters()
+{
+}
+
+// --- Properties ---------------------------------------------------------- //
 std::string OplsParameters::fileName() const
 {
     return m_fileName;
@@ -89,13 +119,17 @@ const OplsBondStrechParameters* OplsParameters::bondStrechParameters(int a, int
         std::swap(a, b);
     }
 
-    foreach(const OplsBondStrechParameters &p, m_bondStrechParameters){
-        if(p.typeA == a && p.typeB == b){
-            return &p;
-        }
+    OplsBondStrechParameters key;
+    key.typeA = a;
+    key.typeB = b;
+
+    std::vector<OplsBondStrechParameters>::const_iterator iter =
+        std::lower_bound(m_bondStrechParameters.begin(), m_bondStrechParameters.end(), key, bondStrechLessThan);
+    if(iter == m_bondStrechParameters.end() || bondStrechLessThan(key, *iter)){
+        return 0;
     }
 
-    return 0;
+    return &*iter;
 }
 
 const OplsAngleBendParameters* OplsParameters::angleBendParameters(int a, int b, int c) const
@@ -108,13 +142,18 @@ const OplsAngleBendParameters* OplsParameters::angleBendParameters(int a, int b,
         std::swap(a, c);
     }
 
-    foreach(const OplsAngleBendParameters &p, m_angleBendParameters){
-        if(p.typeA == a && p.typeB == b && p.typeC == c){
-            return &p;
-        }
+    OplsAngleBendParameters key;
+    key.typeA = a;
+    key.typeB = b;
+    key.typeC = c;
+
+    std::vector<OplsAngleBendParameters>::const_iterator iter =
+        std::lower_bound(m_angleBendParameters.begin(), m_angleBendParameters.end(), key, angleBendLessThan);
+    if(iter == m_angleBendParameters.end() || angleBendLessThan(key, *iter)){
+        return 0;
     }
 
-    return 0;
+    return &*iter;
 }
 
 const OplsTorsionParameters* OplsParameters::torsionParameters(int a, int b, int c, int d) const
@@ -132,13 +171,19 @@ const OplsTorsionParameters* OplsParameters::torsionParameters(int a, int b, int
         std::swap(a, d);
     }
 
-    foreach(const OplsTorsionParameters &p, m_torsionParameters){
-        if(p.typeA == a && p.typeB == b && p.typeC == c && p.typeD == d){
-            return &p;
-        }
+    OplsTorsionParameters key;
+    key.typeA = a;
+    key.typeB = b;
+    key.typeC = c;
+    key.typeD = d;
+
+    std::vector<OplsTorsionParameters>::const_iterator iter =
+        std::lower_bound(m_torsionParameters.begin(), m_torsionParameters.end(), key, torsionLessThan);
+    if(iter == m_torsionParameters.end() || torsionLessThan(key, *iter)){
+        return 0;
     }
 
-    return 0;
+    return &*iter;
 }
 
 const OplsVanDerWaalsParameters* OplsParameters::vanDerWaalsParameters(int type) const
@@ -146,14 +191,16 @@ const OplsVanDerWaalsParameters* OplsParameters::vanDerWaalsParameters(int type)
     return &m_vanDerWaalsParameters[type];
 }
 
-// --- Internal Methods ---------------------------------------------------- //
 bool OplsParameters::read(const std::string &fileName)
 {
     std::ifstream file(fileName.c_str());
     if(!file.is_open()){
+        m_errorString = "Failed to open parameters file.";
         return false;
     }
 
+    m_fileName = fileName;
+
     while(!file.eof()){
         std::string line;
         std::getline(file, line);
@@ -285,5 +332,15 @@ bool OplsParameters::read(const std::string &fileName)
         }
     }
 
+    std::stable_sort(m_bondStrechParameters.begin(), m_bondStrechParameters.end(), bondStrechLessThan);
+    std::stable_sort(m_angleBendParameters.begin(), m_angleBendParameters.end(), angleBendLessThan);
+    std::stable_sort(m_torsionParameters.begin(), m_torsionParameters.end(), torsionLessThan);
+
     return true;
 }
+
+// --- Error Handling ------------------------------------------------------ //
+std::string OplsParameters::errorString() const
+{
+    return m_errorString;
+}
@@ -79,14 +79,14 @@ class OplsParameters
 {
 public:
     // construction and destruction
-    OplsParameters(const std::string &fileName);
+    OplsParameters();
     ~OplsParameters();
 
     // properties
-    void setFileName(const std::string &fileName);
     std::string fileName() const;
 
     // parameters
+    bool read(const std::string &fileName);
     int atomClass(int type) const;
     std::string atomName(int type) const;
     chemkit::Real partialCharge(int type) const;
@@ -95,11 +95,12 @@ public:
     const OplsTorsionParameters* torsionParameters(int a, int b, int c, int d) const;
     const OplsVanDerWaalsParameters* vanDerWaalsParameters(int type) const;
 
-private:
-    bool read(const std::string &fileName);
+    // error handling
+    std::string errorString() const;
 
 private:
     std::string m_fileName;
+    std::string m_errorString;
     std::vector<int> m_typeToClass;
     std::vector<std::string> m_typeToName;
     std::vector<OplsBondStrechParameters> m_bondStrechParameters;
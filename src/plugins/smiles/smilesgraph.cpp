@@ -51,6 +51,43 @@
 
 #include "smiles.h"
 
+namespace {
+
+// Returns true if a path exists between the atoms of bond without
+// using bond itself or any of the bonds in ringBonds. Such a path
+// together with bond forms a cycle so only ring bonds are followed
+// and the search stays within the bond's ring system.
+bool isCyclic(const chemkit::Bond *bond, const std::set<const chemkit::Bond *> &ringBonds)
+{
+    std::set<const chemkit::Atom *> visited;
+    std::queue<const chemkit::Atom *> queue;
+    visited.insert(bond->atom1());
+    queue.push(bond->atom1());
+
+    while(!queue.empty()){
+        const chemkit::Atom *atom = queue.front();
+        queue.pop();
+
+        foreach(const chemkit::Bond *neighborBond, atom->bonds()){
+            if(neighborBond == bond || !neighborBond->isInRing() || ringBonds.find(neighborBond) != ringBonds.end()){
+                continue;
+            }
+
+            const chemkit::Atom *neighbor = neighborBond->otherAtom(atom);
+            if(neighbor == bond->atom2()){
+                return true;
+            }
+            else if(visited.insert(neighbor).second){
+                queue.push(neighbor);
+            }
+        }
+    }
+
+    return false;
+}
+
+} // end anonymous namespace
+
 // === SmilesGraphNode ===================================================== //
 SmilesGraphNode::SmilesGraphNode(const chemkit::Atom *atom)
     : m_atom(atom),
@@ -284,6 +321,10 @@ SmilesGraph::SmilesGraph(const chemkit::Molecule *molecule)
                     else if(neighborCounts[neighbor->index()] <= 1){
                         continue;
                     }
+                    else if(!isCyclic(atom->bondTo(neighbor), ringBonds)){
+                        // opening the ring here would disconnect the molecule
+                        continue;
+                    }
 
                     ringClosingAtom = neighbor;
                 }
@@ -35,9 +35,118 @@
 
 #include "surfacedescriptors.h"
 
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <chemkit/atom.h>
+#include <chemkit/foreach.h>
 #include <chemkit/molecule.h>
 #include <chemkit/molecularsurface.h>
 
+namespace {
+
+// === SurfaceCache ======================================================== //
+// Caches the surface area and volume of the most recently measured
+// atom positions and radii so that the area and volume descriptors
+// for a molecule share a single surface (and alpha shape) per surface
+// type. Only the measurements are kept, the surface itself is
+// destroyed once it has been measured. The mutex is only held while
+// looking up or storing a measurement, the surface is computed
+// without it.
+class SurfaceCache
+{
+public:
+    static chemkit::Real surfaceArea(const chemkit::Molecule *molecule, chemkit::MolecularSurface::SurfaceType type);
+    static chemkit::Real volume(const chemkit::Molecule *molecule, chemkit::MolecularSurface::SurfaceType type);
+
+private:
+    static void measure(const chemkit::Molecule *molecule,
+                        chemkit::MolecularSurface::SurfaceType type,
+                        chemkit::Real *surfaceArea,
+                        chemkit::Real *volume);
+
+    static boost::mutex m_mutex;
+    static std::vector<chemkit::Point3> m_positions;
+    static std::vector<chemkit::Real> m_radii;
+    static bool m_measured[2];
+    static chemkit::Real m_surfaceAreas[2];
+    static chemkit::Real m_volumes[2];
+};
+
+boost::mutex SurfaceCache::m_mutex;
+std::vector<chemkit::Point3> SurfaceCache::m_positions;
+std::vector<chemkit::Real> SurfaceCache::m_radii;
+bool SurfaceCache::m_measured[2] = { false, false };
+chemkit::Real SurfaceCache::m_surfaceAreas[2];
+chemkit::Real SurfaceCache::m_volumes[2];
+
+chemkit::Real SurfaceCache::surfaceArea(const chemkit::Molecule *molecule, chemkit::MolecularSurface::SurfaceType type)
+{
+    chemkit::Real surfaceArea;
+    chemkit::Real volume;
+    measure(molecule, type, &surfaceArea, &volume);
+
+    return surfaceArea;
+}
+
+chemkit::Real SurfaceCache::volume(const chemkit::Molecule *molecule, chemkit::MolecularSurface::SurfaceType type)
+{
+    chemkit::Real surfaceArea;
+    chemkit::Real volume;
+    measure(molecule, type, &surfaceArea, &volume);
+
+    return volume;
+}
+
+// Sets surfaceArea and volume to the measurements of the surface of
+// type for molecule.
+void SurfaceCache::measure(const chemkit::Molecule *molecule,
+                           chemkit::MolecularSurface::SurfaceType type,
+                           chemkit::Real *surfaceArea,
+                           chemkit::Real *volume)
+{
+    std::vector<chemkit::Point3> positions;
+    std::vector<chemkit::Real> radii;
+    positions.reserve(molecule->size());
+    radii.reserve(molecule->size());
+
+    foreach(const chemkit::Atom *atom, molecule->atoms()){
+        positions.push_back(atom->position());
+        radii.push_back(atom->vanDerWaalsRadius());
+    }
+
+    int index = type == chemkit::MolecularSurface::VanDerWaals ? 0 : 1;
+
+    {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        if(m_measured[index] && positions == m_positions && radii == m_radii){
+            *surfaceArea = m_surfaceAreas[index];
+            *volume = m_volumes[index];
+            return;
+        }
+    }
+
+    chemkit::MolecularSurface surface(molecule, type);
+    *surfaceArea = surface.surfaceArea();
+    *volume = surface.volume();
+
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    if(positions != m_positions || radii != m_radii){
+        m_positions.swap(positions);
+        m_radii.swap(radii);
+        m_measured[0] = false;
+        m_measured[1] = false;
+    }
+
+    m_measured[index] = true;
+    m_surfaceAreas[index] = *surfaceArea;
+    m_volumes[index] = *volume;
+}
+
+} // end anonymous namespace
+
 // === VanDerWallsAreaDescriptor =========================================== //
 VanDerWallsAreaDescriptor::VanDerWallsAreaDescriptor()
     : chemkit::MolecularDescriptor("vdw-area")
@@ -47,9 +156,7 @@ VanDerWallsAreaDescriptor::VanDerWallsAreaDescriptor()
 
 chemkit::Variant VanDerWallsAreaDescriptor::value(const chemkit::Molecule *molecule) const
 {
-    chemkit::MolecularSurface surface(molecule, chemkit::MolecularSurface::VanDerWaals);
-
-    return surface.surfaceArea();
+    return SurfaceCache::surfaceArea(molecule, chemkit::MolecularSurface::VanDerWaals);
 }
 
 // === VanDerWallsVolumeDescriptor ========================================= //
@@ -61,9 +168,7 @@ VanDerWallsVolumeDescriptor::VanDerWallsVolumeDescriptor()
 
 chemkit::Variant VanDerWallsVolumeDescriptor::value(const chemkit::Molecule *molecule) const
 {
-    chemkit::MolecularSurface surface(molecule, chemkit::MolecularSurface::VanDerWaals);
-
-    return surface.volume();
+    return SurfaceCache::volume(molecule, chemkit::MolecularSurface::VanDerWaals);
 }
 
 // == SolventAccessibleAreaDescriptor ====================================== //
@@ -75,9 +180,7 @@ SolventAccessibleAreaDescriptor::SolventAccessibleAreaDescriptor()
 
 chemkit::Variant SolventAccessibleAreaDescriptor::value(const chemkit::Molecule *molecule) const
 {
-    chemkit::MolecularSurface surface(molecule, chemkit::MolecularSurface::SolventAccessible);
-
-    return surface.surfaceArea();
+    return SurfaceCache::surfaceArea(molecule, chemkit::MolecularSurface::SolventAccessible);
 }
 
 // === SolventAccessibleVolumeDescriptor =================================== //
@@ -89,7 +192,5 @@ SolventAccessibleVolumeDescriptor::SolventAccessibleVolumeDescriptor()
 
 chemkit::Variant SolventAccessibleVolumeDescriptor::value(const chemkit::Molecule *molecule) const
 {
-    chemkit::MolecularSurface surface(molecule, chemkit::MolecularSurface::SolventAccessible);
-
-    return surface.volume();
+    return SurfaceCache::volume(molecule, chemkit::MolecularSurface::SolventAccessible);
 }
@@ -36,6 +36,7 @@
 #include "mol2fileformat.h"
 
 #include <boost/make_shared.hpp>
+#include <boost/lambda/lambda.hpp>
 #include <boost/algorithm/string.hpp>
 
 #include <chemkit/atom.h>
@@ -47,7 +48,8 @@
 #include "sybylatomtyper.h"
 
 Mol2FileFormat::Mol2FileFormat()
-    : chemkit::MoleculeFileFormat("mol2")
+    : chemkit::MoleculeFileFormat("mol2"),
+      m_moleculeHeaderRead(false)
 {
 }
 
@@ -56,48 +58,88 @@ Mol2FileFormat::~Mol2FileFormat()
 }
 
 bool Mol2FileFormat::read(std::istream &input, chemkit::MoleculeFile *file)
+{
+    m_moleculeHeaderRead = false;
+
+    for(;;){
+        boost::shared_ptr<chemkit::Molecule> molecule;
+
+        bool ok = readMolecule(input, molecule);
+        if(!ok){
+            return false;
+        }
+        else if(!molecule){
+            break;
+        }
+
+        file->addMolecule(molecule);
+    }
+
+    return true;
+}
+
+boost::shared_ptr<chemkit::Molecule> Mol2FileFormat::readNextMolecule(std::istream &input)
 {
     boost::shared_ptr<chemkit::Molecule> molecule;
+    readMolecule(input, molecule);
 
+    return molecule;
+}
+
+// Reads the next molecule record from input. Returns false if an error
+// occurs. If the end of the input has been reached molecule is left null.
+bool Mol2FileFormat::readMolecule(std::istream &input, boost::shared_ptr<chemkit::Molecule> &molecule)
+{
     int atomCount = 0;
     int bondCount = 0;
 
-    while(!input.eof()){
+    // read molecule header
+    while(!molecule){
         std::string line;
-        std::getline(input, line);
 
-        if(boost::starts_with(line, "@<TRIPOS>MOLECULE")){
-            if(molecule){
-                file->addMolecule(molecule);
+        // skip to the start of the next molecule record
+        while(!m_moleculeHeaderRead){
+            if(!std::getline(input, line)){
+                return true;
             }
 
-            std::string name;
-            std::getline(input, name);
-            boost::trim(name);
-
-            std::string countsLineString;
-            std::getline(input, countsLineString);
-            boost::trim_left(countsLineString);
-            std::vector<std::string> countsLine;
-            boost::split(countsLine,
-                         countsLineString,
-                         boost::is_any_of(" \t"),
-                         boost::token_compress_on);
-            if(countsLine.size() < 2){
-                continue;
-            }
+            m_moleculeHeaderRead = boost::starts_with(line, "@<TRIPOS>MOLECULE");
+        }
 
-            atomCount = boost::lexical_cast<int>(countsLine[0]);
-            bondCount = boost::lexical_cast<int>(countsLine[1]);
+        m_moleculeHeaderRead = false;
+
+        std::string name;
+        std::getline(input, name);
+        boost::trim(name);
+
+        std::string countsLineString;
+        std::getline(input, countsLineString);
+        boost::trim_left(countsLineString);
+        std::vector<std::string> countsLine;
+        boost::split(countsLine,
+                     countsLineString,
+                     boost::is_any_of(" \t"),
+                     boost::token_compress_on);
+        if(countsLine.size() < 2){
+            continue;
+        }
 
-            molecule = boost::make_shared<chemkit::Molecule>();
+        atomCount = boost::lexical_cast<int>(countsLine[0]);
+        bondCount = boost::lexical_cast<int>(countsLine[1]);
 
-            if(!name.empty()){
-                molecule->setName(name);
-            }
+        molecule = boost::make_shared<chemkit::Molecule>();
+
+        if(!name.empty()){
+            molecule->setName(name);
         }
-        else if(!molecule){
-            continue;
+    }
+
+    // read molecule sections up to the start of the next molecule
+    std::string line;
+    while(std::getline(input, line)){
+        if(boost::starts_with(line, "@<TRIPOS>MOLECULE")){
+            m_moleculeHeaderRead = true;
+            break;
         }
         else if(boost::starts_with(line, "@<TRIPOS>")){
             boost::trim(line);
@@ -114,6 +156,8 @@ bool Mol2FileFormat::read(std::istream &input, chemkit::MoleculeFile *file)
                                  boost::is_any_of(" \t"),
                                  boost::token_compress_on);
                     if(atomLine.size() < 6){
+                        setErrorString("Invalid atom line");
+                        molecule.reset();
                         return false;
                     }
 
@@ -189,13 +233,22 @@ bool Mol2FileFormat::read(std::istream &input, chemkit::MoleculeFile *file)
         }
     }
 
-    if(molecule){
-        file->addMolecule(molecule);
-    }
 
     return true;
 }
 
+bool Mol2FileFormat::writeMolecule(const chemkit::Molecule *molecule, std::ostream &output)
+{
+    // create a shared_ptr with a null deleter
+    boost::shared_ptr<chemkit::Molecule> moleculePointer(const_cast<chemkit::Molecule *>(molecule),
+                                                         boost::lambda::_1);
+
+    chemkit::MoleculeFile file;
+    file.addMolecule(moleculePointer);
+
+    return write(&file, output);
+}
+
 bool Mol2FileFormat::write(const chemkit::MoleculeFile *file, std::ostream &output)
 {
     char line[80];
@@ -46,6 +46,14 @@ public:
 
     bool read(std::istream &input, chemkit::MoleculeFile *file) CHEMKIT_OVERRIDE;
     bool write(const chemkit::MoleculeFile *file, std::ostream &output) CHEMKIT_OVERRIDE;
+    boost::shared_ptr<chemkit::Molecule> readNextMolecule(std::istream &input) CHEMKIT_OVERRIDE;
+    bool writeMolecule(const chemkit::Molecule *molecule, std::ostream &output) CHEMKIT_OVERRIDE;
+
+private:
+    bool readMolecule(std::istream &input, boost::shared_ptr<chemkit::Molecule> &molecule);
+
+private:
+    bool m_moleculeHeaderRead;
 };
 
 #endif // MOL2FILEFORMAT_H
@@ -43,7 +43,7 @@
 
 #include <chemkit/topology.h>
 #include <chemkit/constants.h>
-#include <chemkit/cartesiancoordinates.h>
+#include <chemkit/geometry.h>
 
 // === UffCalculation ====================================================== //
 UffCalculation::UffCalculation(int type, int atomCount, int parameterCount)
@@ -90,7 +90,7 @@ chemkit::Real UffCalculation::bondLength(const UffAtomParameters *a, const UffAt
 
 // === UffBondStrechCalculation ============================================ //
 UffBondStrechCalculation::UffBondStrechCalculation(size_t a, size_t b)
-    : UffCalculation(BondStrech, 2, 2)
+    : UffCalculation(BondStrech, AtomCount, ParameterCount)
 {
     setAtom(0, a);
     setAtom(1, b);
@@ -121,41 +121,50 @@ bool UffBondStrechCalculation::setup()
     return true;
 }
 
-chemkit::Real UffBondStrechCalculation::energy(const chemkit::CartesianCoordinates *coordinates) const
+const chemkit::ForceFieldKernel* UffBondStrechCalculation::kernel() const
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
+    static const chemkit::ForceFieldKernelAdaptor<UffBondStrechCalculation> kernel;
+    return &kernel;
+}
+
+chemkit::Real UffBondStrechCalculation::evaluateEnergy(const chemkit::Point3 *positions,
+                                                       const size_t *atoms,
+                                                       const chemkit::Real *parameters)
+{
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
 
-    chemkit::Real kb = parameter(0);
-    chemkit::Real r0 = parameter(1);
-    chemkit::Real r = coordinates->distance(a, b);
+    chemkit::Real kb = parameters[0];
+    chemkit::Real r0 = parameters[1];
+    chemkit::Real r = (a - b).norm();
 
     return 0.5 * kb * pow(r - r0, 2);
 }
 
-std::vector<chemkit::Vector3> UffBondStrechCalculation::gradient(const chemkit::CartesianCoordinates *coordinates) const
+void UffBondStrechCalculation::evaluateGradient(const chemkit::Point3 *positions,
+                                                const size_t *atoms,
+                                                const chemkit::Real *parameters,
+                                                chemkit::Vector3 *gradient)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
 
-    chemkit::Real kb = parameter(0);
-    chemkit::Real r0 = parameter(1);
-    chemkit::Real r = coordinates->distance(a, b);
+    chemkit::Real kb = parameters[0];
+    chemkit::Real r0 = parameters[1];
+    chemkit::Real r = (a - b).norm();
 
     // dE/dr
     chemkit::Real de_dr = kb * (r - r0);
 
-    boost::array<chemkit::Vector3, 2> gradient = coordinates->distanceGradient(a, b);
-
-    gradient[0] *= de_dr;
-    gradient[1] *= de_dr;
+    boost::array<chemkit::Vector3, 2> distanceGradient = chemkit::geometry::distanceGradient(a, b);
 
-    return std::vector<chemkit::Vector3>(gradient.begin(), gradient.end());
+    gradient[0] = distanceGradient[0] * de_dr;
+    gradient[1] = distanceGradient[1] * de_dr;
 }
 
 // === UffAngleBendCalculation ============================================= //
 UffAngleBendCalculation::UffAngleBendCalculation(size_t a, size_t b, size_t c)
-    : UffCalculation(AngleBend, 3, 4)
+    : UffCalculation(AngleBend, AtomCount, ParameterCount)
 {
     setAtom(0, a);
     setAtom(1, b);
@@ -210,49 +219,58 @@ bool UffAngleBendCalculation::setup()
     return true;
 }
 
-chemkit::Real UffAngleBendCalculation::energy(const chemkit::CartesianCoordinates *coordinates) const
+const chemkit::ForceFieldKernel* UffAngleBendCalculation::kernel() const
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
+    static const chemkit::ForceFieldKernelAdaptor<UffAngleBendCalculation> kernel;
+    return &kernel;
+}
 
-    chemkit::Real ka = parameter(0);
-    chemkit::Real c0 = parameter(1);
-    chemkit::Real c1 = parameter(2);
-    chemkit::Real c2 = parameter(3);
+chemkit::Real UffAngleBendCalculation::evaluateEnergy(const chemkit::Point3 *positions,
+                                                      const size_t *atoms,
+                                                      const chemkit::Real *parameters)
+{
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+    const chemkit::Point3 &c = positions[atoms[2]];
 
-    chemkit::Real theta = coordinates->angleRadians(a, b, c);
+    chemkit::Real ka = parameters[0];
+    chemkit::Real c0 = parameters[1];
+    chemkit::Real c1 = parameters[2];
+    chemkit::Real c2 = parameters[3];
+
+    chemkit::Real theta = chemkit::geometry::angleRadians(a, b, c);
 
     return ka * (c0 + (c1 * cos(theta)) + (c2 * cos(2*theta)));
 }
 
-std::vector<chemkit::Vector3> UffAngleBendCalculation::gradient(const chemkit::CartesianCoordinates *coordinates) const
+void UffAngleBendCalculation::evaluateGradient(const chemkit::Point3 *positions,
+                                               const size_t *atoms,
+                                               const chemkit::Real *parameters,
+                                               chemkit::Vector3 *gradient)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+    const chemkit::Point3 &c = positions[atoms[2]];
 
-    chemkit::Real ka = parameter(0);
-    chemkit::Real c1 = parameter(2);
-    chemkit::Real c2 = parameter(3);
+    chemkit::Real ka = parameters[0];
+    chemkit::Real c1 = parameters[2];
+    chemkit::Real c2 = parameters[3];
 
-    chemkit::Real theta = coordinates->angleRadians(a, b, c);
+    chemkit::Real theta = chemkit::geometry::angleRadians(a, b, c);
 
     // dE/dtheta
     chemkit::Real de_dtheta = -ka * (c1 * sin(theta) + 2 * c2 * sin(2 * theta));
 
-    boost::array<chemkit::Vector3, 3> gradient = coordinates->angleGradientRadians(a, b, c);
+    boost::array<chemkit::Vector3, 3> angleGradient = chemkit::geometry::angleGradientRadians(a, b, c);
 
-    gradient[0] *= de_dtheta;
-    gradient[1] *= de_dtheta;
-    gradient[2] *= de_dtheta;
-
-    return std::vector<chemkit::Vector3>(gradient.begin(), gradient.end());
+    gradient[0] = angleGradient[0] * de_dtheta;
+    gradient[1] = angleGradient[1] * de_dtheta;
+    gradient[2] = angleGradient[2] * de_dtheta;
 }
 
 // === UffTorsionCalculation =============================================== //
 UffTorsionCalculation::UffTorsionCalculation(size_t a, size_t b, size_t c, size_t d)
-    : UffCalculation(Torsion, 4, 3)
+    : UffCalculation(Torsion, AtomCount, ParameterCount)
 {
     setAtom(0, a);
     setAtom(1, b);
@@ -349,51 +367,60 @@ bool UffTorsionCalculation::setup()
     return true;
 }
 
-chemkit::Real UffTorsionCalculation::energy(const chemkit::CartesianCoordinates *coordinates) const
+const chemkit::ForceFieldKernel* UffTorsionCalculation::kernel() const
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
-    size_t d = atom(3);
+    static const chemkit::ForceFieldKernelAdaptor<UffTorsionCalculation> kernel;
+    return &kernel;
+}
 
-    chemkit::Real V = parameter(0);
-    chemkit::Real n = parameter(1);
-    chemkit::Real phi0 = parameter(2);
+chemkit::Real UffTorsionCalculation::evaluateEnergy(const chemkit::Point3 *positions,
+                                                    const size_t *atoms,
+                                                    const chemkit::Real *parameters)
+{
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+    const chemkit::Point3 &c = positions[atoms[2]];
+    const chemkit::Point3 &d = positions[atoms[3]];
 
-    chemkit::Real phi = coordinates->torsionAngleRadians(a, b, c, d);
+    chemkit::Real V = parameters[0];
+    chemkit::Real n = parameters[1];
+    chemkit::Real phi0 = parameters[2];
+
+    chemkit::Real phi = chemkit::geometry::torsionAngleRadians(a, b, c, d);
 
     return 0.5 * V * (1 - cos(n * phi0) * cos(n * phi));
 }
 
-std::vector<chemkit::Vector3> UffTorsionCalculation::gradient(const chemkit::CartesianCoordinates *coordinates) const
+void UffTorsionCalculation::evaluateGradient(const chemkit::Point3 *positions,
+                                             const size_t *atoms,
+                                             const chemkit::Real *parameters,
+                                             chemkit::Vector3 *gradient)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
-    size_t d = atom(3);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+    const chemkit::Point3 &c = positions[atoms[2]];
+    const chemkit::Point3 &d = positions[atoms[3]];
 
-    chemkit::Real V = parameter(0);
-    chemkit::Real n = parameter(1);
-    chemkit::Real phi0 = parameter(2);
+    chemkit::Real V = parameters[0];
+    chemkit::Real n = parameters[1];
+    chemkit::Real phi0 = parameters[2];
 
-    chemkit::Real phi = coordinates->torsionAngleRadians(a, b, c, d);
+    chemkit::Real phi = chemkit::geometry::torsionAngleRadians(a, b, c, d);
 
     // dE/dphi
     chemkit::Real de_dphi = 0.5 * V * n * cos(n * phi0) * sin(n * phi);
 
-    boost::array<chemkit::Vector3, 4> gradient = coordinates->torsionAngleGradientRadians(a, b, c, d);
-
-    gradient[0] *= de_dphi;
-    gradient[1] *= de_dphi;
-    gradient[2] *= de_dphi;
-    gradient[3] *= de_dphi;
+    boost::array<chemkit::Vector3, 4> torsionGradient = chemkit::geometry::torsionAngleGradientRadians(a, b, c, d);
 
-    return std::vector<chemkit::Vector3>(gradient.begin(), gradient.end());
+    gradient[0] = torsionGradient[0] * de_dphi;
+    gradient[1] = torsionGradient[1] * de_dphi;
+    gradient[2] = torsionGradient[2] * de_dphi;
+    gradient[3] = torsionGradient[3] * de_dphi;
 }
 
 // === UffInversionCalculation ============================================= //
 UffInversionCalculation::UffInversionCalculation(size_t a, size_t b, size_t c, size_t d)
-    : UffCalculation(Inversion, 4, 4)
+    : UffCalculation(Inversion, AtomCount, ParameterCount)
 {
     setAtom(0, a);
     setAtom(1, b);
@@ -447,54 +474,63 @@ bool UffInversionCalculation::setup()
     return true;
 }
 
-chemkit::Real UffInversionCalculation::energy(const chemkit::CartesianCoordinates *coordinates) const
+const chemkit::ForceFieldKernel* UffInversionCalculation::kernel() const
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
-    size_t d = atom(3);
+    static const chemkit::ForceFieldKernelAdaptor<UffInversionCalculation> kernel;
+    return &kernel;
+}
+
+chemkit::Real UffInversionCalculation::evaluateEnergy(const chemkit::Point3 *positions,
+                                                      const size_t *atoms,
+                                                      const chemkit::Real *parameters)
+{
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+    const chemkit::Point3 &c = positions[atoms[2]];
+    const chemkit::Point3 &d = positions[atoms[3]];
 
-    chemkit::Real k = parameter(0);
-    chemkit::Real c0 = parameter(1);
-    chemkit::Real c1 = parameter(2);
-    chemkit::Real c2 = parameter(3);
+    chemkit::Real k = parameters[0];
+    chemkit::Real c0 = parameters[1];
+    chemkit::Real c1 = parameters[2];
+    chemkit::Real c2 = parameters[3];
 
-    chemkit::Real w = coordinates->wilsonAngleRadians(a, b, c, d);
+    chemkit::Real w = chemkit::geometry::wilsonAngleRadians(a, b, c, d);
     chemkit::Real y = w + (chemkit::constants::Pi / 2.0);
 
     return k * (c0 + c1 * sin(y) + c2 * cos(2 * y));
 }
 
-std::vector<chemkit::Vector3> UffInversionCalculation::gradient(const chemkit::CartesianCoordinates *coordinates) const
+void UffInversionCalculation::evaluateGradient(const chemkit::Point3 *positions,
+                                               const size_t *atoms,
+                                               const chemkit::Real *parameters,
+                                               chemkit::Vector3 *gradient)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
-    size_t c = atom(2);
-    size_t d = atom(3);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+    const chemkit::Point3 &c = positions[atoms[2]];
+    const chemkit::Point3 &d = positions[atoms[3]];
 
-    chemkit::Real k = parameter(0);
-    chemkit::Real c1 = parameter(2);
-    chemkit::Real c2 = parameter(3);
+    chemkit::Real k = parameters[0];
+    chemkit::Real c1 = parameters[2];
+    chemkit::Real c2 = parameters[3];
 
-    chemkit::Real w = coordinates->wilsonAngleRadians(a, b, c, d);
+    chemkit::Real w = chemkit::geometry::wilsonAngleRadians(a, b, c, d);
     chemkit::Real y = w + (chemkit::constants::Pi / 2.0);
 
     // dE/dw
     chemkit::Real de_dw = k * (c1 * cos(y) - 2 * c2 * sin(2 * y));
 
-    boost::array<chemkit::Vector3, 4> gradient = coordinates->wilsonAngleGradientRadians(a, b, c, d);
-
-    gradient[0] *= de_dw;
-    gradient[1] *= de_dw;
-    gradient[2] *= de_dw;
-    gradient[3] *= de_dw;
+    boost::array<chemkit::Vector3, 4> wilsonGradient = chemkit::geometry::wilsonAngleGradientRadians(a, b, c, d);
 
-    return std::vector<chemkit::Vector3>(gradient.begin(), gradient.end());
+    gradient[0] = wilsonGradient[0] * de_dw;
+    gradient[1] = wilsonGradient[1] * de_dw;
+    gradient[2] = wilsonGradient[2] * de_dw;
+    gradient[3] = wilsonGradient[3] * de_dw;
 }
 
 // === UffVanDerWaalsCalculation =========================================== //
 UffVanDerWaalsCalculation::UffVanDerWaalsCalculation(size_t a, size_t b)
-    : UffCalculation(VanDerWaals, 2, 2)
+    : UffCalculation(VanDerWaals, AtomCount, ParameterCount)
 {
     setAtom(0, a);
     setAtom(1, b);
@@ -508,53 +544,80 @@ bool UffVanDerWaalsCalculation::setup()
         return false;
     }
 
+    chemkit::Real parameters[ParameterCount];
+    combineParameters(pa, pb, parameters);
+
+    setParameter(0, parameters[0]);
+    setParameter(1, parameters[1]);
+
+    return true;
+}
+
+// Combines the parameters of two atoms into the well depth and
+// distance parameters for their interaction.
+void UffVanDerWaalsCalculation::combineParameters(const UffAtomParameters *pa,
+                                                  const UffAtomParameters *pb,
+                                                  chemkit::Real *parameters)
+{
     // equation 22
-    chemkit::Real d = sqrt(pa->D * pb->D);
+    parameters[0] = sqrt(pa->D * pb->D);
 
     // equation 21b
-    chemkit::Real x = sqrt(pa->x * pb->x);
-
-    setParameter(0, d);
-    setParameter(1, x);
+    parameters[1] = sqrt(pa->x * pb->x);
+}
 
-    return true;
+const chemkit::ForceFieldKernel* UffVanDerWaalsCalculation::kernel() const
+{
+    static const chemkit::ForceFieldKernelAdaptor<UffVanDerWaalsCalculation> kernel;
+    return &kernel;
 }
 
-chemkit::Real UffVanDerWaalsCalculation::energy(const chemkit::CartesianCoordinates *coordinates) const
+chemkit::Real UffVanDerWaalsCalculation::evaluateEnergy(const chemkit::Point3 *positions,
+                                                        const size_t *atoms,
+                                                        const chemkit::Real *parameters)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
 
-    chemkit::Real d = parameter(0);
-    chemkit::Real x = parameter(1);
-    chemkit::Real r = coordinates->distance(a, b);
+    chemkit::Real d = parameters[0];
+    chemkit::Real x = parameters[1];
+    chemkit::Real r = (a - b).norm();
 
-    return d * (-2 * pow(x/r, 6) + pow(x/r, 12));
+    chemkit::Real xr = x / r;
+    chemkit::Real xr2 = xr * xr;
+    chemkit::Real xr6 = xr2 * xr2 * xr2;
+
+    return d * (-2 * xr6 + xr6 * xr6);
 }
 
-std::vector<chemkit::Vector3> UffVanDerWaalsCalculation::gradient(const chemkit::CartesianCoordinates *coordinates) const
+void UffVanDerWaalsCalculation::evaluateGradient(const chemkit::Point3 *positions,
+                                                 const size_t *atoms,
+                                                 const chemkit::Real *parameters,
+                                                 chemkit::Vector3 *gradient)
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
 
-    chemkit::Real d = parameter(0);
-    chemkit::Real x = parameter(1);
-    chemkit::Real r = coordinates->distance(a, b);
+    chemkit::Real d = parameters[0];
+    chemkit::Real x = parameters[1];
+    chemkit::Real r = (a - b).norm();
 
-    // dE/dr
-    chemkit::Real de_dr = -12 * d * x / pow(r, 2) * (pow(x/r, 11) - pow(x/r, 5));
+    chemkit::Real xr = x / r;
+    chemkit::Real xr2 = xr * xr;
+    chemkit::Real xr5 = xr2 * xr2 * xr;
 
-    boost::array<chemkit::Vector3, 2> gradient = coordinates->distanceGradient(a, b);
+    // dE/dr
+    chemkit::Real de_dr = -12 * d * x / (r * r) * (xr5 * xr5 * xr - xr5);
 
-    gradient[0] *= de_dr;
-    gradient[1] *= de_dr;
+    boost::array<chemkit::Vector3, 2> distanceGradient = chemkit::geometry::distanceGradient(a, b);
 
-    return std::vector<chemkit::Vector3>(gradient.begin(), gradient.end());
+    gradient[0] = distanceGradient[0] * de_dr;
+    gradient[1] = distanceGradient[1] * de_dr;
 }
 
 // === UffElectrostaticCalculation ========================================= //
 UffElectrostaticCalculation::UffElectrostaticCalculation(size_t a, size_t b)
-    : UffCalculation(Electrostatic, 2, 2)
+    : UffCalculation(Electrostatic, AtomCount, ParameterCount)
 {
     setAtom(0, a);
     setAtom(1, b);
@@ -565,16 +628,47 @@ bool UffElectrostaticCalculation::setup()
     return false;
 }
 
-chemkit::Real UffElectrostaticCalculation::energy(const chemkit::CartesianCoordinates *coordinates) const
+const chemkit::ForceFieldKernel* UffElectrostaticCalculation::kernel() const
 {
-    size_t a = atom(0);
-    size_t b = atom(1);
+    static const chemkit::ForceFieldKernelAdaptor<UffElectrostaticCalculation> kernel;
+    return &kernel;
+}
+
+chemkit::Real UffElectrostaticCalculation::evaluateEnergy(const chemkit::Point3 *positions,
+                                                          const size_t *atoms,
+                                                          const chemkit::Real *parameters)
+{
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
 
-    chemkit::Real qa = parameter(0);
-    chemkit::Real qb = parameter(1);
+    chemkit::Real qa = parameters[0];
+    chemkit::Real qb = parameters[1];
 
     chemkit::Real e = 1;
-    chemkit::Real r = coordinates->distance(a, b);
+    chemkit::Real r = (a - b).norm();
 
     return 332.037 * (qa * qb) / (e * r);
 }
+
+void UffElectrostaticCalculation::evaluateGradient(const chemkit::Point3 *positions,
+                                                   const size_t *atoms,
+                                                   const chemkit::Real *parameters,
+                                                   chemkit::Vector3 *gradient)
+{
+    const chemkit::Point3 &a = positions[atoms[0]];
+    const chemkit::Point3 &b = positions[atoms[1]];
+
+    chemkit::Real qa = parameters[0];
+    chemkit::Real qb = parameters[1];
+
+    chemkit::Real e = 1;
+    chemkit::Real r = (a - b).norm();
+
+    // dE/dr
+    chemkit::Real de_dr = -332.037 * (qa * qb) / (e * r * r);
+
+    boost::array<chemkit::Vector3, 2> distanceGradient = chemkit::geometry::distanceGradient(a, b);
+
+    gradient[0] = distanceGradient[0] * de_dr;
+    gradient[1] = distanceGradient[1] * de_dr;
+}
@@ -36,6 +36,7 @@
 #ifndef UFFCALCULATION_H
 #define UFFCALCULATION_H
 
+#include <chemkit/forcefieldkernel.h>
 #include <chemkit/forcefieldcalculation.h>
 
 #include "uffparameters.h"
@@ -56,60 +57,137 @@ protected:
 class UffBondStrechCalculation : public UffCalculation
 {
 public:
+    enum {
+        AtomCount = 2,
+        ParameterCount = 2
+    };
+
     UffBondStrechCalculation(size_t a, size_t b);
 
     bool setup();
-    chemkit::Real energy(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
-    std::vector<chemkit::Vector3> gradient(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    const chemkit::ForceFieldKernel* kernel() const CHEMKIT_OVERRIDE;
+
+    static chemkit::Real evaluateEnergy(const chemkit::Point3 *positions,
+                                        const size_t *atoms,
+                                        const chemkit::Real *parameters);
+    static void evaluateGradient(const chemkit::Point3 *positions,
+                                 const size_t *atoms,
+                                 const chemkit::Real *parameters,
+                                 chemkit::Vector3 *gradient);
 };
 
 class UffAngleBendCalculation : public UffCalculation
 {
 public:
+    enum {
+        AtomCount = 3,
+        ParameterCount = 4
+    };
+
     UffAngleBendCalculation(size_t a, size_t b, size_t c);
 
     bool setup();
-    chemkit::Real energy(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
-    std::vector<chemkit::Vector3> gradient(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    const chemkit::ForceFieldKernel* kernel() const CHEMKIT_OVERRIDE;
+
+    static chemkit::Real evaluateEnergy(const chemkit::Point3 *positions,
+                                        const size_t *atoms,
+                                        const chemkit::Real *parameters);
+    static void evaluateGradient(const chemkit::Point3 *positions,
+                                 const size_t *atoms,
+                                 const chemkit::Real *parameters,
+                                 chemkit::Vector3 *gradient);
 };
 
 class UffTorsionCalculation : public UffCalculation
 {
 public:
+    enum {
+        AtomCount = 4,
+        ParameterCount = 3
+    };
+
     UffTorsionCalculation(size_t a, size_t b, size_t c, size_t d);
 
     bool setup();
-    chemkit::Real energy(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
-    std::vector<chemkit::Vector3> gradient(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    const chemkit::ForceFieldKernel* kernel() const CHEMKIT_OVERRIDE;
+
+    static chemkit::Real evaluateEnergy(const chemkit::Point3 *positions,
+                                        const size_t *atoms,
+                                        const chemkit::Real *parameters);
+    static void evaluateGradient(const chemkit::Point3 *positions,
+                                 const size_t *atoms,
+                                 const chemkit::Real *parameters,
+                                 chemkit::Vector3 *gradient);
 };
 
 class UffInversionCalculation : public UffCalculation
 {
 public:
+    enum {
+        AtomCount = 4,
+        ParameterCount = 4
+    };
+
     UffInversionCalculation(size_t a, size_t b, size_t c, size_t d);
 
     bool setup();
-    chemkit::Real energy(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
-    std::vector<chemkit::Vector3> gradient(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    const chemkit::ForceFieldKernel* kernel() const CHEMKIT_OVERRIDE;
+
+    static chemkit::Real evaluateEnergy(const chemkit::Point3 *positions,
+                                        const size_t *atoms,
+                                        const chemkit::Real *parameters);
+    static void evaluateGradient(const chemkit::Point3 *positions,
+                                 const size_t *atoms,
+                                 const chemkit::Real *parameters,
+                                 chemkit::Vector3 *gradient);
 };
 
 class UffVanDerWaalsCalculation : public UffCalculation
 {
 public:
+    enum {
+        AtomCount = 2,
+        ParameterCount = 2
+    };
+
     UffVanDerWaalsCalculation(size_t a, size_t b);
 
     bool setup();
-    chemkit::Real energy(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
-    std::vector<chemkit::Vector3> gradient(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    const chemkit::ForceFieldKernel* kernel() const CHEMKIT_OVERRIDE;
+
+    static void combineParameters(const UffAtomParameters *pa,
+                                  const UffAtomParameters *pb,
+                                  chemkit::Real *parameters);
+
+    static chemkit::Real evaluateEnergy(const chemkit::Point3 *positions,
+                                        const size_t *atoms,
+                                        const chemkit::Real *parameters);
+    static void evaluateGradient(const chemkit::Point3 *positions,
+                                 const size_t *atoms,
+                                 const chemkit::Real *parameters,
+                                 chemkit::Vector3 *gradient);
 };
 
 class UffElectrostaticCalculation : public UffCalculation
 {
 public:
+    enum {
+        AtomCount = 2,
+        ParameterCount = 2
+    };
+
     UffElectrostaticCalculation(size_t a, size_t b);
 
     bool setup();
-    chemkit::Real energy(const chemkit::CartesianCoordinates *coordinates) const CHEMKIT_OVERRIDE;
+    const chemkit::ForceFieldKernel* kernel() const CHEMKIT_OVERRIDE;
+
+    static chemkit::Real evaluateEnergy(const chemkit::Point3 *positions,
+                                        const size_t *atoms,
+                                        const chemkit::Real *parameters);
+    static void evaluateGradient(const chemkit::Point3 *positions,
+                                 const size_t *atoms,
+                                 const chemkit::Real *parameters,
+                                 chemkit::Vector3 *gradient);
 };
 
 #endif // UFFCALCULATION_H
@@ -49,25 +49,26 @@
 
 #include <chemkit/foreach.h>
 #include <chemkit/topology.h>
+#include <chemkit/forcefieldparameterscache.h>
 
 // --- Construction and Destruction ---------------------------------------- //
 UffForceField::UffForceField()
-    : chemkit::ForceField("uff")
+    : chemkit::ForceField("uff"),
+      m_vanDerWaalsKernel(0)
 {
-    m_parameters = new UffParameters;
+    m_parameters = chemkit::ForceFieldParametersCache<UffParameters>::parameters();
 
     setFlags(chemkit::ForceField::AnalyticalGradient);
 }
 
 UffForceField::~UffForceField()
 {
-    delete m_parameters;
 }
 
 // --- Parameters ---------------------------------------------------------- //
 const UffParameters* UffForceField::parameters() const
 {
-    return m_parameters;
+    return m_parameters.get();
 }
 
 // --- Setup --------------------------------------------------------------- //
@@ -78,6 +79,9 @@ bool UffForceField::setup()
         return false;
     }
 
+    // remove the calculations from a previous setup
+    clearCalculations();
+
     // bond strech
     foreach(const chemkit::Topology::BondedInteraction &interaction, topology->bondedInteractions()){
         addCalculation(new UffBondStrechCalculation(interaction[0],
@@ -133,6 +137,26 @@ bool UffForceField::setup()
 
     bool ok = true;
 
+    // van der waals kernel for the neighbor list. pairs with an atom
+    // without parameters are skipped.
+    if(nonbondedCutoff() > 0){
+        clearNonbondedKernels();
+
+        m_atomParameters.resize(topology->size());
+
+        for(size_t i = 0; i < topology->size(); i++){
+            m_atomParameters[i] = m_parameters->parameters(topology->type(i));
+            if(!m_atomParameters[i]){
+                ok = false;
+            }
+        }
+
+        chemkit::ForceFieldKernel *vanDerWaalsKernel =
+            new chemkit::ForceFieldKernelAdaptor<UffVanDerWaalsCalculation>;
+        addNonbondedKernel(vanDerWaalsKernel);
+        m_vanDerWaalsKernel = vanDerWaalsKernel;
+    }
+
     foreach(chemkit::ForceFieldCalculation *calculation, calculations()){
         bool setup = static_cast<UffCalculation *>(calculation)->setup();
 
@@ -157,3 +181,25 @@ bool UffForceField::isGroupSix(size_t atom) const
            boost::starts_with(type, "Te") ||
            boost::starts_with(type, "Po");
 }
+
+bool UffForceField::nonbondedParameters(const chemkit::ForceFieldKernel *kernel,
+                                        size_t a,
+                                        size_t b,
+                                        bool oneFour,
+                                        chemkit::Real *parameters) const
+{
+    CHEMKIT_UNUSED(oneFour);
+
+    if(kernel == m_vanDerWaalsKernel){
+        const UffAtomParameters *pa = m_atomParameters[a];
+        const UffAtomParameters *pb = m_atomParameters[b];
+        if(!pa || !pb){
+            return false;
+        }
+
+        UffVanDerWaalsCalculation::combineParameters(pa, pb, parameters);
+        return true;
+    }
+
+    return false;
+}
@@ -36,9 +36,12 @@
 #ifndef UFFFORCEFIELD_H
 #define UFFFORCEFIELD_H
 
+#include <boost/shared_ptr.hpp>
+
 #include <chemkit/forcefield.h>
 
 class UffParameters;
+struct UffAtomParameters;
 
 class UffForceField : public chemkit::ForceField
 {
@@ -55,8 +58,13 @@ public:
 
     bool isGroupSix(size_t atom) const;
 
+protected:
+    bool nonbondedParameters(const chemkit::ForceFieldKernel *kernel, size_t a, size_t b, bool oneFour, chemkit::Real *parameters) const CHEMKIT_OVERRIDE;
+
 private:
-    UffParameters *m_parameters;
+    boost::shared_ptr<const UffParameters> m_parameters;
+    std::vector<const UffAtomParameters *> m_atomParameters;
+    const chemkit::ForceFieldKernel *m_vanDerWaalsKernel;
 };
 
 #endif // UFFFORCEFIELD_H
@@ -35,6 +35,9 @@
 
 #include "uffparameters.h"
 
+#include <cstring>
+#include <algorithm>
+
 namespace {
 
 const UffAtomParameters AtomParameters[] = {
@@ -169,11 +172,28 @@ const UffAtomParameters AtomParameters[] = {
 
 int AtomParametersCount = sizeof(AtomParameters) / sizeof(*AtomParameters);
 
+bool atomParametersLessThan(const UffAtomParameters *a, const UffAtomParameters *b)
+{
+    return strcmp(a->type, b->type) < 0;
+}
+
+bool atomParametersTypeLessThan(const UffAtomParameters *parameters, const char *type)
+{
+    return strcmp(parameters->type, type) < 0;
+}
+
 } // end anonymous namespace
 
 // --- Construction and Destruction ---------------------------------------- //
 UffParameters::UffParameters()
 {
+    // sort the parameters by type. the first parameters in the table
+    // are kept for types that are listed more than once.
+    for(int i = 0; i < AtomParametersCount; i++){
+        m_atomParameters.push_back(&AtomParameters[i]);
+    }
+
+    std::stable_sort(m_atomParameters.begin(), m_atomParameters.end(), atomParametersLessThan);
 }
 
 UffParameters::~UffParameters()
@@ -183,11 +203,12 @@ UffParameters::~UffParameters()
 // --- Parameters ---------------------------------------------------------- //
 const UffAtomParameters* UffParameters::parameters(const std::string &type) const
 {
-    for(int i = 0; i < AtomParametersCount; i++){
-        if(type == AtomParameters[i].type){
-            return &AtomParameters[i];
-        }
+    std::vector<const UffAtomParameters *>::const_iterator iter =
+        std::lower_bound(m_atomParameters.begin(), m_atomParameters.end(), type.c_str(), atomParametersTypeLessThan);
+
+    if(iter == m_atomParameters.end() || type != (*iter)->type){
+        return 0;
     }
 
-    return 0;
+    return *iter;
 }
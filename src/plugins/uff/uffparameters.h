@@ -37,6 +37,7 @@
 #define UFFPARAMETERS_H
 
 #include <string>
+#include <vector>
 
 #include <chemkit/chemkit.h>
 
@@ -64,6 +65,9 @@ public:
 
     // parameters
     const UffAtomParameters* parameters(const std::string &type) const;
+
+private:
+    std::vector<const UffAtomParameters *> m_atomParameters;
 };
 
 #endif // UFFPARAMETERS_H
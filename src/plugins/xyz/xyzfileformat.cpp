@@ -52,10 +52,39 @@ XyzFileFormat::XyzFileFormat()
 }
 
 bool XyzFileFormat::read(std::istream &input, chemkit::MoleculeFile *file)
+{
+    boost::shared_ptr<chemkit::Molecule> molecule = readMolecule(input);
+    if(!molecule){
+        return false;
+    }
+
+    file->addMolecule(molecule);
+
+    return true;
+}
+
+// Returns the next frame in input. Multi-frame files are simply a
+// concatenation of single frame xyz records.
+boost::shared_ptr<chemkit::Molecule> XyzFileFormat::readNextMolecule(std::istream &input)
+{
+    // skip any blank lines between frames
+    input >> std::ws;
+    if(input.eof()){
+        return boost::shared_ptr<chemkit::Molecule>();
+    }
+
+    return readMolecule(input);
+}
+
+boost::shared_ptr<chemkit::Molecule> XyzFileFormat::readMolecule(std::istream &input)
 {
     // atom count line
     int atomCount = 0;
     input >> atomCount;
+    if(input.fail() || atomCount < 0){
+        setErrorString("Failed to read atom count line");
+        return boost::shared_ptr<chemkit::Molecule>();
+    }
     input.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 
     // comment line (unused)
@@ -97,10 +126,7 @@ bool XyzFileFormat::read(std::istream &input, chemkit::MoleculeFile *file)
         }
     }
 
-    // add molecule to file
-    file->addMolecule(molecule);
-
-    return true;
+    return molecule;
 }
 
 bool XyzFileFormat::readMappedFile(const boost::iostreams::mapped_file_source &input, chemkit::MoleculeFile *file)
@@ -169,6 +195,11 @@ bool XyzFileFormat::write(const chemkit::MoleculeFile *file, std::ostream &outpu
         return false;
     }
 
+    return writeMolecule(molecule.get(), output);
+}
+
+bool XyzFileFormat::writeMolecule(const chemkit::Molecule *molecule, std::ostream &output)
+{
     // atom count line
     output << molecule->atomCount() << "\n";
 
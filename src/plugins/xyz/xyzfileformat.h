@@ -46,6 +46,11 @@ public:
     bool read(std::istream &input, chemkit::MoleculeFile *file) CHEMKIT_OVERRIDE;
     bool readMappedFile(const boost::iostreams::mapped_file_source &input, chemkit::MoleculeFile *file) CHEMKIT_OVERRIDE;
     bool write(const chemkit::MoleculeFile *file, std::ostream &output) CHEMKIT_OVERRIDE;
+    boost::shared_ptr<chemkit::Molecule> readNextMolecule(std::istream &input) CHEMKIT_OVERRIDE;
+    bool writeMolecule(const chemkit::Molecule *molecule, std::ostream &output) CHEMKIT_OVERRIDE;
+
+private:
+    boost::shared_ptr<chemkit::Molecule> readMolecule(std::istream &input);
 };
 
 #endif // XYZFILEFORMAT_H
@@ -49,4 +49,77 @@ void AlphaShapeTest::alphaValue()
     QCOMPARE(alphaShape.alphaValue(), chemkit::Real(1.8));
 }
 
+void AlphaShapeTest::filtration()
+{
+    // serine atom positions and squared van der waals radii
+    std::vector<chemkit::Point3> points;
+    points.push_back(chemkit::Point3(-0.1664, -1.0370, 0.4066));
+    points.push_back(chemkit::Point3(1.2077, -0.5767, -0.0716));
+    points.push_back(chemkit::Point3(-0.6079, -1.5894, -0.3173));
+    points.push_back(chemkit::Point3(1.1440, -0.3456, -1.0571));
+    points.push_back(chemkit::Point3(2.2495, -1.7077, 0.1008));
+    points.push_back(chemkit::Point3(1.6659, 0.7153, 0.7175));
+    points.push_back(chemkit::Point3(1.7844, 0.4727, 1.7759));
+    points.push_back(chemkit::Point3(0.8959, 1.5129, 0.6034));
+    points.push_back(chemkit::Point3(2.8918, 1.1700, 0.2007));
+    points.push_back(chemkit::Point3(3.1444, 1.9558, 0.6711));
+    points.push_back(chemkit::Point3(1.8101, -2.8570, 0.2804));
+    points.push_back(chemkit::Point3(3.4579, -1.3878, 0.0035));
+    points.push_back(chemkit::Point3(-0.0600, -1.6097, 1.2601));
+    points.push_back(chemkit::Point3(-0.7527, -0.2118, 0.6162));
+
+    std::vector<chemkit::Real> weights;
+    weights.push_back(2.4025);
+    weights.push_back(2.90);
+    weights.push_back(1.44);
+    weights.push_back(1.44);
+    weights.push_back(2.90);
+    weights.push_back(2.90);
+    weights.push_back(1.44);
+    weights.push_back(1.44);
+    weights.push_back(2.3104);
+    weights.push_back(1.44);
+    weights.push_back(2.3104);
+    weights.push_back(2.3104);
+    weights.push_back(1.44);
+    weights.push_back(1.44);
+
+    chemkit::AlphaShape alphaShape(points, weights);
+    QCOMPARE(alphaShape.edgeCount(), 29);
+    QCOMPARE(alphaShape.triangleCount(), 22);
+    QCOMPARE(alphaShape.tetrahedronCount(), 6);
+
+    // changing the alpha value of an alpha shape gives the same
+    // simplices as a new alpha shape with that alpha value
+    chemkit::Real alphaValues[] = { -1.0, 1.0, 100.0, 0.5, 0.0 };
+
+    for(int i = 0; i < 5; i++){
+        alphaShape.setAlphaValue(alphaValues[i]);
+
+        chemkit::AlphaShape expected(points, weights);
+        expected.setAlphaValue(alphaValues[i]);
+
+        QCOMPARE(alphaShape.edgeCount(), expected.edgeCount());
+        QCOMPARE(alphaShape.triangleCount(), expected.triangleCount());
+        QCOMPARE(alphaShape.tetrahedronCount(), expected.tetrahedronCount());
+    }
+}
+
+void AlphaShapeTest::planar()
+{
+    // four points on a plane with overlapping spheres
+    std::vector<chemkit::Point3> points;
+    points.push_back(chemkit::Point3(0, 0, 0));
+    points.push_back(chemkit::Point3(1, 0, 0));
+    points.push_back(chemkit::Point3(0, 1, 0));
+    points.push_back(chemkit::Point3(1, 1, 0));
+
+    std::vector<chemkit::Real> weights(4, 1.0);
+
+    chemkit::AlphaShape alphaShape(points, weights);
+    QCOMPARE(alphaShape.tetrahedronCount(), 0);
+    QCOMPARE(alphaShape.triangleCount(), 2);
+    QCOMPARE(alphaShape.edgeCount(), 5);
+}
+
 QTEST_APPLESS_MAIN(AlphaShapeTest)
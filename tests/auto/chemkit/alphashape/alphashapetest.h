@@ -44,6 +44,8 @@ class AlphaShapeTest : public QObject
 
     private slots:
         void alphaValue();
+        void filtration();
+        void planar();
 };
 
 #endif // ALPHASHAPETEST_H
@@ -36,6 +36,7 @@
 #include "atomtest.h"
 
 #include <chemkit/atom.h>
+#include <chemkit/ring.h>
 #include <chemkit/molecule.h>
 #include <chemkit/lineformat.h>
 
@@ -230,6 +231,52 @@ void AtomTest::rings()
     }
 }
 
+void AtomTest::ringsChanged()
+{
+    chemkit::Molecule furan("InChI=1/C4H4O/c1-2-4-5-3-1/h1-4H", "inchi");
+    QCOMPARE(furan.formula(), std::string("C4H4O"));
+    QCOMPARE(furan.ringCount(), size_t(1));
+
+    chemkit::Atom *oxygen = 0;
+    foreach(chemkit::Atom *atom, furan.atoms()){
+        if(atom->is(chemkit::Atom::Oxygen)){
+            oxygen = atom;
+        }
+    }
+    QVERIFY(oxygen != 0);
+    QCOMPARE(oxygen->ringCount(), size_t(1));
+    QVERIFY(*oxygen->rings().begin() == furan.rings()[0]);
+    QCOMPARE(oxygen->isAromatic(), true);
+    QCOMPARE(furan.rings()[0]->isAromatic(), true);
+
+    // element change
+    oxygen->setAtomicNumber(chemkit::Atom::Carbon);
+    QCOMPARE(oxygen->ringCount(), size_t(1));
+    QCOMPARE(oxygen->isAromatic(), false);
+    QCOMPARE(furan.rings()[0]->isAromatic(), false);
+
+    oxygen->setAtomicNumber(chemkit::Atom::Oxygen);
+    QCOMPARE(oxygen->isAromatic(), true);
+    QCOMPARE(furan.rings()[0]->isAromatic(), true);
+
+    // ring re-perception
+    chemkit::Bond *bond = oxygen->bonds()[0];
+    chemkit::Atom *neighbor = bond->otherAtom(oxygen);
+    furan.removeBond(bond);
+    QCOMPARE(furan.ringCount(), size_t(0));
+    QCOMPARE(oxygen->ringCount(), size_t(0));
+    QCOMPARE(oxygen->isInRing(), false);
+    QVERIFY(oxygen->rings().empty());
+    QCOMPARE(oxygen->isAromatic(), false);
+
+    furan.addBond(oxygen, neighbor);
+    QCOMPARE(furan.ringCount(), size_t(1));
+    QCOMPARE(oxygen->ringCount(), size_t(1));
+    QCOMPARE(neighbor->ringCount(), size_t(1));
+    QVERIFY(oxygen->smallestRing() == furan.rings()[0]);
+    QCOMPARE(oxygen->isAromatic(), true);
+}
+
 void AtomTest::position()
 {
     chemkit::Molecule molecule;
@@ -56,6 +56,7 @@ class AtomTest : public QObject
         void is();
         void molecule();
         void rings();
+        void ringsChanged();
         void position();
         void distance();
 };
@@ -37,6 +37,7 @@
 
 #include <chemkit/atom.h>
 #include <chemkit/bond.h>
+#include <chemkit/ring.h>
 #include <chemkit/chemkit.h>
 #include <chemkit/molecule.h>
 #include <chemkit/lineformat.h>
@@ -178,6 +179,53 @@ void BondTest::rings()
     }
 }
 
+void BondTest::ringsChanged()
+{
+    chemkit::Molecule benzene("InChI=1/C6H6/c1-2-4-6-5-3-1/h1-6H", "inchi");
+    QCOMPARE(benzene.ringCount(), size_t(1));
+
+    chemkit::Bond *doubleBond = 0;
+    foreach(chemkit::Bond *bond, benzene.bonds()){
+        if(bond->order() == chemkit::Bond::Double){
+            doubleBond = bond;
+            break;
+        }
+    }
+    QVERIFY(doubleBond != 0);
+    QCOMPARE(doubleBond->ringCount(), size_t(1));
+    QVERIFY(*doubleBond->rings().begin() == benzene.rings()[0]);
+    QCOMPARE(doubleBond->isAromatic(), true);
+    QCOMPARE(benzene.rings()[0]->isAromatic(), true);
+
+    // bond order change
+    doubleBond->setOrder(chemkit::Bond::Single);
+    QCOMPARE(doubleBond->ringCount(), size_t(1));
+    QCOMPARE(doubleBond->isAromatic(), false);
+    QCOMPARE(benzene.rings()[0]->isAromatic(), false);
+
+    doubleBond->setOrder(chemkit::Bond::Double);
+    QCOMPARE(doubleBond->isAromatic(), true);
+    QCOMPARE(benzene.rings()[0]->isAromatic(), true);
+
+    // ring re-perception
+    chemkit::Atom *a = doubleBond->atom1();
+    chemkit::Atom *b = doubleBond->atom2();
+    benzene.removeBond(doubleBond);
+    QCOMPARE(benzene.ringCount(), size_t(0));
+    foreach(chemkit::Bond *bond, benzene.bonds()){
+        QCOMPARE(bond->ringCount(), size_t(0));
+        QVERIFY(bond->rings().empty());
+        QCOMPARE(bond->isAromatic(), false);
+    }
+
+    chemkit::Bond *bond = benzene.addBond(a, b, chemkit::Bond::Double);
+    QCOMPARE(benzene.ringCount(), size_t(1));
+    QCOMPARE(bond->ringCount(), size_t(1));
+    QCOMPARE(bond->isInRing(6), true);
+    QVERIFY(bond->smallestRing() == benzene.rings()[0]);
+    QCOMPARE(bond->isAromatic(), true);
+}
+
 void BondTest::polarity()
 {
     chemkit::Molecule molecule;
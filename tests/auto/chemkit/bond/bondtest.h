@@ -52,6 +52,7 @@ class BondTest : public QObject
         void contains();
         void isTerminal();
         void rings();
+        void ringsChanged();
         void polarity();
         void length();
         void stereochemistry();
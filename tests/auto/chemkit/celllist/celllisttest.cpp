@@ -0,0 +1,154 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "celllisttest.h"
+
+#include <cstdlib>
+
+#include <chemkit/celllist.h>
+#include <chemkit/unitcell.h>
+
+namespace {
+
+// returns a set of pseudo-random points inside a cube with sides
+// of the given length
+std::vector<chemkit::Point3> randomPoints(size_t count, chemkit::Real length)
+{
+    srand(1);
+
+    std::vector<chemkit::Point3> points;
+    for(size_t i = 0; i < count; i++){
+        chemkit::Real x = length * rand() / RAND_MAX;
+        chemkit::Real y = length * rand() / RAND_MAX;
+        chemkit::Real z = length * rand() / RAND_MAX;
+        points.push_back(chemkit::Point3(x, y, z));
+    }
+
+    return points;
+}
+
+} // end anonymous namespace
+
+void CellListTest::basic()
+{
+    std::vector<chemkit::Point3> points;
+    chemkit::CellList empty(points, 2.0);
+    QVERIFY(empty.isEmpty());
+    QCOMPARE(empty.size(), size_t(0));
+    QVERIFY(empty.pairs(5.0).empty());
+
+    points.push_back(chemkit::Point3(0, 0, 0));
+    points.push_back(chemkit::Point3(1, 0, 0));
+    points.push_back(chemkit::Point3(3, 0, 0));
+
+    chemkit::CellList cellList(points, 2.0);
+    QVERIFY(!cellList.isEmpty());
+    QCOMPARE(cellList.size(), size_t(3));
+    QCOMPARE(cellList.isPeriodic(), false);
+    QVERIFY(cellList.position(2) == chemkit::Point3(3, 0, 0));
+    QCOMPARE(qRound(cellList.distance(0, 2)), 3);
+}
+
+void CellListTest::neighbors()
+{
+    std::vector<chemkit::Point3> points = randomPoints(500, 20.0);
+    chemkit::CellList cellList(points, 3.0);
+
+    for(size_t i = 0; i < points.size(); i += 25){
+        std::vector<size_t> expected;
+        for(size_t j = 0; j < points.size(); j++){
+            if(j != i && (points[i] - points[j]).norm() <= 3.0){
+                expected.push_back(j);
+            }
+        }
+
+        QVERIFY(cellList.neighbors(i, 3.0) == expected);
+    }
+
+    // query with a point and a distance larger than the cell size
+    chemkit::Point3 center(10, 10, 10);
+    std::vector<size_t> expected;
+    for(size_t j = 0; j < points.size(); j++){
+        if((points[j] - center).norm() <= 7.5){
+            expected.push_back(j);
+        }
+    }
+    QVERIFY(!expected.empty());
+    QVERIFY(cellList.neighbors(center, 7.5) == expected);
+}
+
+void CellListTest::pairs()
+{
+    std::vector<chemkit::Point3> points = randomPoints(500, 20.0);
+    chemkit::CellList cellList(points, 2.5);
+
+    std::vector<chemkit::CellList::Pair> expected;
+    for(size_t i = 0; i < points.size(); i++){
+        for(size_t j = i + 1; j < points.size(); j++){
+            if((points[i] - points[j]).norm() <= 2.5){
+                expected.push_back(std::make_pair(i, j));
+            }
+        }
+    }
+
+    QVERIFY(!expected.empty());
+    QVERIFY(cellList.pairs(2.5) == expected);
+}
+
+void CellListTest::periodic()
+{
+    chemkit::UnitCell unitCell(chemkit::Vector3(10, 0, 0),
+                               chemkit::Vector3(0, 10, 0),
+                               chemkit::Vector3(0, 0, 10));
+
+    std::vector<chemkit::Point3> points;
+    points.push_back(chemkit::Point3(0.5, 5, 5));
+    points.push_back(chemkit::Point3(9.5, 5, 5));
+    points.push_back(chemkit::Point3(5, 5, 5));
+
+    chemkit::CellList cellList(points, 2.0, unitCell);
+    QCOMPARE(cellList.isPeriodic(), true);
+    QCOMPARE(qRound(cellList.distance(0, 1)), 1);
+
+    std::vector<chemkit::CellList::Pair> pairs = cellList.pairs(2.0);
+    QCOMPARE(pairs.size(), size_t(1));
+    QVERIFY(pairs[0] == std::make_pair(size_t(0), size_t(1)));
+
+    std::vector<size_t> neighbors = cellList.neighbors(size_t(1), 2.0);
+    QCOMPARE(neighbors.size(), size_t(1));
+    QCOMPARE(neighbors[0], size_t(0));
+}
+
+QTEST_APPLESS_MAIN(CellListTest)
@@ -0,0 +1,347 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "fingerprintdatabasetest.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <chemkit/fingerprintdatabase.h>
+
+namespace {
+
+// Returns a fingerprint with the first count bits set.
+chemkit::Bitset makeFingerprint(size_t count, size_t size = 1024)
+{
+    chemkit::Bitset fingerprint(size);
+
+    for(size_t i = 0; i < count; i++){
+        fingerprint.set(i);
+    }
+
+    return fingerprint;
+}
+
+// runs the same search and nearest query repeatedly and counts the
+// results which differ from the expected hits
+void queryDatabase(const chemkit::FingerprintDatabase *database,
+                   const chemkit::Bitset *query,
+                   const std::vector<chemkit::FingerprintDatabase::Hit> *expectedSearch,
+                   const std::vector<chemkit::FingerprintDatabase::Hit> *expectedNearest,
+                   int *mismatches)
+{
+    for(int i = 0; i < 20; i++){
+        if(database->search(*query, 0.7) != *expectedSearch){
+            (*mismatches)++;
+        }
+        if(database->nearest(*query, 10) != *expectedNearest){
+            (*mismatches)++;
+        }
+    }
+}
+
+// Sets the 64-bit value at offset in contents.
+void setValueAt(std::string &contents, size_t offset, boost::uint64_t value)
+{
+    std::memcpy(&contents[offset], &value, sizeof(value));
+}
+
+// Writes contents to fileName with the 64-bit value at offset
+// replaced by value and returns true if the file can still be read.
+bool readCorrupted(const std::string &contents,
+                   size_t offset,
+                   boost::uint64_t value,
+                   const std::string &fileName)
+{
+    std::string corrupted = contents;
+    setValueAt(corrupted, offset, value);
+
+    std::ofstream output(fileName.c_str(), std::ios::binary);
+    output.write(corrupted.data(), corrupted.size());
+    output.close();
+
+    chemkit::FingerprintDatabase database;
+    return database.read(fileName);
+}
+
+// Returns the 64-bit value at offset in contents.
+boost::uint64_t valueAt(const std::string &contents, size_t offset)
+{
+    boost::uint64_t value;
+    std::memcpy(&value, &contents[offset], sizeof(value));
+    return value;
+}
+
+} // end anonymous namespace
+
+void FingerprintDatabaseTest::addFingerprint()
+{
+    chemkit::FingerprintDatabase database;
+    QVERIFY(database.isEmpty());
+    QCOMPARE(database.bitCount(), size_t(0));
+
+    database.addFingerprint(makeFingerprint(10, 1021), "a");
+    database.addFingerprint(makeFingerprint(500, 1021), "b");
+    QCOMPARE(database.size(), size_t(2));
+    QCOMPARE(database.bitCount(), size_t(1021));
+    QCOMPARE(database.id(0), std::string("a"));
+    QCOMPARE(database.id(1), std::string("b"));
+    QVERIFY(database.fingerprint(0) == makeFingerprint(10, 1021));
+    QVERIFY(database.fingerprint(1) == makeFingerprint(500, 1021));
+
+    database.clear();
+    QVERIFY(database.isEmpty());
+}
+
+void FingerprintDatabaseTest::search()
+{
+    chemkit::FingerprintDatabase database(1024);
+    for(size_t i = 1; i <= 100; i++){
+        database.addFingerprint(makeFingerprint(i));
+    }
+
+    // the similarity between the first i and first j bits is i / j
+    chemkit::Bitset query = makeFingerprint(50);
+    QCOMPARE(database.similarity(24, query), 0.5);
+
+    std::vector<chemkit::FingerprintDatabase::Hit> hits = database.search(query, 0.8);
+    QCOMPARE(hits.size(), size_t(23));
+    QCOMPARE(hits[0].first, size_t(49));
+    QCOMPARE(hits[0].second, 1.0);
+    QCOMPARE(hits[1].first, size_t(50));
+    QCOMPARE(hits[2].first, size_t(48));
+
+    for(size_t i = 0; i < hits.size(); i++){
+        QVERIFY(hits[i].second >= 0.8);
+    }
+
+    // multiple threads must give the same hits
+    database.setThreadCount(4);
+    QVERIFY(database.search(query, 0.8) == hits);
+
+    QCOMPARE(database.search(query, 0).size(), size_t(100));
+}
+
+void FingerprintDatabaseTest::nearest()
+{
+    chemkit::FingerprintDatabase database(1024);
+    for(size_t i = 1; i <= 100; i++){
+        database.addFingerprint(makeFingerprint(i));
+    }
+    database.addFingerprint(makeFingerprint(40));
+
+    std::vector<chemkit::FingerprintDatabase::Hit> hits = database.nearest(makeFingerprint(40), 3);
+    QCOMPARE(hits.size(), size_t(3));
+    QCOMPARE(hits[0].first, size_t(39));
+    QCOMPARE(hits[1].first, size_t(100));
+    QCOMPARE(hits[1].second, 1.0);
+    QCOMPARE(hits[2].first, size_t(40));
+
+    database.setThreadCount(4);
+    QVERIFY(database.nearest(makeFingerprint(40), 3) == hits);
+
+    QCOMPARE(database.nearest(makeFingerprint(40), 500).size(), size_t(101));
+    QCOMPARE(database.nearest(makeFingerprint(40), 0).size(), size_t(0));
+}
+
+void FingerprintDatabaseTest::concurrent()
+{
+    // enough fingerprints for several chunks so that queries are
+    // split between the threads in the pool
+    chemkit::FingerprintDatabase database(1024);
+    for(size_t i = 0; i < 20000; i++){
+        database.addFingerprint(makeFingerprint(1 + i % 1000));
+    }
+
+    chemkit::Bitset firstQuery = makeFingerprint(300);
+    chemkit::Bitset secondQuery = makeFingerprint(700);
+
+    database.setThreadCount(1);
+    std::vector<chemkit::FingerprintDatabase::Hit> firstSearch = database.search(firstQuery, 0.7);
+    std::vector<chemkit::FingerprintDatabase::Hit> firstNearest = database.nearest(firstQuery, 10);
+    std::vector<chemkit::FingerprintDatabase::Hit> secondSearch = database.search(secondQuery, 0.7);
+    std::vector<chemkit::FingerprintDatabase::Hit> secondNearest = database.nearest(secondQuery, 10);
+    QVERIFY(!firstSearch.empty());
+    QVERIFY(!secondSearch.empty());
+
+    // two threads querying the same database at once
+    database.setThreadCount(4);
+
+    int firstMismatches = 0;
+    int secondMismatches = 0;
+    boost::thread first(boost::bind(queryDatabase, &database, &firstQuery, &firstSearch, &firstNearest, &firstMismatches));
+    boost::thread second(boost::bind(queryDatabase, &database, &secondQuery, &secondSearch, &secondNearest, &secondMismatches));
+    first.join();
+    second.join();
+
+    QCOMPARE(firstMismatches, 0);
+    QCOMPARE(secondMismatches, 0);
+}
+
+void FingerprintDatabaseTest::read()
+{
+    std::stringstream input;
+    input << "#FPS1\n"
+          << "#num_bits=12\n"
+          << "#type=Test/1\n"
+          << "0100\tfirst\n"
+          << "ff0f\tsecond\textra\n";
+
+    chemkit::FingerprintDatabase database;
+    bool ok = database.read(input);
+    QVERIFY(ok);
+    QCOMPARE(database.size(), size_t(2));
+    QCOMPARE(database.bitCount(), size_t(12));
+    QCOMPARE(database.name(), std::string("Test/1"));
+    QCOMPARE(database.id(0), std::string("first"));
+    QCOMPARE(database.id(1), std::string("second"));
+
+    chemkit::Bitset first = database.fingerprint(0);
+    QCOMPARE(first.count(), size_t(1));
+    QVERIFY(first.test(0));
+    QCOMPARE(database.fingerprint(1).count(), size_t(12));
+
+    std::stringstream invalid;
+    invalid << "#num_bits=12\n"
+            << "01\tshort\n";
+    QVERIFY(!database.read(invalid));
+    QVERIFY(database.isEmpty());
+}
+
+void FingerprintDatabaseTest::write()
+{
+    chemkit::FingerprintDatabase database;
+    database.setName("Test/1");
+    database.addFingerprint(makeFingerprint(3, 16), "a");
+    database.addFingerprint(makeFingerprint(12, 16), "b");
+
+    std::stringstream output;
+    QVERIFY(database.write(output));
+
+    chemkit::FingerprintDatabase copy;
+    QVERIFY(copy.read(output));
+    QCOMPARE(copy.size(), size_t(2));
+    QCOMPARE(copy.bitCount(), size_t(16));
+    QCOMPARE(copy.name(), std::string("Test/1"));
+    QCOMPARE(copy.id(1), std::string("b"));
+    QVERIFY(copy.fingerprint(0) == database.fingerprint(0));
+    QVERIFY(copy.fingerprint(1) == database.fingerprint(1));
+}
+
+void FingerprintDatabaseTest::binary()
+{
+    chemkit::FingerprintDatabase database(1024);
+    database.setName("Test/1");
+    for(size_t i = 100; i > 0; i--){
+        database.addFingerprint(makeFingerprint(i), boost::lexical_cast<std::string>(i));
+    }
+
+    std::string fileName = "fingerprintdatabasetest.ckfp";
+    QVERIFY(database.write(fileName, chemkit::FingerprintDatabase::BinaryFormat));
+
+    chemkit::FingerprintDatabase mapped;
+    bool ok = mapped.read(fileName);
+    if(!ok)
+        qDebug() << mapped.errorString().c_str();
+    QVERIFY(ok);
+    QVERIFY(mapped.isMapped());
+    QCOMPARE(mapped.size(), size_t(100));
+    QCOMPARE(mapped.bitCount(), size_t(1024));
+    QCOMPARE(mapped.name(), std::string("Test/1"));
+    QCOMPARE(mapped.id(0), std::string("100"));
+    QVERIFY(mapped.fingerprint(0) == makeFingerprint(100));
+    QVERIFY(mapped.fingerprint(99) == makeFingerprint(1));
+
+    chemkit::Bitset query = makeFingerprint(50);
+    QVERIFY(mapped.nearest(query, 5) == database.nearest(query, 5));
+    QVERIFY(mapped.search(query, 0.8) == database.search(query, 0.8));
+
+    // adding a fingerprint copies the mapped fingerprints
+    mapped.addFingerprint(makeFingerprint(50), "extra");
+    QVERIFY(!mapped.isMapped());
+    QCOMPARE(mapped.size(), size_t(101));
+    QCOMPARE(mapped.id(100), std::string("extra"));
+    QVERIFY(mapped.fingerprint(50) == makeFingerprint(50));
+    QCOMPARE(mapped.nearest(query, 2).size(), size_t(2));
+    QCOMPARE(mapped.nearest(query, 2)[1].first, size_t(100));
+
+    // corrupt files must be rejected instead of read out of bounds
+    std::ifstream input(fileName.c_str(), std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    input.close();
+
+    const size_t countOffset = 32;
+    const size_t recordOffsetOffset = 48;
+    const size_t idOffsetOffset = 56;
+    boost::uint64_t count = valueAt(contents, countOffset);
+    boost::uint64_t recordSize = valueAt(contents, countOffset - 8);
+    boost::uint64_t recordOffset = valueAt(contents, recordOffsetOffset);
+    boost::uint64_t idOffset = valueAt(contents, idOffsetOffset);
+    QCOMPARE(count, boost::uint64_t(100));
+
+    std::string corruptName = "fingerprintdatabasetest-corrupt.ckfp";
+    QVERIFY(readCorrupted(contents, countOffset, count, corruptName));
+
+    // a count for which every section offset wraps around to the
+    // start of the records (each fingerprint takes 148 bytes)
+    QCOMPARE(recordSize, boost::uint64_t(128));
+    std::string withoutIds = contents;
+    setValueAt(withoutIds, idOffsetOffset, 0);
+    QVERIFY(readCorrupted(withoutIds, countOffset, count, corruptName));
+    QVERIFY(!readCorrupted(withoutIds, countOffset, boost::uint64_t(1) << 62, corruptName));
+    QVERIFY(!readCorrupted(contents, countOffset, count + 1, corruptName));
+    QVERIFY(!readCorrupted(contents, recordOffsetOffset, ~boost::uint64_t(0) - 63, corruptName));
+
+    // an index and a position outside of the records (the index table
+    // needs no padding as the records and counts are multiples of 8)
+    size_t indexOffset = recordOffset + count * recordSize + count * 4;
+    QVERIFY(!readCorrupted(contents, indexOffset, count, corruptName));
+    QVERIFY(!readCorrupted(contents, indexOffset + count * 8, ~boost::uint64_t(0), corruptName));
+
+    // identifier offsets which decrease
+    QVERIFY(!readCorrupted(contents, idOffset + 8, valueAt(contents, idOffset + 16) + 1, corruptName));
+
+    std::remove(corruptName.c_str());
+    std::remove(fileName.c_str());
+}
+
+QTEST_APPLESS_MAIN(FingerprintDatabaseTest)
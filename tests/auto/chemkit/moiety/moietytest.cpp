@@ -100,4 +100,23 @@ void MoietyTest::molecule()
     delete molecule;
 }
 
+void MoietyTest::copy()
+{
+    chemkit::Molecule molecule;
+    chemkit::Atom* atomH = molecule.addAtom("H");
+    chemkit::Atom* atomC = molecule.addAtom("C");
+    std::vector<chemkit::Atom*> moietyAtoms;
+    moietyAtoms.push_back(atomH);
+    moietyAtoms.push_back(atomC);
+    chemkit::Moiety moiety(moietyAtoms);
+
+    chemkit::Moiety copy(moiety);
+    QCOMPARE(copy.size(), size_t(2));
+    QVERIFY(copy.atom(0) == atomH);
+    QVERIFY(copy.atom(1) == atomC);
+
+    std::vector<chemkit::Moiety> moieties(3, moiety);
+    QCOMPARE(moieties[2].size(), size_t(2));
+}
+
 QTEST_APPLESS_MAIN(MoietyTest)
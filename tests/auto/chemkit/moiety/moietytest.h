@@ -47,6 +47,7 @@ class MoietyTest : public QObject
         void isEmpty();
         void atomCount();
         void molecule();
+        void copy();
 };
 
 #endif // MOIETYTEST_H
@@ -39,11 +39,17 @@
 
 #include "molecularsurfacetest.h"
 
+#include <cmath>
+
 #include <chemkit/atom.h>
+#include <chemkit/foreach.h>
+#include <chemkit/constants.h>
 #include <chemkit/point3.h>
 #include <chemkit/polymer.h>
+#include <chemkit/residue.h>
 #include <chemkit/vector3.h>
 #include <chemkit/molecule.h>
+#include <chemkit/polymerchain.h>
 #include <chemkit/polymerfile.h>
 #include <chemkit/moleculefile.h>
 #include <chemkit/molecularsurface.h>
@@ -257,11 +263,47 @@ void MolecularSurfaceTest::buckminsterfullerene()
     QVERIFY(molecule);
     QCOMPARE(molecule->size(), size_t(60));
 
-    // van der waals surface
+    // van der waals surface. the atoms are cospherical and the atoms
+    // of some rings are exactly coplanar. the values were checked by
+    // sampling the union of the atom spheres.
     chemkit::MolecularSurface surface(molecule.get());
     surface.setSurfaceType(chemkit::MolecularSurface::VanDerWaals);
-    QCOMPARE(qRound(surface.volume()), 518);
-    QCOMPARE(qRound(surface.surfaceArea()), 432);
+    QCOMPARE(qRound(surface.volume()), 502);
+    QCOMPARE(qRound(surface.surfaceArea()), 403);
+
+    // solvent accessible surface
+    surface.setSurfaceType(chemkit::MolecularSurface::SolventAccessible);
+    QCOMPARE(qRound(surface.volume()), 1150);
+    QCOMPARE(qRound(surface.surfaceArea()), 548);
+}
+
+void MolecularSurfaceTest::perturbedBuckminsterfullerene()
+{
+    chemkit::MoleculeFile file(dataPath + "buckminsterfullerene.cml");
+    bool ok = file.read();
+    if(!ok)
+        qDebug() << file.errorString().c_str();
+    QVERIFY(ok);
+
+    const boost::shared_ptr<chemkit::Molecule> molecule = file.molecule();
+    QVERIFY(molecule);
+
+    // moving each atom by less than 1e-6 angstroms removes the
+    // degeneracies and must not change the surface
+    chemkit::Molecule perturbed(*molecule);
+    for(size_t i = 0; i < perturbed.size(); i++){
+        chemkit::Atom *atom = perturbed.atom(i);
+        atom->setPosition(atom->position() + chemkit::Vector3(1e-7 * (i % 3), 1e-7 * (i % 5), 1e-7 * (i % 7)));
+    }
+
+    chemkit::MolecularSurface surface(&perturbed);
+    surface.setSurfaceType(chemkit::MolecularSurface::VanDerWaals);
+    QCOMPARE(qRound(surface.volume()), 502);
+    QCOMPARE(qRound(surface.surfaceArea()), 403);
+
+    surface.setSurfaceType(chemkit::MolecularSurface::SolventAccessible);
+    QCOMPARE(qRound(surface.volume()), 1150);
+    QCOMPARE(qRound(surface.surfaceArea()), 548);
 }
 
 void MolecularSurfaceTest::dablib()
@@ -276,11 +318,12 @@ void MolecularSurfaceTest::dablib()
     QVERIFY(molecule != 0);
     QCOMPARE(molecule->size(), size_t(20));
 
-    // van der waals surface
+    // van der waals surface. the values were checked by sampling
+    // the union of the atom spheres.
     chemkit::MolecularSurface surface(molecule.get());
     surface.setSurfaceType(chemkit::MolecularSurface::VanDerWaals);
     QCOMPARE(qRound(surface.volume()), 140);
-    QCOMPARE(qRound(surface.surfaceArea()), 180);
+    QCOMPARE(qRound(surface.surfaceArea()), 178);
 }
 
 void MolecularSurfaceTest::lysozyme()
@@ -475,4 +518,83 @@ void MolecularSurfaceTest::ubiqutin()
     QCOMPARE(qRound(surface.surfaceArea()), 4881);
 }
 
+void MolecularSurfaceTest::atomSurfaceAreas()
+{
+    // a single atom is not buried
+    chemkit::Molecule hydrogen;
+    hydrogen.addAtom("H");
+    chemkit::MolecularSurface hydrogenSurface(&hydrogen, chemkit::MolecularSurface::SolventAccessible);
+    QCOMPARE(hydrogenSurface.pointCount(), size_t(960));
+    QCOMPARE(qRound(hydrogenSurface.atomSurfaceArea(0)), 85);
+
+    chemkit::PolymerFile file(dataPath + "2DHB.pdb");
+    bool ok = file.read();
+    if(!ok)
+        qDebug() << file.errorString().c_str();
+    QVERIFY(ok);
+
+    const boost::shared_ptr<chemkit::Polymer> &protein = file.polymer();
+    QVERIFY(protein);
+
+    chemkit::MolecularSurface surface(protein.get(), chemkit::MolecularSurface::SolventAccessible);
+    surface.setThreadCount(1);
+    std::vector<chemkit::Real> areas = surface.atomSurfaceAreas();
+    QCOMPARE(areas.size(), protein->size());
+
+    chemkit::Real totalArea = 0;
+    for(size_t i = 0; i < areas.size(); i++){
+        chemkit::Real radius = surface.radius(i);
+        QVERIFY(areas[i] >= 0);
+        QVERIFY(areas[i] <= 4 * chemkit::constants::Pi * radius * radius + 1e-6);
+        totalArea += areas[i];
+    }
+
+    // the total agrees with the exact surface area
+    QVERIFY(std::abs(totalArea - 14791) < 0.002 * 14791);
+    QCOMPARE(qRound(surface.surfaceArea()), 14791);
+
+    // the areas do not depend on the number of threads
+    surface.setThreadCount(4);
+    QCOMPARE(surface.threadCount(), size_t(4));
+    surface.setProbeRadius(surface.probeRadius());
+    QVERIFY(surface.atomSurfaceAreas() == areas);
+
+    // more points give a more accurate total
+    surface.setPointCount(4000);
+    totalArea = 0;
+    for(size_t i = 0; i < protein->size(); i++){
+        totalArea += surface.atomSurfaceArea(i);
+    }
+    QVERIFY(std::abs(totalArea - 14791) < 0.001 * 14791);
+}
+
+void MolecularSurfaceTest::residueSurfaceAreas()
+{
+    chemkit::PolymerFile file(dataPath + "1UBQ.pdb");
+    bool ok = file.read();
+    if(!ok)
+        qDebug() << file.errorString().c_str();
+    QVERIFY(ok);
+
+    const boost::shared_ptr<chemkit::Polymer> &protein = file.polymer();
+    QVERIFY(protein);
+
+    chemkit::MolecularSurface surface(protein.get(), chemkit::MolecularSurface::SolventAccessible);
+
+    chemkit::Real totalArea = 0;
+    foreach(const chemkit::PolymerChain *chain, protein->chains()){
+        foreach(const chemkit::Residue *residue, chain->residues()){
+            chemkit::Real area = 0;
+            foreach(const chemkit::Atom *atom, residue->atoms()){
+                area += surface.atomSurfaceArea(atom->index());
+            }
+
+            QVERIFY(std::abs(surface.residueSurfaceArea(residue) - area) < 1e-6);
+            totalArea += area;
+        }
+    }
+
+    QVERIFY(std::abs(totalArea - surface.surfaceArea()) < 0.002 * surface.surfaceArea());
+}
+
 QTEST_APPLESS_MAIN(MolecularSurfaceTest)
@@ -57,6 +57,7 @@ class MolecularSurfaceTest : public QObject
         void ethanol();
         void adenosine();
         void buckminsterfullerene();
+        void perturbedBuckminsterfullerene();
         void dablib();
         void lysozyme();
         void cytochrome();
@@ -66,6 +67,8 @@ class MolecularSurfaceTest : public QObject
         void dna();
         void ribozyme();
         void ubiqutin();
+        void atomSurfaceAreas();
+        void residueSurfaceAreas();
 };
 
 #endif // MOLECULARSURFACETEST_H
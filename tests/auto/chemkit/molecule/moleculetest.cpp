@@ -35,15 +35,82 @@
 
 #include "moleculetest.h"
 
+#include <algorithm>
+
 #include <boost/bind.hpp>
 
 #include <chemkit/atom.h>
 #include <chemkit/bond.h>
+#include <chemkit/ring.h>
 #include <chemkit/chemkit.h>
 #include <chemkit/molecule.h>
 #include <chemkit/lineformat.h>
 #include <chemkit/cartesiancoordinates.h>
 
+namespace {
+
+// Builds triptycene (atoms 0-19) with an acene of acenes rings fused
+// to its first benzene ring.
+void buildTriptycene(chemkit::Molecule *molecule, int acenes)
+{
+    std::vector<chemkit::Atom *> atoms;
+    for(int i = 0; i < 20; i++){
+        atoms.push_back(molecule->addAtom("C"));
+    }
+
+    // atoms 0 and 1 are the bridgeheads
+    for(int i = 0; i < 3; i++){
+        int start = 2 + 6 * i;
+
+        for(int j = 0; j < 6; j++){
+            molecule->addBond(atoms[start + j], atoms[start + (j + 1) % 6]);
+        }
+
+        molecule->addBond(atoms[0], atoms[start]);
+        molecule->addBond(atoms[1], atoms[start + 1]);
+    }
+
+    chemkit::Atom *a = atoms[5];
+    chemkit::Atom *b = atoms[6];
+    for(int i = 0; i < acenes; i++){
+        chemkit::Atom *c1 = molecule->addAtom("C");
+        chemkit::Atom *c2 = molecule->addAtom("C");
+        chemkit::Atom *c3 = molecule->addAtom("C");
+        chemkit::Atom *c4 = molecule->addAtom("C");
+        molecule->addBond(b, c1);
+        molecule->addBond(c1, c2);
+        molecule->addBond(c2, c3);
+        molecule->addBond(c3, c4);
+        molecule->addBond(c4, a);
+        a = c2;
+        b = c3;
+    }
+}
+
+// Returns the sorted atom indices of the rings containing a bridgehead.
+std::vector<std::vector<size_t> > bridgeheadRings(const chemkit::Molecule *molecule)
+{
+    std::vector<std::vector<size_t> > rings;
+
+    foreach(const chemkit::Ring *ring, molecule->rings()){
+        if(!ring->contains(molecule->atom(0))){
+            continue;
+        }
+
+        std::vector<size_t> indices;
+        foreach(const chemkit::Atom *atom, ring->atoms()){
+            indices.push_back(atom->index());
+        }
+        std::sort(indices.begin(), indices.end());
+        rings.push_back(indices);
+    }
+
+    std::sort(rings.begin(), rings.end());
+    return rings;
+}
+
+} // end anonymous namespace
+
 void MoleculeTest::name()
 {
     chemkit::Molecule molecule;
@@ -294,6 +361,32 @@ void MoleculeTest::rings()
     QCOMPARE(cyclopropane.ringCount(), size_t(0));
 }
 
+void MoleculeTest::largeRingSystem()
+{
+    // ring systems with more than 64 atoms are perceived with horton's
+    // algorithm instead of rp-path. the bicyclo[2.2.2]octane core of
+    // triptycene has three equal sized rings of which only two are in
+    // the sssr, the same two must be picked regardless of the size of
+    // the ring system
+    chemkit::Molecule triptycene;
+    buildTriptycene(&triptycene, 0);
+    QCOMPARE(triptycene.size(), size_t(20));
+    QCOMPARE(triptycene.ringCount(), size_t(5));
+
+    chemkit::Molecule large;
+    buildTriptycene(&large, 12);
+    QCOMPARE(large.size(), size_t(68));
+    QCOMPARE(large.ringCount(), size_t(17));
+
+    foreach(const chemkit::Ring *ring, large.rings()){
+        QCOMPARE(ring->size(), size_t(6));
+    }
+
+    std::vector<std::vector<size_t> > expected = bridgeheadRings(&triptycene);
+    QCOMPARE(expected.size(), size_t(2));
+    QVERIFY(bridgeheadRings(&large) == expected);
+}
+
 void MoleculeTest::distance()
 {
     chemkit::Molecule molecule;
@@ -56,6 +56,7 @@ class MoleculeTest : public QObject
         void size();
         void isEmpty();
         void rings();
+        void largeRingSystem();
         void distance();
         void center();
         void bondAngle();
@@ -0,0 +1,212 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#include "packedcoordinatestest.h"
+
+#include <chemkit/packedcoordinates.h>
+#include <chemkit/cartesiancoordinates.h>
+
+namespace {
+
+// returns coordinates for a small bent chain of points
+chemkit::CartesianCoordinates* chainCoordinates()
+{
+    chemkit::CartesianCoordinates *coordinates = new chemkit::CartesianCoordinates;
+    coordinates->append(0.0, 0.0, 0.0);
+    coordinates->append(1.5, 0.0, 0.0);
+    coordinates->append(2.0, 1.4, 0.0);
+    coordinates->append(3.5, 1.4, 0.3);
+    coordinates->append(4.0, 2.8, 1.1);
+    return coordinates;
+}
+
+} // end anonymous namespace
+
+void PackedCoordinatesTest::basic()
+{
+    chemkit::PackedCoordinates<float> coordinates;
+    QCOMPARE(coordinates.size(), size_t(0));
+    QVERIFY(coordinates.isEmpty());
+
+    coordinates.append(1, 2, 3);
+    coordinates.append(chemkit::Point3(4, 5, 6));
+    QCOMPARE(coordinates.size(), size_t(2));
+    QVERIFY(!coordinates.isEmpty());
+    QCOMPARE(coordinates.x()[1], 4.0f);
+    QCOMPARE(coordinates.y()[1], 5.0f);
+    QCOMPARE(coordinates.z()[1], 6.0f);
+    QVERIFY(coordinates.position(0) == chemkit::Point3(1, 2, 3));
+
+    coordinates.resize(3);
+    QCOMPARE(coordinates.size(), size_t(3));
+    QVERIFY(coordinates.position(2) == chemkit::Point3(0, 0, 0));
+
+    coordinates.setPosition(2, 7, 8, 9);
+    QVERIFY(coordinates.position(2) == chemkit::Point3(7, 8, 9));
+
+    // conversion to and from cartesian coordinates
+    chemkit::CartesianCoordinates *cartesianCoordinates = chainCoordinates();
+    chemkit::PackedCoordinates<double> packedCoordinates(cartesianCoordinates);
+    QCOMPARE(packedCoordinates.size(), size_t(5));
+
+    chemkit::CartesianCoordinates *copy = packedCoordinates.toCartesianCoordinates();
+    QCOMPARE(copy->size(), size_t(5));
+    for(size_t i = 0; i < copy->size(); i++){
+        QVERIFY(copy->position(i) == cartesianCoordinates->position(i));
+    }
+
+    delete copy;
+    delete cartesianCoordinates;
+}
+
+void PackedCoordinatesTest::view()
+{
+    chemkit::CartesianCoordinates *cartesianCoordinates = chainCoordinates();
+    chemkit::PackedCoordinates<float> coordinates(cartesianCoordinates);
+
+    chemkit::PackedCoordinatesView<float> view = coordinates.view();
+    QCOMPARE(view.size(), size_t(5));
+    QVERIFY(view.x() == coordinates.x());
+
+    // changes through the view are visible in the coordinates
+    chemkit::PackedCoordinatesView<float> tail = coordinates.view(3, 2);
+    QCOMPARE(tail.size(), size_t(2));
+    QVERIFY(tail.position(0) == coordinates.position(3));
+
+    tail.moveBy(1, 0, 0);
+    QCOMPARE(qRound(coordinates.position(3).x() * 10), 45);
+    QCOMPARE(qRound(coordinates.position(4).x() * 10), 50);
+    QCOMPARE(qRound(coordinates.position(2).x() * 10), 20);
+
+    tail.setPosition(0, chemkit::Point3(-1, -2, -3));
+    QVERIFY(view.position(3) == chemkit::Point3(-1, -2, -3));
+
+    chemkit::PackedCoordinatesView<float> empty;
+    QVERIFY(empty.isEmpty());
+    QCOMPARE(empty.rmsd(empty), chemkit::Real(0));
+
+    delete cartesianCoordinates;
+}
+
+void PackedCoordinatesTest::center()
+{
+    chemkit::CartesianCoordinates *cartesianCoordinates = chainCoordinates();
+    chemkit::PackedCoordinates<float> coordinates(cartesianCoordinates);
+
+    QVERIFY((coordinates.center() - cartesianCoordinates->center()).norm() < 1e-6);
+
+    std::vector<chemkit::Real> weights;
+    weights.push_back(12.0);
+    weights.push_back(1.0);
+    weights.push_back(14.0);
+    weights.push_back(1.0);
+    weights.push_back(16.0);
+    QVERIFY((coordinates.weightedCenter(weights) - chemkit::Point3(97.0 / 44.0, 65.8 / 44.0, 17.9 / 44.0)).norm() < 1e-5);
+
+    // equal weights give the unweighted center
+    std::vector<chemkit::Real> unitWeights(coordinates.size(), 1.0);
+    QVERIFY((coordinates.weightedCenter(unitWeights) - coordinates.center()).norm() < 1e-5);
+
+    delete cartesianCoordinates;
+}
+
+void PackedCoordinatesTest::moveBy()
+{
+    chemkit::CartesianCoordinates *cartesianCoordinates = chainCoordinates();
+    chemkit::PackedCoordinates<double> coordinates(cartesianCoordinates);
+
+    cartesianCoordinates->moveBy(chemkit::Vector3(1, -2, 3));
+    coordinates.moveBy(chemkit::Vector3(1, -2, 3));
+
+    for(size_t i = 0; i < coordinates.size(); i++){
+        QVERIFY(coordinates.position(i) == cartesianCoordinates->position(i));
+    }
+
+    delete cartesianCoordinates;
+}
+
+void PackedCoordinatesTest::rotate()
+{
+    chemkit::CartesianCoordinates *cartesianCoordinates = chainCoordinates();
+    chemkit::PackedCoordinates<double> coordinates(cartesianCoordinates);
+
+    cartesianCoordinates->rotate(chemkit::Vector3(0, 0, 1), 90);
+    coordinates.rotate(chemkit::Vector3(0, 0, 1), 90);
+
+    for(size_t i = 0; i < coordinates.size(); i++){
+        QVERIFY((coordinates.position(i) - cartesianCoordinates->position(i)).norm() < 1e-10);
+    }
+
+    // (1.5, 0, 0) rotated to (0, 1.5, 0)
+    QCOMPARE(qRound(coordinates.position(1).x() * 10), 0);
+    QCOMPARE(qRound(coordinates.position(1).y() * 10), 15);
+
+    delete cartesianCoordinates;
+}
+
+void PackedCoordinatesTest::rmsd()
+{
+    chemkit::CartesianCoordinates *cartesianCoordinates = chainCoordinates();
+    chemkit::PackedCoordinates<double> a(cartesianCoordinates);
+    chemkit::PackedCoordinates<float> b(cartesianCoordinates);
+
+    QCOMPARE(a.rmsd(a), chemkit::Real(0));
+    QVERIFY(a.rmsd(b) < 1e-6);
+
+    // moving every point by 2 angstroms gives a rmsd of 2
+    b.moveBy(0, 2, 0);
+    QVERIFY(qAbs(a.rmsd(b) - 2.0) < 1e-6);
+    QVERIFY(qAbs(b.rmsd(a) - 2.0) < 1e-6);
+
+    delete cartesianCoordinates;
+}
+
+void PackedCoordinatesTest::distanceMatrix()
+{
+    chemkit::CartesianCoordinates *cartesianCoordinates = chainCoordinates();
+    chemkit::PackedCoordinates<double> coordinates(cartesianCoordinates);
+
+    chemkit::Matrix expected = cartesianCoordinates->distanceMatrix();
+    chemkit::Matrix matrix = coordinates.distanceMatrix();
+    QCOMPARE(matrix.rows(), expected.rows());
+    QCOMPARE(matrix.cols(), expected.cols());
+    QVERIFY((matrix - expected).cwiseAbs().maxCoeff() < 1e-12);
+    QCOMPARE(matrix(2, 2), chemkit::Real(0));
+    QCOMPARE(qRound(coordinates.distance(0, 1) * 10), 15);
+
+    delete cartesianCoordinates;
+}
+
+QTEST_APPLESS_MAIN(PackedCoordinatesTest)
@@ -39,6 +39,7 @@
 
 #include <chemkit/atom.h>
 #include <chemkit/bond.h>
+#include <chemkit/foreach.h>
 #include <chemkit/molecule.h>
 #include <chemkit/substructurequery.h>
 
@@ -301,4 +302,117 @@ void SubstructureQueryTest::find()
     QCOMPARE(carboxylMoiety.isEmpty(), true);
 }
 
+void SubstructureQueryTest::findAll()
+{
+    boost::shared_ptr<chemkit::Molecule> benzene = boost::make_shared<chemkit::Molecule>("c1ccccc1", "smiles");
+    boost::shared_ptr<chemkit::Molecule> biphenyl = boost::make_shared<chemkit::Molecule>("c1ccccc1-c2ccccc2", "smiles");
+    boost::shared_ptr<chemkit::Molecule> hexane = boost::make_shared<chemkit::Molecule>("CCCCCC", "smiles");
+    boost::shared_ptr<chemkit::Molecule> hydroxyl = boost::make_shared<chemkit::Molecule>("O", "smiles");
+    boost::shared_ptr<chemkit::Molecule> glycerol = boost::make_shared<chemkit::Molecule>("OCC(O)CO", "smiles");
+
+    // each kekule benzene ring has six mappings onto itself
+    chemkit::SubstructureQuery query(benzene);
+    QCOMPARE(query.count(benzene.get()), size_t(6));
+    QCOMPARE(query.mappings(benzene.get()).size(), size_t(6));
+    QCOMPARE(query.count(biphenyl.get()), size_t(12));
+    QCOMPARE(query.count(hexane.get()), size_t(0));
+
+    query.setFlags(chemkit::SubstructureQuery::UniqueMatches);
+    QCOMPARE(query.count(benzene.get()), size_t(1));
+    QCOMPARE(query.count(biphenyl.get()), size_t(2));
+
+    std::vector<chemkit::Moiety> rings = query.findAll(biphenyl.get());
+    QCOMPARE(rings.size(), size_t(2));
+    QCOMPARE(rings[0].atomCount(), size_t(6));
+    QCOMPARE(rings[1].atomCount(), size_t(6));
+    std::vector<chemkit::Atom *> secondRing = rings[1].atoms();
+    foreach(chemkit::Atom *atom, rings[0].atoms()){
+        QVERIFY(std::find(secondRing.begin(), secondRing.end(), atom) == secondRing.end());
+    }
+
+    // count reaction sites
+    query.setMolecule(hydroxyl);
+    QCOMPARE(query.count(glycerol.get()), size_t(3));
+
+    // each mapping must preserve bonds
+    query.setMolecule(hexane);
+    query.setFlags(0);
+    QCOMPARE(query.count(hexane.get()), size_t(2));
+    std::vector<std::map<chemkit::Atom *, chemkit::Atom *> > mappings = query.mappings(hexane.get());
+    QCOMPARE(mappings.size(), size_t(2));
+    for(size_t i = 0; i < mappings.size(); i++){
+        foreach(const chemkit::Bond *bond, hexane->bonds()){
+            if(bond->contains(chemkit::Atom::Hydrogen)){
+                continue;
+            }
+
+            QVERIFY(mappings[i][bond->atom1()]->isBondedTo(mappings[i][bond->atom2()]));
+        }
+    }
+}
+
+void SubstructureQueryTest::screen()
+{
+    const char *formulas[] = { "C", "CC", "CCO", "C=O", "OC=O", "c1ccccc1",
+                               "c1ccccc1O", "C1CCCCC1", "c1ccncc1", "CC(=O)Nc1ccc(O)cc1" };
+    const size_t formulaCount = sizeof(formulas) / sizeof(*formulas);
+
+    std::vector<boost::shared_ptr<chemkit::Molecule> > molecules;
+    for(size_t i = 0; i < formulaCount; i++){
+        molecules.push_back(boost::make_shared<chemkit::Molecule>(formulas[i], "smiles"));
+    }
+
+    // the screen must never reject a molecule that the query matches
+    chemkit::SubstructureQuery query;
+    for(size_t i = 0; i < formulaCount; i++){
+        query.setMolecule(molecules[i]);
+
+        for(size_t j = 0; j < formulaCount; j++){
+            chemkit::Bitset fingerprint = query.screeningFingerprint(molecules[j].get());
+            bool matches = !query.mapping(molecules[j].get()).empty();
+
+            if(matches){
+                QVERIFY(query.passesScreen(fingerprint));
+            }
+
+            QCOMPARE(query.matches(molecules[j].get(), fingerprint), matches);
+            QCOMPARE(query.matches(molecules[j].get()), matches);
+        }
+    }
+
+    // modifying the query molecule updates the screen
+    boost::shared_ptr<chemkit::Molecule> ethane = boost::make_shared<chemkit::Molecule>("CC", "smiles");
+    boost::shared_ptr<chemkit::Molecule> ethanol = boost::make_shared<chemkit::Molecule>("CCO", "smiles");
+    chemkit::Bitset ethanolFingerprint = query.screeningFingerprint(ethanol.get());
+    query.setMolecule(ethane);
+    QCOMPARE(query.matches(ethanol.get(), ethanolFingerprint), true);
+
+    chemkit::Atom *nitrogen = ethane->addAtom("N");
+    ethane->addBond(ethane->atom(0), nitrogen);
+    QCOMPARE(query.passesScreen(ethanolFingerprint), false);
+    QCOMPARE(query.matches(ethanol.get()), false);
+
+    nitrogen->setAtomicNumber(chemkit::Atom::Oxygen);
+    QCOMPARE(query.passesScreen(ethanolFingerprint), true);
+    QCOMPARE(query.matches(ethanol.get()), true);
+
+    // six-membered rings set a ring bit which the open chains they
+    // contain do not set
+    boost::shared_ptr<chemkit::Molecule> cyclohexane = boost::make_shared<chemkit::Molecule>("C1CCCCC1", "smiles");
+    boost::shared_ptr<chemkit::Molecule> hexane = boost::make_shared<chemkit::Molecule>("CCCCCC", "smiles");
+    chemkit::Bitset cyclohexaneFingerprint = query.screeningFingerprint(cyclohexane.get());
+    chemkit::Bitset hexaneFingerprint = query.screeningFingerprint(hexane.get());
+    QVERIFY(hexaneFingerprint.is_proper_subset_of(cyclohexaneFingerprint));
+
+    boost::shared_ptr<chemkit::Molecule> benzene = boost::make_shared<chemkit::Molecule>("C1=CC=CC=C1", "smiles");
+    boost::shared_ptr<chemkit::Molecule> hexatriene = boost::make_shared<chemkit::Molecule>("C=CC=CC=C", "smiles");
+    boost::shared_ptr<chemkit::Molecule> hexadiene = boost::make_shared<chemkit::Molecule>("CC=CC=CC", "smiles");
+    chemkit::Bitset chainFingerprint = query.screeningFingerprint(hexatriene.get()) |
+                                       query.screeningFingerprint(hexadiene.get());
+    query.setMolecule(benzene);
+    QVERIFY(chainFingerprint.is_proper_subset_of(query.screeningFingerprint(benzene.get())));
+    QCOMPARE(query.passesScreen(chainFingerprint), false);
+    QCOMPARE(query.passesScreen(query.screeningFingerprint(benzene.get())), true);
+}
+
 QTEST_APPLESS_MAIN(SubstructureQueryTest)
@@ -48,6 +48,8 @@ class SubstructureQueryTest : public QObject
         void maximumMapping();
         void matches();
         void find();
+        void findAll();
+        void screen();
 };
 
 #endif // SUBSTRUCTUREQUERYTEST_H
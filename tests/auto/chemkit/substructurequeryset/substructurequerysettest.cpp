@@ -0,0 +1,135 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "substructurequerysettest.h"
+
+#include <boost/make_shared.hpp>
+
+#include <chemkit/foreach.h>
+#include <chemkit/molecule.h>
+#include <chemkit/substructurequery.h>
+#include <chemkit/substructurequeryset.h>
+
+void SubstructureQuerySetTest::addQuery()
+{
+    chemkit::SubstructureQuerySet set;
+    QCOMPARE(set.size(), size_t(0));
+    QCOMPARE(set.isEmpty(), true);
+
+    QCOMPARE(set.addQuery("CO", "smiles"), size_t(0));
+    QCOMPARE(set.addQuery("CN", "smiles", chemkit::SubstructureQuery::CompareAromaticity), size_t(1));
+    QCOMPARE(set.size(), size_t(2));
+    QCOMPARE(set.isEmpty(), false);
+    QCOMPARE(set.query(1)->flags(), int(chemkit::SubstructureQuery::CompareAromaticity));
+
+    set.clear();
+    QCOMPARE(set.size(), size_t(0));
+}
+
+void SubstructureQuerySetTest::matches()
+{
+    const char *formulas[] = { "O", "CO", "CCO", "CCCO", "C=O", "OC=O", "N", "CN",
+                               "c1ccccc1", "c1ccccc1O", "c1ccncc1", "C1CCCCC1", "Cl" };
+    const size_t formulaCount = sizeof(formulas) / sizeof(*formulas);
+
+    const char *molecules[] = { "CCO", "OC(=O)CCN", "Oc1ccccc1", "c1ccncc1CCl", "C1CCCCC1O", "CC" };
+    const size_t moleculeCount = sizeof(molecules) / sizeof(*molecules);
+
+    // the matches from the set must be the same as matching each query
+    for(int flags = 0; flags <= chemkit::SubstructureQuery::CompareAromaticity; flags += chemkit::SubstructureQuery::CompareAromaticity){
+        chemkit::SubstructureQuerySet set;
+        std::vector<boost::shared_ptr<chemkit::SubstructureQuery> > queries;
+
+        for(size_t i = 0; i < formulaCount; i++){
+            set.addQuery(formulas[i], "smiles", flags);
+
+            boost::shared_ptr<chemkit::SubstructureQuery> query =
+                boost::make_shared<chemkit::SubstructureQuery>(formulas[i], "smiles");
+            query->setFlags(flags);
+            queries.push_back(query);
+        }
+
+        for(size_t i = 0; i < moleculeCount; i++){
+            chemkit::Molecule molecule(molecules[i], "smiles");
+
+            std::vector<size_t> expected;
+            for(size_t j = 0; j < queries.size(); j++){
+                if(queries[j]->matches(&molecule)){
+                    expected.push_back(j);
+                }
+            }
+
+            QVERIFY(set.matches(&molecule) == expected);
+        }
+    }
+
+    // ethanol matches hydroxyl, methanol and ethanol
+    chemkit::SubstructureQuerySet set;
+    set.addQuery("O", "smiles");
+    set.addQuery("CO", "smiles");
+    set.addQuery("CCO", "smiles");
+    set.addQuery("CCCO", "smiles");
+    set.addQuery("N", "smiles");
+
+    chemkit::Molecule ethanol("CCO", "smiles");
+    std::vector<size_t> matches = set.matches(&ethanol);
+    QCOMPARE(matches.size(), size_t(3));
+    QCOMPARE(matches[0], size_t(0));
+    QCOMPARE(matches[1], size_t(1));
+    QCOMPARE(matches[2], size_t(2));
+
+    // empty queries match every molecule
+    set.addQuery(boost::make_shared<chemkit::Molecule>());
+    matches = set.matches(&ethanol);
+    QCOMPARE(matches.size(), size_t(4));
+    QCOMPARE(matches[3], size_t(5));
+}
+
+void SubstructureQuerySetTest::matchesAny()
+{
+    chemkit::SubstructureQuerySet set;
+    chemkit::Molecule ethanol("CCO", "smiles");
+    QCOMPARE(set.matchesAny(&ethanol), false);
+
+    set.addQuery("N", "smiles");
+    set.addQuery("Cl", "smiles");
+    QCOMPARE(set.matchesAny(&ethanol), false);
+
+    set.addQuery("CO", "smiles");
+    QCOMPARE(set.matchesAny(&ethanol), true);
+}
+
+QTEST_APPLESS_MAIN(SubstructureQuerySetTest)
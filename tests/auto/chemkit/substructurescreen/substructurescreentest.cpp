@@ -0,0 +1,273 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "substructurescreentest.h"
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+
+#include <chemkit/atom.h>
+#include <chemkit/foreach.h>
+#include <chemkit/molecule.h>
+#include <chemkit/substructurequery.h>
+#include <chemkit/substructurescreen.h>
+
+namespace {
+
+// returns a new alcohol molecule (C1-C2-...-Cn-O) with n carbons or
+// a new alkane with n carbons if hydroxyl is false
+chemkit::Molecule* createChain(int length, bool hydroxyl)
+{
+    chemkit::Molecule *molecule = new chemkit::Molecule;
+
+    chemkit::Atom *previous = 0;
+    for(int i = 0; i < length; i++){
+        chemkit::Atom *carbon = molecule->addAtom("C");
+        if(previous){
+            molecule->addBond(previous, carbon);
+        }
+        previous = carbon;
+    }
+
+    if(hydroxyl){
+        chemkit::Atom *oxygen = molecule->addAtom("O");
+        molecule->addBond(previous, oxygen);
+    }
+
+    return molecule;
+}
+
+void screenMolecules(chemkit::SubstructureScreen *screen,
+                     const std::vector<const chemkit::Molecule *> *molecules,
+                     std::vector<bool> *matches)
+{
+    for(int i = 0; i < 20; i++){
+        *matches = screen->screen(*molecules);
+    }
+}
+
+// screens molecules until one of the screens is canceled
+void screenUntilCanceled(chemkit::SubstructureScreen *screen,
+                         const std::vector<const chemkit::Molecule *> *molecules,
+                         boost::atomic<bool> *done)
+{
+    do {
+        screen->screen(*molecules);
+    } while(!screen->isCanceled());
+
+    *done = true;
+}
+
+} // end anonymous namespace
+
+void SubstructureScreenTest::threadCount()
+{
+    chemkit::SubstructureQuery query;
+    chemkit::SubstructureScreen screen(&query);
+    QVERIFY(screen.query() == &query);
+    QVERIFY(screen.threadCount() >= 1);
+
+    screen.setThreadCount(3);
+    QCOMPARE(screen.threadCount(), size_t(3));
+    QCOMPARE(screen.threadScreenedCounts().size(), size_t(3));
+
+    screen.setChunkSize(0);
+    QCOMPARE(screen.chunkSize(), size_t(1));
+}
+
+void SubstructureScreenTest::screen()
+{
+    boost::shared_ptr<chemkit::Molecule> hydroxyl(createChain(1, true));
+    chemkit::SubstructureQuery query(hydroxyl);
+
+    std::vector<const chemkit::Molecule *> molecules;
+    for(int i = 0; i < 100; i++){
+        molecules.push_back(createChain(1 + i % 7, i % 3 == 0));
+    }
+
+    chemkit::SubstructureScreen screen(&query);
+    screen.setThreadCount(4);
+    screen.setChunkSize(5);
+
+    std::vector<bool> matches = screen.screen(molecules);
+    QCOMPARE(matches.size(), molecules.size());
+    for(size_t i = 0; i < matches.size(); i++){
+        QCOMPARE(bool(matches[i]), i % 3 == 0);
+    }
+
+    QCOMPARE(screen.screenedCount(), size_t(100));
+    QCOMPARE(screen.isCanceled(), false);
+
+    foreach(const chemkit::Molecule *molecule, molecules){
+        delete molecule;
+    }
+}
+
+void SubstructureScreenTest::filter()
+{
+    boost::shared_ptr<chemkit::Molecule> hydroxyl(createChain(1, true));
+    chemkit::SubstructureQuery query(hydroxyl);
+
+    std::vector<chemkit::Molecule *> molecules;
+    for(int i = 0; i < 50; i++){
+        molecules.push_back(createChain(2, i % 2 == 0));
+    }
+
+    chemkit::SubstructureScreen screen(&query);
+    screen.setThreadCount(2);
+    std::vector<chemkit::Molecule *> alcohols = screen.filter(molecules);
+    QCOMPARE(alcohols.size(), size_t(25));
+
+    // molecules are returned in input order
+    for(size_t i = 0; i < alcohols.size(); i++){
+        QVERIFY(alcohols[i] == molecules[i * 2]);
+    }
+
+    // SubstructureQuery::filter() should give the same result
+    QVERIFY(query.filter(molecules) == alcohols);
+
+    foreach(chemkit::Molecule *molecule, molecules){
+        delete molecule;
+    }
+}
+
+void SubstructureScreenTest::fingerprints()
+{
+    boost::shared_ptr<chemkit::Molecule> propanol(createChain(3, true));
+    chemkit::SubstructureQuery query(propanol);
+
+    std::vector<const chemkit::Molecule *> molecules;
+    for(int i = 0; i < 60; i++){
+        molecules.push_back(createChain(1 + i % 5, i % 2 == 0));
+    }
+
+    chemkit::SubstructureScreen screen(&query);
+    screen.setThreadCount(3);
+    screen.setChunkSize(4);
+
+    std::vector<chemkit::Bitset> fingerprints = screen.fingerprints(molecules);
+    QCOMPARE(fingerprints.size(), molecules.size());
+    for(size_t i = 0; i < molecules.size(); i++){
+        QVERIFY(fingerprints[i] == query.screeningFingerprint(molecules[i]));
+    }
+
+    // screening with precalculated fingerprints gives the same result
+    QVERIFY(screen.screen(molecules, fingerprints) == screen.screen(molecules));
+
+    foreach(const chemkit::Molecule *molecule, molecules){
+        delete molecule;
+    }
+}
+
+void SubstructureScreenTest::concurrent()
+{
+    boost::shared_ptr<chemkit::Molecule> hydroxyl(createChain(1, true));
+    chemkit::SubstructureQuery query(hydroxyl);
+
+    chemkit::SubstructureScreen screen(&query);
+    screen.setThreadCount(4);
+    screen.setChunkSize(3);
+
+    // each thread screens its own molecules with the shared screen
+    std::vector<const chemkit::Molecule *> molecules[2];
+    for(int i = 0; i < 200; i++){
+        molecules[i % 2].push_back(createChain(1 + i % 7, i % 3 == 0));
+    }
+
+    std::vector<bool> matches[2];
+    boost::thread first(boost::bind(screenMolecules, &screen, &molecules[0], &matches[0]));
+    boost::thread second(boost::bind(screenMolecules, &screen, &molecules[1], &matches[1]));
+    first.join();
+    second.join();
+
+    for(int k = 0; k < 2; k++){
+        QCOMPARE(matches[k].size(), size_t(100));
+        for(size_t i = 0; i < matches[k].size(); i++){
+            QCOMPARE(bool(matches[k][i]), (2 * i + k) % 3 == 0);
+        }
+
+        foreach(const chemkit::Molecule *molecule, molecules[k]){
+            delete molecule;
+        }
+    }
+
+    QCOMPARE(screen.screenedCount(), size_t(4000));
+}
+
+void SubstructureScreenTest::cancel()
+{
+    boost::shared_ptr<chemkit::Molecule> hydroxyl(createChain(1, true));
+    chemkit::SubstructureQuery query(hydroxyl);
+
+    chemkit::SubstructureScreen screen(&query);
+    screen.setThreadCount(2);
+    screen.setChunkSize(1);
+
+    std::vector<const chemkit::Molecule *> molecules;
+    for(int i = 0; i < 300; i++){
+        molecules.push_back(createChain(1 + i % 7, i % 3 == 0));
+    }
+
+    // canceling with no screen running does not affect the next screen
+    screen.cancel();
+    std::vector<bool> matches = screen.screen(molecules);
+    QCOMPARE(screen.isCanceled(), false);
+    QCOMPARE(size_t(std::count(matches.begin(), matches.end(), true)), size_t(100));
+
+    // cancel the screens run by another thread until one is canceled
+    boost::atomic<bool> done(false);
+    boost::thread thread(boost::bind(screenUntilCanceled, &screen, &molecules, &done));
+    while(!done){
+        screen.cancel();
+        boost::this_thread::yield();
+    }
+    thread.join();
+
+    // the canceled screen belongs to the other thread
+    QCOMPARE(screen.isCanceled(), false);
+    matches = screen.screen(molecules);
+    QCOMPARE(screen.isCanceled(), false);
+    QCOMPARE(size_t(std::count(matches.begin(), matches.end(), true)), size_t(100));
+
+    foreach(const chemkit::Molecule *molecule, molecules){
+        delete molecule;
+    }
+}
+
+QTEST_APPLESS_MAIN(SubstructureScreenTest)
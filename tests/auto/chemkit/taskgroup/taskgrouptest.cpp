@@ -0,0 +1,171 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "taskgrouptest.h"
+
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/atomic.hpp>
+
+#include <chemkit/taskgroup.h>
+#include <chemkit/threadpool.h>
+
+namespace {
+
+void increment(boost::atomic<int> *counter)
+{
+    (*counter)++;
+}
+
+void fail()
+{
+    throw std::runtime_error("task failed");
+}
+
+// blocks until released is set
+void block(boost::atomic<bool> *released)
+{
+    while(!*released){
+        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    }
+}
+
+// starts count tasks in a nested group and waits for them from
+// within a pool thread
+void startNested(chemkit::ThreadPool *pool, boost::atomic<int> *counter, int count)
+{
+    chemkit::TaskGroup group(pool);
+    for(int i = 0; i < count; i++){
+        group.start(boost::bind(increment, counter));
+    }
+
+    group.wait();
+}
+
+} // end anonymous namespace
+
+void TaskGroupTest::wait()
+{
+    chemkit::ThreadPool pool(4);
+    boost::atomic<int> counter(0);
+
+    chemkit::TaskGroup group(&pool);
+    QVERIFY(group.pool() == &pool);
+
+    for(int i = 0; i < 1000; i++){
+        group.start(boost::bind(increment, &counter));
+    }
+
+    group.wait();
+    QCOMPARE(int(counter), 1000);
+
+    // waiting on an empty group returns immediately
+    group.wait();
+}
+
+void TaskGroupTest::independent()
+{
+    chemkit::ThreadPool pool(2);
+    boost::atomic<bool> released(false);
+    boost::atomic<int> counter(0);
+
+    // a task in another group which does not finish until released
+    chemkit::TaskGroup blockingGroup(&pool);
+    blockingGroup.start(boost::bind(block, &released));
+
+    // waiting for the second group does not wait for the first
+    chemkit::TaskGroup group(&pool);
+    for(int i = 0; i < 100; i++){
+        group.start(boost::bind(increment, &counter));
+    }
+
+    group.wait();
+    QCOMPARE(int(counter), 100);
+
+    released = true;
+    blockingGroup.wait();
+}
+
+void TaskGroupTest::nested()
+{
+    // with a single thread the outer tasks must run the nested
+    // tasks themselves while waiting
+    chemkit::ThreadPool pool(1);
+    boost::atomic<int> counter(0);
+
+    chemkit::TaskGroup group(&pool);
+    for(int i = 0; i < 4; i++){
+        group.start(boost::bind(startNested, &pool, &counter, 10));
+    }
+
+    group.wait();
+    QCOMPARE(int(counter), 40);
+}
+
+void TaskGroupTest::exception()
+{
+    chemkit::ThreadPool pool(2);
+    boost::atomic<int> counter(0);
+
+    chemkit::TaskGroup failingGroup(&pool);
+    chemkit::TaskGroup group(&pool);
+    failingGroup.start(fail);
+    for(int i = 0; i < 100; i++){
+        failingGroup.start(boost::bind(increment, &counter));
+        group.start(boost::bind(increment, &counter));
+    }
+
+    // only the group containing the failed task rethrows it
+    group.wait();
+
+    bool thrown = false;
+    try {
+        failingGroup.wait();
+    }
+    catch(const std::runtime_error &){
+        thrown = true;
+    }
+    QVERIFY(thrown);
+    QCOMPARE(int(counter), 200);
+
+    // the exception is only rethrown once
+    failingGroup.wait();
+    pool.waitForDone();
+}
+
+QTEST_APPLESS_MAIN(TaskGroupTest)
@@ -0,0 +1,130 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "threadpooltest.h"
+
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <chemkit/threadpool.h>
+#include <chemkit/concurrent.h>
+
+namespace {
+
+void increment(int *counter, boost::mutex *mutex)
+{
+    boost::lock_guard<boost::mutex> lock(*mutex);
+    (*counter)++;
+}
+
+int fortyTwo()
+{
+    return 42;
+}
+
+void fail()
+{
+    throw std::runtime_error("task failed");
+}
+
+} // end anonymous namespace
+
+void ThreadPoolTest::threadCount()
+{
+    QVERIFY(chemkit::ThreadPool::idealThreadCount() >= 1);
+
+    chemkit::ThreadPool pool(3);
+    QCOMPARE(pool.threadCount(), size_t(3));
+    QCOMPARE(pool.currentThreadIndex(), -1);
+
+    chemkit::ThreadPool defaultPool;
+    QCOMPARE(defaultPool.threadCount(), chemkit::ThreadPool::idealThreadCount());
+}
+
+void ThreadPoolTest::start()
+{
+    int counter = 0;
+    boost::mutex mutex;
+
+    chemkit::ThreadPool pool(4);
+    for(int i = 0; i < 1000; i++){
+        pool.start(boost::bind(increment, &counter, &mutex));
+    }
+
+    pool.waitForDone();
+    QCOMPARE(counter, 1000);
+}
+
+void ThreadPoolTest::run()
+{
+    boost::shared_future<int> future =
+        chemkit::concurrent::run(boost::function<int ()>(fortyTwo));
+
+    QCOMPARE(future.get(), 42);
+}
+
+void ThreadPoolTest::exception()
+{
+    int counter = 0;
+    boost::mutex mutex;
+
+    chemkit::ThreadPool pool(2);
+    pool.start(fail);
+    for(int i = 0; i < 100; i++){
+        pool.start(boost::bind(increment, &counter, &mutex));
+    }
+
+    // the exception is rethrown once all of the tasks have finished
+    bool thrown = false;
+    try {
+        pool.waitForDone();
+    }
+    catch(const std::runtime_error &e){
+        thrown = true;
+        QCOMPARE(std::string(e.what()), std::string("task failed"));
+    }
+    QVERIFY(thrown);
+    QCOMPARE(counter, 100);
+
+    // the pool is still usable afterwards
+    pool.start(boost::bind(increment, &counter, &mutex));
+    pool.waitForDone();
+    QCOMPARE(counter, 101);
+}
+
+QTEST_APPLESS_MAIN(ThreadPoolTest)
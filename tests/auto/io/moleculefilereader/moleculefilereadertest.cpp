@@ -0,0 +1,185 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "moleculefilereadertest.h"
+
+#include <sstream>
+
+#include <chemkit/molecule.h>
+#include <chemkit/moleculefile.h>
+#include <chemkit/moleculefilereader.h>
+
+const std::string dataPath = "../../../data/";
+
+void MoleculeFileReaderTest::fileName()
+{
+    chemkit::MoleculeFileReader reader;
+    QCOMPARE(reader.fileName(), std::string());
+    QCOMPARE(reader.isOpen(), false);
+
+    reader.setFileName("foo");
+    QCOMPARE(reader.fileName(), std::string("foo"));
+
+    chemkit::MoleculeFileReader readerWithName("bar.sdf");
+    QCOMPARE(readerWithName.fileName(), std::string("bar.sdf"));
+}
+
+void MoleculeFileReaderTest::format()
+{
+    chemkit::MoleculeFileReader reader;
+    QVERIFY(reader.format() == 0);
+    QCOMPARE(reader.open(), false);
+
+    chemkit::MoleculeFileReader sdfReader("foo.sdf");
+    QCOMPARE(sdfReader.formatName(), std::string("sdf"));
+
+    chemkit::MoleculeFileReader gzipReader("foo.mol2.gz");
+    QCOMPARE(gzipReader.formatName(), std::string("mol2"));
+    QCOMPARE(gzipReader.compressionFormat(), std::string("gz"));
+}
+
+void MoleculeFileReaderTest::readSdf()
+{
+    // read the file with the streaming reader
+    chemkit::MoleculeFileReader reader(dataPath + "pubchem_416_benzenes.sdf");
+    QVERIFY(reader.open());
+
+    // read the file all at once for comparison
+    chemkit::MoleculeFile file(dataPath + "pubchem_416_benzenes.sdf");
+    QVERIFY(file.read());
+
+    size_t count = 0;
+    while(boost::shared_ptr<chemkit::Molecule> molecule = reader.next()){
+        QVERIFY(count < file.moleculeCount());
+        QCOMPARE(molecule->name(), file.molecule(count)->name());
+        QCOMPARE(molecule->formula(), file.molecule(count)->formula());
+        count++;
+    }
+
+    QCOMPARE(count, size_t(416));
+    QCOMPARE(reader.position(), size_t(416));
+    QCOMPARE(reader.isOpen(), false);
+    QCOMPARE(reader.errorString(), std::string());
+}
+
+void MoleculeFileReaderTest::readMol2()
+{
+    chemkit::MoleculeFileReader reader(dataPath + "MMFF94_hypervalent.mol2");
+    QVERIFY(reader.open());
+
+    chemkit::MoleculeFile file(dataPath + "MMFF94_hypervalent.mol2");
+    QVERIFY(file.read());
+
+    size_t count = 0;
+    while(boost::shared_ptr<chemkit::Molecule> molecule = reader.next()){
+        QCOMPARE(molecule->name(), file.molecule(count)->name());
+        QCOMPARE(molecule->atomCount(), file.molecule(count)->atomCount());
+        QCOMPARE(molecule->bondCount(), file.molecule(count)->bondCount());
+        count++;
+    }
+
+    QCOMPARE(count, file.moleculeCount());
+}
+
+void MoleculeFileReaderTest::readSmi()
+{
+    chemkit::MoleculeFileReader reader(dataPath + "herg.smi");
+    QVERIFY(reader.open());
+
+    boost::shared_ptr<chemkit::Molecule> first = reader.next();
+    QVERIFY(first != 0);
+    QCOMPARE(reader.position(), size_t(1));
+
+    // reopening the reader starts again from the first molecule
+    QVERIFY(reader.open());
+    QCOMPARE(reader.position(), size_t(0));
+    boost::shared_ptr<chemkit::Molecule> again = reader.next();
+    QVERIFY(again != 0);
+    QCOMPARE(again->formula(), first->formula());
+}
+
+void MoleculeFileReaderTest::readUnsupported()
+{
+    // cml does not support incremental reading, the reader should
+    // fall back to reading the entire file
+    chemkit::MoleculeFileReader reader(dataPath + "ethanol.cml");
+    QVERIFY(reader.open());
+
+    boost::shared_ptr<chemkit::Molecule> molecule = reader.next();
+    QVERIFY(molecule != 0);
+    QCOMPARE(molecule->formula(), std::string("C2H6O"));
+    QVERIFY(reader.next() == 0);
+}
+
+void MoleculeFileReaderTest::readTrailingJunk()
+{
+    // a line which is not a frame after the last xyz frame must end
+    // reading with an error instead of returning empty molecules
+    std::stringstream input;
+    input << "3\n"
+          << "water\n"
+          << "O 0.000 0.000 0.000\n"
+          << "H 0.957 0.000 0.000\n"
+          << "H -0.240 0.927 0.000\n"
+          << "END\n";
+
+    chemkit::MoleculeFileReader reader;
+    QVERIFY(reader.setFormat("xyz"));
+    QVERIFY(reader.open(input));
+
+    boost::shared_ptr<chemkit::Molecule> molecule = reader.next();
+    QVERIFY(molecule != 0);
+    QCOMPARE(molecule->formula(), std::string("H2O"));
+
+    QVERIFY(reader.next() == 0);
+    QCOMPARE(reader.position(), size_t(1));
+    QCOMPARE(reader.isOpen(), false);
+    QVERIFY(!reader.errorString().empty());
+
+    // trailing blank lines are not an error
+    std::stringstream blankInput;
+    blankInput << "1\n"
+               << "helium\n"
+               << "He 0.000 0.000 0.000\n"
+               << "\n\n";
+
+    QVERIFY(reader.open(blankInput));
+    QVERIFY(reader.next() != 0);
+    QVERIFY(reader.next() == 0);
+    QCOMPARE(reader.errorString(), std::string());
+}
+
+QTEST_APPLESS_MAIN(MoleculeFileReaderTest)
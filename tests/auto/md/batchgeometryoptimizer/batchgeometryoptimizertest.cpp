@@ -0,0 +1,171 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "batchgeometryoptimizertest.h"
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <chemkit/atom.h>
+#include <chemkit/molecule.h>
+#include <chemkit/batchgeometryoptimizer.h>
+
+namespace {
+
+// Returns a new water molecule with a distorted geometry.
+boost::shared_ptr<chemkit::Molecule> createWater(size_t index)
+{
+    boost::shared_ptr<chemkit::Molecule> molecule(new chemkit::Molecule);
+    molecule->setName(boost::lexical_cast<std::string>(index));
+
+    chemkit::Atom *O1 = molecule->addAtom("O");
+    chemkit::Atom *H2 = molecule->addAtom("H");
+    chemkit::Atom *H3 = molecule->addAtom("H");
+    molecule->addBond(O1, H2);
+    molecule->addBond(O1, H3);
+
+    O1->setPosition(0, 0, 0);
+    H2->setPosition(0, 1 + 0.05 * (index % 5), 0);
+    H3->setPosition(1, 0.1 * (index % 3), 0);
+
+    return molecule;
+}
+
+class WaterSource
+{
+public:
+    WaterSource(size_t count)
+        : m_count(count),
+          m_index(0)
+    {
+    }
+
+    boost::shared_ptr<chemkit::Molecule> operator()()
+    {
+        if(m_index == m_count){
+            return boost::shared_ptr<chemkit::Molecule>();
+        }
+
+        return createWater(m_index++);
+    }
+
+private:
+    size_t m_count;
+    size_t m_index;
+};
+
+void storeMolecule(std::vector<boost::shared_ptr<chemkit::Molecule> > *molecules,
+                   const boost::shared_ptr<chemkit::Molecule> &molecule,
+                   bool converged)
+{
+    if(converged){
+        molecules->push_back(molecule);
+    }
+}
+
+} // end anonymous namespace
+
+void BatchGeometryOptimizerTest::basic()
+{
+    chemkit::BatchGeometryOptimizer optimizer;
+    QCOMPARE(optimizer.forceField(), std::string("uff"));
+    QVERIFY(optimizer.algorithm() == chemkit::MoleculeGeometryOptimizer::SteepestDescent);
+    QVERIFY(optimizer.threadCount() > 0);
+    QCOMPARE(optimizer.queueSize(), size_t(0));
+
+    optimizer.setThreadCount(3);
+    QCOMPARE(optimizer.threadCount(), size_t(3));
+
+    optimizer.setQueueSize(5);
+    QCOMPARE(optimizer.queueSize(), size_t(5));
+
+    // empty input
+    std::vector<chemkit::Molecule *> molecules;
+    QCOMPARE(optimizer.optimize(molecules).size(), size_t(0));
+    QCOMPARE(optimizer.moleculeCount(), size_t(0));
+}
+
+void BatchGeometryOptimizerTest::water_data()
+{
+    QTest::addColumn<int>("threadCount");
+    QTest::addColumn<int>("queueSize");
+
+    QTest::newRow("1 thread") << 1 << 0;
+    QTest::newRow("3 threads") << 3 << 0;
+    QTest::newRow("4 threads, queue size 1") << 4 << 1;
+}
+
+void BatchGeometryOptimizerTest::water()
+{
+    QFETCH(int, threadCount);
+    QFETCH(int, queueSize);
+
+    chemkit::BatchGeometryOptimizer optimizer;
+    optimizer.setThreadCount(threadCount);
+    optimizer.setQueueSize(queueSize);
+
+    std::vector<boost::shared_ptr<chemkit::Molecule> > molecules;
+    size_t count = optimizer.optimize(WaterSource(20), boost::bind(storeMolecule, &molecules, _1, _2));
+    QCOMPARE(count, size_t(20));
+    QCOMPARE(optimizer.moleculeCount(), size_t(20));
+    QCOMPARE(optimizer.convergedCount(), size_t(20));
+    QVERIFY(optimizer.evaluationCount() > 0);
+    QCOMPARE(molecules.size(), size_t(20));
+
+    // molecules are written in input order
+    for(size_t i = 0; i < molecules.size(); i++){
+        const chemkit::Molecule *molecule = molecules[i].get();
+        QCOMPARE(molecule->name(), boost::lexical_cast<std::string>(i));
+        QVERIFY(qAbs(molecule->bondAngle(molecule->atom(1), molecule->atom(0), molecule->atom(2)) - 104.5) < 0.5);
+    }
+
+    // optimize a vector of molecules
+    std::vector<chemkit::Molecule *> pointers;
+    std::vector<boost::shared_ptr<chemkit::Molecule> > waters;
+    for(size_t i = 0; i < 7; i++){
+        waters.push_back(createWater(i));
+        pointers.push_back(waters.back().get());
+    }
+
+    std::vector<bool> converged = optimizer.optimize(pointers);
+    QCOMPARE(converged.size(), size_t(7));
+    QCOMPARE(optimizer.convergedCount(), size_t(7));
+    for(size_t i = 0; i < converged.size(); i++){
+        QVERIFY(converged[i]);
+    }
+}
+
+QTEST_APPLESS_MAIN(BatchGeometryOptimizerTest)
@@ -0,0 +1,147 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "forcefieldparameterscachetest.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <chemkit/forcefieldparameterscache.h>
+
+namespace {
+
+class TestParameters
+{
+public:
+    TestParameters()
+    {
+        createdCount++;
+    }
+
+    bool read(const std::string &fileName)
+    {
+        m_fileName = fileName;
+        return fileName != "missing.prm";
+    }
+
+    std::string fileName() const { return m_fileName; }
+    std::string errorString() const { return "Failed to open parameters file."; }
+
+    static int createdCount;
+
+private:
+    std::string m_fileName;
+};
+
+int TestParameters::createdCount = 0;
+
+typedef chemkit::ForceFieldParametersCache<TestParameters> TestParametersCache;
+
+void requestParameters(std::vector<boost::shared_ptr<const TestParameters> > *parameters, size_t index)
+{
+    (*parameters)[index] = TestParametersCache::parameters("threads.prm");
+}
+
+} // end anonymous namespace
+
+void ForceFieldParametersCacheTest::parameters()
+{
+    TestParametersCache::clear();
+    TestParameters::createdCount = 0;
+
+    boost::shared_ptr<const TestParameters> a = TestParametersCache::parameters();
+    QVERIFY(a != 0);
+    QCOMPARE(TestParameters::createdCount, 1);
+
+    // built-in parameters are only created once
+    boost::shared_ptr<const TestParameters> b = TestParametersCache::parameters();
+    QVERIFY(b == a);
+    QCOMPARE(TestParameters::createdCount, 1);
+
+    // parameters in use stay valid after the cache is cleared
+    TestParametersCache::clear();
+    QCOMPARE(a.use_count(), 2L);
+    b = TestParametersCache::parameters();
+    QVERIFY(b != a);
+    QCOMPARE(TestParameters::createdCount, 2);
+}
+
+void ForceFieldParametersCacheTest::read()
+{
+    TestParametersCache::clear();
+    TestParameters::createdCount = 0;
+
+    boost::shared_ptr<const TestParameters> a = TestParametersCache::parameters("a.prm");
+    QVERIFY(a != 0);
+    QCOMPARE(a->fileName(), std::string("a.prm"));
+
+    boost::shared_ptr<const TestParameters> b = TestParametersCache::parameters("b.prm");
+    QVERIFY(b != 0);
+    QVERIFY(b != a);
+    QCOMPARE(b->fileName(), std::string("b.prm"));
+
+    QVERIFY(TestParametersCache::parameters("a.prm") == a);
+    QCOMPARE(TestParameters::createdCount, 2);
+
+    // failed reads are reported and not cached
+    std::string errorString;
+    QVERIFY(TestParametersCache::parameters("missing.prm", &errorString) == 0);
+    QCOMPARE(errorString, std::string("Failed to open parameters file."));
+    QVERIFY(TestParametersCache::parameters("missing.prm") == 0);
+    QCOMPARE(TestParameters::createdCount, 4);
+}
+
+void ForceFieldParametersCacheTest::threads()
+{
+    TestParametersCache::clear();
+    TestParameters::createdCount = 0;
+
+    std::vector<boost::shared_ptr<const TestParameters> > parameters(8);
+
+    boost::thread_group threads;
+    for(size_t i = 0; i < parameters.size(); i++){
+        threads.create_thread(boost::bind(requestParameters, &parameters, i));
+    }
+    threads.join_all();
+
+    QCOMPARE(TestParameters::createdCount, 1);
+    for(size_t i = 0; i < parameters.size(); i++){
+        QVERIFY(parameters[i] != 0);
+        QVERIFY(parameters[i] == parameters[0]);
+    }
+}
+
+QTEST_APPLESS_MAIN(ForceFieldParametersCacheTest)
@@ -0,0 +1,120 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "langevinintegratortest.h"
+
+#include "../harmonicpotential.h"
+
+#include <boost/make_shared.hpp>
+
+#include <chemkit/potential.h>
+#include <chemkit/langevinintegrator.h>
+#include <chemkit/cartesiancoordinates.h>
+
+void LangevinIntegratorTest::basic()
+{
+    chemkit::LangevinIntegrator integrator;
+    QCOMPARE(integrator.frictionCoefficient(), chemkit::Real(1.0));
+    QCOMPARE(integrator.seed(), 0U);
+
+    integrator.setFrictionCoefficient(5.0);
+    QCOMPARE(integrator.frictionCoefficient(), chemkit::Real(5.0));
+}
+
+void LangevinIntegratorTest::temperature()
+{
+    // start every atom at rest in the bottom of the well
+    chemkit::CartesianCoordinates coordinates(200);
+
+    chemkit::LangevinIntegrator integrator;
+    integrator.setPotential(boost::make_shared<HarmonicPotential>(1.0));
+    integrator.setCoordinates(&coordinates);
+    integrator.setMasses(std::vector<chemkit::Real>(200, 12.0));
+    integrator.setVelocities(std::vector<chemkit::Vector3>(200, chemkit::Vector3(0, 0, 0)));
+    integrator.setTemperature(300);
+    integrator.setTimestep(2.0);
+    integrator.setFrictionCoefficient(20.0);
+    integrator.setFrameInterval(0);
+
+    // equilibrate
+    integrator.run(500);
+
+    // the average temperature matches the heat bath
+    chemkit::Real temperature = 0;
+    for(int i = 0; i < 500; i++){
+        integrator.integrate();
+        temperature += integrator.kineticTemperature();
+    }
+    temperature /= 500;
+
+    QVERIFY(qAbs(temperature - 300) < 15);
+}
+
+void LangevinIntegratorTest::seed()
+{
+    chemkit::CartesianCoordinates coordinates(10);
+    for(size_t i = 0; i < coordinates.size(); i++){
+        coordinates.setPosition(i, chemkit::Point3(0.1 * i, 0, 0));
+    }
+
+    boost::shared_ptr<chemkit::Potential> potential = boost::make_shared<HarmonicPotential>(1.0);
+
+    chemkit::LangevinIntegrator a;
+    a.setPotential(potential);
+    a.setCoordinates(&coordinates);
+    a.setSeed(42);
+    a.run(50);
+
+    chemkit::LangevinIntegrator b;
+    b.setPotential(potential);
+    b.setCoordinates(&coordinates);
+    b.setSeed(42);
+    b.run(50);
+
+    // the same seed gives the same trajectory
+    for(size_t i = 0; i < coordinates.size(); i++){
+        QVERIFY(a.coordinates()->position(i) == b.coordinates()->position(i));
+    }
+
+    chemkit::LangevinIntegrator c;
+    c.setPotential(potential);
+    c.setCoordinates(&coordinates);
+    c.setSeed(7);
+    c.run(50);
+    QVERIFY(a.coordinates()->position(0) != c.coordinates()->position(0));
+}
+
+QTEST_APPLESS_MAIN(LangevinIntegratorTest)
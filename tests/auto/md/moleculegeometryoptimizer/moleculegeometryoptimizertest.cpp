@@ -82,4 +82,92 @@ void MoleculeGeometryOptimizerTest::water()
     QCOMPARE(qRound(molecule.bondAngle(H2, O1, H3)), 104);
 }
 
+void MoleculeGeometryOptimizerTest::algorithm_data()
+{
+    QTest::addColumn<int>("algorithm");
+
+    QTest::newRow("steepest-descent") << int(chemkit::MoleculeGeometryOptimizer::SteepestDescent);
+    QTest::newRow("conjugate-gradient") << int(chemkit::MoleculeGeometryOptimizer::ConjugateGradient);
+    QTest::newRow("lbfgs") << int(chemkit::MoleculeGeometryOptimizer::Lbfgs);
+}
+
+void MoleculeGeometryOptimizerTest::algorithm()
+{
+    QFETCH(int, algorithm);
+
+    chemkit::Molecule molecule;
+    chemkit::Atom *O1 = molecule.addAtom("O");
+    chemkit::Atom *H2 = molecule.addAtom("H");
+    chemkit::Atom *H3 = molecule.addAtom("H");
+    molecule.addBond(O1, H2);
+    molecule.addBond(O1, H3);
+
+    O1->setPosition(0, 0, 0);
+    H2->setPosition(0, 1, 0);
+    H3->setPosition(1, 0, 0);
+
+    chemkit::MoleculeGeometryOptimizer optimizer(&molecule);
+    QVERIFY(optimizer.algorithm() == chemkit::MoleculeGeometryOptimizer::SteepestDescent);
+    optimizer.setAlgorithm(chemkit::MoleculeGeometryOptimizer::Algorithm(algorithm));
+    QVERIFY(optimizer.algorithm() == algorithm);
+
+    optimizer.setGradientTolerance(0.01);
+    QVERIFY(optimizer.gradientTolerance() == 0.01);
+
+    QVERIFY(optimizer.optimize());
+    QVERIFY(optimizer.converged());
+    QVERIFY(!optimizer.isStalled());
+    QVERIFY(optimizer.iterationCount() > 0);
+    QVERIFY(optimizer.evaluationCount() >= optimizer.iterationCount());
+    QVERIFY(qAbs(molecule.bondAngle(H2, O1, H3) - 104.5) < 0.1);
+}
+
+void MoleculeGeometryOptimizerTest::maximumIterations()
+{
+    chemkit::Molecule molecule;
+    chemkit::Atom *O1 = molecule.addAtom("O");
+    chemkit::Atom *H2 = molecule.addAtom("H");
+    chemkit::Atom *H3 = molecule.addAtom("H");
+    molecule.addBond(O1, H2);
+    molecule.addBond(O1, H3);
+
+    O1->setPosition(0, 0, 0);
+    H2->setPosition(0, 1, 0);
+    H3->setPosition(1, 0, 0);
+
+    chemkit::MoleculeGeometryOptimizer optimizer(&molecule);
+    optimizer.setAlgorithm(chemkit::MoleculeGeometryOptimizer::SteepestDescent);
+    optimizer.setMaximumIterations(2);
+    QCOMPARE(optimizer.maximumIterations(), size_t(2));
+
+    QVERIFY(!optimizer.optimize());
+    QCOMPARE(optimizer.iterationCount(), size_t(2));
+}
+
+void MoleculeGeometryOptimizerTest::stalled()
+{
+    chemkit::Molecule molecule;
+    chemkit::Atom *O1 = molecule.addAtom("O");
+    chemkit::Atom *H2 = molecule.addAtom("H");
+    chemkit::Atom *H3 = molecule.addAtom("H");
+    molecule.addBond(O1, H2);
+    molecule.addBond(O1, H3);
+
+    O1->setPosition(0, 0, 0);
+    H2->setPosition(0, 1, 0);
+    H3->setPosition(1, 0, 0);
+
+    // a zero gradient tolerance can not be reached so steepest
+    // descent runs until no step reduces the energy any further
+    chemkit::MoleculeGeometryOptimizer optimizer(&molecule);
+    optimizer.setGradientTolerance(0);
+    optimizer.setMaximumIterations(100000);
+
+    QVERIFY(!optimizer.optimize());
+    QVERIFY(optimizer.isStalled());
+    QVERIFY(!optimizer.converged());
+    QVERIFY(optimizer.iterationCount() < optimizer.maximumIterations());
+    QVERIFY(qAbs(molecule.bondAngle(H2, O1, H3) - 104.5) < 0.1);
+}
+
 QTEST_APPLESS_MAIN(MoleculeGeometryOptimizerTest)
@@ -45,6 +45,10 @@ class MoleculeGeometryOptimizerTest : public QObject
     private slots:
         void molecule();
         void water();
+        void algorithm_data();
+        void algorithm();
+        void maximumIterations();
+        void stalled();
 };
 
 #endif // MOLECULEGEOMTRYOPTIMIZERTEST_H
@@ -0,0 +1,143 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "trajectorytest.h"
+
+#include <chemkit/trajectory.h>
+#include <chemkit/trajectoryframe.h>
+#include <chemkit/cartesiancoordinates.h>
+
+void TrajectoryTest::basic()
+{
+    chemkit::Trajectory trajectory(3);
+    QCOMPARE(trajectory.size(), size_t(3));
+    QVERIFY(trajectory.isEmpty());
+    QCOMPARE(trajectory.coordinatePrecision(), chemkit::Trajectory::DoublePrecision);
+
+    chemkit::TrajectoryFrame *frame = trajectory.addFrame();
+    QCOMPARE(trajectory.frameCount(), size_t(1));
+    QCOMPARE(frame->size(), size_t(3));
+    QCOMPARE(frame->index(), size_t(0));
+
+    frame->setPosition(1, chemkit::Point3(1, 2, 3));
+    QVERIFY(frame->position(1) == chemkit::Point3(1, 2, 3));
+    QVERIFY(frame->coordinates()->position(1) == chemkit::Point3(1, 2, 3));
+    QVERIFY(frame->packedCoordinates().isEmpty());
+
+    trajectory.resize(5);
+    QCOMPARE(frame->size(), size_t(5));
+
+    QVERIFY(trajectory.removeFrame(frame));
+    QVERIFY(trajectory.isEmpty());
+}
+
+void TrajectoryTest::singlePrecision()
+{
+    chemkit::Trajectory trajectory(4);
+
+    // existing frames are converted
+    chemkit::TrajectoryFrame *first = trajectory.addFrame();
+    first->setPosition(0, chemkit::Point3(1.5, 0, 0));
+    trajectory.setCoordinatePrecision(chemkit::Trajectory::SinglePrecision);
+    QCOMPARE(trajectory.coordinatePrecision(), chemkit::Trajectory::SinglePrecision);
+    QCOMPARE(first->packedCoordinates().size(), size_t(4));
+    QVERIFY(first->position(0) == chemkit::Point3(1.5, 0, 0));
+
+    // new frames use single precision
+    chemkit::TrajectoryFrame *second = trajectory.addFrame();
+    QCOMPARE(second->size(), size_t(4));
+
+    chemkit::PackedCoordinatesView<float> view = second->packedCoordinates();
+    QCOMPARE(view.size(), size_t(4));
+
+    second->setPosition(2, chemkit::Point3(0.5, 1.0, 2.0));
+    QCOMPARE(view.y()[2], 1.0f);
+
+    // changes through the view are visible in the frame
+    view.moveBy(1, 0, 0);
+    QVERIFY(second->position(2) == chemkit::Point3(1.5, 1.0, 2.0));
+
+    // double precision copy stays in sync with the frame
+    const chemkit::CartesianCoordinates *coordinates = second->coordinates();
+    QCOMPARE(coordinates->size(), size_t(4));
+    QVERIFY(coordinates->position(2) == chemkit::Point3(1.5, 1.0, 2.0));
+    second->setPosition(3, chemkit::Point3(4, 5, 6));
+    QVERIFY(coordinates->position(3) == chemkit::Point3(4, 5, 6));
+
+    QCOMPARE(qRound(view.rmsd(first->packedCoordinates()) * 100), 462);
+
+    // convert back to double precision
+    trajectory.setCoordinatePrecision(chemkit::Trajectory::DoublePrecision);
+    QVERIFY(second->packedCoordinates().isEmpty());
+    QVERIFY(second->position(3) == chemkit::Point3(4, 5, 6));
+    QVERIFY(first->position(0) == chemkit::Point3(1.5, 0, 0));
+}
+
+void TrajectoryTest::packedCoordinatesView()
+{
+    chemkit::Trajectory trajectory(2);
+    trajectory.setCoordinatePrecision(chemkit::Trajectory::SinglePrecision);
+
+    chemkit::TrajectoryFrame *frame = trajectory.addFrame();
+    frame->setPosition(0, chemkit::Point3(1, 2, 3));
+
+    // coordinates() returns a copy owned by the caller which stays
+    // valid after the view is used
+    chemkit::PackedCoordinatesView<float> view = frame->packedCoordinates();
+    boost::shared_ptr<const chemkit::CartesianCoordinates> copy = frame->coordinates();
+    QVERIFY(copy->position(0) == chemkit::Point3(1, 2, 3));
+    view.setPosition(0, chemkit::Point3(4, 5, 6));
+    QVERIFY(frame->packedCoordinates().position(0) == chemkit::Point3(4, 5, 6));
+    QVERIFY(copy->position(0) == chemkit::Point3(1, 2, 3));
+    QVERIFY(frame->coordinates()->position(0) == chemkit::Point3(4, 5, 6));
+
+    // writes through a view are seen by later copies
+    QVERIFY(frame->coordinates()->position(1) == chemkit::Point3(0, 0, 0));
+    frame->packedCoordinates().setPosition(1, chemkit::Point3(7, 8, 9));
+    QVERIFY(frame->coordinates()->position(1) == chemkit::Point3(7, 8, 9));
+    QCOMPARE(copy->size(), size_t(2));
+
+    // converting back to double precision keeps writes made through
+    // the view after the last call to coordinates()
+    view.setPosition(0, chemkit::Point3(-1, -2, -3));
+    trajectory.setCoordinatePrecision(chemkit::Trajectory::DoublePrecision);
+    QVERIFY(frame->packedCoordinates().isEmpty());
+    QVERIFY(frame->position(0) == chemkit::Point3(-1, -2, -3));
+    QVERIFY(frame->position(1) == chemkit::Point3(7, 8, 9));
+    QVERIFY(frame->coordinates()->position(0) == chemkit::Point3(-1, -2, -3));
+}
+
+QTEST_APPLESS_MAIN(TrajectoryTest)
@@ -0,0 +1,186 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "velocityverletintegratortest.h"
+
+#include "../harmonicpotential.h"
+
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+
+#include <chemkit/potential.h>
+#include <chemkit/trajectory.h>
+#include <chemkit/trajectoryframe.h>
+#include <chemkit/cartesiancoordinates.h>
+#include <chemkit/velocityverletintegrator.h>
+
+namespace {
+
+void countFrame(size_t *count, chemkit::Real time, const chemkit::CartesianCoordinates *coordinates)
+{
+    CHEMKIT_UNUSED(time);
+    CHEMKIT_UNUSED(coordinates);
+
+    (*count)++;
+}
+
+} // end anonymous namespace
+
+void VelocityVerletIntegratorTest::basic()
+{
+    chemkit::VelocityVerletIntegrator integrator;
+    QCOMPARE(integrator.timestep(), chemkit::Real(1.0));
+    QCOMPARE(integrator.temperature(), chemkit::Real(300.0));
+    QCOMPARE(integrator.couplingTime(), chemkit::Real(0.0));
+    QCOMPARE(integrator.frameInterval(), size_t(1));
+    QCOMPARE(integrator.stepCount(), size_t(0));
+    QVERIFY(integrator.trajectory() == 0);
+
+    // nothing happens without a potential
+    integrator.integrate();
+    QCOMPARE(integrator.stepCount(), size_t(0));
+}
+
+void VelocityVerletIntegratorTest::energyConservation()
+{
+    chemkit::CartesianCoordinates coordinates(2);
+    coordinates.setPosition(0, chemkit::Point3(1, 0, 0));
+    coordinates.setPosition(1, chemkit::Point3(0, -0.5, 0.5));
+
+    chemkit::VelocityVerletIntegrator integrator;
+    integrator.setPotential(boost::make_shared<HarmonicPotential>(1.0));
+    integrator.setCoordinates(&coordinates);
+    integrator.setMasses(std::vector<chemkit::Real>(2, 12.0));
+    integrator.setVelocities(std::vector<chemkit::Vector3>(2, chemkit::Vector3(0, 0, 0)));
+    integrator.setTimestep(2.0);
+
+    chemkit::Real initialEnergy = integrator.energy() + integrator.kineticEnergy();
+    QVERIFY(qAbs(initialEnergy - 0.75) < 1e-10);
+
+    for(int i = 0; i < 10; i++){
+        integrator.run(100);
+
+        chemkit::Real energy = integrator.energy() + integrator.kineticEnergy();
+        QVERIFY(qAbs(energy - initialEnergy) < 1e-3 * initialEnergy);
+    }
+
+    QCOMPARE(integrator.stepCount(), size_t(1000));
+    QVERIFY(qAbs(integrator.time() - 2000.0) < 1e-10);
+    QVERIFY(integrator.kineticEnergy() > 0);
+}
+
+void VelocityVerletIntegratorTest::thermostat()
+{
+    chemkit::CartesianCoordinates coordinates(100);
+    for(size_t i = 0; i < coordinates.size(); i++){
+        coordinates.setPosition(i, chemkit::Point3(0.1 * (i % 7), -0.1 * (i % 3), 0.1 * (i % 5)));
+    }
+
+    chemkit::VelocityVerletIntegrator integrator;
+    integrator.setPotential(boost::make_shared<HarmonicPotential>(0.5));
+    integrator.setCoordinates(&coordinates);
+    integrator.setMasses(std::vector<chemkit::Real>(100, 16.0));
+    integrator.setTemperature(100);
+    integrator.initializeVelocities();
+    QVERIFY(qAbs(integrator.kineticTemperature() - 100) < 1e-6);
+
+    // heat the system to 400 K
+    integrator.setTemperature(400);
+    integrator.setCouplingTime(50);
+    integrator.run(2000);
+    QVERIFY(qAbs(integrator.kineticTemperature() - 400) < 40);
+}
+
+void VelocityVerletIntegratorTest::strongCoupling()
+{
+    chemkit::CartesianCoordinates coordinates(10);
+    for(size_t i = 0; i < coordinates.size(); i++){
+        coordinates.setPosition(i, chemkit::Point3(0.2 * i, 0, 0));
+    }
+
+    chemkit::VelocityVerletIntegrator integrator;
+    integrator.setPotential(boost::make_shared<HarmonicPotential>(0.5));
+    integrator.setCoordinates(&coordinates);
+    integrator.setMasses(std::vector<chemkit::Real>(10, 12.0));
+
+    // start at rest so that the first step sees a zero temperature
+    integrator.setVelocities(std::vector<chemkit::Vector3>(10, chemkit::Vector3(0, 0, 0)));
+
+    // a coupling time shorter than the timestep and a system far
+    // hotter than the target would give a negative scale argument
+    integrator.setTimestep(2.0);
+    integrator.setCouplingTime(0.5);
+    integrator.setTemperature(1);
+    integrator.run(100);
+
+    chemkit::Real temperature = integrator.kineticTemperature();
+    QVERIFY(temperature == temperature);
+    QVERIFY(temperature >= 0);
+    for(size_t i = 0; i < coordinates.size(); i++){
+        chemkit::Point3 position = coordinates.position(i);
+        QVERIFY(position.x() == position.x());
+    }
+}
+
+void VelocityVerletIntegratorTest::trajectory()
+{
+    chemkit::CartesianCoordinates coordinates(3);
+    coordinates.setPosition(0, chemkit::Point3(1, 0, 0));
+
+    boost::shared_ptr<chemkit::Trajectory> trajectory = boost::make_shared<chemkit::Trajectory>();
+    size_t writtenFrameCount = 0;
+
+    chemkit::VelocityVerletIntegrator integrator;
+    integrator.setPotential(boost::make_shared<HarmonicPotential>(1.0));
+    integrator.setCoordinates(&coordinates);
+    integrator.setTrajectory(trajectory);
+    integrator.setFrameWriter(boost::bind(countFrame, &writtenFrameCount, _1, _2));
+    integrator.setFrameInterval(10);
+    integrator.setTimestep(0.5);
+    integrator.run(100);
+
+    QCOMPARE(trajectory->size(), size_t(3));
+    QCOMPARE(trajectory->frameCount(), size_t(10));
+    QCOMPARE(writtenFrameCount, size_t(10));
+    QVERIFY(qAbs(trajectory->frame(0)->time() - 5.0) < 1e-10);
+    QVERIFY(qAbs(trajectory->frame(9)->time() - 50.0) < 1e-10);
+    QVERIFY(trajectory->frame(9)->position(0) == integrator.coordinates()->position(0));
+
+    // masses default to one without a topology
+    QVERIFY(integrator.masses() == std::vector<chemkit::Real>(3, 1.0));
+}
+
+QTEST_APPLESS_MAIN(VelocityVerletIntegratorTest)
@@ -44,6 +44,8 @@
 #include <chemkit/forcefield.h>
 #include <chemkit/moleculefile.h>
 #include <chemkit/moleculardescriptor.h>
+#include <chemkit/forcefieldcalculation.h>
+#include <chemkit/cartesiancoordinates.h>
 
 #ifdef CHEMKIT_WITH_MD_IO
 #include <chemkit/trajectoryfileformat.h>
@@ -204,4 +206,114 @@ void AmberTest::water()
     delete forceField;
 }
 
+void AmberTest::gradient()
+{
+    boost::shared_ptr<chemkit::Molecule> molecule =
+        chemkit::MoleculeFile::quickRead(dataPath + "adenosine.mol");
+    QVERIFY(molecule);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("amber");
+    QVERIFY(forceField != 0);
+
+    forceField->setTopologyFromMolecule(molecule.get());
+    forceField->setup();
+    QVERIFY(forceField->isSetup());
+
+    const chemkit::CartesianCoordinates *coordinates = molecule->coordinates();
+
+    // the energy is the sum of the energies of each calculation
+    chemkit::Real energy = 0;
+    foreach(const chemkit::ForceFieldCalculation *calculation, forceField->calculations()){
+        energy += calculation->energy(coordinates);
+    }
+    QVERIFY(std::abs(forceField->energy(coordinates) - energy) < 1e-6);
+
+    // the analytical gradient agrees with a central difference
+    std::vector<chemkit::Vector3> gradient = forceField->gradient(coordinates);
+    QCOMPARE(gradient.size(), size_t(molecule->size()));
+
+    chemkit::CartesianCoordinates displacedCoordinates(*coordinates);
+    const chemkit::Real h = 1e-5;
+    for(size_t i = 0; i < displacedCoordinates.size(); i++){
+        chemkit::Point3 position = displacedCoordinates.position(i);
+
+        for(int j = 0; j < 3; j++){
+            chemkit::Vector3 step(0, 0, 0);
+            step[j] = h;
+
+            displacedCoordinates.setPosition(i, position + step);
+            chemkit::Real forwardEnergy = forceField->energy(&displacedCoordinates);
+            displacedCoordinates.setPosition(i, position - step);
+            chemkit::Real backwardEnergy = forceField->energy(&displacedCoordinates);
+            displacedCoordinates.setPosition(i, position);
+
+            QVERIFY(std::abs((forwardEnergy - backwardEnergy) / (2 * h) - gradient[i][j]) < 1e-3);
+        }
+    }
+
+    delete forceField;
+}
+
+void AmberTest::nonbondedCutoff()
+{
+    boost::shared_ptr<chemkit::Molecule> molecule =
+        chemkit::MoleculeFile::quickRead(dataPath + "adenosine.mol");
+    QVERIFY(molecule);
+
+    const chemkit::CartesianCoordinates *coordinates = molecule->coordinates();
+
+    // evaluate every nonbonded pair
+    chemkit::ForceField *forceField = chemkit::ForceField::create("amber");
+    QVERIFY(forceField != 0);
+    forceField->setTopologyFromMolecule(molecule.get());
+    forceField->setup();
+    QVERIFY(forceField->isSetup());
+
+    chemkit::Real energy = forceField->energy(coordinates);
+    std::vector<chemkit::Vector3> gradient = forceField->gradient(coordinates);
+
+    // a cutoff larger than the molecule gives the same result
+    chemkit::ForceField *cutoffForceField = chemkit::ForceField::create("amber");
+    QVERIFY(cutoffForceField != 0);
+    cutoffForceField->setNonbondedCutoff(100.0);
+    cutoffForceField->setTopologyFromMolecule(molecule.get());
+    QCOMPARE(cutoffForceField->topology()->nonbondedInteractionCount(), size_t(0));
+    cutoffForceField->setup();
+    QVERIFY(cutoffForceField->isSetup());
+
+    QVERIFY(std::abs(cutoffForceField->energy(coordinates) - energy) < 1e-6);
+
+    std::vector<chemkit::Vector3> cutoffGradient = cutoffForceField->gradient(coordinates);
+    QCOMPARE(cutoffGradient.size(), gradient.size());
+    for(size_t i = 0; i < gradient.size(); i++){
+        QVERIFY((cutoffGradient[i] - gradient[i]).norm() < 1e-6);
+    }
+
+    // the switched gradient agrees with a central difference
+    cutoffForceField->setNonbondedCutoff(5.0);
+    cutoffGradient = cutoffForceField->gradient(coordinates);
+
+    chemkit::CartesianCoordinates displacedCoordinates(*coordinates);
+    const chemkit::Real h = 1e-5;
+    for(size_t i = 0; i < displacedCoordinates.size(); i++){
+        chemkit::Point3 position = displacedCoordinates.position(i);
+
+        for(int j = 0; j < 3; j++){
+            chemkit::Vector3 step(0, 0, 0);
+            step[j] = h;
+
+            displacedCoordinates.setPosition(i, position + step);
+            chemkit::Real forwardEnergy = cutoffForceField->energy(&displacedCoordinates);
+            displacedCoordinates.setPosition(i, position - step);
+            chemkit::Real backwardEnergy = cutoffForceField->energy(&displacedCoordinates);
+            displacedCoordinates.setPosition(i, position);
+
+            QVERIFY(std::abs((forwardEnergy - backwardEnergy) / (2 * h) - cutoffGradient[i][j]) < 1e-3);
+        }
+    }
+
+    delete forceField;
+    delete cutoffForceField;
+}
+
 QTEST_APPLESS_MAIN(AmberTest)
@@ -47,6 +47,8 @@ class AmberTest : public QObject
         void adenosine();
         void serine();
         void water();
+        void gradient();
+        void nonbondedCutoff();
 };
 
 #endif // AMBERTEST_H
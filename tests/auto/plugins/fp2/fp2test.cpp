@@ -37,8 +37,12 @@
 
 #include <boost/range/algorithm.hpp>
 
+#include <chemkit/foreach.h>
 #include <chemkit/molecule.h>
 #include <chemkit/fingerprint.h>
+#include <chemkit/moleculefile.h>
+
+const std::string dataPath = "../../../data/";
 
 void Fp2Test::initTestCase()
 {
@@ -258,4 +262,32 @@ void Fp2Test::test()
     }
 }
 
+void Fp2Test::batch()
+{
+    chemkit::MoleculeFile file(dataPath + "pubchem_416_benzenes.sdf");
+    bool ok = file.read();
+    if(!ok)
+        qDebug() << file.errorString().c_str();
+    QVERIFY(ok);
+
+    std::vector<const chemkit::Molecule *> molecules;
+    foreach(const boost::shared_ptr<chemkit::Molecule> &molecule, file.molecules()){
+        molecules.push_back(molecule.get());
+    }
+    QCOMPARE(molecules.size(), size_t(416));
+
+    chemkit::Fingerprint *fingerprint = chemkit::Fingerprint::create("fp2");
+    QVERIFY(fingerprint != 0);
+
+    // the batch values must match the values for each molecule
+    std::vector<chemkit::Bitset> values = fingerprint->value(molecules);
+    QCOMPARE(values.size(), molecules.size());
+
+    for(size_t i = 0; i < molecules.size(); i++){
+        QVERIFY(values[i] == fingerprint->value(molecules[i]));
+    }
+
+    delete fingerprint;
+}
+
 QTEST_APPLESS_MAIN(Fp2Test)
@@ -47,6 +47,7 @@ class Fp2Test : public QObject
         void name();
         void test_data();
         void test();
+        void batch();
 };
 
 #endif // FP2TEST_H
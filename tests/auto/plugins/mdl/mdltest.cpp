@@ -116,6 +116,28 @@ void MdlTest::read_benzenes()
     }
 }
 
+void MdlTest::read_benzenes_parallel()
+{
+    chemkit::MoleculeFile file(dataPath + "pubchem_416_benzenes.sdf");
+    bool ok = file.read();
+    QVERIFY(ok);
+
+    chemkit::MoleculeFile parallelFile(dataPath + "pubchem_416_benzenes.sdf");
+    parallelFile.setThreadCount(4);
+    QCOMPARE(parallelFile.threadCount(), size_t(4));
+    ok = parallelFile.read();
+    if(!ok)
+        qDebug() << parallelFile.errorString().c_str();
+    QVERIFY(ok);
+
+    // check that the molecules are read in file order
+    QCOMPARE(parallelFile.moleculeCount(), size_t(416));
+    for(size_t i = 0; i < file.moleculeCount(); i++){
+        QCOMPARE(parallelFile.molecule(i)->name(), file.molecule(i)->name());
+        QCOMPARE(parallelFile.molecule(i)->formula(), file.molecule(i)->formula());
+    }
+}
+
 void MdlTest::read_serine()
 {
     // check that gz compression is supported
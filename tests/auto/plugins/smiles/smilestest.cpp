@@ -414,6 +414,17 @@ void SmilesTest::colchicine()
     COMPARE_SMILES(&molecule, molecule.formula("smiles"));
 }
 
+void SmilesTest::colzuy()
+{
+    // rings must not be opened on bonds whose removal would leave the
+    // ring closure as the only connection between two fragments
+    chemkit::Molecule molecule("P1(N2CCCN1CCN3CCCN(CC2)P3C)C", "smiles");
+    QCOMPARE(molecule.formula(), std::string("C12H26N4P2"));
+    QCOMPARE(molecule.ringCount(), size_t(3));
+
+    COMPARE_SMILES(&molecule, molecule.formula("smiles"));
+}
+
 void SmilesTest::copperSulfate()
 {
     chemkit::Molecule molecule("[Cu+2].[O-]S(=O)(=O)[O-]", "smiles");
@@ -79,6 +79,7 @@ class SmilesTest : public QObject
         void chrysene();
         void cinnoline();
         void colchicine();
+        void colzuy();
         void copperSulfate();
         void corannulene();
         void coronene();
@@ -37,7 +37,9 @@
 
 #include <boost/range/algorithm.hpp>
 
+#include <chemkit/atom.h>
 #include <chemkit/molecule.h>
+#include <chemkit/vector3.h>
 #include <chemkit/moleculefile.h>
 #include <chemkit/moleculardescriptor.h>
 
@@ -93,4 +95,24 @@ void SurfaceDescriptorsTest::test()
     QCOMPARE(qRound(molecule->descriptor("sas-volume").toDouble()), solventAccessibleVolume);
 }
 
+void SurfaceDescriptorsTest::moved()
+{
+    chemkit::MoleculeFile file(dataPath + "ethanol.cml");
+    bool ok = file.read();
+    if(!ok)
+        qDebug() << file.errorString().c_str();
+    QVERIFY(ok);
+
+    boost::shared_ptr<chemkit::Molecule> molecule = file.molecule();
+    QVERIFY(molecule);
+    QCOMPARE(qRound(molecule->descriptor("vdw-area").toDouble()), 82);
+
+    // moving an atom away from the others changes the surface
+    chemkit::Atom *atom = molecule->atom(0);
+    atom->setPosition(atom->position() + chemkit::Vector3(20, 0, 0));
+
+    chemkit::Real area = molecule->descriptor("vdw-area").toDouble();
+    QVERIFY(area > 82);
+}
+
 QTEST_APPLESS_MAIN(SurfaceDescriptorsTest)
@@ -46,6 +46,7 @@ class SurfaceDescriptorsTest : public QObject
         void initTestCase();
         void test_data();
         void test();
+        void moved();
 };
 
 #endif // SURFACEDESCRIPTORSTEST_H
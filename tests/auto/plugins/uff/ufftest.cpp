@@ -35,13 +35,18 @@
 
 #include "ufftest.h"
 
+#include <boost/make_shared.hpp>
 #include <boost/range/algorithm.hpp>
 
 #include <chemkit/molecule.h>
 #include <chemkit/atomtyper.h>
 #include <chemkit/forcefield.h>
+#include <chemkit/coordinateset.h>
 #include <chemkit/moleculefile.h>
 #include <chemkit/moleculardescriptor.h>
+#include <chemkit/cartesiancoordinates.h>
+
+const std::string dataPath = "../../../data/";
 
 void UffTest::initTestCase()
 {
@@ -51,4 +56,114 @@ void UffTest::initTestCase()
     QVERIFY(boost::count(chemkit::MolecularDescriptor::descriptors(), "uff-energy") == 1);
 }
 
+void UffTest::threadCount()
+{
+    boost::shared_ptr<chemkit::Molecule> molecule =
+        chemkit::MoleculeFile::quickRead(dataPath + "gly-ala.mol2");
+    QVERIFY(molecule);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField != 0);
+    QCOMPARE(forceField->threadCount(), size_t(1));
+
+    forceField->setTopologyFromMolecule(molecule.get());
+    forceField->setup();
+    QVERIFY(forceField->isSetup());
+
+    const chemkit::CartesianCoordinates *coordinates = molecule->coordinates();
+    chemkit::Real energy = forceField->energy(coordinates);
+    std::vector<chemkit::Vector3> gradient = forceField->gradient(coordinates);
+
+    // evaluate in parallel
+    forceField->setThreadCount(4);
+    QCOMPARE(forceField->threadCount(), size_t(4));
+
+    chemkit::Real parallelEnergy = forceField->energy(coordinates);
+    std::vector<chemkit::Vector3> parallelGradient = forceField->gradient(coordinates);
+    QVERIFY(std::abs(parallelEnergy - energy) < 1e-6);
+    QCOMPARE(parallelGradient.size(), gradient.size());
+    for(size_t i = 0; i < gradient.size(); i++){
+        QVERIFY((parallelGradient[i] - gradient[i]).norm() < 1e-6);
+    }
+
+    // results are reproducible for the same thread count
+    QVERIFY(forceField->energy(coordinates) == parallelEnergy);
+    QVERIFY(forceField->gradient(coordinates) == parallelGradient);
+
+    delete forceField;
+}
+
+void UffTest::energies()
+{
+    boost::shared_ptr<chemkit::Molecule> molecule =
+        chemkit::MoleculeFile::quickRead(dataPath + "gly-ala.mol2");
+    QVERIFY(molecule);
+
+    // add perturbed conformers of the molecule
+    for(size_t i = 1; i < 6; i++){
+        chemkit::CartesianCoordinates *coordinates =
+            new chemkit::CartesianCoordinates(*molecule->coordinates());
+        for(size_t j = 0; j < coordinates->size(); j++){
+            chemkit::Real offset = 0.02 * i * ((j % 3) - 1.0);
+            coordinates->setPosition(j, coordinates->position(j) + chemkit::Vector3(offset, -offset, 0));
+        }
+        molecule->addCoordinateSet(coordinates);
+    }
+    molecule->addCoordinateSet(boost::make_shared<chemkit::CoordinateSet>());
+    QCOMPARE(molecule->coordinateSetCount(), size_t(7));
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField != 0);
+    forceField->setTopologyFromMolecule(molecule.get());
+    forceField->setup();
+    QVERIFY(forceField->isSetup());
+
+    std::vector<chemkit::Real> energies = forceField->coordinateSetEnergies(molecule.get());
+    QCOMPARE(energies.size(), size_t(7));
+    for(size_t i = 0; i < 6; i++){
+        const chemkit::CartesianCoordinates *coordinates =
+            molecule->coordinateSet(i)->cartesianCoordinates();
+        QVERIFY(energies[i] == forceField->energy(coordinates));
+    }
+    QVERIFY(energies[0] != energies[1]);
+    QVERIFY(energies[6] != energies[6]);
+
+    // evaluate the conformers in parallel
+    forceField->setThreadCount(4);
+    std::vector<chemkit::Real> parallelEnergies = forceField->coordinateSetEnergies(molecule.get());
+    QCOMPARE(parallelEnergies.size(), energies.size());
+    for(size_t i = 0; i < 6; i++){
+        QVERIFY(parallelEnergies[i] == energies[i]);
+    }
+    QVERIFY(parallelEnergies[6] != parallelEnergies[6]);
+
+    delete forceField;
+}
+
+void UffTest::nonbondedCutoff()
+{
+    boost::shared_ptr<chemkit::Molecule> molecule =
+        chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("uff");
+    QVERIFY(forceField != 0);
+    forceField->setNonbondedCutoff(50.0);
+    forceField->setTopologyFromMolecule(molecule.get());
+    forceField->setup();
+    QVERIFY(forceField->isSetup());
+
+    const chemkit::CartesianCoordinates *coordinates = molecule->coordinates();
+    chemkit::Real energy = forceField->energy(coordinates);
+    size_t calculationCount = forceField->calculationCount();
+
+    // setting up the force field again gives the same energy
+    forceField->setup();
+    QVERIFY(forceField->isSetup());
+    QCOMPARE(forceField->calculationCount(), calculationCount);
+    QVERIFY(std::abs(forceField->energy(coordinates) - energy) < 1e-6);
+
+    delete forceField;
+}
+
 QTEST_APPLESS_MAIN(UffTest)
@@ -44,6 +44,9 @@ class UffTest : public QObject
 
     private slots:
         void initTestCase();
+        void threadCount();
+        void energies();
+        void nonbondedCutoff();
 };
 
 #endif // UFFTEST_H
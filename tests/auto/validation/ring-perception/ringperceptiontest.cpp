@@ -2109,6 +2109,45 @@ void RingPerceptionTest::ladderane()
     QCOMPARE(C11_C12->isAromatic(), false);
 }
 
+/* macrocycle (C122H242)
+ *
+ *  Two branch atoms (C1 and C2) connected by three chains of 30, 40
+ *  and 50 carbon atoms forming rings of size 72, 82 and 92. Only the
+ *  two smallest rings are in the sssr.
+ */
+void RingPerceptionTest::macrocycle()
+{
+    chemkit::Molecule molecule;
+    chemkit::Atom *C1 = molecule.addAtom("C");
+    chemkit::Atom *C2 = molecule.addAtom("C");
+
+    for(int length = 30; length <= 50; length += 10){
+        chemkit::Atom *previous = C1;
+
+        for(int i = 0; i < length; i++){
+            chemkit::Atom *atom = molecule.addAtom("C");
+            molecule.addBond(previous, atom);
+            previous = atom;
+        }
+
+        molecule.addBond(previous, C2);
+    }
+
+    addHydrogens(&molecule);
+    QCOMPARE(molecule.formula(), std::string("C122H242"));
+
+    QCOMPARE(molecule.ringCount(), size_t(2));
+    QCOMPARE(molecule.ring(0)->size(), size_t(72));
+    QCOMPARE(molecule.ring(1)->size(), size_t(82));
+    QCOMPARE(C1->smallestRing()->size(), size_t(72));
+    QCOMPARE(C2->smallestRing()->size(), size_t(72));
+
+    // the 50 atom chain is only in the 82 atom ring
+    QCOMPARE(molecule.atom(72)->isInRing(), true);
+    QCOMPARE(molecule.atom(72)->smallestRing()->size(), size_t(82));
+    QCOMPARE(molecule.atom(121)->smallestRing()->size(), size_t(82));
+}
+
 /* naphthalene (C10H8)
  *
  *      C1     C7
@@ -2971,6 +3010,75 @@ void RingPerceptionTest::quinoxaline()
     QCOMPARE(C9_C10->isAromatic(), true);
 }
 
+/* spirobicyclopentane (C7H10O2)
+ *
+ *      C2        C6 -- C7
+ *    /    \     /        \
+ *  C1 -C4- C3 O1          O2
+ *    \    /    \        /
+ *      C5 ------------/
+ */
+void RingPerceptionTest::spirobicyclopentane()
+{
+    chemkit::Molecule molecule;
+    chemkit::Atom *C1 = molecule.addAtom("C");
+    chemkit::Atom *C2 = molecule.addAtom("C");
+    chemkit::Atom *C3 = molecule.addAtom("C");
+    chemkit::Atom *C4 = molecule.addAtom("C");
+    chemkit::Atom *C5 = molecule.addAtom("C");
+    chemkit::Atom *O1 = molecule.addAtom("O");
+    chemkit::Atom *C6 = molecule.addAtom("C");
+    chemkit::Atom *C7 = molecule.addAtom("C");
+    chemkit::Atom *O2 = molecule.addAtom("O");
+    chemkit::Bond *C1_C2 = molecule.addBond(C1, C2);
+    chemkit::Bond *C1_C4 = molecule.addBond(C1, C4);
+    chemkit::Bond *C1_C5 = molecule.addBond(C1, C5);
+    chemkit::Bond *C2_C3 = molecule.addBond(C2, C3);
+    chemkit::Bond *C3_C4 = molecule.addBond(C3, C4);
+    chemkit::Bond *C3_C5 = molecule.addBond(C3, C5);
+    chemkit::Bond *C5_O1 = molecule.addBond(C5, O1);
+    chemkit::Bond *O1_C6 = molecule.addBond(O1, C6);
+    chemkit::Bond *C6_C7 = molecule.addBond(C6, C7);
+    chemkit::Bond *C7_O2 = molecule.addBond(C7, O2);
+    chemkit::Bond *O2_C5 = molecule.addBond(O2, C5);
+    addHydrogens(&molecule);
+    QCOMPARE(molecule.formula(), std::string("C7H10O2"));
+
+    // the bicyclopentane contains two rings and the dioxolane one
+    QCOMPARE(molecule.ringCount(), size_t(3));
+    chemkit::Ring *R1 = C1->smallestRing();
+    QCOMPARE(R1->size(), size_t(4));
+    QCOMPARE(R1->isAromatic(), false);
+    chemkit::Ring *R2 = C6->smallestRing();
+    QCOMPARE(R2->size(), size_t(5));
+    QCOMPARE(R2->isAromatic(), false);
+    QCOMPARE(R2->contains(C5), true);
+    QCOMPARE(R2->contains(O1), true);
+    QCOMPARE(R2->contains(O2), true);
+
+    QCOMPARE(C1->isInRing(), true);
+    QCOMPARE(C2->isInRing(), true);
+    QCOMPARE(C3->isInRing(), true);
+    QCOMPARE(C4->isInRing(), true);
+    QCOMPARE(C5->isInRing(), true);
+    QCOMPARE(O1->isInRing(), true);
+    QCOMPARE(C6->isInRing(), true);
+    QCOMPARE(C7->isInRing(), true);
+    QCOMPARE(O2->isInRing(), true);
+
+    QCOMPARE(C1_C2->isInRing(), true);
+    QCOMPARE(C1_C4->isInRing(), true);
+    QCOMPARE(C1_C5->isInRing(), true);
+    QCOMPARE(C2_C3->isInRing(), true);
+    QCOMPARE(C3_C4->isInRing(), true);
+    QCOMPARE(C3_C5->isInRing(), true);
+    QCOMPARE(C5_O1->isInRing(), true);
+    QCOMPARE(O1_C6->isInRing(), true);
+    QCOMPARE(C6_C7->isInRing(), true);
+    QCOMPARE(C7_O2->isInRing(), true);
+    QCOMPARE(O2_C5->isInRing(), true);
+}
+
 /* tetralin (C10H12)
  *
  *     C1     C7
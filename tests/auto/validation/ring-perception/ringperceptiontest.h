@@ -73,6 +73,7 @@ class RingPerceptionTest : public QObject
         void indole();
         void imidazole();
         void ladderane();
+        void macrocycle();
         void naphthalene();
         void norbornane();
         void oxazole();
@@ -83,6 +84,7 @@ class RingPerceptionTest : public QObject
         void pyridine();
         void pyrrole();
         void quinoxaline();
+        void spirobicyclopentane();
         void tetralin();
         void thiophene();
         void tricyclohexane();
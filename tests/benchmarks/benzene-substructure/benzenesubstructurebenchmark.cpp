@@ -37,13 +37,21 @@
 // isomorphism algorithms in chemkit.
 //
 // Based on: http://depth-first.com/articles/2009/01/22/mx-performance-comparison-3-substructure-search-in-mx-and-cdk
+//
+// The protein benchmark searches for the six-membered rings of the
+// aromatic residues in ubiquitin (PDB ID: 1UBQ, 602 atoms) and
+// hemoglobin (PDB ID: 2DHB, 2201 atoms) to measure how substructure
+// matching scales with the size of the target molecule.
 
 #include "benzenesubstructurebenchmark.h"
 
 #include <boost/make_shared.hpp>
 
+#include <chemkit/polymer.h>
 #include <chemkit/molecule.h>
+#include <chemkit/polymerfile.h>
 #include <chemkit/moleculefile.h>
+#include <chemkit/bondpredictor.h>
 #include <chemkit/substructurequery.h>
 
 const std::string dataPath = "../../data/";
@@ -75,4 +83,40 @@ void BenzeneSubstructureBenchmark::benchmark()
     }
 }
 
+void BenzeneSubstructureBenchmark::protein_data()
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<int>("atomCount");
+
+    QTest::newRow("1UBQ") << "1UBQ.pdb" << 602;
+    QTest::newRow("2DHB") << "2DHB.pdb" << 2201;
+}
+
+void BenzeneSubstructureBenchmark::protein()
+{
+    QFETCH(QString, fileName);
+    QFETCH(int, atomCount);
+
+    chemkit::PolymerFile file(dataPath + fileName.toStdString());
+    bool ok = file.read();
+    if(!ok)
+        qDebug() << file.errorString().c_str();
+    QVERIFY(ok);
+
+    const boost::shared_ptr<chemkit::Polymer> &protein = file.polymer();
+    QVERIFY(protein);
+    QCOMPARE(protein->size(), size_t(atomCount));
+
+    // pdb files do not contain bonds or bond orders so the bonds are
+    // predicted and the ring is searched for with single bonds
+    chemkit::BondPredictor::predictBonds(protein.get());
+
+    chemkit::SubstructureQuery query("C1CCCCC1", "smiles");
+
+    QBENCHMARK {
+        std::map<chemkit::Atom *, chemkit::Atom *> mapping = query.mapping(protein.get());
+        QCOMPARE(mapping.size(), size_t(6));
+    }
+}
+
 QTEST_APPLESS_MAIN(BenzeneSubstructureBenchmark)
@@ -44,6 +44,8 @@ class BenzeneSubstructureBenchmark : public QObject
 
     private slots:
         void benchmark();
+        void protein_data();
+        void protein();
 };
 
 #endif // BENZENESUBSTRUCTUREBENCHMARK_H
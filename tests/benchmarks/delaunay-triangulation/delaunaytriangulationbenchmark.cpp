@@ -0,0 +1,115 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+// This benchmark measures the time it takes to calculate the
+// weighted delaunay triangulation of the protein hemoglobin
+// (PDB ID: 2DHB) which contains 2201 atoms. The synthetic()
+// benchmark measures the time it takes to triangulate 50000
+// randomly placed points at roughly the density of a protein.
+
+#include "delaunaytriangulationbenchmark.h"
+
+#include <cmath>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+#include <chemkit/atom.h>
+#include <chemkit/polymer.h>
+#include <chemkit/polymerfile.h>
+#include <chemkit/delaunaytriangulation.h>
+
+const std::string dataPath = "../../data/";
+
+void DelaunayTriangulationBenchmark::hemoglobin()
+{
+    chemkit::PolymerFile file(dataPath + "2DHB.pdb");
+    bool ok = file.read();
+    if(!ok)
+        qDebug() << file.errorString().c_str();
+    QVERIFY(ok);
+
+    const boost::shared_ptr<chemkit::Polymer> &protein = file.polymer();
+    QVERIFY(protein);
+    QCOMPARE(protein->size(), size_t(2201));
+
+    // solvent accessible radii with a 1.4 angstrom probe
+    std::vector<chemkit::Point3> points;
+    std::vector<chemkit::Real> weights;
+    foreach(const chemkit::Atom *atom, protein->atoms()){
+        chemkit::Real radius = atom->vanDerWaalsRadius() + 1.4;
+
+        points.push_back(atom->position());
+        weights.push_back(radius * radius);
+    }
+
+    QBENCHMARK {
+        chemkit::DelaunayTriangulation triangulation(points, weights);
+        QCOMPARE(triangulation.vertexCount(), 2201);
+        QCOMPARE(triangulation.tetrahedronCount(), 14697);
+    }
+}
+
+void DelaunayTriangulationBenchmark::synthetic()
+{
+    const int count = 50000;
+
+    // one point per ten cubic angstroms
+    const chemkit::Real side = std::pow(count * 10.0, 1.0 / 3.0);
+
+    boost::mt19937 generator(1);
+    boost::random::uniform_real_distribution<chemkit::Real> position(0, side);
+    boost::random::uniform_real_distribution<chemkit::Real> radius(2.9, 3.4);
+
+    std::vector<chemkit::Point3> points;
+    std::vector<chemkit::Real> weights;
+    for(int i = 0; i < count; i++){
+        chemkit::Real x = position(generator);
+        chemkit::Real y = position(generator);
+        chemkit::Real z = position(generator);
+        chemkit::Real r = radius(generator);
+
+        points.push_back(chemkit::Point3(x, y, z));
+        weights.push_back(r * r);
+    }
+
+    QBENCHMARK {
+        chemkit::DelaunayTriangulation triangulation(points, weights);
+        QCOMPARE(triangulation.vertexCount(), count);
+    }
+}
+
+QTEST_APPLESS_MAIN(DelaunayTriangulationBenchmark)
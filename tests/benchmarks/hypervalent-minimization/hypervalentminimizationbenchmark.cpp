@@ -0,0 +1,129 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2011 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+
+#include "hypervalentminimizationbenchmark.h"
+
+#include <algorithm>
+
+#include <chemkit/molecule.h>
+#include <chemkit/moleculefile.h>
+#include <chemkit/moleculegeometryoptimizer.h>
+
+const std::string dataPath = "../../data/";
+
+void HypervalentMinimizationBenchmark::benchmark_data()
+{
+    QTest::addColumn<int>("algorithm");
+
+    QTest::newRow("steepest-descent") << int(chemkit::MoleculeGeometryOptimizer::SteepestDescent);
+    QTest::newRow("conjugate-gradient") << int(chemkit::MoleculeGeometryOptimizer::ConjugateGradient);
+    QTest::newRow("lbfgs") << int(chemkit::MoleculeGeometryOptimizer::Lbfgs);
+}
+
+void HypervalentMinimizationBenchmark::benchmark()
+{
+    QFETCH(int, algorithm);
+
+    chemkit::MoleculeFile file(dataPath + "MMFF94_hypervalent.mol2");
+    bool ok = file.read();
+    if(!ok)
+        qDebug() << file.errorString().c_str();
+    QVERIFY(ok);
+
+    size_t convergedCount = 0;
+    std::vector<size_t> &evaluationCounts = m_evaluationCounts[algorithm];
+    evaluationCounts.clear();
+
+    QBENCHMARK_ONCE {
+        foreach(const boost::shared_ptr<chemkit::Molecule> &molecule, file.molecules()){
+            chemkit::MoleculeGeometryOptimizer optimizer;
+            optimizer.setForceField("uff");
+            optimizer.setAlgorithm(chemkit::MoleculeGeometryOptimizer::Algorithm(algorithm));
+            optimizer.setMolecule(molecule.get());
+
+            if(optimizer.optimize()){
+                convergedCount++;
+                evaluationCounts.push_back(optimizer.evaluationCount());
+            }
+            else{
+                evaluationCounts.push_back(0);
+            }
+        }
+    }
+
+    QVERIFY(convergedCount > 0);
+    qDebug() << "converged:" << convergedCount;
+}
+
+// Compares the number of evaluations each algorithm needed for the
+// molecules which were converged by all of the algorithms.
+void HypervalentMinimizationBenchmark::evaluations()
+{
+    QCOMPARE(m_evaluationCounts.size(), size_t(3));
+
+    size_t moleculeCount = m_evaluationCounts.begin()->second.size();
+    std::vector<bool> common(moleculeCount, true);
+
+    for(std::map<int, std::vector<size_t> >::const_iterator iter = m_evaluationCounts.begin(); iter != m_evaluationCounts.end(); ++iter){
+        QCOMPARE(iter->second.size(), moleculeCount);
+
+        for(size_t i = 0; i < moleculeCount; i++){
+            if(iter->second[i] == 0){
+                common[i] = false;
+            }
+        }
+    }
+
+    size_t commonCount = std::count(common.begin(), common.end(), true);
+    QVERIFY(commonCount > 0);
+
+    const char *names[] = { "steepest-descent", "conjugate-gradient", "lbfgs" };
+
+    for(std::map<int, std::vector<size_t> >::const_iterator iter = m_evaluationCounts.begin(); iter != m_evaluationCounts.end(); ++iter){
+        size_t evaluationCount = 0;
+        for(size_t i = 0; i < moleculeCount; i++){
+            if(common[i]){
+                evaluationCount += iter->second[i];
+            }
+        }
+
+        qDebug() << names[iter->first]
+                 << "molecules:" << commonCount
+                 << "evaluations per molecule:" << double(evaluationCount) / commonCount;
+    }
+}
+
+QTEST_APPLESS_MAIN(HypervalentMinimizationBenchmark)
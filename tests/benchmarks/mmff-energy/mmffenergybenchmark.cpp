@@ -35,15 +35,31 @@
 
 #include "mmffenergybenchmark.h"
 
+#include <cmath>
+
 #include <chemkit/molecule.h>
 #include <chemkit/topology.h>
 #include <chemkit/forcefield.h>
 #include <chemkit/moleculefile.h>
 
+#include "../replicatedmolecule.h"
+
 const std::string dataPath = "../../data/";
 
+void MmffEnergyBenchmark::benchmark_data()
+{
+    QTest::addColumn<int>("threadCount");
+
+    QTest::newRow("1 thread") << 1;
+    QTest::newRow("2 threads") << 2;
+    QTest::newRow("4 threads") << 4;
+    QTest::newRow("8 threads") << 8;
+}
+
 void MmffEnergyBenchmark::benchmark()
 {
+    QFETCH(int, threadCount);
+
     // load test file
     chemkit::MoleculeFile file(dataPath + "MMFF94_hypervalent.mol2");
     bool ok = file.read();
@@ -56,6 +72,7 @@ void MmffEnergyBenchmark::benchmark()
 
     QBENCHMARK_ONCE {
         chemkit::ForceField *forceField = chemkit::ForceField::create("mmff");
+        forceField->setThreadCount(threadCount);
 
         foreach(const boost::shared_ptr<chemkit::Molecule> &molecule, file.molecules()){
             QVERIFY(forceField);
@@ -74,4 +91,42 @@ void MmffEnergyBenchmark::benchmark()
     QCOMPARE(qRound(totalEnergy), 5228);
 }
 
+void MmffEnergyBenchmark::largeSystem_data()
+{
+    benchmark_data();
+}
+
+void MmffEnergyBenchmark::largeSystem()
+{
+    QFETCH(int, threadCount);
+
+    boost::shared_ptr<chemkit::Molecule> uridine = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(uridine != 0);
+
+    // the terms of a single uridine fit in one task so the energy
+    // is calculated for eight copies (272 atoms and ~74000 terms)
+    // to give each thread a share of the work
+    boost::shared_ptr<chemkit::Molecule> molecule = replicateMolecule(uridine.get(), 8);
+
+    chemkit::ForceField *forceField = chemkit::ForceField::create("mmff");
+    QVERIFY(forceField);
+    forceField->setTopologyFromMolecule(molecule.get());
+    forceField->setup();
+    QVERIFY(forceField->isSetup());
+
+    // reference energy from a single thread
+    double expectedEnergy = forceField->energy(molecule->coordinates());
+
+    forceField->setThreadCount(threadCount);
+
+    double energy = 0;
+    QBENCHMARK {
+        energy = forceField->energy(molecule->coordinates());
+    }
+
+    QVERIFY(std::abs(energy - expectedEnergy) < 1e-6);
+
+    delete forceField;
+}
+
 QTEST_APPLESS_MAIN(MmffEnergyBenchmark)
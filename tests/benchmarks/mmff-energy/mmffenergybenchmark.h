@@ -43,7 +43,10 @@ class MmffEnergyBenchmark : public QObject
     Q_OBJECT
 
     private slots:
+        void benchmark_data();
         void benchmark();
+        void largeSystem_data();
+        void largeSystem();
 };
 
 #endif // MMFFENERGYBENCHMARK_H
@@ -37,12 +37,41 @@
 // the molecular masses for each molecule.
 //
 // Based on: http://depth-first.com/articles/2009/01/20/open-benchmarks-for-cheminformatics-first-performance-comparison-between-cdk-and-mx
+//
+// The large file benchmark reads a ~27 MB sdf file (ten copies of
+// the 416 molecule benzenes file) both sequentially and with the
+// parallel chunked reader to measure the scaling of file parsing.
 
 #include "molecularmassesbenchmark.h"
 
+#include <cstdio>
+#include <fstream>
+
 #include <chemkit/molecule.h>
 #include <chemkit/moleculefile.h>
 
+const std::string dataPath = "../../data/";
+const std::string largeFileName = "pubchem_4160_benzenes.sdf";
+
+void MolecularMassesBenchmark::initTestCase()
+{
+    // create the large file by concatenating the benzenes file
+    std::ifstream input((dataPath + "pubchem_416_benzenes.sdf").c_str(), std::ios::binary);
+    QVERIFY(input.is_open());
+    std::string contents((std::istreambuf_iterator<char>(input)),
+                         std::istreambuf_iterator<char>());
+
+    std::ofstream output(largeFileName.c_str(), std::ios::binary);
+    for(int i = 0; i < 10; i++){
+        output << contents;
+    }
+}
+
+void MolecularMassesBenchmark::cleanupTestCase()
+{
+    std::remove(largeFileName.c_str());
+}
+
 void MolecularMassesBenchmark::benchmark()
 {
     QBENCHMARK {
@@ -62,4 +91,35 @@ void MolecularMassesBenchmark::benchmark()
     }
 }
 
+void MolecularMassesBenchmark::largeFile_data()
+{
+    QTest::addColumn<int>("threadCount");
+
+    QTest::newRow("sequential") << 1;
+    QTest::newRow("parallel") << 0;
+}
+
+void MolecularMassesBenchmark::largeFile()
+{
+    QFETCH(int, threadCount);
+
+    QBENCHMARK {
+        chemkit::MoleculeFile file(largeFileName);
+        file.setThreadCount(threadCount);
+        bool ok = file.read();
+        if(!ok)
+            qDebug() << file.errorString().c_str();
+        QVERIFY(ok);
+        QCOMPARE(file.moleculeCount(), size_t(4160));
+
+        double totalMass = 0;
+
+        foreach(const boost::shared_ptr<chemkit::Molecule> &molecule, file.molecules()){
+            totalMass += molecule->mass();
+        }
+
+        QCOMPARE(qRound(totalMass), 1575363);
+    }
+}
+
 QTEST_APPLESS_MAIN(MolecularMassesBenchmark)
@@ -43,7 +43,11 @@ class MolecularMassesBenchmark : public QObject
     Q_OBJECT
 
     private slots:
+        void initTestCase();
+        void cleanupTestCase();
         void benchmark();
+        void largeFile_data();
+        void largeFile();
 };
 
 #endif // MOLECULARMASSESBENCHMARK_H
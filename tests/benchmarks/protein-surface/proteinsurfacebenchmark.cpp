@@ -36,10 +36,14 @@
 // This benchmark measures the time it takes to calculate the
 // solvent accessible surface area of the protein hemoglobin
 // (PDB ID: 2DHB). The protein contains 146 residues and 2201
-// atoms.
+// atoms. The atomSurfaceAreas() benchmark measures the time it
+// takes to calculate the solvent accessible surface area of each
+// atom in the protein.
 
 #include "proteinsurfacebenchmark.h"
 
+#include <cmath>
+
 #include <chemkit/polymer.h>
 #include <chemkit/polymerfile.h>
 #include <chemkit/molecularsurface.h>
@@ -66,4 +70,31 @@ void ProteinSurfaceBenchmark::benchmark()
     }
 }
 
+void ProteinSurfaceBenchmark::atomSurfaceAreas()
+{
+    chemkit::PolymerFile file(dataPath + "2DHB.pdb");
+    bool ok = file.read();
+    if(!ok)
+        qDebug() << file.errorString().c_str();
+    QVERIFY(ok);
+
+    const boost::shared_ptr<chemkit::Polymer> &protein = file.polymer();
+    QVERIFY(protein);
+    QCOMPARE(protein->size(), size_t(2201));
+
+    QBENCHMARK {
+        chemkit::MolecularSurface surface(protein.get());
+        surface.setSurfaceType(chemkit::MolecularSurface::SolventAccessible);
+
+        std::vector<chemkit::Real> areas = surface.atomSurfaceAreas();
+
+        chemkit::Real totalArea = 0;
+        for(size_t i = 0; i < areas.size(); i++){
+            totalArea += areas[i];
+        }
+
+        QVERIFY(std::abs(totalArea - 14791) < 0.002 * 14791);
+    }
+}
+
 QTEST_APPLESS_MAIN(ProteinSurfaceBenchmark)
@@ -44,6 +44,7 @@ class ProteinSurfaceBenchmark : public QObject
 
     private slots:
         void benchmark();
+        void atomSurfaceAreas();
 };
 
 #endif // PROTEINSURFACEBENCHMARK_H
@@ -0,0 +1,71 @@
+/******************************************************************************
+**
+** Copyright (C) 2009-2012 Kyle Lutz <kyle.r.lutz@gmail.com>
+** All rights reserved.
+**
+** This file is a part of the chemkit project. For more information
+** see <http://www.chemkit.org>.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in the
+**     documentation and/or other materials provided with the distribution.
+**   * Neither the name of the chemkit project nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+******************************************************************************/
+
+#ifndef REPLICATEDMOLECULE_H
+#define REPLICATEDMOLECULE_H
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <chemkit/atom.h>
+#include <chemkit/bond.h>
+#include <chemkit/foreach.h>
+#include <chemkit/molecule.h>
+
+// Returns a molecule containing count copies of molecule spaced 20
+// angstroms apart along the x axis. Shared by the benchmarks which
+// need a system larger than any of the test molecules.
+inline boost::shared_ptr<chemkit::Molecule> replicateMolecule(const chemkit::Molecule *molecule, int count)
+{
+    boost::shared_ptr<chemkit::Molecule> system(new chemkit::Molecule);
+
+    for(int i = 0; i < count; i++){
+        std::vector<chemkit::Atom *> atoms;
+        foreach(const chemkit::Atom *atom, molecule->atoms()){
+            chemkit::Atom *copy = system->addAtomCopy(atom);
+            copy->setPosition(atom->position() + chemkit::Vector3(20.0 * i, 0, 0));
+            atoms.push_back(copy);
+        }
+
+        foreach(const chemkit::Bond *bond, molecule->bonds()){
+            system->addBond(atoms[bond->atom1()->index()], atoms[bond->atom2()->index()], bond->order());
+        }
+    }
+
+    return system;
+}
+
+#endif // REPLICATEDMOLECULE_H
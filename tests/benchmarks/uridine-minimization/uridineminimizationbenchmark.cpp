@@ -39,15 +39,30 @@
 #include <chemkit/moleculefile.h>
 #include <chemkit/moleculegeometryoptimizer.h>
 
+#include "../replicatedmolecule.h"
+
 const std::string dataPath = "../../data/";
 
+void UridineMinimizationBenchmark::benchmark_data()
+{
+    QTest::addColumn<int>("threadCount");
+
+    QTest::newRow("1 thread") << 1;
+    QTest::newRow("2 threads") << 2;
+    QTest::newRow("4 threads") << 4;
+    QTest::newRow("8 threads") << 8;
+}
+
 void UridineMinimizationBenchmark::benchmark()
 {
+    QFETCH(int, threadCount);
+
     boost::shared_ptr<chemkit::Molecule> molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
     QVERIFY(molecule != 0);
 
     chemkit::MoleculeGeometryOptimizer optimizer;
     optimizer.setForceField("uff");
+    optimizer.setThreadCount(threadCount);
     optimizer.setMolecule(molecule.get());
 
     bool ok = optimizer.setup();
@@ -58,11 +73,74 @@ void UridineMinimizationBenchmark::benchmark()
             optimizer.step();
 
             // converge when rmsg = 0.1
-            if(optimizer.converged()){
+            if(optimizer.converged() || optimizer.isStalled()){
                 break;
             }
         }
     }
 }
 
+void UridineMinimizationBenchmark::largeSystem_data()
+{
+    benchmark_data();
+}
+
+void UridineMinimizationBenchmark::largeSystem()
+{
+    QFETCH(int, threadCount);
+
+    boost::shared_ptr<chemkit::Molecule> uridine = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(uridine != 0);
+
+    // eight well separated uridines (272 atoms and ~38000 terms) so
+    // that each gradient evaluation during the minimization is large
+    // enough to be split between the threads
+    boost::shared_ptr<chemkit::Molecule> molecule = replicateMolecule(uridine.get(), 8);
+
+    chemkit::MoleculeGeometryOptimizer optimizer;
+    optimizer.setForceField("uff");
+    optimizer.setThreadCount(threadCount);
+    optimizer.setMolecule(molecule.get());
+
+    bool ok = optimizer.setup();
+    QVERIFY(ok);
+
+    QBENCHMARK_ONCE {
+        while(!optimizer.converged() && !optimizer.isStalled()){
+            optimizer.step();
+        }
+    }
+}
+
+void UridineMinimizationBenchmark::algorithms_data()
+{
+    QTest::addColumn<int>("algorithm");
+
+    QTest::newRow("steepest-descent") << int(chemkit::MoleculeGeometryOptimizer::SteepestDescent);
+    QTest::newRow("conjugate-gradient") << int(chemkit::MoleculeGeometryOptimizer::ConjugateGradient);
+    QTest::newRow("lbfgs") << int(chemkit::MoleculeGeometryOptimizer::Lbfgs);
+}
+
+void UridineMinimizationBenchmark::algorithms()
+{
+    QFETCH(int, algorithm);
+
+    boost::shared_ptr<chemkit::Molecule> molecule = chemkit::MoleculeFile::quickRead(dataPath + "uridine.mol2");
+    QVERIFY(molecule != 0);
+
+    chemkit::MoleculeGeometryOptimizer optimizer;
+    optimizer.setForceField("uff");
+    optimizer.setAlgorithm(chemkit::MoleculeGeometryOptimizer::Algorithm(algorithm));
+    optimizer.setMolecule(molecule.get());
+
+    bool ok = false;
+    QBENCHMARK_ONCE {
+        ok = optimizer.optimize();
+    }
+    QVERIFY(ok);
+
+    qDebug() << "evaluations:" << optimizer.evaluationCount()
+             << "iterations:" << optimizer.iterationCount();
+}
+
 QTEST_APPLESS_MAIN(UridineMinimizationBenchmark)
@@ -43,7 +43,12 @@ class UridineMinimizationBenchmark : public QObject
     Q_OBJECT
 
     private slots:
+        void benchmark_data();
         void benchmark();
+        void largeSystem_data();
+        void largeSystem();
+        void algorithms_data();
+        void algorithms();
 };
 
 #endif // URIDINEMINIMIZATIONBENCHMARK_H